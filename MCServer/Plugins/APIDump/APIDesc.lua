@@ -107,8 +107,12 @@ g_APIDesc =
 				FillRelCuboid = { Params = "MinRelX, MaxRelX, MinRelY, MaxRelY, MinRelZ, MaxRelZ, DataTypes, BlockType, [BlockMeta], [BlockLight], [BlockSkyLight]", Return = "", Notes = "Fills the specified cuboid with the same values (like Fill() )." },
 				GetBlockLight = { Params = "BlockX, BlockY, BlockZ", Return = "NIBBLETYPE", Notes = "Returns the blocklight at the specified absolute coords" },
 				GetBlockMeta = { Params = "BlockX, BlockY, BlockZ", Return = "NIBBLETYPE", Notes = "Returns the block meta at the specified absolute coords" },
+				GetBlockMetasArray = { Params = "", Return = "table", Notes = "Returns all the block metas as an array-table of numbers, 1-based. The block at relative coords {x, y, z} is at index 1 + x + z * SizeX + y * SizeX * SizeZ. Returns nil if the area doesn't hold block metas." },
+				GetBlockMetasString = { Params = "", Return = "string", Notes = "Returns all the block metas as a single string, one byte per block. The block at relative coords {x, y, z} is at string.byte() index 1 + x + z * SizeX + y * SizeX * SizeZ. Returns nil if the area doesn't hold block metas. This is the fastest way to get many blocks into Lua." },
 				GetBlockSkyLight = { Params = "BlockX, BlockY, BlockZ", Return = "NIBBLETYPE", Notes = "Returns the skylight at the specified absolute coords" },
 				GetBlockType = { Params = "BlockX, BlockY, BlockZ", Return = "BLOCKTYPE", Notes = "Returns the block type at the specified absolute coords" },
+				GetBlockTypesArray = { Params = "", Return = "table", Notes = "Returns all the block types as an array-table of numbers, like GetBlockMetasArray()." },
+				GetBlockTypesString = { Params = "", Return = "string", Notes = "Returns all the block types as a single string, one byte per block, like GetBlockMetasString()." },
 				GetBlockTypeMeta = { Params = "BlockX, BlockY, BlockZ", Return = "BLOCKTYPE, NIBBLETYPE", Notes = "Returns the block type and meta at the specified absolute coords" },
 				GetDataTypes = { Params = "", Return = "number", Notes = "Returns the mask of datatypes that the objectis currently holding" },
 				GetOriginX = { Params = "", Return = "number", Notes = "Returns the origin x-coord" },
@@ -135,6 +139,7 @@ g_APIDesc =
 				MirrorYZ = { Params = "", Return = "", Notes = "Mirrors this block area around the YZ plane. Modifies blocks' metas (if present)" },
 				MirrorYZNoMeta = { Params = "", Return = "", Notes = "Mirrors this block area around the YZ plane. Doesn't modify blocks' metas." },
 				Read = { Params = "World, MinX, MaxX, MinY, MaxY, MinZ, MaxZ, DataTypes", Return = "bool", Notes = "Reads the area from World, returns true if successful" },
+				ReadAsync = { Params = "World, MinX, MaxX, MinY, MaxY, MinZ, MaxZ, [DataTypes], Callback", Return = "", Notes = "Reads the area from World in a separate thread, without stalling the world's tick. When finished, calls Callback(BlockArea, IsSuccess) in the world's tick thread. The area must not be used until then. DataTypes defaults to baTypes + baMetas." },
 				RelLine = { Params = "RelX1, RelY1, RelZ1, RelX2, RelY2, RelZ2, DataTypes, BlockType, [BlockMeta], [BlockLight], [BlockSkyLight]", Return = "", Notes = "Draws a line between the two specified points. Sets only datatypes specified by DataTypes." },
 				RotateCCW = { Params = "", Return = "", Notes = "Rotates the block area around the Y axis, counter-clockwise (east -> north). Modifies blocks' metas (if present) to match." },
 				RotateCCWNoMeta = { Params = "", Return = "", Notes = "Rotates the block area around the Y axis, counter-clockwise (east -> north). Doesn't modify blocks' metas." },
@@ -143,8 +148,12 @@ g_APIDesc =
 				SaveToSchematicFile = { Params = "FileName", Return = "", Notes = "Saves the current contents to a schematic file. Returns true if successful." },
 				SetBlockLight = { Params = "BlockX, BlockY, BlockZ, BlockLight", Return = "", Notes = "Sets the blocklight at the specified absolute coords" },
 				SetBlockMeta = { Params = "BlockX, BlockY, BlockZ, BlockMeta", Return = "", Notes = "Sets the block meta at the specified absolute coords" },
+				SetBlockMetasArray = { Params = "Metas", Return = "bool", Notes = "Sets all the block metas from an array-table of numbers, in the same order as GetBlockMetasArray() returns them. Returns false if the table size doesn't match the area size or the area doesn't hold block metas." },
+				SetBlockMetasString = { Params = "Metas", Return = "bool", Notes = "Sets all the block metas from a string, one byte per block, in the same order as GetBlockMetasString() returns them. The string is copied straight from Lua's memory, without any per-block processing. Returns false if the string length doesn't match the area size or the area doesn't hold block metas." },
 				SetBlockSkyLight = { Params = "BlockX, BlockY, BlockZ, SkyLight", Return = "", Notes = "Sets the skylight at the specified absolute coords" },
 				SetBlockType = { Params = "BlockX, BlockY, BlockZ, BlockType", Return = "", Notes = "Sets the block type at the specified absolute coords" },
+				SetBlockTypesArray = { Params = "Types", Return = "bool", Notes = "Sets all the block types from an array-table of numbers, like SetBlockMetasArray()." },
+				SetBlockTypesString = { Params = "Types", Return = "bool", Notes = "Sets all the block types from a string, one byte per block, like SetBlockMetasString()." },
 				SetBlockTypeMeta = { Params = "BlockX, BlockY, BlockZ, BlockType, BlockMeta", Return = "", Notes = "Sets the block type and meta at the specified absolute coords" },
 				SetOrigin = { Params = "OriginX, OriginY, OriginZ", Return = "", Notes = "Resets the origin for the absolute coords. Only affects how absolute coords are translated into relative coords." },
 				SetRelBlockLight = { Params = "RelBlockX, RelBlockY, RelBlockZ, BlockLight", Return = "", Notes = "Sets the blocklight at the specified relative coords" },
@@ -153,6 +162,7 @@ g_APIDesc =
 				SetRelBlockType = { Params = "RelBlockX, RelBlockY, RelBlockZ, BlockType", Return = "", Notes = "Sets the block type at the specified relative coords" },
 				SetRelBlockTypeMeta = { Params = "RelBlockX, RelBlockY, RelBlockZ, BlockType, BlockMeta", Return = "", Notes = "Sets the block type and meta at the specified relative coords" },
 				Write = { Params = "World, MinX, MinY, MinZ, DataTypes", Return = "bool", Notes = "Writes the area into World at the specified coords, returns true if successful" },
+				WriteAsync = { Params = "World, MinX, MinY, MinZ, [DataTypes], Callback", Return = "", Notes = "Writes the area into World in a separate thread, like ReadAsync(). When finished, calls Callback(BlockArea, IsSuccess) in the world's tick thread. The area must not be used until then." },
 			},
 			Constants =
 			{
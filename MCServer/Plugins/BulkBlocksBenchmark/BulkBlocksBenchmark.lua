@@ -0,0 +1,183 @@
+
+-- BulkBlocksBenchmark.lua
+
+-- Compares the speed of editing blocks one by one through cWorld with editing them in bulk through cBlockArea
+-- Use the "bulkbench [Size]" console command; it fills a Size^3 cube high above the default world's spawn with wool
+-- in each of the ways, reads it back, then clears it again.
+
+
+
+
+
+-- The default size of the benchmark cube's edge, in blocks
+DEFAULT_SIZE = 32
+
+-- The lowest Y coord of the benchmark cube, high up in the air so that it doesn't damage any terrain
+CUBE_MIN_Y = 200
+
+
+
+
+
+function Initialize(Plugin)
+	Plugin:SetName("BulkBlocksBenchmark")
+	Plugin:SetVersion(1)
+	
+	cPluginManager.BindConsoleCommand("bulkbench", HandleBulkBenchCmd, "Measures the speed of the per-block and the bulk block APIs")
+	return true
+end
+
+
+
+
+
+--- Returns the number of blocks per second, formatted
+local function FormatSpeed(a_NumBlocks, a_Seconds)
+	if (a_Seconds <= 0) then
+		return "too fast to measure"
+	end
+	return string.format("%.0f blocks/sec", a_NumBlocks / a_Seconds)
+end
+
+
+
+
+
+--- Fills the cube using cWorld:SetBlock() for each block, then reads it back using cWorld:GetBlock()
+local function BenchPerBlock(a_World, a_MinX, a_MinY, a_MinZ, a_Size)
+	local Start = os.clock()
+	for y = a_MinY, a_MinY + a_Size - 1 do
+		for z = a_MinZ, a_MinZ + a_Size - 1 do
+			for x = a_MinX, a_MinX + a_Size - 1 do
+				a_World:SetBlock(x, y, z, E_BLOCK_WOOL, (x + z) % 16)
+			end
+		end
+	end
+	local Written = os.clock()
+	local NumWool = 0
+	for y = a_MinY, a_MinY + a_Size - 1 do
+		for z = a_MinZ, a_MinZ + a_Size - 1 do
+			for x = a_MinX, a_MinX + a_Size - 1 do
+				if (a_World:GetBlock(x, y, z) == E_BLOCK_WOOL) then
+					NumWool = NumWool + 1
+				end
+			end
+		end
+	end
+	return Written - Start, os.clock() - Written, NumWool
+end
+
+
+
+
+
+--- Fills the cube using a cBlockArea and the string bulk API, then reads it back the same way
+local function BenchString(a_World, a_MinX, a_MinY, a_MinZ, a_Size)
+	local Start = os.clock()
+	local Area = cBlockArea()
+	Area:Create(a_Size, a_Size, a_Size)
+	local Metas = {}
+	for i = 1, a_Size * a_Size do
+		-- One layer of metas, in the area's order (x first, then z):
+		local x = (i - 1) % a_Size
+		local z = math.floor((i - 1) / a_Size)
+		Metas[i] = string.char((a_MinX + x + a_MinZ + z) % 16)
+	end
+	Area:SetBlockTypesString(string.rep(string.char(E_BLOCK_WOOL), a_Size * a_Size * a_Size))
+	Area:SetBlockMetasString(string.rep(table.concat(Metas), a_Size))
+	Area:Write(a_World, a_MinX, a_MinY, a_MinZ)
+	local Written = os.clock()
+	Area:Read(a_World, a_MinX, a_MinX + a_Size - 1, a_MinY, a_MinY + a_Size - 1, a_MinZ, a_MinZ + a_Size - 1)
+	local Types = Area:GetBlockTypesString()
+	local Wool = string.char(E_BLOCK_WOOL)
+	local NumWool = 0
+	local Pos = string.find(Types, Wool, 1, true)
+	while (Pos ~= nil) do
+		NumWool = NumWool + 1
+		Pos = string.find(Types, Wool, Pos + 1, true)
+	end
+	return Written - Start, os.clock() - Written, NumWool
+end
+
+
+
+
+
+--- Fills the cube using a cBlockArea and the array bulk API, then reads it back the same way
+local function BenchArray(a_World, a_MinX, a_MinY, a_MinZ, a_Size)
+	local Start = os.clock()
+	local Area = cBlockArea()
+	Area:Create(a_Size, a_Size, a_Size)
+	local Types = {}
+	local Metas = {}
+	local Idx = 1
+	for y = 0, a_Size - 1 do
+		for z = 0, a_Size - 1 do
+			for x = 0, a_Size - 1 do
+				Types[Idx] = E_BLOCK_WOOL
+				Metas[Idx] = (a_MinX + x + a_MinZ + z) % 16
+				Idx = Idx + 1
+			end
+		end
+	end
+	Area:SetBlockTypesArray(Types)
+	Area:SetBlockMetasArray(Metas)
+	Area:Write(a_World, a_MinX, a_MinY, a_MinZ)
+	local Written = os.clock()
+	Area:Read(a_World, a_MinX, a_MinX + a_Size - 1, a_MinY, a_MinY + a_Size - 1, a_MinZ, a_MinZ + a_Size - 1)
+	local NumWool = 0
+	for _, BlockType in ipairs(Area:GetBlockTypesArray()) do
+		if (BlockType == E_BLOCK_WOOL) then
+			NumWool = NumWool + 1
+		end
+	end
+	return Written - Start, os.clock() - Written, NumWool
+end
+
+
+
+
+
+--- Clears the cube back to air
+local function ClearCube(a_World, a_MinX, a_MinY, a_MinZ, a_Size)
+	local Area = cBlockArea()
+	Area:Create(a_Size, a_Size, a_Size)
+	Area:Write(a_World, a_MinX, a_MinY, a_MinZ)
+end
+
+
+
+
+
+function HandleBulkBenchCmd(a_Split)
+	local Size = tonumber(a_Split[2]) or DEFAULT_SIZE
+	if ((Size < 1) or (CUBE_MIN_Y + Size > 256)) then
+		return true, "The size must be between 1 and " .. (256 - CUBE_MIN_Y)
+	end
+	
+	local World = cRoot:Get():GetDefaultWorld()
+	local MinX = math.floor(World:GetSpawnX()) - math.floor(Size / 2)
+	local MinZ = math.floor(World:GetSpawnZ()) - math.floor(Size / 2)
+	local NumBlocks = Size * Size * Size
+	local Benchmarks =
+	{
+		{ Name = "cWorld:SetBlock / GetBlock", Fn = BenchPerBlock },
+		{ Name = "cBlockArea strings",         Fn = BenchString },
+		{ Name = "cBlockArea arrays",          Fn = BenchArray },
+	}
+	local Out = { "Bulk blocks benchmark, " .. NumBlocks .. " blocks:" }
+	for _, Bench in ipairs(Benchmarks) do
+		ClearCube(World, MinX, CUBE_MIN_Y, MinZ, Size)
+		local WriteTime, ReadTime, NumWool = Bench.Fn(World, MinX, CUBE_MIN_Y, MinZ, Size)
+		table.insert(Out, string.format("  %s: write %s, read %s%s",
+			Bench.Name, FormatSpeed(NumBlocks, WriteTime), FormatSpeed(NumBlocks, ReadTime),
+			(NumWool == NumBlocks) and "" or (" (read back only " .. NumWool .. " blocks, the chunks may not be loaded)")
+		))
+	end
+	ClearCube(World, MinX, CUBE_MIN_Y, MinZ, Size)
+	return true, table.concat(Out, "\n")
+end
+
+
+
+
@@ -0,0 +1,179 @@
+
+// AuthPerformanceTest.cpp
+
+// Measures the login throughput of cAuthenticator against a local stand-in session server
+
+/*
+A wave of users logs in at once, as after a server restart, and the time until all of them are authenticated is measured.
+The stand-in session server delays each answer to simulate the round trip to the real session server, and the first
+answer on each connection more, to simulate the TCP handshake. The scenarios compare a single worker opening a new
+connection for each user (the previous authenticator), a single worker reusing its connection, several workers,
+and a second wave of the same users reconnecting while their authentications are cached.
+Every INVALID_EVERY-th user is refused by the session server; the number of refused users is checked in each scenario.
+*/
+
+#include "Globals.h"
+#include "Authenticator.h"
+#include "StandInSessionServer.h"
+#include "OSSupport/Timer.h"
+#include "inifile/iniFile.h"
+
+
+
+
+
+/** Number of users logging in in each wave */
+#define NUM_USERS 200
+
+/** Every n-th user is refused by the session server */
+#define INVALID_EVERY 10
+
+/** Number of msec the stand-in session server takes to answer each request */
+#define REQUEST_LATENCY 10
+
+/** Number of msec added to the first answer on each connection */
+#define CONNECT_LATENCY 10
+
+
+
+
+
+/** Counts the authentication results and lets the main thread wait for them */
+class cResultCounter :
+	public cAuthenticator::cCallbacks
+{
+public:
+	cResultCounter(void) :
+		m_NumAuthenticated(0),
+		m_NumFailed(0)
+	{
+	}
+
+	/** Waits until the total number of results reaches a_NumResults */
+	void WaitForResults(int a_NumResults)
+	{
+		cCSLock Lock(m_CS);
+		while (m_NumAuthenticated + m_NumFailed < a_NumResults)
+		{
+			cCSUnlock Unlock(Lock);
+			m_evResult.Wait();
+		}
+	}
+
+	int GetNumAuthenticated(void) const { return m_NumAuthenticated; }
+	int GetNumFailed(void) const { return m_NumFailed; }
+
+protected:
+	cCriticalSection m_CS;
+	cEvent m_evResult;
+	int m_NumAuthenticated;
+	int m_NumFailed;
+
+	// cAuthenticator::cCallbacks overrides:
+	virtual void OnAuthenticated(int a_ClientID) override
+	{
+		cCSLock Lock(m_CS);
+		m_NumAuthenticated++;
+		m_evResult.Set();
+	}
+
+	virtual void OnAuthFailed(int a_ClientID, const AString & a_Reason) override
+	{
+		cCSLock Lock(m_CS);
+		m_NumFailed++;
+		m_evResult.Set();
+	}
+} ;
+
+
+
+
+
+/** Makes all the users log in at once and waits until all of them are authenticated or refused */
+static void LoginWave(cAuthenticator & a_Authenticator, cResultCounter & a_Results)
+{
+	int NumResults = a_Results.GetNumAuthenticated() + a_Results.GetNumFailed();
+	for (int i = 0; i < NUM_USERS; i++)
+	{
+		AString UserName = Printf("%s%d", ((i % INVALID_EVERY) == 0) ? "Invalid" : "Player", i);
+		AString IP = Printf("10.0.%d.%d", i / 256, i % 256);
+		a_Authenticator.Authenticate(i, UserName, IP, "0123456789abcdef");
+	}
+	a_Results.WaitForResults(NumResults + NUM_USERS);
+}
+
+
+
+
+
+/** Runs a single scenario and logs its results */
+static void Measure(const char * a_Name, cStandInSessionServer & a_Server, bool a_KeepAlive, int a_NumThreads, bool a_Reconnect)
+{
+	a_Server.SetKeepAlive(a_KeepAlive);
+	cIniFile Ini;
+	Ini.SetValue ("Authentication", "Server", Printf("127.0.0.1:%u", (unsigned)a_Server.GetPort()));
+	Ini.SetValueI("Authentication", "NumThreads", a_NumThreads);
+	Ini.SetValueI("Authentication", "CacheTimeout", a_Reconnect ? 600 : 0);
+
+	cResultCounter Results;
+	cAuthenticator Authenticator(Results);
+	Authenticator.Start(Ini);
+	if (a_Reconnect)
+	{
+		// The first wave fills the cache:
+		LoginWave(Authenticator, Results);
+	}
+	int NumRequests = Authenticator.GetNumRequests();
+	int NumConnections = Authenticator.GetNumConnections();
+	int NumAuthenticated = Results.GetNumAuthenticated();
+	int NumFailed = Results.GetNumFailed();
+
+	cTimer Timer;
+	long long Start = Timer.GetNowTime();
+	LoginWave(Authenticator, Results);
+	long long MSec = Timer.GetNowTime() - Start;
+	Authenticator.Stop();
+
+	NumAuthenticated = Results.GetNumAuthenticated() - NumAuthenticated;
+	NumFailed = Results.GetNumFailed() - NumFailed;
+	int ExpectedNumFailed = (NUM_USERS + INVALID_EVERY - 1) / INVALID_EVERY;
+	LOG("%-28s %6lld msec (%7.1f logins/sec), %4d requests over %4d connections, %d cache hits%s",
+		a_Name, MSec, (double)NUM_USERS * 1000 / std::max(MSec, 1LL),
+		Authenticator.GetNumRequests() - NumRequests, Authenticator.GetNumConnections() - NumConnections,
+		Authenticator.GetNumCacheHits(),
+		((NumAuthenticated == NUM_USERS - ExpectedNumFailed) && (NumFailed == ExpectedNumFailed)) ? "" : ", RESULTS WRONG!"
+	);
+}
+
+
+
+
+
+int main(int argc, char * argv[])
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+	cSocket::WSAStartup();
+
+	cStandInSessionServer Server;
+	if (!Server.Start(REQUEST_LATENCY, CONNECT_LATENCY))
+	{
+		return 1;
+	}
+	LOG("Stand-in session server listening on port %u, %d msec per request, %d msec more per connection",
+		(unsigned)Server.GetPort(), REQUEST_LATENCY, CONNECT_LATENCY
+	);
+	LOG("Logging in %d users at once, every %d-th one is refused", NUM_USERS, INVALID_EVERY);
+
+	Measure("1 thread, no reuse",    Server, false, 1,  false);
+	Measure("1 thread",              Server, true,  1,  false);
+	Measure("4 threads",             Server, true,  4,  false);
+	Measure("16 threads",            Server, true,  16, false);
+	Measure("16 threads, reconnect", Server, true,  16, true);
+
+	Server.Stop();
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,267 @@
+
+// StandInSessionServer.cpp
+
+// Implements the cStandInSessionServer class representing a local HTTP server answering the auth requests like the official session server
+
+#include "Globals.h"
+#include "StandInSessionServer.h"
+#include "OSSupport/Sleep.h"
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cStandInSessionServer:
+
+cStandInSessionServer::cStandInSessionServer(void) :
+	super("cStandInSessionServer"),
+	m_Port(0),
+	m_RequestLatency(0),
+	m_ConnectLatency(0),
+	m_KeepAlive(true),
+	m_NumConnections(0),
+	m_NumRequests(0)
+{
+}
+
+
+
+
+
+cStandInSessionServer::~cStandInSessionServer()
+{
+	Stop();
+}
+
+
+
+
+
+bool cStandInSessionServer::Start(int a_RequestLatency, int a_ConnectLatency)
+{
+	m_RequestLatency = a_RequestLatency;
+	m_ConnectLatency = a_ConnectLatency;
+	m_ListenSocket = cSocket::CreateSocket(cSocket::IPv4);
+	if (
+		!m_ListenSocket.IsValid() ||
+		!m_ListenSocket.BindToLocalhostIPv4(cSocket::ANY_PORT) ||
+		!m_ListenSocket.Listen(100)
+	)
+	{
+		LOGERROR("Cannot listen on a localhost port: %s", cSocket::GetLastErrorString().c_str());
+		return false;
+	}
+	m_Port = m_ListenSocket.GetPort();
+	m_ShouldTerminate = false;
+	return super::Start();
+}
+
+
+
+
+
+void cStandInSessionServer::Stop(void)
+{
+	if (!m_ListenSocket.IsValid())
+	{
+		return;
+	}
+
+	// Wake up the accept() call by connecting to ourselves:
+	m_ShouldTerminate = true;
+	cSocket Waker = cSocket::CreateSocket(cSocket::IPv4);
+	Waker.ConnectToLocalhostIPv4(m_Port);
+	Wait();
+	Waker.CloseSocket();
+	m_ListenSocket.CloseSocket();
+
+	// Take the connections out of the list first, their threads need m_CS to finish:
+	cConnections Connections;
+	{
+		cCSLock Lock(m_CS);
+		std::swap(Connections, m_Connections);
+	}
+	for (cConnections::iterator itr = Connections.begin(); itr != Connections.end(); ++itr)
+	{
+		(*itr)->Shutdown();
+		delete *itr;
+	}
+}
+
+
+
+
+
+void cStandInSessionServer::Execute(void)
+{
+	while (!m_ShouldTerminate)
+	{
+		cSocket Socket = m_ListenSocket.AcceptIPv4();
+		if (!Socket.IsValid())
+		{
+			continue;
+		}
+		if (m_ShouldTerminate)
+		{
+			Socket.CloseSocket();
+			break;
+		}
+
+		RemoveFinishedConnections();
+		cCSLock Lock(m_CS);
+		cConnection * Connection = new cConnection(*this, Socket);
+		m_Connections.push_back(Connection);
+		m_NumConnections++;
+		Connection->Start();
+	}
+}
+
+
+
+
+
+void cStandInSessionServer::RemoveFinishedConnections(void)
+{
+	cCSLock Lock(m_CS);
+	for (cConnections::iterator itr = m_Connections.begin(); itr != m_Connections.end();)
+	{
+		if ((*itr)->IsFinished())
+		{
+			delete *itr;
+			itr = m_Connections.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}  // for itr - m_Connections[]
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cStandInSessionServer::cConnection:
+
+cStandInSessionServer::cConnection::cConnection(cStandInSessionServer & a_Server, cSocket a_Socket) :
+	super("cStandInSessionServer connection"),
+	m_Server(a_Server),
+	m_Socket(a_Socket),
+	m_IsFinished(false)
+{
+}
+
+
+
+
+
+cStandInSessionServer::cConnection::~cConnection()
+{
+	Wait();
+	m_Socket.CloseSocket();
+}
+
+
+
+
+
+void cStandInSessionServer::cConnection::Shutdown(void)
+{
+	if (!m_IsFinished)
+	{
+		m_Socket.ShutdownReadWrite();
+	}
+}
+
+
+
+
+
+void cStandInSessionServer::cConnection::Execute(void)
+{
+	bool IsFirst = true;
+	AString Data;
+	for (;;)
+	{
+		// Receive a whole request; the auth requests have no body:
+		size_t idxEnd;
+		while ((idxEnd = Data.find("\r\n\r\n")) == AString::npos)
+		{
+			char Buffer[1024];
+			int NumReceived = m_Socket.Receive(Buffer, sizeof(Buffer), 0);
+			if (NumReceived <= 0)
+			{
+				m_IsFinished = true;
+				return;
+			}
+			Data.append(Buffer, (size_t)NumReceived);
+		}
+		AString Request = Data.substr(0, idxEnd);
+		Data.erase(0, idxEnd + 4);
+
+		// Parse the request line, "GET <path> HTTP/1.1":
+		AStringVector RequestLine = StringSplit(Request.substr(0, Request.find("\r\n")), " ");
+		AString Answer = ((RequestLine.size() == 3) && (RequestLine[0] == "GET")) ? GetAnswer(RequestLine[1]) : "NO";
+		bool KeepAlive = m_Server.m_KeepAlive;
+
+		cSleep::MilliSleep((unsigned)(m_Server.m_RequestLatency + (IsFirst ? m_Server.m_ConnectLatency : 0)));
+		IsFirst = false;
+
+		AString Response;
+		Printf(Response, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %u\r\nConnection: %s\r\n\r\n%s",
+			(unsigned)Answer.size(), KeepAlive ? "keep-alive" : "close", Answer.c_str()
+		);
+		if (m_Socket.Send(Response.data(), (unsigned)Response.size()) != (int)Response.size())
+		{
+			m_IsFinished = true;
+			return;
+		}
+		{
+			cCSLock Lock(m_Server.m_CS);
+			m_Server.m_NumRequests++;
+		}
+		if (!KeepAlive)
+		{
+			m_Socket.ShutdownReadWrite();
+			m_IsFinished = true;
+			return;
+		}
+	}  // for (-ever)
+}
+
+
+
+
+
+AString cStandInSessionServer::cConnection::GetAnswer(const AString & a_Path)
+{
+	size_t idxQuery = a_Path.find('?');
+	if ((idxQuery == AString::npos) || (a_Path.substr(0, idxQuery) != "/game/checkserver.jsp"))
+	{
+		return "NO";
+	}
+	AString UserName, ServerID;
+	AStringVector Params = StringSplit(a_Path.substr(idxQuery + 1), "&");
+	for (AStringVector::const_iterator itr = Params.begin(); itr != Params.end(); ++itr)
+	{
+		if (itr->compare(0, 5, "user=") == 0)
+		{
+			UserName = itr->substr(5);
+		}
+		else if (itr->compare(0, 9, "serverId=") == 0)
+		{
+			ServerID = itr->substr(9);
+		}
+	}
+	if (UserName.empty() || ServerID.empty() || (UserName.compare(0, 7, "Invalid") == 0))
+	{
+		return "NO";
+	}
+	return "YES";
+}
+
+
+
+
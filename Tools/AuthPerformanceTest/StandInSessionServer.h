@@ -0,0 +1,105 @@
+
+// StandInSessionServer.h
+
+// Declares the cStandInSessionServer class representing a local HTTP server answering the auth requests like the official session server
+
+/*
+The server listens on a free localhost port and answers "GET /game/checkserver.jsp?user=<name>&serverId=<id>" requests
+with "YES" for any user whose name doesn't start with "Invalid", and with "NO" for the rest. Each answer is delayed to
+simulate the round trip to the real session server, the first answer on each connection is delayed more to simulate
+the TCP handshake. Each connection is handled by its own thread, so the server answers any number of requests at once.
+*/
+
+
+
+
+
+#pragma once
+
+#include "OSSupport/IsThread.h"
+#include "OSSupport/Socket.h"
+
+
+
+
+
+class cStandInSessionServer :
+	public cIsThread
+{
+	typedef cIsThread super;
+
+public:
+	cStandInSessionServer(void);
+	~cStandInSessionServer();
+
+	/** Starts listening on a free localhost port. a_RequestLatency and a_ConnectLatency are the delays in msec
+	added to each answer and to the first answer on each connection, respectively. Returns true if successful */
+	bool Start(int a_RequestLatency, int a_ConnectLatency);
+
+	/** Stops the server, closes all the connections */
+	void Stop(void);
+
+	/** Returns the port on which the server listens */
+	unsigned short GetPort(void) const { return m_Port; }
+
+	/** Sets whether the connections are kept open after each answer, or closed as with the old clients */
+	void SetKeepAlive(bool a_KeepAlive) { m_KeepAlive = a_KeepAlive; }
+
+	/** Returns the number of connections accepted since the start */
+	int GetNumConnections(void) const { return m_NumConnections; }
+
+	/** Returns the number of requests answered since the start */
+	int GetNumRequests(void) const { return m_NumRequests; }
+
+protected:
+	/** A thread serving the requests of a single connection */
+	class cConnection :
+		public cIsThread
+	{
+		typedef cIsThread super;
+
+	public:
+		cConnection(cStandInSessionServer & a_Server, cSocket a_Socket);
+		virtual ~cConnection();
+
+		/** Returns true once the thread has finished serving the connection */
+		bool IsFinished(void) const { return m_IsFinished; }
+
+		/** Makes the thread's blocking socket calls fail, so that it finishes */
+		void Shutdown(void);
+
+	protected:
+		cStandInSessionServer & m_Server;
+		cSocket m_Socket;
+		volatile bool m_IsFinished;
+
+		// cIsThread override:
+		virtual void Execute(void) override;
+
+		/** Returns the answer to the request for a_Path, "YES" or "NO" */
+		AString GetAnswer(const AString & a_Path);
+	} ;
+
+	typedef std::vector<cConnection *> cConnections;
+
+	cSocket        m_ListenSocket;
+	unsigned short m_Port;
+	int            m_RequestLatency;
+	int            m_ConnectLatency;
+	volatile bool  m_KeepAlive;
+
+	cCriticalSection m_CS;
+	cConnections     m_Connections;
+	int              m_NumConnections;
+	int              m_NumRequests;
+
+	// cIsThread override:
+	virtual void Execute(void) override;
+
+	/** Deletes the connections whose threads have finished */
+	void RemoveFinishedConnections(void);
+} ;
+
+
+
+
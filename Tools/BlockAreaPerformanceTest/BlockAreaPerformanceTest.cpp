@@ -0,0 +1,196 @@
+
+// BlockAreaPerformanceTest.cpp
+
+// Measures the speed of the bulk cBlockArea operations on large areas
+
+/*
+Each operation is run on a copy of the same area, half of it air and the rest random blocks with random metas.
+The operations that have a vectorized implementation in cBlockArrayOps are run both with it and with the scalar one,
+and the results of the two are compared.
+*/
+
+#include "Globals.h"
+#include "BlockArea.h"
+#include "BlockArrayOps.h"
+#include "FastRandom.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+/** Size of the areas along each axis */
+#define AREA_SIZE 256
+
+/** Number of blocks cut off / added on each side by the crop and expand operations */
+#define CROP_SIZE 8
+
+
+
+
+
+/** An operation run on a_Area; a_Other is another area of the same size with different contents, used for merging */
+typedef void (* cOperation)(cBlockArea & a_Area, const cBlockArea & a_Other);
+
+/** The other area's metas packed into the chunk format, for unpacking */
+static std::vector<NIBBLETYPE> g_PackedNibbles;
+
+
+
+
+
+static void OpFill          (cBlockArea & a_Area, const cBlockArea &) { a_Area.Fill(cBlockArea::baTypes | cBlockArea::baMetas, E_BLOCK_STONE, 3); }
+static void OpFillRelCuboid (cBlockArea & a_Area, const cBlockArea &) { a_Area.FillRelCuboid(1, AREA_SIZE - 2, 1, AREA_SIZE - 2, 1, AREA_SIZE - 2, cBlockArea::baTypes | cBlockArea::baMetas, E_BLOCK_STONE, 3); }
+static void OpMergeOverwrite(cBlockArea & a_Area, const cBlockArea & a_Other) { a_Area.Merge(a_Other, 0, 0, 0, cBlockArea::msOverwrite); }
+static void OpMergeFillAir  (cBlockArea & a_Area, const cBlockArea & a_Other) { a_Area.Merge(a_Other, 0, 0, 0, cBlockArea::msFillAir); }
+static void OpMergeImprint  (cBlockArea & a_Area, const cBlockArea & a_Other) { a_Area.Merge(a_Other, 0, 0, 0, cBlockArea::msImprint); }
+static void OpCrop          (cBlockArea & a_Area, const cBlockArea &) { a_Area.Crop(CROP_SIZE, CROP_SIZE, CROP_SIZE, CROP_SIZE, CROP_SIZE, CROP_SIZE); }
+static void OpExpand        (cBlockArea & a_Area, const cBlockArea &) { a_Area.Expand(CROP_SIZE, CROP_SIZE, CROP_SIZE, CROP_SIZE, CROP_SIZE, CROP_SIZE); }
+static void OpRotateCW      (cBlockArea & a_Area, const cBlockArea &) { a_Area.RotateCW(); }
+static void OpRotateCCW     (cBlockArea & a_Area, const cBlockArea &) { a_Area.RotateCCW(); }
+static void OpMirrorXY      (cBlockArea & a_Area, const cBlockArea &) { a_Area.MirrorXY(); }
+static void OpMirrorXZ      (cBlockArea & a_Area, const cBlockArea &) { a_Area.MirrorXZ(); }
+static void OpMirrorYZ      (cBlockArea & a_Area, const cBlockArea &) { a_Area.MirrorYZ(); }
+
+
+
+
+
+static void OpPackNibbles(cBlockArea & a_Area, const cBlockArea &)
+{
+	// Packs in place, into the first half of the metas, so that the result gets compared:
+	cBlockArrayOps::PackNibbles(a_Area.GetBlockMetas(), a_Area.GetBlockMetas(), a_Area.GetBlockCount());
+}
+
+
+
+
+
+static void OpUnpackNibbles(cBlockArea & a_Area, const cBlockArea &)
+{
+	cBlockArrayOps::UnpackNibbles(&g_PackedNibbles[0], a_Area.GetBlockMetas(), a_Area.GetBlockCount());
+}
+
+
+
+
+
+/** Fills the area with random blocks and metas, about half of the blocks are air */
+static void FillRandom(cBlockArea & a_Area, cFastRandom & a_Random)
+{
+	BLOCKTYPE * BlockTypes = a_Area.GetBlockTypes();
+	NIBBLETYPE * BlockMetas = a_Area.GetBlockMetas();
+	for (int i = a_Area.GetBlockCount() - 1; i >= 0; i--)
+	{
+		int Rnd = a_Random.NextInt(0x10000, i);
+		BlockTypes[i] = ((Rnd & 1) == 0) ? (BLOCKTYPE)E_BLOCK_AIR : (BLOCKTYPE)(1 + (Rnd >> 1) % 150);
+		BlockMetas[i] = (NIBBLETYPE)((Rnd >> 9) & 0x0f);
+	}
+}
+
+
+
+
+
+/** Returns a checksum of the area's size, blocktypes and metas */
+static UInt32 Checksum(const cBlockArea & a_Area)
+{
+	UInt32 Res = 2166136261u;  // FNV-1a
+	Res = (Res ^ (UInt32)a_Area.GetSizeX()) * 16777619u;
+	Res = (Res ^ (UInt32)a_Area.GetSizeY()) * 16777619u;
+	Res = (Res ^ (UInt32)a_Area.GetSizeZ()) * 16777619u;
+	const BLOCKTYPE * BlockTypes = a_Area.GetBlockTypes();
+	const NIBBLETYPE * BlockMetas = a_Area.GetBlockMetas();
+	for (int i = a_Area.GetBlockCount() - 1; i >= 0; i--)
+	{
+		Res = (Res ^ BlockTypes[i]) * 16777619u;
+		Res = (Res ^ BlockMetas[i]) * 16777619u;
+	}
+	return Res;
+}
+
+
+
+
+
+/** Runs the operation on a fresh copy of a_Source and returns the time it took, in msec; a_Checksum receives the checksum of the result */
+static long long Run(cOperation a_Operation, const cBlockArea & a_Source, const cBlockArea & a_Other, UInt32 & a_Checksum)
+{
+	cBlockArea Area;
+	a_Source.CopyTo(Area);
+	cTimer Timer;
+	long long Start = Timer.GetNowTime();
+	a_Operation(Area, a_Other);
+	long long MSec = Timer.GetNowTime() - Start;
+	a_Checksum = Checksum(Area);
+	return MSec;
+}
+
+
+
+
+
+/** Measures the operation and logs the results. If a_IsVectorized, measures both implementations and compares the results */
+static void Measure(const char * a_Name, cOperation a_Operation, bool a_IsVectorized, const cBlockArea & a_Source, const cBlockArea & a_Other)
+{
+	double MBlocks = (double)a_Source.GetBlockCount() / 1000000;
+	if (!a_IsVectorized || !cBlockArrayOps::IsSimdSupported())
+	{
+		UInt32 Checksum;
+		long long MSec = Run(a_Operation, a_Source, a_Other, Checksum);
+		LOG("%-16s %6lld msec (%7.1f MBlocks/sec)", a_Name, MSec, MBlocks * 1000 / std::max(MSec, 1LL));
+		return;
+	}
+
+	UInt32 ScalarChecksum, SimdChecksum;
+	cBlockArrayOps::SetSimdEnabled(false);
+	long long ScalarMSec = Run(a_Operation, a_Source, a_Other, ScalarChecksum);
+	cBlockArrayOps::SetSimdEnabled(true);
+	long long SimdMSec = Run(a_Operation, a_Source, a_Other, SimdChecksum);
+	LOG("%-16s %6lld msec (%7.1f MBlocks/sec), scalar %6lld msec (%7.1f MBlocks/sec)%s",
+		a_Name,
+		SimdMSec, MBlocks * 1000 / std::max(SimdMSec, 1LL),
+		ScalarMSec, MBlocks * 1000 / std::max(ScalarMSec, 1LL),
+		(ScalarChecksum == SimdChecksum) ? "" : ", RESULTS DIFFER!"
+	);
+}
+
+
+
+
+
+int main(void)
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+
+	LOG("Preparing two %d^3 areas...", AREA_SIZE);
+	cFastRandom Random;
+	cBlockArea Source, Other;
+	Source.Create(AREA_SIZE, AREA_SIZE, AREA_SIZE, cBlockArea::baTypes | cBlockArea::baMetas);
+	Other.Create(AREA_SIZE, AREA_SIZE, AREA_SIZE, cBlockArea::baTypes | cBlockArea::baMetas);
+	FillRandom(Source, Random);
+	FillRandom(Other, Random);
+	g_PackedNibbles.resize(Other.GetBlockCount() / 2);
+	cBlockArrayOps::PackNibbles(Other.GetBlockMetas(), &g_PackedNibbles[0], Other.GetBlockCount());
+	LOG("SSE2 is %s", cBlockArrayOps::IsSimdSupported() ? "supported, comparing to the scalar implementation" : "not supported");
+
+	Measure("Fill",            OpFill,           false, Source, Other);
+	Measure("FillRelCuboid",   OpFillRelCuboid,  false, Source, Other);
+	Measure("Merge Overwrite", OpMergeOverwrite, false, Source, Other);
+	Measure("Merge FillAir",   OpMergeFillAir,   true,  Source, Other);
+	Measure("Merge Imprint",   OpMergeImprint,   true,  Source, Other);
+	Measure("Crop",            OpCrop,           false, Source, Other);
+	Measure("Expand",          OpExpand,         false, Source, Other);
+	Measure("RotateCW",        OpRotateCW,       false, Source, Other);
+	Measure("RotateCCW",       OpRotateCCW,      false, Source, Other);
+	Measure("MirrorXY",        OpMirrorXY,       false, Source, Other);
+	Measure("MirrorXZ",        OpMirrorXZ,       false, Source, Other);
+	Measure("MirrorYZ",        OpMirrorYZ,       false, Source, Other);
+	Measure("Pack nibbles",    OpPackNibbles,    true,  Source, Other);
+	Measure("Unpack nibbles",  OpUnpackNibbles,  true,  Source, Other);
+	return 0;
+}
+
+
+
+
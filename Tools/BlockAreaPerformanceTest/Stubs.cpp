@@ -0,0 +1,194 @@
+
+// Stubs.cpp
+
+// Implements a stand-in for the blockhandlers, so that the benchmark doesn't need to link the Blocks library
+
+/*
+cBlockArea's meta rotations and mirroring ask the blockhandlers for the transformed metas. The real handlers live in
+the Blocks library, which pulls in the entire server (cChunkMap, cWorld, cPlayer, ...). Instead, all the block types
+share a single base cBlockHandler here, whose meta transformations are the default ones (no change). The benchmark
+still goes through the same per-blocktype transformation tables as with the real handlers.
+The rest of cBlockHandler's functions are never called in the benchmark, they only need to exist for the vtable.
+*/
+
+#include "Globals.h"
+#include "Blocks/BlockHandler.h"
+
+
+
+
+
+cBlockHandler * cBlockHandler::GetBlockHandler(BLOCKTYPE)
+{
+	static cBlockHandler Handler(E_BLOCK_STONE);
+	return &Handler;
+}
+
+
+
+
+
+cBlockHandler::cBlockHandler(BLOCKTYPE a_BlockType)
+{
+	m_BlockType = a_BlockType;
+}
+
+
+
+
+
+void cBlockHandler::OnUpdate(cChunkInterface &, cWorldInterface &, cBlockPluginInterface &, cChunk &, int, int, int)
+{
+}
+
+
+
+
+
+bool cBlockHandler::GetPlacementBlockTypeMeta(
+	cChunkInterface &, cPlayer *,
+	int, int, int, eBlockFace,
+	int, int, int,
+	BLOCKTYPE &, NIBBLETYPE &
+)
+{
+	return false;
+}
+
+
+
+
+
+void cBlockHandler::OnPlaced(cChunkInterface &, cWorldInterface &, int, int, int, BLOCKTYPE, NIBBLETYPE)
+{
+}
+
+
+
+
+
+void cBlockHandler::OnPlacedByPlayer(cChunkInterface &, cWorldInterface &, cPlayer *, int, int, int, eBlockFace, int, int, int, BLOCKTYPE, NIBBLETYPE)
+{
+}
+
+
+
+
+
+void cBlockHandler::OnDestroyedByPlayer(cChunkInterface &, cWorldInterface &, cPlayer *, int, int, int)
+{
+}
+
+
+
+
+
+void cBlockHandler::OnDestroyed(cChunkInterface &, cWorldInterface &, int, int, int)
+{
+}
+
+
+
+
+
+void cBlockHandler::OnNeighborChanged(cChunkInterface &, int, int, int)
+{
+}
+
+
+
+
+
+void cBlockHandler::OnDigging(cChunkInterface &, cWorldInterface &, cPlayer *, int, int, int)
+{
+}
+
+
+
+
+
+void cBlockHandler::OnUse(cChunkInterface &, cWorldInterface &, cPlayer *, int, int, int, eBlockFace, int, int, int)
+{
+}
+
+
+
+
+
+void cBlockHandler::ConvertToPickups(cItems &, NIBBLETYPE)
+{
+}
+
+
+
+
+
+void cBlockHandler::DropBlock(cChunkInterface &, cWorldInterface &, cBlockPluginInterface &, cEntity *, int, int, int)
+{
+}
+
+
+
+
+
+const char * cBlockHandler::GetStepSound(void)
+{
+	return "step.stone";
+}
+
+
+
+
+
+bool cBlockHandler::CanBeAt(cChunkInterface &, int, int, int, const cChunk &)
+{
+	return true;
+}
+
+
+
+
+
+bool cBlockHandler::IsUseable(void)
+{
+	return false;
+}
+
+
+
+
+
+bool cBlockHandler::IsClickedThrough(void)
+{
+	return false;
+}
+
+
+
+
+
+bool cBlockHandler::DoesIgnoreBuildCollision(void)
+{
+	return false;
+}
+
+
+
+
+
+bool cBlockHandler::DoesDropOnUnsuitable(void)
+{
+	return true;
+}
+
+
+
+
+
+void cBlockHandler::Check(cChunkInterface &, cBlockPluginInterface &, int, int, int, cChunk &)
+{
+}
+
+
+
+
@@ -0,0 +1,583 @@
+
+// Bot.cpp
+
+// Implements the cBot class representing a single headless client of BotSwarm, walking along a scripted path and timing the chunks it receives
+
+#include "Globals.h"
+#include "Bot.h"
+#include "ByteBuffer.h"
+
+#ifndef _WIN32
+	#include <netinet/tcp.h>  // For TCP_NODELAY
+#endif
+
+
+
+
+
+/** Number of msec between the position updates, the game client sends one each tick */
+#define MOVE_INTERVAL 50
+
+/** Height of the player's eyes above their feet; the server's Player Position And Look packet uses the eye height */
+#define EYE_HEIGHT 1.62
+
+/** The angle between the directions of two consecutive bots, in radians; the golden angle spreads any number of bots evenly */
+#define DIRECTION_STEP 2.39996323
+
+/** Width of a chunk, in blocks */
+#define CHUNK_WIDTH 16
+
+
+
+
+
+/** Reads a VarInt from a_Data at a_Pos and advances a_Pos past it. Returns false if the data ends prematurely */
+static bool ReadVarInt(const AString & a_Data, size_t & a_Pos, UInt32 & a_Value)
+{
+	a_Value = 0;
+	for (int Shift = 0; Shift < 35; Shift += 7)
+	{
+		if (a_Pos >= a_Data.size())
+		{
+			return false;
+		}
+		Byte b = (Byte)a_Data[a_Pos++];
+		a_Value |= (UInt32)(b & 0x7f) << Shift;
+		if ((b & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+
+cBot::cBot(const sBotSettings & a_Settings, const AString & a_UserName, int a_Index) :
+	m_Settings(a_Settings),
+	m_UserName(a_UserName),
+	m_Index(a_Index),
+	m_State(stDisconnected),
+	m_OriginX(0),
+	m_OriginZ(0),
+	m_PosX(0),
+	m_PosY(0),
+	m_PosZ(0),
+	m_PathStart(0),
+	m_NextMoveTime(0),
+	m_ChunkX(0),
+	m_ChunkZ(0),
+	m_GapStart(-1),
+	m_ConnectTime(-1),
+	m_SpawnTime(-1)
+{
+}
+
+
+
+
+
+cBot::~cBot()
+{
+	Disconnect("Benchmark finished");
+}
+
+
+
+
+
+bool cBot::Connect(Int64 a_Now)
+{
+	m_ConnectTime = a_Now;
+	m_Socket = cSocket::CreateSocket(cSocket::IPv4);
+	if (!m_Socket.IsValid())
+	{
+		m_DisconnectReason = Printf("Cannot create a socket: %s", cSocket::GetLastErrorString().c_str());
+		return false;
+	}
+	// Like the game client, send the small packets right away, so that they don't distort the latency:
+	int NoDelay = 1;
+	setsockopt(m_Socket.GetSocket(), IPPROTO_TCP, TCP_NODELAY, (const char *)&NoDelay, sizeof(NoDelay));
+	if (!m_Socket.ConnectIPv4(m_Settings.m_ServerAddress, m_Settings.m_ServerPort))
+	{
+		Disconnect(Printf("Cannot connect to the server: %s", cSocket::GetLastErrorString().c_str()));
+		return false;
+	}
+	m_State = stLoggingIn;
+
+	// Send the initial handshake:
+	cByteBuffer Handshake(512);
+	Handshake.WriteVarInt(0x00);
+	Handshake.WriteVarInt(m_Settings.m_ProtocolVersion);
+	Handshake.WriteVarUTF8String(m_Settings.m_ServerAddress);
+	Handshake.WriteBEShort((short)m_Settings.m_ServerPort);
+	Handshake.WriteVarInt(2);  // Next state: login
+	SendPacket(Handshake);
+
+	// Send the Login Start packet:
+	cByteBuffer LoginStart(512);
+	LoginStart.WriteVarInt(0x00);
+	LoginStart.WriteVarUTF8String(m_UserName);
+	SendPacket(LoginStart);
+	return IsConnected();
+}
+
+
+
+
+
+void cBot::Disconnect(const AString & a_Reason)
+{
+	if (!m_Socket.IsValid())
+	{
+		return;
+	}
+	m_Socket.CloseSocket();
+	m_State = stDisconnected;
+	m_DisconnectReason = a_Reason;
+}
+
+
+
+
+
+void cBot::ReceiveData(Int64 a_Now)
+{
+	char Buffer[64 KiB];
+	int NumBytes = m_Socket.Receive(Buffer, sizeof(Buffer), 0);
+	if (NumBytes <= 0)
+	{
+		Disconnect((NumBytes == 0) ? AString("The server closed the connection") : Printf("Receiving failed: %s", cSocket::GetLastErrorString().c_str()));
+		return;
+	}
+	m_Stats.m_NumBytesReceived += NumBytes;
+	m_IncomingData.append(Buffer, (size_t)NumBytes);
+
+	// Handle all the complete packets:
+	size_t Pos = 0;
+	while (IsConnected())
+	{
+		size_t PacketStart = Pos;
+		UInt32 PacketLen;
+		if (!ReadVarInt(m_IncomingData, Pos, PacketLen) || (m_IncomingData.size() - Pos < PacketLen))
+		{
+			// Not a complete packet yet
+			Pos = PacketStart;
+			break;
+		}
+		HandlePacket(m_IncomingData.substr(Pos, PacketLen), a_Now);
+		Pos += PacketLen;
+	}
+	m_IncomingData.erase(0, Pos);
+}
+
+
+
+
+
+void cBot::Tick(Int64 a_Now)
+{
+	if ((m_State != stWalking) || (a_Now < m_NextMoveTime))
+	{
+		return;
+	}
+	m_NextMoveTime += MOVE_INTERVAL;
+	if (m_NextMoveTime <= a_Now)
+	{
+		// The thread has fallen behind, don't send a burst of updates to catch up:
+		m_NextMoveTime = a_Now + MOVE_INTERVAL;
+	}
+
+	// Send the Player Position packet for where the path leads now:
+	CalcPathPos(a_Now);
+	cByteBuffer Pos(64);
+	Pos.WriteVarInt(0x04);
+	Pos.WriteBEDouble(m_PosX);
+	Pos.WriteBEDouble(m_PosY);
+	Pos.WriteBEDouble(m_PosY + EYE_HEIGHT);  // Stance
+	Pos.WriteBEDouble(m_PosZ);
+	Pos.WriteBool(true);  // On ground
+	SendPacket(Pos);
+
+	// If the bot has crossed into another chunk, the chunks coming into view are wanted from now on:
+	int ChunkX = (int)floor(m_PosX / CHUNK_WIDTH);
+	int ChunkZ = (int)floor(m_PosZ / CHUNK_WIDTH);
+	if ((ChunkX != m_ChunkX) || (ChunkZ != m_ChunkZ))
+	{
+		m_Stats.m_NumChunkCrossings++;
+		UpdateView(ChunkX, ChunkZ, a_Now, a_Now);
+	}
+}
+
+
+
+
+
+Int64 cBot::GetNextTickTime(void) const
+{
+	return (m_State == stWalking) ? m_NextMoveTime : -1;
+}
+
+
+
+
+
+void cBot::HandlePacket(const AString & a_Packet, Int64 a_Now)
+{
+	cByteBuffer Packet((int)a_Packet.size() + 1);
+	Packet.Write(a_Packet.data(), (int)a_Packet.size());
+	UInt32 PacketType;
+	if (!Packet.ReadVarInt(PacketType))
+	{
+		return;
+	}
+
+	if (m_State == stLoggingIn)
+	{
+		switch (PacketType)
+		{
+			case 0x00:
+			{
+				// Disconnect
+				AString Reason;
+				Packet.ReadVarUTF8String(Reason);
+				Disconnect("Login refused: " + Reason);
+				return;
+			}
+			case 0x01:
+			{
+				// Encryption Request
+				Disconnect("The server requires authentication, it needs to run with authentication disabled");
+				return;
+			}
+			case 0x02:
+			{
+				// Login Success
+				m_State = stSpawning;
+				return;
+			}
+		}
+		return;
+	}
+
+	switch (PacketType)
+	{
+		case 0x00:
+		{
+			// Keep Alive, answer with the same ID:
+			int KeepAliveID;
+			if (Packet.ReadBEInt(KeepAliveID))
+			{
+				cByteBuffer Answer(16);
+				Answer.WriteVarInt(0x00);
+				Answer.WriteBEInt(KeepAliveID);
+				SendPacket(Answer);
+			}
+			break;
+		}
+		case 0x08: HandlePlayerPosLook(Packet, a_Now); break;
+		case 0x21: HandleChunkData    (Packet, a_Now, (int)a_Packet.size()); break;
+		case 0x26: HandleMapChunkBulk (Packet, a_Now, (int)a_Packet.size()); break;
+		case 0x40:
+		{
+			// Disconnect
+			AString Reason;
+			Packet.ReadVarUTF8String(Reason);
+			Disconnect("Kicked: " + Reason);
+			break;
+		}
+	}
+}
+
+
+
+
+
+void cBot::HandlePlayerPosLook(cByteBuffer & a_Packet, Int64 a_Now)
+{
+	double PosX, EyeY, PosZ;
+	float Yaw, Pitch;
+	bool IsOnGround;
+	if (
+		!a_Packet.ReadBEDouble(PosX) || !a_Packet.ReadBEDouble(EyeY) || !a_Packet.ReadBEDouble(PosZ) ||
+		!a_Packet.ReadBEFloat(Yaw) || !a_Packet.ReadBEFloat(Pitch) || !a_Packet.ReadBool(IsOnGround)
+	)
+	{
+		return;
+	}
+
+	// Confirm the position, as the game client does:
+	m_PosX = PosX;
+	m_PosY = EyeY - EYE_HEIGHT;
+	m_PosZ = PosZ;
+	cByteBuffer Answer(64);
+	Answer.WriteVarInt(0x06);
+	Answer.WriteBEDouble(m_PosX);
+	Answer.WriteBEDouble(m_PosY);
+	Answer.WriteBEDouble(EyeY);
+	Answer.WriteBEDouble(m_PosZ);
+	Answer.WriteBEFloat(Yaw);
+	Answer.WriteBEFloat(Pitch);
+	Answer.WriteBool(IsOnGround);
+	SendPacket(Answer);
+
+	// The path starts anew from here:
+	m_OriginX = m_PosX;
+	m_OriginZ = m_PosZ;
+	m_PathStart = a_Now;
+	int ChunkX = (int)floor(m_PosX / CHUNK_WIDTH);
+	int ChunkZ = (int)floor(m_PosZ / CHUNK_WIDTH);
+	if (m_State == stSpawning)
+	{
+		// The chunks around the spawn have been wanted since the login:
+		m_State = stWalking;
+		m_SpawnTime = a_Now;
+		m_Stats.m_LoginTime = a_Now - m_ConnectTime;
+		m_NextMoveTime = a_Now;
+		UpdateView(ChunkX, ChunkZ, a_Now, m_ConnectTime);
+	}
+	else if ((ChunkX != m_ChunkX) || (ChunkZ != m_ChunkZ))
+	{
+		UpdateView(ChunkX, ChunkZ, a_Now, a_Now);
+	}
+}
+
+
+
+
+
+void cBot::HandleChunkData(cByteBuffer & a_Packet, Int64 a_Now, int a_PacketSize)
+{
+	m_Stats.m_NumChunkBytes += a_PacketSize;
+	int ChunkX, ChunkZ;
+	bool IsGroundUp;
+	short PrimaryBitMap, AddBitMap;
+	if (
+		!a_Packet.ReadBEInt(ChunkX) || !a_Packet.ReadBEInt(ChunkZ) || !a_Packet.ReadBool(IsGroundUp) ||
+		!a_Packet.ReadBEShort(PrimaryBitMap) || !a_Packet.ReadBEShort(AddBitMap)
+	)
+	{
+		return;
+	}
+	if (IsGroundUp && (PrimaryBitMap == 0))
+	{
+		// The server unloads the chunk:
+		m_LoadedChunks.erase(cChunkXZ(ChunkX, ChunkZ));
+		m_Stats.m_NumChunksUnloaded++;
+		return;
+	}
+	ChunkArrived(ChunkX, ChunkZ, a_Now);
+}
+
+
+
+
+
+void cBot::HandleMapChunkBulk(cByteBuffer & a_Packet, Int64 a_Now, int a_PacketSize)
+{
+	m_Stats.m_NumChunkBytes += a_PacketSize;
+	short NumChunks;
+	int DataLength;
+	bool HasSkyLight;
+	if (
+		!a_Packet.ReadBEShort(NumChunks) || !a_Packet.ReadBEInt(DataLength) || !a_Packet.ReadBool(HasSkyLight) ||
+		!a_Packet.SkipRead(DataLength)
+	)
+	{
+		return;
+	}
+
+	// The chunk coords follow the compressed data of all the chunks:
+	for (short i = 0; i < NumChunks; i++)
+	{
+		int ChunkX, ChunkZ;
+		short PrimaryBitMap, AddBitMap;
+		if (!a_Packet.ReadBEInt(ChunkX) || !a_Packet.ReadBEInt(ChunkZ) || !a_Packet.ReadBEShort(PrimaryBitMap) || !a_Packet.ReadBEShort(AddBitMap))
+		{
+			return;
+		}
+		ChunkArrived(ChunkX, ChunkZ, a_Now);
+	}
+}
+
+
+
+
+
+void cBot::ChunkArrived(int a_ChunkX, int a_ChunkZ, Int64 a_Now)
+{
+	m_Stats.m_NumChunksReceived++;
+	cChunkXZ Chunk(a_ChunkX, a_ChunkZ);
+	if (!m_LoadedChunks.insert(Chunk).second)
+	{
+		m_Stats.m_NumChunksUnexpected++;
+		return;
+	}
+	if (m_State != stWalking)
+	{
+		// Before the spawn, the bot doesn't know its position yet; the spawn checks the loaded chunks
+		return;
+	}
+
+	cChunkTimeMap::iterator itr = m_WantedChunks.find(Chunk);
+	if (itr == m_WantedChunks.end())
+	{
+		// Either outside the view distance, or it has left the view while on the way:
+		m_Stats.m_NumChunksUnexpected++;
+		return;
+	}
+	if (itr->second >= m_SpawnTime)
+	{
+		// Came into view while walking; the chunks around the spawn are measured together by m_InitialViewTime
+		m_Stats.m_ChunkLatencies.push_back((int)(a_Now - itr->second));
+	}
+	m_WantedChunks.erase(itr);
+	CheckViewComplete(a_Now);
+}
+
+
+
+
+
+void cBot::UpdateView(int a_ChunkX, int a_ChunkZ, Int64 a_Now, Int64 a_Since)
+{
+	m_ChunkX = a_ChunkX;
+	m_ChunkZ = a_ChunkZ;
+	int ViewDistance = m_Settings.m_ViewDistance;
+
+	// The chunks that have left the view are not wanted anymore:
+	for (cChunkTimeMap::iterator itr = m_WantedChunks.begin(); itr != m_WantedChunks.end();)
+	{
+		if ((abs(itr->first.first - a_ChunkX) > ViewDistance) || (abs(itr->first.second - a_ChunkZ) > ViewDistance))
+		{
+			m_WantedChunks.erase(itr++);
+			continue;
+		}
+		++itr;
+	}  // for itr - m_WantedChunks[]
+
+	// The server streams a square of chunks around the player:
+	for (int z = a_ChunkZ - ViewDistance; z <= a_ChunkZ + ViewDistance; z++)
+	{
+		for (int x = a_ChunkX - ViewDistance; x <= a_ChunkX + ViewDistance; x++)
+		{
+			cChunkXZ Chunk(x, z);
+			if ((m_LoadedChunks.find(Chunk) == m_LoadedChunks.end()) && (m_WantedChunks.find(Chunk) == m_WantedChunks.end()))
+			{
+				m_WantedChunks[Chunk] = a_Since;
+			}
+		}  // for x
+	}  // for z
+	CheckViewComplete(a_Now);
+}
+
+
+
+
+
+void cBot::CheckViewComplete(Int64 a_Now)
+{
+	if (!m_WantedChunks.empty())
+	{
+		if ((m_Stats.m_InitialViewTime >= 0) && (m_GapStart < 0))
+		{
+			m_GapStart = a_Now;
+		}
+		return;
+	}
+	if (m_Stats.m_InitialViewTime < 0)
+	{
+		m_Stats.m_InitialViewTime = a_Now - m_ConnectTime;
+	}
+	else if (m_GapStart >= 0)
+	{
+		m_Stats.m_ViewGaps.push_back((int)(a_Now - m_GapStart));
+		m_GapStart = -1;
+	}
+}
+
+
+
+
+
+void cBot::CalcPathPos(Int64 a_Now)
+{
+	double Distance = m_Settings.m_Speed * (double)(a_Now - m_PathStart) / 1000;
+	double Radius = std::max(m_Settings.m_PathRadius, 1.0);
+	double Direction = m_Index * DIRECTION_STEP;
+	double DirX = cos(Direction), DirZ = sin(Direction);
+	switch (m_Settings.m_Path)
+	{
+		case sBotSettings::pathLine:
+		{
+			m_PosX = m_OriginX + DirX * Distance;
+			m_PosZ = m_OriginZ + DirZ * Distance;
+			break;
+		}
+		case sBotSettings::pathCircle:
+		{
+			// The circle's center is chosen so that the bot starts at the origin:
+			double Angle = Direction + Distance / Radius;
+			m_PosX = m_OriginX - DirX * Radius + cos(Angle) * Radius;
+			m_PosZ = m_OriginZ - DirZ * Radius + sin(Angle) * Radius;
+			break;
+		}
+		case sBotSettings::pathShuttle:
+		{
+			double Along = fmod(Distance, 2 * Radius);
+			if (Along > Radius)
+			{
+				Along = 2 * Radius - Along;
+			}
+			m_PosX = m_OriginX + DirX * Along;
+			m_PosZ = m_OriginZ + DirZ * Along;
+			break;
+		}
+		case sBotSettings::pathStill:
+		{
+			m_PosX = m_OriginX;
+			m_PosZ = m_OriginZ;
+			break;
+		}
+	}
+}
+
+
+
+
+
+void cBot::SendPacket(cByteBuffer & a_Body)
+{
+	if (!IsConnected())
+	{
+		return;
+	}
+	AString Body;
+	a_Body.ReadAll(Body);
+	cByteBuffer Length(8);
+	Length.WriteVarInt((UInt32)Body.size());
+	AString Packet;
+	Length.ReadAll(Packet);
+	Packet.append(Body);
+
+	const char * Data = Packet.data();
+	int NumLeft = (int)Packet.size();
+	while (NumLeft > 0)
+	{
+		int NumSent = m_Socket.Send(Data, NumLeft);
+		if (NumSent <= 0)
+		{
+			Disconnect(Printf("Sending failed: %s", cSocket::GetLastErrorString().c_str()));
+			return;
+		}
+		Data += NumSent;
+		NumLeft -= NumSent;
+	}
+	m_Stats.m_NumBytesSent += Packet.size();
+}
+
+
+
+
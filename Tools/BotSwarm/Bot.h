@@ -0,0 +1,192 @@
+
+// Bot.h
+
+// Declares the cBot class representing a single headless client of BotSwarm, walking along a scripted path and timing the chunks it receives
+
+
+
+
+
+#pragma once
+
+#include "OSSupport/Socket.h"
+
+
+
+
+
+class cByteBuffer;
+
+
+
+
+
+/** The settings shared by all the bots of the swarm */
+struct sBotSettings
+{
+	enum ePath
+	{
+		pathLine,     ///< Walk straight away from the spawn, each bot in a different direction; the server keeps generating new chunks
+		pathCircle,   ///< Walk around a circle starting at the spawn; the chunks are reused after the first lap
+		pathShuttle,  ///< Walk away from the spawn and back again; the chunks are reused after the first trip
+		pathStill,    ///< Stay at the spawn, only the login and the initial chunks are measured
+	} ;
+
+	AString m_ServerAddress;
+	unsigned short m_ServerPort;
+	int     m_ProtocolVersion;
+	int     m_ViewDistance;  ///< The server's view distance; the server decides it, the bots only need it to know which chunks to expect
+	ePath   m_Path;
+	double  m_Speed;         ///< Walking speed, in blocks per second
+	double  m_PathRadius;    ///< Radius of the circle, or the length of the shuttle trip, in blocks
+
+	sBotSettings(void) :
+		m_ServerAddress("localhost"),
+		m_ServerPort(25565),
+		m_ProtocolVersion(4),  // 1.7.2
+		m_ViewDistance(10),
+		m_Path(pathLine),
+		m_Speed(4.3),
+		m_PathRadius(64)
+	{
+	}
+} ;
+
+
+
+
+
+class cBot
+{
+public:
+	/** The statistics of a single bot; the chunk latencies are all the samples so far */
+	struct sStats
+	{
+		Int64 m_LoginTime;        ///< Msec from connecting until the server spawned the player, -1 if not spawned
+		Int64 m_InitialViewTime;  ///< Msec from connecting until all the chunks around the spawn arrived, -1 if not yet
+		std::vector<int> m_ChunkLatencies;  ///< Msec from each chunk coming into view while walking until it arrived
+		std::vector<int> m_ViewGaps;        ///< Msec for which the view had missing chunks while walking, one per gap
+		int   m_NumChunksReceived;
+		int   m_NumChunksUnloaded;
+		int   m_NumChunksUnexpected;  ///< Chunks that arrived while already loaded or outside the view distance
+		int   m_NumChunkCrossings;    ///< Number of chunk borders crossed while walking
+		Int64 m_NumChunkBytes;        ///< Bytes received in the chunk packets
+		Int64 m_NumBytesReceived;
+		Int64 m_NumBytesSent;
+
+		sStats(void) :
+			m_LoginTime(-1),
+			m_InitialViewTime(-1),
+			m_NumChunksReceived(0),
+			m_NumChunksUnloaded(0),
+			m_NumChunksUnexpected(0),
+			m_NumChunkCrossings(0),
+			m_NumChunkBytes(0),
+			m_NumBytesReceived(0),
+			m_NumBytesSent(0)
+		{
+		}
+	} ;
+
+	cBot(const sBotSettings & a_Settings, const AString & a_UserName, int a_Index);
+	~cBot();
+
+	/** Connects to the server and logs in. Returns false if the connection fails */
+	bool Connect(Int64 a_Now);
+
+	/** Closes the connection, if still open; a_Reason is reported in the summary */
+	void Disconnect(const AString & a_Reason);
+
+	bool IsConnected(void) const { return m_Socket.IsValid(); }
+
+	/** Returns true if the server has spawned the player */
+	bool HasSpawned(void) const { return (m_Stats.m_LoginTime >= 0); }
+
+	cSocket::xSocket GetSocket(void) const { return m_Socket.GetSocket(); }
+
+	/** Receives the data waiting on the socket and handles the complete packets. Disconnects on error */
+	void ReceiveData(Int64 a_Now);
+
+	/** Moves the bot along its path and sends the position update, if due. Disconnects on error */
+	void Tick(Int64 a_Now);
+
+	/** Returns the time when Tick() next has something to send, -1 if nothing is scheduled */
+	Int64 GetNextTickTime(void) const;
+
+	/** Returns the number of chunks in view that haven't arrived yet */
+	int GetNumChunksMissing(void) const { return (int)m_WantedChunks.size(); }
+
+	const sStats &  GetStats(void) const { return m_Stats; }
+	const AString & GetDisconnectReason(void) const { return m_DisconnectReason; }
+
+protected:
+	enum eState
+	{
+		stDisconnected,
+		stLoggingIn,  ///< The login has been sent, waiting for the Login Success packet
+		stSpawning,   ///< In the game, waiting for the first Player Position And Look packet from the server
+		stWalking,    ///< Walking along the path
+	} ;
+
+	typedef std::pair<int, int> cChunkXZ;
+	typedef std::set<cChunkXZ> cChunkSet;
+	typedef std::map<cChunkXZ, Int64> cChunkTimeMap;
+
+	const sBotSettings & m_Settings;
+	AString m_UserName;
+	int     m_Index;  ///< Index of the bot in the swarm, used to spread the bots' paths
+	cSocket m_Socket;
+	eState  m_State;
+
+	/** The data received from the server that hasn't been handled yet, waiting for the rest of the packet */
+	AString m_IncomingData;
+
+	// The path:
+	double m_OriginX, m_OriginZ;  ///< The position where the path started (the spawn, or where the server teleported the bot)
+	double m_PosX, m_PosY, m_PosZ;
+	Int64  m_PathStart;           ///< Time when the bot started walking the path from the origin
+	Int64  m_NextMoveTime;
+
+	// The chunks:
+	int m_ChunkX, m_ChunkZ;        ///< The chunk the bot is in, as last reported to the server
+	cChunkSet     m_LoadedChunks;  ///< The chunks that the server has sent and not unloaded yet
+	cChunkTimeMap m_WantedChunks;  ///< The chunks in view that haven't arrived yet, with the time since when they have been in view
+	Int64 m_GapStart;              ///< Time when m_WantedChunks last became non-empty while walking
+
+	// Statistics:
+	sStats  m_Stats;
+	AString m_DisconnectReason;
+	Int64   m_ConnectTime;
+	Int64   m_SpawnTime;  ///< Time when the server spawned the player, -1 if not yet
+
+	/** Handles a single complete packet from the server; a_Packet contains the packet without its length */
+	void HandlePacket(const AString & a_Packet, Int64 a_Now);
+
+	/** Handles the Player Position And Look packet, the server spawns or teleports the player */
+	void HandlePlayerPosLook(cByteBuffer & a_Packet, Int64 a_Now);
+
+	/** Handles the Chunk Data packet, a single chunk or its unloading */
+	void HandleChunkData(cByteBuffer & a_Packet, Int64 a_Now, int a_PacketSize);
+
+	/** Handles the Map Chunk Bulk packet, several chunks at once */
+	void HandleMapChunkBulk(cByteBuffer & a_Packet, Int64 a_Now, int a_PacketSize);
+
+	/** Marks the chunk as loaded and records how long it has been waited for */
+	void ChunkArrived(int a_ChunkX, int a_ChunkZ, Int64 a_Now);
+
+	/** Updates the wanted chunks after the bot has moved into the chunk, the new chunks in view are wanted since a_Since */
+	void UpdateView(int a_ChunkX, int a_ChunkZ, Int64 a_Now, Int64 a_Since);
+
+	/** Records the initial view time or the end of a view gap if no chunks are missing, or the start of a gap if some are */
+	void CheckViewComplete(Int64 a_Now);
+
+	/** Sets m_PosX and m_PosZ to where the path leads at a_Now */
+	void CalcPathPos(Int64 a_Now);
+
+	/** Sends the packet whose type and data are in a_Body, prefixed with its length */
+	void SendPacket(cByteBuffer & a_Body);
+} ;
+
+
+
+
@@ -0,0 +1,458 @@
+
+// BotSwarm.cpp
+
+// Implements the main app entrypoint of BotSwarm, the benchmark logging in many headless bots that walk around and time the chunks they receive
+
+/*
+The bots speak the 1.7 protocol (cProtocol172). They log in one after another, then each walks along a scripted path
+at a constant speed, sending its position each tick like the game client. Each bot tracks which chunks are within
+the server's view distance and times how long each chunk takes to arrive after it has come into view. The server
+must run with the authentication disabled (Authenticate=0 in settings.ini); its view distance must be passed to the bots,
+the server doesn't tell it and ignores the client's.
+If the RCON port and password are given, the server's "netstats", "tickstats" and "chunkstats" are queried periodically
+and logged into the metrics file, so that the server-side queues can be matched with the bots' numbers.
+
+The report contains:
+	- the login time, from connecting until the server spawned the player;
+	- the initial view time, from connecting until all the chunks in view have arrived;
+	- the chunk latency, from a chunk coming into view while walking until it arrives;
+	- the view gaps, the periods for which some chunks in view were missing;
+	- the data volume of the chunks and of the rest of the traffic.
+*/
+
+#include "Globals.h"
+#include "BotThread.h"
+#include "ServerMonitor.h"
+#include "OSSupport/Timer.h"
+
+#ifndef _WIN32
+	#include <sys/resource.h>
+	#include <limits.h>
+#endif
+
+
+
+
+
+/** Number of msec between the progress reports and between the server stats queries */
+#define REPORT_INTERVAL 10000
+
+/** Number of msec between the start of the program and the first login, for the threads to start */
+#define START_DELAY 100
+
+
+
+
+
+typedef std::vector<cBotThread *> cBotThreads;
+
+
+
+
+
+/** Returns the a_Percentile-th percentile of the (sorted) values */
+static int GetPercentile(const std::vector<int> & a_SortedValues, int a_Percentile)
+{
+	if (a_SortedValues.empty())
+	{
+		return 0;
+	}
+	return a_SortedValues[(a_SortedValues.size() - 1) * a_Percentile / 100];
+}
+
+
+
+
+
+/** Collects the stats of all the bots, for the progress report or the summary */
+class cStatsCollector :
+	public cItemCallback<cBot>
+{
+public:
+	int m_NumBots;
+	int m_NumSpawned;
+	int m_NumConnected;
+	int m_NumChunksMissing;
+	Int64 m_TotalLoginTime, m_MaxLoginTime;
+	cBot::sStats m_Totals;  ///< Sums of the counters; the vectors contain the samples of all the bots
+	std::vector<int> m_InitialViewTimes;
+	std::map<AString, int> m_DisconnectReasons;
+
+	/** Number of the chunk latencies of each bot already collected; if given, only the new samples are collected */
+	std::map<const cBot *, size_t> * m_NumLatenciesCollected;
+
+	cStatsCollector(std::map<const cBot *, size_t> * a_NumLatenciesCollected) :
+		m_NumBots(0),
+		m_NumSpawned(0),
+		m_NumConnected(0),
+		m_NumChunksMissing(0),
+		m_TotalLoginTime(0),
+		m_MaxLoginTime(0),
+		m_NumLatenciesCollected(a_NumLatenciesCollected)
+	{
+	}
+
+	/** Collects the stats of the bots of all the threads */
+	void Collect(const cBotThreads & a_Threads)
+	{
+		for (cBotThreads::const_iterator itr = a_Threads.begin(); itr != a_Threads.end(); ++itr)
+		{
+			(*itr)->ForEachBot(*this);
+		}
+		std::sort(m_Totals.m_ChunkLatencies.begin(), m_Totals.m_ChunkLatencies.end());
+		std::sort(m_Totals.m_ViewGaps.begin(), m_Totals.m_ViewGaps.end());
+		std::sort(m_InitialViewTimes.begin(), m_InitialViewTimes.end());
+	}
+
+protected:
+	virtual bool Item(cBot * a_Bot) override
+	{
+		const cBot::sStats & Stats = a_Bot->GetStats();
+		m_NumBots++;
+		if (a_Bot->IsConnected())
+		{
+			m_NumConnected++;
+			m_NumChunksMissing += a_Bot->GetNumChunksMissing();
+		}
+		else if (!a_Bot->GetDisconnectReason().empty())
+		{
+			m_DisconnectReasons[a_Bot->GetDisconnectReason()] += 1;
+		}
+		if (a_Bot->HasSpawned())
+		{
+			m_NumSpawned++;
+			m_TotalLoginTime += Stats.m_LoginTime;
+			m_MaxLoginTime = std::max(m_MaxLoginTime, Stats.m_LoginTime);
+		}
+		if (Stats.m_InitialViewTime >= 0)
+		{
+			m_InitialViewTimes.push_back((int)Stats.m_InitialViewTime);
+		}
+
+		size_t FirstLatency = 0;
+		if (m_NumLatenciesCollected != NULL)
+		{
+			FirstLatency = (*m_NumLatenciesCollected)[a_Bot];
+			(*m_NumLatenciesCollected)[a_Bot] = Stats.m_ChunkLatencies.size();
+		}
+		m_Totals.m_ChunkLatencies.insert(m_Totals.m_ChunkLatencies.end(), Stats.m_ChunkLatencies.begin() + FirstLatency, Stats.m_ChunkLatencies.end());
+		m_Totals.m_ViewGaps.insert(m_Totals.m_ViewGaps.end(), Stats.m_ViewGaps.begin(), Stats.m_ViewGaps.end());
+		m_Totals.m_NumChunksReceived   += Stats.m_NumChunksReceived;
+		m_Totals.m_NumChunksUnloaded   += Stats.m_NumChunksUnloaded;
+		m_Totals.m_NumChunksUnexpected += Stats.m_NumChunksUnexpected;
+		m_Totals.m_NumChunkCrossings   += Stats.m_NumChunkCrossings;
+		m_Totals.m_NumChunkBytes       += Stats.m_NumChunkBytes;
+		m_Totals.m_NumBytesReceived    += Stats.m_NumBytesReceived;
+		m_Totals.m_NumBytesSent        += Stats.m_NumBytesSent;
+		return false;
+	}
+} ;
+
+
+
+
+
+/** Prints the progress line: the bots walking and the chunks received since the last report */
+static void PrintProgress(const cBotThreads & a_Threads, Int64 a_Elapsed, Int64 a_Interval, std::map<const cBot *, size_t> & a_NumLatenciesReported, cBot::sStats & a_LastTotals)
+{
+	cStatsCollector Stats(&a_NumLatenciesReported);
+	Stats.Collect(a_Threads);
+	double Seconds = (double)std::max(a_Interval, 1LL) / 1000;
+	printf("[%4d s] %d bots playing, %d chunks missing; %.0f chunks/s, latency median %d msec, 95th %d msec; chunk data %.2f MiB/s, other %.1f KiB/s\n",
+		(int)(a_Elapsed / 1000), Stats.m_NumConnected, Stats.m_NumChunksMissing,
+		(Stats.m_Totals.m_NumChunksReceived - a_LastTotals.m_NumChunksReceived) / Seconds,
+		GetPercentile(Stats.m_Totals.m_ChunkLatencies, 50), GetPercentile(Stats.m_Totals.m_ChunkLatencies, 95),
+		(double)(Stats.m_Totals.m_NumChunkBytes - a_LastTotals.m_NumChunkBytes) / 1024 / 1024 / Seconds,
+		(double)(
+			(Stats.m_Totals.m_NumBytesReceived - Stats.m_Totals.m_NumChunkBytes) -
+			(a_LastTotals.m_NumBytesReceived - a_LastTotals.m_NumChunkBytes)
+		) / 1024 / Seconds
+	);
+	a_LastTotals.m_NumChunksReceived = Stats.m_Totals.m_NumChunksReceived;
+	a_LastTotals.m_NumChunkBytes     = Stats.m_Totals.m_NumChunkBytes;
+	a_LastTotals.m_NumBytesReceived  = Stats.m_Totals.m_NumBytesReceived;
+}
+
+
+
+
+
+/** Prints the summary of the whole run */
+static void PrintSummary(const cBotThreads & a_Threads, Int64 a_Duration)
+{
+	cStatsCollector Stats(NULL);
+	Stats.Collect(a_Threads);
+	const cBot::sStats & Totals = Stats.m_Totals;
+	double Seconds = (double)std::max(a_Duration, 1LL) / 1000;
+
+	printf("\nSummary of %d bots over %.0f seconds:\n", Stats.m_NumBots, Seconds);
+	int NumDisconnected = 0;
+	for (std::map<AString, int>::const_iterator itr = Stats.m_DisconnectReasons.begin(); itr != Stats.m_DisconnectReasons.end(); ++itr)
+	{
+		NumDisconnected += itr->second;
+	}
+	printf("  spawned: %d, disconnected before the end: %d\n", Stats.m_NumSpawned, NumDisconnected);
+	for (std::map<AString, int>::const_iterator itr = Stats.m_DisconnectReasons.begin(); itr != Stats.m_DisconnectReasons.end(); ++itr)
+	{
+		printf("    %4d x %s\n", itr->second, itr->first.c_str());
+	}
+	printf("  login time: average %d msec, max %d msec\n",
+		(Stats.m_NumSpawned > 0) ? (int)(Stats.m_TotalLoginTime / Stats.m_NumSpawned) : 0, (int)Stats.m_MaxLoginTime
+	);
+	printf("  initial view time: median %d msec, 95th percentile %d msec, max %d msec (%d bots have never had all the chunks)\n",
+		GetPercentile(Stats.m_InitialViewTimes, 50), GetPercentile(Stats.m_InitialViewTimes, 95), GetPercentile(Stats.m_InitialViewTimes, 100),
+		Stats.m_NumSpawned - (int)Stats.m_InitialViewTimes.size()
+	);
+	printf("  chunk latency while walking: median %d msec, 95th percentile %d msec, 99th percentile %d msec, max %d msec (%d chunks)\n",
+		GetPercentile(Totals.m_ChunkLatencies, 50), GetPercentile(Totals.m_ChunkLatencies, 95),
+		GetPercentile(Totals.m_ChunkLatencies, 99), GetPercentile(Totals.m_ChunkLatencies, 100),
+		(int)Totals.m_ChunkLatencies.size()
+	);
+	printf("  view gaps: %d, median %d msec, 95th percentile %d msec, max %d msec; %d chunks still missing at the end\n",
+		(int)Totals.m_ViewGaps.size(), GetPercentile(Totals.m_ViewGaps, 50), GetPercentile(Totals.m_ViewGaps, 95),
+		GetPercentile(Totals.m_ViewGaps, 100), Stats.m_NumChunksMissing
+	);
+	printf("  chunks: %d received, %d unloaded, %d unexpected (already loaded or out of view); %d chunk borders crossed\n",
+		Totals.m_NumChunksReceived, Totals.m_NumChunksUnloaded, Totals.m_NumChunksUnexpected, Totals.m_NumChunkCrossings
+	);
+	printf("  chunk data: %.1f MiB, %.1f KiB per chunk, %.2f MiB/s (%.1f KiB/s per bot)\n",
+		(double)Totals.m_NumChunkBytes / 1024 / 1024,
+		(Totals.m_NumChunksReceived > 0) ? ((double)Totals.m_NumChunkBytes / 1024 / Totals.m_NumChunksReceived) : 0.0,
+		(double)Totals.m_NumChunkBytes / 1024 / 1024 / Seconds,
+		(double)Totals.m_NumChunkBytes / 1024 / Seconds / std::max(Stats.m_NumBots, 1)
+	);
+	printf("  other traffic: %.1f KiB/s received, %.1f KiB/s sent\n",
+		(double)(Totals.m_NumBytesReceived - Totals.m_NumChunkBytes) / 1024 / Seconds,
+		(double)Totals.m_NumBytesSent / 1024 / Seconds
+	);
+}
+
+
+
+
+
+/** Raises the limit of the open files to the maximum, each bot needs a socket. Returns the new limit, -1 if unlimited or unknown */
+static int RaiseSocketLimit(void)
+{
+	#ifdef _WIN32
+		return -1;
+	#else
+		rlimit Limit;
+		if (getrlimit(RLIMIT_NOFILE, &Limit) != 0)
+		{
+			return -1;
+		}
+		Limit.rlim_cur = Limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &Limit);
+		getrlimit(RLIMIT_NOFILE, &Limit);
+		return (Limit.rlim_cur == RLIM_INFINITY) ? -1 : (int)std::min(Limit.rlim_cur, (rlim_t)INT_MAX);
+	#endif
+}
+
+
+
+
+
+/** Replaces a host name with its IP address, so that the bot threads don't resolve it concurrently. Returns false if it can't be resolved */
+static bool ResolveAddress(AString & a_Address)
+{
+	if (inet_addr(a_Address.c_str()) != INADDR_NONE)
+	{
+		return true;
+	}
+	hostent * Host = gethostbyname(a_Address.c_str());
+	if ((Host == NULL) || (Host->h_addrtype != AF_INET))
+	{
+		return false;
+	}
+	in_addr Addr;
+	memcpy(&Addr, Host->h_addr, sizeof(Addr));
+	a_Address = inet_ntoa(Addr);
+	return true;
+}
+
+
+
+
+
+static const char * PathToString(sBotSettings::ePath a_Path)
+{
+	switch (a_Path)
+	{
+		case sBotSettings::pathLine:    return "line";
+		case sBotSettings::pathCircle:  return "circle";
+		case sBotSettings::pathShuttle: return "shuttle";
+		case sBotSettings::pathStill:   return "still";
+	}
+	return "unknown";
+}
+
+
+
+
+
+static void PrintUsage(const char * a_ProgramName)
+{
+	printf("Usage: %s [options]\n", a_ProgramName);
+	printf("  -s, --server <address>      The server to connect to (localhost)\n");
+	printf("  -p, --port <port>           The server's game port (25565)\n");
+	printf("  -n, --bots <count>          Number of bots (100)\n");
+	printf("  -t, --time <seconds>        Duration of the benchmark (60)\n");
+	printf("  -i, --interval <msec>       Time between two logins (50)\n");
+	printf("  --path <line|circle|shuttle|still>  The path the bots walk (line)\n");
+	printf("  --speed <blocks per second> Walking speed (4.3; sprinting 5.6, flying 10.9)\n");
+	printf("  --radius <blocks>           Radius of the circle or length of the shuttle (64)\n");
+	printf("  --viewdistance <chunks>     The server's view distance, DefaultViewDistance in settings.ini (10)\n");
+	printf("  --protocol <version>        Protocol version sent in the handshake (4, that is 1.7.2)\n");
+	printf("  --rcon-port <port>          The server's RCON port; if given, the server stats are queried\n");
+	printf("  --rcon-password <password>  The RCON password\n");
+	printf("  --metrics <file>            Where to log the server stats (BotSwarmMetrics.txt)\n");
+}
+
+
+
+
+
+int main(int argc, char * argv[])
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+
+	// Parse the cmdline:
+	sBotSettings Settings;
+	int NumBots = 100, Duration = 60, LoginInterval = 50, RCONPort = -1;
+	AString RCONPassword, MetricsFileName = "BotSwarmMetrics.txt";
+	for (int i = 1; i < argc; i++)
+	{
+		AString Arg = argv[i];
+		if ((i == argc - 1) || (Arg == "-h") || (Arg == "--help"))
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+		AString Value = argv[++i];
+		if      ((Arg == "-s") || (Arg == "--server"))   { Settings.m_ServerAddress = Value; }
+		else if ((Arg == "-p") || (Arg == "--port"))     { Settings.m_ServerPort = (unsigned short)atoi(Value.c_str()); }
+		else if ((Arg == "-n") || (Arg == "--bots"))     { NumBots = atoi(Value.c_str()); }
+		else if ((Arg == "-t") || (Arg == "--time"))     { Duration = atoi(Value.c_str()); }
+		else if ((Arg == "-i") || (Arg == "--interval")) { LoginInterval = atoi(Value.c_str()); }
+		else if (Arg == "--speed")         { Settings.m_Speed = atof(Value.c_str()); }
+		else if (Arg == "--radius")        { Settings.m_PathRadius = atof(Value.c_str()); }
+		else if (Arg == "--viewdistance")  { Settings.m_ViewDistance = atoi(Value.c_str()); }
+		else if (Arg == "--protocol")      { Settings.m_ProtocolVersion = atoi(Value.c_str()); }
+		else if (Arg == "--rcon-port")     { RCONPort = atoi(Value.c_str()); }
+		else if (Arg == "--rcon-password") { RCONPassword = Value; }
+		else if (Arg == "--metrics")       { MetricsFileName = Value; }
+		else if (Arg == "--path")
+		{
+			if      (Value == "line")    { Settings.m_Path = sBotSettings::pathLine; }
+			else if (Value == "circle")  { Settings.m_Path = sBotSettings::pathCircle; }
+			else if (Value == "shuttle") { Settings.m_Path = sBotSettings::pathShuttle; }
+			else if (Value == "still")   { Settings.m_Path = sBotSettings::pathStill; }
+			else
+			{
+				printf("Unknown path \"%s\"\n", Value.c_str());
+				return 1;
+			}
+		}
+		else
+		{
+			printf("Unknown option \"%s\"\n", Arg.c_str());
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	cSocket::WSAStartup();
+	if (!ResolveAddress(Settings.m_ServerAddress))
+	{
+		printf("Cannot resolve the server address \"%s\"\n", Settings.m_ServerAddress.c_str());
+		return 1;
+	}
+	int SocketLimit = RaiseSocketLimit();
+	if ((SocketLimit >= 0) && (NumBots + 32 > SocketLimit))
+	{
+		printf("Warning: the process can open only %d sockets, raise the limit (ulimit -n) for %d bots\n", SocketLimit, NumBots);
+	}
+
+	// Start the server monitor first, so that its socket is among the first ones:
+	cTimer Timer;
+	Int64 Start = Timer.GetNowTime() + START_DELAY;
+	cServerMonitor Monitor;
+	if (RCONPort > 0)
+	{
+		AStringVector Commands;
+		Commands.push_back("netstats");
+		Commands.push_back("tickstats");
+		Commands.push_back("chunkstats");
+		AString Error;
+		if (!Monitor.Start(Settings.m_ServerAddress, (unsigned short)RCONPort, RCONPassword, Commands, REPORT_INTERVAL, MetricsFileName, Start, Error))
+		{
+			printf("Cannot query the server stats: %s\n", Error.c_str());
+			return 1;
+		}
+	}
+
+	// Distribute the bots among the threads, the logins are scheduled in the order of the bots:
+	cBotThreads Threads;
+	for (int i = 0; i < NumBots; i++)
+	{
+		if (Threads.empty() || !Threads.back()->HasRoom())
+		{
+			Threads.push_back(new cBotThread);
+		}
+		Threads.back()->AddBot(new cBot(Settings, Printf("Bot%d", i), i), Start + (Int64)i * LoginInterval);
+	}
+	printf("Running %d bots in %d threads for %d seconds against %s:%d, walking the %s path at %.1f blocks/s, view distance %d\n",
+		NumBots, (int)Threads.size(), Duration, Settings.m_ServerAddress.c_str(), (int)Settings.m_ServerPort,
+		PathToString(Settings.m_Path),
+		Settings.m_Speed, Settings.m_ViewDistance
+	);
+	for (cBotThreads::iterator itr = Threads.begin(); itr != Threads.end(); ++itr)
+	{
+		(*itr)->Start();
+	}
+
+	// Report the progress until the time's up:
+	std::map<const cBot *, size_t> NumLatenciesReported;
+	cBot::sStats LastTotals;
+	Int64 End = Start + (Int64)Duration * 1000;
+	Int64 LastReport = Start;
+	for (;;)
+	{
+		Int64 Now = Timer.GetNowTime();
+		if (Now >= End)
+		{
+			break;
+		}
+		cSleep::MilliSleep((unsigned)std::max(std::min(End - Now, LastReport + REPORT_INTERVAL - Now), 0LL));
+		Now = Timer.GetNowTime();
+		if (Now >= LastReport + REPORT_INTERVAL)
+		{
+			PrintProgress(Threads, Now - Start, Now - LastReport, NumLatenciesReported, LastTotals);
+			LastReport = Now;
+		}
+	}
+
+	// Stop the bots, then the monitor, so that its last query covers the whole run:
+	for (cBotThreads::iterator itr = Threads.begin(); itr != Threads.end(); ++itr)
+	{
+		(*itr)->Stop();
+	}
+	Monitor.Stop();
+	PrintSummary(Threads, Timer.GetNowTime() - Start);
+	if (RCONPort > 0)
+	{
+		printf("\nServer stats at the end (all the queries are in %s):\n%s%s",
+			MetricsFileName.c_str(), Monitor.GetLastOutput("netstats").c_str(), Monitor.GetLastOutput("tickstats").c_str()
+		);
+	}
+	for (cBotThreads::iterator itr = Threads.begin(); itr != Threads.end(); ++itr)
+	{
+		delete *itr;
+	}
+	return 0;
+}
+
+
+
+
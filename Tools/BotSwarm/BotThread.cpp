@@ -0,0 +1,210 @@
+
+// BotThread.cpp
+
+// Implements the cBotThread class representing a thread that runs a group of bots, waiting on all their sockets at once
+
+#include "Globals.h"
+#include "BotThread.h"
+
+#ifndef _WIN32
+	#include <poll.h>
+#endif
+
+
+
+
+
+/** The longest msec the thread waits for the sockets, so that it notices the termination request */
+#define MAX_WAIT 100
+
+
+
+
+
+cBotThread::cBotThread(void) :
+	super("cBotThread"),
+	m_CS("cBotThread"),
+	m_NumConnected(0)
+{
+}
+
+
+
+
+
+cBotThread::~cBotThread()
+{
+	Stop();
+	for (cBots::iterator itr = m_Bots.begin(); itr != m_Bots.end(); ++itr)
+	{
+		delete *itr;
+	}
+}
+
+
+
+
+
+void cBotThread::AddBot(cBot * a_Bot, Int64 a_ConnectTime)
+{
+	ASSERT(HasRoom());
+	ASSERT(m_ConnectTimes.empty() || (m_ConnectTimes.back() <= a_ConnectTime));
+	m_Bots.push_back(a_Bot);
+	m_ConnectTimes.push_back(a_ConnectTime);
+}
+
+
+
+
+
+bool cBotThread::Start(void)
+{
+	m_ShouldTerminate = false;
+	return super::Start();
+}
+
+
+
+
+
+bool cBotThread::ForEachBot(cItemCallback<cBot> & a_Callback)
+{
+	cCSLock Lock(m_CS);
+	for (cBots::iterator itr = m_Bots.begin(); itr != m_Bots.end(); ++itr)
+	{
+		if (a_Callback.Item(*itr))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+
+
+void cBotThread::Execute(void)
+{
+	cBots Readable;
+	while (!m_ShouldTerminate)
+	{
+		// Connect the bots that are due; the connection is blocking, the following bots wait for it:
+		Int64 Now = m_Timer.GetNowTime();
+		while ((m_NumConnected < m_Bots.size()) && (m_ConnectTimes[m_NumConnected] <= Now))
+		{
+			cCSLock Lock(m_CS);
+			m_Bots[m_NumConnected]->Connect(Now);
+			m_NumConnected++;
+		}
+
+		// Wait for the data from the server or for the next thing to send, whichever comes first:
+		Int64 Wakeup = Now + MAX_WAIT;
+		if (m_NumConnected < m_Bots.size())
+		{
+			Wakeup = std::min(Wakeup, m_ConnectTimes[m_NumConnected]);
+		}
+		for (size_t i = 0; i < m_NumConnected; i++)
+		{
+			Int64 NextTick = m_Bots[i]->GetNextTickTime();
+			if (NextTick >= 0)
+			{
+				Wakeup = std::min(Wakeup, NextTick);
+			}
+		}
+		WaitForData(std::max(Wakeup - Now, 0LL), Readable);
+
+		// Process the bots:
+		Now = m_Timer.GetNowTime();
+		cCSLock Lock(m_CS);
+		for (cBots::iterator itr = Readable.begin(); itr != Readable.end(); ++itr)
+		{
+			(*itr)->ReceiveData(Now);
+		}
+		for (size_t i = 0; i < m_NumConnected; i++)
+		{
+			if (m_Bots[i]->IsConnected())
+			{
+				m_Bots[i]->Tick(Now);
+			}
+		}
+	}  // while (!m_ShouldTerminate)
+}
+
+
+
+
+
+void cBotThread::WaitForData(Int64 a_Timeout, cBots & a_Readable)
+{
+	a_Readable.clear();
+
+	#ifdef _WIN32
+		// select() on Windows takes up to FD_SETSIZE sockets, regardless of their values:
+		fd_set ReadFDs;
+		FD_ZERO(&ReadFDs);
+		for (size_t i = 0; i < m_NumConnected; i++)
+		{
+			if (m_Bots[i]->IsConnected())
+			{
+				FD_SET(m_Bots[i]->GetSocket(), &ReadFDs);
+			}
+		}
+		timeval Timeout;
+		Timeout.tv_sec = (long)(a_Timeout / 1000);
+		Timeout.tv_usec = (long)(a_Timeout % 1000) * 1000;
+		if (ReadFDs.fd_count == 0)
+		{
+			// Windows' select() fails on empty sets
+			cSleep::MilliSleep((unsigned)a_Timeout);
+			return;
+		}
+		if (select(0, &ReadFDs, NULL, NULL, &Timeout) <= 0)
+		{
+			return;
+		}
+		for (size_t i = 0; i < m_NumConnected; i++)
+		{
+			if (m_Bots[i]->IsConnected() && FD_ISSET(m_Bots[i]->GetSocket(), &ReadFDs))
+			{
+				a_Readable.push_back(m_Bots[i]);
+			}
+		}
+	#else
+		// select() on POSIX cannot take socket values above FD_SETSIZE, which thousands of bots in a single process exceed:
+		std::vector<pollfd> FDs;
+		cBots Polled;
+		for (size_t i = 0; i < m_NumConnected; i++)
+		{
+			if (m_Bots[i]->IsConnected())
+			{
+				pollfd FD;
+				FD.fd = m_Bots[i]->GetSocket();
+				FD.events = POLLIN;
+				FD.revents = 0;
+				FDs.push_back(FD);
+				Polled.push_back(m_Bots[i]);
+			}
+		}
+		if (FDs.empty())
+		{
+			cSleep::MilliSleep((unsigned)a_Timeout);
+			return;
+		}
+		if (poll(&FDs[0], FDs.size(), (int)a_Timeout) <= 0)
+		{
+			return;
+		}
+		for (size_t i = 0; i < FDs.size(); i++)
+		{
+			if ((FDs[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0)
+			{
+				a_Readable.push_back(Polled[i]);
+			}
+		}
+	#endif
+}
+
+
+
+
@@ -0,0 +1,71 @@
+
+// BotThread.h
+
+// Declares the cBotThread class representing a thread that runs a group of bots, waiting on all their sockets at once
+
+
+
+
+
+#pragma once
+
+#include "Bot.h"
+#include "OSSupport/IsThread.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+/** How many bots should one thread run? On Windows, select() can wait for at most FD_SETSIZE sockets */
+#ifdef _WIN32
+	#define BOTS_PER_THREAD (FD_SETSIZE - 1)
+#else
+	#define BOTS_PER_THREAD 250
+#endif
+
+
+
+
+
+class cBotThread :
+	public cIsThread
+{
+	typedef cIsThread super;
+
+public:
+	cBotThread(void);
+	virtual ~cBotThread();
+
+	/** Adds the bot, to be connected at a_ConnectTime (cTimer msec); takes ownership of the bot. Must be called before Start() */
+	void AddBot(cBot * a_Bot, Int64 a_ConnectTime);
+
+	/** Returns true if another bot can be added to this thread */
+	bool HasRoom(void) const { return (m_Bots.size() < BOTS_PER_THREAD); }
+
+	bool Start(void);
+
+	/** Calls a_Callback for each bot, while the thread isn't processing them. Returns true if all the bots were enumerated */
+	bool ForEachBot(cItemCallback<cBot> & a_Callback);
+
+protected:
+	typedef std::vector<cBot *> cBots;
+
+	/** Protects the bots while this thread processes them */
+	cCriticalSection m_CS;
+
+	cBots              m_Bots;
+	std::vector<Int64> m_ConnectTimes;  ///< The time when each bot of m_Bots is to connect, ascending
+	size_t             m_NumConnected;  ///< Number of bots from the start of m_Bots that have been connected so far
+	cTimer             m_Timer;
+
+	// cIsThread override:
+	virtual void Execute(void) override;
+
+	/** Waits until any connected bot has data to receive, or a_Timeout msec pass. Fills a_Readable with the bots to receive from */
+	void WaitForData(Int64 a_Timeout, cBots & a_Readable);
+} ;
+
+
+
+
@@ -0,0 +1,239 @@
+
+// ServerMonitor.cpp
+
+// Implements the cServerMonitor class representing a thread that periodically queries the server's stats over RCON while the bots run
+
+#include "Globals.h"
+#include "ServerMonitor.h"
+#include "ByteBuffer.h"
+
+
+
+
+
+/** RCON packet types, as in cRCONServer */
+#define RCON_PACKET_COMMAND 2
+#define RCON_PACKET_LOGIN   3
+
+/** Number of msec to wait for a RCON response before giving up */
+#define RESPONSE_TIMEOUT 10000
+
+/** Number of msec the thread sleeps at once while waiting for the next query, so that it notices the termination request */
+#define SLEEP_STEP 100
+
+
+
+
+
+cServerMonitor::cServerMonitor(void) :
+	super("cServerMonitor"),
+	m_Interval(0),
+	m_StartTime(0),
+	m_RequestID(1)
+{
+}
+
+
+
+
+
+cServerMonitor::~cServerMonitor()
+{
+	Stop();
+}
+
+
+
+
+
+bool cServerMonitor::Start(
+	const AString & a_ServerAddress, unsigned short a_Port, const AString & a_Password,
+	const AStringVector & a_Commands, int a_Interval, const AString & a_LogFileName, Int64 a_StartTime,
+	AString & a_Error
+)
+{
+	m_Commands = a_Commands;
+	m_Interval = a_Interval;
+	m_StartTime = a_StartTime;
+	if (!m_LogFile.Open(a_LogFileName, cFile::fmWrite))
+	{
+		Printf(a_Error, "Cannot open the metrics file \"%s\"", a_LogFileName.c_str());
+		return false;
+	}
+	m_Socket = cSocket::CreateSocket(cSocket::IPv4);
+	if (!m_Socket.IsValid() || !m_Socket.ConnectIPv4(a_ServerAddress, a_Port))
+	{
+		Printf(a_Error, "Cannot connect to the RCON port %d: %s", (int)a_Port, cSocket::GetLastErrorString().c_str());
+		m_Socket.CloseSocket();
+		return false;
+	}
+
+	// The server answers a wrong password with the request ID -1:
+	AString Payload;
+	if (!Request(RCON_PACKET_LOGIN, a_Password, 1, Payload))
+	{
+		a_Error = "The RCON login has failed, check the password";
+		return false;
+	}
+
+	m_ShouldTerminate = false;
+	return super::Start();
+}
+
+
+
+
+
+void cServerMonitor::Stop(void)
+{
+	super::Stop();
+	if (m_Socket.IsValid())
+	{
+		QueryAll();
+		m_Socket.CloseSocket();
+	}
+	m_LogFile.Close();
+}
+
+
+
+
+
+AString cServerMonitor::GetLastOutput(const AString & a_Command)
+{
+	cCSLock Lock(m_CS);
+	std::map<AString, AString>::const_iterator itr = m_LastOutputs.find(a_Command);
+	return (itr == m_LastOutputs.end()) ? AString() : itr->second;
+}
+
+
+
+
+
+void cServerMonitor::Execute(void)
+{
+	Int64 NextQuery = m_Timer.GetNowTime();
+	while (!m_ShouldTerminate && m_Socket.IsValid())
+	{
+		if (m_Timer.GetNowTime() < NextQuery)
+		{
+			cSleep::MilliSleep(SLEEP_STEP);
+			continue;
+		}
+		QueryAll();
+		NextQuery += m_Interval;
+	}
+}
+
+
+
+
+
+void cServerMonitor::QueryAll(void)
+{
+	for (AStringVector::const_iterator itr = m_Commands.begin(); itr != m_Commands.end(); ++itr)
+	{
+		// The server acknowledges the command right away and sends its output in another response once it's executed:
+		Int64 Now = m_Timer.GetNowTime();
+		AString Output;
+		if (!Request(RCON_PACKET_COMMAND, *itr, 2, Output))
+		{
+			m_LogFile.Printf("[%4d s] %s: the server didn't answer, stopping the queries\n", (int)((Now - m_StartTime) / 1000), itr->c_str());
+			return;
+		}
+		m_LogFile.Printf("[%4d s] %s:\n%s\n", (int)((Now - m_StartTime) / 1000), itr->c_str(), Output.c_str());
+		m_LogFile.Flush();
+		cCSLock Lock(m_CS);
+		m_LastOutputs[*itr] = Output;
+	}
+}
+
+
+
+
+
+bool cServerMonitor::Request(int a_Type, const AString & a_Body, int a_NumResponses, AString & a_Payload)
+{
+	// Send the request:
+	int RequestID = m_RequestID++;
+	cByteBuffer Packet((int)a_Body.size() + 32);
+	Packet.WriteLEInt((int)a_Body.size() + 10);
+	Packet.WriteLEInt(RequestID);
+	Packet.WriteLEInt(a_Type);
+	Packet.WriteBuf(a_Body.data(), a_Body.size());
+	Packet.WriteBEShort(0);  // Padding
+	AString Data;
+	Packet.ReadAll(Data);
+	if (m_Socket.Send(Data.data(), (unsigned)Data.size()) != (int)Data.size())
+	{
+		m_Socket.CloseSocket();
+		return false;
+	}
+
+	// Receive the responses:
+	a_Payload.clear();
+	for (int i = 0; i < a_NumResponses; i++)
+	{
+		int ResponseID;
+		AString Payload;
+		if (!ReceiveResponse(ResponseID, Payload) || (ResponseID != RequestID))
+		{
+			m_Socket.CloseSocket();
+			return false;
+		}
+		a_Payload.append(Payload);
+	}
+	return true;
+}
+
+
+
+
+
+bool cServerMonitor::ReceiveResponse(int & a_RequestID, AString & a_Payload)
+{
+	Int64 Deadline = m_Timer.GetNowTime() + RESPONSE_TIMEOUT;
+	for (;;)
+	{
+		// Parse a complete response, if received already; the payload ends with two padding zeroes:
+		cByteBuffer Buffer((int)m_IncomingData.size() + 1);
+		Buffer.Write(m_IncomingData.data(), m_IncomingData.size());
+		int Length, PacketType;
+		if (Buffer.ReadLEInt(Length) && Buffer.CanReadBytes(Length) && (Length >= 10))
+		{
+			Buffer.ReadLEInt(a_RequestID);
+			Buffer.ReadLEInt(PacketType);
+			Buffer.ReadString(a_Payload, Length - 10);
+			m_IncomingData.erase(0, (size_t)Length + 4);
+			return true;
+		}
+
+		// Wait for more data; the monitor connects before the bots, so its socket value fits into an fd_set:
+		Int64 Timeout = Deadline - m_Timer.GetNowTime();
+		if (Timeout <= 0)
+		{
+			return false;
+		}
+		fd_set ReadFDs;
+		FD_ZERO(&ReadFDs);
+		FD_SET(m_Socket.GetSocket(), &ReadFDs);
+		timeval tv;
+		tv.tv_sec = (long)(Timeout / 1000);
+		tv.tv_usec = (long)(Timeout % 1000) * 1000;
+		if (select((int)m_Socket.GetSocket() + 1, &ReadFDs, NULL, NULL, &tv) <= 0)
+		{
+			return false;
+		}
+		char Data[16 KiB];
+		int NumReceived = m_Socket.Receive(Data, sizeof(Data), 0);
+		if (NumReceived <= 0)
+		{
+			return false;
+		}
+		m_IncomingData.append(Data, (size_t)NumReceived);
+	}
+}
+
+
+
+
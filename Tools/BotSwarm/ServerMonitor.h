@@ -0,0 +1,81 @@
+
+// ServerMonitor.h
+
+// Declares the cServerMonitor class representing a thread that periodically queries the server's stats over RCON while the bots run
+
+
+
+
+
+#pragma once
+
+#include "OSSupport/IsThread.h"
+#include "OSSupport/Socket.h"
+#include "OSSupport/Timer.h"
+#include "OSSupport/File.h"
+
+
+
+
+
+class cServerMonitor :
+	public cIsThread
+{
+	typedef cIsThread super;
+
+public:
+	cServerMonitor(void);
+	~cServerMonitor();
+
+	/** Connects to the server's RCON port, logs in and starts querying the commands every a_Interval msec.
+	The outputs are appended to a_LogFileName, each with the msec since a_StartTime (cTimer msec).
+	Returns false and sets a_Error if the connection or the login fails */
+	bool Start(
+		const AString & a_ServerAddress, unsigned short a_Port, const AString & a_Password,
+		const AStringVector & a_Commands, int a_Interval, const AString & a_LogFileName, Int64 a_StartTime,
+		AString & a_Error
+	);
+
+	/** Stops querying, then queries all the commands once more so that the last outputs cover the whole run */
+	void Stop(void);
+
+	/** Returns the last output of the command, empty if it hasn't been queried successfully yet */
+	AString GetLastOutput(const AString & a_Command);
+
+protected:
+	cSocket       m_Socket;
+	AStringVector m_Commands;
+	int           m_Interval;
+	cFile         m_LogFile;
+	Int64         m_StartTime;
+	cTimer        m_Timer;
+
+	/** ID of the next RCON request */
+	int m_RequestID;
+
+	/** The data received from the server that hasn't been parsed into a response yet */
+	AString m_IncomingData;
+
+	/** Protects m_LastOutputs */
+	cCriticalSection m_CS;
+
+	/** The last output of each command */
+	std::map<AString, AString> m_LastOutputs;
+
+	// cIsThread override:
+	virtual void Execute(void) override;
+
+	/** Queries each command and logs its output */
+	void QueryAll(void);
+
+	/** Sends a single RCON request and receives its responses, a_NumResponses of them.
+	Returns false and disconnects on error or if the server doesn't answer in time. a_Payload is set to the responses' payloads */
+	bool Request(int a_Type, const AString & a_Body, int a_NumResponses, AString & a_Payload);
+
+	/** Receives a single RCON response. Returns false if the server doesn't answer in time or on error */
+	bool ReceiveResponse(int & a_RequestID, AString & a_Payload);
+} ;
+
+
+
+
@@ -0,0 +1,169 @@
+
+// ChunkLoadPerformanceTest.cpp
+
+// Measures the speed of decoding Anvil chunks, using all the region files in the specified folder
+
+#include "Globals.h"
+#include "AnvilChunkDecoder.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+/** Statistics collected over all the processed chunks */
+struct sStats
+{
+	int       m_NumChunks;
+	int       m_NumFailed;
+	long long m_CompressedBytes;
+	long long m_InflatedBytes;
+	long long m_BytesCopied;
+
+	sStats(void) :
+		m_NumChunks(0),
+		m_NumFailed(0),
+		m_CompressedBytes(0),
+		m_InflatedBytes(0),
+		m_BytesCopied(0)
+	{
+	}
+} ;
+
+
+
+
+
+/** Decodes all chunks in the specified region file data, adds the results to a_Stats */
+static void ProcessRegionFile(const AString & a_Data, cAnvilChunkDecoder & a_Decoder, sStats & a_Stats)
+{
+	// The destination arrays, same as what cWSSAnvil uses:
+	cChunkDef::BlockTypes   BlockTypes;
+	cChunkDef::BlockNibbles BlockMetas;
+	cChunkDef::BlockNibbles BlockLight;
+	cChunkDef::BlockNibbles SkyLight;
+
+	const Byte * Header = (const Byte *)a_Data.data();
+	for (int i = 0; i < 1024; i++)
+	{
+		int SectorNum = (Header[4 * i] << 16) | (Header[4 * i + 1] << 8) | Header[4 * i + 2];
+		if (SectorNum == 0)
+		{
+			// Chunk not present
+			continue;
+		}
+		size_t Offset = (size_t)SectorNum * (4 KiB);
+		if (Offset + 5 > a_Data.size())
+		{
+			a_Stats.m_NumFailed++;
+			continue;
+		}
+		const Byte * Chunk = (const Byte *)a_Data.data() + Offset;
+		size_t Length = (Chunk[0] << 24) | (Chunk[1] << 16) | (Chunk[2] << 8) | Chunk[3];
+		if ((Length < 1) || (Chunk[4] != 2) || (Offset + 4 + Length > a_Data.size()))
+		{
+			// Invalid length, or not zlib-compressed
+			a_Stats.m_NumFailed++;
+			continue;
+		}
+
+		bool IsOK = a_Decoder.Inflate((const char *)Chunk + 5, Length - 1);
+		if (IsOK)
+		{
+			cParsedNBT NBT(a_Decoder.GetData(), a_Decoder.GetDataSize());
+			int Level = NBT.IsValid() ? NBT.FindChildByName(0, "Level") : -1;
+			IsOK = (Level >= 0) && a_Decoder.DecodeSections(NBT, Level, BlockTypes, BlockMetas, BlockLight, SkyLight);
+		}
+		if (!IsOK)
+		{
+			a_Stats.m_NumFailed++;
+			continue;
+		}
+		a_Stats.m_NumChunks++;
+		a_Stats.m_CompressedBytes += Length - 1;
+		a_Stats.m_InflatedBytes += a_Decoder.GetDataSize();
+		a_Stats.m_BytesCopied += a_Decoder.GetLastBytesCopied();
+	}  // for i - chunks in file
+}
+
+
+
+
+
+int main(int argc, char * argv[])
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+
+	if (argc < 2)
+	{
+		LOG("Usage: %s <RegionFolder> [<NumRepeats>]", argv[0]);
+		LOG("Decodes all chunks from all the region files in the folder and reports the decoding speed.");
+		return 1;
+	}
+	AString Folder(argv[1]);
+	int NumRepeats = (argc > 2) ? std::max(1, atoi(argv[2])) : 1;
+
+	// Read all the region files first, so that only the decoding is timed:
+	AStringVector Files = cFile::GetFolderContents(Folder);
+	AStringVector RegionData;
+	for (AStringVector::const_iterator itr = Files.begin(), end = Files.end(); itr != end; ++itr)
+	{
+		if ((itr->size() < 4) || (itr->compare(itr->size() - 4, 4, ".mca") != 0))
+		{
+			continue;
+		}
+		AString Data = cFile::ReadWholeFile(Folder + cFile::PathSeparator + *itr);
+		if (Data.size() < 8 KiB)
+		{
+			LOGWARNING("File %s is too small to be a region file, skipping.", itr->c_str());
+			continue;
+		}
+		RegionData.push_back(Data);
+	}
+
+	// Time the whole decoding loop at once, most chunks take well under the timer's 1 msec resolution:
+	cAnvilChunkDecoder Decoder;
+	sStats Stats;
+	cTimer Timer;
+	long long Start = Timer.GetNowTime();
+	for (int r = 0; r < NumRepeats; r++)
+	{
+		for (AStringVector::const_iterator itr = RegionData.begin(), end = RegionData.end(); itr != end; ++itr)
+		{
+			ProcessRegionFile(*itr, Decoder, Stats);
+		}
+	}
+	long long DecodeMSec = Timer.GetNowTime() - Start;
+
+	if (Stats.m_NumChunks == 0)
+	{
+		LOG("No chunks decoded (%d failed).", Stats.m_NumFailed);
+		return 1;
+	}
+
+	// cChunk::SetAllData() copies the decoded arrays once more into the chunk:
+	const long long ChunkCopyBytes = sizeof(cChunkDef::BlockTypes) + 3 * sizeof(cChunkDef::BlockNibbles);
+	double Seconds = DecodeMSec / 1000.0;
+	LOG("Decoded %d chunks (%d failed) in %.3f sec", Stats.m_NumChunks, Stats.m_NumFailed, Seconds);
+	if (DecodeMSec < 100)
+	{
+		LOG("  The decoding took too short to measure the speed reliably, use more region files or repeats");
+	}
+	else
+	{
+		LOG("  %.1f chunks/sec", Stats.m_NumChunks / Seconds);
+	}
+	LOG("  %.1f KiB compressed, %.1f KiB inflated per chunk",
+		Stats.m_CompressedBytes / 1024.0 / Stats.m_NumChunks,
+		Stats.m_InflatedBytes   / 1024.0 / Stats.m_NumChunks
+	);
+	LOG("  %.1f KiB copied per chunk by the decoder, plus %.1f KiB copied into cChunk",
+		Stats.m_BytesCopied / 1024.0 / Stats.m_NumChunks,
+		ChunkCopyBytes / 1024.0
+	);
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,118 @@
+
+// ExplosionPerformanceTest.cpp
+
+// Measures the speed of calculating the chain reaction of a large TNT cannon and counts the chunks its changes span
+
+#include "Globals.h"
+#include "Explosion.h"
+#include "BlockArea.h"
+#include "FastRandom.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+/** Size of the simulated piece of the world; the stone fills its lower part */
+#define WORLD_SIZE_XZ 128
+#define WORLD_SIZE_Y  64
+#define STONE_HEIGHT  40
+
+/** Size of the TNT cube placed in the middle of the world, on top of the stone */
+#define CANNON_SIZE 10
+
+/** The explosion size of a single TNT block */
+#define TNT_EXPLOSION_SIZE 4.0
+
+
+
+
+
+/** Counts the chunks in the (chunk-sorted) blocks */
+static int CountChunks(const sSetBlockVector & a_Blocks)
+{
+	int NumChunks = 0;
+	for (sSetBlockVector::const_iterator itr = a_Blocks.begin(), end = a_Blocks.end(); itr != end; ++itr)
+	{
+		if ((itr == a_Blocks.begin()) || (itr->ChunkX != (itr - 1)->ChunkX) || (itr->ChunkZ != (itr - 1)->ChunkZ))
+		{
+			NumChunks += 1;
+		}
+	}
+	return NumChunks;
+}
+
+
+
+
+
+int main(void)
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+
+	cBlockArea World;
+	World.Create(WORLD_SIZE_XZ, WORLD_SIZE_Y, WORLD_SIZE_XZ);
+	World.FillRelCuboid(0, WORLD_SIZE_XZ - 1, 0, STONE_HEIGHT - 1, 0, WORLD_SIZE_XZ - 1, cBlockArea::baTypes | cBlockArea::baMetas, E_BLOCK_STONE);
+	int CannonMin = (WORLD_SIZE_XZ - CANNON_SIZE) / 2;
+	int CannonMax = CannonMin + CANNON_SIZE - 1;
+	World.FillRelCuboid(CannonMin, CannonMax, STONE_HEIGHT, STONE_HEIGHT + CANNON_SIZE - 1, CannonMin, CannonMax, cBlockArea::baTypes | cBlockArea::baMetas, E_BLOCK_TNT);
+
+	// Set off the TNT in the cannon's center and follow the chain reaction:
+	std::vector<Vector3d> Queue;
+	Queue.push_back(Vector3d(CannonMin + CANNON_SIZE / 2 + 0.5, STONE_HEIGHT + CANNON_SIZE / 2 + 0.5, CannonMin + CANNON_SIZE / 2 + 0.5));
+	World.SetRelBlockType(CannonMin + CANNON_SIZE / 2, STONE_HEIGHT + CANNON_SIZE / 2, CannonMin + CANNON_SIZE / 2, E_BLOCK_AIR);
+	cFastRandom Random;
+	int NumExplosions = 0;
+	Int64 NumDestroyed = 0, NumChanged = 0, NumChunks = 0;
+	cTimer Timer;
+	long long Start = Timer.GetNowTime();
+	while (!Queue.empty())
+	{
+		Vector3d Center = Queue.back();
+		Queue.pop_back();
+		NumExplosions += 1;
+
+		// Read the snapshot the same way cChunkMap does:
+		cExplosion Explosion(TNT_EXPLOSION_SIZE, Center);
+		int MinX, MaxX, MinY, MaxY, MinZ, MaxZ;
+		Explosion.GetReach(MinX, MaxX, MinY, MaxY, MinZ, MaxZ);
+		cBlockArea Snapshot;
+		Snapshot.Create(MaxX - MinX + 1, MaxY - MinY + 1, MaxZ - MinZ + 1);
+		Snapshot.SetOrigin(MinX, MinY, MinZ);
+		Snapshot.Merge(World, -MinX, -MinY, -MinZ, cBlockArea::msOverwrite);
+		Explosion.Calculate(Snapshot, Random);
+
+		// Apply the changes to the simulated world and queue the hit TNT:
+		const sSetBlockVector & Changed = Explosion.GetChangedBlocks();
+		for (sSetBlockVector::const_iterator itr = Changed.begin(), end = Changed.end(); itr != end; ++itr)
+		{
+			int BlockX = itr->ChunkX * cChunkDef::Width + itr->x;
+			int BlockZ = itr->ChunkZ * cChunkDef::Width + itr->z;
+			if ((BlockX >= 0) && (BlockX < WORLD_SIZE_XZ) && (BlockZ >= 0) && (BlockZ < WORLD_SIZE_XZ))
+			{
+				World.SetRelBlockTypeMeta(BlockX, itr->y, BlockZ, itr->BlockType, itr->BlockMeta);
+			}
+		}
+		const sSetBlockVector & Destroyed = Explosion.GetDestroyedBlocks();
+		for (sSetBlockVector::const_iterator itr = Destroyed.begin(), end = Destroyed.end(); itr != end; ++itr)
+		{
+			if (itr->BlockType == E_BLOCK_TNT)
+			{
+				Queue.push_back(Vector3d(itr->ChunkX * cChunkDef::Width + itr->x + 0.5, itr->y + 0.5, itr->ChunkZ * cChunkDef::Width + itr->z + 0.5));
+			}
+		}
+
+		NumDestroyed += Destroyed.size();
+		NumChanged += Changed.size();
+		NumChunks += CountChunks(Changed);
+	}
+	long long MSec = std::max(Timer.GetNowTime() - Start, 1LL);
+
+	LOG("TNT cannon of %d blocks: %d explosions in %lld msec, %.1f explosions/sec", CANNON_SIZE * CANNON_SIZE * CANNON_SIZE, NumExplosions, MSec, NumExplosions * 1000.0 / MSec);
+	LOG("Blocks destroyed: %lld, blocks changed: %lld, spanning %lld chunks in total", NumDestroyed, NumChanged, NumChunks);
+	return 0;
+}
+
+
+
+
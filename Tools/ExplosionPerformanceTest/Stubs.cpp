@@ -0,0 +1,24 @@
+
+// Stubs.cpp
+
+// Implements stubs for the server functions that the cBlockArea sources reference, but the explosion benchmark never calls.
+// Linking the real ones would pull in the entire server through the Blocks library
+
+#include "Globals.h"
+#include "Blocks/BlockHandler.h"
+
+
+
+
+
+cBlockHandler * cBlockHandler::GetBlockHandler(BLOCKTYPE a_BlockType)
+{
+	// Only used by cBlockArea's meta rotations and mirroring
+	UNUSED(a_BlockType);
+	ASSERT(!"Blockhandlers are not available in the explosion benchmark");
+	return NULL;
+}
+
+
+
+
@@ -1,7 +1,130 @@
 
+// GeneratorPerformanceTest.cpp
+
+// Measures the speed of generating the trees in a forest-heavy world, with and without the tree overflow cache,
+// and checks that both produce the same chunks
+
 #include "Globals.h"
-#include "ChunkGenerator.h"
+#include "ComposableGenerator.h"
+#include "StructGen.h"
+#include "inifile/iniFile.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+/** The number of chunks along each side of the generated square */
+#define AREA_SIZE 24
+
+/** The cache size to compare against the uncached generation; same as the default in world.ini */
+#define TREES_CACHE_SIZE 64
+
+
+
+
+
+/** Generates the trees for all the chunks of the area, row by row, the same order the generator mostly sees.
+Returns the number of milliseconds it took. */
+static long long GenerateArea(cStructureGen & a_Trees, cBiomeGen & a_BiomeGen, cTerrainHeightGen & a_HeightGen, cTerrainCompositionGen & a_CompoGen)
+{
+	cTimer Timer;
+	long long Start = Timer.GetNowTime();
+	for (int z = 0; z < AREA_SIZE; z++)
+	{
+		for (int x = 0; x < AREA_SIZE; x++)
+		{
+			cChunkDesc Desc(x, z);
+			a_BiomeGen.GenBiomes(x, z, Desc.GetBiomeMap());
+			a_HeightGen.GenHeightMap(x, z, Desc.GetHeightMap());
+			a_CompoGen.ComposeTerrain(Desc);
+			a_Trees.GenStructures(Desc);
+		}
+	}
+	return Timer.GetNowTime() - Start;
+}
+
+
 
-int main(int argc, char * argv[]) {
-	cChunkGenerator Generator = cChunkGenerator();
+
+
+/** Generates each chunk of the area with both tree generators and compares the resulting blocks.
+Returns the number of chunks that differ; the cache must never change the generated terrain. */
+static int CompareArea(cStructureGen & a_Uncached, cStructureGen & a_Cached, cBiomeGen & a_BiomeGen, cTerrainHeightGen & a_HeightGen, cTerrainCompositionGen & a_CompoGen)
+{
+	int NumDifferent = 0;
+	for (int z = 0; z < AREA_SIZE; z++)
+	{
+		for (int x = 0; x < AREA_SIZE; x++)
+		{
+			cChunkDesc UncachedDesc(x, z);
+			cChunkDesc CachedDesc(x, z);
+			a_BiomeGen.GenBiomes(x, z, UncachedDesc.GetBiomeMap());
+			a_HeightGen.GenHeightMap(x, z, UncachedDesc.GetHeightMap());
+			a_CompoGen.ComposeTerrain(UncachedDesc);
+			a_BiomeGen.GenBiomes(x, z, CachedDesc.GetBiomeMap());
+			a_HeightGen.GenHeightMap(x, z, CachedDesc.GetHeightMap());
+			a_CompoGen.ComposeTerrain(CachedDesc);
+			a_Uncached.GenStructures(UncachedDesc);
+			a_Cached.GenStructures(CachedDesc);
+			if (
+				(memcmp(UncachedDesc.GetBlockTypes(), CachedDesc.GetBlockTypes(), sizeof(cChunkDef::BlockTypes)) != 0) ||
+				(memcmp(UncachedDesc.GetBlockMetasUncompressed(), CachedDesc.GetBlockMetasUncompressed(), sizeof(cChunkDesc::BlockNibbleBytes)) != 0)
+			)
+			{
+				LOGWARNING("Chunk [%d, %d] differs between the cached and uncached tree generation", x, z);
+				NumDifferent++;
+			}
+		}
+	}
+	return NumDifferent;
+}
+
+
+
+
+
+int main(void)
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+
+	// A forest everywhere, with the default terrain:
+	cIniFile IniFile;
+	IniFile.SetValue("Generator", "BiomeGen", "Constant");
+	IniFile.SetValue("Generator", "ConstantBiome", "Forest");
+	int Seed = 0;
+	bool CacheOffByDefault = false;
+	cBiomeGen * BiomeGen = cBiomeGen::CreateBiomeGen(IniFile, Seed, CacheOffByDefault);
+	cTerrainHeightGen * HeightGen = cTerrainHeightGen::CreateHeightGen(IniFile, *BiomeGen, Seed, CacheOffByDefault);
+	cTerrainCompositionGen * CompoGen = cTerrainCompositionGen::CreateCompositionGen(IniFile, *BiomeGen, *HeightGen, Seed);
+
+	cStructGenTrees Uncached(Seed, BiomeGen, HeightGen, CompoGen, 0);
+	cStructGenTrees Cached(Seed, BiomeGen, HeightGen, CompoGen, TREES_CACHE_SIZE);
+	long long UncachedMSec = std::max(GenerateArea(Uncached, *BiomeGen, *HeightGen, *CompoGen), 1LL);
+	long long CachedMSec   = std::max(GenerateArea(Cached,   *BiomeGen, *HeightGen, *CompoGen), 1LL);
+
+	int NumChunks = AREA_SIZE * AREA_SIZE;
+	LOG("Generated %d forest chunks", NumChunks);
+	LOG("Without the trees cache: %5lld msec, %7.1f chunks/sec", UncachedMSec, NumChunks * 1000.0 / UncachedMSec);
+	LOG("With the trees cache:    %5lld msec, %7.1f chunks/sec", CachedMSec,   NumChunks * 1000.0 / CachedMSec);
+	LOG("Trees cache hits: %d, misses: %d", Cached.GetNumCacheHits(), Cached.GetNumCacheMisses());
+	
+	int NumDifferent = CompareArea(Uncached, Cached, *BiomeGen, *HeightGen, *CompoGen);
+	if (NumDifferent > 0)
+	{
+		LOGWARNING("%d of %d chunks differ between the cached and uncached generation!", NumDifferent, NumChunks);
+	}
+	else
+	{
+		LOG("The cached and uncached generation produced identical chunks");
+	}
+
+	delete CompoGen;
+	delete HeightGen;
+	delete BiomeGen;
+	return (NumDifferent > 0) ? 1 : 0;
 }
+
+
+
+
@@ -0,0 +1,86 @@
+
+// Stubs.cpp
+
+// Implements stubs for the server functions that the generator sources reference, but the trees benchmark never calls.
+// Linking the real ones would pull in the entire server (cWorld, cChunkMap, cRoot, ...)
+
+#include "Globals.h"
+#include "ChunkMap.h"
+#include "ItemGrid.h"
+#include "BlockEntities/BlockEntity.h"
+#include "Blocks/BlockHandler.h"
+#include "Simulator/FireSimulator.h"
+#include "Simulator/FluidSimulator.h"
+
+
+
+
+
+cBlockEntity * cBlockEntity::CreateByBlockType(BLOCKTYPE, NIBBLETYPE, int, int, int, cWorld *)
+{
+	ASSERT(!"Block entities are not available in the generator benchmark");
+	return NULL;
+}
+
+
+
+
+
+cBlockHandler * cBlockHandler::GetBlockHandler(BLOCKTYPE)
+{
+	ASSERT(!"Blockhandlers are not available in the generator benchmark");
+	return NULL;
+}
+
+
+
+
+
+bool cChunkMap::ForEachChunkInRect(int, int, int, int, cChunkDataCallback &)
+{
+	ASSERT(!"There is no chunkmap in the generator benchmark");
+	return false;
+}
+
+
+
+
+
+bool cChunkMap::WriteBlockArea(cBlockArea &, int, int, int, int)
+{
+	ASSERT(!"There is no chunkmap in the generator benchmark");
+	return false;
+}
+
+
+
+
+
+bool cFireSimulator::DoesBurnForever(BLOCKTYPE)
+{
+	ASSERT(!"The finishers are not run in the generator benchmark");
+	return false;
+}
+
+
+
+
+
+bool cFluidSimulator::CanWashAway(BLOCKTYPE)
+{
+	ASSERT(!"The finishers are not run in the generator benchmark");
+	return false;
+}
+
+
+
+
+
+void cItemGrid::GenerateRandomLootWithBooks(const cLootProbab *, size_t, int, int)
+{
+	ASSERT(!"The structure generators with loot are not run in the generator benchmark");
+}
+
+
+
+
@@ -0,0 +1,338 @@
+
+// PathfindingPerformanceTest.cpp
+
+// Measures the speed and success of the mob pathfinding: mobs in a maze walking to a common target
+
+/*
+Compares three ways of finding the paths:
+	- The previous greedy stepping of cMonster::TickPathFinding(), which picks the neighbor closest to the target
+	- cPathFinder's A* for each mob separately
+	- cPathFinder's A* sharing the found paths the way cPathService does: a search ends when it reaches the path
+	  of a previous mob to the same target
+*/
+
+#include "Globals.h"
+#include "PathFinder.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+/** The server's table lives in BlockID.cpp, which needs most of the server; the maze only uses air and stone */
+bool g_BlockIsSolid[256];
+
+/** Number of maze cells along each side; the maze is twice as many blocks wide, plus the outer wall */
+#define MAZE_CELLS 31
+
+/** Size of the maze in blocks: the floor, two blocks of walls and one of air above */
+#define MAZE_SIZE (2 * MAZE_CELLS + 1)
+#define MAZE_HEIGHT 4
+
+/** Percentage of the inner walls removed after generating the maze, so that there are several ways to the target */
+#define MAZE_OPENNESS 10
+
+/** Number of mobs walking to the target */
+#define NUM_MOBS 500
+
+/** Maximum number of nodes per search, same as cPathService uses */
+#define MAX_NODES 3000
+
+/** Maximum number of steps of the greedy stepping before giving up */
+#define MAX_GREEDY_STEPS 1000
+
+/** The nodes budget per tick, same as the default in world.ini */
+#define NODES_PER_TICK 2000
+
+
+
+
+
+class cMaze
+{
+public:
+	cMaze(void)
+	{
+		m_Blocks.resize(MAZE_SIZE * MAZE_SIZE * MAZE_HEIGHT, E_BLOCK_AIR);
+		for (int z = 0; z < MAZE_SIZE; z++)
+		{
+			for (int x = 0; x < MAZE_SIZE; x++)
+			{
+				Set(x, 0, z, E_BLOCK_STONE);
+				Set(x, 1, z, E_BLOCK_STONE);
+				Set(x, 2, z, E_BLOCK_STONE);
+			}
+		}
+		Generate();
+	}
+
+	const BLOCKTYPE * GetBlocks(void) const { return &m_Blocks[0]; }
+
+	BLOCKTYPE Get(int a_X, int a_Y, int a_Z) const
+	{
+		if ((a_X < 0) || (a_X >= MAZE_SIZE) || (a_Y < 0) || (a_Y >= MAZE_HEIGHT) || (a_Z < 0) || (a_Z >= MAZE_SIZE))
+		{
+			return E_BLOCK_STONE;
+		}
+		return m_Blocks[a_X + a_Z * MAZE_SIZE + a_Y * MAZE_SIZE * MAZE_SIZE];
+	}
+
+	/** Returns the feet position of the mob standing in the maze cell */
+	static Vector3i CellToPos(int a_CellX, int a_CellZ)
+	{
+		return Vector3i(2 * a_CellX + 1, 1, 2 * a_CellZ + 1);
+	}
+
+protected:
+	std::vector<BLOCKTYPE> m_Blocks;
+
+	void Set(int a_X, int a_Y, int a_Z, BLOCKTYPE a_Block)
+	{
+		m_Blocks[a_X + a_Z * MAZE_SIZE + a_Y * MAZE_SIZE * MAZE_SIZE] = a_Block;
+	}
+
+	/** Carves the passage between the cell and its neighbor in the specified direction */
+	void Carve(int a_CellX, int a_CellZ, int a_DirX, int a_DirZ)
+	{
+		for (int i = 0; i <= 2; i++)
+		{
+			Set(2 * a_CellX + 1 + i * a_DirX, 1, 2 * a_CellZ + 1 + i * a_DirZ, E_BLOCK_AIR);
+			Set(2 * a_CellX + 1 + i * a_DirX, 2, 2 * a_CellZ + 1 + i * a_DirZ, E_BLOCK_AIR);
+		}
+	}
+
+	/** Generates a maze using a randomized depth-first search, then opens some of the remaining walls */
+	void Generate(void)
+	{
+		static const int Dirs[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+		std::vector<bool> IsVisited(MAZE_CELLS * MAZE_CELLS, false);
+		std::vector<std::pair<int, int> > Stack;
+		Stack.push_back(std::make_pair(0, 0));
+		IsVisited[0] = true;
+		Carve(0, 0, 0, 0);
+		while (!Stack.empty())
+		{
+			int CellX = Stack.back().first;
+			int CellZ = Stack.back().second;
+			int Unvisited[4];
+			int NumUnvisited = 0;
+			for (int d = 0; d < 4; d++)
+			{
+				int NX = CellX + Dirs[d][0];
+				int NZ = CellZ + Dirs[d][1];
+				if ((NX >= 0) && (NX < MAZE_CELLS) && (NZ >= 0) && (NZ < MAZE_CELLS) && !IsVisited[NX + NZ * MAZE_CELLS])
+				{
+					Unvisited[NumUnvisited++] = d;
+				}
+			}
+			if (NumUnvisited == 0)
+			{
+				Stack.pop_back();
+				continue;
+			}
+			int d = Unvisited[rand() % NumUnvisited];
+			Carve(CellX, CellZ, Dirs[d][0], Dirs[d][1]);
+			int NX = CellX + Dirs[d][0];
+			int NZ = CellZ + Dirs[d][1];
+			IsVisited[NX + NZ * MAZE_CELLS] = true;
+			Stack.push_back(std::make_pair(NX, NZ));
+		}
+
+		for (int CellZ = 0; CellZ < MAZE_CELLS - 1; CellZ++)
+		{
+			for (int CellX = 0; CellX < MAZE_CELLS - 1; CellX++)
+			{
+				if (rand() % 100 < MAZE_OPENNESS)
+				{
+					Carve(CellX, CellZ, (rand() % 2 == 0) ? 1 : 0, 0);
+					Carve(CellX, CellZ, 0, 1);
+				}
+			}
+		}
+	}
+} ;
+
+
+
+
+
+/** The previous cMonster::TickPathFinding() algorithm, stepping to the free neighbor closest to the target.
+Returns the number of steps to reach the target, or -1 if the mob got stuck. */
+static int GreedyWalk(const cMaze & a_Maze, Vector3i a_Pos, const Vector3i & a_Target)
+{
+	std::vector<Vector3i> Traversed;
+	for (int Step = 0; Step < MAX_GREEDY_STEPS; Step++)
+	{
+		if ((a_Pos.x == a_Target.x) && (a_Pos.z == a_Target.z))
+		{
+			return Step;
+		}
+		Traversed.push_back(a_Pos);
+		static const int Dirs[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+		bool HasBest = false;
+		Vector3i Best;
+		for (int d = 0; d < 4; d++)
+		{
+			Vector3i Next(a_Pos.x + Dirs[d][0], a_Pos.y, a_Pos.z + Dirs[d][1]);
+			bool IsTraversed = false;
+			for (std::vector<Vector3i>::const_iterator itr = Traversed.begin(); itr != Traversed.end(); ++itr)
+			{
+				if (itr->Equals(Next))
+				{
+					IsTraversed = true;
+					break;
+				}
+			}
+			if (IsTraversed)
+			{
+				continue;
+			}
+			BLOCKTYPE BlockAtY   = a_Maze.Get(Next.x, Next.y,     Next.z);
+			BLOCKTYPE BlockAtYP  = a_Maze.Get(Next.x, Next.y + 1, Next.z);
+			BLOCKTYPE BlockAtYPP = a_Maze.Get(Next.x, Next.y + 2, Next.z);
+			if (!g_BlockIsSolid[BlockAtY] && !g_BlockIsSolid[BlockAtYP])
+			{
+				// Same level
+			}
+			else if (g_BlockIsSolid[BlockAtY] && !g_BlockIsSolid[BlockAtYP] && !g_BlockIsSolid[BlockAtYPP])
+			{
+				Next.y += 1;
+			}
+			else
+			{
+				continue;
+			}
+			if (!HasBest || ((Next - a_Target).SqrLength() < (Best - a_Target).SqrLength()))
+			{
+				Best = Next;
+				HasBest = true;
+			}
+		}
+		if (!HasBest)
+		{
+			return -1;
+		}
+		a_Pos = Best;
+	}
+	return -1;
+}
+
+
+
+
+
+/** Statistics of one pathfinding method over all the mobs */
+struct sStats
+{
+	int       m_NumReached;
+	long long m_PathLengths;
+	long long m_NumNodes;
+	long long m_MSec;
+
+	sStats(void) :
+		m_NumReached(0),
+		m_PathLengths(0),
+		m_NumNodes(0),
+		m_MSec(0)
+	{
+	}
+
+	void Log(const char * a_Name)
+	{
+		double Seconds = std::max(m_MSec, 1LL) / 1000.0;
+		LOG("%-14s: %3d of %d mobs reached the target, %6.1f blocks per path, %7.1f nodes per mob, %9.0f mobs/sec",
+			a_Name, m_NumReached, NUM_MOBS,
+			(m_NumReached > 0) ? ((double)m_PathLengths / m_NumReached) : 0.0,
+			(double)m_NumNodes / NUM_MOBS,
+			NUM_MOBS / Seconds
+		);
+	}
+} ;
+
+
+
+
+
+int main(void)
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+	srand(0);
+	g_BlockIsSolid[E_BLOCK_STONE] = true;
+
+	cMaze Maze;
+	Vector3i Target = cMaze::CellToPos(MAZE_CELLS / 2, MAZE_CELLS / 2);
+	std::vector<Vector3i> Mobs;
+	for (int i = 0; i < NUM_MOBS; i++)
+	{
+		Mobs.push_back(cMaze::CellToPos(rand() % MAZE_CELLS, rand() % MAZE_CELLS));
+	}
+	LOG("%d mobs in a %d x %d blocks maze, walking to its center", NUM_MOBS, MAZE_SIZE, MAZE_SIZE);
+
+	cTimer Timer;
+
+	// The previous greedy stepping:
+	sStats Greedy;
+	long long Start = Timer.GetNowTime();
+	for (std::vector<Vector3i>::const_iterator itr = Mobs.begin(); itr != Mobs.end(); ++itr)
+	{
+		int Steps = GreedyWalk(Maze, *itr, Target);
+		if (Steps >= 0)
+		{
+			Greedy.m_NumReached += 1;
+			Greedy.m_PathLengths += Steps;
+		}
+		Greedy.m_NumNodes += (Steps >= 0) ? Steps : MAX_GREEDY_STEPS;
+	}
+	Greedy.m_MSec = Timer.GetNowTime() - Start;
+
+	// A* for each mob, and A* joining the paths found before:
+	cPathFinder Finder;
+	sStats AStar, Shared;
+	for (int Pass = 0; Pass < 2; Pass++)
+	{
+		bool ShouldShare = (Pass == 1);
+		sStats & Stats = ShouldShare ? Shared : AStar;
+		cVector3iArray KnownPath, Path;
+		Start = Timer.GetNowTime();
+		for (std::vector<Vector3i>::const_iterator itr = Mobs.begin(); itr != Mobs.end(); ++itr)
+		{
+			Finder.Start(Maze.GetBlocks(), Vector3i(0, 0, 0), Vector3i(MAZE_SIZE, MAZE_HEIGHT, MAZE_SIZE), *itr, Target, MAX_NODES);
+			for (size_t i = 0; i < KnownPath.size(); i++)
+			{
+				Finder.AddKnownPoint(KnownPath[i], (int)i);
+			}
+			int Budget = MAX_NODES + 1;
+			cPathFinder::eStatus Status = Finder.Step(Budget);
+			Stats.m_NumNodes += Finder.GetNumExpandedNodes();
+			if (Status != cPathFinder::fsFound)
+			{
+				continue;
+			}
+			Finder.GetPath(Path);
+			int KnownIdx = Finder.GetKnownPointIndex();
+			if (KnownIdx >= 0)
+			{
+				Path.insert(Path.end(), KnownPath.begin() + KnownIdx + 1, KnownPath.end());
+			}
+			Stats.m_NumReached += 1;
+			Stats.m_PathLengths += Path.size() - 1;
+			if (ShouldShare)
+			{
+				std::swap(KnownPath, Path);
+			}
+		}
+		Stats.m_MSec = Timer.GetNowTime() - Start;
+	}
+
+	Greedy.Log("Greedy");
+	AStar.Log("A*");
+	Shared.Log("A* shared");
+	LOG("With %d nodes per tick, all the paths take %.1f ticks to find (%.1f ticks when shared)",
+		NODES_PER_TICK, (double)AStar.m_NumNodes / NODES_PER_TICK, (double)Shared.m_NumNodes / NODES_PER_TICK
+	);
+	return 0;
+}
+
+
+
+
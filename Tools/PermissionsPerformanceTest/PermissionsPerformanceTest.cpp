@@ -0,0 +1,267 @@
+
+// PermissionsPerformanceTest.cpp
+
+// Measures the speed of permission checks using cPermissionTrie, compared to the previous split-and-compare algorithm
+
+#include "Globals.h"
+#include "PermissionTrie.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+/** Number of times each set of requests is checked while measuring */
+#define NUM_ROUNDS 20000
+
+
+
+
+
+/** The previous cPlayer::HasPermission() algorithm, used as the reference for the results and the speed */
+static bool HasPermissionReference(const AStringVector & a_Granted, const AString & a_Permission)
+{
+	if (a_Permission.empty())
+	{
+		return true;
+	}
+	AStringVector Split = StringSplit(a_Permission, ".");
+	for (AStringVector::const_iterator itr = a_Granted.begin(), end = a_Granted.end(); itr != end; ++itr)
+	{
+		AStringVector OtherSplit = StringSplit(*itr, ".");
+		if (OtherSplit.size() > Split.size())
+		{
+			continue;
+		}
+		size_t i;
+		for (i = 0; i < OtherSplit.size(); ++i)
+		{
+			if (OtherSplit[i].compare(Split[i]) != 0)
+			{
+				if (OtherSplit[i].compare("*") == 0)
+				{
+					return true;
+				}
+				break;
+			}
+		}
+		if (i == Split.size())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+
+/** A set of granted permissions, such as a player in a group would have */
+struct sPermissionSet
+{
+	const char * m_Name;
+	AStringVector m_Granted;
+	cPermissionTrie m_Trie;
+
+	sPermissionSet(const char * a_Name, const AStringVector & a_Granted) :
+		m_Name(a_Name),
+		m_Granted(a_Granted)
+	{
+		for (AStringVector::const_iterator itr = a_Granted.begin(), end = a_Granted.end(); itr != end; ++itr)
+		{
+			m_Trie.Add(*itr);
+		}
+	}
+} ;
+
+
+
+
+
+/** Checks that the trie gives the same results as the reference for all the requests; returns the number of mismatches */
+static int Verify(const sPermissionSet & a_Set, const AStringVector & a_Requests)
+{
+	int NumMismatches = 0;
+	for (AStringVector::const_iterator itr = a_Requests.begin(), end = a_Requests.end(); itr != end; ++itr)
+	{
+		bool Expected = HasPermissionReference(a_Set.m_Granted, *itr);
+		if (a_Set.m_Trie.HasPermission(*itr) != Expected)
+		{
+			LOGWARNING("Mismatch in set \"%s\" for permission \"%s\": expected %s", a_Set.m_Name, itr->c_str(), Expected ? "granted" : "denied");
+			NumMismatches++;
+		}
+	}
+	return NumMismatches;
+}
+
+
+
+
+
+/** Returns a random permission made of a few short parts, including empty parts and "*", for the verification */
+static AString RandomPermission(void)
+{
+	static const char * Parts[] = {"a", "b", "c", "*", "", "ab"};
+	AString res;
+	int NumParts = 1 + rand() % 4;
+	for (int i = 0; i < NumParts; i++)
+	{
+		if (i > 0)
+		{
+			res.push_back('.');
+		}
+		res.append(Parts[rand() % ARRAYCOUNT(Parts)]);
+	}
+	if (rand() % 8 == 0)
+	{
+		res.push_back('.');
+	}
+	return res;
+}
+
+
+
+
+
+/** Checks random granted sets against random requests; returns the number of mismatches */
+static int VerifyRandom(int a_NumSets, int a_NumRequests)
+{
+	int NumMismatches = 0;
+	for (int s = 0; s < a_NumSets; s++)
+	{
+		AStringVector Granted;
+		int NumGranted = rand() % 6;
+		for (int i = 0; i < NumGranted; i++)
+		{
+			Granted.push_back(RandomPermission());
+		}
+		sPermissionSet Set("random", Granted);
+		AStringVector Requests;
+		for (int i = 0; i < a_NumRequests; i++)
+		{
+			Requests.push_back(RandomPermission());
+		}
+		NumMismatches += Verify(Set, Requests);
+	}
+	return NumMismatches;
+}
+
+
+
+
+
+/** Measures both algorithms on the set with the requests and outputs the checks per second */
+static void Measure(const sPermissionSet & a_Set, const AStringVector & a_Requests)
+{
+	cTimer Timer;
+	int NumGranted = 0;
+
+	long long Start = Timer.GetNowTime();
+	for (int r = 0; r < NUM_ROUNDS; r++)
+	{
+		for (AStringVector::const_iterator itr = a_Requests.begin(), end = a_Requests.end(); itr != end; ++itr)
+		{
+			NumGranted += a_Set.m_Trie.HasPermission(*itr) ? 1 : 0;
+		}
+	}
+	long long TrieMSec = std::max(Timer.GetNowTime() - Start, 1LL);
+
+	// The reference is much slower, measure it on fewer rounds:
+	const int NumReferenceRounds = NUM_ROUNDS / 20;
+	Start = Timer.GetNowTime();
+	for (int r = 0; r < NumReferenceRounds; r++)
+	{
+		for (AStringVector::const_iterator itr = a_Requests.begin(), end = a_Requests.end(); itr != end; ++itr)
+		{
+			NumGranted += HasPermissionReference(a_Set.m_Granted, *itr) ? 1 : 0;
+		}
+	}
+	long long ReferenceMSec = std::max(Timer.GetNowTime() - Start, 1LL);
+
+	double TriePerSec      = 1000.0 * NUM_ROUNDS * a_Requests.size() / TrieMSec;
+	double ReferencePerSec = 1000.0 * NumReferenceRounds * a_Requests.size() / ReferenceMSec;
+	LOG("%-12s (%3u granted): trie %12.0f checks/sec, previous %10.0f checks/sec, speedup %.1fx (%d granted checks)",
+		a_Set.m_Name, (unsigned)a_Set.m_Granted.size(), TriePerSec, ReferencePerSec, TriePerSec / ReferencePerSec, NumGranted
+	);
+}
+
+
+
+
+
+int main(void)
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+	srand(0);
+
+	// The permissions of the default groups, as written by cGroupManager into a new groups.ini:
+	AStringVector Default = StringSplit("core.help,core.plugins,core.spawn,core.worlds,core.back,core.motd,core.build,core.locate,core.viewdistance", ",");
+	AStringVector Player(Default);
+	Player.push_back("core.portal");
+	AStringVector Moderator(Player);
+	AStringVector ModeratorOwn = StringSplit("core.time,core.item,core.teleport,core.ban,core.unban,core.save-all,core.toggledownfall", ",");
+	Moderator.insert(Moderator.end(), ModeratorOwn.begin(), ModeratorOwn.end());
+	AStringVector Owner;
+	Owner.push_back("*");
+
+	// A server with many plugins, each having its own commands; some are granted as a whole:
+	AStringVector Plugins(Moderator);
+	for (int p = 0; p < 30; p++)
+	{
+		if (p % 5 == 0)
+		{
+			Plugins.push_back(Printf("plugin%d.*", p));
+			continue;
+		}
+		for (int c = 0; c < 8; c++)
+		{
+			Plugins.push_back(Printf("plugin%d.command%d", p, c));
+			Plugins.push_back(Printf("plugin%d.command%d.others", p, c));
+		}
+	}
+
+	// The requests mix the core commands and plugin commands, both granted and denied:
+	AStringVector Requests(Moderator);
+	Requests.push_back("core.stop");
+	Requests.push_back("core.gamemode");
+	Requests.push_back("core.give.others");
+	for (int p = 0; p < 30; p += 3)
+	{
+		Requests.push_back(Printf("plugin%d.command%d", p, p % 10));
+		Requests.push_back(Printf("plugin%d.command%d.others", p, p % 7));
+		Requests.push_back(Printf("plugin%d.admin", p));
+	}
+
+	sPermissionSet Sets[] =
+	{
+		sPermissionSet("Default",   Default),
+		sPermissionSet("Moderator", Moderator),
+		sPermissionSet("Owner",     Owner),
+		sPermissionSet("Plugins",   Plugins),
+	} ;
+
+	int NumMismatches = 0;
+	for (size_t i = 0; i < ARRAYCOUNT(Sets); i++)
+	{
+		NumMismatches += Verify(Sets[i], Requests);
+	}
+	NumMismatches += VerifyRandom(2000, 200);
+	if (NumMismatches > 0)
+	{
+		LOGWARNING("The trie doesn't match the previous algorithm in %d checks", NumMismatches);
+		return 1;
+	}
+	LOG("The trie matches the previous algorithm in all checks.");
+
+	LOG("Checking %u permissions, %d rounds:", (unsigned)Requests.size(), NUM_ROUNDS);
+	for (size_t i = 0; i < ARRAYCOUNT(Sets); i++)
+	{
+		Measure(Sets[i], Requests);
+	}
+	return 0;
+}
+
+
+
+
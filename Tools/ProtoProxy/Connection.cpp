@@ -199,7 +199,9 @@ cConnection::cConnection(SOCKET a_ClientSocket, cServer & a_Server) :
 	m_HasClientPinged(false),
 	m_ServerProtocolState(-1),
 	m_ClientProtocolState(-1),
-	m_IsServerEncrypted(false)
+	m_IsServerEncrypted(false),
+	m_ProtocolVersion(0),
+	m_ShouldRecord(true)
 {
 	// Create the Logs subfolder, if not already created:
 	#if defined(_WIN32)
@@ -608,6 +610,13 @@ bool cConnection::DecodeClientsPackets(const char * a_Data, int a_Size)
 				break;
 			}
 		}  // switch (m_ProtocolState)
+		
+		// Record the game packets. The keepalives are left out, the replayer answers the server's ones by itself;
+		// so are the Tab-Completes, the replayer uses them to probe the latency and their answers would be taken for the probe's:
+		if ((m_ClientProtocolState == 3) && (PacketType != 0x00) && (PacketType != 0x14) && m_ShouldRecord)
+		{
+			RecordClientPacket();
+		}
 		m_ClientBuffer.CommitRead();
 	}  // while (true)
 	return true;
@@ -617,6 +626,29 @@ bool cConnection::DecodeClientsPackets(const char * a_Data, int a_Size)
 
 
 
+void cConnection::RecordClientPacket(void)
+{
+	if (!m_Trace.IsOpen())
+	{
+		// The trace is created only once the session reaches the game, the status pings don't need one:
+		AString FileName = m_LogNameBase + ".mcstrace";
+		if (!m_Trace.Open(FileName, m_ProtocolVersion))
+		{
+			Log("Cannot create the trace file \"%s\", the session will not be recorded", FileName.c_str());
+			m_ShouldRecord = false;
+			return;
+		}
+		printf("Session is recorded to file \"%s\"\n", FileName.c_str());
+	}
+	AString Packet;
+	m_ClientBuffer.ReadAgain(Packet);
+	m_Trace.WritePacket((Int64)(GetRelativeTime() * 1000), Packet);
+}
+
+
+
+
+
 bool cConnection::DecodeServersPackets(const char * a_Data, int a_Size)
 {
 	if (!m_ServerBuffer.Write(a_Data, a_Size))
@@ -785,6 +817,7 @@ bool cConnection::HandleClientHandshake(void)
 	HANDLE_CLIENT_PACKET_READ(ReadBEShort,       short,   ServerPort);
 	HANDLE_CLIENT_PACKET_READ(ReadVarInt,        UInt32,  NextState);
 	m_ClientBuffer.CommitRead();
+	m_ProtocolVersion = ProtocolVersion;
 	
 	Log("Received an initial handshake packet from the client:");
 	Log("  ProtocolVersion = %u", ProtocolVersion);
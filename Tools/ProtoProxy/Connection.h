@@ -11,6 +11,7 @@
 
 #include "ByteBuffer.h"
 #include "OSSupport/Timer.h"
+#include "Trace.h"
 
 
 
@@ -90,6 +91,15 @@ protected:
 	/// True if the server connection has provided encryption keys
 	bool m_IsServerEncrypted;
 	
+	/// The protocol version from the client's initial handshake, stored in the trace
+	UInt32 m_ProtocolVersion;
+	
+	/// The client's game packets are recorded into this trace, to be replayed by TrafficReplay
+	cTraceWriter m_Trace;
+	
+	/// Cleared when the trace file cannot be created, so that it isn't retried for each packet
+	bool m_ShouldRecord;
+	
 
 	bool ConnectToServer(void);
 	
@@ -120,6 +130,9 @@ protected:
 	/// Decodes packets coming from the server, sends appropriate counterparts to the client; returns false if the connection is to be dropped
 	bool DecodeServersPackets(const char * a_Data, int a_Size);
 	
+	/// Writes the client's packet that has just been handled into the trace, creating the trace file on the first call
+	void RecordClientPacket(void);
+	
 	// Packet handling, client-side, initial:
 	bool HandleClientHandshake(void);
 	
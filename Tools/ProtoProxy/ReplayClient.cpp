@@ -0,0 +1,522 @@
+
+// ReplayClient.cpp
+
+// Implements the cReplayClient class representing a single synthetic client of TrafficReplay, replaying a trace to the server
+
+#include "Globals.h"
+#include "ReplayClient.h"
+#include "ByteBuffer.h"
+
+#ifndef _WIN32
+	#include <netinet/tcp.h>  // For TCP_NODELAY
+#endif
+
+
+
+
+
+/// Number of msec between the latency probes of a single client
+#define PROBE_INTERVAL 1000
+
+/// Number of msec after which an unanswered latency probe is considered lost
+#define PROBE_TIMEOUT 10000
+
+/// Number of msec between the end of a pass through the trace and the start of the next one
+#define PASS_PAUSE 1000
+
+/// Height of the player's eyes above their feet; the server's Player Position And Look packet uses the eye height
+#define EYE_HEIGHT 1.62
+
+
+
+
+
+cReplayClient::cReplayClient(const cTrace & a_Trace, const AString & a_UserName, short a_ServerPort) :
+	m_Trace(a_Trace),
+	m_UserName(a_UserName),
+	m_ServerPort(a_ServerPort),
+	m_Socket(INVALID_SOCKET),
+	m_State(stDisconnected),
+	m_PassStart(0),
+	m_NextPacket(0),
+	m_OffsetX(0),
+	m_OffsetY(0),
+	m_OffsetZ(0),
+	m_PosX(0),
+	m_PosY(0),
+	m_PosZ(0),
+	m_ProbeSentTime(-1),
+	m_NextProbeTime(0),
+	m_ConnectTime(-1),
+	m_SpawnTime(-1),
+	m_NumBytesSent(0),
+	m_NumBytesReceived(0),
+	m_NumPacketsReplayed(0),
+	m_NumPasses(0),
+	m_NumProbesLost(0),
+	m_FirstWorldAge(0),
+	m_FirstWorldAgeTime(-1),
+	m_LastWorldAge(0),
+	m_LastWorldAgeTime(-1)
+{
+}
+
+
+
+
+
+cReplayClient::~cReplayClient()
+{
+	Disconnect("Replay finished");
+}
+
+
+
+
+
+bool cReplayClient::Connect(Int64 a_Now)
+{
+	m_ConnectTime = a_Now;
+	m_Socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (m_Socket == INVALID_SOCKET)
+	{
+		m_DisconnectReason = Printf("Cannot create a socket: %d", SocketError);
+		return false;
+	}
+	// Like the game client, send the small packets right away, so that they don't distort the latency:
+	int NoDelay = 1;
+	setsockopt(m_Socket, IPPROTO_TCP, TCP_NODELAY, (const char *)&NoDelay, sizeof(NoDelay));
+	sockaddr_in localhost;
+	memset(&localhost, 0, sizeof(localhost));
+	localhost.sin_family = AF_INET;
+	localhost.sin_port = htons(m_ServerPort);
+	localhost.sin_addr.s_addr = htonl(0x7f000001);  // localhost
+	if (connect(m_Socket, (sockaddr *)&localhost, sizeof(localhost)) != 0)
+	{
+		Disconnect(Printf("Cannot connect to the server: %d", SocketError));
+		return false;
+	}
+	m_State = stLoggingIn;
+
+	// Send the initial handshake, with the protocol version of the recorded client:
+	cByteBuffer Handshake(512);
+	Handshake.WriteVarInt(0x00);
+	Handshake.WriteVarInt(m_Trace.GetProtocolVersion());
+	Handshake.WriteVarUTF8String("localhost");
+	Handshake.WriteBEShort(m_ServerPort);
+	Handshake.WriteVarInt(2);  // Next state: login
+	SendPacket(Handshake);
+
+	// Send the Login Start packet:
+	cByteBuffer LoginStart(512);
+	LoginStart.WriteVarInt(0x00);
+	LoginStart.WriteVarUTF8String(m_UserName);
+	SendPacket(LoginStart);
+	return IsConnected();
+}
+
+
+
+
+
+void cReplayClient::Disconnect(const AString & a_Reason)
+{
+	if (m_Socket == INVALID_SOCKET)
+	{
+		return;
+	}
+	closesocket(m_Socket);
+	m_Socket = INVALID_SOCKET;
+	m_State = stDisconnected;
+	m_DisconnectReason = a_Reason;
+}
+
+
+
+
+
+void cReplayClient::ReceiveData(Int64 a_Now)
+{
+	char Buffer[64 KiB];
+	int NumBytes = recv(m_Socket, Buffer, sizeof(Buffer), 0);
+	if (NumBytes <= 0)
+	{
+		Disconnect((NumBytes == 0) ? "The server closed the connection" : Printf("Receiving failed: %d", SocketError));
+		return;
+	}
+	m_NumBytesReceived += NumBytes;
+	m_IncomingData.append(Buffer, (size_t)NumBytes);
+
+	// Handle all the complete packets:
+	size_t Pos = 0;
+	while (IsConnected())
+	{
+		size_t PacketStart = Pos;
+		UInt32 PacketLen;
+		if (!cTrace::ReadVarInt(m_IncomingData, Pos, PacketLen) || (m_IncomingData.size() - Pos < PacketLen))
+		{
+			// Not a complete packet yet
+			Pos = PacketStart;
+			break;
+		}
+		HandlePacket(m_IncomingData.substr(Pos, PacketLen), a_Now);
+		Pos += PacketLen;
+	}
+	m_IncomingData.erase(0, Pos);
+}
+
+
+
+
+
+void cReplayClient::Tick(Int64 a_Now)
+{
+	if (m_State != stPlaying)
+	{
+		return;
+	}
+
+	// Send the trace packets that are due:
+	const cTrace::cPackets & Packets = m_Trace.GetPackets();
+	while (IsConnected() && (m_PassStart + Packets[m_NextPacket].m_Time <= a_Now))
+	{
+		SendTracePacket(Packets[m_NextPacket]);
+		m_NextPacket++;
+		if (m_NextPacket >= Packets.size())
+		{
+			// Loop the trace, continuing from where the player is:
+			m_NumPasses++;
+			StartPass(std::max(a_Now, m_PassStart + m_Trace.GetLength() + PASS_PAUSE));
+			break;
+		}
+	}
+
+	// Probe the latency; the Tab-Complete packet is answered by the server right away, listing the player's own name:
+	if ((m_ProbeSentTime >= 0) && (a_Now - m_ProbeSentTime > PROBE_TIMEOUT))
+	{
+		m_NumProbesLost++;
+		m_ProbeSentTime = -1;
+	}
+	if (IsConnected() && (m_ProbeSentTime < 0) && (a_Now >= m_NextProbeTime))
+	{
+		cByteBuffer Probe(512);
+		Probe.WriteVarInt(0x14);  // Tab-Complete packet
+		Probe.WriteVarUTF8String(m_UserName);
+		SendPacket(Probe);
+		m_ProbeSentTime = a_Now;
+		m_NextProbeTime = a_Now + PROBE_INTERVAL;
+	}
+}
+
+
+
+
+
+Int64 cReplayClient::GetNextTickTime(void) const
+{
+	if (m_State != stPlaying)
+	{
+		// Nothing to send until spawned
+		return -1;
+	}
+	Int64 NextPacketTime = m_PassStart + m_Trace.GetPackets()[m_NextPacket].m_Time;
+	Int64 NextProbeTime = (m_ProbeSentTime < 0) ? m_NextProbeTime : (m_ProbeSentTime + PROBE_TIMEOUT);
+	return std::min(NextPacketTime, NextProbeTime);
+}
+
+
+
+
+
+void cReplayClient::GetWorldAgeProgress(Int64 & a_NumTicks, Int64 & a_NumMSec) const
+{
+	if (m_FirstWorldAgeTime < 0)
+	{
+		a_NumTicks = 0;
+		a_NumMSec = 0;
+		return;
+	}
+	a_NumTicks = m_LastWorldAge - m_FirstWorldAge;
+	a_NumMSec = m_LastWorldAgeTime - m_FirstWorldAgeTime;
+}
+
+
+
+
+
+void cReplayClient::HandlePacket(const AString & a_Packet, Int64 a_Now)
+{
+	cByteBuffer Packet((int)a_Packet.size() + 1);
+	Packet.Write(a_Packet.data(), (int)a_Packet.size());
+	UInt32 PacketType;
+	if (!Packet.ReadVarInt(PacketType))
+	{
+		return;
+	}
+
+	if (m_State == stLoggingIn)
+	{
+		switch (PacketType)
+		{
+			case 0x00:
+			{
+				// Disconnect
+				AString Reason;
+				Packet.ReadVarUTF8String(Reason);
+				Disconnect("Login refused: " + Reason);
+				return;
+			}
+			case 0x01:
+			{
+				// Encryption Request
+				Disconnect("The server requires authentication, it needs to run with authentication disabled");
+				return;
+			}
+			case 0x02:
+			{
+				// Login Success
+				m_State = stSpawning;
+				return;
+			}
+		}
+		return;
+	}
+
+	switch (PacketType)
+	{
+		case 0x00:
+		{
+			// Keep Alive, answer with the same ID:
+			int KeepAliveID;
+			if (Packet.ReadBEInt(KeepAliveID))
+			{
+				cByteBuffer Answer(16);
+				Answer.WriteVarInt(0x00);
+				Answer.WriteBEInt(KeepAliveID);
+				SendPacket(Answer);
+			}
+			break;
+		}
+		case 0x03:
+		{
+			// Time Update
+			Int64 WorldAge;
+			if (Packet.ReadBEInt64(WorldAge))
+			{
+				if (m_FirstWorldAgeTime < 0)
+				{
+					m_FirstWorldAge = WorldAge;
+					m_FirstWorldAgeTime = a_Now;
+				}
+				m_LastWorldAge = WorldAge;
+				m_LastWorldAgeTime = a_Now;
+			}
+			break;
+		}
+		case 0x08:
+		{
+			// Player Position And Look, the server spawns or teleports the player; confirm the position:
+			double PosX, EyeY, PosZ;
+			float Yaw, Pitch;
+			bool IsOnGround;
+			if (
+				!Packet.ReadBEDouble(PosX) || !Packet.ReadBEDouble(EyeY) || !Packet.ReadBEDouble(PosZ) ||
+				!Packet.ReadBEFloat(Yaw) || !Packet.ReadBEFloat(Pitch) || !Packet.ReadBool(IsOnGround)
+			)
+			{
+				break;
+			}
+			m_PosX = PosX;
+			m_PosY = EyeY - EYE_HEIGHT;
+			m_PosZ = PosZ;
+			cByteBuffer Answer(64);
+			Answer.WriteVarInt(0x06);
+			Answer.WriteBEDouble(m_PosX);
+			Answer.WriteBEDouble(m_PosY);
+			Answer.WriteBEDouble(EyeY);
+			Answer.WriteBEDouble(m_PosZ);
+			Answer.WriteBEFloat(Yaw);
+			Answer.WriteBEFloat(Pitch);
+			Answer.WriteBool(IsOnGround);
+			SendPacket(Answer);
+			if (m_State == stSpawning)
+			{
+				m_State = stPlaying;
+				m_SpawnTime = a_Now;
+				m_NextProbeTime = a_Now;
+				StartPass(a_Now);
+			}
+			break;
+		}
+		case 0x3a:
+		{
+			// Tab-Complete, the answer to the latency probe:
+			if (m_ProbeSentTime >= 0)
+			{
+				m_ProbeRTTs.push_back((int)(a_Now - m_ProbeSentTime));
+				m_ProbeSentTime = -1;
+			}
+			break;
+		}
+		case 0x40:
+		{
+			// Disconnect
+			AString Reason;
+			Packet.ReadVarUTF8String(Reason);
+			Disconnect("Kicked: " + Reason);
+			break;
+		}
+	}
+}
+
+
+
+
+
+void cReplayClient::StartPass(Int64 a_Now)
+{
+	m_PassStart = a_Now;
+	m_NextPacket = 0;
+	double StartX, StartY, StartZ;
+	if (m_Trace.GetStartPos(StartX, StartY, StartZ))
+	{
+		// Whole blocks, so that the dug and placed blocks stay where the player is:
+		m_OffsetX = (int)floor(m_PosX) - (int)floor(StartX);
+		m_OffsetY = (int)floor(m_PosY) - (int)floor(StartY);
+		m_OffsetZ = (int)floor(m_PosZ) - (int)floor(StartZ);
+	}
+}
+
+
+
+
+
+void cReplayClient::SendTracePacket(const cTrace::sPacket & a_Packet)
+{
+	if (a_Packet.m_Type == 0x14)
+	{
+		// Tab-Complete, the server's answer would be taken for the latency probe's; the traces recorded since are without them
+		return;
+	}
+	m_NumPacketsReplayed++;
+	if ((a_Packet.m_Type < 0x04) || (a_Packet.m_Type > 0x08) || (a_Packet.m_Type == 0x05))
+	{
+		// No coords in the packet, send as recorded:
+		SendData(a_Packet.m_Data);
+		return;
+	}
+
+	cByteBuffer Recorded((int)a_Packet.m_Data.size() + 1);
+	Recorded.Write(a_Packet.m_Data.data(), (int)a_Packet.m_Data.size());
+	UInt32 PacketLen, PacketType;
+	Recorded.ReadVarInt(PacketLen);
+	Recorded.ReadVarInt(PacketType);
+	cByteBuffer Body((int)a_Packet.m_Data.size() + 16);
+	Body.WriteVarInt(PacketType);
+	switch (PacketType)
+	{
+		case 0x04:
+		case 0x06:
+		{
+			// Player Position / Player Position And Look:
+			double PosX, PosY, Stance, PosZ;
+			if (
+				!Recorded.ReadBEDouble(PosX) || !Recorded.ReadBEDouble(PosY) ||
+				!Recorded.ReadBEDouble(Stance) || !Recorded.ReadBEDouble(PosZ)
+			)
+			{
+				return;
+			}
+			m_PosX = PosX + m_OffsetX;
+			m_PosY = PosY + m_OffsetY;
+			m_PosZ = PosZ + m_OffsetZ;
+			Body.WriteBEDouble(m_PosX);
+			Body.WriteBEDouble(m_PosY);
+			Body.WriteBEDouble(Stance + m_OffsetY);
+			Body.WriteBEDouble(m_PosZ);
+			break;
+		}
+		case 0x07:
+		{
+			// Player Digging; the statuses 3 to 5 (dropping items, shooting arrows) have no coords:
+			char Status;
+			int BlockX, BlockZ;
+			Byte BlockY;
+			if (!Recorded.ReadChar(Status) || !Recorded.ReadBEInt(BlockX) || !Recorded.ReadByte(BlockY) || !Recorded.ReadBEInt(BlockZ))
+			{
+				return;
+			}
+			bool HasCoords = ((Status < 3) || (Status > 5));
+			Body.WriteChar(Status);
+			Body.WriteBEInt(HasCoords ? BlockX + m_OffsetX : BlockX);
+			Body.WriteByte(HasCoords ? (Byte)(BlockY + m_OffsetY) : BlockY);
+			Body.WriteBEInt(HasCoords ? BlockZ + m_OffsetZ : BlockZ);
+			break;
+		}
+		case 0x08:
+		{
+			// Player Block Placement; the coords {-1, 255, -1} mean using the held item, not a placement:
+			int BlockX, BlockZ;
+			Byte BlockY;
+			if (!Recorded.ReadBEInt(BlockX) || !Recorded.ReadByte(BlockY) || !Recorded.ReadBEInt(BlockZ))
+			{
+				return;
+			}
+			bool HasCoords = ((BlockX != -1) || (BlockY != 255) || (BlockZ != -1));
+			Body.WriteBEInt(HasCoords ? BlockX + m_OffsetX : BlockX);
+			Body.WriteByte(HasCoords ? (Byte)(BlockY + m_OffsetY) : BlockY);
+			Body.WriteBEInt(HasCoords ? BlockZ + m_OffsetZ : BlockZ);
+			break;
+		}
+	}
+
+	// The rest of the packet is sent as recorded:
+	AString Rest;
+	Recorded.ReadAll(Rest);
+	Body.WriteBuf(Rest.data(), (int)Rest.size());
+	SendPacket(Body);
+}
+
+
+
+
+
+void cReplayClient::SendPacket(cByteBuffer & a_Body)
+{
+	AString Body;
+	a_Body.ReadAll(Body);
+	AString Packet;
+	cTrace::AppendVarInt(Packet, (UInt32)Body.size());
+	Packet.append(Body);
+	SendData(Packet);
+}
+
+
+
+
+
+void cReplayClient::SendData(const AString & a_Data)
+{
+	if (!IsConnected())
+	{
+		return;
+	}
+	const char * Data = a_Data.data();
+	int NumLeft = (int)a_Data.size();
+	while (NumLeft > 0)
+	{
+		int NumSent = send(m_Socket, Data, NumLeft, 0);
+		if (NumSent <= 0)
+		{
+			Disconnect(Printf("Sending failed: %d", SocketError));
+			return;
+		}
+		Data += NumSent;
+		NumLeft -= NumSent;
+	}
+	m_NumBytesSent += a_Data.size();
+}
+
+
+
+
@@ -0,0 +1,134 @@
+
+// ReplayClient.h
+
+// Interfaces to the cReplayClient class representing a single synthetic client of TrafficReplay, replaying a trace to the server
+
+
+
+
+
+#pragma once
+
+#include "Trace.h"
+
+
+
+
+
+class cByteBuffer;
+
+
+
+
+
+class cReplayClient
+{
+public:
+	cReplayClient(const cTrace & a_Trace, const AString & a_UserName, short a_ServerPort);
+	~cReplayClient();
+
+	/// Connects to the server and logs in. Returns false if the connection fails
+	bool Connect(Int64 a_Now);
+
+	/// Closes the connection, if still open; a_Reason is reported in the summary
+	void Disconnect(const AString & a_Reason);
+
+	/// Returns the socket of the connection, INVALID_SOCKET if not connected
+	SOCKET GetSocket(void) const { return m_Socket; }
+
+	bool IsConnected(void) const { return (m_Socket != INVALID_SOCKET); }
+
+	/// Returns true if the server has spawned the player, so that the trace is being replayed
+	bool HasSpawned(void) const { return (m_SpawnTime >= 0); }
+
+	/// Receives the data waiting on the socket and handles the complete packets. Disconnects on error
+	void ReceiveData(Int64 a_Now);
+
+	/// Sends the trace packets and the latency probe that are due. Disconnects on error
+	void Tick(Int64 a_Now);
+
+	/// Returns the time when Tick() next has something to send, -1 if nothing is scheduled
+	Int64 GetNextTickTime(void) const;
+
+	// Statistics:
+	const AString & GetUserName        (void) const { return m_UserName; }
+	const AString & GetDisconnectReason(void) const { return m_DisconnectReason; }
+	Int64 GetLoginTime        (void) const { return HasSpawned() ? (m_SpawnTime - m_ConnectTime) : -1; }
+	Int64 GetNumBytesSent     (void) const { return m_NumBytesSent; }
+	Int64 GetNumBytesReceived (void) const { return m_NumBytesReceived; }
+	int   GetNumPacketsReplayed(void) const { return m_NumPacketsReplayed; }
+	int   GetNumPasses        (void) const { return m_NumPasses; }
+	int   GetNumProbesLost    (void) const { return m_NumProbesLost; }
+
+	/// Returns the round-trip times of the latency probes answered so far, in msec
+	const std::vector<int> & GetProbeRTTs(void) const { return m_ProbeRTTs; }
+
+	/// Returns the number of world ticks and the wall-clock msec between the first and the last time update from the server
+	void GetWorldAgeProgress(Int64 & a_NumTicks, Int64 & a_NumMSec) const;
+
+protected:
+	enum eState
+	{
+		stDisconnected,
+		stLoggingIn,   ///< The login has been sent, waiting for the Login Success packet
+		stSpawning,    ///< In the game, waiting for the first Player Position And Look packet from the server
+		stPlaying,     ///< Replaying the trace
+	} ;
+
+	const cTrace & m_Trace;
+	AString m_UserName;
+	short   m_ServerPort;
+	SOCKET  m_Socket;
+	eState  m_State;
+
+	/// The data received from the server that hasn't been handled yet, waiting for the rest of the packet
+	AString m_IncomingData;
+
+	/// Time when the current pass through the trace started; the packets are sent relative to it
+	Int64 m_PassStart;
+
+	/// Index into m_Trace's packets of the next packet to send
+	size_t m_NextPacket;
+
+	/// The difference in blocks between the player's position and the trace's, added to all the coords sent
+	int m_OffsetX, m_OffsetY, m_OffsetZ;
+
+	/// The player's position as last sent to or received from the server
+	double m_PosX, m_PosY, m_PosZ;
+
+	// Latency probe:
+	Int64 m_ProbeSentTime;  ///< Time when the outstanding probe was sent, -1 if none
+	Int64 m_NextProbeTime;
+
+	// Statistics:
+	AString m_DisconnectReason;
+	Int64 m_ConnectTime;
+	Int64 m_SpawnTime;  ///< Time when the server spawned the player, -1 if not yet
+	Int64 m_NumBytesSent;
+	Int64 m_NumBytesReceived;
+	int   m_NumPacketsReplayed;
+	int   m_NumPasses;
+	int   m_NumProbesLost;
+	std::vector<int> m_ProbeRTTs;
+	Int64 m_FirstWorldAge, m_FirstWorldAgeTime;  ///< The first time update received, m_FirstWorldAgeTime is -1 if none yet
+	Int64 m_LastWorldAge,  m_LastWorldAgeTime;   ///< The last time update received
+
+	/// Handles a single complete packet from the server; a_Packet contains the packet without its length
+	void HandlePacket(const AString & a_Packet, Int64 a_Now);
+
+	/// Starts a new pass through the trace, relative to the player's current position
+	void StartPass(Int64 a_Now);
+
+	/// Sends the trace packet, with the coords moved by the offset
+	void SendTracePacket(const cTrace::sPacket & a_Packet);
+
+	/// Sends the packet whose type and data are in a_Body, prefixed with its length
+	void SendPacket(cByteBuffer & a_Body);
+
+	/// Sends the raw data over the socket. Disconnects on error
+	void SendData(const AString & a_Data);
+} ;
+
+
+
+
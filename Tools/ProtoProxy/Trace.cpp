@@ -0,0 +1,227 @@
+
+// Trace.cpp
+
+// Implements the cTraceWriter and cTrace classes representing the session traces recorded by ProtoProxy and replayed by TrafficReplay
+
+#include "Globals.h"
+#include "Trace.h"
+#include "ByteBuffer.h"
+
+
+
+
+
+/// The signature at the start of each trace file
+#define TRACE_SIGNATURE "MCSTRACE"
+
+/// Version of the trace format, stored after the signature
+#define TRACE_VERSION 1
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cTraceWriter:
+
+cTraceWriter::cTraceWriter(void) :
+	m_IsOpen(false),
+	m_LastTime(0),
+	m_NumPackets(0)
+{
+}
+
+
+
+
+
+bool cTraceWriter::Open(const AString & a_FileName, UInt32 a_ProtocolVersion)
+{
+	if (!m_File.Open(a_FileName, cGZipFile::fmWrite))
+	{
+		return false;
+	}
+	AString Header(TRACE_SIGNATURE);
+	Header.push_back((char)TRACE_VERSION);
+	cTrace::AppendVarInt(Header, a_ProtocolVersion);
+	m_IsOpen = m_File.Write(Header);
+	return m_IsOpen;
+}
+
+
+
+
+
+void cTraceWriter::WritePacket(Int64 a_Time, const AString & a_Packet)
+{
+	if (!m_IsOpen)
+	{
+		return;
+	}
+	AString Record;
+	cTrace::AppendVarInt(Record, (UInt32)std::max(a_Time - m_LastTime, 0LL));
+	Record.append(a_Packet);
+	m_LastTime = std::max(a_Time, m_LastTime);
+	m_IsOpen = m_File.Write(Record);
+	m_NumPackets++;
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cTrace:
+
+cTrace::cTrace(void) :
+	m_ProtocolVersion(0)
+{
+}
+
+
+
+
+
+bool cTrace::Load(const AString & a_FileName, AString & a_Error)
+{
+	cGZipFile File;
+	if (!File.Open(a_FileName, cGZipFile::fmRead))
+	{
+		a_Error = "Cannot open the file";
+		return false;
+	}
+	// The trace of a killed proxy is cut short; the data decompressed before the error is still used:
+	AString Data;
+	if ((File.ReadRestOfFile(Data) < 0) && Data.empty())
+	{
+		a_Error = "Cannot decompress the file";
+		return false;
+	}
+
+	size_t SignatureLen = sizeof(TRACE_SIGNATURE) - 1;
+	size_t Pos = SignatureLen + 1;
+	if ((Data.compare(0, SignatureLen, TRACE_SIGNATURE) != 0) || (Data.size() < Pos))
+	{
+		a_Error = "Not a trace file";
+		return false;
+	}
+	if (Data[SignatureLen] != TRACE_VERSION)
+	{
+		Printf(a_Error, "Unsupported trace format version %d", Data[SignatureLen]);
+		return false;
+	}
+	if (!ReadVarInt(Data, Pos, m_ProtocolVersion))
+	{
+		a_Error = "The header is truncated";
+		return false;
+	}
+
+	m_Packets.clear();
+	Int64 Time = 0;
+	while (Pos < Data.size())
+	{
+		// A truncated record means the recording proxy has been killed, the packets before it are used:
+		UInt32 TimeDelta, PacketLen, PacketType;
+		if (!ReadVarInt(Data, Pos, TimeDelta))
+		{
+			break;
+		}
+		size_t PacketStart = Pos;
+		if (!ReadVarInt(Data, Pos, PacketLen) || (Data.size() - Pos < PacketLen))
+		{
+			break;
+		}
+		size_t PacketEnd = Pos + PacketLen;
+		if (!ReadVarInt(Data, Pos, PacketType))
+		{
+			break;
+		}
+		Time += TimeDelta;
+		m_Packets.push_back(sPacket());
+		sPacket & Packet = m_Packets.back();
+		Packet.m_Time = Time;
+		Packet.m_Type = PacketType;
+		Packet.m_Data.assign(Data, PacketStart, PacketEnd - PacketStart);
+		Pos = PacketEnd;
+	}
+	if (m_Packets.empty())
+	{
+		a_Error = "The trace contains no packets";
+		return false;
+	}
+	return true;
+}
+
+
+
+
+
+bool cTrace::GetStartPos(double & a_X, double & a_Y, double & a_Z) const
+{
+	for (cPackets::const_iterator itr = m_Packets.begin(); itr != m_Packets.end(); ++itr)
+	{
+		if ((itr->m_Type != 0x04) && (itr->m_Type != 0x06))
+		{
+			continue;
+		}
+
+		// Both the Player Position and the Player Position And Look packets start with X, FeetY, HeadY, Z:
+		cByteBuffer Buffer((int)itr->m_Data.size() + 1);
+		Buffer.Write(itr->m_Data.data(), (int)itr->m_Data.size());
+		UInt32 PacketLen, PacketType;
+		double Stance;
+		if (
+			Buffer.ReadVarInt(PacketLen) && Buffer.ReadVarInt(PacketType) &&
+			Buffer.ReadBEDouble(a_X) && Buffer.ReadBEDouble(a_Y) && Buffer.ReadBEDouble(Stance) && Buffer.ReadBEDouble(a_Z)
+		)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+
+void cTrace::AppendVarInt(AString & a_Data, UInt32 a_Value)
+{
+	do
+	{
+		Byte b = (Byte)(a_Value & 0x7f);
+		a_Value >>= 7;
+		if (a_Value > 0)
+		{
+			b |= 0x80;
+		}
+		a_Data.push_back((char)b);
+	} while (a_Value > 0);
+}
+
+
+
+
+
+bool cTrace::ReadVarInt(const AString & a_Data, size_t & a_Pos, UInt32 & a_Value)
+{
+	a_Value = 0;
+	for (int Shift = 0; Shift < 35; Shift += 7)
+	{
+		if (a_Pos >= a_Data.size())
+		{
+			return false;
+		}
+		Byte b = (Byte)a_Data[a_Pos++];
+		a_Value |= (UInt32)(b & 0x7f) << Shift;
+		if ((b & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
@@ -0,0 +1,95 @@
+
+// Trace.h
+
+// Declares the cTraceWriter and cTrace classes representing the session traces recorded by ProtoProxy and replayed by TrafficReplay
+
+/*
+A trace contains the game packets that a client sent to the server, together with the time when each one was sent.
+The login is not recorded, the replayer logs in under its own names; neither are the keepalives, the replayer
+answers the server's ones itself. The file is gzipped, its contents are:
+	"MCSTRACE" <format version: byte> <protocol version from the client's handshake: VarInt>
+followed by the packets, each one as:
+	<msec since the previous packet: VarInt> <the packet exactly as it was sent: VarInt length, VarInt type, data>
+*/
+
+
+
+
+
+#pragma once
+
+#include "OSSupport/GZipFile.h"
+
+
+
+
+
+class cTraceWriter
+{
+public:
+	cTraceWriter(void);
+
+	/// Creates the trace file. Returns true if successful
+	bool Open(const AString & a_FileName, UInt32 a_ProtocolVersion);
+
+	bool IsOpen(void) const { return m_IsOpen; }
+
+	/// Appends a packet sent a_Time msec after the session started; a_Packet includes the length
+	void WritePacket(Int64 a_Time, const AString & a_Packet);
+
+	/// Returns the number of packets written so far
+	int GetNumPackets(void) const { return m_NumPackets; }
+
+protected:
+	cGZipFile m_File;
+	bool      m_IsOpen;
+	Int64     m_LastTime;  ///< Time of the last packet written, the next one is stored relative to it
+	int       m_NumPackets;
+} ;
+
+
+
+
+
+class cTrace
+{
+public:
+	/// A single packet of the trace
+	struct sPacket
+	{
+		Int64   m_Time;    ///< Msec since the start of the trace
+		UInt32  m_Type;
+		AString m_Data;    ///< The packet, including its length and type
+	} ;
+
+	typedef std::vector<sPacket> cPackets;
+
+	cTrace(void);
+
+	/// Reads the whole trace file. Returns true if successful; on failure, a_Error is set to the reason
+	bool Load(const AString & a_FileName, AString & a_Error);
+
+	UInt32 GetProtocolVersion(void) const { return m_ProtocolVersion; }
+
+	const cPackets & GetPackets(void) const { return m_Packets; }
+
+	/// Returns the time of the last packet, in msec since the start of the trace
+	Int64 GetLength(void) const { return m_Packets.empty() ? 0 : m_Packets.back().m_Time; }
+
+	/// Returns true if the trace contains a player position; a_X, a_Y and a_Z are set to the first one
+	bool GetStartPos(double & a_X, double & a_Y, double & a_Z) const;
+
+	/// Writes a VarInt into a_Data
+	static void AppendVarInt(AString & a_Data, UInt32 a_Value);
+
+	/// Reads a VarInt from a_Data at a_Pos and advances a_Pos past it. Returns false if the data ends prematurely
+	static bool ReadVarInt(const AString & a_Data, size_t & a_Pos, UInt32 & a_Value);
+
+protected:
+	UInt32   m_ProtocolVersion;
+	cPackets m_Packets;
+} ;
+
+
+
+
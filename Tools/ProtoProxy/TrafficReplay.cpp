@@ -0,0 +1,301 @@
+
+// TrafficReplay.cpp
+
+// Implements the main app entrypoint of TrafficReplay, the load generator replaying the traces recorded by ProtoProxy
+
+/*
+TrafficReplay logs N synthetic clients into a local server and makes each of them replay the same trace, looping it
+for the given duration. The movement, digging and placing are moved to where the server spawned each client.
+The server must run with the authentication disabled (Authenticate=0 in settings.ini), the clients don't encrypt.
+Usage: TrafficReplay <trace-file> [num-clients] [duration-sec] [server-port] [login-interval-msec]
+
+The report measures the server as the clients see it:
+	- the login time, from connecting until the server spawns the player;
+	- the latency, the round-trip time of a Tab-Complete packet each client sends every second;
+	- the world tick rate, from the world age in the server's Time Update packets;
+	- the bandwidth both ways.
+*/
+
+#include "Globals.h"
+#include "ReplayClient.h"
+#include "OSSupport/Timer.h"
+
+#ifndef _WIN32
+	#include <signal.h>
+#endif
+
+
+
+
+
+/// Number of msec between the progress reports
+#define REPORT_INTERVAL 10000
+
+/// Number of ticks per second of a server that keeps up
+#define TICKS_PER_SECOND 20
+
+
+
+
+
+typedef std::vector<cReplayClient *> cReplayClients;
+
+
+
+
+
+/// Returns the a_Percentile-th percentile of the (sorted) values
+static int GetPercentile(const std::vector<int> & a_SortedValues, int a_Percentile)
+{
+	if (a_SortedValues.empty())
+	{
+		return 0;
+	}
+	return a_SortedValues[(a_SortedValues.size() - 1) * a_Percentile / 100];
+}
+
+
+
+
+
+/// Prints the progress line: the clients playing and the latency and traffic since the last report.
+/// a_NumRTTsReported holds the number of each client's probes already reported, a_NumBytesReported the traffic.
+static void PrintProgress(const cReplayClients & a_Clients, Int64 a_Elapsed, Int64 a_Interval, std::vector<size_t> & a_NumRTTsReported, Int64 & a_NumBytesReported)
+{
+	int NumPlaying = 0;
+	std::vector<int> RTTs;
+	Int64 NumBytes = 0;
+	for (size_t i = 0; i < a_Clients.size(); i++)
+	{
+		const cReplayClient & Client = *a_Clients[i];
+		if (Client.IsConnected() && Client.HasSpawned())
+		{
+			NumPlaying++;
+		}
+		const std::vector<int> & ClientRTTs = Client.GetProbeRTTs();
+		RTTs.insert(RTTs.end(), ClientRTTs.begin() + a_NumRTTsReported[i], ClientRTTs.end());
+		a_NumRTTsReported[i] = ClientRTTs.size();
+		NumBytes += Client.GetNumBytesReceived() + Client.GetNumBytesSent();
+	}
+	std::sort(RTTs.begin(), RTTs.end());
+	printf("[%4d s] %d clients playing, latency median %d msec, 95th %d msec, traffic %.1f KiB/s\n",
+		(int)(a_Elapsed / 1000), NumPlaying, GetPercentile(RTTs, 50), GetPercentile(RTTs, 95),
+		(double)(NumBytes - a_NumBytesReported) * 1000 / 1024 / std::max(a_Interval, 1LL)
+	);
+	a_NumBytesReported = NumBytes;
+}
+
+
+
+
+
+/// Prints the summary of the whole replay
+static void PrintSummary(const cReplayClients & a_Clients, Int64 a_Duration)
+{
+	int NumSpawned = 0, NumDisconnected = 0, NumProbesLost = 0, NumPacketsReplayed = 0, NumPasses = 0;
+	Int64 NumBytesSent = 0, NumBytesReceived = 0, NumTicks = 0, NumTickMSec = 0, TotalLoginTime = 0, MaxLoginTime = 0;
+	std::vector<int> RTTs;
+	std::map<AString, int> DisconnectReasons;
+	for (cReplayClients::const_iterator itr = a_Clients.begin(); itr != a_Clients.end(); ++itr)
+	{
+		const cReplayClient & Client = **itr;
+		if (Client.HasSpawned())
+		{
+			NumSpawned++;
+			TotalLoginTime += Client.GetLoginTime();
+			MaxLoginTime = std::max(MaxLoginTime, Client.GetLoginTime());
+		}
+		if (!Client.IsConnected() && !Client.GetDisconnectReason().empty())
+		{
+			NumDisconnected++;
+			DisconnectReasons[Client.GetDisconnectReason()] += 1;
+		}
+		NumProbesLost += Client.GetNumProbesLost();
+		NumPacketsReplayed += Client.GetNumPacketsReplayed();
+		NumPasses += Client.GetNumPasses();
+		NumBytesSent += Client.GetNumBytesSent();
+		NumBytesReceived += Client.GetNumBytesReceived();
+		RTTs.insert(RTTs.end(), Client.GetProbeRTTs().begin(), Client.GetProbeRTTs().end());
+		Int64 ClientTicks, ClientMSec;
+		Client.GetWorldAgeProgress(ClientTicks, ClientMSec);
+		NumTicks += ClientTicks;
+		NumTickMSec += ClientMSec;
+	}
+	std::sort(RTTs.begin(), RTTs.end());
+	double Seconds = (double)std::max(a_Duration, 1LL) / 1000;
+
+	printf("\nSummary of %d clients over %.0f seconds:\n", (int)a_Clients.size(), Seconds);
+	printf("  spawned: %d, disconnected before the end: %d\n", NumSpawned, NumDisconnected);
+	for (std::map<AString, int>::const_iterator itr = DisconnectReasons.begin(); itr != DisconnectReasons.end(); ++itr)
+	{
+		printf("    %4d x %s\n", itr->second, itr->first.c_str());
+	}
+	printf("  login time: average %d msec, max %d msec\n",
+		(NumSpawned > 0) ? (int)(TotalLoginTime / NumSpawned) : 0, (int)MaxLoginTime
+	);
+	printf("  latency: median %d msec, 95th percentile %d msec, 99th percentile %d msec, max %d msec (%d probes, %d lost)\n",
+		GetPercentile(RTTs, 50), GetPercentile(RTTs, 95), GetPercentile(RTTs, 99), GetPercentile(RTTs, 100),
+		(int)RTTs.size(), NumProbesLost
+	);
+	if (NumTickMSec > 0)
+	{
+		double TPS = (double)NumTicks * 1000 / NumTickMSec;
+		if (TPS < TICKS_PER_SECOND - 0.1)
+		{
+			printf("  server tick rate: %.2f TPS, the ticks take %.1f msec on average\n", TPS, 1000 / std::max(TPS, 0.01));
+		}
+		else
+		{
+			printf("  server tick rate: %.2f TPS, the ticks keep up (each shorter than %d msec)\n", TPS, 1000 / TICKS_PER_SECOND);
+		}
+	}
+	else
+	{
+		printf("  server tick rate: unknown, no time updates received\n");
+	}
+	printf("  bandwidth: %.1f KiB/s received (%.1f KiB/s per client), %.1f KiB/s sent\n",
+		(double)NumBytesReceived / 1024 / Seconds, (double)NumBytesReceived / 1024 / Seconds / std::max((int)a_Clients.size(), 1),
+		(double)NumBytesSent / 1024 / Seconds
+	);
+	printf("  packets replayed: %d, in %d complete passes through the trace\n", NumPacketsReplayed, NumPasses);
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	if (argc < 2)
+	{
+		printf("Usage: %s <trace-file> [num-clients] [duration-sec] [server-port] [login-interval-msec]\n", argv[0]);
+		return 1;
+	}
+	AString TraceFileName = argv[1];
+	int NumClients    = (argc > 2) ? atoi(argv[2]) : 10;
+	int Duration      = ((argc > 3) ? atoi(argv[3]) : 60) * 1000;
+	int ServerPort    = (argc > 4) ? atoi(argv[4]) : 25565;
+	int LoginInterval = (argc > 5) ? atoi(argv[5]) : 100;
+	if (NumClients > FD_SETSIZE - 1)
+	{
+		printf("Too many clients, at most %d are supported\n", FD_SETSIZE - 1);
+		return 1;
+	}
+
+	#ifdef _WIN32
+		WSAData wsa;
+		int res = WSAStartup(0x0202, &wsa);
+		if (res != 0)
+		{
+			printf("Cannot initialize WinSock: %d\n", res);
+			return res;
+		}
+	#else
+		// A send() to a connection closed by the server would kill the process otherwise:
+		signal(SIGPIPE, SIG_IGN);
+	#endif  // _WIN32
+
+	cTrace Trace;
+	AString Error;
+	if (!Trace.Load(TraceFileName, Error))
+	{
+		printf("Cannot load trace \"%s\": %s\n", TraceFileName.c_str(), Error.c_str());
+		return 1;
+	}
+	printf("Replaying trace \"%s\" (%d packets, %.1f seconds, protocol %u) by %d clients for %d seconds against localhost:%d\n",
+		TraceFileName.c_str(), (int)Trace.GetPackets().size(), (double)Trace.GetLength() / 1000, Trace.GetProtocolVersion(),
+		NumClients, Duration / 1000, ServerPort
+	);
+
+	cReplayClients Clients;
+	for (int i = 0; i < NumClients; i++)
+	{
+		Clients.push_back(new cReplayClient(Trace, Printf("Replay%d", i), (short)ServerPort));
+	}
+
+	// Run the clients, all in this thread, until the time's up:
+	cTimer Timer;
+	Int64 Start = Timer.GetNowTime();
+	Int64 NextReport = Start + REPORT_INTERVAL;
+	int NumConnected = 0;
+	std::vector<size_t> NumRTTsReported(Clients.size(), 0);
+	Int64 NumBytesReported = 0;
+	for (;;)
+	{
+		Int64 Now = Timer.GetNowTime();
+		if (Now >= Start + Duration)
+		{
+			break;
+		}
+
+		// Log in the clients one by one, so that the logins don't all measure the same burst:
+		while ((NumConnected < NumClients) && (Now >= Start + (Int64)NumConnected * LoginInterval))
+		{
+			Clients[NumConnected]->Connect(Now);
+			NumConnected++;
+		}
+
+		// Wait for the data from the server or for the next thing to send, whichever comes first:
+		Int64 Wakeup = std::min(Start + Duration, NextReport);
+		if (NumConnected < NumClients)
+		{
+			Wakeup = std::min(Wakeup, Start + (Int64)NumConnected * LoginInterval);
+		}
+		fd_set ReadFDs;
+		FD_ZERO(&ReadFDs);
+		SOCKET MaxSocket = 0;
+		for (cReplayClients::const_iterator itr = Clients.begin(); itr != Clients.end(); ++itr)
+		{
+			if (!(*itr)->IsConnected())
+			{
+				continue;
+			}
+			FD_SET((*itr)->GetSocket(), &ReadFDs);
+			MaxSocket = std::max(MaxSocket, (*itr)->GetSocket());
+			Int64 NextTick = (*itr)->GetNextTickTime();
+			if (NextTick >= 0)
+			{
+				Wakeup = std::min(Wakeup, NextTick);
+			}
+		}
+		Int64 Timeout = std::max(Wakeup - Now, 0LL);
+		timeval tv;
+		tv.tv_sec = (long)(Timeout / 1000);
+		tv.tv_usec = (long)(Timeout % 1000) * 1000;
+		if (select((int)MaxSocket + 1, &ReadFDs, NULL, NULL, &tv) < 0)
+		{
+			printf("select() failed: %d; aborting the replay\n", SocketError);
+			break;
+		}
+
+		Now = Timer.GetNowTime();
+		for (cReplayClients::iterator itr = Clients.begin(); itr != Clients.end(); ++itr)
+		{
+			if ((*itr)->IsConnected() && FD_ISSET((*itr)->GetSocket(), &ReadFDs))
+			{
+				(*itr)->ReceiveData(Now);
+			}
+			if ((*itr)->IsConnected())
+			{
+				(*itr)->Tick(Now);
+			}
+		}
+
+		if (Now >= NextReport)
+		{
+			PrintProgress(Clients, Now - Start, Now - NextReport + REPORT_INTERVAL, NumRTTsReported, NumBytesReported);
+			NextReport += REPORT_INTERVAL;
+		}
+	}
+
+	PrintSummary(Clients, Timer.GetNowTime() - Start);
+	for (cReplayClients::iterator itr = Clients.begin(); itr != Clients.end(); ++itr)
+	{
+		delete *itr;
+	}
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,183 @@
+
+// QueuePerformanceTest.cpp
+
+// Measures the speed of cQueue with the chunk coords, compared to the previous std::list-based implementation
+
+/*
+The workload resembles the world storage's load queue when many players join at once: the chunks around them
+are queued, most of them are requested again while still queued, some get unloaded and unqueued before being
+loaded, and a few are moved to the front. Both queues must dequeue the chunks in the same order.
+*/
+
+#include "Globals.h"
+#include "ChunkDef.h"
+#include "OSSupport/Queue.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+/** Number of different chunk coords queued */
+#define NUM_COORDS 100000
+
+/** Every n-th queued chunk is removed from the queue before being dequeued */
+#define REMOVE_EVERY 4
+
+/** Every n-th queued chunk is moved to the front of the queue */
+#define PRIORITIZE_EVERY 100
+
+
+
+
+
+/** The previous cQueue storage, used as the reference for the results and the speed */
+class cListQueue
+{
+public:
+	void EnqueueItemIfNotPresent(const cChunkCoords & a_Item)
+	{
+		for (cChunkCoordsList::iterator itr = m_Contents.begin(); itr != m_Contents.end(); ++itr)
+		{
+			if ((*itr) == a_Item)
+			{
+				return;
+			}
+		}
+		m_Contents.push_back(a_Item);
+	}
+
+	void EnqueueItemAtFront(const cChunkCoords & a_Item)
+	{
+		Remove(a_Item);
+		m_Contents.push_front(a_Item);
+	}
+
+	bool TryDequeueItem(cChunkCoords & a_Item)
+	{
+		if (m_Contents.empty())
+		{
+			return false;
+		}
+		a_Item = m_Contents.front();
+		m_Contents.pop_front();
+		return true;
+	}
+
+	bool Remove(const cChunkCoords & a_Item)
+	{
+		for (cChunkCoordsList::iterator itr = m_Contents.begin(); itr != m_Contents.end(); ++itr)
+		{
+			if ((*itr) == a_Item)
+			{
+				m_Contents.erase(itr);
+				return true;
+			}
+		}
+		return false;
+	}
+
+protected:
+	cChunkCoordsList m_Contents;
+} ;
+
+
+
+
+
+/** Returns the coords of the chunks in a square spiral around [0, 0], the way the chunks around a player get queued */
+static cChunkCoordsVector MakeSpiral(int a_Count)
+{
+	cChunkCoordsVector Res;
+	Res.reserve(a_Count);
+	int x = 0, z = 0, dx = 1, dz = 0, Len = 1;
+	while ((int)Res.size() < a_Count)
+	{
+		for (int i = 0; (i < Len) && ((int)Res.size() < a_Count); i++)
+		{
+			Res.push_back(cChunkCoords(x, 0, z));
+			x += dx;
+			z += dz;
+		}
+		std::swap(dx, dz);
+		dx = -dx;
+		if (dz == 0)
+		{
+			Len += 1;
+		}
+	}
+	return Res;
+}
+
+
+
+
+
+/** Runs the workload on the queue, returns the time it took in msec; a_Checksum receives the checksum of the dequeue order */
+template <typename QueueType>
+static long long Run(QueueType & a_Queue, const cChunkCoordsVector & a_Coords, UInt32 & a_Checksum, int & a_NumDequeued)
+{
+	cTimer Timer;
+	long long Start = Timer.GetNowTime();
+	for (cChunkCoordsVector::const_iterator itr = a_Coords.begin(), end = a_Coords.end(); itr != end; ++itr)
+	{
+		a_Queue.EnqueueItemIfNotPresent(*itr);
+	}
+	for (cChunkCoordsVector::const_iterator itr = a_Coords.begin(), end = a_Coords.end(); itr != end; ++itr)
+	{
+		// Requested again by another player:
+		a_Queue.EnqueueItemIfNotPresent(*itr);
+	}
+	for (size_t i = 0; i < a_Coords.size(); i += REMOVE_EVERY)
+	{
+		a_Queue.Remove(a_Coords[i]);
+	}
+	for (size_t i = 1; i < a_Coords.size(); i += PRIORITIZE_EVERY)
+	{
+		a_Queue.EnqueueItemAtFront(a_Coords[i]);
+	}
+	a_Checksum = 2166136261u;  // FNV-1a
+	a_NumDequeued = 0;
+	cChunkCoords Coords(0, 0, 0);
+	while (a_Queue.TryDequeueItem(Coords))
+	{
+		a_Checksum = (a_Checksum ^ (UInt32)Coords.m_ChunkX) * 16777619u;
+		a_Checksum = (a_Checksum ^ (UInt32)Coords.m_ChunkZ) * 16777619u;
+		a_NumDequeued += 1;
+	}
+	return Timer.GetNowTime() - Start;
+}
+
+
+
+
+
+int main(int argc, char * argv[])
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+
+	cChunkCoordsVector Coords = MakeSpiral(NUM_COORDS);
+	LOG("Queueing %d chunk coords twice, removing every %d-th and prioritizing every %d-th...", NUM_COORDS, REMOVE_EVERY, PRIORITIZE_EVERY);
+
+	UInt32 Checksum, RefChecksum;
+	int NumDequeued, RefNumDequeued;
+	cQueue<cChunkCoords> Queue;
+	long long MSec = Run(Queue, Coords, Checksum, NumDequeued);
+	LOG("cQueue:     %6lld msec, %d chunks dequeued", MSec, NumDequeued);
+
+	cListQueue RefQueue;
+	long long RefMSec = Run(RefQueue, Coords, RefChecksum, RefNumDequeued);
+	LOG("std::list:  %6lld msec, %d chunks dequeued", RefMSec, RefNumDequeued);
+
+	if ((Checksum != RefChecksum) || (NumDequeued != RefNumDequeued))
+	{
+		LOGWARNING("The dequeue orders DIFFER!");
+		return 1;
+	}
+	LOG("The dequeue orders match, cQueue is %.1f times faster", (double)std::max(RefMSec, 1LL) / std::max(MSec, 1LL));
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,363 @@
+
+// SimulatorPerformanceTest.cpp
+
+// Measures the speed of the real floody fluid simulator and fire simulator on a water flood and a forest fire
+
+/*
+The simulators are the server's real classes, with their real per-chunk queues; they simulate a piece of the world
+made of stubbed chunks (see Stubs.cpp), which keep the blocks and deliver the block changes back to the simulator the
+same way the server does. Each scenario is ticked until the simulator's queues stay empty, and is run twice to check
+that the results are repeatable.
+*/
+
+#include "Globals.h"
+#include "Chunk.h"
+#include "World.h"
+#include "Simulator/FloodyFluidSimulator.h"
+#include "Simulator/FireSimulator.h"
+#include "OSSupport/Timer.h"
+#include "MersenneTwister.h"
+
+
+
+
+
+/** Size of the simulated piece of the world, in chunks along each horizontal axis */
+#define WORLD_CHUNKS 8
+
+/** Size of the simulated piece of the world, in blocks along each horizontal axis */
+#define WORLD_SIZE (WORLD_CHUNKS * cChunkDef::Width)
+
+/** Length of a tick, in msec, as passed to the simulators */
+#define TICK_DT 50.0f
+
+/** Number of the fluid simulator's delay slots; same as the water's default TickDelay in world.ini */
+#define WATER_TICK_DELAY 5
+
+/** The scenarios are stopped after this many ticks even if the simulator is still busy */
+#define MAX_TICKS 20000
+
+/** Defined in Stubs.cpp: the simulator that the stubbed chunks wake up and tick */
+extern cSimulator * g_Simulator;
+
+/** Defined in Stubs.cpp: number of the block changes made in the stubbed chunks */
+extern Int64 g_NumBlockChanges;
+
+/** Defined in Stubs.cpp: the random generator for cChunk::GetTickRandomNumber() */
+extern MTRand g_TickRand;
+
+
+
+
+
+/** Pseudo-random but repeatable number for the specified coords */
+static unsigned Hash(int a_X, int a_Y, int a_Z)
+{
+	unsigned Res = ((unsigned)a_X * 73856093u) ^ ((unsigned)a_Y * 19349663u) ^ ((unsigned)a_Z * 83492791u);
+	Res ^= Res >> 13;
+	Res *= 0x5bd1e995;
+	return Res ^ (Res >> 15);
+}
+
+
+
+
+
+/** The simulators and the chunks keep a reference to their world, but the code that the scenarios reach never uses it.
+There is no cWorld in the benchmark, so they get this unconstructed storage instead. */
+static cWorld & GetWorld(void)
+{
+	static double Storage[sizeof(cWorld) / sizeof(double) + 1];
+	return *reinterpret_cast<cWorld *>(Storage);
+}
+
+
+
+
+
+/** The piece of the world: WORLD_CHUNKS x WORLD_CHUNKS stubbed chunks, linked to their neighbors */
+class cTestWorld
+{
+public:
+	/** Creates the chunks; g_Simulator needs to be set already, so that the chunks create its chunk data */
+	cTestWorld(void)
+	{
+		for (int z = 0; z < WORLD_CHUNKS; z++)
+		{
+			for (int x = 0; x < WORLD_CHUNKS; x++)
+			{
+				cChunk * NeighborXM = (x > 0) ? m_Chunks[x - 1 + z * WORLD_CHUNKS] : NULL;
+				cChunk * NeighborZM = (z > 0) ? m_Chunks[x + (z - 1) * WORLD_CHUNKS] : NULL;
+				m_Chunks[x + z * WORLD_CHUNKS] = new cChunk(x, ZERO_CHUNK_Y, z, NULL, &GetWorld(), NeighborXM, NULL, NeighborZM, NULL);
+			}
+		}
+	}
+
+	~cTestWorld()
+	{
+		for (size_t i = 0; i < ARRAYCOUNT(m_Chunks); i++)
+		{
+			delete m_Chunks[i];
+		}
+	}
+
+	cChunk * GetChunk(int a_BlockX, int a_BlockZ)
+	{
+		return m_Chunks[(a_BlockX / cChunkDef::Width) + (a_BlockZ / cChunkDef::Width) * WORLD_CHUNKS];
+	}
+
+	/** Sets the block without notifying the simulator, used for building the scenario */
+	void FastSetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta = 0)
+	{
+		GetChunk(a_BlockX, a_BlockZ)->FastSetBlock(a_BlockX % cChunkDef::Width, a_BlockY, a_BlockZ % cChunkDef::Width, a_BlockType, a_BlockMeta);
+	}
+
+	/** Sets the block and lets the simulator know in the next tick */
+	void SetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta = 0)
+	{
+		GetChunk(a_BlockX, a_BlockZ)->SetBlock(a_BlockX % cChunkDef::Width, a_BlockY, a_BlockZ % cChunkDef::Width, a_BlockType, a_BlockMeta);
+	}
+
+	/** Ticks the simulator and all the chunks once */
+	void Tick(void)
+	{
+		g_Simulator->Simulate(TICK_DT);
+		for (size_t i = 0; i < ARRAYCOUNT(m_Chunks); i++)
+		{
+			m_Chunks[i]->Tick(TICK_DT);
+		}
+	}
+
+	/** Returns a checksum of all the block types */
+	UInt32 Checksum(void)
+	{
+		UInt32 Res = 2166136261u;  // FNV-1a
+		for (size_t i = 0; i < ARRAYCOUNT(m_Chunks); i++)
+		{
+			BLOCKTYPE BlockTypes[cChunkDef::NumBlocks];
+			m_Chunks[i]->GetBlockTypes(BlockTypes);
+			for (int j = 0; j < cChunkDef::NumBlocks; j++)
+			{
+				Res = (Res ^ BlockTypes[j]) * 16777619u;
+			}
+		}
+		return Res;
+	}
+
+	cChunk * m_Chunks[WORLD_CHUNKS * WORLD_CHUNKS];
+} ;
+
+
+
+
+
+/** Water poured into an uneven stone basin from a spring above each chunk; it flows down and sideways until it settles */
+class cFloodScenario
+{
+public:
+	cFloodScenario(void) :
+		m_Simulator(GetWorld(), E_BLOCK_WATER, E_BLOCK_STATIONARY_WATER, 1, WATER_TICK_DELAY, 2),  // Water's defaults from world.ini
+		m_NumSimulated(0),
+		m_NumSkipped(0)
+	{
+	}
+
+	cSimulator * GetSimulator(void) { return &m_Simulator; }
+
+	void Prepare(cTestWorld & a_World)
+	{
+		for (int z = 0; z < WORLD_SIZE; z++)
+		{
+			for (int x = 0; x < WORLD_SIZE; x++)
+			{
+				int Height = 4 + (int)(Hash(x / 4, 0, z / 4) % 12);
+				for (int y = 0; y < Height; y++)
+				{
+					a_World.FastSetBlock(x, y, z, E_BLOCK_STONE);
+				}
+			}
+		}
+	}
+
+	void Start(cTestWorld & a_World)
+	{
+		for (int z = cChunkDef::Width / 2; z < WORLD_SIZE; z += cChunkDef::Width)
+		{
+			for (int x = cChunkDef::Width / 2; x < WORLD_SIZE; x += cChunkDef::Width)
+			{
+				a_World.SetBlock(x, 16, z, E_BLOCK_WATER);
+			}
+		}
+	}
+
+	bool IsIdle(cTestWorld & a_World)
+	{
+		m_NumSimulated += m_Simulator.GetNumSimulatedLastTick();
+		m_NumSkipped   += m_Simulator.GetNumSkippedLastTick();
+		for (size_t i = 0; i < ARRAYCOUNT(a_World.m_Chunks); i++)
+		{
+			cDelayedFluidSimulatorChunkData * Data = (cDelayedFluidSimulatorChunkData *)a_World.m_Chunks[i]->GetWaterSimulatorData();
+			for (int Slot = 0; Slot < WATER_TICK_DELAY; Slot++)
+			{
+				if (!Data->m_Slots[Slot].empty())
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	AString GetStats(void) const
+	{
+		return Printf("%lld blocks simulated, %lld settled blocks skipped", m_NumSimulated, m_NumSkipped);
+	}
+
+protected:
+	cFloodyFluidSimulator m_Simulator;
+	Int64 m_NumSimulated, m_NumSkipped;
+} ;
+
+
+
+
+
+/** A forest of planks set on fire at one corner; the fire spreads through it and burns it out */
+class cFireScenario
+{
+public:
+	cFireScenario(void) :
+		m_Simulator(GetWorld(), GetIniFile())
+	{
+	}
+
+	cSimulator * GetSimulator(void) { return &m_Simulator; }
+
+	void Prepare(cTestWorld & a_World)
+	{
+		for (int z = 0; z < WORLD_SIZE; z++)
+		{
+			for (int x = 0; x < WORLD_SIZE; x++)
+			{
+				for (int y = 0; y < 4; y++)
+				{
+					a_World.FastSetBlock(x, y, z, E_BLOCK_STONE);
+				}
+				for (int y = 4; y < 7; y++)
+				{
+					if ((Hash(x, y, z) % 3) != 0)
+					{
+						a_World.FastSetBlock(x, y, z, E_BLOCK_PLANKS);
+					}
+				}
+			}
+		}
+	}
+
+	void Start(cTestWorld & a_World)
+	{
+		a_World.SetBlock(0, 7, 0, E_BLOCK_FIRE);
+	}
+
+	bool IsIdle(cTestWorld & a_World)
+	{
+		for (size_t i = 0; i < ARRAYCOUNT(a_World.m_Chunks); i++)
+		{
+			if (!a_World.m_Chunks[i]->GetFireSimulatorData().m_Blocks.empty())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	AString GetStats(void) const
+	{
+		return "";
+	}
+
+protected:
+	cFireSimulator m_Simulator;
+
+	/** The fire simulator's settings: the defaults, except for a higher flammability, so that the fire spreads through the whole forest */
+	static cIniFile & GetIniFile(void)
+	{
+		static cIniFile IniFile;
+		IniFile.SetValueI("FireSimulator", "Flammability", 20000);
+		return IniFile;
+	}
+} ;
+
+
+
+
+
+/** Runs the scenario once and logs the time it took; a_Checksum receives the checksum of the resulting world */
+template <typename Scenario>
+static void Run(UInt32 & a_Checksum)
+{
+	Scenario Scn;
+	g_Simulator = Scn.GetSimulator();
+	cTestWorld World;
+	Scn.Prepare(World);
+	g_NumBlockChanges = 0;
+	g_TickRand.seed(1);
+
+	cTimer Timer;
+	long long Start = Timer.GetNowTime();
+	Scn.Start(World);
+	int NumTicks = 0;
+	int NumIdleTicks = 0;
+	while ((NumIdleTicks < 2) && (NumTicks < MAX_TICKS))
+	{
+		// The last block changes wake the simulator up in the next tick, so it needs to be idle for two ticks in a row:
+		World.Tick();
+		NumTicks += 1;
+		NumIdleTicks = Scn.IsIdle(World) ? NumIdleTicks + 1 : 0;
+	}
+	long long MSec = Timer.GetNowTime() - Start;
+
+	a_Checksum = World.Checksum();
+	AString Stats = Scn.GetStats();
+	LOG("  %6lld msec, %d ticks%s, %lld block changes%s%s",
+		MSec, NumTicks, (NumTicks < MAX_TICKS) ? "" : " (stopped)", g_NumBlockChanges,
+		Stats.empty() ? "" : ", ", Stats.c_str()
+	);
+	g_Simulator = NULL;
+}
+
+
+
+
+
+/** Runs the scenario twice and checks that the results are the same */
+template <typename Scenario>
+static void Measure(const char * a_Name)
+{
+	LOG("%s:", a_Name);
+	UInt32 Checksum1, Checksum2;
+	Run<Scenario>(Checksum1);
+	Run<Scenario>(Checksum2);
+	if (Checksum1 != Checksum2)
+	{
+		LOG("  RESULTS DIFFER!");
+	}
+}
+
+
+
+
+
+int main(void)
+{
+	new cMCLogger();  // Create a logger, it will be the global one
+
+	LOG("Simulating %d x %d chunks", WORLD_CHUNKS, WORLD_CHUNKS);
+	Measure<cFloodScenario>("Water flood");
+	Measure<cFireScenario> ("Forest fire");
+	return 0;
+}
+
+
+
+
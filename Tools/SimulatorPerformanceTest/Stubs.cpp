@@ -0,0 +1,419 @@
+
+// Stubs.cpp
+
+// Implements the stubbed cChunk that the simulator benchmark runs the real simulators on, and stubs for the server
+// functions that the simulators reference, but the benchmark's scenarios never reach.
+// Linking the real cChunk would pull in the entire server (cWorld, cChunkMap, the block handlers, ...)
+
+/*
+The stubbed chunk keeps only the block types and metas, in the real cChunk's arrays, and is linked to its neighbors
+the same way the real one is. Block changes are delivered to the simulator the same way as in the server: SetBlock()
+queues the block for checking and the chunk's next Tick() wakes the simulator up for it (which is what the real
+CheckBlocks() does through cBlockHandler::Check()), then runs the simulator's SimulateChunk() on the chunk.
+*/
+
+#include "Globals.h"
+#include "Chunk.h"
+#include "ChunkMap.h"
+#include "Root.h"
+#include "Bindings/PluginManager.h"
+#include "Blocks/BlockHandler.h"
+#include "Simulator/FluidSimulator.h"
+#include "MersenneTwister.h"
+
+
+
+
+
+/** The simulator that the stubbed chunks wake up and tick; set by the benchmark before creating the chunks */
+cSimulator * g_Simulator = NULL;
+
+/** Number of the blocks changed through SetBlock() or FastSetBlock(), for the benchmark's statistics */
+Int64 g_NumBlockChanges = 0;
+
+/** The random generator for cChunk::GetTickRandomNumber(); the benchmark seeds it with a constant before each run */
+MTRand g_TickRand;
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cChunk:
+
+cChunk::cChunk(
+	int a_ChunkX, int a_ChunkY, int a_ChunkZ,
+	cChunkMap * a_ChunkMap, cWorld * a_World,
+	cChunk * a_NeighborXM, cChunk * a_NeighborXP, cChunk * a_NeighborZM, cChunk * a_NeighborZP
+) :
+	m_IsValid(true),
+	m_IsLightValid(false),
+	m_IsDirty(false),
+	m_IsSaving(false),
+	m_HasLoadFailed(false),
+	m_StayCount(0),
+	m_PosX(a_ChunkX),
+	m_PosY(a_ChunkY),
+	m_PosZ(a_ChunkZ),
+	m_World(a_World),
+	m_ChunkMap(a_ChunkMap),
+	m_BlockTickX(0),
+	m_BlockTickY(0),
+	m_BlockTickZ(0),
+	m_NeighborXM(a_NeighborXM),
+	m_NeighborXP(a_NeighborXP),
+	m_NeighborZM(a_NeighborZM),
+	m_NeighborZP(a_NeighborZP),
+	m_TickRegion(NULL),
+	m_WaterSimulatorData(NULL),
+	m_LavaSimulatorData(NULL)
+{
+	memset(m_BlockTypes, 0, sizeof(m_BlockTypes));
+	memset(m_BlockMeta,  0, sizeof(m_BlockMeta));
+
+	// The fluid simulators keep their queues in the chunk's water data:
+	cFluidSimulator * FluidSimulator = dynamic_cast<cFluidSimulator *>(g_Simulator);
+	if (FluidSimulator != NULL)
+	{
+		m_WaterSimulatorData = FluidSimulator->CreateChunkData();
+	}
+
+	if (a_NeighborXM != NULL)
+	{
+		a_NeighborXM->m_NeighborXP = this;
+	}
+	if (a_NeighborXP != NULL)
+	{
+		a_NeighborXP->m_NeighborXM = this;
+	}
+	if (a_NeighborZM != NULL)
+	{
+		a_NeighborZM->m_NeighborZP = this;
+	}
+	if (a_NeighborZP != NULL)
+	{
+		a_NeighborZP->m_NeighborZM = this;
+	}
+}
+
+
+
+
+
+cChunk::~cChunk()
+{
+	if (m_NeighborXM != NULL)
+	{
+		m_NeighborXM->m_NeighborXP = NULL;
+	}
+	if (m_NeighborXP != NULL)
+	{
+		m_NeighborXP->m_NeighborXM = NULL;
+	}
+	if (m_NeighborZM != NULL)
+	{
+		m_NeighborZM->m_NeighborZP = NULL;
+	}
+	if (m_NeighborZP != NULL)
+	{
+		m_NeighborZP->m_NeighborZM = NULL;
+	}
+	delete m_WaterSimulatorData;
+	delete m_LavaSimulatorData;
+}
+
+
+
+
+
+void cChunk::Tick(float a_Dt)
+{
+	// Wake the simulator up for the changed blocks, as CheckBlocks() does:
+	std::vector<unsigned int> ToTickBlocks;
+	std::swap(m_ToTickBlocks, ToTickBlocks);
+	for (std::vector<unsigned int>::const_iterator itr = ToTickBlocks.begin(), end = ToTickBlocks.end(); itr != end; ++itr)
+	{
+		Vector3i Pos = IndexToCoordinate(*itr);
+		g_Simulator->WakeUp(m_PosX * Width + Pos.x, Pos.y, m_PosZ * Width + Pos.z, this);
+	}
+
+	g_Simulator->SimulateChunk(a_Dt, m_PosX, m_PosZ, this);
+}
+
+
+
+
+
+int cChunk::GetTickRandomNumber(unsigned a_Range)
+{
+	return (int)g_TickRand.randInt(a_Range);
+}
+
+
+
+
+
+void cChunk::SetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
+{
+	FastSetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType, a_BlockMeta);
+	m_ToTickBlocks.push_back(MakeIndexNoCheck(a_RelX, a_RelY, a_RelZ));
+}
+
+
+
+
+
+void cChunk::FastSetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, BLOCKTYPE a_BlockMeta)
+{
+	ASSERT(!((a_RelX < 0) || (a_RelX >= Width) || (a_RelY < 0) || (a_RelY >= Height) || (a_RelZ < 0) || (a_RelZ >= Width)));
+
+	int Index = MakeIndexNoCheck(a_RelX, a_RelY, a_RelZ);
+	if ((m_BlockTypes[Index] == a_BlockType) && (GetNibble(m_BlockMeta, Index) == a_BlockMeta))
+	{
+		return;
+	}
+	m_BlockTypes[Index] = a_BlockType;
+	SetNibble(m_BlockMeta, Index, a_BlockMeta);
+	g_NumBlockChanges += 1;
+}
+
+
+
+
+
+BLOCKTYPE cChunk::GetBlock(int a_RelX, int a_RelY, int a_RelZ) const
+{
+	ASSERT(!((a_RelX < 0) || (a_RelX >= Width) || (a_RelY < 0) || (a_RelY >= Height) || (a_RelZ < 0) || (a_RelZ >= Width)));
+	return m_BlockTypes[MakeIndexNoCheck(a_RelX, a_RelY, a_RelZ)];
+}
+
+
+
+
+
+BLOCKTYPE cChunk::GetBlock(int a_BlockIdx) const
+{
+	ASSERT((a_BlockIdx >= 0) && (a_BlockIdx < NumBlocks));
+	return m_BlockTypes[a_BlockIdx];
+}
+
+
+
+
+
+void cChunk::GetBlockTypes(BLOCKTYPE * a_BlockTypes)
+{
+	memcpy(a_BlockTypes, m_BlockTypes, NumBlocks);
+}
+
+
+
+
+
+bool cChunk::UnboundedRelGetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType, NIBBLETYPE & a_BlockMeta) const
+{
+	if ((a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+	{
+		return false;
+	}
+	cChunk * Chunk = GetRelNeighborChunkAdjustCoords(a_RelX, a_RelZ);
+	if (Chunk == NULL)
+	{
+		// Outside of the benchmark's world
+		return false;
+	}
+	int Index = MakeIndexNoCheck(a_RelX, a_RelY, a_RelZ);
+	a_BlockType = Chunk->m_BlockTypes[Index];
+	a_BlockMeta = GetNibble(Chunk->m_BlockMeta, Index);
+	return true;
+}
+
+
+
+
+
+bool cChunk::UnboundedRelSetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
+{
+	if ((a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+	{
+		return false;
+	}
+	cChunk * Chunk = GetRelNeighborChunkAdjustCoords(a_RelX, a_RelZ);
+	if (Chunk == NULL)
+	{
+		// Outside of the benchmark's world
+		return false;
+	}
+	Chunk->SetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType, a_BlockMeta);
+	return true;
+}
+
+
+
+
+
+cChunk * cChunk::GetNeighborChunk(int a_BlockX, int a_BlockZ)
+{
+	int RelX = a_BlockX - m_PosX * Width;
+	int RelZ = a_BlockZ - m_PosZ * Width;
+	return GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+}
+
+
+
+
+
+cChunk * cChunk::GetRelNeighborChunkAdjustCoords(int & a_RelX, int & a_RelZ) const
+{
+	// Walk through the neighbors; there is no chunkmap to fall back to:
+	cChunk * ToReturn = const_cast<cChunk *>(this);
+	int RelX = a_RelX;
+	int RelZ = a_RelZ;
+	while ((RelX >= Width) && (ToReturn != NULL))
+	{
+		RelX -= Width;
+		ToReturn = ToReturn->m_NeighborXP;
+	}
+	while ((RelX < 0) && (ToReturn != NULL))
+	{
+		RelX += Width;
+		ToReturn = ToReturn->m_NeighborXM;
+	}
+	while ((RelZ >= Width) && (ToReturn != NULL))
+	{
+		RelZ -= Width;
+		ToReturn = ToReturn->m_NeighborZP;
+	}
+	while ((RelZ < 0) && (ToReturn != NULL))
+	{
+		RelZ += Width;
+		ToReturn = ToReturn->m_NeighborZM;
+	}
+	if (ToReturn != NULL)
+	{
+		a_RelX = RelX;
+		a_RelZ = RelZ;
+	}
+	return ToReturn;
+}
+
+
+
+
+
+void cChunk::BroadcastSoundEffect(const AString & a_SoundName, int a_SrcX, int a_SrcY, int a_SrcZ, float a_Volume, float a_Pitch, const cClientHandle * a_Exclude)
+{
+	// Only used by the fluid simulators when lava meets water, the benchmark's scenarios have no lava
+	UNUSED(a_SoundName);
+	UNUSED(a_SrcX);
+	UNUSED(a_SrcY);
+	UNUSED(a_SrcZ);
+	UNUSED(a_Volume);
+	UNUSED(a_Pitch);
+	UNUSED(a_Exclude);
+	ASSERT(!"There are no clients in the simulator benchmark");
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Server functions that the scenarios never reach:
+
+cBlockHandler * cBlockHandler::GetBlockHandler(BLOCKTYPE a_BlockType)
+{
+	// Only used by the fluid simulators for washing away blocks, the benchmark's scenarios have none
+	UNUSED(a_BlockType);
+	ASSERT(!"Blockhandlers are not available in the simulator benchmark");
+	return NULL;
+}
+
+
+
+
+
+cRoot * cRoot::s_Root = NULL;
+
+
+
+
+
+BLOCKTYPE cChunkMap::GetBlock(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	// Only used by cFluidSimulator::GetFlowingDirection(), for the entities in fluids
+	UNUSED(a_BlockX);
+	UNUSED(a_BlockY);
+	UNUSED(a_BlockZ);
+	ASSERT(!"There is no chunkmap in the simulator benchmark");
+	return E_BLOCK_AIR;
+}
+
+
+
+
+
+NIBBLETYPE cChunkMap::GetBlockMeta(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	// Only used by cFluidSimulator::GetFlowingDirection(), for the entities in fluids
+	UNUSED(a_BlockX);
+	UNUSED(a_BlockY);
+	UNUSED(a_BlockZ);
+	ASSERT(!"There is no chunkmap in the simulator benchmark");
+	return 0;
+}
+
+
+
+
+
+bool cChunkMap::ForEachChunkInRect(int a_MinChunkX, int a_MaxChunkX, int a_MinChunkZ, int a_MaxChunkZ, cChunkDataCallback & a_Callback)
+{
+	// Only used by the block handlers through cChunkInterface, for washing away blocks
+	UNUSED(a_MinChunkX);
+	UNUSED(a_MaxChunkX);
+	UNUSED(a_MinChunkZ);
+	UNUSED(a_MaxChunkZ);
+	UNUSED(a_Callback);
+	ASSERT(!"There is no chunkmap in the simulator benchmark");
+	return false;
+}
+
+
+
+
+
+bool cChunkMap::WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes)
+{
+	// Only used by the block handlers through cChunkInterface, for washing away blocks
+	UNUSED(a_Area);
+	UNUSED(a_MinBlockX);
+	UNUSED(a_MinBlockY);
+	UNUSED(a_MinBlockZ);
+	UNUSED(a_DataTypes);
+	ASSERT(!"There is no chunkmap in the simulator benchmark");
+	return false;
+}
+
+
+
+
+
+bool cPluginManager::CallHookBlockToPickups(cWorld * a_World, cEntity * a_Digger, int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta, cItems & a_Pickups)
+{
+	// Only used by the block handlers, for washing away blocks
+	UNUSED(a_World);
+	UNUSED(a_Digger);
+	UNUSED(a_BlockX);
+	UNUSED(a_BlockY);
+	UNUSED(a_BlockZ);
+	UNUSED(a_BlockType);
+	UNUSED(a_BlockMeta);
+	UNUSED(a_Pickups);
+	ASSERT(!"There are no plugins in the simulator benchmark");
+	return false;
+}
+
+
+
+
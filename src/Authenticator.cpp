@@ -2,14 +2,9 @@
 #include "Globals.h"  // NOTE: MSVC stupidness requires this to be the same across all modules
 
 #include "Authenticator.h"
-#include "OSSupport/BlockingTCPLink.h"
-#include "Root.h"
-#include "Server.h"
 
 #include "inifile/iniFile.h"
 
-#include <sstream>
-
 
 
 
@@ -18,15 +13,38 @@
 #define DEFAULT_AUTH_ADDRESS "/game/checkserver.jsp?user=%USERNAME%&serverId=%SERVERID%"
 #define MAX_REDIRECTS 10
 
+/** Default number of the worker threads, i. e. of the auth requests in progress at once */
+#define DEFAULT_NUM_THREADS 4
+
+/** Upper limit for the number of the worker threads set in the INI file */
+#define MAX_NUM_THREADS 64
+
+/** Default number of seconds for which a successful authentication is remembered for the (username, IP) pair.
+The cache is off by default: while an entry is valid, anyone connecting from the same IP (the same NAT, proxy or shared host)
+can log in as that user without the session server being asked. Admins may opt in by setting
+[Authentication] CacheTimeout in settings.ini, trading that risk for fewer auth requests on quick reconnects. */
+#define DEFAULT_CACHE_TIMEOUT 0
+
+/** The largest response body accepted from the auth server; the real answer is a single word */
+#define MAX_BODY_SIZE 65536
+
 
 
 
 
-cAuthenticator::cAuthenticator(void) :
-	super("cAuthenticator"),
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cAuthenticator:
+
+cAuthenticator::cAuthenticator(cCallbacks & a_Callbacks) :
+	m_Callbacks(a_Callbacks),
 	m_Server(DEFAULT_AUTH_SERVER),
 	m_Address(DEFAULT_AUTH_ADDRESS),
-	m_ShouldAuthenticate(true)
+	m_ShouldAuthenticate(true),
+	m_NumThreads(DEFAULT_NUM_THREADS),
+	m_CacheTimeout(DEFAULT_CACHE_TIMEOUT * 1000),
+	m_NumCacheHits(0),
+	m_NumRequests(0),
+	m_NumConnections(0)
 {
 }
 
@@ -48,22 +66,35 @@ void cAuthenticator::ReadINI(cIniFile & IniFile)
 	m_Server  = IniFile.GetValueSet("Authentication", "Server", DEFAULT_AUTH_SERVER);
 	m_Address = IniFile.GetValueSet("Authentication", "Address", DEFAULT_AUTH_ADDRESS);
 	m_ShouldAuthenticate = IniFile.GetValueSetB("Authentication", "Authenticate", true);
+	m_NumThreads = std::min(std::max(IniFile.GetValueSetI("Authentication", "NumThreads", DEFAULT_NUM_THREADS), 1), MAX_NUM_THREADS);
+	m_CacheTimeout = std::max(IniFile.GetValueSetI("Authentication", "CacheTimeout", DEFAULT_CACHE_TIMEOUT), 0) * 1000;
 }
 
 
 
 
 
-void cAuthenticator::Authenticate(int a_ClientID, const AString & a_UserName, const AString & a_ServerHash)
+void cAuthenticator::Authenticate(int a_ClientID, const AString & a_UserName, const AString & a_IP, const AString & a_ServerHash)
 {
 	if (!m_ShouldAuthenticate)
 	{
-		cRoot::Get()->AuthenticateUser(a_ClientID);
+		m_Callbacks.OnAuthenticated(a_ClientID);
+		return;
+	}
+
+	if (IsCached(a_UserName, a_IP))
+	{
+		LOGD("cAuthenticator: User \"%s\" has authenticated from %s recently, skipping the auth server", a_UserName.c_str(), a_IP.c_str());
+		{
+			cCSLock Lock(m_CS);
+			m_NumCacheHits++;
+		}
+		m_Callbacks.OnAuthenticated(a_ClientID);
 		return;
 	}
 
 	cCSLock Lock(m_CS);
-	m_Queue.push_back(cUser(a_ClientID, a_UserName, a_ServerHash));
+	m_Queue.push_back(cUser(a_ClientID, a_UserName, a_IP, a_ServerHash));
 	m_QueueNonempty.Set();
 }
 
@@ -74,8 +105,13 @@ void cAuthenticator::Authenticate(int a_ClientID, const AString & a_UserName, co
 void cAuthenticator::Start(cIniFile & IniFile)
 {
 	ReadINI(IniFile);
-	m_ShouldTerminate = false;
-	super::Start();
+	ASSERT(m_Workers.empty());  // Not stopped since the last start?
+	for (int i = 0; i < m_NumThreads; i++)
+	{
+		cWorker * Worker = new cWorker(*this);
+		m_Workers.push_back(Worker);
+		Worker->Start();
+	}
 }
 
 
@@ -84,182 +120,544 @@ void cAuthenticator::Start(cIniFile & IniFile)
 
 void cAuthenticator::Stop(void)
 {
-	m_ShouldTerminate = true;
-	m_QueueNonempty.Set();
-	Wait();
+	for (cWorkers::iterator itr = m_Workers.begin(); itr != m_Workers.end(); ++itr)
+	{
+		(*itr)->SignalTerminate();
+		m_QueueNonempty.Set();
+	}
+	for (cWorkers::iterator itr = m_Workers.begin(); itr != m_Workers.end(); ++itr)
+	{
+		(*itr)->Wait();
+		delete *itr;
+	}
+	m_Workers.clear();
 }
 
 
 
 
 
-void cAuthenticator::Execute(void)
+bool cAuthenticator::GetNextUser(const volatile bool & a_ShouldTerminate, cUser & a_User)
 {
-	for (;;)
+	cCSLock Lock(m_CS);
+	while (!a_ShouldTerminate && m_Queue.empty())
+	{
+		cCSUnlock Unlock(Lock);
+		m_QueueNonempty.Wait();
+	}
+	if (a_ShouldTerminate)
+	{
+		// Pass the wakeup on, the other workers may be terminating, too:
+		m_QueueNonempty.Set();
+		return false;
+	}
+
+	a_User = m_Queue.front();
+	m_Queue.pop_front();
+	if (!m_Queue.empty())
+	{
+		// The event doesn't count the Set() calls on all platforms, so wake up another worker for the rest of the queue:
+		m_QueueNonempty.Set();
+	}
+	return true;
+}
+
+
+
+
+
+bool cAuthenticator::IsCached(const AString & a_UserName, const AString & a_IP)
+{
+	if (m_CacheTimeout <= 0)
 	{
-		cCSLock Lock(m_CS);
-		while (!m_ShouldTerminate && (m_Queue.size() == 0))
+		return false;
+	}
+
+	cCSLock Lock(m_CSCache);
+	cAuthCache::iterator itr = m_Cache.find(std::make_pair(a_UserName, a_IP));
+	if (itr == m_Cache.end())
+	{
+		return false;
+	}
+	if (itr->second < m_Timer.GetNowTime())
+	{
+		m_Cache.erase(itr);
+		return false;
+	}
+	return true;
+}
+
+
+
+
+
+void cAuthenticator::AddToCache(const AString & a_UserName, const AString & a_IP)
+{
+	if (m_CacheTimeout <= 0)
+	{
+		return;
+	}
+
+	cCSLock Lock(m_CSCache);
+	long long Now = m_Timer.GetNowTime();
+
+	// Purge the expired entries, so that the cache doesn't keep every user who has ever connected:
+	for (cAuthCache::iterator itr = m_Cache.begin(); itr != m_Cache.end();)
+	{
+		if (itr->second < Now)
 		{
-			cCSUnlock Unlock(Lock);
-			m_QueueNonempty.Wait();
+			m_Cache.erase(itr++);
 		}
-		if (m_ShouldTerminate)
+		else
 		{
-			return;
+			++itr;
 		}
-		ASSERT(!m_Queue.empty());
-		
-		int ClientID = m_Queue.front().m_ClientID;
-		AString UserName = m_Queue.front().m_Name;
-		AString ActualAddress = m_Address;
-		ReplaceString(ActualAddress, "%USERNAME%", UserName);
-		ReplaceString(ActualAddress, "%SERVERID%", m_Queue.front().m_ServerID);
-		m_Queue.pop_front();
-		Lock.Unlock();
-
-		if (!AuthFromAddress(m_Server, ActualAddress, UserName))
+	}  // for itr - m_Cache[]
+
+	// Only the auth server's answers set the expiration, so that a user is verified at least once per timeout:
+	m_Cache[std::make_pair(a_UserName, a_IP)] = Now + m_CacheTimeout;
+}
+
+
+
+
+
+bool cAuthenticator::Resolve(const AString & a_Server, AString & a_IP)
+{
+	if (inet_addr(a_Server.c_str()) != INADDR_NONE)
+	{
+		// Already an IP address
+		a_IP = a_Server;
+		return true;
+	}
+
+	cCSLock Lock(m_CSResolve);
+	hostent * hp = gethostbyname(a_Server.c_str());
+	if ((hp == NULL) || (hp->h_addrtype != AF_INET))
+	{
+		return false;
+	}
+	in_addr Addr;
+	memcpy(&Addr, hp->h_addr, sizeof(Addr));
+	a_IP = inet_ntoa(Addr);
+	return true;
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cAuthenticator::cWorker:
+
+cAuthenticator::cWorker::cWorker(cAuthenticator & a_Authenticator) :
+	super("cAuthenticator worker"),
+	m_Authenticator(a_Authenticator),
+	m_ContentLength(-1),
+	m_IsChunked(false),
+	m_ShouldClose(false)
+{
+}
+
+
+
+
+
+cAuthenticator::cWorker::~cWorker()
+{
+	Disconnect();
+}
+
+
+
+
+
+void cAuthenticator::cWorker::Execute(void)
+{
+	cUser User(0, "", "", "");
+	while (m_Authenticator.GetNextUser(m_ShouldTerminate, User))
+	{
+		AString ActualAddress = m_Authenticator.m_Address;
+		ReplaceString(ActualAddress, "%USERNAME%", User.m_Name);
+		ReplaceString(ActualAddress, "%SERVERID%", User.m_ServerID);
+
+		if (!AuthFromAddress(m_Authenticator.m_Server, ActualAddress, User.m_Name))
 		{
-			cRoot::Get()->KickUser(ClientID, "Failed to authenticate account!");
+			m_Authenticator.m_Callbacks.OnAuthFailed(User.m_ClientID, "Failed to authenticate account!");
 		}
 		else
 		{
-			cRoot::Get()->AuthenticateUser(ClientID);
+			m_Authenticator.AddToCache(User.m_Name, User.m_IP);
+			m_Authenticator.m_Callbacks.OnAuthenticated(User.m_ClientID);
+		}
+	}  // while (GetNextUser())
+	Disconnect();
+}
+
+
+
+
+
+void cAuthenticator::cWorker::OnHeaderLine(const AString & a_Key, const AString & a_Value)
+{
+	if (NoCaseCompare(a_Key, "Content-Length") == 0)
+	{
+		m_ContentLength = atoi(a_Value.c_str());
+	}
+	else if (NoCaseCompare(a_Key, "Transfer-Encoding") == 0)
+	{
+		AString Value(a_Value);
+		m_IsChunked = (StrToLower(Value).find("chunked") != AString::npos);
+	}
+	else if (NoCaseCompare(a_Key, "Connection") == 0)
+	{
+		AString Value(TrimString(a_Value));
+		if (NoCaseCompare(Value, "close") == 0)
+		{
+			m_ShouldClose = true;
+		}
+		else if (NoCaseCompare(Value, "keep-alive") == 0)
+		{
+			m_ShouldClose = false;
+		}
+	}
+	else if (NoCaseCompare(a_Key, "Location") == 0)
+	{
+		m_Location = TrimString(a_Value);
+	}
+}
+
+
+
+
+
+bool cAuthenticator::cWorker::AuthFromAddress(const AString & a_Server, const AString & a_Address, const AString & a_UserName)
+{
+	AString Server(a_Server);
+	AString Address(a_Address);
+	for (int Level = 1; Level <= MAX_REDIRECTS; Level++)
+	{
+		int StatusCode;
+		AString Body;
+		if (!Get(Server, Address, StatusCode, Body))
+		{
+			LOGWARNING("%s: cannot get a reply from auth server \"%s\", kicking user \"%s\"",
+				__FUNCTION__, Server.c_str(), a_UserName.c_str()
+			);
+			return false;
+		}
+
+		if (StatusCode == 302)
+		{
+			LOGD("%s: Need to redirect, current level %d!", __FUNCTION__, Level);
+			if (m_Location.compare(0, 7, "http://") != 0)
+			{
+				LOGERROR("cAuthenticator: received invalid redirection from auth server \"%s\" for user \"%s\", kicking user.", Server.c_str(), a_UserName.c_str());
+				return false;
+			}
+			AString Location = m_Location.substr(7);  // Strip http://
+			size_t idxSlash = Location.find('/');
+			Server = Location.substr(0, idxSlash);  // Only leave server address
+			Address = (idxSlash == AString::npos) ? "/" : Location.substr(idxSlash);
+			continue;
 		}
-	}  // for (-ever)
+
+		if (StatusCode != 200)
+		{
+			LOGERROR("cAuthenticator: received an error from auth server \"%s\" for user \"%s\", kicking user.", Server.c_str(), a_UserName.c_str());
+			return false;
+		}
+		LOGD("cAuthenticator: Received status 200 OK! :D");
+
+		AString Result = TrimString(Body);
+		LOGD("cAuthenticator: Authentication result was %s", Result.c_str());
+		if (Result.compare("YES") == 0)	//Works well
+		{
+			LOGINFO("Authentication result \"YES\", player authentication success!");
+			return true;
+		}
+		LOGINFO("Authentication result was \"%s\", player authentication failure!", Result.c_str());
+		return false;
+	}  // for Level
+
+	LOGERROR("cAuthenticator: received too many levels of redirection from auth server \"%s\" for user \"%s\", bailing out and kicking the user", a_Server.c_str(), a_UserName.c_str());
+	return false;
+}
+
+
+
+
+
+bool cAuthenticator::cWorker::Get(const AString & a_Server, const AString & a_Address, int & a_StatusCode, AString & a_Body)
+{
+	bool IsReused = (m_Link.IsValid() && (m_LinkServer == a_Server));
+	if (!IsReused)
+	{
+		Disconnect();
+		if (!Connect(a_Server))
+		{
+			return false;
+		}
+	}
+	if (SendAndReceive(a_Server, a_Address, a_StatusCode, a_Body))
+	{
+		return true;
+	}
+	Disconnect();
+	if (!IsReused)
+	{
+		return false;
+	}
+
+	// The server may have closed the idle connection in the meantime, retry once over a new one:
+	if (!Connect(a_Server))
+	{
+		return false;
+	}
+	if (SendAndReceive(a_Server, a_Address, a_StatusCode, a_Body))
+	{
+		return true;
+	}
+	Disconnect();
+	return false;
 }
 
 
 
 
 
-bool cAuthenticator::AuthFromAddress(const AString & a_Server, const AString & a_Address, const AString & a_UserName, int a_Level /* = 1 */)
+bool cAuthenticator::cWorker::SendAndReceive(const AString & a_Server, const AString & a_Address, int & a_StatusCode, AString & a_Body)
 {
-	// Returns true if the user authenticated okay, false on error; iLevel is the recursion deptht (bails out if too deep)
+	{
+		cCSLock Lock(m_Authenticator.m_CS);
+		m_Authenticator.m_NumRequests++;
+	}
 
-	cBlockingTCPLink Link;
-	if (!Link.Connect(a_Server.c_str(), 80))
+	AString Request;
+	Printf(Request, "GET %s HTTP/1.1\r\nUser-Agent: MCServer\r\nHost: %s\r\nAccept: */*\r\nConnection: keep-alive\r\n\r\n",
+		a_Address.c_str(), a_Server.c_str()
+	);
+	for (size_t Pos = 0; Pos < Request.size();)
+	{
+		int NumSent = m_Link.Send(Request.data() + Pos, (unsigned int)(Request.size() - Pos));
+		if (NumSent <= 0)
+		{
+			return false;
+		}
+		Pos += (size_t)NumSent;
+	}
+
+	// Receive the status line:
+	AString Data;
+	size_t idxCRLF;
+	while ((idxCRLF = Data.find("\r\n")) == AString::npos)
+	{
+		if (!ReceiveMore(Data))
+		{
+			return false;
+		}
+	}
+	AStringVector StatusLine = StringSplit(Data.substr(0, idxCRLF), " ");
+	Data.erase(0, idxCRLF + 2);
+	if ((StatusLine.size() < 2) || ((StatusLine[0] != "HTTP/1.1") && (StatusLine[0] != "HTTP/1.0")))
 	{
-		LOGWARNING("%s: cannot connect to auth server \"%s\", kicking user \"%s\"",
-			__FUNCTION__, a_Server.c_str(), a_UserName.c_str()
-		);
 		return false;
 	}
-	
-	Link.SendMessage( AString( "GET " + a_Address + " HTTP/1.1\r\n" ).c_str());
-	Link.SendMessage( AString( "User-Agent: MCServer\r\n" ).c_str());
-	Link.SendMessage( AString( "Host: " + a_Server + "\r\n" ).c_str());
-	//Link.SendMessage( AString( "Host: session.minecraft.net\r\n" ).c_str());
-	Link.SendMessage( AString( "Accept: */*\r\n" ).c_str());
-	Link.SendMessage( AString( "Connection: close\r\n" ).c_str());	//Close so we dont have to mess with the Content-Length :)
-	Link.SendMessage( AString( "\r\n" ).c_str());
-	AString DataRecvd;
-	Link.ReceiveData(DataRecvd);
-	Link.CloseSocket();
-
-	std::stringstream ss(DataRecvd);
-
-	// Parse the data received:
-	std::string temp;
-	ss >> temp;
-	bool bRedirect = false;
-	bool bOK = false;
-	if ((temp.compare("HTTP/1.1") == 0) || (temp.compare("HTTP/1.0") == 0))
-	{
-		int code;
-		ss >> code;
-		if (code == 302)
+	a_StatusCode = atoi(StatusLine[1].c_str());
+
+	// Receive the headers; HTTP/1.0 servers close the connection unless they say otherwise:
+	m_ContentLength = -1;
+	m_IsChunked = false;
+	m_ShouldClose = (StatusLine[0] == "HTTP/1.0");
+	m_Location.clear();
+	cEnvelopeParser Parser(*this);
+	for (;;)
+	{
+		int NumConsumed = Parser.Parse(Data.data(), (int)Data.size());
+		if (NumConsumed < 0)
+		{
+			return false;
+		}
+		Data.erase(0, (size_t)NumConsumed);
+		if (!Parser.IsInHeaders())
+		{
+			break;
+		}
+		if (!ReceiveMore(Data))
+		{
+			return false;
+		}
+	}
+
+	// Receive the body:
+	a_Body.clear();
+	if (m_IsChunked)
+	{
+		if (!ReceiveChunkedBody(Data, a_Body))
 		{
-			// redirect blabla
-			LOGD("%s: Need to redirect, current level %d!", __FUNCTION__, a_Level);
-			if (a_Level > MAX_REDIRECTS)
+			return false;
+		}
+	}
+	else if (m_ContentLength >= 0)
+	{
+		if (m_ContentLength > MAX_BODY_SIZE)
+		{
+			return false;
+		}
+		while (Data.size() < (size_t)m_ContentLength)
+		{
+			if (!ReceiveMore(Data))
 			{
-				LOGERROR("cAuthenticator: received too many levels of redirection from auth server \"%s\" for user \"%s\", bailing out and kicking the user", a_Server.c_str(), a_UserName.c_str());
 				return false;
 			}
-			bRedirect = true;
 		}
-		else if (code == 200)
+		a_Body.assign(Data, 0, (size_t)m_ContentLength);
+	}
+	else
+	{
+		// No length given, the body extends until the server closes the connection:
+		while ((Data.size() <= MAX_BODY_SIZE) && ReceiveMore(Data))
 		{
-			LOGD("cAuthenticator: Received status 200 OK! :D");
-			bOK = true;
 		}
+		a_Body = Data;
+		m_ShouldClose = true;
 	}
-	else
+
+	if (m_ShouldClose)
+	{
+		Disconnect();
+	}
+	return true;
+}
+
+
+
+
+
+bool cAuthenticator::cWorker::ReceiveMore(AString & a_Data)
+{
+	char Buffer[1024];
+	int NumReceived = m_Link.Receive(Buffer, sizeof(Buffer), 0);
+	if (NumReceived <= 0)
 	{
-		LOGERROR("cAuthenticator: cannot parse auth reply from server \"%s\" for user \"%s\", kicking the user.", a_Server.c_str(), a_UserName.c_str());
 		return false;
 	}
+	a_Data.append(Buffer, (size_t)NumReceived);
+	return true;
+}
+
+
 
-	if( bRedirect )
+
+
+bool cAuthenticator::cWorker::ReceiveChunkedBody(AString & a_Data, AString & a_Body)
+{
+	for (;;)
 	{
-		AString Location;
-		// Search for "Location:"
-		bool bFoundLocation = false;
-		while( !bFoundLocation && ss.good() )
+		// The chunk size line, in hex, possibly followed by extensions:
+		size_t idxCRLF;
+		while ((idxCRLF = a_Data.find("\r\n")) == AString::npos)
 		{
-			char c = 0;
-			while( c != '\n' )
+			if (!ReceiveMore(a_Data))
 			{
-				ss.get( c );
+				return false;
 			}
-			AString Name;
-			ss >> Name;
-			if (Name.compare("Location:") == 0)
+		}
+		if (!isxdigit((unsigned char)a_Data[0]))
+		{
+			return false;
+		}
+		size_t ChunkSize = (size_t)strtoul(a_Data.c_str(), NULL, 16);
+		a_Data.erase(0, idxCRLF + 2);
+
+		if (ChunkSize == 0)
+		{
+			// The last chunk; skip the trailer headers up to the empty line:
+			for (;;)
 			{
-				bFoundLocation = true;
-				ss >> Location;
+				while ((idxCRLF = a_Data.find("\r\n")) == AString::npos)
+				{
+					if (!ReceiveMore(a_Data))
+					{
+						return false;
+					}
+				}
+				a_Data.erase(0, idxCRLF + 2);
+				if (idxCRLF == 0)
+				{
+					return true;
+				}
 			}
 		}
-		if (!bFoundLocation)
+
+		if (a_Body.size() + ChunkSize > MAX_BODY_SIZE)
 		{
-			LOGERROR("cAuthenticator: received invalid redirection from auth server \"%s\" for user \"%s\", kicking user.", a_Server.c_str(), a_UserName.c_str());
 			return false;
 		}
+		while (a_Data.size() < ChunkSize + 2)
+		{
+			if (!ReceiveMore(a_Data))
+			{
+				return false;
+			}
+		}
+		a_Body.append(a_Data, 0, ChunkSize);
+		a_Data.erase(0, ChunkSize + 2);
+	}
+}
+
 
-		Location = Location.substr(strlen("http://"), std::string::npos); // Strip http://
-		std::string Server = Location.substr( 0, Location.find( "/" ) ); // Only leave server address
-		Location = Location.substr( Server.length(), std::string::npos);
-		return AuthFromAddress(Server, Location, a_UserName, a_Level + 1);
+
+
+
+bool cAuthenticator::cWorker::Connect(const AString & a_Server)
+{
+	// The server may specify the port as "host:port":
+	AString Host(a_Server);
+	int Port = 80;
+	size_t idxColon = a_Server.find(':');
+	if (idxColon != AString::npos)
+	{
+		Host = a_Server.substr(0, idxColon);
+		Port = atoi(a_Server.c_str() + idxColon + 1);
 	}
 
-	if (!bOK)
+	AString IP;
+	if (!m_Authenticator.Resolve(Host, IP))
 	{
-		LOGERROR("cAuthenticator: received an error from auth server \"%s\" for user \"%s\", kicking user.", a_Server.c_str(), a_UserName.c_str());
+		LOGWARNING("%s: cannot resolve auth server \"%s\"", __FUNCTION__, Host.c_str());
 		return false;
 	}
-
-	// Header says OK, so receive the rest.
-	// Go past header, double \n means end of headers
-	char c = 0;
-	while (ss.good())
+	m_Link = cSocket::CreateSocket(cSocket::IPv4);
+	if (!m_Link.IsValid())
 	{
-		while (c != '\n')
-		{
-			ss.get(c);
-		}
-		ss.get(c);
-		if( c == '\n' || c == '\r' || ss.peek() == '\r' || ss.peek() == '\n' )
-			break;
+		LOGWARNING("%s: cannot create a socket for connecting to auth server \"%s\"", __FUNCTION__, a_Server.c_str());
+		return false;
 	}
-	if (!ss.good())
+	if (!m_Link.ConnectIPv4(IP, (unsigned short)Port))
 	{
-		LOGERROR("cAuthenticator: error while parsing response body from auth server \"%s\" for user \"%s\", kicking user.", a_Server.c_str(), a_UserName.c_str());
+		LOGWARNING("%s: cannot connect to auth server \"%s\" (%s)", __FUNCTION__, a_Server.c_str(), cSocket::GetLastErrorString().c_str());
+		m_Link.CloseSocket();
 		return false;
 	}
+	m_LinkServer = a_Server;
 
-	std::string Result;
-	ss >> Result;
-	LOGD("cAuthenticator: Authentication result was %s", Result.c_str());
+	cCSLock Lock(m_Authenticator.m_CS);
+	m_Authenticator.m_NumConnections++;
+	return true;
+}
 
-	if (Result.compare("YES") == 0)	//Works well
-	{
-		LOGINFO("Authentication result \"YES\", player authentication success!");
-		return true;
-	}
 
 
-	LOGINFO("Authentication result was \"%s\", player authentication failure!", Result.c_str());
-	return false;
+
+
+void cAuthenticator::cWorker::Disconnect(void)
+{
+	if (m_Link.IsValid())
+	{
+		m_Link.CloseSocket();
+	}
+	m_LinkServer.clear();
 }
 
 
@@ -1,10 +1,12 @@
 
 // cAuthenticator.h
 
-// Interfaces to the cAuthenticator class representing the thread that authenticates users against the official MC server
+// Interfaces to the cAuthenticator class representing the threads that authenticate users against the official MC server
 // Authentication prevents "hackers" from joining with an arbitrary username (possibly impersonating the server admins)
 // For more info, see http://wiki.vg/Session#Server_operation
-// In MCS, authentication is implemented as a single thread that receives queued auth requests and dispatches them one by one.
+// In MCS, authentication is implemented as a pool of worker threads that receive queued auth requests and dispatch them in parallel.
+// Each worker keeps its connection to the auth server open between the requests.
+// Users who have successfully authenticated recently from the same IP address are let in without asking the auth server again.
 
 
 
@@ -15,39 +17,65 @@
 #define CAUTHENTICATOR_H_INCLUDED
 
 #include "OSSupport/IsThread.h"
+#include "OSSupport/Socket.h"
+#include "OSSupport/Timer.h"
+#include "HTTPServer/EnvelopeParser.h"
 
 
 
 
 
-// fwd: "cRoot.h"
-class cRoot;
+// fwd: "inifile/iniFile.h"
+class cIniFile;
 
 
 
 
 
-class cAuthenticator :
-	public cIsThread
+class cAuthenticator
 {
-	typedef cIsThread super;
-	
 public:
-	cAuthenticator(void);
+	/** Interface that receives the authentication results. Called from the worker threads,
+	or directly from Authenticate() when the result is known without asking the auth server */
+	class cCallbacks
+	{
+	public:
+		// Force a virtual destructor in descendants:
+		virtual ~cCallbacks() {}
+
+		/** Called when the user has passed the authentication */
+		virtual void OnAuthenticated(int a_ClientID) = 0;
+
+		/** Called when the user has failed the authentication; they are expected to be kicked */
+		virtual void OnAuthFailed(int a_ClientID, const AString & a_Reason) = 0;
+	} ;
+
+
+	cAuthenticator(cCallbacks & a_Callbacks);
 	~cAuthenticator();
 
-	/// (Re-)read server and address from INI:
+	/// (Re-)read server, address, number of threads and cache timeout from INI:
 	void ReadINI(cIniFile & IniFile);
 
-	/// Queues a request for authenticating a user. If the auth fails, the user is kicked
-	void Authenticate(int a_ClientID, const AString & a_UserName, const AString & a_ServerHash);
+	/** Queues a request for authenticating a user. If the user has authenticated from the same IP recently,
+	they are authenticated right away. If the auth fails, the user is kicked */
+	void Authenticate(int a_ClientID, const AString & a_UserName, const AString & a_IP, const AString & a_ServerHash);
 
-	/// Starts the authenticator thread. The thread may be started and stopped repeatedly
+	/// Starts the authenticator threads. The threads may be started and stopped repeatedly
 	void Start(cIniFile & IniFile);
-	
-	/// Stops the authenticator thread. The thread may be started and stopped repeatedly
+
+	/// Stops the authenticator threads. The threads may be started and stopped repeatedly
 	void Stop(void);
-	
+
+	/** Returns the number of users authenticated from the cache since the start */
+	int GetNumCacheHits(void) const { return m_NumCacheHits; }
+
+	/** Returns the number of requests sent to the auth server since the start, including the redirections */
+	int GetNumRequests(void) const { return m_NumRequests; }
+
+	/** Returns the number of connections opened to the auth server since the start */
+	int GetNumConnections(void) const { return m_NumConnections; }
+
 private:
 
 	class cUser
@@ -55,31 +83,127 @@ private:
 	public:
 		int     m_ClientID;
 		AString m_Name;
+		AString m_IP;
 		AString m_ServerID;
-		
-		cUser(int a_ClientID, const AString & a_Name, const AString & a_ServerID) :
+
+		cUser(int a_ClientID, const AString & a_Name, const AString & a_IP, const AString & a_ServerID) :
 			m_ClientID(a_ClientID),
 			m_Name(a_Name),
+			m_IP(a_IP),
 			m_ServerID(a_ServerID)
 		{
 		}
 	} ;
-	
+
+
+	/** A single thread taking the users from the queue and asking the auth server about them.
+	Keeps its connection to the auth server open between the requests, as long as the server allows it */
+	class cWorker :
+		public cIsThread,
+		public cEnvelopeParser::cCallbacks
+	{
+		typedef cIsThread super;
+
+	public:
+		cWorker(cAuthenticator & a_Authenticator);
+		virtual ~cWorker();
+
+		/** Makes the thread terminate once it finishes the current request; doesn't wait for it */
+		void SignalTerminate(void) { m_ShouldTerminate = true; }
+
+	protected:
+		cAuthenticator & m_Authenticator;
+
+		/** The connection to the auth server, kept open between the requests. Invalid if not connected */
+		cSocket m_Link;
+
+		/** The server to which m_Link is connected */
+		AString m_LinkServer;
+
+		// Values of the interesting headers in the response currently being received:
+		int     m_ContentLength;  ///< -1 if not given
+		bool    m_IsChunked;
+		bool    m_ShouldClose;
+		AString m_Location;
+
+		// cIsThread override:
+		virtual void Execute(void) override;
+
+		// cEnvelopeParser::cCallbacks override:
+		virtual void OnHeaderLine(const AString & a_Key, const AString & a_Value) override;
+
+		/** Returns true if the user authenticated okay, false on error; follows the redirections up to MAX_REDIRECTS levels */
+		bool AuthFromAddress(const AString & a_Server, const AString & a_Address, const AString & a_UserName);
+
+		/** Sends a GET request for a_Address to a_Server and receives the response, reusing the open connection if possible.
+		Returns false on network error or an unparsable response */
+		bool Get(const AString & a_Server, const AString & a_Address, int & a_StatusCode, AString & a_Body);
+
+		/** Sends the request over m_Link and receives the response. Returns false on network error or an unparsable response */
+		bool SendAndReceive(const AString & a_Server, const AString & a_Address, int & a_StatusCode, AString & a_Body);
+
+		/** Appends the data received from m_Link to a_Data. Returns false if the link was closed or failed */
+		bool ReceiveMore(AString & a_Data);
+
+		/** Decodes the chunked-encoded a_Data into a_Body, receiving more data as needed. Returns false on error */
+		bool ReceiveChunkedBody(AString & a_Data, AString & a_Body);
+
+		/** Opens m_Link to a_Server. Returns true if successful */
+		bool Connect(const AString & a_Server);
+
+		/** Closes m_Link, if open */
+		void Disconnect(void);
+	} ;
+
 	typedef std::deque<cUser> cUserList;
-	
+	typedef std::vector<cWorker *> cWorkers;
+
+	/** Maps the (username, IP) pair to the time (cTimer msec) when the cached authentication expires */
+	typedef std::map<std::pair<AString, AString>, long long> cAuthCache;
+
+	cCallbacks & m_Callbacks;
+
 	cCriticalSection m_CS;
 	cUserList        m_Queue;
 	cEvent           m_QueueNonempty;
-	
+	cWorkers         m_Workers;
+
+	/** Protects m_Cache */
+	cCriticalSection m_CSCache;
+	cAuthCache       m_Cache;
+	cTimer           m_Timer;
+
+	/** Protects the hostname resolution, gethostbyname() isn't reentrant on all platforms */
+	cCriticalSection m_CSResolve;
+
 	AString m_Server;
 	AString m_Address;
 	bool    m_ShouldAuthenticate;
-	
-	// cIsThread override:
-	virtual void Execute(void) override;
-	
-	// Returns true if the user authenticated okay, false on error; iLevel is the recursion deptht (bails out if too deep)
-	bool AuthFromAddress(const AString & a_Server, const AString & a_Address, const AString & a_UserName, int a_Level = 1);
+
+	/** Number of the worker threads, and thus of the auth requests in progress at once */
+	int m_NumThreads;
+
+	/** Number of msec for which a successful authentication is remembered for the (username, IP) pair; 0 (the default) disables the cache.
+	A cached user is let in from the same IP without asking the session server, so enabling this is an opt-in security trade-off */
+	int m_CacheTimeout;
+
+	// Statistics, modified only while holding m_CS:
+	int m_NumCacheHits;
+	int m_NumRequests;
+	int m_NumConnections;
+
+	/** Waits for a user in the queue and removes them from it into a_User.
+	Returns false if a_ShouldTerminate got set instead; a_ShouldTerminate is the calling worker's termination flag */
+	bool GetNextUser(const volatile bool & a_ShouldTerminate, cUser & a_User);
+
+	/** Returns true if the user has successfully authenticated from the IP recently */
+	bool IsCached(const AString & a_UserName, const AString & a_IP);
+
+	/** Remembers a successful authentication of the user from the IP; purges the expired entries */
+	void AddToCache(const AString & a_UserName, const AString & a_IP);
+
+	/** Resolves a_Server into a dotted IPv4 address in a_IP. Returns false if it cannot be resolved */
+	bool Resolve(const AString & a_Server, AString & a_IP);
 };
 
 
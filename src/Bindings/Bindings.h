@@ -0,0 +1,8 @@
+/*
+** Lua binding: AllToLua
+** Generated automatically by tolua++-1.0.92 on Mon Oct 19 02:56:21 2026.
+*/
+
+/* Exported function */
+TOLUA_API int  tolua_AllToLua_open (lua_State* tolua_S);
+
@@ -249,9 +249,14 @@ bool cLuaState::PushFunction(const char * a_FunctionName)
 
 bool cLuaState::PushFunction(int a_FnRef)
 {
-	ASSERT(IsValid());
 	ASSERT(m_NumCurrentFunctionArgs == -1);  // If not, there's already something pushed onto the stack
 	
+	if (!IsValid())
+	{
+		// This happens if an async callback gets called while its plugin is being closed
+		return false;
+	}
+	
 	// Push the error handler for lua_pcall()
 	lua_pushcfunction(m_LuaState, &ReportFnCallErrors);
 	
@@ -528,6 +533,18 @@ void cLuaState::Push(cChunkDesc * a_ChunkDesc)
 
 
 
+void cLuaState::Push(cBlockArea * a_BlockArea)
+{
+	ASSERT(IsValid());
+
+	tolua_pushusertype(m_LuaState, a_BlockArea, "cBlockArea");
+	m_NumCurrentFunctionArgs += 1;
+}
+
+
+
+
+
 void cLuaState::Push(const cCraftingGrid * a_Grid)
 {
 	ASSERT(IsValid());
@@ -42,6 +42,7 @@ class cItems;
 class cClientHandle;
 class cPickup;
 class cChunkDesc;
+class cBlockArea;
 class cCraftingGrid;
 class cCraftingRecipe;
 struct TakeDamageInfo;
@@ -181,6 +182,7 @@ public:
 	void Push(cClientHandle * a_ClientHandle);
 	void Push(cPickup * a_Pickup);
 	void Push(cChunkDesc * a_ChunkDesc);
+	void Push(cBlockArea * a_BlockArea);
 	void Push(const cCraftingGrid * a_Grid);
 	void Push(const cCraftingRecipe * a_Recipe);
 	void Push(TakeDamageInfo * a_TDI);
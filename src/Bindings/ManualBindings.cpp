@@ -2370,6 +2370,364 @@ static int tolua_cBlockArea_SaveToSchematicFile(lua_State * tolua_S)
 
 
 
+
+
+/** The bulk data accessors of cBlockArea work on one of its data arrays, each with one byte per block */
+typedef unsigned char * (cBlockArea::*cBlockAreaDataFn)(void) const;
+
+/** Checks the params of the bulk data accessors and returns the cBlockArea, or NULL on error */
+static cBlockArea * GetBlockAreaForBulkAccess(lua_State * tolua_S, bool a_HasData, const char * a_FnName)
+{
+	cLuaState L(tolua_S);
+	if (
+		!L.CheckParamUserType(1, "cBlockArea") ||
+		(a_HasData && !(lua_isstring(tolua_S, 2) || lua_istable(tolua_S, 2))) ||
+		!L.CheckParamEnd     (a_HasData ? 3 : 2)
+	)
+	{
+		return NULL;
+	}
+	cBlockArea * self = (cBlockArea *)tolua_tousertype(tolua_S, 1, NULL);
+	if (self == NULL)
+	{
+		tolua_error(tolua_S, Printf("invalid 'self' in function 'cBlockArea:%s'", a_FnName).c_str(), NULL);
+		return NULL;
+	}
+	return self;
+}
+
+
+
+
+
+/** Returns the whole data array as a single string, one byte per block, in the area's own order:
+index = x + z * SizeX + y * SizeX * SizeZ. Returns nil if the area doesn't hold the data. */
+static int tolua_cBlockArea_GetDataString(lua_State * tolua_S, cBlockAreaDataFn a_DataFn, const char * a_FnName)
+{
+	cBlockArea * self = GetBlockAreaForBulkAccess(tolua_S, false, a_FnName);
+	if (self == NULL)
+	{
+		return 0;
+	}
+	const unsigned char * Data = (self->*a_DataFn)();
+	if (Data == NULL)
+	{
+		lua_pushnil(tolua_S);
+		return 1;
+	}
+	lua_pushlstring(tolua_S, (const char *)Data, self->GetBlockCount());
+	return 1;
+}
+
+
+
+
+
+/** Sets the whole data array from a string, one byte per block, in the same order as GetDataString().
+The string is copied straight from Lua's memory. Returns false if the size doesn't match or the area doesn't hold the data. */
+static int tolua_cBlockArea_SetDataString(lua_State * tolua_S, cBlockAreaDataFn a_DataFn, const char * a_FnName)
+{
+	cBlockArea * self = GetBlockAreaForBulkAccess(tolua_S, true, a_FnName);
+	if (self == NULL)
+	{
+		return 0;
+	}
+	size_t Len = 0;
+	const char * Src = lua_tolstring(tolua_S, 2, &Len);
+	unsigned char * Data = (self->*a_DataFn)();
+	if ((Src == NULL) || (Data == NULL) || (Len != (size_t)self->GetBlockCount()))
+	{
+		tolua_pushboolean(tolua_S, false);
+		return 1;
+	}
+	memcpy(Data, Src, Len);
+	tolua_pushboolean(tolua_S, true);
+	return 1;
+}
+
+
+
+
+
+/** Returns the whole data array as an array-table of numbers, 1-based, in the same order as GetDataString().
+Returns nil if the area doesn't hold the data. */
+static int tolua_cBlockArea_GetDataArray(lua_State * tolua_S, cBlockAreaDataFn a_DataFn, const char * a_FnName)
+{
+	cBlockArea * self = GetBlockAreaForBulkAccess(tolua_S, false, a_FnName);
+	if (self == NULL)
+	{
+		return 0;
+	}
+	const unsigned char * Data = (self->*a_DataFn)();
+	if (Data == NULL)
+	{
+		lua_pushnil(tolua_S);
+		return 1;
+	}
+	int NumBlocks = self->GetBlockCount();
+	lua_createtable(tolua_S, NumBlocks, 0);
+	for (int i = 0; i < NumBlocks; i++)
+	{
+		lua_pushnumber(tolua_S, Data[i]);
+		lua_rawseti(tolua_S, -2, i + 1);
+	}
+	return 1;
+}
+
+
+
+
+
+/** Sets the whole data array from an array-table of numbers, in the same order as GetDataArray().
+Returns false if the size doesn't match or the area doesn't hold the data. */
+static int tolua_cBlockArea_SetDataArray(lua_State * tolua_S, cBlockAreaDataFn a_DataFn, const char * a_FnName)
+{
+	cBlockArea * self = GetBlockAreaForBulkAccess(tolua_S, true, a_FnName);
+	if (self == NULL)
+	{
+		return 0;
+	}
+	unsigned char * Data = (self->*a_DataFn)();
+	int NumBlocks = self->GetBlockCount();
+	if (!lua_istable(tolua_S, 2) || (Data == NULL) || (lua_objlen(tolua_S, 2) != (size_t)NumBlocks))
+	{
+		tolua_pushboolean(tolua_S, false);
+		return 1;
+	}
+	for (int i = 0; i < NumBlocks; i++)
+	{
+		lua_rawgeti(tolua_S, 2, i + 1);
+		Data[i] = (unsigned char)lua_tonumber(tolua_S, -1);
+		lua_pop(tolua_S, 1);
+	}
+	tolua_pushboolean(tolua_S, true);
+	return 1;
+}
+
+
+
+
+
+static int tolua_cBlockArea_GetBlockTypesString(lua_State * tolua_S)
+{
+	return tolua_cBlockArea_GetDataString(tolua_S, &cBlockArea::GetBlockTypes, "GetBlockTypesString");
+}
+
+
+
+
+
+static int tolua_cBlockArea_GetBlockMetasString(lua_State * tolua_S)
+{
+	return tolua_cBlockArea_GetDataString(tolua_S, &cBlockArea::GetBlockMetas, "GetBlockMetasString");
+}
+
+
+
+
+
+static int tolua_cBlockArea_SetBlockTypesString(lua_State * tolua_S)
+{
+	return tolua_cBlockArea_SetDataString(tolua_S, &cBlockArea::GetBlockTypes, "SetBlockTypesString");
+}
+
+
+
+
+
+static int tolua_cBlockArea_SetBlockMetasString(lua_State * tolua_S)
+{
+	return tolua_cBlockArea_SetDataString(tolua_S, &cBlockArea::GetBlockMetas, "SetBlockMetasString");
+}
+
+
+
+
+
+static int tolua_cBlockArea_GetBlockTypesArray(lua_State * tolua_S)
+{
+	return tolua_cBlockArea_GetDataArray(tolua_S, &cBlockArea::GetBlockTypes, "GetBlockTypesArray");
+}
+
+
+
+
+
+static int tolua_cBlockArea_GetBlockMetasArray(lua_State * tolua_S)
+{
+	return tolua_cBlockArea_GetDataArray(tolua_S, &cBlockArea::GetBlockMetas, "GetBlockMetasArray");
+}
+
+
+
+
+
+static int tolua_cBlockArea_SetBlockTypesArray(lua_State * tolua_S)
+{
+	return tolua_cBlockArea_SetDataArray(tolua_S, &cBlockArea::GetBlockTypes, "SetBlockTypesArray");
+}
+
+
+
+
+
+static int tolua_cBlockArea_SetBlockMetasArray(lua_State * tolua_S)
+{
+	return tolua_cBlockArea_SetDataArray(tolua_S, &cBlockArea::GetBlockMetas, "SetBlockMetasArray");
+}
+
+
+
+/** Calls the plugin's function once an asynchronous cBlockArea:ReadAsync() or cBlockArea:WriteAsync() finishes.
+Keeps a reference to the area's userdata, so that Lua doesn't collect the area in the meantime.
+The references are released when the callback is deleted, whether it has been called or the request was dropped.
+The plugin cancels its pending requests when it is closed (cPluginLua::CancelBlockAreaRequests()). */
+class cLuaBlockAreaCallback :
+	public cBlockAreaCallback
+{
+public:
+	cLuaBlockAreaCallback(cPluginLua & a_Plugin, int a_FnRef, int a_AreaRef) :
+		m_Plugin(a_Plugin),
+		m_FnRef(a_FnRef),
+		m_AreaRef(a_AreaRef)
+	{
+	}
+	
+	virtual ~cLuaBlockAreaCallback()
+	{
+		m_Plugin.Unreference(m_FnRef);
+		m_Plugin.Unreference(m_AreaRef);
+	}
+
+protected:
+	cPluginLua & m_Plugin;
+	int m_FnRef;
+	int m_AreaRef;
+	
+	// cBlockAreaCallback overrides:
+	virtual void OnFinished(cBlockArea & a_Area, bool a_IsSuccess) override
+	{
+		m_Plugin.Call(m_FnRef, &a_Area, a_IsSuccess);
+	}
+	
+	virtual const void * GetOwner(void) const override
+	{
+		return &m_Plugin;
+	}
+} ;
+
+
+
+
+
+/** Checks the common params of cBlockArea:ReadAsync() and cBlockArea:WriteAsync().
+a_NumCoords is the number of the coord params following the world, they may be followed by the optional DataTypes and must be followed by the callback.
+Returns the callback for the area, or NULL on error. a_World and a_DataTypes receive the respective params. */
+static cLuaBlockAreaCallback * GetBlockAreaAsyncParams(lua_State * tolua_S, int a_NumCoords, const char * a_FnName, cWorld *& a_World, int & a_DataTypes)
+{
+	cPluginLua * Plugin = GetLuaPlugin(tolua_S);
+	if (Plugin == NULL)
+	{
+		// An error message has been already printed in GetLuaPlugin()
+		return NULL;
+	}
+	
+	cLuaState L(tolua_S);
+	int FnIdx = 3 + a_NumCoords;
+	if (lua_isnumber(tolua_S, FnIdx))
+	{
+		// The optional DataTypes param is present
+		FnIdx += 1;
+	}
+	if (
+		!L.CheckParamUserType(1, "cBlockArea") ||
+		!L.CheckParamUserType(2, "cWorld") ||
+		!L.CheckParamNumber  (3, FnIdx - 1) ||
+		!L.CheckParamFunction(FnIdx) ||
+		!L.CheckParamEnd     (FnIdx + 1)
+	)
+	{
+		return NULL;
+	}
+	cBlockArea * self = (cBlockArea *)tolua_tousertype(tolua_S, 1, NULL);
+	if (self == NULL)
+	{
+		tolua_error(tolua_S, Printf("invalid 'self' in function 'cBlockArea:%s'", a_FnName).c_str(), NULL);
+		return NULL;
+	}
+	a_World = (cWorld *)tolua_tousertype(tolua_S, 2, NULL);
+	if (a_World == NULL)
+	{
+		tolua_error(tolua_S, Printf("invalid 'World' in function 'cBlockArea:%s'", a_FnName).c_str(), NULL);
+		return NULL;
+	}
+	a_DataTypes = (FnIdx > 3 + a_NumCoords) ? (int)tolua_tonumber(tolua_S, FnIdx - 1, 0) : (cBlockArea::baTypes | cBlockArea::baMetas);
+	
+	// Create the references to the function and the area:
+	lua_pushvalue(tolua_S, FnIdx);
+	int FnRef = luaL_ref(tolua_S, LUA_REGISTRYINDEX);
+	lua_pushvalue(tolua_S, 1);
+	int AreaRef = luaL_ref(tolua_S, LUA_REGISTRYINDEX);
+	if ((FnRef == LUA_REFNIL) || (AreaRef == LUA_REFNIL))
+	{
+		tolua_error(tolua_S, Printf("Could not get the references for function 'cBlockArea:%s'", a_FnName).c_str(), NULL);
+		return NULL;
+	}
+	return new cLuaBlockAreaCallback(*Plugin, FnRef, AreaRef);
+}
+
+
+
+
+
+static int tolua_cBlockArea_ReadAsync(lua_State * tolua_S)
+{
+	// function cBlockArea:ReadAsync(World, MinX, MaxX, MinY, MaxY, MinZ, MaxZ, [DataTypes,] Callback)
+	cWorld * World;
+	int DataTypes;
+	cLuaBlockAreaCallback * Callback = GetBlockAreaAsyncParams(tolua_S, 6, "ReadAsync", World, DataTypes);
+	if (Callback == NULL)
+	{
+		return 0;
+	}
+	cBlockArea * self = (cBlockArea *)tolua_tousertype(tolua_S, 1, NULL);
+	World->ReadBlockAreaAsync(
+		*self,
+		(int)tolua_tonumber(tolua_S, 3, 0), (int)tolua_tonumber(tolua_S, 4, 0),
+		(int)tolua_tonumber(tolua_S, 5, 0), (int)tolua_tonumber(tolua_S, 6, 0),
+		(int)tolua_tonumber(tolua_S, 7, 0), (int)tolua_tonumber(tolua_S, 8, 0),
+		DataTypes, Callback
+	);
+	return 0;
+}
+
+
+
+
+
+static int tolua_cBlockArea_WriteAsync(lua_State * tolua_S)
+{
+	// function cBlockArea:WriteAsync(World, MinX, MinY, MinZ, [DataTypes,] Callback)
+	cWorld * World;
+	int DataTypes;
+	cLuaBlockAreaCallback * Callback = GetBlockAreaAsyncParams(tolua_S, 3, "WriteAsync", World, DataTypes);
+	if (Callback == NULL)
+	{
+		return 0;
+	}
+	cBlockArea * self = (cBlockArea *)tolua_tousertype(tolua_S, 1, NULL);
+	World->WriteBlockAreaAsync(
+		*self,
+		(int)tolua_tonumber(tolua_S, 3, 0), (int)tolua_tonumber(tolua_S, 4, 0), (int)tolua_tonumber(tolua_S, 5, 0),
+		DataTypes & self->GetDataTypes(), Callback
+	);
+	return 0;
+}
+
+
+
+
+
 void ManualBindings::Bind(lua_State * tolua_S)
 {
 	tolua_beginmodule(tolua_S, NULL);
@@ -2388,6 +2746,16 @@ void ManualBindings::Bind(lua_State * tolua_S)
 		tolua_beginmodule(tolua_S, "cBlockArea");
 			tolua_function(tolua_S, "LoadFromSchematicFile", tolua_cBlockArea_LoadFromSchematicFile);
 			tolua_function(tolua_S, "SaveToSchematicFile", tolua_cBlockArea_SaveToSchematicFile);
+			tolua_function(tolua_S, "GetBlockTypesString", tolua_cBlockArea_GetBlockTypesString);
+			tolua_function(tolua_S, "GetBlockMetasString", tolua_cBlockArea_GetBlockMetasString);
+			tolua_function(tolua_S, "SetBlockTypesString", tolua_cBlockArea_SetBlockTypesString);
+			tolua_function(tolua_S, "SetBlockMetasString", tolua_cBlockArea_SetBlockMetasString);
+			tolua_function(tolua_S, "GetBlockTypesArray",  tolua_cBlockArea_GetBlockTypesArray);
+			tolua_function(tolua_S, "GetBlockMetasArray",  tolua_cBlockArea_GetBlockMetasArray);
+			tolua_function(tolua_S, "SetBlockTypesArray",  tolua_cBlockArea_SetBlockTypesArray);
+			tolua_function(tolua_S, "SetBlockMetasArray",  tolua_cBlockArea_SetBlockMetasArray);
+			tolua_function(tolua_S, "ReadAsync",           tolua_cBlockArea_ReadAsync);
+			tolua_function(tolua_S, "WriteAsync",          tolua_cBlockArea_WriteAsync);
 		tolua_endmodule(tolua_S);
 		
 		tolua_beginmodule(tolua_S, "cHopperEntity");
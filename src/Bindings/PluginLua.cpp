@@ -8,6 +8,8 @@
 #define LUA_USE_POSIX
 #include "PluginLua.h"
 #include "../CommandOutput.h"
+#include "../Root.h"
+#include "../World.h"
 
 extern "C"
 {
@@ -25,6 +27,7 @@ extern "C"
 
 cPluginLua::cPluginLua(const AString & a_PluginDirectory) :
 	cPlugin(a_PluginDirectory),
+	m_CriticalSection("cPluginLua::m_CriticalSection"),
 	m_LuaState(Printf("plugin %s", a_PluginDirectory.c_str()))
 {
 }
@@ -35,6 +38,9 @@ cPluginLua::cPluginLua(const AString & a_PluginDirectory) :
 
 cPluginLua::~cPluginLua()
 {
+	// The pending async callbacks would outlive the plugin; they lock it while running, so wait for them before locking:
+	CancelBlockAreaRequests(true);
+	
 	cCSLock Lock(m_CriticalSection);
 	Close();
 }
@@ -47,6 +53,9 @@ void cPluginLua::Close(void)
 {
 	if (m_LuaState.IsValid())
 	{
+		// The async cBlockArea operations use the areas in the LuaState that is being closed:
+		CancelBlockAreaRequests(false);
+		
 		// Release all the references in the hook map:
 		for (cHookMap::iterator itrH = m_HookMap.begin(), endH = m_HookMap.end(); itrH != endH; ++itrH)
 		{
@@ -69,6 +78,43 @@ void cPluginLua::Close(void)
 
 
 
+void cPluginLua::CancelBlockAreaRequests(bool a_ShouldWaitForCallbacks)
+{
+	class cCanceller :
+		public cWorldListCallback
+	{
+	public:
+		cCanceller(cPluginLua & a_Plugin, bool a_ShouldWaitForCallbacks) :
+			m_Plugin(a_Plugin),
+			m_ShouldWaitForCallbacks(a_ShouldWaitForCallbacks)
+		{
+		}
+		
+	protected:
+		cPluginLua & m_Plugin;
+		bool m_ShouldWaitForCallbacks;
+		
+		virtual bool Item(cWorld * a_World) override
+		{
+			a_World->GetBlockAreaIO().CancelRequests(&m_Plugin);
+			if (m_ShouldWaitForCallbacks)
+			{
+				a_World->GetBlockAreaIO().WaitForCallbacks();
+			}
+			return false;
+		}
+	} Canceller(*this, a_ShouldWaitForCallbacks);
+	
+	if (cRoot::Get() != NULL)
+	{
+		cRoot::Get()->ForEachWorld(Canceller);
+	}
+}
+
+
+
+
+
 bool cPluginLua::Initialize(void)
 {
 	cCSLock Lock(m_CriticalSection);
@@ -1626,6 +1672,11 @@ void cPluginLua::BindConsoleCommand(const AString & a_Command, int a_FnRef)
 void cPluginLua::Unreference(int a_LuaRef)
 {
 	cCSLock Lock(m_CriticalSection);
+	if (!m_LuaState.IsValid())
+	{
+		// The LuaState has been closed, together with all its references
+		return;
+	}
 	luaL_unref(m_LuaState, LUA_REGISTRYINDEX, a_LuaRef);
 }
 
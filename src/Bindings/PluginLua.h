@@ -237,6 +237,12 @@ protected:
 	
 	/** Releases all Lua references and closes the LuaState */
 	void Close(void);
+	
+	/** Cancels the plugin's asynchronous cBlockArea reads and writes in all worlds, the areas live in the LuaState.
+	Waits for the operations that are in progress. If a_ShouldWaitForCallbacks is true, waits also for the callbacks
+	that are being called in the worlds' tick threads; that must not be done while m_CriticalSection is locked,
+	the callbacks lock it. */
+	void CancelBlockAreaRequests(bool a_ShouldWaitForCallbacks);
 } ;  // tolua_export
 
 
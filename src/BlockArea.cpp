@@ -8,6 +8,21 @@
 #include "BlockArea.h"
 #include "OSSupport/GZipFile.h"
 #include "Blocks/BlockHandler.h"
+#include "BlockArrayOps.h"
+#include "OSSupport/IsThread.h"
+
+
+
+
+
+/** Reads of at least this many chunks snapshot the chunks and copy the snapshots into the area in parallel */
+#define BLOCKAREA_PARALLEL_READ_MIN_CHUNKS 16
+
+/** Each worker thread helping a parallel read gets at least this many chunks to copy */
+#define BLOCKAREA_MIN_CHUNKS_PER_WORKER 4
+
+/** The number of worker threads shared by the parallel reads, the reading thread helps them as well */
+#define BLOCKAREA_MAX_READ_WORKERS 3
 
 
 
@@ -52,41 +67,66 @@ template<typename Combinator> void InternalMergeBlocks(
 
 
 
-/// Combinator used for cBlockArea::msOverwrite merging
-static void MergeCombinatorOverwrite(BLOCKTYPE & a_DstType, BLOCKTYPE a_SrcType, NIBBLETYPE & a_DstMeta, NIBBLETYPE a_SrcMeta)
+/// Merges two blocktypes and blockmetas the same way as InternalMergeBlocks(), but hands whole X rows to the row combinator
+template<typename RowCombinator> void InternalMergeRows(
+	BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes,
+	NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, 
+	int a_SizeX, int a_SizeY, int a_SizeZ,
+	int a_SrcOffX, int a_SrcOffY, int a_SrcOffZ,
+	int a_DstOffX, int a_DstOffY, int a_DstOffZ,
+	int a_SrcSizeX, int a_SrcSizeY, int a_SrcSizeZ,
+	int a_DstSizeX, int a_DstSizeY, int a_DstSizeZ,
+	RowCombinator a_RowCombinator
+)
 {
-	a_DstType = a_SrcType;
-	a_DstMeta = a_SrcMeta;
+	UNUSED(a_SrcSizeY);
+	UNUSED(a_DstSizeY);
+	if (a_SizeX <= 0)
+	{
+		return;
+	}
+	for (int y = 0; y < a_SizeY; y++)
+	{
+		int SrcBaseY = (y + a_SrcOffY) * a_SrcSizeX * a_SrcSizeZ;
+		int DstBaseY = (y + a_DstOffY) * a_DstSizeX * a_DstSizeZ;
+		for (int z = 0; z < a_SizeZ; z++)
+		{
+			int SrcIdx = SrcBaseY + (z + a_SrcOffZ) * a_SrcSizeX + a_SrcOffX;
+			int DstIdx = DstBaseY + (z + a_DstOffZ) * a_DstSizeX + a_DstOffX;
+			a_RowCombinator(a_DstTypes + DstIdx, a_SrcTypes + SrcIdx, a_DstMetas + DstIdx, a_SrcMetas + SrcIdx, a_SizeX);
+		}  // for z
+	}  // for y
 }
 
 
 
 
 
-/// Combinator used for cBlockArea::msFillAir merging
-static void MergeCombinatorFillAir(BLOCKTYPE & a_DstType, BLOCKTYPE a_SrcType, NIBBLETYPE & a_DstMeta, NIBBLETYPE a_SrcMeta)
+/// Row combinator used for cBlockArea::msOverwrite merging
+static void MergeRowsOverwrite(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
 {
-	if (a_DstType == E_BLOCK_AIR)
-	{
-		a_DstType = a_SrcType;
-		a_DstMeta = a_SrcMeta;
-	}
-	// "else" is the default, already in place
+	memcpy(a_DstTypes, a_SrcTypes, a_Count * sizeof(BLOCKTYPE));
+	memcpy(a_DstMetas, a_SrcMetas, a_Count * sizeof(NIBBLETYPE));
 }
 
 
 
 
 
-/// Combinator used for cBlockArea::msImprint merging
-static void MergeCombinatorImprint(BLOCKTYPE & a_DstType, BLOCKTYPE a_SrcType, NIBBLETYPE & a_DstMeta, NIBBLETYPE a_SrcMeta)
+/// Row combinator used for cBlockArea::msFillAir merging
+static void MergeRowsFillAir(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
 {
-	if (a_SrcType != E_BLOCK_AIR)
-	{
-		a_DstType = a_SrcType;
-		a_DstMeta = a_SrcMeta;
-	}
-	// "else" is the default, already in place
+	cBlockArrayOps::MergeFillAir(a_DstTypes, a_SrcTypes, a_DstMetas, a_SrcMetas, a_Count);
+}
+
+
+
+
+
+/// Row combinator used for cBlockArea::msImprint merging
+static void MergeRowsImprint(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
+{
+	cBlockArrayOps::MergeImprint(a_DstTypes, a_SrcTypes, a_DstMetas, a_SrcMetas, a_Count);
 }
 
 
@@ -157,6 +197,43 @@ static void MergeCombinatorLake(BLOCKTYPE & a_DstType, BLOCKTYPE a_SrcType, NIBB
 
 
 
+/** Caches the results of one of the blockhandlers' meta transformations (MetaRotateCW() etc.) for each blocktype and
+meta, so that transforming a large area doesn't need a virtual call per block. A blocktype's row is filled when first used. */
+class cMetaTransformTable
+{
+public:
+	typedef NIBBLETYPE (cBlockHandler::*cTransform)(NIBBLETYPE a_Meta);
+	
+	cMetaTransformTable(cTransform a_Transform) :
+		m_Transform(a_Transform)
+	{
+		memset(m_IsFilled, 0, sizeof(m_IsFilled));
+	}
+	
+	NIBBLETYPE Transform(BLOCKTYPE a_BlockType, NIBBLETYPE a_Meta)
+	{
+		if (!m_IsFilled[a_BlockType])
+		{
+			cBlockHandler * Handler = BlockHandler(a_BlockType);
+			for (NIBBLETYPE Meta = 0; Meta < 16; Meta++)
+			{
+				m_Metas[a_BlockType][Meta] = (Handler->*m_Transform)(Meta);
+			}
+			m_IsFilled[a_BlockType] = true;
+		}
+		return m_Metas[a_BlockType][a_Meta & 0x0f];
+	}
+	
+protected:
+	cTransform m_Transform;
+	bool       m_IsFilled[256];
+	NIBBLETYPE m_Metas[256][16];
+} ;
+
+
+
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // cBlockArea:
 
@@ -316,7 +393,6 @@ bool cBlockArea::Read(cForEachChunkProvider * a_ForEachChunkProvider, int a_MinB
 	m_OriginX = a_MinBlockX;
 	m_OriginY = a_MinBlockY;
 	m_OriginZ = a_MinBlockZ;
-	cChunkReader Reader(*this);
 	
 	// Convert block coords to chunks coords:
 	int MinChunkX, MaxChunkX;
@@ -324,12 +400,27 @@ bool cBlockArea::Read(cForEachChunkProvider * a_ForEachChunkProvider, int a_MinB
 	cChunkDef::AbsoluteToRelative(a_MinBlockX, a_MinBlockY, a_MinBlockZ, MinChunkX, MinChunkZ);
 	cChunkDef::AbsoluteToRelative(a_MaxBlockX, a_MaxBlockY, a_MaxBlockZ, MaxChunkX, MaxChunkZ);
 	
-	// Query block data:
+	// Small areas are copied directly while each chunk is locked:
+	int NumChunks = (MaxChunkX - MinChunkX + 1) * (MaxChunkZ - MinChunkZ + 1);
+	if (NumChunks < BLOCKAREA_PARALLEL_READ_MIN_CHUNKS)
+	{
+		cChunkReader Reader(*this);
+		if (!a_ForEachChunkProvider->ForEachChunkInRect(MinChunkX, MaxChunkX, MinChunkZ, MaxChunkZ, Reader))
+		{
+			Clear();
+			return false;
+		}
+		return true;
+	}
+	
+	// Large areas only snapshot the needed layers while each chunk is locked, then copy the snapshots in parallel:
+	cParallelChunkReader Reader(*this);
 	if (!a_ForEachChunkProvider->ForEachChunkInRect(MinChunkX, MaxChunkX, MinChunkZ, MaxChunkZ, Reader))
 	{
 		Clear();
 		return false;
 	}
+	Reader.Finish();
 	
 	return true;
 }
@@ -566,7 +657,7 @@ void cBlockArea::Merge(const cBlockArea & a_Src, int a_RelX, int a_RelY, int a_R
 	{
 		case msOverwrite:
 		{
-			InternalMergeBlocks(
+			InternalMergeRows(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -574,14 +665,14 @@ void cBlockArea::Merge(const cBlockArea & a_Src, int a_RelX, int a_RelY, int a_R
 				DstOffX, DstOffY, DstOffZ,
 				a_Src.GetSizeX(), a_Src.GetSizeY(), a_Src.GetSizeZ(),
 				m_SizeX, m_SizeY, m_SizeZ,
-				MergeCombinatorOverwrite
+				MergeRowsOverwrite
 			);
 			break;
 		}  // case msOverwrite
 		
 		case msFillAir:
 		{
-			InternalMergeBlocks(
+			InternalMergeRows(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -589,14 +680,14 @@ void cBlockArea::Merge(const cBlockArea & a_Src, int a_RelX, int a_RelY, int a_R
 				DstOffX, DstOffY, DstOffZ,
 				a_Src.GetSizeX(), a_Src.GetSizeY(), a_Src.GetSizeZ(),
 				m_SizeX, m_SizeY, m_SizeZ,
-				MergeCombinatorFillAir
+				MergeRowsFillAir
 			);
 			break;
 		}  // case msFillAir
 		
 		case msImprint:
 		{
-			InternalMergeBlocks(
+			InternalMergeRows(
 				m_BlockTypes, a_Src.GetBlockTypes(),
 				DstMetas, SrcMetas,
 				SizeX, SizeY, SizeZ,
@@ -604,7 +695,7 @@ void cBlockArea::Merge(const cBlockArea & a_Src, int a_RelX, int a_RelY, int a_R
 				DstOffX, DstOffY, DstOffZ,
 				a_Src.GetSizeX(), a_Src.GetSizeY(), a_Src.GetSizeZ(),
 				m_SizeX, m_SizeY, m_SizeZ,
-				MergeCombinatorImprint
+				MergeRowsImprint
 			);
 			break;
 		}  // case msImprint
@@ -656,31 +747,19 @@ void cBlockArea::Fill(int a_DataTypes, BLOCKTYPE a_BlockType, NIBBLETYPE a_Block
 	int BlockCount = GetBlockCount();
 	if ((a_DataTypes & baTypes) != 0)
 	{
-		for (int i = 0; i < BlockCount; i++)
-		{
-			m_BlockTypes[i] = a_BlockType;
-		}
+		memset(m_BlockTypes, a_BlockType, BlockCount);
 	}
 	if ((a_DataTypes & baMetas) != 0)
 	{
-		for (int i = 0; i < BlockCount; i++)
-		{
-			m_BlockMetas[i] = a_BlockMeta;
-		}
+		memset(m_BlockMetas, a_BlockMeta, BlockCount);
 	}
 	if ((a_DataTypes & baLight) != 0)
 	{
-		for (int i = 0; i < BlockCount; i++)
-		{
-			m_BlockLight[i] = a_BlockLight;
-		}
+		memset(m_BlockLight, a_BlockLight, BlockCount);
 	}
 	if ((a_DataTypes & baSkyLight) != 0)
 	{
-		for (int i = 0; i < BlockCount; i++)
-		{
-			m_BlockSkyLight[i] = a_BlockSkyLight;
-		}
+		memset(m_BlockSkyLight, a_BlockSkyLight, BlockCount);
 	}
 }
 
@@ -701,33 +780,38 @@ void cBlockArea::FillRelCuboid(int a_MinRelX, int a_MaxRelX, int a_MinRelY, int
 		a_DataTypes = a_DataTypes & GetDataTypes();
 	}
 	
+	int SizeX = a_MaxRelX - a_MinRelX + 1;
+	if (SizeX <= 0)
+	{
+		return;
+	}
 	if ((a_DataTypes & baTypes) != 0)
 	{
-		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++) for (int x = a_MinRelX; x <= a_MaxRelX; x++)
+		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++)
 		{
-			m_BlockTypes[MakeIndex(x, y, z)] = a_BlockType;
-		}  // for x, z, y
+			memset(m_BlockTypes + MakeIndex(a_MinRelX, y, z), a_BlockType, SizeX);
+		}  // for z, y
 	}
 	if ((a_DataTypes & baMetas) != 0)
 	{
-		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++) for (int x = a_MinRelX; x <= a_MaxRelX; x++)
+		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++)
 		{
-			m_BlockMetas[MakeIndex(x, y, z)] = a_BlockMeta;
-		}  // for x, z, y
+			memset(m_BlockMetas + MakeIndex(a_MinRelX, y, z), a_BlockMeta, SizeX);
+		}  // for z, y
 	}
 	if ((a_DataTypes & baLight) != 0)
 	{
-		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++) for (int x = a_MinRelX; x <= a_MaxRelX; x++)
+		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++)
 		{
-			m_BlockLight[MakeIndex(x, y, z)] = a_BlockLight;
-		}  // for x, z, y
+			memset(m_BlockLight + MakeIndex(a_MinRelX, y, z), a_BlockLight, SizeX);
+		}  // for z, y
 	}
 	if ((a_DataTypes & baSkyLight) != 0)
 	{
-		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++) for (int x = a_MinRelX; x <= a_MaxRelX; x++)
+		for (int y = a_MinRelY; y <= a_MaxRelY; y++) for (int z = a_MinRelZ; z <= a_MaxRelZ; z++)
 		{
-			m_BlockSkyLight[MakeIndex(x, y, z)] = a_BlockSkyLight;
-		}  // for x, z, y
+			memset(m_BlockSkyLight + MakeIndex(a_MinRelX, y, z), a_BlockSkyLight, SizeX);
+		}  // for z, y
 	}
 }
 
@@ -868,23 +952,27 @@ void cBlockArea::RotateCCW(void)
 	}
 	
 	// We are guaranteed that both blocktypes and blockmetas exist; rotate both at the same time:
+	// The old area is read in its memory order; the new area's rows are m_SizeZ long
 	BLOCKTYPE * NewTypes = new BLOCKTYPE[m_SizeX * m_SizeY * m_SizeZ];
 	NIBBLETYPE * NewMetas = new NIBBLETYPE[m_SizeX * m_SizeY * m_SizeZ];
-	for (int x = 0; x < m_SizeX; x++)
+	cMetaTransformTable Rotate(&cBlockHandler::MetaRotateCCW);
+	int OldIdx = 0;
+	for (int y = 0; y < m_SizeY; y++)
 	{
-		int NewZ = m_SizeX - x - 1;
+		int NewBaseY = y * m_SizeX * m_SizeZ;
 		for (int z = 0; z < m_SizeZ; z++)
 		{
 			int NewX = z;
-			for (int y = 0; y < m_SizeY; y++)
+			for (int x = 0; x < m_SizeX; x++)
 			{
-				int NewIdx = NewX + NewZ * m_SizeX + y * m_SizeX * m_SizeZ;
-				int OldIdx = MakeIndex(x, y, z);
+				int NewZ = m_SizeX - x - 1;
+				int NewIdx = NewBaseY + NewX + NewZ * m_SizeZ;
 				NewTypes[NewIdx] = m_BlockTypes[OldIdx];
-				NewMetas[NewIdx] = BlockHandler(m_BlockTypes[OldIdx])->MetaRotateCCW(m_BlockMetas[OldIdx]);
-			}  // for y
+				NewMetas[NewIdx] = Rotate.Transform(m_BlockTypes[OldIdx], m_BlockMetas[OldIdx]);
+				++OldIdx;
+			}  // for x
 		}  // for z
-	}  // for x
+	}  // for y
 	std::swap(m_BlockTypes, NewTypes);
 	std::swap(m_BlockMetas, NewMetas);
 	delete[] NewTypes;
@@ -913,23 +1001,27 @@ void cBlockArea::RotateCW(void)
 	}
 	
 	// We are guaranteed that both blocktypes and blockmetas exist; rotate both at the same time:
+	// The old area is read in its memory order; the new area's rows are m_SizeZ long
 	BLOCKTYPE * NewTypes = new BLOCKTYPE[m_SizeX * m_SizeY * m_SizeZ];
 	NIBBLETYPE * NewMetas = new NIBBLETYPE[m_SizeX * m_SizeY * m_SizeZ];
-	for (int x = 0; x < m_SizeX; x++)
+	cMetaTransformTable Rotate(&cBlockHandler::MetaRotateCW);
+	int OldIdx = 0;
+	for (int y = 0; y < m_SizeY; y++)
 	{
-		int NewZ = x;
+		int NewBaseY = y * m_SizeX * m_SizeZ;
 		for (int z = 0; z < m_SizeZ; z++)
 		{
 			int NewX = m_SizeZ - z - 1;
-			for (int y = 0; y < m_SizeY; y++)
+			for (int x = 0; x < m_SizeX; x++)
 			{
-				int NewIdx = NewX + NewZ * m_SizeX + y * m_SizeX * m_SizeZ;
-				int OldIdx = MakeIndex(x, y, z);
+				int NewZ = x;
+				int NewIdx = NewBaseY + NewX + NewZ * m_SizeZ;
 				NewTypes[NewIdx] = m_BlockTypes[OldIdx];
-				NewMetas[NewIdx] = BlockHandler(m_BlockTypes[OldIdx])->MetaRotateCW(m_BlockMetas[OldIdx]);
-			}  // for y
+				NewMetas[NewIdx] = Rotate.Transform(m_BlockTypes[OldIdx], m_BlockMetas[OldIdx]);
+				++OldIdx;
+			}  // for x
 		}  // for z
-	}  // for x
+	}  // for y
 	std::swap(m_BlockTypes, NewTypes);
 	std::swap(m_BlockMetas, NewMetas);
 	delete[] NewTypes;
@@ -958,6 +1050,7 @@ void cBlockArea::MirrorXY(void)
 	}
 
 	// We are guaranteed that both blocktypes and blockmetas exist; mirror both at the same time:
+	cMetaTransformTable Mirror(&cBlockHandler::MetaMirrorXY);
 	int HalfZ = m_SizeZ / 2;
 	int MaxZ = m_SizeZ - 1;
 	for (int y = 0; y < m_SizeY; y++)
@@ -969,8 +1062,8 @@ void cBlockArea::MirrorXY(void)
 				int Idx1 = MakeIndex(x, y, z);
 				int Idx2 = MakeIndex(x, y, MaxZ - z);
 				std::swap(m_BlockTypes[Idx1], m_BlockTypes[Idx2]);
-				NIBBLETYPE Meta1 = BlockHandler(m_BlockTypes[Idx2])->MetaMirrorXY(m_BlockMetas[Idx1]);
-				NIBBLETYPE Meta2 = BlockHandler(m_BlockTypes[Idx1])->MetaMirrorXY(m_BlockMetas[Idx2]);
+				NIBBLETYPE Meta1 = Mirror.Transform(m_BlockTypes[Idx2], m_BlockMetas[Idx1]);
+				NIBBLETYPE Meta2 = Mirror.Transform(m_BlockTypes[Idx1], m_BlockMetas[Idx2]);
 				m_BlockMetas[Idx1] = Meta2;
 				m_BlockMetas[Idx2] = Meta1;
 			}  // for x
@@ -998,6 +1091,7 @@ void cBlockArea::MirrorXZ(void)
 	}
 
 	// We are guaranteed that both blocktypes and blockmetas exist; mirror both at the same time:
+	cMetaTransformTable Mirror(&cBlockHandler::MetaMirrorXZ);
 	int HalfY = m_SizeY / 2;
 	int MaxY = m_SizeY - 1;
 	for (int y = 0; y < HalfY; y++)
@@ -1009,8 +1103,8 @@ void cBlockArea::MirrorXZ(void)
 				int Idx1 = MakeIndex(x, y, z);
 				int Idx2 = MakeIndex(x, MaxY - y, z);
 				std::swap(m_BlockTypes[Idx1], m_BlockTypes[Idx2]);
-				NIBBLETYPE Meta1 = BlockHandler(m_BlockTypes[Idx2])->MetaMirrorXZ(m_BlockMetas[Idx1]);
-				NIBBLETYPE Meta2 = BlockHandler(m_BlockTypes[Idx1])->MetaMirrorXZ(m_BlockMetas[Idx2]);
+				NIBBLETYPE Meta1 = Mirror.Transform(m_BlockTypes[Idx2], m_BlockMetas[Idx1]);
+				NIBBLETYPE Meta2 = Mirror.Transform(m_BlockTypes[Idx1], m_BlockMetas[Idx2]);
 				m_BlockMetas[Idx1] = Meta2;
 				m_BlockMetas[Idx2] = Meta1;
 			}  // for x
@@ -1038,6 +1132,7 @@ void cBlockArea::MirrorYZ(void)
 	}
 
 	// We are guaranteed that both blocktypes and blockmetas exist; mirror both at the same time:
+	cMetaTransformTable Mirror(&cBlockHandler::MetaMirrorYZ);
 	int HalfX = m_SizeX / 2;
 	int MaxX = m_SizeX - 1;
 	for (int y = 0; y < m_SizeY; y++)
@@ -1049,8 +1144,8 @@ void cBlockArea::MirrorYZ(void)
 				int Idx1 = MakeIndex(x, y, z);
 				int Idx2 = MakeIndex(MaxX - x, y, z);
 				std::swap(m_BlockTypes[Idx1], m_BlockTypes[Idx2]);
-				NIBBLETYPE Meta1 = BlockHandler(m_BlockTypes[Idx2])->MetaMirrorYZ(m_BlockMetas[Idx1]);
-				NIBBLETYPE Meta2 = BlockHandler(m_BlockTypes[Idx1])->MetaMirrorYZ(m_BlockMetas[Idx2]);
+				NIBBLETYPE Meta1 = Mirror.Transform(m_BlockTypes[Idx2], m_BlockMetas[Idx1]);
+				NIBBLETYPE Meta2 = Mirror.Transform(m_BlockTypes[Idx1], m_BlockMetas[Idx2]);
 				m_BlockMetas[Idx1] = Meta2;
 				m_BlockMetas[Idx2] = Meta1;
 			}  // for x
@@ -1067,36 +1162,40 @@ void cBlockArea::RotateCCWNoMeta(void)
 	if (HasBlockTypes())
 	{
 		BLOCKTYPE * NewTypes = new BLOCKTYPE[m_SizeX * m_SizeY * m_SizeZ];
-		for (int x = 0; x < m_SizeX; x++)
+		int OldIdx = 0;
+		for (int y = 0; y < m_SizeY; y++)
 		{
-			int NewZ = m_SizeX - x - 1;
+			int NewBaseY = y * m_SizeX * m_SizeZ;
 			for (int z = 0; z < m_SizeZ; z++)
 			{
 				int NewX = z;
-				for (int y = 0; y < m_SizeY; y++)
+				for (int x = 0; x < m_SizeX; x++)
 				{
-					NewTypes[NewX + NewZ * m_SizeX + y * m_SizeX * m_SizeZ] = m_BlockTypes[MakeIndex(x, y, z)];
-				}  // for y
+					int NewZ = m_SizeX - x - 1;
+					NewTypes[NewBaseY + NewX + NewZ * m_SizeZ] = m_BlockTypes[OldIdx++];
+				}  // for x
 			}  // for z
-		}  // for x
+		}  // for y
 		std::swap(m_BlockTypes, NewTypes);
 		delete[] NewTypes;
 	}
 	if (HasBlockMetas())
 	{
 		NIBBLETYPE * NewMetas = new NIBBLETYPE[m_SizeX * m_SizeY * m_SizeZ];
-		for (int x = 0; x < m_SizeX; x++)
+		int OldIdx = 0;
+		for (int y = 0; y < m_SizeY; y++)
 		{
-			int NewZ = m_SizeX - x - 1;
+			int NewBaseY = y * m_SizeX * m_SizeZ;
 			for (int z = 0; z < m_SizeZ; z++)
 			{
 				int NewX = z;
-				for (int y = 0; y < m_SizeY; y++)
+				for (int x = 0; x < m_SizeX; x++)
 				{
-					NewMetas[NewX + NewZ * m_SizeX + y * m_SizeX * m_SizeZ] = m_BlockMetas[MakeIndex(x, y, z)];
-				}  // for y
+					int NewZ = m_SizeX - x - 1;
+					NewMetas[NewBaseY + NewX + NewZ * m_SizeZ] = m_BlockMetas[OldIdx++];
+				}  // for x
 			}  // for z
-		}  // for x
+		}  // for y
 		std::swap(m_BlockMetas, NewMetas);
 		delete[] NewMetas;
 	}
@@ -1112,36 +1211,40 @@ void cBlockArea::RotateCWNoMeta(void)
 	if (HasBlockTypes())
 	{
 		BLOCKTYPE * NewTypes = new BLOCKTYPE[m_SizeX * m_SizeY * m_SizeZ];
-		for (int z = 0; z < m_SizeZ; z++)
+		int OldIdx = 0;
+		for (int y = 0; y < m_SizeY; y++)
 		{
-			int NewX = m_SizeZ - z - 1;
-			for (int x = 0; x < m_SizeX; x++)
+			int NewBaseY = y * m_SizeX * m_SizeZ;
+			for (int z = 0; z < m_SizeZ; z++)
 			{
-				int NewZ = x;
-				for (int y = 0; y < m_SizeY; y++)
+				int NewX = m_SizeZ - z - 1;
+				for (int x = 0; x < m_SizeX; x++)
 				{
-					NewTypes[NewX + NewZ * m_SizeX + y * m_SizeX * m_SizeZ] = m_BlockTypes[MakeIndex(x, y, z)];
-				}  // for y
-			}  // for x
-		}  // for z
+					int NewZ = x;
+					NewTypes[NewBaseY + NewX + NewZ * m_SizeZ] = m_BlockTypes[OldIdx++];
+				}  // for x
+			}  // for z
+		}  // for y
 		std::swap(m_BlockTypes, NewTypes);
 		delete[] NewTypes;
 	}
 	if (HasBlockMetas())
 	{
 		NIBBLETYPE * NewMetas = new NIBBLETYPE[m_SizeX * m_SizeY * m_SizeZ];
-		for (int z = 0; z < m_SizeZ; z++)
+		int OldIdx = 0;
+		for (int y = 0; y < m_SizeY; y++)
 		{
-			int NewX = m_SizeZ - z - 1;
-			for (int x = 0; x < m_SizeX; x++)
+			int NewBaseY = y * m_SizeX * m_SizeZ;
+			for (int z = 0; z < m_SizeZ; z++)
 			{
-				int NewZ = x;
-				for (int y = 0; y < m_SizeY; y++)
+				int NewX = m_SizeZ - z - 1;
+				for (int x = 0; x < m_SizeX; x++)
 				{
-					NewMetas[NewX + NewZ * m_SizeX + y * m_SizeX * m_SizeZ] = m_BlockMetas[MakeIndex(x, y, z)];
-				}  // for y
-			}  // for x
-		}  // for z
+					int NewZ = x;
+					NewMetas[NewBaseY + NewX + NewZ * m_SizeZ] = m_BlockMetas[OldIdx++];
+				}  // for x
+			}  // for z
+		}  // for y
 		std::swap(m_BlockMetas, NewMetas);
 		delete[] NewMetas;
 	}
@@ -1644,64 +1747,90 @@ cBlockArea::cChunkReader::cChunkReader(cBlockArea & a_Area) :
 
 
 
-void cBlockArea::cChunkReader::CopyNibbles(NIBBLETYPE * a_AreaDst, const NIBBLETYPE * a_ChunkSrc)
+void cBlockArea::cChunkReader::GetChunkPart(int a_ChunkX, int a_ChunkZ, int & a_SizeX, int & a_SizeZ, int & a_OffX, int & a_OffZ, int & a_BaseX, int & a_BaseZ) const
 {
-	int SizeY = m_Area.m_SizeY;
-	int MinY = m_OriginY;
-	
-	// SizeX, SizeZ are the dmensions of the block data to copy from the current chunk (size of the geometric union)
-	// OffX, OffZ are the offsets of the current chunk data from the area origin
-	// BaseX, BaseZ are the offsets of the area data within the current chunk from the chunk borders
-	int SizeX = cChunkDef::Width;
-	int SizeZ = cChunkDef::Width;
-	int OffX, OffZ;
-	int BaseX, BaseZ;
-	OffX = m_CurrentChunkX * cChunkDef::Width - m_OriginX;
-	if (OffX < 0)
-	{
-		BaseX = -OffX;
-		SizeX += OffX;  // SizeX is decreased, OffX is negative
-		OffX = 0;
+	a_SizeX = cChunkDef::Width;
+	a_SizeZ = cChunkDef::Width;
+	a_OffX = a_ChunkX * cChunkDef::Width - m_OriginX;
+	if (a_OffX < 0)
+	{
+		a_BaseX = -a_OffX;
+		a_SizeX += a_OffX;  // SizeX is decreased, OffX is negative
+		a_OffX = 0;
 	}
 	else
 	{
-		BaseX = 0;
+		a_BaseX = 0;
 	}
-	OffZ = m_CurrentChunkZ * cChunkDef::Width - m_OriginZ;
-	if (OffZ < 0)
+	a_OffZ = a_ChunkZ * cChunkDef::Width - m_OriginZ;
+	if (a_OffZ < 0)
 	{
-		BaseZ = -OffZ;
-		SizeZ += OffZ;  // SizeZ is decreased, OffZ is negative
-		OffZ = 0;
+		a_BaseZ = -a_OffZ;
+		a_SizeZ += a_OffZ;  // SizeZ is decreased, OffZ is negative
+		a_OffZ = 0;
 	}
 	else
 	{
-		BaseZ = 0;
+		a_BaseZ = 0;
 	}
 	// If the chunk extends beyond the area in the X or Z axis, cut off the Size:
-	if ((m_CurrentChunkX + 1) * cChunkDef::Width > m_OriginX + m_Area.m_SizeX)
+	if ((a_ChunkX + 1) * cChunkDef::Width > m_OriginX + m_Area.m_SizeX)
 	{
-		SizeX -= (m_CurrentChunkX + 1) * cChunkDef::Width - (m_OriginX + m_Area.m_SizeX);
+		a_SizeX -= (a_ChunkX + 1) * cChunkDef::Width - (m_OriginX + m_Area.m_SizeX);
 	}
-	if ((m_CurrentChunkZ + 1) * cChunkDef::Width > m_OriginZ + m_Area.m_SizeZ)
+	if ((a_ChunkZ + 1) * cChunkDef::Width > m_OriginZ + m_Area.m_SizeZ)
 	{
-		SizeZ -= (m_CurrentChunkZ + 1) * cChunkDef::Width - (m_OriginZ + m_Area.m_SizeZ);
+		a_SizeZ -= (a_ChunkZ + 1) * cChunkDef::Width - (m_OriginZ + m_Area.m_SizeZ);
 	}
+}
+
+
+
 
+
+void cBlockArea::cChunkReader::CopyBlockTypes(int a_ChunkX, int a_ChunkZ, const BLOCKTYPE * a_ChunkSrc) const
+{
+	int SizeX, SizeZ, OffX, OffZ, BaseX, BaseZ;
+	GetChunkPart(a_ChunkX, a_ChunkZ, SizeX, SizeZ, OffX, OffZ, BaseX, BaseZ);
+	if ((SizeX <= 0) || (SizeZ <= 0))
+	{
+		return;
+	}
+
+	// The chunk data is in the XZY order, same as the area, so whole X rows are copied at once:
+	int SizeY = m_Area.m_SizeY;
 	for (int y = 0; y < SizeY; y++)
 	{
-		int ChunkY = MinY + y;
-		int AreaY = y;
+		const BLOCKTYPE * Layer = a_ChunkSrc + y * cChunkDef::Width * cChunkDef::Width;
 		for (int z = 0; z < SizeZ; z++)
 		{
-			int ChunkZ = BaseZ + z;
-			int AreaZ = OffZ + z;
-			for (int x = 0; x < SizeX; x++)
-			{
-				int ChunkX = BaseX + x;
-				int AreaX = OffX + x;
-				a_AreaDst[m_Area.MakeIndex(AreaX, AreaY, AreaZ)] = cChunkDef::GetNibble(a_ChunkSrc, ChunkX, ChunkY, ChunkZ);
-			}  // for x
+			memcpy(m_Area.m_BlockTypes + m_Area.MakeIndex(OffX, y, OffZ + z), Layer + BaseX + (BaseZ + z) * cChunkDef::Width, SizeX);
+		}  // for z
+	}  // for y
+}
+
+
+
+
+
+void cBlockArea::cChunkReader::CopyNibbles(int a_ChunkX, int a_ChunkZ, NIBBLETYPE * a_AreaDst, const NIBBLETYPE * a_ChunkSrc) const
+{
+	int SizeX, SizeZ, OffX, OffZ, BaseX, BaseZ;
+	GetChunkPart(a_ChunkX, a_ChunkZ, SizeX, SizeZ, OffX, OffZ, BaseX, BaseZ);
+	if ((SizeX <= 0) || (SizeZ <= 0))
+	{
+		return;
+	}
+
+	// Unpack each whole chunk layer at once, then copy the rows within the area:
+	NIBBLETYPE Layer[cChunkDef::Width * cChunkDef::Width];
+	int SizeY = m_Area.m_SizeY;
+	for (int y = 0; y < SizeY; y++)
+	{
+		cBlockArrayOps::UnpackNibbles(a_ChunkSrc + y * ARRAYCOUNT(Layer) / 2, Layer, ARRAYCOUNT(Layer));
+		for (int z = 0; z < SizeZ; z++)
+		{
+			memcpy(a_AreaDst + m_Area.MakeIndex(OffX, y, OffZ + z), Layer + BaseX + (BaseZ + z) * cChunkDef::Width, SizeX);
 		}  // for z
 	}  // for y
 }
@@ -1728,107 +1857,355 @@ void cBlockArea::cChunkReader::BlockTypes(const BLOCKTYPE * a_BlockTypes)
 		// Don't want BlockTypes
 		return;
 	}
+	CopyBlockTypes(m_CurrentChunkX, m_CurrentChunkZ, a_BlockTypes + cChunkDef::MakeIndexNoCheck(0, m_OriginY, 0));
+}
+
+
+
+
+
+void cBlockArea::cChunkReader::BlockMeta(const NIBBLETYPE * a_BlockMetas)
+{
+	if (m_Area.m_BlockMetas == NULL)
+	{
+		// Don't want metas
+		return;
+	}
+	CopyNibbles(m_CurrentChunkX, m_CurrentChunkZ, m_Area.m_BlockMetas, a_BlockMetas + cChunkDef::MakeIndexNoCheck(0, m_OriginY, 0) / 2);
+}
+
+
+
+
+
+void cBlockArea::cChunkReader::BlockLight(const NIBBLETYPE * a_BlockLight)
+{
+	if (m_Area.m_BlockLight == NULL)
+	{
+		// Don't want light
+		return;
+	}
+	CopyNibbles(m_CurrentChunkX, m_CurrentChunkZ, m_Area.m_BlockLight, a_BlockLight + cChunkDef::MakeIndexNoCheck(0, m_OriginY, 0) / 2);
+}
+
+
+
+
+
+void cBlockArea::cChunkReader::BlockSkyLight(const NIBBLETYPE * a_BlockSkyLight)
+{
+	if (m_Area.m_BlockSkyLight == NULL)
+	{
+		// Don't want skylight
+		return;
+	}
+	CopyNibbles(m_CurrentChunkX, m_CurrentChunkZ, m_Area.m_BlockSkyLight, a_BlockSkyLight + cChunkDef::MakeIndexNoCheck(0, m_OriginY, 0) / 2);
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cBlockArea::cParallelChunkReader:
+
+/** The worker threads helping the parallel reads copy their snapshots. They are started by the first parallel read
+that needs them and then wait for the next one, so that the reads don't start and stop threads each time.
+Only one read can use them at a time, a read that finds them busy copies its snapshots alone. */
+class cBlockArea::cParallelChunkReader::cWorkers
+{
+public:
+	cWorkers(void) :
+		m_Reader(NULL),
+		m_NumBusyWorkers(0)
+	{
+	}
 	
-	int SizeY = m_Area.m_SizeY;
-	int MinY = m_OriginY;
+	/** Stops the worker threads */
+	~cWorkers()
+	{
+		for (cWorkerThreads::iterator itr = m_Workers.begin(), end = m_Workers.end(); itr != end; ++itr)
+		{
+			delete *itr;
+		}
+	}
 	
-	// SizeX, SizeZ are the dmensions of the block data to copy from the current chunk (size of the geometric union)
-	// OffX, OffZ are the offsets of the current chunk data from the area origin
-	// BaseX, BaseZ are the offsets of the area data within the current chunk from the chunk borders
-	int SizeX = cChunkDef::Width;
-	int SizeZ = cChunkDef::Width;
-	int OffX, OffZ;
-	int BaseX, BaseZ;
-	OffX = m_CurrentChunkX * cChunkDef::Width - m_OriginX;
-	if (OffX < 0)
-	{
-		BaseX = -OffX;
-		SizeX += OffX;  // SizeX is decreased, OffX is negative
-		OffX = 0;
+	/** Copies all the snapshots of a_Reader into its area, using the worker threads and the calling thread.
+	Returns once all the snapshots are copied. */
+	void Process(cParallelChunkReader & a_Reader)
+	{
+		int NumWorkers = std::min((int)a_Reader.m_Snapshots.size() / BLOCKAREA_MIN_CHUNKS_PER_WORKER, BLOCKAREA_MAX_READ_WORKERS);
+		{
+			cCSLock Lock(m_CS);
+			if (m_Reader != NULL)
+			{
+				// Another read is using the workers
+				NumWorkers = 0;
+			}
+			while ((int)m_Workers.size() < NumWorkers)
+			{
+				cWorker * Worker = new cWorker(*this);
+				if (!Worker->Start())
+				{
+					delete Worker;
+					NumWorkers = (int)m_Workers.size();
+					break;
+				}
+				m_Workers.push_back(Worker);
+			}
+			if (NumWorkers > 0)
+			{
+				m_Reader = &a_Reader;
+				m_NumBusyWorkers = NumWorkers;
+			}
+		}
+		for (int i = 0; i < NumWorkers; i++)
+		{
+			m_Workers[i]->StartCopying();
+		}
+		
+		// Help the workers, this also processes everything if there are no workers for this read:
+		while (a_Reader.ProcessNextSnapshot())
+		{
+			// Nothing needed, just loop
+		}
+		
+		if (NumWorkers > 0)
+		{
+			m_evtFinished.Wait();
+			cCSLock Lock(m_CS);
+			m_Reader = NULL;
+		}
 	}
-	else
+	
+protected:
+	/** A worker thread, waiting for a read and then copying its snapshots until there are none left */
+	class cWorker :
+		public cIsThread
+	{
+		typedef cIsThread super;
+		
+	public:
+		cWorker(cWorkers & a_Parent) :
+			super("cBlockArea reader"),
+			m_Parent(a_Parent)
+		{
+		}
+		
+		/** Stops the thread */
+		virtual ~cWorker()
+		{
+			m_ShouldTerminate = true;
+			m_evtStart.Set();
+			Wait();
+		}
+		
+		/** Wakes the thread up to copy the snapshots of its parent's current read */
+		void StartCopying(void) { m_evtStart.Set(); }
+		
+	protected:
+		cWorkers & m_Parent;
+		
+		/** Set when there is a read to help, or to stop the thread */
+		cEvent m_evtStart;
+		
+		// cIsThread override:
+		virtual void Execute(void) override
+		{
+			for (;;)
+			{
+				m_evtStart.Wait();
+				if (m_ShouldTerminate)
+				{
+					return;
+				}
+				while (m_Parent.m_Reader->ProcessNextSnapshot())
+				{
+					// Nothing needed, just loop
+				}
+				m_Parent.WorkerFinished();
+			}
+		}
+	} ;
+	
+	typedef std::vector<cWorker *> cWorkerThreads;
+	
+	cWorkerThreads m_Workers;
+	
+	/** Protects m_Workers, m_Reader and m_NumBusyWorkers */
+	cCriticalSection m_CS;
+	
+	/** The read that is using the workers, NULL if they are free */
+	cParallelChunkReader * m_Reader;
+	
+	/** The number of workers that have been woken up for m_Reader and haven't run out of snapshots yet */
+	int m_NumBusyWorkers;
+	
+	/** Set by the last worker that runs out of snapshots */
+	cEvent m_evtFinished;
+	
+	/** Called by each worker once it runs out of snapshots; the last one sets m_evtFinished */
+	void WorkerFinished(void)
+	{
+		cCSLock Lock(m_CS);
+		ASSERT(m_NumBusyWorkers > 0);
+		m_NumBusyWorkers -= 1;
+		if (m_NumBusyWorkers == 0)
+		{
+			m_evtFinished.Set();
+		}
+	}
+} ;
+
+cBlockArea::cParallelChunkReader::cWorkers cBlockArea::cParallelChunkReader::s_Workers;
+
+
+
+
+
+cBlockArea::cParallelChunkReader::cParallelChunkReader(cBlockArea & a_Area) :
+	super(a_Area),
+	m_NextSnapshot(0)
+{
+}
+
+
+
+
+
+cBlockArea::cParallelChunkReader::~cParallelChunkReader()
+{
+	for (cSnapshots::iterator itr = m_Snapshots.begin(), end = m_Snapshots.end(); itr != end; ++itr)
 	{
-		BaseX = 0;
+		delete *itr;
 	}
-	OffZ = m_CurrentChunkZ * cChunkDef::Width - m_OriginZ;
-	if (OffZ < 0)
+}
+
+
+
+
+
+void cBlockArea::cParallelChunkReader::Finish(void)
+{
+	m_NextSnapshot = 0;
+	s_Workers.Process(*this);
+}
+
+
+
+
+
+bool cBlockArea::cParallelChunkReader::ProcessNextSnapshot(void)
+{
+	sSnapshot * Snapshot;
 	{
-		BaseZ = -OffZ;
-		SizeZ += OffZ;  // SizeZ is decreased, OffZ is negative
-		OffZ = 0;
+		cCSLock Lock(m_CS);
+		if (m_NextSnapshot >= m_Snapshots.size())
+		{
+			return false;
+		}
+		Snapshot = m_Snapshots[m_NextSnapshot];
+		m_NextSnapshot += 1;
 	}
-	else
+
+	// Each snapshot covers a different part of the area, so the copying needs no locking:
+	if (!Snapshot->m_BlockTypes.empty())
 	{
-		BaseZ = 0;
+		CopyBlockTypes(Snapshot->m_ChunkX, Snapshot->m_ChunkZ, &Snapshot->m_BlockTypes[0]);
 	}
-	// If the chunk extends beyond the area in the X or Z axis, cut off the Size:
-	if ((m_CurrentChunkX + 1) * cChunkDef::Width > m_OriginX + m_Area.m_SizeX)
+	if (!Snapshot->m_BlockMetas.empty())
+	{
+		CopyNibbles(Snapshot->m_ChunkX, Snapshot->m_ChunkZ, m_Area.m_BlockMetas, &Snapshot->m_BlockMetas[0]);
+	}
+	if (!Snapshot->m_BlockLight.empty())
 	{
-		SizeX -= (m_CurrentChunkX + 1) * cChunkDef::Width - (m_OriginX + m_Area.m_SizeX);
+		CopyNibbles(Snapshot->m_ChunkX, Snapshot->m_ChunkZ, m_Area.m_BlockLight, &Snapshot->m_BlockLight[0]);
 	}
-	if ((m_CurrentChunkZ + 1) * cChunkDef::Width > m_OriginZ + m_Area.m_SizeZ)
+	if (!Snapshot->m_BlockSkyLight.empty())
 	{
-		SizeZ -= (m_CurrentChunkZ + 1) * cChunkDef::Width - (m_OriginZ + m_Area.m_SizeZ);
+		CopyNibbles(Snapshot->m_ChunkX, Snapshot->m_ChunkZ, m_Area.m_BlockSkyLight, &Snapshot->m_BlockSkyLight[0]);
 	}
+	return true;
+}
 
-	for (int y = 0; y < SizeY; y++)
+
+
+
+
+void cBlockArea::cParallelChunkReader::SnapshotNibbles(std::vector<NIBBLETYPE> & a_Dst, const NIBBLETYPE * a_ChunkSrc)
+{
+	const NIBBLETYPE * Start = a_ChunkSrc + cChunkDef::MakeIndexNoCheck(0, m_OriginY, 0) / 2;
+	a_Dst.assign(Start, Start + m_Area.m_SizeY * cChunkDef::Width * cChunkDef::Width / 2);
+}
+
+
+
+
+
+bool cBlockArea::cParallelChunkReader::Coords(int a_ChunkX, int a_ChunkZ)
+{
+	sSnapshot * Snapshot = new sSnapshot;
+	Snapshot->m_ChunkX = a_ChunkX;
+	Snapshot->m_ChunkZ = a_ChunkZ;
+	m_Snapshots.push_back(Snapshot);
+	return true;
+}
+
+
+
+
+
+void cBlockArea::cParallelChunkReader::BlockTypes(const BLOCKTYPE * a_BlockTypes)
+{
+	if (m_Area.m_BlockTypes == NULL)
 	{
-		int ChunkY = MinY + y;
-		int AreaY = y;
-		for (int z = 0; z < SizeZ; z++)
-		{
-			int ChunkZ = BaseZ + z;
-			int AreaZ = OffZ + z;
-			for (int x = 0; x < SizeX; x++)
-			{
-				int ChunkX = BaseX + x;
-				int AreaX = OffX + x;
-				m_Area.m_BlockTypes[m_Area.MakeIndex(AreaX, AreaY, AreaZ)] = cChunkDef::GetBlock(a_BlockTypes, ChunkX, ChunkY, ChunkZ);
-			}  // for x
-		}  // for z
-	}  // for y
+		// Don't want BlockTypes
+		return;
+	}
+	const BLOCKTYPE * Start = a_BlockTypes + cChunkDef::MakeIndexNoCheck(0, m_OriginY, 0);
+	m_Snapshots.back()->m_BlockTypes.assign(Start, Start + m_Area.m_SizeY * cChunkDef::Width * cChunkDef::Width);
 }
 
 
 
 
 
-void cBlockArea::cChunkReader::BlockMeta(const NIBBLETYPE * a_BlockMetas)
+void cBlockArea::cParallelChunkReader::BlockMeta(const NIBBLETYPE * a_BlockMetas)
 {
 	if (m_Area.m_BlockMetas == NULL)
 	{
 		// Don't want metas
 		return;
 	}
-	CopyNibbles(m_Area.m_BlockMetas, a_BlockMetas);
+	SnapshotNibbles(m_Snapshots.back()->m_BlockMetas, a_BlockMetas);
 }
 
 
 
 
 
-void cBlockArea::cChunkReader::BlockLight(const NIBBLETYPE * a_BlockLight)
+void cBlockArea::cParallelChunkReader::BlockLight(const NIBBLETYPE * a_BlockLight)
 {
 	if (m_Area.m_BlockLight == NULL)
 	{
 		// Don't want light
 		return;
 	}
-	CopyNibbles(m_Area.m_BlockLight, a_BlockLight);
+	SnapshotNibbles(m_Snapshots.back()->m_BlockLight, a_BlockLight);
 }
 
 
 
 
 
-void cBlockArea::cChunkReader::BlockSkyLight(const NIBBLETYPE * a_BlockSkyLight)
+void cBlockArea::cParallelChunkReader::BlockSkyLight(const NIBBLETYPE * a_BlockSkyLight)
 {
 	if (m_Area.m_BlockSkyLight == NULL)
 	{
 		// Don't want skylight
 		return;
 	}
-	CopyNibbles(m_Area.m_BlockSkyLight, a_BlockSkyLight);
+	SnapshotNibbles(m_Snapshots.back()->m_BlockSkyLight, a_BlockSkyLight);
 }
 
 
@@ -1846,14 +2223,11 @@ void cBlockArea::CropBlockTypes(int a_AddMinX, int a_SubMaxX, int a_AddMinY, int
 	{
 		for (int z = 0; z < NewSizeZ; z++)
 		{
-			for (int x = 0; x < NewSizeX; x++)
-			{
-				int OldIndex = MakeIndex(x + a_AddMinX, y + a_AddMinY, z + a_AddMinZ);
-				NewBlockTypes[idx++] = m_BlockTypes[OldIndex];
-			}  // for x
+			memcpy(NewBlockTypes + idx, m_BlockTypes + MakeIndex(a_AddMinX, y + a_AddMinY, z + a_AddMinZ), NewSizeX * sizeof(BLOCKTYPE));
+			idx += NewSizeX;
 		}  // for z
 	}  // for y
-	delete m_BlockTypes;
+	delete[] m_BlockTypes;
 	m_BlockTypes = NewBlockTypes;
 }
 
@@ -1872,13 +2246,11 @@ void cBlockArea::CropNibbles(NIBBLEARRAY & a_Array, int a_AddMinX, int a_SubMaxX
 	{
 		for (int z = 0; z < NewSizeZ; z++)
 		{
-			for (int x = 0; x < NewSizeX; x++)
-			{
-				NewNibbles[idx++] = a_Array[MakeIndex(x + a_AddMinX, y + a_AddMinY, z + a_AddMinZ)];
-			}  // for x
+			memcpy(NewNibbles + idx, a_Array + MakeIndex(a_AddMinX, y + a_AddMinY, z + a_AddMinZ), NewSizeX * sizeof(NIBBLETYPE));
+			idx += NewSizeX;
 		}  // for z
 	}  // for y
-	delete a_Array;
+	delete[] a_Array;
 	a_Array = NewNibbles;
 }
 
@@ -1897,18 +2269,15 @@ void cBlockArea::ExpandBlockTypes(int a_SubMinX, int a_AddMaxX, int a_SubMinY, i
 	int OldIndex = 0;
 	for (int y = 0; y < m_SizeY; y++)
 	{
-		int IndexBaseY = (y + a_SubMinY) * m_SizeX * m_SizeZ;
+		int IndexBaseY = (y + a_SubMinY) * NewSizeX * NewSizeZ;
 		for (int z = 0; z < m_SizeZ; z++)
 		{
-			int IndexBaseZ = IndexBaseY + (z + a_SubMinZ) * m_SizeX;
-			int idx = IndexBaseZ + a_SubMinX;
-			for (int x = 0; x < m_SizeX; x++)
-			{
-				NewBlockTypes[idx++] = m_BlockTypes[OldIndex++];
-			}  // for x
+			int IndexBaseZ = IndexBaseY + (z + a_SubMinZ) * NewSizeX;
+			memcpy(NewBlockTypes + IndexBaseZ + a_SubMinX, m_BlockTypes + OldIndex, m_SizeX * sizeof(BLOCKTYPE));
+			OldIndex += m_SizeX;
 		}  // for z
 	}  // for y
-	delete m_BlockTypes;
+	delete[] m_BlockTypes;
 	m_BlockTypes = NewBlockTypes;
 }
 
@@ -1927,18 +2296,15 @@ void cBlockArea::ExpandNibbles(NIBBLEARRAY & a_Array, int a_SubMinX, int a_AddMa
 	int OldIndex = 0;
 	for (int y = 0; y < m_SizeY; y++)
 	{
-		int IndexBaseY = (y + a_SubMinY) * m_SizeX * m_SizeZ;
+		int IndexBaseY = (y + a_SubMinY) * NewSizeX * NewSizeZ;
 		for (int z = 0; z < m_SizeZ; z++)
 		{
-			int IndexBaseZ = IndexBaseY + (z + a_SubMinZ) * m_SizeX;
-			int idx = IndexBaseZ + a_SubMinX;
-			for (int x = 0; x < m_SizeX; x++)
-			{
-				NewNibbles[idx++] = a_Array[OldIndex++];
-			}  // for x
+			int IndexBaseZ = IndexBaseY + (z + a_SubMinZ) * NewSizeX;
+			memcpy(NewNibbles + IndexBaseZ + a_SubMinX, a_Array + OldIndex, m_SizeX * sizeof(NIBBLETYPE));
+			OldIndex += m_SizeX;
 		}  // for z
 	}  // for y
-	delete a_Array;
+	delete[] a_Array;
 	a_Array = NewNibbles;
 }
 
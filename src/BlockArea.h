@@ -232,7 +232,72 @@ protected:
 		int m_CurrentChunkX;
 		int m_CurrentChunkZ;
 		
-		void CopyNibbles(NIBBLETYPE * a_AreaDst, const NIBBLETYPE * a_ChunkSrc);
+		/** Calculates the part of the chunk that is within the area:
+		a_SizeX, a_SizeZ are the dimensions of the part,
+		a_OffX, a_OffZ are the offsets of the part from the area origin,
+		a_BaseX, a_BaseZ are the offsets of the part from the chunk borders */
+		void GetChunkPart(int a_ChunkX, int a_ChunkZ, int & a_SizeX, int & a_SizeZ, int & a_OffX, int & a_OffZ, int & a_BaseX, int & a_BaseZ) const;
+		
+		/** Copies the blocktypes of the chunk into the area. a_ChunkSrc points to the chunk's layer at the area's origin Y. */
+		void CopyBlockTypes(int a_ChunkX, int a_ChunkZ, const BLOCKTYPE * a_ChunkSrc) const;
+		
+		/** Unpacks the nibbles of the chunk into the area. a_ChunkSrc points to the chunk's layer at the area's origin Y. */
+		void CopyNibbles(int a_ChunkX, int a_ChunkZ, NIBBLETYPE * a_AreaDst, const NIBBLETYPE * a_ChunkSrc) const;
+		
+		// cChunkDataCallback overrides:
+		virtual bool Coords       (int a_ChunkX, int a_ChunkZ) override;
+		virtual void BlockTypes   (const BLOCKTYPE *  a_BlockTypes)    override;
+		virtual void BlockMeta    (const NIBBLETYPE * a_BlockMetas)    override;
+		virtual void BlockLight   (const NIBBLETYPE * a_BlockLight)    override;
+		virtual void BlockSkyLight(const NIBBLETYPE * a_BlockSkyLight) override;
+	} ;
+	
+	/** Reads large areas: while each chunk is locked, only the layers needed are copied out of it, as a snapshot.
+	The snapshots are copied into the area by several worker threads afterwards, without any lock held. */
+	class cParallelChunkReader :
+		public cChunkReader
+	{
+		typedef cChunkReader super;
+		
+	public:
+		cParallelChunkReader(cBlockArea & a_Area);
+		~cParallelChunkReader();
+		
+		/** Copies all the snapshots into the area, using the worker threads, and waits for them to finish */
+		void Finish(void);
+		
+	protected:
+		class cWorkers;
+		
+		/** The worker threads shared by all the parallel reads */
+		static cWorkers s_Workers;
+		
+		/** The layers of a single chunk needed for the area, in the chunk format */
+		struct sSnapshot
+		{
+			int m_ChunkX;
+			int m_ChunkZ;
+			std::vector<BLOCKTYPE>  m_BlockTypes;
+			std::vector<NIBBLETYPE> m_BlockMetas;
+			std::vector<NIBBLETYPE> m_BlockLight;
+			std::vector<NIBBLETYPE> m_BlockSkyLight;
+		} ;
+		
+		typedef std::vector<sSnapshot *> cSnapshots;
+		
+		cSnapshots m_Snapshots;
+		
+		/** Protects m_NextSnapshot while the workers run */
+		cCriticalSection m_CS;
+		
+		/** Index into m_Snapshots of the next snapshot for a worker to process */
+		size_t m_NextSnapshot;
+		
+		/** Copies the next unprocessed snapshot into the area. Returns false if there are no more. Called by the workers. */
+		bool ProcessNextSnapshot(void);
+		
+		/** Copies the layers needed for the area out of the chunk's nibble array */
+		void SnapshotNibbles(std::vector<NIBBLETYPE> & a_Dst, const NIBBLETYPE * a_ChunkSrc);
 		
 		// cChunkDataCallback overrides:
 		virtual bool Coords       (int a_ChunkX, int a_ChunkZ) override;
@@ -0,0 +1,305 @@
+
+// BlockAreaIOThread.cpp
+
+// Implements the cBlockAreaIOThread class representing the per-world thread that reads and writes cBlockArea objects asynchronously
+
+#include "Globals.h"
+#include "BlockAreaIOThread.h"
+#include "BlockArea.h"
+#include "World.h"
+
+
+
+
+
+/** Calls the callbacks of the finished requests in the tick thread */
+class cBlockAreaIOThread::cFinishedTask :
+	public cWorld::cTask
+{
+public:
+	cFinishedTask(cBlockAreaIOThread & a_IOThread) :
+		m_IOThread(a_IOThread)
+	{
+	}
+	
+protected:
+	cBlockAreaIOThread & m_IOThread;
+	
+	// cWorld::cTask override:
+	virtual void Run(cWorld &) override
+	{
+		m_IOThread.CallFinishedCallbacks();
+	}
+} ;
+
+
+
+
+
+cBlockAreaIOThread::cBlockAreaIOThread(void) :
+	super("cBlockAreaIOThread"),
+	m_World(NULL)
+{
+}
+
+
+
+
+
+cBlockAreaIOThread::~cBlockAreaIOThread()
+{
+	Stop();
+}
+
+
+
+
+
+void cBlockAreaIOThread::Start(cWorld * a_World)
+{
+	m_World = a_World;
+	super::Start();
+}
+
+
+
+
+
+void cBlockAreaIOThread::Stop(void)
+{
+	m_ShouldTerminate = true;
+	m_evtQueued.Set();
+	Wait();
+	
+	cCSLock Lock(m_CS);
+	for (cRequests::iterator itr = m_Requests.begin(), end = m_Requests.end(); itr != end; ++itr)
+	{
+		delete itr->m_Callback;
+	}
+	m_Requests.clear();
+	for (cFinished::iterator itr = m_Finished.begin(), end = m_Finished.end(); itr != end; ++itr)
+	{
+		delete itr->m_Callback;
+	}
+	m_Finished.clear();
+}
+
+
+
+
+
+void cBlockAreaIOThread::QueueRead(cBlockArea & a_Area, int a_MinBlockX, int a_MaxBlockX, int a_MinBlockY, int a_MaxBlockY, int a_MinBlockZ, int a_MaxBlockZ, int a_DataTypes, cBlockAreaCallback * a_Callback)
+{
+	sRequest Request;
+	Request.m_Area = &a_Area;
+	Request.m_IsWrite = false;
+	Request.m_MinBlockX = a_MinBlockX;
+	Request.m_MaxBlockX = a_MaxBlockX;
+	Request.m_MinBlockY = a_MinBlockY;
+	Request.m_MaxBlockY = a_MaxBlockY;
+	Request.m_MinBlockZ = a_MinBlockZ;
+	Request.m_MaxBlockZ = a_MaxBlockZ;
+	Request.m_DataTypes = a_DataTypes;
+	Request.m_Callback = a_Callback;
+	QueueRequest(Request);
+}
+
+
+
+
+
+void cBlockAreaIOThread::QueueWrite(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes, cBlockAreaCallback * a_Callback)
+{
+	sRequest Request;
+	Request.m_Area = &a_Area;
+	Request.m_IsWrite = true;
+	Request.m_MinBlockX = a_MinBlockX;
+	Request.m_MaxBlockX = a_MinBlockX;
+	Request.m_MinBlockY = a_MinBlockY;
+	Request.m_MaxBlockY = a_MinBlockY;
+	Request.m_MinBlockZ = a_MinBlockZ;
+	Request.m_MaxBlockZ = a_MinBlockZ;
+	Request.m_DataTypes = a_DataTypes;
+	Request.m_Callback = a_Callback;
+	QueueRequest(Request);
+}
+
+
+
+
+
+size_t cBlockAreaIOThread::GetQueueLength(void)
+{
+	cCSLock Lock(m_CS);
+	return m_Requests.size();
+}
+
+
+
+
+
+void cBlockAreaIOThread::CancelRequests(const void * a_Owner)
+{
+	std::vector<cBlockAreaCallback *> Cancelled;
+	{
+		cCSLock Lock(m_CS);
+		for (cRequests::iterator itr = m_Requests.begin(); itr != m_Requests.end();)
+		{
+			if ((itr->m_Callback != NULL) && (itr->m_Callback->GetOwner() == a_Owner))
+			{
+				Cancelled.push_back(itr->m_Callback);
+				itr = m_Requests.erase(itr);
+			}
+			else
+			{
+				++itr;
+			}
+		}
+	}
+	
+	{
+		// Wait for the request that is being processed, it may be the owner's:
+		cCSLock ProcessingLock(m_CSProcessing);
+	}
+	
+	{
+		cCSLock Lock(m_CS);
+		for (cFinished::iterator itr = m_Finished.begin(); itr != m_Finished.end();)
+		{
+			if (itr->m_Callback->GetOwner() == a_Owner)
+			{
+				Cancelled.push_back(itr->m_Callback);
+				itr = m_Finished.erase(itr);
+			}
+			else
+			{
+				++itr;
+			}
+		}
+	}
+	
+	// Delete the callbacks while no lock is held, they may need to lock their owner:
+	for (std::vector<cBlockAreaCallback *>::iterator itr = Cancelled.begin(), end = Cancelled.end(); itr != end; ++itr)
+	{
+		delete *itr;
+	}
+}
+
+
+
+
+
+void cBlockAreaIOThread::WaitForCallbacks(void)
+{
+	cCSLock Lock(m_CSCallbacks);
+}
+
+
+
+
+
+void cBlockAreaIOThread::QueueRequest(const sRequest & a_Request)
+{
+	{
+		cCSLock Lock(m_CS);
+		m_Requests.push_back(a_Request);
+	}
+	m_evtQueued.Set();
+}
+
+
+
+
+
+void cBlockAreaIOThread::CallFinishedCallbacks(void)
+{
+	cCSLock CallbacksLock(m_CSCallbacks);
+	for (;;)
+	{
+		sFinished Finished;
+		{
+			cCSLock Lock(m_CS);
+			if (m_Finished.empty())
+			{
+				return;
+			}
+			Finished = m_Finished.front();
+			m_Finished.pop_front();
+		}
+		Finished.m_Callback->OnFinished(*Finished.m_Area, Finished.m_IsSuccess);
+		delete Finished.m_Callback;
+	}
+}
+
+
+
+
+
+void cBlockAreaIOThread::Execute(void)
+{
+	for (;;)
+	{
+		m_evtQueued.Wait();
+		
+		// Process all the queued requests, the event may have been set only once for several of them:
+		while (!m_ShouldTerminate)
+		{
+			cCSLock ProcessingLock(m_CSProcessing);
+			sRequest Request;
+			{
+				cCSLock Lock(m_CS);
+				if (m_Requests.empty())
+				{
+					break;
+				}
+				Request = m_Requests.front();
+				m_Requests.pop_front();
+			}
+			
+			bool IsSuccess;
+			if (Request.m_IsWrite)
+			{
+				IsSuccess = Request.m_Area->Write(m_World, Request.m_MinBlockX, Request.m_MinBlockY, Request.m_MinBlockZ, Request.m_DataTypes);
+			}
+			else
+			{
+				IsSuccess = Request.m_Area->Read(
+					m_World,
+					Request.m_MinBlockX, Request.m_MaxBlockX,
+					Request.m_MinBlockY, Request.m_MaxBlockY,
+					Request.m_MinBlockZ, Request.m_MaxBlockZ,
+					Request.m_DataTypes
+				);
+			}
+			if (Request.m_Callback == NULL)
+			{
+				continue;
+			}
+			
+			// Queue the callback; the task calls all the queued ones, so a new task is needed only if there were none:
+			bool ShouldQueueTask;
+			{
+				cCSLock Lock(m_CS);
+				ShouldQueueTask = m_Finished.empty();
+				sFinished Finished;
+				Finished.m_Area = Request.m_Area;
+				Finished.m_IsSuccess = IsSuccess;
+				Finished.m_Callback = Request.m_Callback;
+				m_Finished.push_back(Finished);
+			}
+			if (ShouldQueueTask)
+			{
+				m_World->QueueTask(new cFinishedTask(*this));
+			}
+		}
+		
+		if (m_ShouldTerminate)
+		{
+			return;
+		}
+	}
+}
+
+
+
+
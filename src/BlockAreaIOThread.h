@@ -0,0 +1,143 @@
+
+// BlockAreaIOThread.h
+
+// Declares the cBlockAreaIOThread class representing the per-world thread that reads and writes cBlockArea objects asynchronously
+
+/*
+Plugins that read or write large areas would stall the tick thread for the whole operation. Instead, they can queue
+the operation here; it runs in this thread, locking the chunkmap for each chunk separately, and once it is finished,
+the callback is called in the tick thread. The area must not be accessed nor destroyed until then.
+
+The finished requests wait in m_Finished until the tick thread delivers them, so that all the requests of an owner
+(such as a plugin that is being unloaded) can be cancelled at any stage, see CancelRequests().
+*/
+
+
+
+
+
+#pragma once
+
+#include "OSSupport/IsThread.h"
+
+
+
+
+
+// fwd:
+class cBlockArea;
+class cWorld;
+
+
+
+
+
+/** The callback called in the tick thread when an asynchronous cBlockArea read or write finishes */
+class cBlockAreaCallback
+{
+public:
+	virtual ~cBlockAreaCallback() {}
+	
+	/** Called when the operation on a_Area has finished. a_IsSuccess is false if some of the chunks were not available.
+	The callback object is deleted right after this call. */
+	virtual void OnFinished(cBlockArea & a_Area, bool a_IsSuccess) = 0;
+	
+	/** Returns the object on whose behalf the operation runs, CancelRequests() cancels the operations by their owner.
+	NULL if the operation cannot be cancelled. */
+	virtual const void * GetOwner(void) const { return NULL; }
+} ;
+
+
+
+
+
+class cBlockAreaIOThread :
+	public cIsThread
+{
+	typedef cIsThread super;
+	
+public:
+	cBlockAreaIOThread(void);
+	~cBlockAreaIOThread();
+	
+	void Start(cWorld * a_World);
+	
+	/** Stops the thread and drops the requests that haven't been processed yet, their callbacks are deleted without being called */
+	void Stop(void);
+	
+	/** Queues a cBlockArea::Read() of the specified coords (all inclusive). Takes ownership of a_Callback, which may be NULL. */
+	void QueueRead(cBlockArea & a_Area, int a_MinBlockX, int a_MaxBlockX, int a_MinBlockY, int a_MaxBlockY, int a_MinBlockZ, int a_MaxBlockZ, int a_DataTypes, cBlockAreaCallback * a_Callback);
+	
+	/** Queues a cBlockArea::Write() to the specified coords. Takes ownership of a_Callback, which may be NULL. */
+	void QueueWrite(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes, cBlockAreaCallback * a_Callback);
+	
+	/** Returns the number of requests waiting to be processed */
+	size_t GetQueueLength(void);
+	
+	/** Drops all the requests whose callback's GetOwner() is a_Owner, both the queued and the finished ones, their
+	callbacks are deleted without being called. If a request of the owner is being processed, waits for it to finish.
+	A callback of the owner that is being called in the tick thread may still be running when this returns, use
+	WaitForCallbacks() before destroying the owner. */
+	void CancelRequests(const void * a_Owner);
+	
+	/** Waits until the callback that is currently being called in the tick thread, if any, returns */
+	void WaitForCallbacks(void);
+	
+protected:
+	class cFinishedTask;
+	
+	struct sRequest
+	{
+		cBlockArea * m_Area;
+		bool m_IsWrite;
+		int  m_MinBlockX, m_MaxBlockX;
+		int  m_MinBlockY, m_MaxBlockY;
+		int  m_MinBlockZ, m_MaxBlockZ;
+		int  m_DataTypes;
+		cBlockAreaCallback * m_Callback;
+	} ;
+	
+	typedef std::deque<sRequest> cRequests;
+	
+	/** A processed request waiting for its callback to be called in the tick thread */
+	struct sFinished
+	{
+		cBlockArea * m_Area;
+		bool m_IsSuccess;
+		cBlockAreaCallback * m_Callback;
+	} ;
+	
+	typedef std::deque<sFinished> cFinished;
+	
+	cWorld * m_World;
+	
+	/** Protects m_Requests and m_Finished */
+	cCriticalSection m_CS;
+	
+	/** Held by the thread while processing a request, so that CancelRequests() can wait for it */
+	cCriticalSection m_CSProcessing;
+	
+	/** Held by the tick thread while calling the callbacks, so that WaitForCallbacks() can wait for them */
+	cCriticalSection m_CSCallbacks;
+	
+	cRequests m_Requests;
+	
+	/** The processed requests whose callbacks haven't been called yet */
+	cFinished m_Finished;
+	
+	/** Set when a request is queued, or to stop the thread */
+	cEvent m_evtQueued;
+	
+	/** Queues the request and wakes up the thread */
+	void QueueRequest(const sRequest & a_Request);
+	
+	/** Calls the callbacks of all the finished requests and deletes them. Called in the tick thread by cFinishedTask. */
+	void CallFinishedCallbacks(void);
+	
+	// cIsThread override:
+	virtual void Execute(void) override;
+} ;
+
+
+
+
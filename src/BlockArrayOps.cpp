@@ -0,0 +1,305 @@
+
+// BlockArrayOps.cpp
+
+// Implements the cBlockArrayOps class with the bulk operations on the block data arrays
+
+#include "Globals.h"
+#include "BlockArrayOps.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define BLOCKARRAYOPS_USE_SSE2 1
+	#include <emmintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define SSE2_FUNCTION
+	#else
+		#include <cpuid.h>
+		// Allows using the intrinsics even if the whole program isn't compiled with SSE2 enabled (32-bit builds):
+		#define SSE2_FUNCTION __attribute__((target("sse2")))
+	#endif
+#else
+	#define BLOCKARRAYOPS_USE_SSE2 0
+#endif
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar implementations:
+
+static void ScalarMergeFillAir(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
+{
+	for (int i = 0; i < a_Count; i++)
+	{
+		if (a_DstTypes[i] == E_BLOCK_AIR)
+		{
+			a_DstTypes[i] = a_SrcTypes[i];
+			a_DstMetas[i] = a_SrcMetas[i];
+		}
+	}
+}
+
+
+
+
+
+static void ScalarMergeImprint(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
+{
+	for (int i = 0; i < a_Count; i++)
+	{
+		if (a_SrcTypes[i] != E_BLOCK_AIR)
+		{
+			a_DstTypes[i] = a_SrcTypes[i];
+			a_DstMetas[i] = a_SrcMetas[i];
+		}
+	}
+}
+
+
+
+
+
+static void ScalarPackNibbles(const NIBBLETYPE * a_Src, NIBBLETYPE * a_Dst, int a_Count)
+{
+	for (int i = 0; i < a_Count / 2; i++)
+	{
+		a_Dst[i] = (a_Src[2 * i] & 0x0f) | ((a_Src[2 * i + 1] & 0x0f) << 4);
+	}
+}
+
+
+
+
+
+static void ScalarUnpackNibbles(const NIBBLETYPE * a_Src, NIBBLETYPE * a_Dst, int a_Count)
+{
+	for (int i = 0; i < a_Count / 2; i++)
+	{
+		a_Dst[2 * i]     = a_Src[i] & 0x0f;
+		a_Dst[2 * i + 1] = a_Src[i] >> 4;
+	}
+}
+
+
+
+
+
+#if BLOCKARRAYOPS_USE_SSE2
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SSE2 implementations, 16 blocks at a time, the rest is left to the scalar ones:
+
+/** Returns true if the CPU reports SSE2 support */
+static bool HasCpuSse2(void)
+{
+	#ifdef _MSC_VER
+		int Info[4];
+		__cpuid(Info, 1);
+		return ((Info[3] & (1 << 26)) != 0);
+	#else
+		unsigned int Eax, Ebx, Ecx, Edx;
+		if (__get_cpuid(1, &Eax, &Ebx, &Ecx, &Edx) == 0)
+		{
+			return false;
+		}
+		return ((Edx & (1 << 26)) != 0);
+	#endif
+}
+
+
+
+
+
+SSE2_FUNCTION static void Sse2MergeFillAir(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
+{
+	const __m128i Air = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 16 <= a_Count; i += 16)
+	{
+		__m128i DstTypes = _mm_loadu_si128((const __m128i *)(a_DstTypes + i));
+		__m128i SrcTypes = _mm_loadu_si128((const __m128i *)(a_SrcTypes + i));
+		__m128i DstMetas = _mm_loadu_si128((const __m128i *)(a_DstMetas + i));
+		__m128i SrcMetas = _mm_loadu_si128((const __m128i *)(a_SrcMetas + i));
+		__m128i TakeSrc = _mm_cmpeq_epi8(DstTypes, Air);
+		_mm_storeu_si128((__m128i *)(a_DstTypes + i), _mm_or_si128(_mm_and_si128(TakeSrc, SrcTypes), _mm_andnot_si128(TakeSrc, DstTypes)));
+		_mm_storeu_si128((__m128i *)(a_DstMetas + i), _mm_or_si128(_mm_and_si128(TakeSrc, SrcMetas), _mm_andnot_si128(TakeSrc, DstMetas)));
+	}
+	ScalarMergeFillAir(a_DstTypes + i, a_SrcTypes + i, a_DstMetas + i, a_SrcMetas + i, a_Count - i);
+}
+
+
+
+
+
+SSE2_FUNCTION static void Sse2MergeImprint(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
+{
+	const __m128i Air = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 16 <= a_Count; i += 16)
+	{
+		__m128i DstTypes = _mm_loadu_si128((const __m128i *)(a_DstTypes + i));
+		__m128i SrcTypes = _mm_loadu_si128((const __m128i *)(a_SrcTypes + i));
+		__m128i DstMetas = _mm_loadu_si128((const __m128i *)(a_DstMetas + i));
+		__m128i SrcMetas = _mm_loadu_si128((const __m128i *)(a_SrcMetas + i));
+		__m128i KeepDst = _mm_cmpeq_epi8(SrcTypes, Air);
+		_mm_storeu_si128((__m128i *)(a_DstTypes + i), _mm_or_si128(_mm_and_si128(KeepDst, DstTypes), _mm_andnot_si128(KeepDst, SrcTypes)));
+		_mm_storeu_si128((__m128i *)(a_DstMetas + i), _mm_or_si128(_mm_and_si128(KeepDst, DstMetas), _mm_andnot_si128(KeepDst, SrcMetas)));
+	}
+	ScalarMergeImprint(a_DstTypes + i, a_SrcTypes + i, a_DstMetas + i, a_SrcMetas + i, a_Count - i);
+}
+
+
+
+
+
+SSE2_FUNCTION static void Sse2PackNibbles(const NIBBLETYPE * a_Src, NIBBLETYPE * a_Dst, int a_Count)
+{
+	const __m128i LowNibbles = _mm_set1_epi8(0x0f);
+	const __m128i LowBytes = _mm_set1_epi16(0x00ff);
+	int i = 0;
+	for (; i + 32 <= a_Count; i += 32)
+	{
+		// Each 16-bit lane holds two nibbles, n0 | (n1 << 8); shifting by 4 and or-ing puts n0 | (n1 << 4) into the low byte:
+		__m128i Src1 = _mm_and_si128(_mm_loadu_si128((const __m128i *)(a_Src + i)),      LowNibbles);
+		__m128i Src2 = _mm_and_si128(_mm_loadu_si128((const __m128i *)(a_Src + i + 16)), LowNibbles);
+		Src1 = _mm_and_si128(_mm_or_si128(Src1, _mm_srli_epi16(Src1, 4)), LowBytes);
+		Src2 = _mm_and_si128(_mm_or_si128(Src2, _mm_srli_epi16(Src2, 4)), LowBytes);
+		_mm_storeu_si128((__m128i *)(a_Dst + i / 2), _mm_packus_epi16(Src1, Src2));
+	}
+	ScalarPackNibbles(a_Src + i, a_Dst + i / 2, a_Count - i);
+}
+
+
+
+
+
+SSE2_FUNCTION static void Sse2UnpackNibbles(const NIBBLETYPE * a_Src, NIBBLETYPE * a_Dst, int a_Count)
+{
+	const __m128i LowNibbles = _mm_set1_epi8(0x0f);
+	int i = 0;
+	for (; i + 32 <= a_Count; i += 32)
+	{
+		__m128i Src = _mm_loadu_si128((const __m128i *)(a_Src + i / 2));
+		__m128i Low  = _mm_and_si128(Src, LowNibbles);
+		__m128i High = _mm_and_si128(_mm_srli_epi16(Src, 4), LowNibbles);
+		_mm_storeu_si128((__m128i *)(a_Dst + i),      _mm_unpacklo_epi8(Low, High));
+		_mm_storeu_si128((__m128i *)(a_Dst + i + 16), _mm_unpackhi_epi8(Low, High));
+	}
+	ScalarUnpackNibbles(a_Src + i / 2, a_Dst + i, a_Count - i);
+}
+
+#endif  // BLOCKARRAYOPS_USE_SSE2
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cBlockArrayOps:
+
+#if BLOCKARRAYOPS_USE_SSE2
+	static const bool g_IsSimdSupported = HasCpuSse2();
+#else
+	static const bool g_IsSimdSupported = false;
+#endif
+
+/** Set to false by the benchmarks to measure the scalar implementations */
+static bool g_IsSimdEnabled = g_IsSimdSupported;
+
+
+
+
+
+bool cBlockArrayOps::IsSimdSupported(void)
+{
+	return g_IsSimdSupported;
+}
+
+
+
+
+
+bool cBlockArrayOps::IsSimdEnabled(void)
+{
+	return g_IsSimdEnabled;
+}
+
+
+
+
+
+void cBlockArrayOps::SetSimdEnabled(bool a_Enabled)
+{
+	g_IsSimdEnabled = a_Enabled && g_IsSimdSupported;
+}
+
+
+
+
+
+void cBlockArrayOps::MergeFillAir(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
+{
+	#if BLOCKARRAYOPS_USE_SSE2
+		if (g_IsSimdEnabled)
+		{
+			Sse2MergeFillAir(a_DstTypes, a_SrcTypes, a_DstMetas, a_SrcMetas, a_Count);
+			return;
+		}
+	#endif
+	ScalarMergeFillAir(a_DstTypes, a_SrcTypes, a_DstMetas, a_SrcMetas, a_Count);
+}
+
+
+
+
+
+void cBlockArrayOps::MergeImprint(BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes, NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas, int a_Count)
+{
+	#if BLOCKARRAYOPS_USE_SSE2
+		if (g_IsSimdEnabled)
+		{
+			Sse2MergeImprint(a_DstTypes, a_SrcTypes, a_DstMetas, a_SrcMetas, a_Count);
+			return;
+		}
+	#endif
+	ScalarMergeImprint(a_DstTypes, a_SrcTypes, a_DstMetas, a_SrcMetas, a_Count);
+}
+
+
+
+
+
+void cBlockArrayOps::PackNibbles(const NIBBLETYPE * a_Src, NIBBLETYPE * a_Dst, int a_Count)
+{
+	ASSERT((a_Count % 2) == 0);
+	#if BLOCKARRAYOPS_USE_SSE2
+		if (g_IsSimdEnabled)
+		{
+			Sse2PackNibbles(a_Src, a_Dst, a_Count);
+			return;
+		}
+	#endif
+	ScalarPackNibbles(a_Src, a_Dst, a_Count);
+}
+
+
+
+
+
+void cBlockArrayOps::UnpackNibbles(const NIBBLETYPE * a_Src, NIBBLETYPE * a_Dst, int a_Count)
+{
+	ASSERT((a_Count % 2) == 0);
+	#if BLOCKARRAYOPS_USE_SSE2
+		if (g_IsSimdEnabled)
+		{
+			Sse2UnpackNibbles(a_Src, a_Dst, a_Count);
+			return;
+		}
+	#endif
+	ScalarUnpackNibbles(a_Src, a_Dst, a_Count);
+}
+
+
+
+
@@ -0,0 +1,62 @@
+
+// BlockArrayOps.h
+
+// Declares the cBlockArrayOps class with the bulk operations on the block data arrays used by cBlockArea and the generator
+
+/*
+The operations have a scalar implementation and, on x86 / x64 CPUs, an SSE2 one that processes 16 blocks at a time.
+The implementation is chosen at runtime: the SSE2 one is used only if the CPU reports SSE2 support through CPUID,
+so that the 32-bit builds, which aren't compiled with SSE2 enabled, still run on any CPU. The benchmarks can switch
+the vectorized implementation off to compare the two.
+*/
+
+
+
+
+
+#pragma once
+
+#include "ChunkDef.h"
+
+
+
+
+
+class cBlockArrayOps
+{
+public:
+	/** Returns true if the CPU supports the vectorized implementations */
+	static bool IsSimdSupported(void);
+
+	/** Returns true if the vectorized implementations are currently used */
+	static bool IsSimdEnabled(void);
+
+	/** Enables or disables the vectorized implementations; enabling has no effect if the CPU doesn't support them.
+	Meant for comparing the implementations, not thread-safe. */
+	static void SetSimdEnabled(bool a_Enabled);
+
+	/** Copies the source type and meta of each of the a_Count blocks whose destination type is air (cBlockArea::msFillAir) */
+	static void MergeFillAir(
+		BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes,
+		NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas,
+		int a_Count
+	);
+
+	/** Copies the source type and meta of each of the a_Count blocks whose source type is not air (cBlockArea::msImprint) */
+	static void MergeImprint(
+		BLOCKTYPE * a_DstTypes, const BLOCKTYPE * a_SrcTypes,
+		NIBBLETYPE * a_DstMetas, const NIBBLETYPE * a_SrcMetas,
+		int a_Count
+	);
+
+	/** Packs a_Count nibbles stored one per byte in a_Src into a_Dst, two per byte, lower nibble first (the chunk format).
+	a_Count must be even. a_Dst may be the same buffer as a_Src. */
+	static void PackNibbles(const NIBBLETYPE * a_Src, NIBBLETYPE * a_Dst, int a_Count);
+
+	/** Unpacks a_Count nibbles stored two per byte in a_Src into a_Dst, one per byte. a_Count must be even. */
+	static void UnpackNibbles(const NIBBLETYPE * a_Src, NIBBLETYPE * a_Dst, int a_Count);
+} ;
+
+
+
+
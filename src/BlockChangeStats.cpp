@@ -0,0 +1,87 @@
+
+// BlockChangeStats.cpp
+
+// Implements the cBlockChangeStats class that counts the block changes sent to the clients
+
+#include "Globals.h"
+#include "BlockChangeStats.h"
+#include "CommandOutput.h"
+
+
+
+
+
+/** The approximate sizes of the packets, in bytes, for estimating the savings */
+#define SINGLE_BLOCK_PACKET_SIZE 13
+#define MULTI_BLOCK_PACKET_SIZE  16
+#define MULTI_BLOCK_RECORD_SIZE  4
+
+
+
+
+
+cBlockChangeStats::cBlockChangeStats(void) :
+	m_NumChanges(0),
+	m_NumCollapsed(0),
+	m_NumSinglePackets(0),
+	m_NumMultiPackets(0),
+	m_NumChunkResends(0),
+	m_NumPacketsSaved(0),
+	m_NumBytesSaved(0)
+{
+}
+
+
+
+
+
+void cBlockChangeStats::AddPackets(int a_NumChanges, int a_NumSent, int a_NumClients)
+{
+	m_NumChanges += a_NumChanges;
+	m_NumCollapsed += a_NumChanges - a_NumSent;
+	int NumBytes;
+	if (a_NumSent == 1)
+	{
+		m_NumSinglePackets += a_NumClients;
+		NumBytes = SINGLE_BLOCK_PACKET_SIZE;
+	}
+	else
+	{
+		m_NumMultiPackets += a_NumClients;
+		NumBytes = MULTI_BLOCK_PACKET_SIZE + a_NumSent * MULTI_BLOCK_RECORD_SIZE;
+	}
+	m_NumPacketsSaved += (Int64)(a_NumChanges - 1) * a_NumClients;
+	m_NumBytesSaved += (Int64)(a_NumChanges * SINGLE_BLOCK_PACKET_SIZE - NumBytes) * a_NumClients;
+}
+
+
+
+
+
+void cBlockChangeStats::AddChunkResend(int a_NumChanges, int a_NumClients)
+{
+	m_NumChanges += a_NumChanges;
+	m_NumChunkResends += a_NumClients;
+	m_NumPacketsSaved += (Int64)(a_NumChanges - 1) * a_NumClients;
+}
+
+
+
+
+
+void cBlockChangeStats::LogStats(cCommandOutputCallback & a_Output)
+{
+	a_Output.Out("  Block changes: %lld changes, %lld collapsed into a later change of the same block",
+		m_NumChanges, m_NumCollapsed
+	);
+	a_Output.Out("    sent in %lld single-block packets, %lld multi-block packets and %lld chunk resends",
+		m_NumSinglePackets, m_NumMultiPackets, m_NumChunkResends
+	);
+	a_Output.Out("    saved %lld packets and about %lld KiB, compared to a packet per change (bytes without the chunk resends)",
+		m_NumPacketsSaved, m_NumBytesSaved / 1024
+	);
+}
+
+
+
+
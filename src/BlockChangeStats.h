@@ -0,0 +1,58 @@
+
+// BlockChangeStats.h
+
+// Declares the cBlockChangeStats class that counts the block changes sent to the clients
+
+/*
+Each tick, each chunk sends the blocks changed in it to its clients. The repeated changes to the same block are
+collapsed into the last one, then the chunk sends a single-block packet, a multi-block packet or, if there are too
+many changes, the whole chunk again. This class counts what has been sent and estimates what it saved, compared
+to sending each change as a separate single-block packet.
+*/
+
+
+
+
+
+#pragma once
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+
+
+
+
+
+class cBlockChangeStats
+{
+public:
+	cBlockChangeStats(void);
+
+	/** Called when a chunk has sent a_NumSent changes, collapsed from a_NumChanges, to a_NumClients clients,
+	as a single-block packet (a_NumSent == 1) or as a multi-block packet */
+	void AddPackets(int a_NumChanges, int a_NumSent, int a_NumClients);
+
+	/** Called when a chunk has sent itself whole to a_NumClients clients, instead of a_NumChanges changes */
+	void AddChunkResend(int a_NumChanges, int a_NumClients);
+
+	/** Outputs the statistics */
+	void LogStats(cCommandOutputCallback & a_Output);
+
+protected:
+	// Statistics; updated only from the tick thread:
+	Int64 m_NumChanges;          ///< Changes made, including the collapsed ones
+	Int64 m_NumCollapsed;        ///< Changes collapsed into a later change of the same block
+	Int64 m_NumSinglePackets;    ///< Single-block packets sent, counted per client
+	Int64 m_NumMultiPackets;     ///< Multi-block packets sent, counted per client
+	Int64 m_NumChunkResends;     ///< Chunks sent whole instead of the changes, counted per client
+	Int64 m_NumPacketsSaved;     ///< Packets not sent, compared to a single-block packet per change
+	Int64 m_NumBytesSaved;       ///< Estimated bytes not sent, compared to a single-block packet per change; without the chunk resends
+} ;
+
+
+
+
@@ -46,3 +46,44 @@ cBlockEntity * cBlockEntity::CreateByBlockType(BLOCKTYPE a_BlockType, NIBBLETYPE
 
 
 
+
+bool cBlockEntity::IsBlockEntityBlockType(BLOCKTYPE a_BlockType)
+{
+	switch (a_BlockType)
+	{
+		case E_BLOCK_CHEST:
+		case E_BLOCK_COMMAND_BLOCK:
+		case E_BLOCK_DISPENSER:
+		case E_BLOCK_DROPPER:
+		case E_BLOCK_ENDER_CHEST:
+		case E_BLOCK_LIT_FURNACE:
+		case E_BLOCK_FURNACE:
+		case E_BLOCK_HOPPER:
+		case E_BLOCK_SIGN_POST:
+		case E_BLOCK_WALLSIGN:
+		case E_BLOCK_NOTE_BLOCK:
+		case E_BLOCK_JUKEBOX:
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+
+void cBlockEntity::WakeUp(void)
+{
+	if (m_World == NULL)
+	{
+		// Not in any chunk yet; entities start awake
+		return;
+	}
+	m_World->WakeUpBlockEntity(*this);
+}
+
+
+
+
@@ -31,7 +31,8 @@ protected:
 		m_RelX(a_BlockX - cChunkDef::Width * FAST_FLOOR_DIV(a_BlockX, cChunkDef::Width)),
 		m_RelZ(a_BlockZ - cChunkDef::Width * FAST_FLOOR_DIV(a_BlockZ, cChunkDef::Width)),
 		m_BlockType(a_BlockType),
-		m_World(a_World)
+		m_World(a_World),
+		m_NextTick(0)
 	{
 	}
 
@@ -52,6 +53,9 @@ public:
 	/// Returns NULL for unknown block types
 	static cBlockEntity * CreateByBlockType(BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta, int a_BlockX, int a_BlockY, int a_BlockZ, cWorld * a_World = NULL);
 	
+	/** Returns true if the specified block type has a block entity, i.e. CreateByBlockType() creates one for it */
+	static bool IsBlockEntityBlockType(BLOCKTYPE a_BlockType);
+	
 	static const char * GetClassStatic(void)  // Needed for ManualBindings's ForEach templates
 	{
 		return "cBlockEntity";
@@ -86,12 +90,25 @@ public:
 	*/
 	virtual void SendTo(cClientHandle & a_Client) = 0;
 	
-	/// Ticks the entity; returns true if the chunk should be marked as dirty as a result of this ticking. By default does nothing.
+	/** Ticks the entity; returns true if the chunk should be marked as dirty as a result of this ticking.
+	The entity is ticked each tick until it calls SleepUntil() or Sleep() from within this function.
+	By default does nothing and sleeps until woken up. */
 	virtual bool Tick(float a_Dt, cChunk & /* a_Chunk */)
 	{
 		UNUSED(a_Dt);
+		Sleep();
 		return false;
 	}
+	
+	/** Returns the world age at which the entity wants to be ticked next; 0 if in each tick, -1 if sleeping until woken up */
+	Int64 GetNextTick(void) const { return m_NextTick; }
+	
+	/** Returns true if the entity is sleeping until an event wakes it up, and so isn't in its chunk's tick list */
+	bool IsSleeping(void) const { return (m_NextTick < 0); }
+	
+	/** Makes the entity tick again in the next world tick. Called on the events that the entity may be waiting for,
+	such as a change in its or its neighbors' contents or a neighbor block change. Locks the chunkmap. */
+	void WakeUp(void);
 
 protected:
 	/// Position in absolute block coordinates
@@ -103,6 +120,18 @@ protected:
 	BLOCKTYPE m_BlockType;
 	
 	cWorld * m_World;
+	
+	/** The world age at which the entity wants to be ticked next; 0 if in each tick, -1 if sleeping until woken up. Modified only with the chunkmap locked */
+	Int64 m_NextTick;
+	
+	/** The chunk resets m_NextTick when waking the entity up */
+	friend class cChunk;
+	
+	/** Skips ticking the entity until the specified world age. To be called only from within Tick() */
+	void SleepUntil(Int64 a_WorldAge) { m_NextTick = a_WorldAge; }
+	
+	/** Removes the entity from its chunk's tick list until WakeUp() is called. To be called only from within Tick() */
+	void Sleep(void) { m_NextTick = -1; }
 } ;  // tolua_export
 
 
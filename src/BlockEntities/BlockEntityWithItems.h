@@ -81,10 +81,14 @@ protected:
 		{
 			if (GetWindow() != NULL)
 			{
-				GetWindow()->BroadcastWholeWindow();
+				GetWindow()->BroadcastChangedSlots();
 			}
 
 			m_World->MarkChunkDirty(GetChunkX(), GetChunkZ());
+			
+			// This entity may have items to process, the neighbors (hoppers) may have items to take or room to put them to:
+			WakeUp();
+			m_World->WakeUpBlockEntityNeighbors(m_PosX, m_PosY, m_PosZ);
 		}
 	}
 } ;  // tolua_export
@@ -170,3 +170,39 @@ void cChestEntity::OpenNewWindow(void)
 
 
 
+
+void cChestEntity::OnSlotChanged(cItemGrid * a_Grid, int a_SlotNum)
+{
+	super::OnSlotChanged(a_Grid, a_SlotNum);
+	
+	if (m_World == NULL)
+	{
+		return;
+	}
+	
+	// The hoppers next to the other half of a double-chest take from this half, too:
+	static const struct
+	{
+		int x, z;
+	}
+	Coords[] =
+	{
+		{ 1,  0},
+		{-1,  0},
+		{ 0,  1},
+		{ 0, -1},
+	} ;
+	for (size_t i = 0; i < ARRAYCOUNT(Coords); i++)
+	{
+		int x = m_PosX + Coords[i].x;
+		int z = m_PosZ + Coords[i].z;
+		if (m_World->GetBlock(x, m_PosY, z) == E_BLOCK_CHEST)
+		{
+			m_World->WakeUpBlockEntityNeighbors(x, m_PosY, z);
+		}
+	}
+}
+
+
+
+
@@ -105,6 +105,7 @@ NIBBLETYPE cCommandBlockEntity::GetResult(void) const
 void cCommandBlockEntity::Activate(void)
 {
 	m_ShouldExecute = true;
+	WakeUp();
 }
 
 
@@ -128,6 +129,8 @@ bool cCommandBlockEntity::Tick(float a_Dt, cChunk & a_Chunk)
 {
 	if (!m_ShouldExecute)
 	{
+		// Nothing to do until activated
+		Sleep();
 		return false;
 	}
 	
@@ -108,6 +108,7 @@ void cDropSpenserEntity::DropSpense(cChunk & a_Chunk)
 void cDropSpenserEntity::Activate(void)
 {
 	m_ShouldDropSpense = true;
+	WakeUp();
 }
 
 
@@ -131,6 +132,8 @@ bool cDropSpenserEntity::Tick(float a_Dt, cChunk & a_Chunk)
 {
 	if (!m_ShouldDropSpense)
 	{
+		// Nothing to do until activated
+		Sleep();
 		return false;
 	}
 	
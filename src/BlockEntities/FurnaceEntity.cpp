@@ -101,6 +101,9 @@ bool cFurnaceEntity::Tick(float a_Dt, cChunk & a_Chunk)
 		{
 			UpdateProgressBars();
 		}
+		
+		// Only a change in the slots can start burning new fuel, sleep until then:
+		Sleep();
 		return false;
 	}
 
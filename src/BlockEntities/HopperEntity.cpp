@@ -64,7 +64,29 @@ bool cHopperEntity::Tick(float a_Dt, cChunk & a_Chunk)
 	res = MoveItemsIn  (a_Chunk, CurrentTick) || res;
 	res = MovePickupsIn(a_Chunk, CurrentTick) || res;
 	res = MoveItemsOut (a_Chunk, CurrentTick) || res;
-	return res;
+	if (res)
+	{
+		// Keep moving while there are items to move
+		return true;
+	}
+	
+	// Nothing moved. If waiting for the transfer delay, retry once it's over; otherwise sleep until the contents
+	// of this hopper or of the neighbors change, a neighbor is placed, or a pickup lands on the hopper:
+	Int64 NextInTick  = m_LastMoveItemsInTick  + TICKS_PER_TRANSFER;
+	Int64 NextOutTick = m_LastMoveItemsOutTick + TICKS_PER_TRANSFER;
+	if ((NextInTick > CurrentTick) && ((NextOutTick <= CurrentTick) || (NextInTick < NextOutTick)))
+	{
+		SleepUntil(NextInTick);
+	}
+	else if (NextOutTick > CurrentTick)
+	{
+		SleepUntil(NextOutTick);
+	}
+	else
+	{
+		Sleep();
+	}
+	return false;
 }
 
 
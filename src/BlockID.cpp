@@ -21,6 +21,7 @@ bool       g_BlockIsSnowable[256];
 bool       g_BlockRequiresSpecialTool[256];
 bool       g_BlockIsSolid[256];
 bool       g_BlockFullyOccupiesVoxel[256];
+float      g_BlockBlastResistance[256];
 
 
 
@@ -856,6 +857,147 @@ public:
 		g_BlockFullyOccupiesVoxel[E_BLOCK_WOOL]                  = true;
 		g_BlockFullyOccupiesVoxel[E_BLOCK_STONE]                 = true;
 		g_BlockFullyOccupiesVoxel[E_BLOCK_STONE_BRICKS]          = true;
+
+		// Blast resistance, the vanilla values; the blocks not listed get 0 if not solid and 15 (wood) if solid:
+		for (size_t i = 0; i < ARRAYCOUNT(g_BlockBlastResistance); i++)
+		{
+			g_BlockBlastResistance[i] = g_BlockIsSolid[i] ? 15.0f : 0.0f;
+		}
+		g_BlockBlastResistance[E_BLOCK_STONE]                 = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_GRASS]                 = 3.0f;
+		g_BlockBlastResistance[E_BLOCK_DIRT]                  = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_COBBLESTONE]           = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_PLANKS]                = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_BEDROCK]               = 18000000.0f;
+		g_BlockBlastResistance[E_BLOCK_WATER]                 = 500.0f;
+		g_BlockBlastResistance[E_BLOCK_STATIONARY_WATER]      = 500.0f;
+		g_BlockBlastResistance[E_BLOCK_LAVA]                  = 500.0f;
+		g_BlockBlastResistance[E_BLOCK_STATIONARY_LAVA]       = 500.0f;
+		g_BlockBlastResistance[E_BLOCK_SAND]                  = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_GRAVEL]                = 3.0f;
+		g_BlockBlastResistance[E_BLOCK_GOLD_ORE]              = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_IRON_ORE]              = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_COAL_ORE]              = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_LOG]                   = 10.0f;
+		g_BlockBlastResistance[E_BLOCK_LEAVES]                = 1.0f;
+		g_BlockBlastResistance[E_BLOCK_SPONGE]                = 3.0f;
+		g_BlockBlastResistance[E_BLOCK_GLASS]                 = 1.5f;
+		g_BlockBlastResistance[E_BLOCK_LAPIS_ORE]             = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_LAPIS_BLOCK]           = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_DISPENSER]             = 17.5f;
+		g_BlockBlastResistance[E_BLOCK_SANDSTONE]             = 4.0f;
+		g_BlockBlastResistance[E_BLOCK_NOTE_BLOCK]            = 4.0f;
+		g_BlockBlastResistance[E_BLOCK_BED]                   = 1.0f;
+		g_BlockBlastResistance[E_BLOCK_POWERED_RAIL]          = 3.5f;
+		g_BlockBlastResistance[E_BLOCK_DETECTOR_RAIL]         = 3.5f;
+		g_BlockBlastResistance[E_BLOCK_STICKY_PISTON]         = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_COBWEB]                = 20.0f;
+		g_BlockBlastResistance[E_BLOCK_PISTON]                = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_PISTON_EXTENSION]      = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_WOOL]                  = 4.0f;
+		g_BlockBlastResistance[E_BLOCK_GOLD_BLOCK]            = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_IRON_BLOCK]            = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_DOUBLE_STONE_SLAB]     = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_STONE_SLAB]            = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_BRICK]                 = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_TNT]                   = 0.0f;
+		g_BlockBlastResistance[E_BLOCK_BOOKCASE]              = 7.5f;
+		g_BlockBlastResistance[E_BLOCK_MOSSY_COBBLESTONE]     = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_OBSIDIAN]              = 6000.0f;
+		g_BlockBlastResistance[E_BLOCK_MOB_SPAWNER]           = 25.0f;
+		g_BlockBlastResistance[E_BLOCK_WOODEN_STAIRS]         = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_CHEST]                 = 12.5f;
+		g_BlockBlastResistance[E_BLOCK_DIAMOND_ORE]           = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_DIAMOND_BLOCK]         = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_CRAFTING_TABLE]        = 12.5f;
+		g_BlockBlastResistance[E_BLOCK_FARMLAND]              = 3.0f;
+		g_BlockBlastResistance[E_BLOCK_FURNACE]               = 17.5f;
+		g_BlockBlastResistance[E_BLOCK_LIT_FURNACE]           = 17.5f;
+		g_BlockBlastResistance[E_BLOCK_SIGN_POST]             = 5.0f;
+		g_BlockBlastResistance[E_BLOCK_WOODEN_DOOR]           = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_LADDER]                = 2.0f;
+		g_BlockBlastResistance[E_BLOCK_RAIL]                  = 3.5f;
+		g_BlockBlastResistance[E_BLOCK_COBBLESTONE_STAIRS]    = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_WALLSIGN]              = 5.0f;
+		g_BlockBlastResistance[E_BLOCK_LEVER]                 = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_STONE_PRESSURE_PLATE]  = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_IRON_DOOR]             = 25.0f;
+		g_BlockBlastResistance[E_BLOCK_WOODEN_PRESSURE_PLATE] = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_REDSTONE_ORE]          = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_REDSTONE_ORE_GLOWING]  = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_STONE_BUTTON]          = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_SNOW]                  = 0.5f;
+		g_BlockBlastResistance[E_BLOCK_ICE]                   = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_SNOW_BLOCK]            = 1.0f;
+		g_BlockBlastResistance[E_BLOCK_CACTUS]                = 2.0f;
+		g_BlockBlastResistance[E_BLOCK_CLAY]                  = 3.0f;
+		g_BlockBlastResistance[E_BLOCK_JUKEBOX]               = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_FENCE]                 = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_PUMPKIN]               = 5.0f;
+		g_BlockBlastResistance[E_BLOCK_NETHERRACK]            = 2.0f;
+		g_BlockBlastResistance[E_BLOCK_SOULSAND]              = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_GLOWSTONE]             = 1.5f;
+		g_BlockBlastResistance[E_BLOCK_JACK_O_LANTERN]        = 5.0f;
+		g_BlockBlastResistance[E_BLOCK_CAKE]                  = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_STAINED_GLASS]         = 1.5f;
+		g_BlockBlastResistance[E_BLOCK_TRAPDOOR]              = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_SILVERFISH_EGG]        = 3.75f;
+		g_BlockBlastResistance[E_BLOCK_STONE_BRICKS]          = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_HUGE_BROWN_MUSHROOM]   = 1.0f;
+		g_BlockBlastResistance[E_BLOCK_HUGE_RED_MUSHROOM]     = 1.0f;
+		g_BlockBlastResistance[E_BLOCK_IRON_BARS]             = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_GLASS_PANE]            = 1.5f;
+		g_BlockBlastResistance[E_BLOCK_MELON]                 = 5.0f;
+		g_BlockBlastResistance[E_BLOCK_VINES]                 = 1.0f;
+		g_BlockBlastResistance[E_BLOCK_FENCE_GATE]            = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_BRICK_STAIRS]          = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_STONE_BRICK_STAIRS]    = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_MYCELIUM]              = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_NETHER_BRICK]          = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_NETHER_BRICK_FENCE]    = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_NETHER_BRICK_STAIRS]   = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_ENCHANTMENT_TABLE]     = 6000.0f;
+		g_BlockBlastResistance[E_BLOCK_BREWING_STAND]         = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_CAULDRON]              = 10.0f;
+		g_BlockBlastResistance[E_BLOCK_END_PORTAL]            = 18000000.0f;
+		g_BlockBlastResistance[E_BLOCK_END_PORTAL_FRAME]      = 18000000.0f;
+		g_BlockBlastResistance[E_BLOCK_END_STONE]             = 45.0f;
+		g_BlockBlastResistance[E_BLOCK_DRAGON_EGG]            = 45.0f;
+		g_BlockBlastResistance[E_BLOCK_REDSTONE_LAMP_OFF]     = 1.5f;
+		g_BlockBlastResistance[E_BLOCK_REDSTONE_LAMP_ON]      = 1.5f;
+		g_BlockBlastResistance[E_BLOCK_DOUBLE_WOODEN_SLAB]    = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_WOODEN_SLAB]           = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_COCOA_POD]             = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_SANDSTONE_STAIRS]      = 4.0f;
+		g_BlockBlastResistance[E_BLOCK_EMERALD_ORE]           = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_ENDER_CHEST]           = 3000.0f;
+		g_BlockBlastResistance[E_BLOCK_EMERALD_BLOCK]         = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_SPRUCE_WOOD_STAIRS]    = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_BIRCH_WOOD_STAIRS]     = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_JUNGLE_WOOD_STAIRS]    = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_COMMAND_BLOCK]         = 18000000.0f;
+		g_BlockBlastResistance[E_BLOCK_BEACON]                = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_COBBLESTONE_WALL]      = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_ANVIL]                 = 6000.0f;
+		g_BlockBlastResistance[E_BLOCK_TRAPPED_CHEST]         = 12.5f;
+		g_BlockBlastResistance[E_BLOCK_DAYLIGHT_SENSOR]       = 1.0f;
+		g_BlockBlastResistance[E_BLOCK_BLOCK_OF_REDSTONE]     = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_NETHER_QUARTZ_ORE]     = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_HOPPER]                = 24.0f;
+		g_BlockBlastResistance[E_BLOCK_QUARTZ_BLOCK]          = 4.0f;
+		g_BlockBlastResistance[E_BLOCK_QUARTZ_STAIRS]         = 4.0f;
+		g_BlockBlastResistance[E_BLOCK_ACTIVATOR_RAIL]        = 3.5f;
+		g_BlockBlastResistance[E_BLOCK_DROPPER]               = 17.5f;
+		g_BlockBlastResistance[E_BLOCK_STAINED_CLAY]          = 21.0f;
+		g_BlockBlastResistance[E_BLOCK_NEW_LEAVES]            = 1.0f;
+		g_BlockBlastResistance[E_BLOCK_NEW_LOG]               = 10.0f;
+		g_BlockBlastResistance[E_BLOCK_ACACIA_WOOD_STAIRS]    = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_DARK_OAK_WOOD_STAIRS]  = 15.0f;
+		g_BlockBlastResistance[E_BLOCK_HAY_BALE]              = 2.5f;
+		g_BlockBlastResistance[E_BLOCK_CARPET]                = 0.5f;
+		g_BlockBlastResistance[E_BLOCK_HARDENED_CLAY]         = 21.0f;
+		g_BlockBlastResistance[E_BLOCK_BLOCK_OF_COAL]         = 30.0f;
+		g_BlockBlastResistance[E_BLOCK_PACKED_ICE]            = 2.5f;
 	}
 } BlockPropertiesInitializer;
 
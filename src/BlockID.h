@@ -913,6 +913,7 @@ extern bool       g_BlockIsSnowable[256];
 extern bool       g_BlockRequiresSpecialTool[256];
 extern bool       g_BlockIsSolid[256];
 extern bool       g_BlockFullyOccupiesVoxel[256];
+extern float      g_BlockBlastResistance[256];  ///< How much the block weakens an explosion passing through it
 
 
 
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "BlockHandler.h"
+#include "../Simulator/FluidSimulator.h"
 
 
 
@@ -34,16 +35,23 @@ public:
 	
 	virtual void Check(cChunkInterface & a_ChunkInterface, cBlockPluginInterface & a_PluginInterface, int a_RelX, int a_RelY, int a_RelZ, cChunk & a_Chunk) override
 	{
+		// Wake the stationary fluid up, unless the simulator says it cannot change (lakes and oceans stay asleep):
 		switch (m_BlockType)
 		{
 			case E_BLOCK_STATIONARY_LAVA:
 			{
-				a_Chunk.FastSetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_LAVA, a_Chunk.GetMeta(a_RelX, a_RelY, a_RelZ));
+				if (a_Chunk.GetWorld()->GetLavaSimulator()->ShouldWakeUpStationary(&a_Chunk, a_RelX, a_RelY, a_RelZ))
+				{
+					a_Chunk.FastSetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_LAVA, a_Chunk.GetMeta(a_RelX, a_RelY, a_RelZ));
+				}
 				break;
 			}
 			case E_BLOCK_STATIONARY_WATER:
 			{
-				a_Chunk.FastSetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_WATER, a_Chunk.GetMeta(a_RelX, a_RelY, a_RelZ));
+				if (a_Chunk.GetWorld()->GetWaterSimulator()->ShouldWakeUpStationary(&a_Chunk, a_RelX, a_RelY, a_RelZ))
+				{
+					a_Chunk.FastSetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_WATER, a_Chunk.GetMeta(a_RelX, a_RelY, a_RelZ));
+				}
 				break;
 			}
 		}
@@ -32,6 +32,7 @@
 #include "MobCensus.h"
 #include "MobSpawner.h"
 #include "BlockInServerPluginInterface.h"
+#include "ChunkTickRegion.h"
 
 #include "json/json.h"
 
@@ -39,18 +40,8 @@
 
 
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// sSetBlock:
-
-sSetBlock::sSetBlock( int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta )  // absolute block position
-	: x( a_BlockX )
-	, y( a_BlockY )
-	, z( a_BlockZ )
-	, BlockType( a_BlockType )
-	, BlockMeta( a_BlockMeta )
-{
-	cChunkDef::AbsoluteToRelative(x, y, z, ChunkX, ChunkZ);
-}
+/** If more blocks than this change in a chunk in a single tick, the whole chunk is sent to the clients instead of the changes */
+#define MAX_BLOCK_CHANGES_TO_SEND 1024
 
 
 
@@ -82,6 +73,7 @@ cChunk::cChunk(
 	m_NeighborXP(a_NeighborXP),
 	m_NeighborZM(a_NeighborZM),
 	m_NeighborZP(a_NeighborZP),
+	m_TickRegion(NULL),
 	m_WaterSimulatorData(a_World->GetWaterSimulator()->CreateChunkData()),
 	m_LavaSimulatorData (a_World->GetLavaSimulator ()->CreateChunkData())
 {
@@ -118,6 +110,7 @@ cChunk::~cChunk()
 		delete *itr;
 	}
 	m_BlockEntities.clear();
+	m_TickingBlockEntities.clear();
 
 	// Remove and destroy all entities that are not players:
 	cEntityList Entities;
@@ -289,6 +282,9 @@ void cChunk::SetAllData(
 	
 	m_IsLightValid = (a_BlockLight != NULL) && (a_BlockSkyLight != NULL);
 	
+	// All the blocks have changed, drop the cached line-of-sight results going through the chunk:
+	m_World->GetLineOfSight().OnAreaChanged(m_PosX * Width, 0, m_PosZ * Width, m_PosX * Width + Width - 1, Height - 1, m_PosZ * Width + Width - 1);
+	
 	if (a_HeightMap == NULL)
 	{
 		CalculateHeightmap();
@@ -310,6 +306,9 @@ void cChunk::SetAllData(
 	// Create block entities that the loader didn't load; fill them with defaults
 	CreateBlockEntities();
 	
+	// All the new block entities start awake:
+	m_TickingBlockEntities.assign(m_BlockEntities.begin(), m_BlockEntities.end());
+	
 	// Set the chunk data as valid. This may be needed for some simulators that perform actions upon block adding (Vaporize)
 	SetValid();
 	
@@ -395,6 +394,12 @@ void cChunk::WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlock
 			}  // for x
 		}  // for z
 	}  // for y
+	
+	// Report the whole written area to the LOS cache at once, so that it doesn't depend on FastSetBlock() being used above:
+	if ((SizeX > 0) && (SizeY > 0) && (SizeZ > 0))
+	{
+		m_World->GetLineOfSight().OnAreaChanged(BlockStartX, a_MinBlockY, BlockStartZ, BlockEndX - 1, a_MinBlockY + SizeY - 1, BlockEndZ - 1);
+	}
 }
 
 
@@ -558,6 +563,17 @@ void cChunk::SpawnMobs(cMobSpawner& a_MobSpawner)
 
 
 void cChunk::Tick(float a_Dt)
+{
+	TickBeforeSimulators();
+	m_World->GetSimulatorManager()->SimulateChunk(a_Dt, m_PosX, m_PosZ, this);
+	TickAfterSimulators(a_Dt);
+}
+
+
+
+
+
+void cChunk::TickBeforeSimulators(void)
 {
 	BroadcastPendingBlockChanges();
 
@@ -572,17 +588,34 @@ void cChunk::Tick(float a_Dt)
 	ProcessQueuedSetBlocks();
 
 	CheckBlocks();
-	
-	// Tick simulators:
-	m_World->GetSimulatorManager()->SimulateChunk(a_Dt, m_PosX, m_PosZ, this);
-	
+}
+
+
+
+
+
+void cChunk::TickAfterSimulators(float a_Dt)
+{
 	TickBlocks();
 
-	// Tick all block entities in this chunk:
-	for (cBlockEntityList::iterator itr = m_BlockEntities.begin(); itr != m_BlockEntities.end(); ++itr)
+	// Tick the block entities that are awake and due. Ticking may wake up other block entities, appending them to the list,
+	// or remove block entities, setting their entries to NULL; hence the indexing:
+	Int64 WorldAge = m_World->GetWorldAge();
+	for (size_t i = 0; i < m_TickingBlockEntities.size(); i++)
 	{
-		m_IsDirty = (*itr)->Tick(a_Dt, *this) | m_IsDirty;
+		cBlockEntity * BlockEntity = m_TickingBlockEntities[i];
+		if ((BlockEntity == NULL) || (BlockEntity->GetNextTick() > WorldAge))
+		{
+			continue;
+		}
+		m_IsDirty = BlockEntity->Tick(a_Dt, *this) | m_IsDirty;
+		if ((m_TickingBlockEntities[i] != NULL) && BlockEntity->IsSleeping())
+		{
+			// The block entity has nothing to do until an event wakes it up, don't tick it until then:
+			m_TickingBlockEntities[i] = NULL;
+		}
 	}
+	m_TickingBlockEntities.erase(std::remove(m_TickingBlockEntities.begin(), m_TickingBlockEntities.end(), (cBlockEntity *)NULL), m_TickingBlockEntities.end());
 	
 	// Tick all entities in this chunk (except mobs):
 	for (cEntityList::iterator itr = m_Entities.begin(); itr != m_Entities.end(); ++itr)
@@ -632,6 +665,31 @@ void cChunk::Tick(float a_Dt)
 
 
 
+void cChunk::TickInRegion(cChunkTickRegion & a_Region, float a_Dt)
+{
+	ASSERT(m_TickRegion == NULL);
+	m_TickRegion = &a_Region;
+	m_World->GetSimulatorManager()->SimulateChunk(a_Dt, m_PosX, m_PosZ, this, true);
+	m_TickRegion = NULL;
+}
+
+
+
+
+
+int cChunk::GetTickRandomNumber(unsigned a_Range)
+{
+	if (m_TickRegion != NULL)
+	{
+		return m_TickRegion->GetRandomNumber(a_Range);
+	}
+	return m_World->GetTickRandomNumber(a_Range);
+}
+
+
+
+
+
 void cChunk::TickBlock(int a_RelX, int a_RelY, int a_RelZ)
 {
 	unsigned Index = MakeIndex(a_RelX, a_RelY, a_RelZ);
@@ -736,16 +794,85 @@ void cChunk::ProcessQueuedSetBlocks(void)
 
 
 
+/** Orders the block changes by the block they change; std::stable_sort() keeps the changes of each block in order */
+static bool IsBlockChangeBefore(const sSetBlock & a_Change1, const sSetBlock & a_Change2)
+{
+	if (a_Change1.y != a_Change2.y)
+	{
+		return (a_Change1.y < a_Change2.y);
+	}
+	if (a_Change1.z != a_Change2.z)
+	{
+		return (a_Change1.z < a_Change2.z);
+	}
+	return (a_Change1.x < a_Change2.x);
+}
+
+
+
+
+
 void cChunk::BroadcastPendingBlockChanges(void)
 {
 	if (m_PendingSendBlocks.empty())
 	{
 		return;
 	}
+	if (m_LoadedByClient.empty())
+	{
+		m_PendingSendBlocks.clear();
+		return;
+	}
 	
-	for (cClientHandleList::iterator itr = m_LoadedByClient.begin(), end = m_LoadedByClient.end(); itr != end; ++itr)
+	// Collapse the repeated changes of a block into the last one:
+	int NumChanges = (int)m_PendingSendBlocks.size();
+	if (NumChanges > 1)
 	{
-		(*itr)->SendBlockChanges(m_PosX, m_PosZ, m_PendingSendBlocks);
+		std::stable_sort(m_PendingSendBlocks.begin(), m_PendingSendBlocks.end(), IsBlockChangeBefore);
+		sSetBlockVector::iterator Dst = m_PendingSendBlocks.begin();
+		for (sSetBlockVector::iterator itr = m_PendingSendBlocks.begin(), end = m_PendingSendBlocks.end(); itr != end; ++itr)
+		{
+			sSetBlockVector::iterator Next = itr + 1;
+			if ((Next != end) && (Next->x == itr->x) && (Next->y == itr->y) && (Next->z == itr->z))
+			{
+				// The block changes again later
+				continue;
+			}
+			*Dst = *itr;
+			++Dst;
+		}
+		m_PendingSendBlocks.erase(Dst, m_PendingSendBlocks.end());
+	}
+	
+	cBlockChangeStats & Stats = m_World->GetBlockChangeStats();
+	int NumClients = (int)m_LoadedByClient.size();
+	if (m_PendingSendBlocks.size() > MAX_BLOCK_CHANGES_TO_SEND)
+	{
+		// Too many changes, resend the whole chunk:
+		for (cClientHandleList::iterator itr = m_LoadedByClient.begin(), end = m_LoadedByClient.end(); itr != end; ++itr)
+		{
+			m_World->SendChunkTo(m_PosX, m_PosZ, *itr);
+		}
+		Stats.AddChunkResend(NumChanges, NumClients);
+	}
+	else if (m_PendingSendBlocks.size() == 1)
+	{
+		const sSetBlock & Change = m_PendingSendBlocks.front();
+		int BlockX = m_PosX * Width + Change.x;
+		int BlockZ = m_PosZ * Width + Change.z;
+		for (cClientHandleList::iterator itr = m_LoadedByClient.begin(), end = m_LoadedByClient.end(); itr != end; ++itr)
+		{
+			(*itr)->SendBlockChange(BlockX, Change.y, BlockZ, Change.BlockType, Change.BlockMeta);
+		}
+		Stats.AddPackets(NumChanges, 1, NumClients);
+	}
+	else
+	{
+		for (cClientHandleList::iterator itr = m_LoadedByClient.begin(), end = m_LoadedByClient.end(); itr != end; ++itr)
+		{
+			(*itr)->SendBlockChanges(m_PosX, m_PosZ, m_PendingSendBlocks);
+		}
+		Stats.AddPackets(NumChanges, (int)m_PendingSendBlocks.size(), NumClients);
 	}
 	m_PendingSendBlocks.clear();
 }
@@ -793,10 +920,18 @@ void cChunk::TickBlocks(void)
 	
 	cChunkInterface ChunkInterface(this->GetWorld()->GetChunkMap());
 	cBlockInServerPluginInterface PluginInterface(*this->GetWorld());
+	
+	// When the world is overloaded, do only a fraction of the random ticks:
+	int NumTicks = 50;
+	if (m_World->ShouldDeferWork(cWorld::dwRandomBlockTicks))
+	{
+		NumTicks = 10;
+		m_World->AddDeferredWork(cWorld::dwRandomBlockTicks, 50 - NumTicks);
+	}
 
 	// This for loop looks disgusting, but it actually does a simple thing - first processes m_BlockTick, then adds random to it
 	// This is so that SetNextBlockTick() works
-	for (int i = 0; i < 50; i++,
+	for (int i = 0; i < NumTicks; i++,
 	
 		// This weird construct (*2, then /2) is needed,
 		// otherwise the blocktick distribution is too biased towards even coords!
@@ -839,6 +974,12 @@ void cChunk::ApplyWeatherToTop()
 		// Not the right weather, or not at this tick; bail out
 		return;
 	}
+	if (m_World->ShouldDeferWork(cWorld::dwWeatherOnTop))
+	{
+		// The world is overloaded, skip the weather
+		m_World->AddDeferredWork(cWorld::dwWeatherOnTop, 1);
+		return;
+	}
 	
 	int X = m_World->GetTickRandomNumber(15);
 	int Z = m_World->GetTickRandomNumber(15);
@@ -1218,6 +1359,47 @@ bool cChunk::UnboundedRelGetBlockLights(int a_RelX, int a_RelY, int a_RelZ, NIBB
 
 
 
+/** Sets a block in a chunk of another tick region; deferred from the region's tick by the UnboundedRel*SetBlock() functions */
+class cDeferredSetBlock :
+	public cChunkTickRegion::cDeferredAction
+{
+public:
+	cDeferredSetBlock(cChunk & a_Chunk, int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta, bool a_IsFast) :
+		m_Chunk(a_Chunk),
+		m_RelX(a_RelX),
+		m_RelY(a_RelY),
+		m_RelZ(a_RelZ),
+		m_BlockType(a_BlockType),
+		m_BlockMeta(a_BlockMeta),
+		m_IsFast(a_IsFast)
+	{
+	}
+	
+protected:
+	cChunk & m_Chunk;
+	int m_RelX, m_RelY, m_RelZ;
+	BLOCKTYPE  m_BlockType;
+	NIBBLETYPE m_BlockMeta;
+	bool m_IsFast;
+	
+	// cChunkTickRegion::cDeferredAction override:
+	virtual void Run(void) override
+	{
+		if (m_IsFast)
+		{
+			m_Chunk.FastSetBlock(m_RelX, m_RelY, m_RelZ, m_BlockType, m_BlockMeta);
+		}
+		else
+		{
+			m_Chunk.SetBlock(m_RelX, m_RelY, m_RelZ, m_BlockType, m_BlockMeta);
+		}
+	}
+} ;
+
+
+
+
+
 bool cChunk::UnboundedRelSetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
 {
 	if ((a_RelY < 0) || (a_RelY > cChunkDef::Height))
@@ -1231,6 +1413,12 @@ bool cChunk::UnboundedRelSetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE
 		// The chunk is not available, bail out
 		return false;
 	}
+	if ((m_TickRegion != NULL) && !m_TickRegion->IsInRegion(Chunk->GetPosX(), Chunk->GetPosZ()))
+	{
+		// The change reaches the other chunk's neighbors, which the region doesn't own; set the block once all the regions are ticked:
+		m_TickRegion->Defer(new cDeferredSetBlock(*Chunk, a_RelX, a_RelY, a_RelZ, a_BlockType, a_BlockMeta, false));
+		return true;
+	}
 	Chunk->SetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType, a_BlockMeta);
 	return true;
 }	
@@ -1252,6 +1440,12 @@ bool cChunk::UnboundedRelFastSetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKT
 		// The chunk is not available, bail out
 		return false;
 	}
+	if ((m_TickRegion != NULL) && !m_TickRegion->IsInRegion(Chunk->GetPosX(), Chunk->GetPosZ()))
+	{
+		// The change reaches the other chunk's neighbors, which the region doesn't own; set the block once all the regions are ticked:
+		m_TickRegion->Defer(new cDeferredSetBlock(*Chunk, a_RelX, a_RelY, a_RelZ, a_BlockType, a_BlockMeta, true));
+		return true;
+	}
 	Chunk->FastSetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType, a_BlockMeta);
 	return true;
 }
@@ -1302,31 +1496,16 @@ void cChunk::CreateBlockEntities(void)
 			for (int y = 0; y < Height; y++)
 			{
 				BLOCKTYPE BlockType = cChunkDef::GetBlock(m_BlockTypes, x, y, z);
-				switch (BlockType)
+				if (
+					cBlockEntity::IsBlockEntityBlockType(BlockType) &&
+					!HasBlockEntityAt(x + m_PosX * Width, y + m_PosY * Height, z + m_PosZ * Width)
+				)
 				{
-					case E_BLOCK_CHEST:
-					case E_BLOCK_COMMAND_BLOCK:
-					case E_BLOCK_DISPENSER:
-					case E_BLOCK_DROPPER:
-					case E_BLOCK_ENDER_CHEST:
-					case E_BLOCK_LIT_FURNACE:
-					case E_BLOCK_FURNACE:
-					case E_BLOCK_HOPPER:
-					case E_BLOCK_SIGN_POST:
-					case E_BLOCK_WALLSIGN:
-					case E_BLOCK_NOTE_BLOCK:
-					case E_BLOCK_JUKEBOX:
-					{
-						if (!HasBlockEntityAt(x + m_PosX * Width, y + m_PosY * Height, z + m_PosZ * Width))
-						{
-							m_BlockEntities.push_back(cBlockEntity::CreateByBlockType(
-								BlockType, GetMeta(x, y, z),
-								x + m_PosX * Width, y + m_PosY * Height, z + m_PosZ * Width, m_World
-							));
-						}
-						break;
-					}
-				}  // switch (BlockType)
+					m_BlockEntities.push_back(cBlockEntity::CreateByBlockType(
+						BlockType, GetMeta(x, y, z),
+						x + m_PosX * Width, y + m_PosY * Height, z + m_PosZ * Width, m_World
+					));
+				}
 			}  // for y
 		}  // for z
 	}  // for x
@@ -1430,25 +1609,13 @@ void cChunk::SetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType,
 	}
 	
 	// If the new block is a block entity, create the entity object:
-	switch (a_BlockType)
+	if (cBlockEntity::IsBlockEntityBlockType(a_BlockType))
 	{
-		case E_BLOCK_CHEST:
-		case E_BLOCK_COMMAND_BLOCK:
-		case E_BLOCK_DISPENSER:
-		case E_BLOCK_DROPPER:
-		case E_BLOCK_ENDER_CHEST:
-		case E_BLOCK_LIT_FURNACE:
-		case E_BLOCK_FURNACE:
-		case E_BLOCK_HOPPER:
-		case E_BLOCK_SIGN_POST:
-		case E_BLOCK_WALLSIGN:
-		case E_BLOCK_NOTE_BLOCK:
-		case E_BLOCK_JUKEBOX:
-		{
-			AddBlockEntity(cBlockEntity::CreateByBlockType(a_BlockType, a_BlockMeta, WorldPos.x, WorldPos.y, WorldPos.z, m_World));
-			break;
-		}
-	}  // switch (a_BlockType)
+		AddBlockEntity(cBlockEntity::CreateByBlockType(a_BlockType, a_BlockMeta, WorldPos.x, WorldPos.y, WorldPos.z, m_World));
+	}
+	
+	// The neighboring block entities may now have a container to move items into or from:
+	WakeUpBlockEntityNeighbors(a_RelX, a_RelY, a_RelZ);
 }
 
 
@@ -1524,6 +1691,7 @@ void cChunk::FastSetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockT
 	}
 
 	MarkDirty();
+	m_World->GetLineOfSight().OnBlockChanged(m_PosX * Width + a_RelX, a_RelY, m_PosZ * Width + a_RelZ);
 	
 	m_BlockTypes[index] = a_BlockType;
 
@@ -1612,6 +1780,10 @@ void cChunk::AddBlockEntity(cBlockEntity * a_BlockEntity)
 {
 	MarkDirty();
 	m_BlockEntities.push_back(a_BlockEntity);
+	
+	// New block entities start awake:
+	ASSERT(!a_BlockEntity->IsSleeping());
+	m_TickingBlockEntities.push_back(a_BlockEntity);
 }
 
 
@@ -1639,6 +1811,94 @@ cBlockEntity * cChunk::GetBlockEntity(int a_BlockX, int a_BlockY, int a_BlockZ)
 
 
 
+void cChunk::WakeUpBlockEntity(cBlockEntity * a_BlockEntity)
+{
+	ASSERT((a_BlockEntity->GetChunkX() == m_PosX) && (a_BlockEntity->GetChunkZ() == m_PosZ));
+	
+	// Only the sleeping block entities are out of the tick list:
+	if (a_BlockEntity->IsSleeping())
+	{
+		m_TickingBlockEntities.push_back(a_BlockEntity);
+	}
+	a_BlockEntity->m_NextTick = 0;
+}
+
+
+
+
+
+void cChunk::WakeUpBlockEntity(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	cBlockEntity * BlockEntity = GetBlockEntity(a_BlockX, a_BlockY, a_BlockZ);
+	if (BlockEntity != NULL)
+	{
+		WakeUpBlockEntity(BlockEntity);
+	}
+}
+
+
+
+
+
+void cChunk::WakeUpBlockEntityNeighbors(int a_RelX, int a_RelY, int a_RelZ)
+{
+	static const struct
+	{
+		int x, y, z;
+	}
+	Coords[] =
+	{
+		{ 1,  0,  0},
+		{-1,  0,  0},
+		{ 0,  1,  0},
+		{ 0, -1,  0},
+		{ 0,  0,  1},
+		{ 0,  0, -1},
+	} ;
+	for (size_t i = 0; i < ARRAYCOUNT(Coords); i++)
+	{
+		int RelX = a_RelX + Coords[i].x;
+		int RelY = a_RelY + Coords[i].y;
+		int RelZ = a_RelZ + Coords[i].z;
+		if ((RelY < 0) || (RelY >= cChunkDef::Height))
+		{
+			continue;
+		}
+		cChunk * Chunk = GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+		
+		// Check the block type first, so that the block entity list is only searched next to the blocks that have one:
+		if (
+			(Chunk == NULL) || !Chunk->IsValid() ||
+			!cBlockEntity::IsBlockEntityBlockType(Chunk->GetBlock(RelX, RelY, RelZ))
+		)
+		{
+			continue;
+		}
+		Chunk->WakeUpBlockEntity(RelX + Chunk->GetPosX() * Width, RelY, RelZ + Chunk->GetPosZ() * Width);
+	}  // for i - Coords[]
+}
+
+
+
+
+
+void cChunk::GetBlockEntityCounts(int & a_NumAwake, int & a_NumSleeping) const
+{
+	a_NumAwake = (int)m_TickingBlockEntities.size();
+	a_NumSleeping = 0;
+	for (cBlockEntityList::const_iterator itr = m_BlockEntities.begin(); itr != m_BlockEntities.end(); ++itr)
+	{
+		if ((*itr)->IsSleeping())
+		{
+			a_NumSleeping++;
+		}
+	}
+}
+
+
+
+
+
 void cChunk::UseBlockEntity(cPlayer * a_Player, int a_X, int a_Y, int a_Z)
 {
 	cBlockEntity * be = GetBlockEntity(a_X, a_Y, a_Z);
@@ -1732,6 +1992,9 @@ void cChunk::RemoveBlockEntity( cBlockEntity* a_BlockEntity )
 {
 	MarkDirty();
 	m_BlockEntities.remove(a_BlockEntity);
+	
+	// The tick list may be being iterated over in Tick(), only reset the entry; Tick() removes it:
+	std::replace(m_TickingBlockEntities.begin(), m_TickingBlockEntities.end(), a_BlockEntity, (cBlockEntity *)NULL);
 }
 
 
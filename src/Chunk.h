@@ -39,6 +39,7 @@ class cBlockArea;
 class cFluidSimulatorData;
 class cMobCensus;
 class cMobSpawner;
+class cChunkTickRegion;
 
 typedef std::list<cClientHandle *>         cClientHandleList;
 typedef cItemCallback<cEntity>             cEntityCallback;
@@ -126,6 +127,23 @@ public:
 
 	void Tick(float a_Dt);
 	
+	/** The parts of Tick(), in the order in which Tick() calls them. The parallel tick mode (cChunkMap::TickParallel()) calls
+	TickBeforeSimulators() for all the chunks, then TickInRegion() from the tick regions, then the simulators that aren't
+	region-local and TickAfterSimulators() for all the chunks. */
+	void TickBeforeSimulators(void);
+	void TickAfterSimulators(float a_Dt);
+	
+	/** Runs the region-local simulators on this chunk, as a part of the tick region a_Region, possibly in a worker thread */
+	void TickInRegion(cChunkTickRegion & a_Region, float a_Dt);
+	
+	/** Returns the tick region that is ticking this chunk in a worker thread, or NULL if the chunk is ticked in the tick thread.
+	Code that runs in the chunk's tick needs to defer the actions that aren't safe in a worker thread to the region, see cChunkTickRegion. */
+	cChunkTickRegion * GetTickRegion(void) const { return m_TickRegion; }
+	
+	/** Returns a random number in range [0 .. a_Range] for the chunk's tick: from the tick region while ticked in a region,
+	from the world's m_TickRand otherwise */
+	int GetTickRandomNumber(unsigned a_Range);
+	
 	/** Ticks a single block. Used by cWorld::TickQueuedBlocks() to tick the queued blocks */
 	void TickBlock(int a_RelX, int a_RelY, int a_RelZ);
 
@@ -357,6 +375,18 @@ public:
 
 	cBlockEntity * GetBlockEntity(int a_BlockX, int a_BlockY, int a_BlockZ);
 	cBlockEntity * GetBlockEntity(const Vector3i & a_BlockPos) { return GetBlockEntity(a_BlockPos.x, a_BlockPos.y, a_BlockPos.z); }
+	
+	/** Puts the block entity back into the tick list, if it was sleeping. The block entity must be in this chunk */
+	void WakeUpBlockEntity(cBlockEntity * a_BlockEntity);
+	
+	/** Wakes up the block entity at the specified absolute coords, if there is any */
+	void WakeUpBlockEntity(int a_BlockX, int a_BlockY, int a_BlockZ);
+	
+	/** Wakes up the block entities of all 6 neighbors of the specified block. If any are outside the chunk, relays to the proper neighboring chunk */
+	void WakeUpBlockEntityNeighbors(int a_RelX, int a_RelY, int a_RelZ);
+	
+	/** Returns the number of block entities in the tick list and the number of those sleeping until woken up */
+	void GetBlockEntityCounts(int & a_NumAwake, int & a_NumSleeping) const;
 
 private:
 
@@ -396,6 +426,10 @@ private:
 	cEntityList        m_Entities;
 	cBlockEntityList   m_BlockEntities;
 	
+	/** The block entities that are not sleeping, the only ones ticked. A woken up block entity is appended; those falling asleep are removed after the tick.
+	Entries of the block entities removed while ticking are set to NULL */
+	std::vector<cBlockEntity *> m_TickingBlockEntities;
+	
 	/** Number of times the chunk has been requested to stay (by various cChunkStay objects); if zero, the chunk can be unloaded */
 	int m_StayCount;
 
@@ -419,6 +453,9 @@ private:
 	cChunk * m_NeighborZM;  // Neighbor at [X,     Z - 1]
 	cChunk * m_NeighborZP;  // Neighbor at [X,     Z + 1]
 	
+	/** The tick region that is ticking this chunk in a worker thread, NULL otherwise */
+	cChunkTickRegion * m_TickRegion;
+	
 	// Per-chunk simulator data:
 	cFireSimulatorChunkData m_FireSimulatorData;
 	cFluidSimulatorData *   m_WaterSimulatorData;
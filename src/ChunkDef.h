@@ -449,7 +449,14 @@ struct sSetBlock
 	BLOCKTYPE BlockType;
 	NIBBLETYPE BlockMeta;
 
-	sSetBlock( int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta );  // absolute block position
+	sSetBlock( int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta ) :  // absolute block position
+		x(a_BlockX), y(a_BlockY), z(a_BlockZ),
+		BlockType(a_BlockType),
+		BlockMeta(a_BlockMeta)
+	{
+		cChunkDef::AbsoluteToRelative(x, y, z, ChunkX, ChunkZ);
+	}
+
 	sSetBlock(int a_ChunkX, int a_ChunkZ, int a_X, int a_Y, int a_Z, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta) :
 		x(a_X), y(a_Y), z(a_Z),
 		ChunkX(a_ChunkX), ChunkZ(a_ChunkZ),
@@ -478,6 +485,13 @@ public:
 	{
 		return ((m_ChunkX == a_Other.m_ChunkX) && (m_ChunkY == a_Other.m_ChunkY) && (m_ChunkZ == a_Other.m_ChunkZ));
 	}
+	
+	/** Returns the hash of the coords, used for indexing the chunk queues */
+	size_t GetHash(void) const
+	{
+		size_t Hash = (size_t)m_ChunkX * 0x9e3779b1u + (size_t)m_ChunkZ * 0x85ebca6bu + (size_t)m_ChunkY;
+		return Hash ^ (Hash >> 16);
+	}
 } ;
 
 typedef std::list<cChunkCoords> cChunkCoordsList;
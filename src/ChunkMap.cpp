@@ -16,6 +16,10 @@
 #include "MobCensus.h"
 #include "MobSpawner.h"
 #include "BoundingBox.h"
+#include "Explosion.h"
+#include "FastRandom.h"
+#include "CommandOutput.h"
+#include "BlockEntities/BlockEntity.h"
 
 #include "Entities/Pickup.h"
 
@@ -30,11 +34,19 @@
 
 
 
+/** Number of chunks with the most awake block entities that LogBlockEntityStats() lists */
+#define NUM_BUSIEST_CHUNKS_TO_LOG 5
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // cChunkMap:
 
 cChunkMap::cChunkMap(cWorld * a_World )
-	: m_World( a_World )
+	: m_CSLayers("cChunkMap::m_CSLayers")
+	, m_World( a_World )
 {
 }
 
@@ -105,7 +117,8 @@ cChunkMap::cChunkLayer * cChunkMap::FindLayerForChunk(int a_ChunkX, int a_ChunkZ
 
 cChunkMap::cChunkLayer * cChunkMap::FindLayer(int a_LayerX, int a_LayerZ)
 {
-	ASSERT(m_CSLayers.IsLockedByCurrentThread());
+	// The tick regions' threads look up chunks while the tick thread holds the lock for them:
+	ASSERT(m_CSLayers.IsLockedByCurrentThread() || m_TickThreads.IsTicking());
 
 	for (cChunkLayerList::const_iterator itr = m_Layers.begin(); itr != m_Layers.end(); ++itr)
 	{
@@ -313,7 +326,8 @@ bool cChunkMap::LockedFastSetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLO
 
 cChunk * cChunkMap::FindChunk(int a_ChunkX, int a_ChunkZ)
 {
-	ASSERT(m_CSLayers.IsLockedByCurrentThread());
+	// The tick regions' threads look up chunks while the tick thread holds the lock for them:
+	ASSERT(m_CSLayers.IsLockedByCurrentThread() || m_TickThreads.IsTicking());
 	
 	cChunkLayer * Layer = FindLayerForChunk(a_ChunkX, a_ChunkZ);
 	if (Layer == NULL)
@@ -1689,96 +1703,43 @@ void cChunkMap::DoExplosionAt(double a_ExplosionSize, double a_BlockX, double a_
 	int ExplosionSizeInt = (int)ceil(a_ExplosionSize);
 	int ExplosionSizeSq = ExplosionSizeInt * ExplosionSizeInt;
 
-	int bx = (int)floor(a_BlockX);
-	int by = (int)floor(a_BlockY);
-	int bz = (int)floor(a_BlockZ);
-
-	int MinY = std::max((int)floor(a_BlockY - ExplosionSizeInt), 0);
-	int MaxY = std::min((int)ceil(a_BlockY + ExplosionSizeInt), cChunkDef::Height - 1);
-
 	if (ShouldDestroyBlocks)
 	{
-		cBlockArea area;
-
-		a_BlocksAffected.reserve(8 * ExplosionSizeInt * ExplosionSizeInt * ExplosionSizeInt);
-
-		area.Read(m_World, bx - ExplosionSizeInt, (int)ceil(a_BlockX + ExplosionSizeInt), MinY, MaxY, bz - ExplosionSizeInt, (int)ceil(a_BlockZ + ExplosionSizeInt));
-		for (int x = -ExplosionSizeInt; x < ExplosionSizeInt; x++)
+		// Cast all the rays over a single snapshot of the blocks, then apply the results in one go:
+		cExplosion Explosion(a_ExplosionSize, Vector3d(a_BlockX, a_BlockY, a_BlockZ));
+		int MinX, MaxX, MinY, MaxY, MinZ, MaxZ;
+		Explosion.GetReach(MinX, MaxX, MinY, MaxY, MinZ, MaxZ);
+		cBlockArea Snapshot;
+		if (!Snapshot.Read(m_World, MinX, MaxX, MinY, MaxY, MinZ, MaxZ))
 		{
-			for (int y = -ExplosionSizeInt; y < ExplosionSizeInt; y++)
+			// Some of the chunks in reach are not loaded, read the loaded ones one by one.
+			// The blocks in the rest stay bedrock, so that the rays stop there as they would at an unloaded block:
+			Snapshot.Create(MaxX - MinX + 1, MaxY - MinY + 1, MaxZ - MinZ + 1);
+			Snapshot.SetOrigin(MinX, MinY, MinZ);
+			Snapshot.Fill(cBlockArea::baTypes, E_BLOCK_BEDROCK);
+			int MinChunkX = FAST_FLOOR_DIV(MinX, cChunkDef::Width);
+			int MaxChunkX = FAST_FLOOR_DIV(MaxX, cChunkDef::Width);
+			int MinChunkZ = FAST_FLOOR_DIV(MinZ, cChunkDef::Width);
+			int MaxChunkZ = FAST_FLOOR_DIV(MaxZ, cChunkDef::Width);
+			for (int ChunkZ = MinChunkZ; ChunkZ <= MaxChunkZ; ChunkZ++)
 			{
-				if ((by + y >= cChunkDef::Height) || (by + y < 0))
-				{
-					// Outside of the world
-					continue;
-				}
-				for (int z = -ExplosionSizeInt; z < ExplosionSizeInt; z++)
+				int PartMinZ = std::max(MinZ, ChunkZ * cChunkDef::Width);
+				int PartMaxZ = std::min(MaxZ, ChunkZ * cChunkDef::Width + cChunkDef::Width - 1);
+				for (int ChunkX = MinChunkX; ChunkX <= MaxChunkX; ChunkX++)
 				{
-					if ((x * x + y * y + z * z) > ExplosionSizeSq)
-					{
-						// Too far away
-						continue;
-					}
-
-					BLOCKTYPE Block = area.GetBlockType(bx + x, by + y, bz + z);
-					switch (Block)
-					{
-					case E_BLOCK_TNT:
-					{
-						// Activate the TNT, with a random fuse between 10 to 30 game ticks
-						double FuseTime = (double)(10 + m_World->GetTickRandomNumber(20)) / 20;
-						m_World->SpawnPrimedTNT(a_BlockX + x + 0.5, a_BlockY + y + 0.5, a_BlockZ + z + 0.5, FuseTime);
-						area.SetBlockType(bx + x, by + y, bz + z, E_BLOCK_AIR);
-						a_BlocksAffected.push_back(Vector3i(bx + x, by + y, bz + z));
-						break;
-					}
-					case E_BLOCK_OBSIDIAN:
-					case E_BLOCK_BEDROCK:
-					case E_BLOCK_WATER:
-					case E_BLOCK_LAVA:
-					{
-						// These blocks are not affected by explosions
-						break;
-					}
-
-					case E_BLOCK_STATIONARY_WATER:
+					int PartMinX = std::max(MinX, ChunkX * cChunkDef::Width);
+					int PartMaxX = std::min(MaxX, ChunkX * cChunkDef::Width + cChunkDef::Width - 1);
+					cBlockArea Part;
+					if (Part.Read(m_World, PartMinX, PartMaxX, MinY, MaxY, PartMinZ, PartMaxZ))
 					{
-						// Turn into simulated water:
-						area.SetBlockType(bx + x, by + y, bz + z, E_BLOCK_WATER);
-						break;
+						Snapshot.Merge(Part, PartMinX - MinX, 0, PartMinZ - MinZ, cBlockArea::msOverwrite);
 					}
-
-					case E_BLOCK_STATIONARY_LAVA:
-					{
-						// Turn into simulated lava:
-						area.SetBlockType(bx + x, by + y, bz + z, E_BLOCK_LAVA);
-						break;
-					}
-
-					case E_BLOCK_AIR:
-					{
-						// No pickups for air
-						break;
-					}
-
-					default:
-					{
-						if (m_World->GetTickRandomNumber(100) <= 25) // 25% chance of pickups
-						{
-							cItems Drops;
-							cBlockHandler * Handler = BlockHandler(Block);
-
-							Handler->ConvertToPickups(Drops, area.GetBlockMeta(bx + x, by + y, bz + z)); // Stone becomes cobblestone, coal ore becomes coal, etc.
-							m_World->SpawnItemPickups(Drops, bx + x, by + y, bz + z);
-						}
-						area.SetBlockType(bx + x, by + y, bz + z, E_BLOCK_AIR);
-						a_BlocksAffected.push_back(Vector3i(bx + x, by + y, bz + z));
-					}
-					}  // switch (BlockType)
-				}  // for z
-			}  // for y
-		}  // for x
-		area.Write(m_World, bx - ExplosionSizeInt, MinY, bz - ExplosionSizeInt);
+				}  // for ChunkX
+			}  // for ChunkZ
+		}
+		cFastRandom Random;
+		Explosion.Calculate(Snapshot, Random);
+		ApplyExplosion(Explosion, a_BlocksAffected);
 	}
 
 	class cTNTDamageCallback :
@@ -1858,13 +1819,111 @@ void cChunkMap::DoExplosionAt(double a_ExplosionSize, double a_BlockX, double a_
 
 	cTNTDamageCallback TNTDamageCallback(bbTNT, Vector3d(a_BlockX, a_BlockY, a_BlockZ), ExplosionSizeInt, ExplosionSizeSq);
 	ForEachEntity(TNTDamageCallback);
+}
+
+
 
-	// Wake up all simulators for the area, so that water and lava flows and sand falls into the blasted holes (FS #391):
-	WakeUpSimulatorsInArea(
-		bx - ExplosionSizeInt - 1, bx + ExplosionSizeInt + 1,
-		MinY, MaxY,
-		bz - ExplosionSizeInt - 1, bz + ExplosionSizeInt + 1
-	);
+
+
+/** Adds the item to a_Pickups, merging it into an existing stack if there's room */
+static void AddMergedPickup(cItems & a_Pickups, const cItem & a_Item)
+{
+	for (cItems::iterator itr = a_Pickups.begin(), end = a_Pickups.end(); itr != end; ++itr)
+	{
+		if (itr->IsEqual(a_Item) && (itr->m_ItemCount + a_Item.m_ItemCount <= itr->GetMaxStackSize()))
+		{
+			itr->m_ItemCount += a_Item.m_ItemCount;
+			return;
+		}
+	}
+	a_Pickups.push_back(a_Item);
+}
+
+
+
+
+
+void cChunkMap::ApplyExplosion(const cExplosion & a_Explosion, cVector3iArray & a_BlocksAffected)
+{
+	// Set the blocks, the changes are sorted by chunk, so each chunk is looked up only once.
+	// The simulators are woken up only for the changed blocks, they wake up the neighbors themselves
+	// (so that water and lava flows and sand falls into the blasted holes, FS #391):
+	const sSetBlockVector & Changed = a_Explosion.GetChangedBlocks();
+	cChunkCoordsVector InvalidChunks;  // The chunks that the changes weren't applied to, because they got unloaded
+	{
+		cCSLock Lock(m_CSLayers);
+		cSimulatorManager * SimMgr = m_World->GetSimulatorManager();
+		cChunkPtr Chunk = NULL;
+		for (sSetBlockVector::const_iterator itr = Changed.begin(), end = Changed.end(); itr != end; ++itr)
+		{
+			if ((itr == Changed.begin()) || (itr->ChunkX != (itr - 1)->ChunkX) || (itr->ChunkZ != (itr - 1)->ChunkZ))
+			{
+				Chunk = GetChunkNoGen(itr->ChunkX, ZERO_CHUNK_Y, itr->ChunkZ);
+				if ((Chunk == NULL) || !Chunk->IsValid())
+				{
+					InvalidChunks.push_back(cChunkCoords(itr->ChunkX, ZERO_CHUNK_Y, itr->ChunkZ));
+				}
+			}
+			if ((Chunk == NULL) || !Chunk->IsValid())
+			{
+				continue;
+			}
+			Chunk->SetBlock(itr->x, itr->y, itr->z, itr->BlockType, itr->BlockMeta);
+			SimMgr->WakeUp(itr->ChunkX * cChunkDef::Width + itr->x, itr->y, itr->ChunkZ * cChunkDef::Width + itr->z, Chunk);
+		}
+	}
+
+	// Prime the TNT and collect the pickups, spawning them once per chunk at the average position of their blocks:
+	const sSetBlockVector & Destroyed = a_Explosion.GetDestroyedBlocks();
+	a_BlocksAffected.reserve(a_BlocksAffected.size() + Destroyed.size());
+	cItems Pickups;
+	Vector3d PickupsPos;
+	int NumPickupBlocks = 0;
+	bool IsChunkValid = true;
+	for (sSetBlockVector::const_iterator itr = Destroyed.begin(), end = Destroyed.end(); itr != end; ++itr)
+	{
+		if ((itr == Destroyed.begin()) || (itr->ChunkX != (itr - 1)->ChunkX) || (itr->ChunkZ != (itr - 1)->ChunkZ))
+		{
+			cChunkCoords Coords(itr->ChunkX, ZERO_CHUNK_Y, itr->ChunkZ);
+			IsChunkValid = (std::find(InvalidChunks.begin(), InvalidChunks.end(), Coords) == InvalidChunks.end());
+		}
+		if (!IsChunkValid)
+		{
+			// The block hasn't been destroyed, don't prime it nor drop its pickups
+			continue;
+		}
+
+		int BlockX = itr->ChunkX * cChunkDef::Width + itr->x;
+		int BlockZ = itr->ChunkZ * cChunkDef::Width + itr->z;
+		a_BlocksAffected.push_back(Vector3i(BlockX, itr->y, BlockZ));
+		if (itr->BlockType == E_BLOCK_TNT)
+		{
+			// Activate the TNT, with a random fuse between 10 to 30 game ticks
+			double FuseTime = (double)(10 + m_World->GetTickRandomNumber(20)) / 20;
+			m_World->SpawnPrimedTNT(BlockX + 0.5, itr->y + 0.5, BlockZ + 0.5, FuseTime);
+		}
+		else if (m_World->GetTickRandomNumber(100) <= 25)  // 25% chance of pickups
+		{
+			cItems Drops;
+			BlockHandler(itr->BlockType)->ConvertToPickups(Drops, itr->BlockMeta);  // Stone becomes cobblestone, coal ore becomes coal, etc.
+			for (cItems::const_iterator itrD = Drops.begin(), endD = Drops.end(); itrD != endD; ++itrD)
+			{
+				AddMergedPickup(Pickups, *itrD);
+			}
+			PickupsPos += Vector3d(BlockX + 0.5, itr->y + 0.5, BlockZ + 0.5);
+			NumPickupBlocks += 1;
+		}
+
+		bool IsLastInChunk = ((itr + 1 == end) || ((itr + 1)->ChunkX != itr->ChunkX) || ((itr + 1)->ChunkZ != itr->ChunkZ));
+		if (IsLastInChunk && (NumPickupBlocks > 0))
+		{
+			PickupsPos = PickupsPos / NumPickupBlocks;
+			m_World->SpawnItemPickups(Pickups, PickupsPos.x, PickupsPos.y, PickupsPos.z);
+			Pickups.clear();
+			PickupsPos = Vector3d();
+			NumPickupBlocks = 0;
+		}
+	}
 }
 
 
@@ -1997,6 +2056,40 @@ bool cChunkMap::DoWithBlockEntityAt(int a_BlockX, int a_BlockY, int a_BlockZ, cB
 
 
 
+void cChunkMap::WakeUpBlockEntity(cBlockEntity & a_BlockEntity)
+{
+	cCSLock Lock(m_CSLayers);
+	cChunkPtr Chunk = GetChunkNoLoad(a_BlockEntity.GetChunkX(), ZERO_CHUNK_Y, a_BlockEntity.GetChunkZ());
+	if ((Chunk == NULL) || !Chunk->IsValid())
+	{
+		// The block entity is still being loaded, it is awake already
+		return;
+	}
+	Chunk->WakeUpBlockEntity(&a_BlockEntity);
+}
+
+
+
+
+
+void cChunkMap::WakeUpBlockEntityNeighbors(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	int ChunkX, ChunkZ;
+	int RelX = a_BlockX, RelY = a_BlockY, RelZ = a_BlockZ;
+	cChunkDef::AbsoluteToRelative(RelX, RelY, RelZ, ChunkX, ChunkZ);
+	cCSLock Lock(m_CSLayers);
+	cChunkPtr Chunk = GetChunkNoLoad(ChunkX, ZERO_CHUNK_Y, ChunkZ);
+	if ((Chunk == NULL) || !Chunk->IsValid())
+	{
+		return;
+	}
+	Chunk->WakeUpBlockEntityNeighbors(RelX, RelY, RelZ);
+}
+
+
+
+
+
 bool cChunkMap::DoWithChestAt(int a_BlockX, int a_BlockY, int a_BlockZ, cChestCallback & a_Callback)
 {
 	int ChunkX, ChunkZ;
@@ -2258,11 +2351,12 @@ bool cChunkMap::IsChunkLighted(int a_ChunkX, int a_ChunkZ)
 bool cChunkMap::ForEachChunkInRect(int a_MinChunkX, int a_MaxChunkX, int a_MinChunkZ, int a_MaxChunkZ, cChunkDataCallback & a_Callback)
 {
 	bool Result = true;
-	cCSLock Lock(m_CSLayers);
 	for (int z = a_MinChunkZ; z <= a_MaxChunkZ; z++)
 	{
 		for (int x = a_MinChunkX; x <= a_MaxChunkX; x++)
 		{
+			// Lock each chunk separately so that large areas don't stall the tick thread for their whole duration:
+			cCSLock Lock(m_CSLayers);
 			cChunkPtr Chunk = GetChunkNoLoad(x, ZERO_CHUNK_Y, z);
 			if ((Chunk == NULL) || (!Chunk->IsValid()))
 			{
@@ -2300,11 +2394,12 @@ bool cChunkMap::WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBl
 	
 	// Iterate over chunks, write data into each:
 	bool Result = true;
-	cCSLock Lock(m_CSLayers);
 	for (int z = MinChunkZ; z <= MaxChunkZ; z++)
 	{
 		for (int x = MinChunkX; x <= MaxChunkX; x++)
 		{
+			// Lock each chunk separately, same as ForEachChunkInRect():
+			cCSLock Lock(m_CSLayers);
 			cChunkPtr Chunk = GetChunkNoLoad(x, ZERO_CHUNK_Y, z);
 			if ((Chunk == NULL) || (!Chunk->IsValid()))
 			{
@@ -2340,6 +2435,61 @@ void cChunkMap::GetChunkStats(int & a_NumChunksValid, int & a_NumChunksDirty)
 
 
 
+void cChunkMap::LogBlockEntityStats(cCommandOutputCallback & a_Output)
+{
+	cCSLock Lock(m_CSLayers);
+	cChunkPtrs Chunks;
+	for (cChunkLayerList::iterator itr = m_Layers.begin(); itr != m_Layers.end(); ++itr)
+	{
+		(*itr)->CollectTickableChunks(Chunks);
+	}  // for itr - m_Layers
+	
+	// Sum the counts and order the chunks by the number of awake block entities, descending:
+	int TotalAwake = 0, TotalSleeping = 0;
+	std::vector<std::pair<int, cChunk *> > Busiest;
+	for (cChunkPtrs::const_iterator itr = Chunks.begin(); itr != Chunks.end(); ++itr)
+	{
+		int NumAwake, NumSleeping;
+		(*itr)->GetBlockEntityCounts(NumAwake, NumSleeping);
+		TotalAwake += NumAwake;
+		TotalSleeping += NumSleeping;
+		if (NumAwake > 0)
+		{
+			Busiest.push_back(std::make_pair(-NumAwake, *itr));
+		}
+	}  // for itr - Chunks[]
+	std::sort(Busiest.begin(), Busiest.end());
+	
+	a_Output.Out("  Block entities in the %u ticked chunks: %d awake, %d sleeping", (unsigned)Chunks.size(), TotalAwake, TotalSleeping);
+	if (Busiest.empty())
+	{
+		return;
+	}
+	a_Output.Out("  Chunks with the most awake block entities:");
+	for (size_t i = 0; (i < Busiest.size()) && (i < NUM_BUSIEST_CHUNKS_TO_LOG); i++)
+	{
+		int NumAwake, NumSleeping;
+		cChunk * Chunk = Busiest[i].second;
+		Chunk->GetBlockEntityCounts(NumAwake, NumSleeping);
+		a_Output.Out("    [%d, %d]: %d awake, %d sleeping", Chunk->GetPosX(), Chunk->GetPosZ(), NumAwake, NumSleeping);
+	}
+}
+
+
+
+
+
+int cChunkMap::GetNumChunksInLayer(int a_LayerX, int a_LayerZ)
+{
+	cCSLock Lock(m_CSLayers);
+	cChunkLayer * Layer = FindLayer(a_LayerX, a_LayerZ);
+	return (Layer == NULL) ? 0 : Layer->GetNumChunksLoaded();
+}
+
+
+
+
+
 void cChunkMap::GrowMelonPumpkin(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, MTRand & a_Rand)
 {
 	int ChunkX, ChunkZ;
@@ -2434,13 +2584,116 @@ void cChunkMap::SpawnMobs(cMobSpawner& a_MobSpawner)
 
 
 
+/** Orders chunks by their tick phase, then by their tick region, then by their coords */
+class cChunkTickOrder
+{
+public:
+	bool operator ()(const cChunk * a_First, const cChunk * a_Second) const
+	{
+		int RegionX1 = FAST_FLOOR_DIV(a_First->GetPosX(),  cChunkMap::TICK_REGION_SIZE);
+		int RegionZ1 = FAST_FLOOR_DIV(a_First->GetPosZ(),  cChunkMap::TICK_REGION_SIZE);
+		int RegionX2 = FAST_FLOOR_DIV(a_Second->GetPosX(), cChunkMap::TICK_REGION_SIZE);
+		int RegionZ2 = FAST_FLOOR_DIV(a_Second->GetPosZ(), cChunkMap::TICK_REGION_SIZE);
+		int Phase1 = (RegionX1 & 1) | ((RegionZ1 & 1) << 1);
+		int Phase2 = (RegionX2 & 1) | ((RegionZ2 & 1) << 1);
+		if (Phase1 != Phase2)
+		{
+			return (Phase1 < Phase2);
+		}
+		if (RegionX1 != RegionX2)
+		{
+			return (RegionX1 < RegionX2);
+		}
+		if (RegionZ1 != RegionZ2)
+		{
+			return (RegionZ1 < RegionZ2);
+		}
+		if (a_First->GetPosX() != a_Second->GetPosX())
+		{
+			return (a_First->GetPosX() < a_Second->GetPosX());
+		}
+		return (a_First->GetPosZ() < a_Second->GetPosZ());
+	}
+} ;
+
+
+
+
+
 void cChunkMap::Tick(float a_Dt)
 {
 	cCSLock Lock(m_CSLayers);
+	
+	// Collect the chunks to tick and order them by tick regions and phases.
+	// The order then doesn't depend on the order in which the layers were created, and each phase's regions are independent of each other
+	m_TickList.clear();
 	for (cChunkLayerList::iterator itr = m_Layers.begin(); itr != m_Layers.end(); ++itr)
 	{
-		(*itr)->Tick(a_Dt);
+		(*itr)->CollectTickableChunks(m_TickList);
 	}  // for itr - m_Layers
+	std::sort(m_TickList.begin(), m_TickList.end(), cChunkTickOrder());
+	
+	if (m_TickThreads.IsEnabled())
+	{
+		TickParallel(a_Dt);
+		return;
+	}
+	
+	for (cChunkPtrs::iterator itr = m_TickList.begin(), end = m_TickList.end(); itr != end; ++itr)
+	{
+		(*itr)->Tick(a_Dt);
+	}  // for itr - m_TickList[]
+}
+
+
+
+
+
+void cChunkMap::TickParallel(float a_Dt)
+{
+	// The lock is held by Tick() for the whole time, the worker threads rely on it to keep everyone else out
+	ASSERT(m_CSLayers.IsLockedByCurrentThread());
+	
+	for (cChunkPtrs::iterator itr = m_TickList.begin(), end = m_TickList.end(); itr != end; ++itr)
+	{
+		(*itr)->TickBeforeSimulators();
+	}  // for itr - m_TickList[]
+	
+	// Split the chunks into the tick regions, m_TickList is sorted by phase and region.
+	// The regions' random generators are seeded in the tick order, so that the numbers don't depend on the thread timing:
+	cChunkTickRegions Regions;
+	cChunkTickRegions PhaseRegions[4];
+	for (cChunkPtrs::iterator itr = m_TickList.begin(), end = m_TickList.end(); itr != end; ++itr)
+	{
+		int RegionX = FAST_FLOOR_DIV((*itr)->GetPosX(), TICK_REGION_SIZE);
+		int RegionZ = FAST_FLOOR_DIV((*itr)->GetPosZ(), TICK_REGION_SIZE);
+		if (Regions.empty() || (Regions.back()->GetRegionX() != RegionX) || (Regions.back()->GetRegionZ() != RegionZ))
+		{
+			cChunkTickRegion * Region = new cChunkTickRegion(RegionX, RegionZ, (unsigned)m_World->GetTickRandomNumber(0xffffffff));
+			Regions.push_back(Region);
+			PhaseRegions[(RegionX & 1) | ((RegionZ & 1) << 1)].push_back(Region);
+		}
+		Regions.back()->AddChunk(*itr);
+	}  // for itr - m_TickList[]
+	
+	for (size_t i = 0; i < ARRAYCOUNT(PhaseRegions); i++)
+	{
+		m_TickThreads.TickRegions(PhaseRegions[i], a_Dt);
+	}
+	
+	// Merge step: run what the regions have deferred, in the tick order:
+	for (cChunkTickRegions::iterator itr = Regions.begin(), end = Regions.end(); itr != end; ++itr)
+	{
+		(*itr)->RunDeferredActions();
+		delete *itr;
+	}  // for itr - Regions[]
+	
+	cSimulatorManager * SimulatorManager = m_World->GetSimulatorManager();
+	for (cChunkPtrs::iterator itr = m_TickList.begin(), end = m_TickList.end(); itr != end; ++itr)
+	{
+		SimulatorManager->SimulateChunk(a_Dt, (*itr)->GetPosX(), (*itr)->GetPosZ(), *itr, false);
+		(*itr)->TickAfterSimulators(a_Dt);
+	}  // for itr - m_TickList[]
 }
 
 
@@ -2641,14 +2894,14 @@ void cChunkMap::cChunkLayer::SpawnMobs(cMobSpawner& a_MobSpawner)
 
 
 
-void cChunkMap::cChunkLayer::Tick(float a_Dt)
+void cChunkMap::cChunkLayer::CollectTickableChunks(cChunkPtrs & a_Chunks)
 {
 	for (size_t i = 0; i < ARRAYCOUNT(m_Chunks); i++)
 	{
 		// Only tick chunks that are valid and have clients:
 		if ((m_Chunks[i] != NULL) && m_Chunks[i]->IsValid() && m_Chunks[i]->HasAnyClients())
 		{
-			m_Chunks[i]->Tick(a_Dt);
+			a_Chunks.push_back(m_Chunks[i]);
 		}
 	}  // for i - m_Chunks[]
 }
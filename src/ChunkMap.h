@@ -6,6 +6,7 @@
 #pragma once
 
 #include "ChunkDef.h"
+#include "ChunkTickRegion.h"
 
 
 
@@ -31,6 +32,8 @@ class cChunkDataSerializer;
 class cBlockArea;
 class cMobCensus;
 class cMobSpawner;
+class cExplosion;
+class cCommandOutputCallback;
 
 typedef std::list<cClientHandle *>  cClientHandleList;
 typedef cChunk * cChunkPtr;
@@ -54,6 +57,11 @@ class cChunkMap
 public:
 
 	static const int LAYER_SIZE = 32;
+	
+	/** Size of the tick regions, in chunks along each side.
+	Chunks are ticked region by region, in 4 phases based on the region coords' parity. Regions within a single phase
+	are always separated by a whole region of the other phases, so they don't touch each other's neighbors. */
+	static const int TICK_REGION_SIZE = 4;
 
 	cChunkMap(cWorld* a_World );
 	~cChunkMap();
@@ -223,6 +231,12 @@ public:
 	
 	/** Calls the callback for the block entity at the specified coords; returns false if there's no block entity at those coords, true if found */
 	bool DoWithBlockEntityAt(int a_BlockX, int a_BlockY, int a_BlockZ, cBlockEntityCallback & a_Callback);  // Lua-acessible
+	
+	/** Wakes up the block entity, so that its chunk ticks it again */
+	void WakeUpBlockEntity(cBlockEntity & a_BlockEntity);
+	
+	/** Wakes up the block entities of all 6 neighbors of the specified block */
+	void WakeUpBlockEntityNeighbors(int a_BlockX, int a_BlockY, int a_BlockZ);
 
 	/** Calls the callback for the chest at the specified coords; returns false if there's no chest at those coords, true if found */
 	bool DoWithChestAt(int a_BlockX, int a_BlockY, int a_BlockZ, cChestCallback & a_Callback);  // Lua-acessible
@@ -268,7 +282,8 @@ public:
 	
 	bool IsChunkLighted(int a_ChunkX, int a_ChunkZ);
 	
-	/** Calls the callback for each chunk in the coords specified (all cords are inclusive). Returns true if all chunks have been processed successfully */
+	/** Calls the callback for each chunk in the coords specified (all cords are inclusive). Returns true if all chunks have been processed successfully.
+	The chunkmap is locked for each chunk separately, other threads may modify the chunks in between. */
 	bool ForEachChunkInRect(int a_MinChunkX, int a_MaxChunkX, int a_MinChunkZ, int a_MaxChunkZ, cChunkDataCallback & a_Callback);
 	
 	/** Writes the block area into the specified coords. Returns true if all chunks have been processed. Prefer cBlockArea::Write() instead. */
@@ -277,6 +292,12 @@ public:
 	/** Returns the number of valid chunks and the number of dirty chunks */
 	void GetChunkStats(int & a_NumChunksValid, int & a_NumChunksDirty);
 	
+	/** Outputs the number of awake and sleeping block entities in the ticked chunks, and the chunks with the most awake ones */
+	void LogBlockEntityStats(cCommandOutputCallback & a_Output);
+	
+	/** Returns the number of chunks loaded in the specified layer (32 x 32 chunks, same as an Anvil region) */
+	int GetNumChunksInLayer(int a_LayerX, int a_LayerZ);
+	
 	/** Grows a melon or a pumpkin next to the block specified (assumed to be the stem) */
 	void GrowMelonPumpkin(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, MTRand & a_Rand);
 	
@@ -297,6 +318,9 @@ public:
 
 	void Tick(float a_Dt);
 	
+	/** Starts the threads for the parallel tick mode, see cChunkTickRegion. With zero threads, the chunks are ticked sequentially. */
+	void StartTickThreads(int a_NumThreads) { m_TickThreads.Start(a_NumThreads); }
+	
 	/** Ticks a single block. Used by cWorld::TickQueuedBlocks() to tick the queued blocks */
 	void TickBlock(int a_BlockX, int a_BlockY, int a_BlockZ);
 
@@ -323,6 +347,7 @@ private:
 	// The chunkstay can (de-)register itself using AddChunkStay() and DelChunkStay()
 	friend class cChunkStay;
 	
+	typedef std::vector<cChunk *> cChunkPtrs;
 
 	class cChunkLayer
 	{
@@ -351,7 +376,8 @@ private:
 		/** Try to Spawn Monsters inside all Chunks */
 		void SpawnMobs(cMobSpawner& a_MobSpawner);
 
-		void Tick(float a_Dt);
+		/** Adds all the chunks that should be ticked (valid and with clients) to a_Chunks */
+		void CollectTickableChunks(cChunkPtrs & a_Chunks);
 		
 		void RemoveClient(cClientHandle * a_Client);
 		
@@ -393,6 +419,15 @@ private:
 
 	cCriticalSection m_CSLayers;
 	cChunkLayerList  m_Layers;
+	
+	/** The chunks to be ticked in the current tick, in the tick order. Only used within Tick(), kept as a member to avoid reallocation */
+	cChunkPtrs m_TickList;
+	
+	/** The worker threads of the parallel tick mode; none if the mode is disabled */
+	cChunkTickThreads m_TickThreads;
+	
+	/** Ticks the chunks in m_TickList in the parallel tick mode, with the region-local part of each tick region in m_TickThreads */
+	void TickParallel(float a_Dt);
 	cEvent           m_evtChunkValid;  // Set whenever any chunk becomes valid, via ChunkValidated()
 
 	cWorld * m_World;
@@ -432,6 +467,11 @@ private:
 	/** Removes the specified cChunkStay descendant from the internal list of ChunkStays.
 	To be used only by cChunkStay; others should use cChunkStay::Disable() instead */
 	void DelChunkStay(cChunkStay & a_ChunkStay);
+
+	/** Applies the blocks changed by the explosion in one batch per chunk and wakes up the simulators for them.
+	Then primes the destroyed TNT and spawns the pickups of the destroyed blocks, merged into a single spawn per chunk.
+	Adds the destroyed blocks to a_BlocksAffected. */
+	void ApplyExplosion(const cExplosion & a_Explosion, cVector3iArray & a_BlocksAffected);
 	
 };
 
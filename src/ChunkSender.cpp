@@ -12,6 +12,7 @@
 #include "World.h"
 #include "BlockEntities/BlockEntity.h"
 #include "Protocol/ChunkDataSerializer.h"
+#include "CommandOutput.h"
 
 
 
@@ -36,7 +37,13 @@ cChunkSender::cChunkSender(void) :
 	super("ChunkSender"),
 	m_World(NULL),
 	m_RemoveCount(0),
-	m_Notify(NULL)
+	m_Notify(NULL),
+	m_NumBroadcast(0),
+	m_NumSentToClient(0),
+	m_NumSkipped(0),
+	m_TotalQueueWait(0),
+	m_MaxQueueWait(0),
+	m_TotalSendTime(0)
 {
 	m_Notify.SetChunkSender(this);
 }
@@ -100,7 +107,7 @@ void cChunkSender::QueueSendChunkTo(int a_ChunkX, int a_ChunkZ, cClientHandle *
 			// Already queued, bail out
 			return;
 		}
-		m_SendChunks.push_back(sSendChunk(a_ChunkX, ZERO_CHUNK_Y, a_ChunkZ, a_Client));
+		m_SendChunks.push_back(sSendChunk(a_ChunkX, ZERO_CHUNK_Y, a_ChunkZ, a_Client, m_Timer.GetNowTime()));
 	}
 	m_evtQueue.Set();
 }
@@ -160,7 +167,18 @@ void cChunkSender::Execute(void)
 			m_ChunksReady.pop_front();
 			Lock.Unlock();
 			
-			SendChunk(Coords.m_ChunkX, Coords.m_ChunkY, Coords.m_ChunkZ, NULL);
+			long long Start = m_Timer.GetNowTime();
+			bool IsSent = SendChunk(Coords.m_ChunkX, Coords.m_ChunkY, Coords.m_ChunkZ, NULL);
+			Lock.Lock();
+			if (IsSent)
+			{
+				m_NumBroadcast += 1;
+				m_TotalSendTime += m_Timer.GetNowTime() - Start;
+			}
+			else
+			{
+				m_NumSkipped += 1;
+			}
 		}
 		else
 		{
@@ -169,9 +187,22 @@ void cChunkSender::Execute(void)
 			m_SendChunks.pop_front();
 			Lock.Unlock();
 			
-			SendChunk(Chunk.m_ChunkX, Chunk.m_ChunkY, Chunk.m_ChunkZ, Chunk.m_Client);
+			long long Start = m_Timer.GetNowTime();
+			bool IsSent = SendChunk(Chunk.m_ChunkX, Chunk.m_ChunkY, Chunk.m_ChunkZ, Chunk.m_Client);
+			Lock.Lock();
+			if (IsSent)
+			{
+				long long Wait = Start - Chunk.m_QueuedTime;
+				m_NumSentToClient += 1;
+				m_TotalQueueWait += Wait;
+				m_MaxQueueWait = std::max(m_MaxQueueWait, Wait);
+				m_TotalSendTime += m_Timer.GetNowTime() - Start;
+			}
+			else
+			{
+				m_NumSkipped += 1;
+			}
 		}
-		Lock.Lock();
 		int RemoveCount = m_RemoveCount;
 		m_RemoveCount = 0;
 		Lock.Unlock();
@@ -186,7 +217,7 @@ void cChunkSender::Execute(void)
 
 
 
-void cChunkSender::SendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, cClientHandle * a_Client)
+bool cChunkSender::SendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, cClientHandle * a_Client)
 {
 	ASSERT(m_World != NULL);
 	
@@ -195,35 +226,35 @@ void cChunkSender::SendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, cClientHa
 	{
 		if (!a_Client->WantsSendChunk(a_ChunkX, a_ChunkY, a_ChunkZ))
 		{
-			return;
+			return false;
 		}
 	}
 	
 	// If the chunk has no clients, no need to packetize it:
 	if (!m_World->HasChunkAnyClients(a_ChunkX, a_ChunkZ))
 	{
-		return;
+		return false;
 	}
 	
 	// If the chunk is not valid, do nothing - whoever needs it has queued it for loading / generating
 	if (!m_World->IsChunkValid(a_ChunkX, a_ChunkZ))
 	{
-		return;
+		return false;
 	}
 	
 	// If the chunk is not lighted, queue it for relighting and get notified when it's ready:
 	if (!m_World->IsChunkLighted(a_ChunkX, a_ChunkZ))
 	{
 		m_World->QueueLightChunk(a_ChunkX, a_ChunkZ, &m_Notify);
-		return;
+		return false;
 	}
 	
 	// Query and prepare chunk data:
 	if (!m_World->GetChunkData(a_ChunkX, a_ChunkZ, *this))
 	{
-		return;
+		return false;
 	}
-	cChunkDataSerializer Data(m_BlockTypes, m_BlockMetas, m_BlockLight, m_BlockSkyLight, m_BiomeMap);
+	cChunkDataSerializer Data(m_BlockTypes, m_BlockMetas, m_BlockLight, m_BlockSkyLight, m_BiomeMap, m_World->GetNetworkCompressor());
 	
 	// Send:
 	if (a_Client == NULL)
@@ -250,6 +281,35 @@ void cChunkSender::SendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, cClientHa
 	m_BlockEntities.clear();
 	
 	// TODO: Send entity spawn packets
+	return true;
+}
+
+
+
+
+
+void cChunkSender::LogStats(cCommandOutputCallback & a_Output)
+{
+	cCSLock Lock(m_CS);
+	a_Output.Out("  Chunk sender: %d chunks ready to broadcast, %d chunks queued for single clients",
+		(int)m_ChunksReady.size(), (int)m_SendChunks.size()
+	);
+	if (!m_SendChunks.empty())
+	{
+		a_Output.Out("    oldest queued chunk waiting for %lld msec", m_Timer.GetNowTime() - m_SendChunks.front().m_QueuedTime);
+	}
+	a_Output.Out("    sent %lld chunks broadcast, %lld chunks to single clients, skipped %lld chunks",
+		m_NumBroadcast, m_NumSentToClient, m_NumSkipped
+	);
+	long long NumSent = m_NumBroadcast + m_NumSentToClient;
+	if (NumSent == 0)
+	{
+		return;
+	}
+	a_Output.Out("    queue wait per chunk: average %.1f msec, max %lld msec; sending took %.2f msec per chunk",
+		(m_NumSentToClient > 0) ? ((double)m_TotalQueueWait / m_NumSentToClient) : 0.0, m_MaxQueueWait,
+		(double)m_TotalSendTime / NumSent
+	);
 }
 
 
@@ -26,6 +26,7 @@ Note that it may be called by world's BroadcastToChunk() if the client is still
 #pragma once
 
 #include "OSSupport/IsThread.h"
+#include "OSSupport/Timer.h"
 #include "ChunkDef.h"
 
 
@@ -34,6 +35,7 @@ Note that it may be called by world's BroadcastToChunk() if the client is still
 
 class cWorld;
 class cClientHandle;
+class cCommandOutputCallback;
 
 
 
@@ -88,6 +90,9 @@ public:
 	/// Removes the a_Client from all waiting chunk send operations
 	void RemoveClient(cClientHandle * a_Client);
 	
+	/** Outputs the queue lengths and the number of chunks sent, with the time they waited in the queue */
+	void LogStats(cCommandOutputCallback & a_Output);
+	
 protected:
 
 	/// Used for sending chunks to specific clients
@@ -97,12 +102,14 @@ protected:
 		int m_ChunkY;
 		int m_ChunkZ;
 		cClientHandle * m_Client;
+		long long m_QueuedTime;  ///< The cTimer time when the chunk was queued; not compared by operator ==
 		
-		sSendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, cClientHandle * a_Client) :
+		sSendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, cClientHandle * a_Client, long long a_QueuedTime = 0) :
 			m_ChunkX(a_ChunkX),
 			m_ChunkY(a_ChunkY),
 			m_ChunkZ(a_ChunkZ),
-			m_Client(a_Client)
+			m_Client(a_Client),
+			m_QueuedTime(a_QueuedTime)
 		{
 		}
 		
@@ -145,6 +152,16 @@ protected:
 	
 	cNotifyChunkSender m_Notify;  // Used for chunks that don't have a valid lighting - they will be re-queued after lightcalc
 	
+	cTimer m_Timer;
+	
+	// Statistics, protected by m_CS:
+	long long m_NumBroadcast;    ///< Number of chunks sent to all their clients (ChunkReady())
+	long long m_NumSentToClient; ///< Number of chunks sent to a single client (QueueSendChunkTo())
+	long long m_NumSkipped;      ///< Number of chunks taken from the queue but not sent (unwanted by then, not valid or not lighted yet)
+	long long m_TotalQueueWait;  ///< Sum of the msec the chunks sent to a single client have waited in m_SendChunks
+	long long m_MaxQueueWait;    ///< The longest msec a chunk sent to a single client has waited in m_SendChunks
+	long long m_TotalSendTime;   ///< Sum of the msec spent in SendChunk() for the sent chunks (serializing and compressing)
+	
 	// Data about the chunk that is being sent:
 	// NOTE that m_BlockData[] is inherited from the cChunkDataCollector
 	unsigned char m_BiomeMap[cChunkDef::Width * cChunkDef::Width];
@@ -160,8 +177,8 @@ protected:
 	virtual void Entity       (cEntity *      a_Entity) override;
 	virtual void BlockEntity  (cBlockEntity * a_Entity) override;
 
-	/// Sends the specified chunk to a_Client, or to all chunk clients if a_Client == NULL
-	void SendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, cClientHandle * a_Client);
+	/// Sends the specified chunk to a_Client, or to all chunk clients if a_Client == NULL. Returns true if the chunk was sent
+	bool SendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, cClientHandle * a_Client);
 } ;
 
 
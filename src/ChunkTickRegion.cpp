@@ -0,0 +1,263 @@
+
+// ChunkTickRegion.cpp
+
+// Implements the cChunkTickRegion class representing a group of chunks that is ticked as a unit in the parallel tick mode,
+// and the cChunkTickThreads class representing the pool of threads that ticks the regions
+
+#include "Globals.h"
+#include "ChunkTickRegion.h"
+#include "ChunkMap.h"
+#include "Chunk.h"
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cChunkTickRegion:
+
+cChunkTickRegion::cChunkTickRegion(int a_RegionX, int a_RegionZ, unsigned a_RandomSeed) :
+	m_RegionX(a_RegionX),
+	m_RegionZ(a_RegionZ),
+	m_Random(a_RandomSeed)
+{
+}
+
+
+
+
+
+cChunkTickRegion::~cChunkTickRegion()
+{
+	for (cDeferredActions::iterator itr = m_DeferredActions.begin(), end = m_DeferredActions.end(); itr != end; ++itr)
+	{
+		delete *itr;
+	}
+}
+
+
+
+
+
+bool cChunkTickRegion::IsInRegion(int a_ChunkX, int a_ChunkZ) const
+{
+	return (
+		(FAST_FLOOR_DIV(a_ChunkX, cChunkMap::TICK_REGION_SIZE) == m_RegionX) &&
+		(FAST_FLOOR_DIV(a_ChunkZ, cChunkMap::TICK_REGION_SIZE) == m_RegionZ)
+	);
+}
+
+
+
+
+
+void cChunkTickRegion::Tick(float a_Dt)
+{
+	for (cChunkPtrs::iterator itr = m_Chunks.begin(), end = m_Chunks.end(); itr != end; ++itr)
+	{
+		(*itr)->TickInRegion(*this, a_Dt);
+	}
+}
+
+
+
+
+
+void cChunkTickRegion::RunDeferredActions(void)
+{
+	// The actions may not defer any more actions, they run outside of the region, so the list stays the same:
+	for (cDeferredActions::iterator itr = m_DeferredActions.begin(), end = m_DeferredActions.end(); itr != end; ++itr)
+	{
+		(*itr)->Run();
+		delete *itr;
+	}
+	m_DeferredActions.clear();
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cChunkTickThreads::cThread:
+
+cChunkTickThreads::cThread::cThread(cChunkTickThreads & a_Parent) :
+	super("cChunkTickThreads::cThread"),
+	m_Parent(a_Parent)
+{
+}
+
+
+
+
+
+cChunkTickThreads::cThread::~cThread()
+{
+	Stop();
+}
+
+
+
+
+
+void cChunkTickThreads::cThread::Stop(void)
+{
+	m_ShouldTerminate = true;
+	m_evtStart.Set();
+	Wait();
+}
+
+
+
+
+
+void cChunkTickThreads::cThread::Execute(void)
+{
+	for (;;)
+	{
+		m_evtStart.Wait();
+		if (m_ShouldTerminate)
+		{
+			return;
+		}
+		m_Parent.ProcessRegions();
+		m_Parent.ThreadFinished();
+	}
+}
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cChunkTickThreads:
+
+cChunkTickThreads::cChunkTickThreads(void) :
+	m_Regions(NULL),
+	m_NextRegion(0),
+	m_NumBusyThreads(0),
+	m_Dt(0)
+{
+}
+
+
+
+
+
+cChunkTickThreads::~cChunkTickThreads()
+{
+	Stop();
+}
+
+
+
+
+
+void cChunkTickThreads::Start(int a_NumThreads)
+{
+	ASSERT(m_Threads.empty());  // Already started?
+
+	for (int i = 0; i < a_NumThreads; i++)
+	{
+		cThread * Thread = new cThread(*this);
+		if (!Thread->Start())
+		{
+			LOGWARNING("Cannot start chunk tick thread #%d, continuing with %d threads", i + 1, i);
+			delete Thread;
+			break;
+		}
+		m_Threads.push_back(Thread);
+	}
+}
+
+
+
+
+
+void cChunkTickThreads::Stop(void)
+{
+	for (cThreads::iterator itr = m_Threads.begin(), end = m_Threads.end(); itr != end; ++itr)
+	{
+		delete *itr;
+	}
+	m_Threads.clear();
+}
+
+
+
+
+
+void cChunkTickThreads::TickRegions(cChunkTickRegions & a_Regions, float a_Dt)
+{
+	ASSERT(!IsTicking());  // Only one phase can be ticked at a time
+
+	if (a_Regions.empty())
+	{
+		return;
+	}
+
+	// Wake up only as many threads as there are regions for them, the calling thread takes one of the regions as well:
+	int NumThreads = std::min((int)m_Threads.size(), (int)a_Regions.size() - 1);
+	{
+		cCSLock Lock(m_CS);
+		m_Regions = &a_Regions;
+		m_NextRegion = 0;
+		m_NumBusyThreads = NumThreads;
+		m_Dt = a_Dt;
+	}
+	for (int i = 0; i < NumThreads; i++)
+	{
+		m_Threads[i]->StartTicking();
+	}
+
+	ProcessRegions();
+
+	if (NumThreads > 0)
+	{
+		m_evtFinished.Wait();
+	}
+
+	cCSLock Lock(m_CS);
+	m_Regions = NULL;
+}
+
+
+
+
+
+void cChunkTickThreads::ProcessRegions(void)
+{
+	for (;;)
+	{
+		cChunkTickRegion * Region;
+		{
+			cCSLock Lock(m_CS);
+			if (m_NextRegion >= m_Regions->size())
+			{
+				break;
+			}
+			Region = (*m_Regions)[m_NextRegion];
+			m_NextRegion += 1;
+		}
+		Region->Tick(m_Dt);
+	}
+}
+
+
+
+
+
+void cChunkTickThreads::ThreadFinished(void)
+{
+	cCSLock Lock(m_CS);
+	ASSERT(m_NumBusyThreads > 0);
+	m_NumBusyThreads -= 1;
+	if (m_NumBusyThreads == 0)
+	{
+		m_evtFinished.Set();
+	}
+}
+
+
+
+
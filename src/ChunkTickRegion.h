@@ -0,0 +1,186 @@
+
+// ChunkTickRegion.h
+
+// Declares the cChunkTickRegion class representing a group of chunks that is ticked as a unit in the parallel tick mode,
+// and the cChunkTickThreads class representing the pool of threads that ticks the regions
+
+/*
+In the parallel tick mode, cChunkMap::Tick() splits the chunks into the tick regions (see cChunkMap::TICK_REGION_SIZE)
+and ticks the region-local part of each chunk (the simulators that report IsRegionLocal()) region by region, with the
+regions of one phase spread over the threads. The regions of a single phase don't touch each other's neighbors, but
+there are things a region still must not do from a worker thread:
+	- call plugin hooks, or anything else that goes through cWorld / cChunkMap and would need the chunkmap lock
+	- use the world's m_TickRand, its sequence would depend on the thread timing
+	- write blocks into chunks of other regions (cChunk::UnboundedRelSetBlock())
+	- spawn or move entities
+These are either done through the region (GetRandomNumber()) or queued as a cDeferredAction, which is run in the tick
+thread once all the phases are finished, region by region in the tick order. The rest of the chunk tick (block ticks,
+block entities, entities, the other simulators) runs in the tick thread afterwards, as in the sequential mode.
+*/
+
+
+
+
+
+#pragma once
+
+#include "OSSupport/IsThread.h"
+#include "MersenneTwister.h"
+
+
+
+
+
+// fwd:
+class cChunk;
+
+
+
+
+
+class cChunkTickRegion
+{
+public:
+	/** An action that a chunk's region-local tick can't do in a worker thread; it is run in the tick thread after all
+	the tick regions have been ticked */
+	class cDeferredAction
+	{
+	public:
+		virtual ~cDeferredAction() {}
+
+		/** Runs the action, in the tick thread, with the chunkmap locked. The action object is deleted afterwards. */
+		virtual void Run(void) = 0;
+	} ;
+
+
+	cChunkTickRegion(int a_RegionX, int a_RegionZ, unsigned a_RandomSeed);
+
+	/** Deletes the deferred actions that haven't been run */
+	~cChunkTickRegion();
+
+	int GetRegionX(void) const { return m_RegionX; }
+	int GetRegionZ(void) const { return m_RegionZ; }
+
+	/** Adds the chunk to the region; the chunks are ticked in the order in which they were added */
+	void AddChunk(cChunk * a_Chunk) { m_Chunks.push_back(a_Chunk); }
+
+	/** Returns true if the specified chunk belongs to this region */
+	bool IsInRegion(int a_ChunkX, int a_ChunkZ) const;
+
+	/** Returns a random number in range [0 .. a_Range], to be used instead of the world's m_TickRand while ticking the region */
+	int GetRandomNumber(unsigned a_Range) { return (int)(m_Random.randInt(a_Range)); }
+
+	/** Queues the action to be run in the tick thread after all the regions have been ticked. Takes ownership of a_Action. */
+	void Defer(cDeferredAction * a_Action) { m_DeferredActions.push_back(a_Action); }
+
+	/** Ticks the region-local part of all the chunks in the region */
+	void Tick(float a_Dt);
+
+	/** Runs the deferred actions in the order in which they were queued, then deletes them */
+	void RunDeferredActions(void);
+
+protected:
+	typedef std::vector<cChunk *> cChunkPtrs;
+	typedef std::vector<cDeferredAction *> cDeferredActions;
+
+	int m_RegionX;
+	int m_RegionZ;
+
+	cChunkPtrs m_Chunks;
+
+	/** Seeded from the world's m_TickRand in the tick thread, so that the numbers don't depend on the thread timing */
+	MTRand m_Random;
+
+	cDeferredActions m_DeferredActions;
+} ;
+
+typedef std::vector<cChunkTickRegion *> cChunkTickRegions;
+
+
+
+
+
+class cChunkTickThreads
+{
+public:
+	cChunkTickThreads(void);
+
+	/** Stops the threads */
+	~cChunkTickThreads();
+
+	/** Starts the specified number of worker threads. Zero threads means the parallel tick mode is disabled. */
+	void Start(int a_NumThreads);
+
+	/** Stops all the worker threads */
+	void Stop(void);
+
+	/** Returns true if the parallel tick mode is enabled (there are worker threads to tick the regions) */
+	bool IsEnabled(void) const { return !m_Threads.empty(); }
+
+	/** Returns true while TickRegions() is ticking the regions */
+	bool IsTicking(void) const { return (m_Regions != NULL); }
+
+	/** Ticks all the regions, spread over the worker threads and the calling thread. Returns once all of them are ticked.
+	The regions must not touch each other's neighbors, i. e. they must all belong to a single tick phase. */
+	void TickRegions(cChunkTickRegions & a_Regions, float a_Dt);
+
+protected:
+	class cThread :
+		public cIsThread
+	{
+		typedef cIsThread super;
+
+	public:
+		cThread(cChunkTickThreads & a_Parent);
+
+		/** Stops the thread */
+		virtual ~cThread();
+
+		/** Signals the thread to terminate and waits for it to finish */
+		void Stop(void);
+
+		/** Wakes the thread up to tick the regions from its parent */
+		void StartTicking(void) { m_evtStart.Set(); }
+
+	protected:
+		cChunkTickThreads & m_Parent;
+
+		/** Set when there are regions to tick, or to stop the thread */
+		cEvent m_evtStart;
+
+		// cIsThread override:
+		virtual void Execute(void) override;
+	} ;
+
+	typedef std::vector<cThread *> cThreads;
+
+	cThreads m_Threads;
+
+	/** Protects m_NextRegion and m_NumBusyThreads */
+	cCriticalSection m_CS;
+
+	/** The regions being ticked by TickRegions(), NULL when not ticking */
+	cChunkTickRegions * volatile m_Regions;
+
+	/** The index into m_Regions of the next region to be ticked */
+	size_t m_NextRegion;
+
+	/** The number of worker threads that have been woken up and haven't run out of regions yet */
+	int m_NumBusyThreads;
+
+	/** The a_Dt of the current TickRegions() call */
+	float m_Dt;
+
+	/** Set by the last worker thread that runs out of regions */
+	cEvent m_evtFinished;
+
+	/** Ticks the regions from m_Regions until there are none left. Called in both the worker threads and the tick thread. */
+	void ProcessRegions(void);
+
+	/** Called by each worker thread once it runs out of regions; the last one sets m_evtFinished */
+	void ThreadFinished(void);
+} ;
+
+
+
+
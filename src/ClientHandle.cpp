@@ -80,6 +80,7 @@ int cClientHandle::s_ClientCount = 0;
 cClientHandle::cClientHandle(const cSocket * a_Socket, int a_ViewDistance) :
 	m_ViewDistance(a_ViewDistance),
 	m_IPString(a_Socket->GetIPString()),
+	m_CSOutgoingData("cClientHandle::m_CSOutgoingData"),
 	m_OutgoingData(64 KiB),
 	m_Player(NULL),
 	m_HasSentDC(false),
@@ -449,9 +450,12 @@ bool cClientHandle::HandleLogin(int a_ProtocolVersion, const AString & a_Usernam
 		return false;
 	}
 
+	// Read the player's data while they're being authenticated:
+	cRoot::Get()->GetPlayerDataStore().Prefetch(a_Username);
+
 	// Schedule for authentication; until then, let them wait (but do not block)
 	m_State = csAuthenticating;
-	cRoot::Get()->GetAuthenticator().Authenticate(GetUniqueID(), GetUsername(), m_Protocol->GetAuthServerID());
+	cRoot::Get()->GetAuthenticator().Authenticate(GetUniqueID(), GetUsername(), GetIPString(), m_Protocol->GetAuthServerID());
 	return true;
 }
 
@@ -2470,6 +2474,16 @@ bool cClientHandle::WantsSendChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ)
 
 
 
+int cClientHandle::GetNumChunksToSend(void)
+{
+	cCSLock Lock(m_CSChunkLists);
+	return (int)m_ChunksToSend.size();
+}
+
+
+
+
+
 void cClientHandle::AddWantedChunk(int a_ChunkX, int a_ChunkZ)
 {
 	if (m_State >= csDestroying)
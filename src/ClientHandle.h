@@ -167,6 +167,9 @@ public:
 	/// Adds the chunk specified to the list of chunks wanted for sending (m_ChunksToSend)
 	void AddWantedChunk(int a_ChunkX, int a_ChunkZ);
 	
+	/** Returns the number of chunks in view that haven't been sent to the client yet (m_ChunksToSend) */
+	int GetNumChunksToSend(void);
+	
 	// Calls that cProtocol descendants use to report state:
 	void PacketBufferFull(void);
 	void PacketUnknown(UInt32 a_PacketType);
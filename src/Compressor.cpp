@@ -0,0 +1,416 @@
+
+// Compressor.cpp
+
+// Implements the cCompressor class representing a single compression path (storage, network) with a selectable codec and its statistics
+
+#include "Globals.h"
+#include "Compressor.h"
+#include "StringCompression.h"
+#include "CommandOutput.h"
+
+#ifndef _WIN32
+	#include <time.h>
+#endif
+
+
+
+
+
+/** The first byte of the LZ-compressed data. A zlib stream always starts with a byte whose lower nibble is 8 (deflate), so this never starts one. */
+#define LZ_MARKER 'L'
+
+/** Size of the LZ header: the marker and the uncompressed size (32-bit little endian) */
+#define LZ_HEADER_SIZE 5
+
+/** Shortest match that the LZ codec encodes; also the number of bytes hashed for the match search */
+#define LZ_MIN_MATCH 4
+
+/** Largest distance of a match; the offsets are stored in two bytes */
+#define LZ_MAX_OFFSET 65535
+
+/** Number of bits of the match-search hash table index */
+#define LZ_HASH_BITS 12
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The LZ codec:
+
+/*
+The LZ data is a sequence of (literals, match) pairs. Each pair starts with a token byte: the upper nibble is the
+number of literals, the lower nibble is the match length minus LZ_MIN_MATCH. A nibble value of 15 means that more
+length bytes follow, each adding its value, until a byte less than 255. The literals follow the token, then the
+2-byte little-endian match offset and the match length bytes. The last pair has only the literals.
+*/
+
+
+
+
+
+static inline UInt32 LZRead32(const Byte * a_Data)
+{
+	UInt32 res;
+	memcpy(&res, a_Data, sizeof(res));
+	return res;
+}
+
+
+
+
+
+static inline int LZHash(UInt32 a_Value)
+{
+	return (int)((a_Value * 2654435761U) >> (32 - LZ_HASH_BITS));
+}
+
+
+
+
+
+/** Appends the extra bytes of a length whose nibble has overflowed */
+static void LZWriteLength(AString & a_Out, int a_Length)
+{
+	for (a_Length -= 15; a_Length >= 255; a_Length -= 255)
+	{
+		a_Out.push_back((char)255);
+	}
+	a_Out.push_back((char)a_Length);
+}
+
+
+
+
+
+/** Appends one (literals, match) pair; a_MatchLength is 0 for the last pair */
+static void LZWriteSequence(AString & a_Out, const Byte * a_Literals, int a_NumLiterals, int a_Offset, int a_MatchLength)
+{
+	int LitNibble = std::min(a_NumLiterals, 15);
+	int MatchNibble = (a_MatchLength > 0) ? std::min(a_MatchLength - LZ_MIN_MATCH, 15) : 0;
+	a_Out.push_back((char)((LitNibble << 4) | MatchNibble));
+	if (LitNibble == 15)
+	{
+		LZWriteLength(a_Out, a_NumLiterals);
+	}
+	a_Out.append((const char *)a_Literals, a_NumLiterals);
+	if (a_MatchLength == 0)
+	{
+		return;
+	}
+	a_Out.push_back((char)(a_Offset & 0xff));
+	a_Out.push_back((char)(a_Offset >> 8));
+	if (MatchNibble == 15)
+	{
+		LZWriteLength(a_Out, a_MatchLength - LZ_MIN_MATCH);
+	}
+}
+
+
+
+
+
+static void CompressLZ(const char * a_Data, int a_Length, AString & a_Compressed)
+{
+	const Byte * Data = (const Byte *)a_Data;
+
+	a_Compressed.clear();
+	a_Compressed.reserve(LZ_HEADER_SIZE + a_Length + a_Length / 255 + 16);
+	a_Compressed.push_back(LZ_MARKER);
+	for (int i = 0; i < 4; i++)
+	{
+		a_Compressed.push_back((char)((a_Length >> (8 * i)) & 0xff));
+	}
+
+	// The hash table stores the last position of each hashed 4-byte sequence:
+	int HashTable[1 << LZ_HASH_BITS];
+	for (size_t i = 0; i < ARRAYCOUNT(HashTable); i++)
+	{
+		HashTable[i] = -1;
+	}
+
+	int Anchor = 0;  // Start of the literals not yet written
+	int Pos = 0;
+	while (Pos + LZ_MIN_MATCH <= a_Length)
+	{
+		UInt32 Sequence = LZRead32(Data + Pos);
+		int Hash = LZHash(Sequence);
+		int Candidate = HashTable[Hash];
+		HashTable[Hash] = Pos;
+		if ((Candidate < 0) || (Pos - Candidate > LZ_MAX_OFFSET) || (LZRead32(Data + Candidate) != Sequence))
+		{
+			Pos++;
+			continue;
+		}
+
+		// Found a match, extend it as far as possible:
+		int MatchLength = LZ_MIN_MATCH;
+		while ((Pos + MatchLength < a_Length) && (Data[Candidate + MatchLength] == Data[Pos + MatchLength]))
+		{
+			MatchLength++;
+		}
+		LZWriteSequence(a_Compressed, Data + Anchor, Pos - Anchor, Pos - Candidate, MatchLength);
+		Pos += MatchLength;
+		Anchor = Pos;
+	}
+
+	// Write the trailing literals, if any:
+	if (Anchor < a_Length)
+	{
+		LZWriteSequence(a_Compressed, Data + Anchor, a_Length - Anchor, 0, 0);
+	}
+}
+
+
+
+
+
+/** Reads the extra bytes of a length whose nibble has overflowed; returns false if the data ends prematurely */
+static bool LZReadLength(const Byte *& a_Data, const Byte * a_End, int & a_Length)
+{
+	Byte b;
+	do
+	{
+		if (a_Data >= a_End)
+		{
+			return false;
+		}
+		b = *a_Data++;
+		a_Length += b;
+	} while (b == 255);
+	return true;
+}
+
+
+
+
+
+static int UncompressLZ(const char * a_Data, int a_Length, AString & a_Uncompressed, int a_UncompressedSize)
+{
+	if ((a_Length < LZ_HEADER_SIZE) || (a_Data[0] != LZ_MARKER))
+	{
+		return Z_DATA_ERROR;
+	}
+	const Byte * Src = (const Byte *)a_Data;
+	int Size = Src[1] | (Src[2] << 8) | (Src[3] << 16) | (Src[4] << 24);
+	if (Size != a_UncompressedSize)
+	{
+		return Z_DATA_ERROR;
+	}
+
+	// HACK: We're assuming that AString returns its internal buffer in its data() call and we're overwriting that buffer!
+	a_Uncompressed.resize(Size);
+	Byte * Dst = (Byte *)a_Uncompressed.data();
+	int DstPos = 0;
+	const Byte * End = Src + a_Length;
+	Src += LZ_HEADER_SIZE;
+	while (Src < End)
+	{
+		Byte Token = *Src++;
+
+		// Copy the literals:
+		int NumLiterals = Token >> 4;
+		if ((NumLiterals == 15) && !LZReadLength(Src, End, NumLiterals))
+		{
+			return Z_DATA_ERROR;
+		}
+		if ((NumLiterals > End - Src) || (NumLiterals > Size - DstPos))
+		{
+			return Z_DATA_ERROR;
+		}
+		memcpy(Dst + DstPos, Src, NumLiterals);
+		Src += NumLiterals;
+		DstPos += NumLiterals;
+		if (Src == End)
+		{
+			// The last sequence has no match
+			break;
+		}
+
+		// Copy the match; it may overlap the data being written, so copy byte-by-byte:
+		if (End - Src < 2)
+		{
+			return Z_DATA_ERROR;
+		}
+		int Offset = Src[0] | (Src[1] << 8);
+		Src += 2;
+		int MatchLength = Token & 0x0f;
+		if ((MatchLength == 15) && !LZReadLength(Src, End, MatchLength))
+		{
+			return Z_DATA_ERROR;
+		}
+		MatchLength += LZ_MIN_MATCH;
+		if ((Offset == 0) || (Offset > DstPos) || (MatchLength > Size - DstPos))
+		{
+			return Z_DATA_ERROR;
+		}
+		const Byte * Match = Dst + DstPos - Offset;
+		for (int i = 0; i < MatchLength; i++)
+		{
+			Dst[DstPos + i] = Match[i];
+		}
+		DstPos += MatchLength;
+	}
+	return (DstPos == Size) ? Z_OK : Z_DATA_ERROR;
+}
+
+
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cCompressor:
+
+cCompressor::cCompressor(const AString & a_Name, eCodec a_Codec, int a_Level) :
+	m_Name(a_Name),
+	m_Codec(a_Codec),
+	m_Level(std::min(std::max(a_Level, 0), 9)),
+	m_NumCalls(0),
+	m_NumBytesIn(0),
+	m_NumBytesOut(0),
+	m_NumMicroSec(0)
+{
+}
+
+
+
+
+
+void cCompressor::SetLevel(int a_Level)
+{
+	m_Level = std::min(std::max(a_Level, 0), 9);
+}
+
+
+
+
+
+cCompressor::eCodec cCompressor::StringToCodec(const AString & a_Name, eCodec a_Default)
+{
+	if (NoCaseCompare(a_Name, "zlib") == 0)
+	{
+		return codecZlib;
+	}
+	if (NoCaseCompare(a_Name, "lz") == 0)
+	{
+		return codecLZ;
+	}
+	return a_Default;
+}
+
+
+
+
+
+AString cCompressor::CodecToString(eCodec a_Codec)
+{
+	switch (a_Codec)
+	{
+		case codecZlib: return "zlib";
+		case codecLZ:   return "lz";
+	}
+	ASSERT(!"Unknown codec");
+	return "unknown";
+}
+
+
+
+
+
+int cCompressor::Compress(const char * a_Data, int a_Length, AString & a_Compressed)
+{
+	long long Start = GetThreadTimeMicroSec();
+	int res = Z_OK;
+	switch (m_Codec)
+	{
+		case codecZlib: res = CompressString(a_Data, a_Length, a_Compressed, m_Level); break;
+		case codecLZ:   CompressLZ(a_Data, a_Length, a_Compressed); break;
+	}
+	long long Duration = GetThreadTimeMicroSec() - Start;
+
+	if (res == Z_OK)
+	{
+		cCSLock Lock(m_CSStats);
+		m_NumCalls += 1;
+		m_NumBytesIn += a_Length;
+		m_NumBytesOut += a_Compressed.size();
+		m_NumMicroSec += Duration;
+	}
+	return res;
+}
+
+
+
+
+
+int cCompressor::Uncompress(const char * a_Data, int a_Length, AString & a_Uncompressed, int a_UncompressedSize)
+{
+	if ((a_Length > 0) && (a_Data[0] == LZ_MARKER))
+	{
+		return UncompressLZ(a_Data, a_Length, a_Uncompressed, a_UncompressedSize);
+	}
+	return UncompressString(a_Data, a_Length, a_Uncompressed, a_UncompressedSize);
+}
+
+
+
+
+
+void cCompressor::LogStats(cCommandOutputCallback & a_Output)
+{
+	long long NumCalls, NumBytesIn, NumBytesOut, NumMicroSec;
+	{
+		cCSLock Lock(m_CSStats);
+		NumCalls    = m_NumCalls;
+		NumBytesIn  = m_NumBytesIn;
+		NumBytesOut = m_NumBytesOut;
+		NumMicroSec = m_NumMicroSec;
+	}
+	AString Codec = CodecToString(m_Codec);
+	if (m_Codec == codecZlib)
+	{
+		AppendPrintf(Codec, " level %d", m_Level);
+	}
+	a_Output.Out("  %s (%s): %lld calls, %lld KiB -> %lld KiB",
+		m_Name.c_str(), Codec.c_str(), NumCalls, NumBytesIn / 1024, NumBytesOut / 1024
+	);
+	if (NumCalls == 0)
+	{
+		return;
+	}
+	a_Output.Out("    ratio %.2f, %.1f msec CPU in total, %.1f usec per call, %.1f MiB/s",
+		(NumBytesOut > 0) ? ((double)NumBytesIn / NumBytesOut) : 0.0,
+		NumMicroSec / 1000.0,
+		(double)NumMicroSec / NumCalls,
+		(NumMicroSec > 0) ? (NumBytesIn / 1.048576 / NumMicroSec) : 0.0
+	);
+}
+
+
+
+
+
+long long cCompressor::GetThreadTimeMicroSec(void)
+{
+	#if defined(_WIN32)
+		// The Windows thread times only have the scheduler granularity, use the wall clock; compressing doesn't block, so it is close
+		LARGE_INTEGER Freq, Now;
+		QueryPerformanceFrequency(&Freq);
+		QueryPerformanceCounter(&Now);
+		return (Now.QuadPart / Freq.QuadPart) * 1000000 + ((Now.QuadPart % Freq.QuadPart) * 1000000) / Freq.QuadPart;
+	#elif defined(CLOCK_THREAD_CPUTIME_ID)
+		struct timespec Now;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Now);
+		return (long long)Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+	#else
+		struct timeval Now;
+		gettimeofday(&Now, NULL);
+		return (long long)Now.tv_sec * 1000000 + Now.tv_usec;
+	#endif
+}
+
+
+
+
@@ -0,0 +1,88 @@
+
+// Compressor.h
+
+// Declares the cCompressor class representing a single compression path (storage, network) with a selectable codec and its statistics
+
+/*
+The LZ codec is a simple LZ77-class byte-oriented codec, several times faster than deflate at a worse ratio.
+Its output starts with a marker byte that can never start a zlib stream, so cCompressor::Uncompress() can tell
+the codecs apart and data written with either codec can be read back regardless of the current setting.
+Only MCServer's own formats may use it; the clients and the Anvil format understand zlib only.
+*/
+
+
+
+
+
+#pragma once
+
+#include "zlib/zlib.h"  // Needed for the Z_XXX return values
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+
+
+
+
+
+class cCompressor
+{
+public:
+	enum eCodec
+	{
+		codecZlib = 0,  ///< zlib stream at the configured level
+		codecLZ   = 1,  ///< The fast in-tree LZ codec; the level is ignored
+	} ;
+
+	/** Creates a new compression path. a_Name is used for the statistics output */
+	cCompressor(const AString & a_Name, eCodec a_Codec, int a_Level);
+
+	const AString & GetName (void) const { return m_Name; }
+	eCodec          GetCodec(void) const { return m_Codec; }
+	int             GetLevel(void) const { return m_Level; }
+
+	/** Sets the codec and level used for the subsequent compressions. Not synchronized with Compress(), meant to be called on startup */
+	void SetCodec(eCodec a_Codec) { m_Codec = a_Codec; }
+	void SetLevel(int a_Level);
+
+	/** Returns the codec for the specified name ("zlib" or "lz", case insensitive), or a_Default if the name is not recognized */
+	static eCodec StringToCodec(const AString & a_Name, eCodec a_Default);
+
+	/** Returns the name of the codec, as accepted by StringToCodec() */
+	static AString CodecToString(eCodec a_Codec);
+
+	/** Compresses a_Data into a_Compressed using the current codec and level and updates the statistics.
+	Returns Z_OK on success, or a Z_XXX error constant same as zlib's compress2(). Thread-safe. */
+	int Compress(const char * a_Data, int a_Length, AString & a_Compressed);
+
+	/** Uncompresses data created by Compress() with any codec; a_UncompressedSize is the expected size of the data.
+	Returns Z_OK on success, or a Z_XXX error constant same as zlib's uncompress() */
+	static int Uncompress(const char * a_Data, int a_Length, AString & a_Uncompressed, int a_UncompressedSize);
+
+	/** Outputs the statistics: number of calls, bytes in and out, the ratio and the CPU time spent compressing */
+	void LogStats(cCommandOutputCallback & a_Output);
+
+protected:
+	AString m_Name;
+	eCodec  m_Codec;
+	int     m_Level;
+
+	/** Protects the statistics below */
+	cCriticalSection m_CSStats;
+
+	long long m_NumCalls;
+	long long m_NumBytesIn;
+	long long m_NumBytesOut;
+	long long m_NumMicroSec;
+
+	/** Returns the CPU time used by the calling thread, in microseconds (wall time where not available) */
+	static long long GetThreadTimeMicroSec(void);
+} ;
+
+
+
+
@@ -138,6 +138,16 @@ void cPickup::Tick(float a_Dt, cChunk & a_Chunk)
 						m_World->BroadcastEntityMetadata(*this);
 					}
 				}
+				
+				// Wake up the hopper below, it sleeps while it has nothing to move:
+				if (BlockIn == E_BLOCK_HOPPER)
+				{
+					CurrentChunk->WakeUpBlockEntity(BlockX, BlockY, BlockZ);
+				}
+				else if (BlockBelow == E_BLOCK_HOPPER)
+				{
+					CurrentChunk->WakeUpBlockEntity(BlockX, BlockY - 1, BlockZ);
+				}
 			}
 		}
 	}
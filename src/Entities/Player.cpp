@@ -1276,34 +1276,7 @@ bool cPlayer::HasPermission(const AString & a_Permission)
 		return true;
 	}
 	
-	AStringVector Split = StringSplit( a_Permission, "." );
-	PermissionMap Possibilities = m_ResolvedPermissions;
-	// Now search the namespaces
-	while( Possibilities.begin() != Possibilities.end() )
-	{
-		PermissionMap::iterator itr = Possibilities.begin();
-		if( itr->second )
-		{
-			AStringVector OtherSplit = StringSplit( itr->first, "." );
-			if( OtherSplit.size() <= Split.size() )
-			{
-				unsigned int i;
-				for( i = 0; i < OtherSplit.size(); ++i )
-				{
-					if( OtherSplit[i].compare( Split[i] ) != 0 )
-					{
-						if( OtherSplit[i].compare("*") == 0 ) return true; // WildCard man!! WildCard!
-						break;
-					}
-				}
-				if( i == Split.size() ) return true;
-			}
-		}
-		Possibilities.erase( itr );
-	}
-
-	// Nothing that matched :(
-	return false;
+	return m_PermissionTrie.HasPermission(a_Permission);
 }
 
 
@@ -1342,6 +1315,16 @@ void cPlayer::ResolvePermissions()
 			m_ResolvedPermissions[ itr->first ] = itr->second;
 		}
 	}
+
+	// Compile the granted permissions for HasPermission():
+	m_PermissionTrie.Clear();
+	for (PermissionMap::const_iterator itr = m_ResolvedPermissions.begin(); itr != m_ResolvedPermissions.end(); ++itr)
+	{
+		if (itr->second)
+		{
+			m_PermissionTrie.Add(itr->first);
+		}
+	}
 }
 
 
@@ -1566,29 +1549,19 @@ bool cPlayer::LoadFromDisk()
 		if( itr->second ) LOG(" - %s", itr->first.c_str() );
 	}
 
-	AString SourceFile;
-	Printf(SourceFile, "players/%s.json", m_PlayerName.c_str() );
-
-	cFile f;
-	if (!f.Open(SourceFile, cFile::fmRead))
-	{
-		// This is a new player whom we haven't seen yet, bail out, let them have the defaults
-		return false;
-	}
-
+	// The data is usually prefetched during the login, or still waiting to be written if the player has just left:
 	AString buffer;
-	if (f.ReadRestOfFile(buffer) != f.GetSize())
+	if (!cRoot::Get()->GetPlayerDataStore().Load(m_PlayerName, buffer))
 	{
-		LOGWARNING("Cannot read player data from file \"%s\"", SourceFile.c_str()); 
+		// This is a new player whom we haven't seen yet, bail out, let them have the defaults
 		return false;
 	}
-	f.Close(); //cool kids play nice
 
 	Json::Value root;
 	Json::Reader reader;
 	if (!reader.parse(buffer, root, false))
 	{
-		LOGWARNING("Cannot parse player data in file \"%s\", player will be reset", SourceFile.c_str());
+		LOGWARNING("Cannot parse player data in file \"%s\", player will be reset", cPlayerDataStore::GetFileName(m_PlayerName).c_str());
 	}
 
 	Json::Value & JSON_PlayerPosition = root["position"];
@@ -1645,8 +1618,6 @@ bool cPlayer::LoadFromDisk()
 
 bool cPlayer::SaveToDisk()
 {
-	cFile::CreateFolder(FILE_IO_PREFIX + AString("players"));
-
 	// create the JSON data
 	Json::Value JSON_PlayerPosition;
 	JSON_PlayerPosition.append(Json::Value(GetPosX()));
@@ -1688,20 +1659,8 @@ bool cPlayer::SaveToDisk()
 	Json::StyledWriter writer;
 	std::string JsonData = writer.write(root);
 
-	AString SourceFile;
-	Printf(SourceFile, "players/%s.json", m_PlayerName.c_str() );
-
-	cFile f;
-	if (!f.Open(SourceFile, cFile::fmWrite))
-	{
-		LOGERROR("ERROR WRITING PLAYER \"%s\" TO FILE \"%s\" - cannot open file", m_PlayerName.c_str(), SourceFile.c_str());
-		return false;
-	}
-	if (f.Write(JsonData.c_str(), JsonData.size()) != (int)JsonData.size())
-	{
-		LOGERROR("ERROR WRITING PLAYER JSON TO FILE \"%s\"", SourceFile.c_str()); 
-		return false;
-	}
+	// The file is written in the background, so that many players leaving at once don't stall the tick thread:
+	cRoot::Get()->GetPlayerDataStore().QueueSave(m_PlayerName, JsonData);
 	return true;
 }
 
@@ -6,6 +6,7 @@
 #include "../Defines.h"
 #include "../World.h"
 #include "../ClientHandle.h"
+#include "../PermissionTrie.h"
 
 
 
@@ -373,6 +374,9 @@ protected:
 	PermissionMap m_ResolvedPermissions;
 	PermissionMap m_Permissions;
 
+	/** The granted permissions from m_ResolvedPermissions, compiled for fast checking in HasPermission() */
+	cPermissionTrie m_PermissionTrie;
+
 	GroupList m_ResolvedGroups;
 	GroupList m_Groups;
 
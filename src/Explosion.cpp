@@ -0,0 +1,177 @@
+
+// Explosion.cpp
+
+// Implements the cExplosion class that calculates which blocks an explosion affects
+
+#include "Globals.h"
+#include "Explosion.h"
+#include "BlockArea.h"
+#include "FastRandom.h"
+
+
+
+
+
+/** Number of rays along each edge of the cube whose surface the rays are cast towards */
+#define EXPLOSION_RAYS_PER_SIDE 16
+
+/** Length of a single step of a ray, in blocks */
+#define EXPLOSION_STEP 0.3
+
+/** How much intensity a ray loses in each step, regardless of the blocks it passes */
+#define EXPLOSION_STEP_DECAY 0.225f
+
+/** The maximum initial intensity of a ray, relative to the explosion size */
+#define EXPLOSION_MAX_INTENSITY 1.3f
+
+
+
+
+
+/** Orders the blocks by the chunk they are in */
+static bool IsInChunkOrder(const sSetBlock & a_Block1, const sSetBlock & a_Block2)
+{
+	if (a_Block1.ChunkX != a_Block2.ChunkX)
+	{
+		return (a_Block1.ChunkX < a_Block2.ChunkX);
+	}
+	return (a_Block1.ChunkZ < a_Block2.ChunkZ);
+}
+
+
+
+
+
+/** Returns the block at the specified absolute coords, with its chunk coords filled in */
+static sSetBlock MakeSetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
+{
+	int ChunkX, ChunkZ;
+	cChunkDef::AbsoluteToRelative(a_BlockX, a_BlockY, a_BlockZ, ChunkX, ChunkZ);
+	return sSetBlock(ChunkX, ChunkZ, a_BlockX, a_BlockY, a_BlockZ, a_BlockType, a_BlockMeta);
+}
+
+
+
+
+
+cExplosion::cExplosion(double a_Size, const Vector3d & a_Center) :
+	m_Size(a_Size),
+	m_Center(a_Center)
+{
+}
+
+
+
+
+
+void cExplosion::GetReach(int & a_MinX, int & a_MaxX, int & a_MinY, int & a_MaxY, int & a_MinZ, int & a_MaxZ) const
+{
+	// The strongest ray runs out after this many blocks even in air:
+	int Reach = (int)ceil(m_Size * EXPLOSION_MAX_INTENSITY / EXPLOSION_STEP_DECAY * EXPLOSION_STEP) + 1;
+	a_MinX = (int)floor(m_Center.x) - Reach;
+	a_MaxX = (int)floor(m_Center.x) + Reach;
+	a_MinY = std::max((int)floor(m_Center.y) - Reach, 0);
+	a_MaxY = std::min((int)floor(m_Center.y) + Reach, cChunkDef::Height - 1);
+	a_MinZ = (int)floor(m_Center.z) - Reach;
+	a_MaxZ = (int)floor(m_Center.z) + Reach;
+}
+
+
+
+
+
+void cExplosion::Calculate(const cBlockArea & a_Snapshot, cFastRandom & a_Random)
+{
+	m_DestroyedBlocks.clear();
+	m_ChangedBlocks.clear();
+
+	const BLOCKTYPE *  BlockTypes = a_Snapshot.GetBlockTypes();
+	const NIBBLETYPE * BlockMetas = a_Snapshot.GetBlockMetas();
+	int OriginX = a_Snapshot.GetOriginX();
+	int OriginY = a_Snapshot.GetOriginY();
+	int OriginZ = a_Snapshot.GetOriginZ();
+	int SizeX = a_Snapshot.GetSizeX();
+	int SizeY = a_Snapshot.GetSizeY();
+	int SizeZ = a_Snapshot.GetSizeZ();
+
+	// Blocks already affected by another ray:
+	std::vector<bool> IsAffected(a_Snapshot.GetBlockCount(), false);
+
+	const int Last = EXPLOSION_RAYS_PER_SIDE - 1;
+	for (int i = 0; i < EXPLOSION_RAYS_PER_SIDE; i++)
+	{
+		for (int j = 0; j < EXPLOSION_RAYS_PER_SIDE; j++)
+		{
+			for (int k = 0; k < EXPLOSION_RAYS_PER_SIDE; k++)
+			{
+				if ((i != 0) && (i != Last) && (j != 0) && (j != Last) && (k != 0) && (k != Last))
+				{
+					// Not on the surface of the cube
+					continue;
+				}
+
+				Vector3d Step((double)i / Last * 2 - 1, (double)j / Last * 2 - 1, (double)k / Last * 2 - 1);
+				Step.Normalize();
+				Step *= EXPLOSION_STEP;
+
+				Vector3d Pos(m_Center);
+				float Intensity = (float)m_Size * (EXPLOSION_MAX_INTENSITY - a_Random.NextFloat(0.6f));
+				while (Intensity > 0)
+				{
+					int BlockX = (int)floor(Pos.x);
+					int BlockY = (int)floor(Pos.y);
+					int BlockZ = (int)floor(Pos.z);
+					int RelX = BlockX - OriginX;
+					int RelY = BlockY - OriginY;
+					int RelZ = BlockZ - OriginZ;
+					if ((RelX < 0) || (RelX >= SizeX) || (RelY < 0) || (RelY >= SizeY) || (RelZ < 0) || (RelZ >= SizeZ))
+					{
+						// Outside the snapshot
+						break;
+					}
+
+					int Idx = a_Snapshot.MakeIndex(RelX, RelY, RelZ);
+					BLOCKTYPE BlockType = BlockTypes[Idx];
+					if (BlockType != E_BLOCK_AIR)
+					{
+						Intensity -= (g_BlockBlastResistance[BlockType] / 5 + 0.3f) * 0.3f;
+						if (!IsAffected[Idx])
+						{
+							switch (BlockType)
+							{
+								case E_BLOCK_STATIONARY_WATER:
+								case E_BLOCK_STATIONARY_LAVA:
+								{
+									// Stationary liquids aren't destroyed, but start flowing:
+									IsAffected[Idx] = true;
+									BLOCKTYPE Flowing = (BlockType == E_BLOCK_STATIONARY_WATER) ? E_BLOCK_WATER : E_BLOCK_LAVA;
+									m_ChangedBlocks.push_back(MakeSetBlock(BlockX, BlockY, BlockZ, Flowing, BlockMetas[Idx]));
+									break;
+								}
+								default:
+								{
+									if (Intensity > 0)
+									{
+										IsAffected[Idx] = true;
+										m_DestroyedBlocks.push_back(MakeSetBlock(BlockX, BlockY, BlockZ, BlockType, BlockMetas[Idx]));
+										m_ChangedBlocks.push_back(MakeSetBlock(BlockX, BlockY, BlockZ, E_BLOCK_AIR, 0));
+									}
+									break;
+								}
+							}  // switch (BlockType)
+						}
+					}
+					Pos += Step;
+					Intensity -= EXPLOSION_STEP_DECAY;
+				}  // while (Intensity > 0)
+			}  // for k
+		}  // for j
+	}  // for i
+
+	std::sort(m_DestroyedBlocks.begin(), m_DestroyedBlocks.end(), IsInChunkOrder);
+	std::sort(m_ChangedBlocks.begin(),   m_ChangedBlocks.end(),   IsInChunkOrder);
+}
+
+
+
+
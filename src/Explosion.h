@@ -0,0 +1,67 @@
+
+// Explosion.h
+
+// Declares the cExplosion class that calculates which blocks an explosion affects
+
+/*
+The explosion is calculated the vanilla way: rays are cast from the center towards each block on the surface of a
+16^3 cube around it. Each ray starts with a random intensity derived from the explosion size and walks in steps of
+0.3 blocks; each step weakens the ray, and so does each block the ray passes, according to the block's blast
+resistance (g_BlockBlastResistance[]). A block is destroyed if a ray reaches it with some intensity left.
+
+All the rays are cast over a single snapshot of the blocks, so the world is read only once for the whole
+explosion. The results are sorted by chunk, so that the caller can apply them as one batch per chunk.
+*/
+
+
+
+
+
+#pragma once
+
+#include "ChunkDef.h"
+#include "Vector3d.h"
+
+
+
+
+
+// fwd:
+class cBlockArea;
+class cFastRandom;
+
+
+
+
+
+class cExplosion
+{
+public:
+	cExplosion(double a_Size, const Vector3d & a_Center);
+
+	/** Returns the bounds of the blocks that the rays may reach, clamped to the world height.
+	The snapshot given to Calculate() needs to cover these. */
+	void GetReach(int & a_MinX, int & a_MaxX, int & a_MinY, int & a_MaxY, int & a_MinZ, int & a_MaxZ) const;
+
+	/** Casts the rays through a_Snapshot, which needs block types and metas, and collects the affected blocks.
+	The blocks outside the snapshot stop the rays. */
+	void Calculate(const cBlockArea & a_Snapshot, cFastRandom & a_Random);
+
+	/** The blocks destroyed by the explosion, with their original types and metas; sorted by chunk */
+	const sSetBlockVector & GetDestroyedBlocks(void) const { return m_DestroyedBlocks; }
+
+	/** The new contents of all the affected blocks: air for the destroyed blocks and flowing liquid for the stationary
+	liquids hit by the rays; sorted by chunk */
+	const sSetBlockVector & GetChangedBlocks(void) const { return m_ChangedBlocks; }
+
+protected:
+	double   m_Size;
+	Vector3d m_Center;
+
+	sSetBlockVector m_DestroyedBlocks;
+	sSetBlockVector m_ChangedBlocks;
+} ;
+
+
+
+
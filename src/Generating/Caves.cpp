@@ -125,7 +125,7 @@ typedef std::vector<cCaveTunnel *> cCaveTunnels;
 class cStructGenWormNestCaves::cCaveSystem
 {
 public:
-	// The generating block position; is read directly in cStructGenWormNestCaves::GetCavesForChunk()
+	// The generating block position
 	int m_BlockX;
 	int m_BlockZ;
 
@@ -740,22 +740,31 @@ int cStructGenWormNestCaves::cCaveSystem::GetRadius(cNoise & a_Noise, int a_Orig
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // cStructGenWormNestCaves:
 
+cStructGenWormNestCaves::cStructGenWormNestCaves(int a_Seed, int a_Size, int a_Grid, int a_MaxOffset) :
+	m_Noise(a_Seed),
+	m_Size(a_Size),
+	m_MaxOffset(a_MaxOffset),
+	m_Grid(a_Grid),
+	m_Cache(*this, 2 * NEIGHBORHOOD_SIZE, "WormNestCaves")
+{
+}
+
+
+
+
+
 cStructGenWormNestCaves::~cStructGenWormNestCaves()
 {
-	ClearCache();
+	// Defined here, where cCaveSystem is complete, so that m_Cache can delete the cave systems
 }
 
 
 
 
 
-void cStructGenWormNestCaves::ClearCache(void)
+cStructGenWormNestCaves::cCaveSystem * cStructGenWormNestCaves::CreateStructure(int a_GridX, int a_GridZ)
 {
-	for (cCaveSystems::const_iterator itr = m_Cache.begin(), end = m_Cache.end(); itr != end; ++itr)
-	{
-		delete *itr;
-	}  // for itr - m_Cache[]
-	m_Cache.clear();
+	return new cCaveSystem(a_GridX * m_Grid, a_GridZ * m_Grid, m_MaxOffset, m_Size, m_Noise);
 }
 
 
@@ -766,19 +775,19 @@ void cStructGenWormNestCaves::GenStructures(cChunkDesc & a_ChunkDesc)
 {
 	int ChunkX = a_ChunkDesc.GetChunkX();
 	int ChunkZ = a_ChunkDesc.GetChunkZ();
-	cCaveSystems Caves;
+	cCaveSystems::cRefs Caves;
 	GetCavesForChunk(ChunkX, ChunkZ, Caves);
-	for (cCaveSystems::const_iterator itr = Caves.begin(); itr != Caves.end(); ++itr)
+	for (size_t i = 0; i < Caves.size(); i++)
 	{
-		(*itr)->ProcessChunk(ChunkX, ChunkZ, a_ChunkDesc.GetBlockTypes(), a_ChunkDesc.GetHeightMap());
-	}  // for itr - Caves[]
+		Caves[i]->ProcessChunk(ChunkX, ChunkZ, a_ChunkDesc.GetBlockTypes(), a_ChunkDesc.GetHeightMap());
+	}  // for i - Caves[]
 }
 
 
 
 
 
-void cStructGenWormNestCaves::GetCavesForChunk(int a_ChunkX, int a_ChunkZ, cStructGenWormNestCaves::cCaveSystems & a_Caves)
+void cStructGenWormNestCaves::GetCavesForChunk(int a_ChunkX, int a_ChunkZ, cCaveSystems::cRefs & a_Caves)
 {
 	int BaseX = a_ChunkX * cChunkDef::Width / m_Grid;
 	int BaseZ = a_ChunkZ * cChunkDef::Width / m_Grid;
@@ -793,68 +802,7 @@ void cStructGenWormNestCaves::GetCavesForChunk(int a_ChunkX, int a_ChunkZ, cStru
 	BaseX -= NEIGHBORHOOD_SIZE / 2;
 	BaseZ -= NEIGHBORHOOD_SIZE / 2;
 
-	// Walk the cache, move each cave system that we want into a_Caves:
-	int StartX = BaseX * m_Grid;
-	int EndX = (BaseX + NEIGHBORHOOD_SIZE + 1) * m_Grid;
-	int StartZ = BaseZ * m_Grid;
-	int EndZ = (BaseZ + NEIGHBORHOOD_SIZE + 1) * m_Grid;
-	for (cCaveSystems::iterator itr = m_Cache.begin(), end = m_Cache.end(); itr != end;)
-	{
-		if (
-			((*itr)->m_BlockX >= StartX) && ((*itr)->m_BlockX < EndX) &&
-			((*itr)->m_BlockZ >= StartZ) && ((*itr)->m_BlockZ < EndZ)
-		)
-		{
-			// want
-			a_Caves.push_back(*itr);
-			itr = m_Cache.erase(itr);
-		}
-		else
-		{
-			// don't want
-			++itr;
-		}
-	}  // for itr - m_Cache[]
-
-	for (int x = 0; x < NEIGHBORHOOD_SIZE; x++)
-	{
-		int RealX = (BaseX + x) * m_Grid;
-		for (int z = 0; z < NEIGHBORHOOD_SIZE; z++)
-		{
-			int RealZ = (BaseZ + z) * m_Grid;
-			bool Found = false;
-			for (cCaveSystems::const_iterator itr = a_Caves.begin(), end = a_Caves.end(); itr != end; ++itr)
-			{
-				if (((*itr)->m_BlockX == RealX) && ((*itr)->m_BlockZ == RealZ))
-				{
-					Found = true;
-					break;
-				}
-			}
-			if (!Found)
-			{
-				a_Caves.push_back(new cCaveSystem(RealX, RealZ, m_MaxOffset, m_Size, m_Noise));
-			}
-		}
-	}
-
-	// Copy a_Caves into m_Cache to the beginning:
-	cCaveSystems CavesCopy(a_Caves);
-	m_Cache.splice(m_Cache.begin(), CavesCopy, CavesCopy.begin(), CavesCopy.end());
-
-	// Trim the cache if it's too long:
-	if (m_Cache.size() > 100)
-	{
-		cCaveSystems::iterator itr = m_Cache.begin();
-		std::advance(itr, 100);
-		for (cCaveSystems::iterator end = m_Cache.end(); itr != end; ++itr)
-		{
-			delete *itr;
-		}
-		itr = m_Cache.begin();
-		std::advance(itr, 100);
-		m_Cache.erase(itr, m_Cache.end());
-	}
+	m_Cache.GetStructures(BaseX, BaseZ, NEIGHBORHOOD_SIZE, NEIGHBORHOOD_SIZE, a_Caves);
 
 	/*
 	// Uncomment this block for debugging the caves' shapes in 2D using an SVG export
@@ -862,11 +810,11 @@ void cStructGenWormNestCaves::GetCavesForChunk(int a_ChunkX, int a_ChunkZ, cStru
 	AString SVG;
 	SVG.append("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1024\" height = \"1024\">\n");
 	SVG.reserve(2 * 1024 * 1024);
-	for (cCaveSystems::const_iterator itr = a_Caves.begin(), end = a_Caves.end(); itr != end; ++itr)
+	for (size_t i = 0; i < a_Caves.size(); i++)
 	{
-		int Color = 0x10 * abs((*itr)->m_BlockX / m_Grid);
-		Color |= 0x1000 * abs((*itr)->m_BlockZ / m_Grid);
-		SVG.append((*itr)->ExportAsSVG(Color, 512, 512));
+		int Color = 0x10 * abs(a_Caves[i]->m_BlockX / m_Grid);
+		Color |= 0x1000 * abs(a_Caves[i]->m_BlockZ / m_Grid);
+		SVG.append(a_Caves[i]->ExportAsSVG(Color, 512, 512));
 	}
 	SVG.append("</svg>\n");
 
@@ -14,6 +14,7 @@
 
 #include "ComposableGenerator.h"
 #include "../Noise.h"
+#include "GridStructCache.h"
 
 
 
@@ -67,19 +68,13 @@ class cStructGenWormNestCaves :
 	public cStructureGen
 {
 public:
-	cStructGenWormNestCaves(int a_Seed, int a_Size = 64, int a_Grid = 96, int a_MaxOffset = 128) :
-		m_Noise(a_Seed),
-		m_Size(a_Size),
-		m_MaxOffset(a_MaxOffset),
-		m_Grid(a_Grid)
-	{
-	}
-	
+	cStructGenWormNestCaves(int a_Seed, int a_Size = 64, int a_Grid = 96, int a_MaxOffset = 128);
 	~cStructGenWormNestCaves();
 	
 protected:
 	class cCaveSystem;  // fwd: Caves.cpp
-	typedef std::list<cCaveSystem *> cCaveSystems;
+	typedef cGridStructCache<cCaveSystem, cStructGenWormNestCaves> cCaveSystems;
+	friend class cGridStructCache<cCaveSystem, cStructGenWormNestCaves>;
 
 	cNoise       m_Noise;
 	int          m_Size;  // relative size of the cave systems' caves. Average number of blocks of each initial tunnel
@@ -87,11 +82,11 @@ protected:
 	int          m_Grid;  // average spacing of the nests
 	cCaveSystems m_Cache;
 	
-	/// Clears everything from the cache
-	void ClearCache(void);
+	/// Creates the cave system for the specified grid cell; called by m_Cache
+	cCaveSystem * CreateStructure(int a_GridX, int a_GridZ);
 	
-	/// Returns all caves that *may* intersect the given chunk. All the caves are valid until the next call to this function.
-	void GetCavesForChunk(int a_ChunkX, int a_ChunkZ, cCaveSystems & a_Caves);
+	/// Returns all caves that *may* intersect the given chunk. All the caves are valid until a_Caves is released.
+	void GetCavesForChunk(int a_ChunkX, int a_ChunkZ, cCaveSystems::cRefs & a_Caves);
 	
 	// cStructGen override:
 	virtual void GenStructures(cChunkDesc & a_ChunkDesc) override;
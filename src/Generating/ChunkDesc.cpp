@@ -6,6 +6,7 @@
 #include "Globals.h"
 #include "ChunkDesc.h"
 #include "../BlockArea.h"
+#include "../BlockArrayOps.h"
 #include "../Cuboid.h"
 #include "../Noise.h"
 #include "../BlockEntities/BlockEntity.h"
@@ -589,11 +590,7 @@ void cChunkDesc::UpdateHeightmap(void)
 
 void cChunkDesc::CompressBlockMetas(cChunkDef::BlockNibbles & a_DestMetas)
 {
-	const NIBBLETYPE * AreaMetas = m_BlockArea.GetBlockMetas();
-	for (size_t i = 0; i < ARRAYCOUNT(a_DestMetas); i++)
-	{
-		a_DestMetas[i] = AreaMetas[2 * i] | (AreaMetas[2 * i + 1] << 4);
-	}
+	cBlockArrayOps::PackNibbles(m_BlockArea.GetBlockMetas(), a_DestMetas, cChunkDef::NumBlocks);
 }
 
 
@@ -98,27 +98,26 @@ void cChunkGenerator::Stop(void)
 
 
 
-void cChunkGenerator::QueueGenerateChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ)
+void cChunkGenerator::QueueGenerateChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, bool a_IsUrgent)
 {
 	{
 		cCSLock Lock(m_CS);
+		cChunkCoords Coords(a_ChunkX, a_ChunkY, a_ChunkZ);
 
-		// Check if it is already in the queue:
-		for (cChunkCoordsList::iterator itr = m_Queue.begin(); itr != m_Queue.end(); ++itr)
+		// Add to queue unless already there, issue a warning if too many:
+		if (a_IsUrgent)
 		{
-			if ((itr->m_ChunkX == a_ChunkX) && (itr->m_ChunkY == a_ChunkY) && (itr->m_ChunkZ == a_ChunkZ))
-			{
-				// Already in the queue, bail out
-				return;
-			}
-		}  // for itr - m_Queue[]
-
-		// Add to queue, issue a warning if too many:
-		if (m_Queue.size() >= QUEUE_WARNING_LIMIT)
+			m_Queue.MoveToFront(Coords);
+		}
+		else if (!m_Queue.PushBackIfNotPresent(Coords))
+		{
+			// Already in the queue, bail out
+			return;
+		}
+		if (m_Queue.size() > QUEUE_WARNING_LIMIT)
 		{
-			LOGWARN("WARNING: Adding chunk [%i, %i] to generation queue; Queue is too big! (%i)", a_ChunkX, a_ChunkZ, m_Queue.size());
+			LOGWARN("WARNING: Adding chunk [%i, %i] to generation queue; Queue is too big! (%i)", a_ChunkX, a_ChunkZ, (int)m_Queue.size());
 		}
-		m_Queue.push_back(cChunkCoords(a_ChunkX, a_ChunkY, a_ChunkZ));
 	}
 
 	m_Event.Set();
@@ -228,8 +227,8 @@ void cChunkGenerator::Execute(void)
 			continue;
 		}
 
-		cChunkCoords coords = m_Queue.front();		// Get next coord from queue
-		m_Queue.erase( m_Queue.begin() );	// Remove coordinate from queue
+		cChunkCoords coords(0, 0, 0);
+		m_Queue.PopFront(coords);  // Get next coord from queue
 		bool SkipEnabled = (m_Queue.size() > QUEUE_SKIP_LIMIT);
 		Lock.Unlock();			// Unlock ASAP
 		m_evtRemoved.Set();
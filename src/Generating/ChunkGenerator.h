@@ -19,6 +19,7 @@ If the generator queue is overloaded, the generator skips chunks with no clients
 #pragma once
 
 #include "../OSSupport/IsThread.h"
+#include "../OSSupport/Queue.h"
 #include "../ChunkDef.h"
 
 
@@ -115,8 +116,8 @@ public:
 	bool Start(cPluginInterface & a_PluginInterface, cChunkSink & a_ChunkSink, cIniFile & a_IniFile);
 	void Stop(void);
 
-	/// Queues the chunk for generation; removes duplicate requests
-	void QueueGenerateChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ);
+	/// Queues the chunk for generation; removes duplicate requests. Urgent chunks are moved to the front of the queue.
+	void QueueGenerateChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ, bool a_IsUrgent = false);
 	
 	/// Generates the biomes for the specified chunk (directly, not in a separate thread). Used by the world loader if biomes failed loading.
 	void GenerateBiomes(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_BiomeMap);
@@ -138,7 +139,7 @@ private:
 	int m_Seed;
 
 	cCriticalSection m_CS;
-	cChunkCoordsList m_Queue;
+	cIndexedQueue<cChunkCoords> m_Queue;
 	cEvent           m_Event;       ///< Set when an item is added to the queue or the thread should terminate
 	cEvent           m_evtRemoved;  ///< Set when an item is removed from the queue
 	
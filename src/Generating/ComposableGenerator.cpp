@@ -342,7 +342,8 @@ void cComposableGenerator::InitStructureGens(cIniFile & a_IniFile)
 		}
 		else if (NoCaseCompare(*itr, "Trees") == 0)
 		{
-			m_StructureGens.push_back(new cStructGenTrees(Seed, m_BiomeGen, m_HeightGen, m_CompositionGen));
+			int CacheSize = a_IniFile.GetValueSetI("Generator", "TreesCacheSize", 64);
+			m_StructureGens.push_back(new cStructGenTrees(Seed, m_BiomeGen, m_HeightGen, m_CompositionGen, CacheSize));
 		}
 		else if (NoCaseCompare(*itr, "WaterLakes") == 0)
 		{
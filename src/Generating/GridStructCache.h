@@ -0,0 +1,228 @@
+
+// GridStructCache.h
+
+// Declares the cGridStructCache class template representing a thread-safe cache of grid-aligned structures
+
+#pragma once
+
+/*
+The structure generators that place their structures on a grid (caves, ravines, mineshafts) need, for each chunk,
+all the structures from the grid cells around it. Neighboring chunks share most of those, so the structures are
+cached.
+
+The cache is a square table of slots, indexed directly by the grid cell coords modulo the table size, so a lookup
+is O(1) and any neighborhood no larger than the table never evicts its own members. A structure in a slot gets
+replaced once another grid cell that maps to the same slot is requested.
+
+The slots are guarded by a set of locks, each lock guarding every NUM_LOCKS-th slot, so that several generator
+threads may use the same cache without waiting for each other most of the time. The structures handed out are
+reference-counted, so a structure that gets replaced while another thread is still carving it is deleted only
+once that thread releases it.
+
+Usage:
+The cache is instantiated as cGridStructCache<StructType, FactoryType>, where FactoryType (usually the generator
+itself) provides the function "StructType * CreateStructure(int a_GridX, int a_GridZ)", which may be called from
+several threads at once. For each chunk, the generator calls GetStructures() with a cRefs object, uses the
+structures through it and lets the cRefs go out of scope (or calls Release()) when done.
+*/
+
+
+
+
+#include "../OSSupport/CriticalSection.h"
+
+
+
+
+
+template <class StructType, class FactoryType>
+class cGridStructCache
+{
+	/** A cached structure, with the number of cRefs currently holding it */
+	struct sEntry
+	{
+		StructType * m_Struct;
+		int          m_GridX;
+		int          m_GridZ;
+		int          m_NumRefs;   ///< Number of cRefs holding the entry, protected by the slot's lock
+		bool         m_IsCached;  ///< False once the entry has been replaced in its slot; deleted when m_NumRefs drops to 0
+	} ;
+
+	/** Number of locks guarding the slots; each lock guards every NUM_LOCKS-th slot */
+	static const int NUM_LOCKS = 16;
+
+public:
+	class cRefs;
+	friend class cRefs;
+
+	/** References to the structures returned by GetStructures(); the structures stay valid until released */
+	class cRefs
+	{
+		friend class cGridStructCache;
+
+	public:
+		cRefs(void) : m_Cache(NULL) {}
+		~cRefs() { Release(); }
+
+		size_t size(void) const { return m_Entries.size(); }
+		StructType * operator [] (size_t a_Idx) const { return m_Entries[a_Idx]->m_Struct; }
+
+		/** Releases all the held structures */
+		void Release(void)
+		{
+			if (m_Cache != NULL)
+			{
+				m_Cache->ReleaseEntries(m_Entries);
+			}
+			m_Entries.clear();
+		}
+
+	protected:
+		cGridStructCache * m_Cache;
+		std::vector<sEntry *> m_Entries;
+	} ;
+
+
+	/** Creates a cache for the structures in the grid cells, a_Size is the number of cells along each side of the
+	cached square. It is rounded up to a power of 2 and should be larger than the neighborhood queried for a chunk. */
+	cGridStructCache(FactoryType & a_Factory, int a_Size, const char * a_Name) :
+		m_Factory(a_Factory),
+		m_Name(a_Name)
+	{
+		m_Size = 1;
+		while (m_Size < a_Size)
+		{
+			m_Size *= 2;
+		}
+		m_Slots.resize(m_Size * m_Size, NULL);
+		for (int i = 0; i < NUM_LOCKS; i++)
+		{
+			m_NumHits[i] = 0;
+			m_NumMisses[i] = 0;
+		}
+	}
+
+
+	~cGridStructCache()
+	{
+		Int64 NumHits = 0, NumMisses = 0;
+		for (int i = 0; i < NUM_LOCKS; i++)
+		{
+			NumHits += m_NumHits[i];
+			NumMisses += m_NumMisses[i];
+		}
+		if (NumHits + NumMisses > 0)
+		{
+			LOGD("%s cache: %lld hits, %lld misses, saved %.2f %%", m_Name, NumHits, NumMisses, 100.0 * NumHits / (NumHits + NumMisses));
+		}
+
+		for (typename std::vector<sEntry *>::iterator itr = m_Slots.begin(), end = m_Slots.end(); itr != end; ++itr)
+		{
+			if (*itr != NULL)
+			{
+				ASSERT((*itr)->m_NumRefs == 0);  // Someone is still holding a structure
+				delete (*itr)->m_Struct;
+				delete *itr;
+			}
+		}
+	}
+
+
+	/** Adds the structures for the grid cells [a_GridX, a_GridX + a_SizeX) x [a_GridZ, a_GridZ + a_SizeZ) into a_Refs,
+	creating those not in the cache. */
+	void GetStructures(int a_GridX, int a_GridZ, int a_SizeX, int a_SizeZ, cRefs & a_Refs)
+	{
+		ASSERT((a_Refs.m_Cache == NULL) || (a_Refs.m_Cache == this));
+		a_Refs.m_Cache = this;
+		a_Refs.m_Entries.reserve(a_Refs.m_Entries.size() + a_SizeX * a_SizeZ);
+		for (int x = 0; x < a_SizeX; x++)
+		{
+			for (int z = 0; z < a_SizeZ; z++)
+			{
+				a_Refs.m_Entries.push_back(GetEntry(a_GridX + x, a_GridZ + z));
+			}
+		}
+	}
+
+protected:
+	FactoryType & m_Factory;
+
+	/** Name of the cache, for the statistics */
+	const char * m_Name;
+
+	/** Number of slots along each side of the square, a power of 2 */
+	int m_Size;
+
+	/** The cached entries, m_Size * m_Size of them, indexed by SlotIndex() */
+	std::vector<sEntry *> m_Slots;
+
+	cCriticalSection m_CS[NUM_LOCKS];
+
+	// Statistics, per lock so that they are protected by the locks:
+	Int64 m_NumHits[NUM_LOCKS];
+	Int64 m_NumMisses[NUM_LOCKS];
+
+
+	int SlotIndex(int a_GridX, int a_GridZ) const
+	{
+		return (a_GridX & (m_Size - 1)) + (a_GridZ & (m_Size - 1)) * m_Size;
+	}
+
+
+	/** Returns the entry for the grid cell, with a reference added; creates the structure if not cached */
+	sEntry * GetEntry(int a_GridX, int a_GridZ)
+	{
+		int Idx = SlotIndex(a_GridX, a_GridZ);
+		int LockIdx = Idx % NUM_LOCKS;
+		cCSLock Lock(m_CS[LockIdx]);
+		sEntry * Entry = m_Slots[Idx];
+		if ((Entry != NULL) && (Entry->m_GridX == a_GridX) && (Entry->m_GridZ == a_GridZ))
+		{
+			m_NumHits[LockIdx] += 1;
+			Entry->m_NumRefs += 1;
+			return Entry;
+		}
+
+		// Not cached, replace the slot's contents:
+		m_NumMisses[LockIdx] += 1;
+		if (Entry != NULL)
+		{
+			Entry->m_IsCached = false;
+			if (Entry->m_NumRefs == 0)
+			{
+				delete Entry->m_Struct;
+				delete Entry;
+			}
+		}
+		Entry = new sEntry;
+		Entry->m_Struct = m_Factory.CreateStructure(a_GridX, a_GridZ);
+		Entry->m_GridX = a_GridX;
+		Entry->m_GridZ = a_GridZ;
+		Entry->m_NumRefs = 1;
+		Entry->m_IsCached = true;
+		m_Slots[Idx] = Entry;
+		return Entry;
+	}
+
+
+	/** Removes one reference from each of the entries, deleting those that are no longer cached nor referenced */
+	void ReleaseEntries(const std::vector<sEntry *> & a_Entries)
+	{
+		for (typename std::vector<sEntry *>::const_iterator itr = a_Entries.begin(), end = a_Entries.end(); itr != end; ++itr)
+		{
+			sEntry * Entry = *itr;
+			cCSLock Lock(m_CS[SlotIndex(Entry->m_GridX, Entry->m_GridZ) % NUM_LOCKS]);
+			ASSERT(Entry->m_NumRefs > 0);
+			Entry->m_NumRefs -= 1;
+			if ((Entry->m_NumRefs == 0) && !Entry->m_IsCached)
+			{
+				delete Entry->m_Struct;
+				delete Entry;
+			}
+		}
+	}
+} ;
+
+
+
+
@@ -1290,7 +1290,8 @@ cStructGenMineShafts::cStructGenMineShafts(
 	m_MaxSystemSize(a_MaxSystemSize),
 	m_ProbLevelCorridor(std::max(0, a_ChanceCorridor)),
 	m_ProbLevelCrossing(std::max(0, a_ChanceCorridor + a_ChanceCrossing)),
-	m_ProbLevelStaircase(std::max(0, a_ChanceCorridor + a_ChanceCrossing + a_ChanceStaircase))
+	m_ProbLevelStaircase(std::max(0, a_ChanceCorridor + a_ChanceCrossing + a_ChanceStaircase)),
+	m_Cache(*this, 2 * NEIGHBORHOOD_SIZE, "MineShafts")
 {
 }
 
@@ -1300,20 +1301,19 @@ cStructGenMineShafts::cStructGenMineShafts(
 
 cStructGenMineShafts::~cStructGenMineShafts()
 {
-	ClearCache();
+	// Defined here, where cMineShaftSystem is complete, so that m_Cache can delete the systems
 }
 
 
 
 
 
-void cStructGenMineShafts::ClearCache(void)
+cStructGenMineShafts::cMineShaftSystem * cStructGenMineShafts::CreateStructure(int a_GridX, int a_GridZ)
 {
-	for (cMineShaftSystems::const_iterator itr = m_Cache.begin(), end = m_Cache.end(); itr != end; ++itr)
-	{
-		delete *itr;
-	}  // for itr - m_Cache[]
-	m_Cache.clear();
+	return new cMineShaftSystem(
+		a_GridX * m_GridSize, a_GridZ * m_GridSize, m_GridSize, m_MaxSystemSize, m_Noise,
+		m_ProbLevelCorridor, m_ProbLevelCrossing, m_ProbLevelStaircase
+	);
 }
 
 
@@ -1322,7 +1322,7 @@ void cStructGenMineShafts::ClearCache(void)
 
 void cStructGenMineShafts::GetMineShaftSystemsForChunk(
 	int a_ChunkX, int a_ChunkZ,
-	cStructGenMineShafts::cMineShaftSystems & a_MineShafts
+	cStructGenMineShafts::cMineShaftSystems::cRefs & a_MineShafts
 )
 {
 	int BaseX = a_ChunkX * cChunkDef::Width / m_GridSize;
@@ -1338,68 +1338,7 @@ void cStructGenMineShafts::GetMineShaftSystemsForChunk(
 	BaseX -= NEIGHBORHOOD_SIZE / 2;
 	BaseZ -= NEIGHBORHOOD_SIZE / 2;
 
-	// Walk the cache, move each cave system that we want into a_Caves:
-	int StartX = BaseX * m_GridSize;
-	int EndX = (BaseX + NEIGHBORHOOD_SIZE + 1) * m_GridSize;
-	int StartZ = BaseZ * m_GridSize;
-	int EndZ = (BaseZ + NEIGHBORHOOD_SIZE + 1) * m_GridSize;
-	for (cMineShaftSystems::iterator itr = m_Cache.begin(), end = m_Cache.end(); itr != end;)
-	{
-		if (
-			((*itr)->m_BlockX >= StartX) && ((*itr)->m_BlockX < EndX) &&
-			((*itr)->m_BlockZ >= StartZ) && ((*itr)->m_BlockZ < EndZ)
-		)
-		{
-			// want
-			a_MineShafts.push_back(*itr);
-			itr = m_Cache.erase(itr);
-		}
-		else
-		{
-			// don't want
-			++itr;
-		}
-	}  // for itr - m_Cache[]
-
-	for (int x = 0; x < NEIGHBORHOOD_SIZE; x++)
-	{
-		int RealX = (BaseX + x) * m_GridSize;
-		for (int z = 0; z < NEIGHBORHOOD_SIZE; z++)
-		{
-			int RealZ = (BaseZ + z) * m_GridSize;
-			bool Found = false;
-			for (cMineShaftSystems::const_iterator itr = a_MineShafts.begin(), end = a_MineShafts.end(); itr != end; ++itr)
-			{
-				if (((*itr)->m_BlockX == RealX) && ((*itr)->m_BlockZ == RealZ))
-				{
-					Found = true;
-					break;
-				}
-			}  // for itr - a_Mineshafts
-			if (!Found)
-			{
-				a_MineShafts.push_back(new cMineShaftSystem(RealX, RealZ, m_GridSize, m_MaxSystemSize, m_Noise, m_ProbLevelCorridor, m_ProbLevelCrossing, m_ProbLevelStaircase));
-			}
-		}  // for z
-	}  // for x
-
-	// Copy a_MineShafts into m_Cache to the beginning:
-	cMineShaftSystems MineShaftsCopy(a_MineShafts);
-	m_Cache.splice(m_Cache.begin(), MineShaftsCopy, MineShaftsCopy.begin(), MineShaftsCopy.end());
-
-	// Trim the cache if it's too long:
-	if (m_Cache.size() > 100)
-	{
-		cMineShaftSystems::iterator itr = m_Cache.begin();
-		std::advance(itr, 100);
-		for (cMineShaftSystems::iterator end = m_Cache.end(); itr != end; ++itr)
-		{
-			delete *itr;
-		}
-		itr = m_Cache.begin();
-		std::advance(itr, 100);
-		m_Cache.erase(itr, m_Cache.end());
-	}
+	m_Cache.GetStructures(BaseX, BaseZ, NEIGHBORHOOD_SIZE, NEIGHBORHOOD_SIZE, a_MineShafts);
 }
 
 
@@ -1411,12 +1350,12 @@ void cStructGenMineShafts::GenStructures(cChunkDesc & a_ChunkDesc)
 {
 	int ChunkX = a_ChunkDesc.GetChunkX();
 	int ChunkZ = a_ChunkDesc.GetChunkZ();
-	cMineShaftSystems MineShafts;
+	cMineShaftSystems::cRefs MineShafts;
 	GetMineShaftSystemsForChunk(ChunkX, ChunkZ, MineShafts);
-	for (cMineShaftSystems::const_iterator itr = MineShafts.begin(); itr != MineShafts.end(); ++itr)
+	for (size_t i = 0; i < MineShafts.size(); i++)
 	{
-		(*itr)->ProcessChunk(a_ChunkDesc);
-	}  // for itr - MineShafts[]
+		MineShafts[i]->ProcessChunk(a_ChunkDesc);
+	}  // for i - MineShafts[]
 }
 
 
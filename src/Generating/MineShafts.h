@@ -11,6 +11,7 @@
 
 #include "ComposableGenerator.h"
 #include "../Noise.h"
+#include "GridStructCache.h"
 
 
 
@@ -34,7 +35,8 @@ protected:
 	friend class cMineShaftCrossing;
 	friend class cMineShaftStaircase;
 	class cMineShaftSystem;  // fwd: MineShafts.cpp
-	typedef std::list<cMineShaftSystem *> cMineShaftSystems;
+	typedef cGridStructCache<cMineShaftSystem, cStructGenMineShafts> cMineShaftSystems;
+	friend class cGridStructCache<cMineShaftSystem, cStructGenMineShafts>;
 	
 	cNoise            m_Noise;
 	int               m_GridSize;            ///< Average spacing of the systems
@@ -42,15 +44,15 @@ protected:
 	int               m_ProbLevelCorridor;   ///< Probability level of a branch object being the corridor
 	int               m_ProbLevelCrossing;   ///< Probability level of a branch object being the crossing, minus Corridor
 	int               m_ProbLevelStaircase;  ///< Probability level of a branch object being the staircase, minus Crossing
-	cMineShaftSystems m_Cache;               ///< Cache of the most recently used systems. MoveToFront used.
+	cMineShaftSystems m_Cache;               ///< Cache of the systems around the recently generated chunks
 	
-	/// Clears everything from the cache
-	void ClearCache(void);
+	/// Creates the system for the specified grid cell; called by m_Cache
+	cMineShaftSystem * CreateStructure(int a_GridX, int a_GridZ);
 	
 	/** Returns all systems that *may* intersect the given chunk.
-	All the systems are valid until the next call to this function (which may delete some of the pointers).
+	All the systems are valid until a_MineShaftSystems is released.
 	*/
-	void GetMineShaftSystemsForChunk(int a_ChunkX, int a_ChunkZ, cMineShaftSystems & a_MineShaftSystems);
+	void GetMineShaftSystemsForChunk(int a_ChunkX, int a_ChunkZ, cMineShaftSystems::cRefs & a_MineShaftSystems);
 
 	// cStructureGen overrides:
 	virtual void GenStructures(cChunkDesc & a_ChunkDesc) override;
@@ -87,7 +87,8 @@ public:
 
 cStructGenRavines::cStructGenRavines(int a_Seed, int a_Size) :
 	m_Noise(a_Seed),
-	m_Size(a_Size)
+	m_Size(a_Size),
+	m_Cache(*this, 2 * NEIGHBORHOOD_SIZE, "Ravines")
 {
 }
 
@@ -97,20 +98,16 @@ cStructGenRavines::cStructGenRavines(int a_Seed, int a_Size) :
 
 cStructGenRavines::~cStructGenRavines()
 {
-	ClearCache();
+	// Defined here, where cRavine is complete, so that m_Cache can delete the ravines
 }
 
 
 
 
 
-void cStructGenRavines::ClearCache(void)
+cStructGenRavines::cRavine * cStructGenRavines::CreateStructure(int a_GridX, int a_GridZ)
 {
-	for (cRavines::const_iterator itr = m_Cache.begin(), end = m_Cache.end(); itr != end; ++itr)
-	{
-		delete *itr;
-	}  // for itr - m_Cache[]
-	m_Cache.clear();
+	return new cRavine(a_GridX * m_Size, a_GridZ * m_Size, m_Size, m_Noise);
 }
 
 
@@ -121,19 +118,19 @@ void cStructGenRavines::GenStructures(cChunkDesc & a_ChunkDesc)
 {
 	int ChunkX = a_ChunkDesc.GetChunkX();
 	int ChunkZ = a_ChunkDesc.GetChunkZ();
-	cRavines Ravines;
+	cRavines::cRefs Ravines;
 	GetRavinesForChunk(ChunkX, ChunkZ, Ravines);
-	for (cRavines::const_iterator itr = Ravines.begin(), end = Ravines.end(); itr != end; ++itr)
+	for (size_t i = 0; i < Ravines.size(); i++)
 	{
-		(*itr)->ProcessChunk(ChunkX, ChunkZ, a_ChunkDesc.GetBlockTypes(), a_ChunkDesc.GetHeightMap());
-	}  // for itr - Ravines[]
+		Ravines[i]->ProcessChunk(ChunkX, ChunkZ, a_ChunkDesc.GetBlockTypes(), a_ChunkDesc.GetHeightMap());
+	}  // for i - Ravines[]
 }
 
 
 
 
 
-void cStructGenRavines::GetRavinesForChunk(int a_ChunkX, int a_ChunkZ, cStructGenRavines::cRavines & a_Ravines)
+void cStructGenRavines::GetRavinesForChunk(int a_ChunkX, int a_ChunkZ, cRavines::cRefs & a_Ravines)
 {
 	int BaseX = a_ChunkX * cChunkDef::Width / m_Size;
 	int BaseZ = a_ChunkZ * cChunkDef::Width / m_Size;
@@ -148,77 +145,16 @@ void cStructGenRavines::GetRavinesForChunk(int a_ChunkX, int a_ChunkZ, cStructGe
 	BaseX -= 4;
 	BaseZ -= 4;
 	
-	// Walk the cache, move each ravine that we want into a_Ravines:
-	int StartX = BaseX * m_Size;
-	int EndX = (BaseX + NEIGHBORHOOD_SIZE + 1) * m_Size;
-	int StartZ = BaseZ * m_Size;
-	int EndZ = (BaseZ + NEIGHBORHOOD_SIZE + 1) * m_Size;
-	for (cRavines::iterator itr = m_Cache.begin(), end = m_Cache.end(); itr != end;)
-	{
-		if (
-			((*itr)->m_BlockX >= StartX) && ((*itr)->m_BlockX < EndX) &&
-			((*itr)->m_BlockZ >= StartZ) && ((*itr)->m_BlockZ < EndZ)
-		)
-		{
-			// want
-			a_Ravines.push_back(*itr);
-			itr = m_Cache.erase(itr);
-		}
-		else
-		{
-			// don't want
-			++itr;
-		}
-	}  // for itr - m_Cache[]
-	
-	for (int x = 0; x < NEIGHBORHOOD_SIZE; x++)
-	{
-		int RealX = (BaseX + x) * m_Size;
-		for (int z = 0; z < NEIGHBORHOOD_SIZE; z++)
-		{
-			int RealZ = (BaseZ + z) * m_Size;
-			bool Found = false;
-			for (cRavines::const_iterator itr = a_Ravines.begin(), end = a_Ravines.end(); itr != end; ++itr)
-			{
-				if (((*itr)->m_BlockX == RealX) && ((*itr)->m_BlockZ == RealZ))
-				{
-					Found = true;
-					break;
-				}
-			}
-			if (!Found)
-			{
-				a_Ravines.push_back(new cRavine(RealX, RealZ, m_Size, m_Noise));
-			}
-		}
-	}
-	
-	// Copy a_Ravines into m_Cache to the beginning:
-	cRavines RavinesCopy(a_Ravines);
-	m_Cache.splice(m_Cache.begin(), RavinesCopy, RavinesCopy.begin(), RavinesCopy.end());
-	
-	// Trim the cache if it's too long:
-	if (m_Cache.size() > 100)
-	{
-		cRavines::iterator itr = m_Cache.begin();
-		std::advance(itr, 100);
-		for (cRavines::iterator end = m_Cache.end(); itr != end; ++itr)
-		{
-			delete *itr;
-		}
-		itr = m_Cache.begin();
-		std::advance(itr, 100);
-		m_Cache.erase(itr, m_Cache.end());
-	}
+	m_Cache.GetStructures(BaseX, BaseZ, NEIGHBORHOOD_SIZE, NEIGHBORHOOD_SIZE, a_Ravines);
 	
 	/*
 	#ifdef _DEBUG
 	// DEBUG: Export as SVG into a file specific for the chunk, for visual verification:
 	AString SVG;
 	SVG.append("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1024\" height = \"1024\">\n");
-	for (cRavines::const_iterator itr = a_Ravines.begin(), end = a_Ravines.end(); itr != end; ++itr)
+	for (size_t i = 0; i < a_Ravines.size(); i++)
 	{
-		SVG.append((*itr)->ExportAsSVG(0, 512, 512));
+		SVG.append(a_Ravines[i]->ExportAsSVG(0, 512, 512));
 	}
 	SVG.append("</svg>\n");
 	
@@ -11,6 +11,7 @@
 
 #include "ComposableGenerator.h"
 #include "../Noise.h"
+#include "GridStructCache.h"
 
 
 
@@ -25,17 +26,18 @@ public:
 	
 protected:
 	class cRavine;  // fwd: Ravines.cpp
-	typedef std::list<cRavine *> cRavines;
+	typedef cGridStructCache<cRavine, cStructGenRavines> cRavines;
+	friend class cGridStructCache<cRavine, cStructGenRavines>;
 	
 	cNoise   m_Noise;
 	int      m_Size;  // Max size, in blocks, of the ravines generated
 	cRavines m_Cache;
 	
-	/// Clears everything from the cache
-	void ClearCache(void);
+	/// Creates the ravine for the specified grid cell; called by m_Cache
+	cRavine * CreateStructure(int a_GridX, int a_GridZ);
 	
-	/// Returns all ravines that *may* intersect the given chunk. All the ravines are valid until the next call to this function.
-	void GetRavinesForChunk(int a_ChunkX, int a_ChunkZ, cRavines & a_Ravines);
+	/// Returns all ravines that *may* intersect the given chunk. All the ravines are valid until a_Ravines is released.
+	void GetRavinesForChunk(int a_ChunkX, int a_ChunkZ, cRavines::cRefs & a_Ravines);
 	
 	// cStructureGen override:
 	virtual void GenStructures(cChunkDesc & a_ChunkDesc) override;
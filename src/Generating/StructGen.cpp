@@ -63,6 +63,29 @@ template <typename T> T Clamp(T a_Value, T a_Min, T a_Max)
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // cStructGenTrees:
 
+cStructGenTrees::cStructGenTrees(int a_Seed, cBiomeGen * a_BiomeGen, cTerrainHeightGen * a_HeightGen, cTerrainCompositionGen * a_CompositionGen, int a_CacheSize) :
+	m_Seed(a_Seed),
+	m_Noise(a_Seed),
+	m_BiomeGen(a_BiomeGen),
+	m_HeightGen(a_HeightGen),
+	m_CompositionGen(a_CompositionGen),
+	m_NumHits(0),
+	m_NumMisses(0)
+{
+	m_Cache.resize(std::max(a_CacheSize, 0));
+	m_CacheOrder.resize(m_Cache.size());
+	for (size_t i = 0; i < m_Cache.size(); i++)
+	{
+		m_CacheOrder[i] = (int)i;
+		m_Cache[i].m_ChunkX = 0x7fffffff;
+		m_Cache[i].m_ChunkZ = 0x7fffffff;
+	}
+}
+
+
+
+
+
 void cStructGenTrees::GenStructures(cChunkDesc & a_ChunkDesc)
 {
 	int ChunkX = a_ChunkDesc.GetChunkX();
@@ -78,37 +101,34 @@ void cStructGenTrees::GenStructures(cChunkDesc & a_ChunkDesc)
 		{
 			int BaseZ = ChunkZ + z - 1;
 			
-			cChunkDesc * Dest;
-
+			const sSetBlockVector * OutsideLogs;
+			const sSetBlockVector * OutsideOther;
+			sSetBlockVector OwnOutsideLogs, OwnOutsideOther;
 			if ((x != 1) || (z != 1))
 			{
-				Dest = &WorkerDesc;
-				WorkerDesc.SetChunkCoords(BaseX, BaseZ);
-				
-				m_BiomeGen->GenBiomes           (BaseX, BaseZ, WorkerDesc.GetBiomeMap());
-				m_HeightGen->GenHeightMap       (BaseX, BaseZ, WorkerDesc.GetHeightMap());
-				m_CompositionGen->ComposeTerrain(WorkerDesc);
-				// TODO: Free the entity lists
+				// A neighbor, only its overflow into this chunk is needed:
+				const sTreeOverflow & Overflow = GetTreeOverflow(BaseX, BaseZ, WorkerDesc);
+				OutsideLogs  = &Overflow.m_Logs;
+				OutsideOther = &Overflow.m_Other;
 			}
 			else
 			{
-				Dest = &a_ChunkDesc;
-			}
-
-			int NumTrees = GetNumTrees(BaseX, BaseZ, Dest->GetBiomeMap());
-
-			sSetBlockVector OutsideLogs, OutsideOther;
-			for (int i = 0; i < NumTrees; i++)
-			{
-				GenerateSingleTree(BaseX, BaseZ, i, *Dest, OutsideLogs, OutsideOther);
+				// This chunk, generate the trees directly into it:
+				int NumTrees = GetNumTrees(BaseX, BaseZ, a_ChunkDesc.GetBiomeMap());
+				for (int i = 0; i < NumTrees; i++)
+				{
+					GenerateSingleTree(BaseX, BaseZ, i, a_ChunkDesc, OwnOutsideLogs, OwnOutsideOther);
+				}
+				OutsideLogs  = &OwnOutsideLogs;
+				OutsideOther = &OwnOutsideOther;
 			}
 
 			sSetBlockVector IgnoredOverflow;
-			IgnoredOverflow.reserve(OutsideOther.size());
-			ApplyTreeImage(ChunkX, ChunkZ, a_ChunkDesc, OutsideOther, IgnoredOverflow);
+			IgnoredOverflow.reserve(OutsideOther->size());
+			ApplyTreeImage(ChunkX, ChunkZ, a_ChunkDesc, *OutsideOther, IgnoredOverflow);
 			IgnoredOverflow.clear();
-			IgnoredOverflow.reserve(OutsideLogs.size());
-			ApplyTreeImage(ChunkX, ChunkZ, a_ChunkDesc, OutsideLogs, IgnoredOverflow);
+			IgnoredOverflow.reserve(OutsideLogs->size());
+			ApplyTreeImage(ChunkX, ChunkZ, a_ChunkDesc, *OutsideLogs, IgnoredOverflow);
 		}  // for z
 	}  // for x
 	
@@ -133,6 +153,72 @@ void cStructGenTrees::GenStructures(cChunkDesc & a_ChunkDesc)
 
 
 
+const cStructGenTrees::sTreeOverflow & cStructGenTrees::GetTreeOverflow(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_WorkerDesc)
+{
+	if (m_Cache.empty())
+	{
+		GenerateTreeOverflow(a_ChunkX, a_ChunkZ, a_WorkerDesc, m_Uncached);
+		return m_Uncached;
+	}
+	
+	int CacheSize = (int)m_Cache.size();
+	for (int i = 0; i < CacheSize; i++)
+	{
+		int Idx = m_CacheOrder[i];
+		if ((m_Cache[Idx].m_ChunkX != a_ChunkX) || (m_Cache[Idx].m_ChunkZ != a_ChunkZ))
+		{
+			continue;
+		}
+		
+		// Found it in the cache, move to front:
+		for (int j = i; j > 0; j--)
+		{
+			m_CacheOrder[j] = m_CacheOrder[j - 1];
+		}
+		m_CacheOrder[0] = Idx;
+		m_NumHits++;
+		return m_Cache[Idx];
+	}  // for i - cache
+	
+	// Not in the cache, generate into the least recently used item and make it the first in the MRU order:
+	m_NumMisses++;
+	int Idx = m_CacheOrder[CacheSize - 1];
+	for (int i = CacheSize - 1; i > 0; i--)
+	{
+		m_CacheOrder[i] = m_CacheOrder[i - 1];
+	}
+	m_CacheOrder[0] = Idx;
+	GenerateTreeOverflow(a_ChunkX, a_ChunkZ, a_WorkerDesc, m_Cache[Idx]);
+	return m_Cache[Idx];
+}
+
+
+
+
+
+void cStructGenTrees::GenerateTreeOverflow(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_WorkerDesc, sTreeOverflow & a_Overflow)
+{
+	a_Overflow.m_ChunkX = a_ChunkX;
+	a_Overflow.m_ChunkZ = a_ChunkZ;
+	a_Overflow.m_Logs.clear();
+	a_Overflow.m_Other.clear();
+	
+	a_WorkerDesc.SetChunkCoords(a_ChunkX, a_ChunkZ);
+	m_BiomeGen->GenBiomes           (a_ChunkX, a_ChunkZ, a_WorkerDesc.GetBiomeMap());
+	m_HeightGen->GenHeightMap       (a_ChunkX, a_ChunkZ, a_WorkerDesc.GetHeightMap());
+	m_CompositionGen->ComposeTerrain(a_WorkerDesc);
+	
+	int NumTrees = GetNumTrees(a_ChunkX, a_ChunkZ, a_WorkerDesc.GetBiomeMap());
+	for (int i = 0; i < NumTrees; i++)
+	{
+		GenerateSingleTree(a_ChunkX, a_ChunkZ, i, a_WorkerDesc, a_Overflow.m_Logs, a_Overflow.m_Other);
+	}
+}
+
+
+
+
+
 void cStructGenTrees::GenerateSingleTree(
 	int a_ChunkX, int a_ChunkZ, int a_Seq,
 	cChunkDesc & a_ChunkDesc,
@@ -24,22 +24,52 @@ class cStructGenTrees :
 	public cStructureGen
 {
 public:
-	cStructGenTrees(int a_Seed, cBiomeGen * a_BiomeGen, cTerrainHeightGen * a_HeightGen, cTerrainCompositionGen * a_CompositionGen) :
-		m_Seed(a_Seed),
-		m_Noise(a_Seed),
-		m_BiomeGen(a_BiomeGen),
-		m_HeightGen(a_HeightGen),
-		m_CompositionGen(a_CompositionGen)
-	{}
+	/** Creates the generator. a_CacheSize is the number of chunks whose tree overflow is cached for their neighbors, 0 to disable the cache */
+	cStructGenTrees(int a_Seed, cBiomeGen * a_BiomeGen, cTerrainHeightGen * a_HeightGen, cTerrainCompositionGen * a_CompositionGen, int a_CacheSize);
+	
+	/** Returns the number of tree overflow lookups served from the cache */
+	int GetNumCacheHits(void) const { return m_NumHits; }
+	
+	/** Returns the number of tree overflow lookups that had to generate the neighbor's terrain and trees */
+	int GetNumCacheMisses(void) const { return m_NumMisses; }
 	
 protected:
 
+	/** The trees generated in a chunk of bare terrain, reduced to the blocks that overflow out of the chunk */
+	struct sTreeOverflow
+	{
+		int m_ChunkX;
+		int m_ChunkZ;
+		sSetBlockVector m_Logs;
+		sSetBlockVector m_Other;
+	} ;
+	
 	int m_Seed;
 	cNoise m_Noise;
 	cBiomeGen *              m_BiomeGen;
 	cTerrainHeightGen *      m_HeightGen;
 	cTerrainCompositionGen * m_CompositionGen;
 	
+	/** The overflow of the recently used neighbor chunks. Each chunk is a neighbor of 8 chunks, so caching saves
+	re-generating its terrain and trees for each of them. */
+	std::vector<sTreeOverflow> m_Cache;
+	
+	/** MRU-ized order of m_Cache, to avoid moving the data; m_Cache[m_CacheOrder[0]] is the most recently used */
+	std::vector<int> m_CacheOrder;
+	
+	/** Used instead of the cache when it is disabled */
+	sTreeOverflow m_Uncached;
+	
+	/** Cache statistics, reported by GetNumCacheHits() and GetNumCacheMisses() */
+	int m_NumHits;
+	int m_NumMisses;
+	
+	/** Returns the overflow of the trees in the specified chunk's bare terrain, either from the cache, or generated using a_WorkerDesc */
+	const sTreeOverflow & GetTreeOverflow(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_WorkerDesc);
+	
+	/** Generates the bare terrain of the chunk into a_WorkerDesc, generates the trees in it and stores their overflow into a_Overflow */
+	void GenerateTreeOverflow(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_WorkerDesc, sTreeOverflow & a_Overflow);
+	
 	/** Generates and applies an image of a single tree.
 	Parts of the tree inside the chunk are applied to a_BlockX.
 	Parts of the tree outside the chunk are stored in a_OutsideX
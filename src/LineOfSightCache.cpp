@@ -0,0 +1,484 @@
+
+// LineOfSightCache.cpp
+
+// Implements the cLineOfSightCache class that answers and caches the line-of-sight queries of a world
+
+#include "Globals.h"
+#include "LineOfSightCache.h"
+#include "World.h"
+#include "CommandOutput.h"
+
+
+
+
+
+/** Number of ticks for which a traced result is used, unless a block changes around the sight line */
+#define LOS_CACHE_TICKS 10
+
+/** The maximum number of cached results; no more are stored until the old ones expire */
+#define LOS_MAX_RESULTS 20000
+
+/** How far the snapshots reach from their center, horizontally and vertically */
+#define LOS_SNAPSHOT_RADIUS   16
+#define LOS_SNAPSHOT_RADIUS_Y 8
+
+/** The maximum number of snapshots read in a single tick */
+#define LOS_MAX_SNAPSHOTS 8
+
+/** Converts block coords to the coords of the 16^3 section containing the block */
+#define LOS_SECTION(a_BlockCoord) ((a_BlockCoord) >> 4)
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cLineOfSightCache::sKey:
+
+bool cLineOfSightCache::sKey::operator < (const sKey & a_Other) const
+{
+	if (m_From < a_Other.m_From)
+	{
+		return true;
+	}
+	if (a_Other.m_From < m_From)
+	{
+		return false;
+	}
+	return (m_To < a_Other.m_To);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cLineOfSightCache:
+
+cLineOfSightCache::cLineOfSightCache(cWorld & a_World) :
+	m_World(a_World),
+	m_CurrentTick(0),
+	m_ChangeSeq(0),
+	m_NumQueries(0),
+	m_NumHits(0),
+	m_NumInvalidated(0),
+	m_NumSnapshotTraces(0),
+	m_NumWorldTraces(0),
+	m_NumSnapshots(0)
+{
+}
+
+
+
+
+
+cLineOfSightCache::~cLineOfSightCache()
+{
+	for (cSnapshots::iterator itr = m_Snapshots.begin(), end = m_Snapshots.end(); itr != end; ++itr)
+	{
+		delete *itr;
+	}
+}
+
+
+
+
+
+bool cLineOfSightCache::IsVisible(const Vector3d & a_From, const Vector3d & a_To)
+{
+	sKey Key;
+	Key.m_From.Set((int)floor(a_From.x), (int)floor(a_From.y), (int)floor(a_From.z));
+	Key.m_To.Set  ((int)floor(a_To.x),   (int)floor(a_To.y),   (int)floor(a_To.z));
+	cVector3iArray Blocks;
+	GetLineBlocks(a_From, a_To, Blocks);
+
+	Int64 StartSeq;
+	bool ShouldReadSnapshot;
+	{
+		cCSLock Lock(m_CS);
+		m_NumQueries += 1;
+		cResults::iterator itr = m_Results.find(Key);
+		if ((itr != m_Results.end()) && (m_CurrentTick - itr->second.m_Tick < LOS_CACHE_TICKS))
+		{
+			if (IsResultValid(Key, itr->second.m_ChangeSeq))
+			{
+				m_NumHits += 1;
+				return itr->second.m_IsVisible;
+			}
+			m_NumInvalidated += 1;
+		}
+
+		// Not cached, trace through a snapshot, if there's one already:
+		cBlockArea * Snapshot = FindSnapshot(Key.m_From, Key.m_To);
+		if (Snapshot != NULL)
+		{
+			bool IsVisible = TraceInSnapshot(*Snapshot, Blocks);
+			StoreResult(Key, IsVisible, m_ChangeSeq);
+			return IsVisible;
+		}
+		StartSeq = m_ChangeSeq;
+		ShouldReadSnapshot = (m_Snapshots.size() < LOS_MAX_SNAPSHOTS);
+	}
+
+	// Read a new snapshot around the target, the other mobs will likely look at the same target this tick:
+	cBlockArea * Snapshot = ShouldReadSnapshot ? ReadSnapshot(Key.m_To) : NULL;
+	if (Snapshot != NULL)
+	{
+		cCSLock Lock(m_CS);
+		m_NumSnapshots += 1;
+		if (IsInSnapshot(*Snapshot, Key.m_From))
+		{
+			// The snapshot may get invalidated by another thread once added, so trace while still locked:
+			m_Snapshots.push_back(Snapshot);
+			bool IsVisible = TraceInSnapshot(*Snapshot, Blocks);
+			StoreResult(Key, IsVisible, StartSeq);
+			return IsVisible;
+		}
+
+		// The start is outside the snapshot (a very long sight line), the snapshot won't be of much use to others
+		delete Snapshot;
+	}
+
+	// No snapshot, trace through the world:
+	bool IsVisible = true;
+	for (cVector3iArray::const_iterator itr = Blocks.begin(), end = Blocks.end(); itr != end; ++itr)
+	{
+		if ((itr->y >= 0) && (itr->y < cChunkDef::Height) && g_BlockIsSolid[m_World.GetBlock(itr->x, itr->y, itr->z)])
+		{
+			IsVisible = false;
+			break;
+		}
+	}
+	cCSLock Lock(m_CS);
+	m_NumWorldTraces += 1;
+	StoreResult(Key, IsVisible, StartSeq);
+	return IsVisible;
+}
+
+
+
+
+
+void cLineOfSightCache::OnBlockChanged(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	OnAreaChanged(a_BlockX, a_BlockY, a_BlockZ, a_BlockX, a_BlockY, a_BlockZ);
+}
+
+
+
+
+
+void cLineOfSightCache::OnAreaChanged(int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_MaxBlockX, int a_MaxBlockY, int a_MaxBlockZ)
+{
+	cCSLock Lock(m_CS);
+	m_ChangeSeq += 1;
+	for (int y = LOS_SECTION(a_MinBlockY); y <= LOS_SECTION(a_MaxBlockY); y++)
+	{
+		for (int z = LOS_SECTION(a_MinBlockZ); z <= LOS_SECTION(a_MaxBlockZ); z++)
+		{
+			for (int x = LOS_SECTION(a_MinBlockX); x <= LOS_SECTION(a_MaxBlockX); x++)
+			{
+				m_SectionChanges[Vector3i(x, y, z)] = m_ChangeSeq;
+			}
+		}
+	}
+
+	Vector3i Min(a_MinBlockX, a_MinBlockY, a_MinBlockZ);
+	Vector3i Max(a_MaxBlockX, a_MaxBlockY, a_MaxBlockZ);
+	for (cSnapshots::iterator itr = m_Snapshots.begin(); itr != m_Snapshots.end();)
+	{
+		if (DoesSnapshotIntersect(**itr, Min, Max))
+		{
+			delete *itr;
+			itr = m_Snapshots.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+}
+
+
+
+
+
+void cLineOfSightCache::Tick(Int64 a_WorldAge)
+{
+	cCSLock Lock(m_CS);
+	m_CurrentTick = a_WorldAge;
+
+	// Drop the expired results:
+	Int64 MinChangeSeq = m_ChangeSeq;
+	for (cResults::iterator itr = m_Results.begin(); itr != m_Results.end();)
+	{
+		if (m_CurrentTick - itr->second.m_Tick >= LOS_CACHE_TICKS)
+		{
+			m_Results.erase(itr++);
+		}
+		else
+		{
+			MinChangeSeq = std::min(MinChangeSeq, itr->second.m_ChangeSeq);
+			++itr;
+		}
+	}
+
+	// Drop the section changes that happened before all of the remaining results were traced:
+	for (cSectionChanges::iterator itr = m_SectionChanges.begin(); itr != m_SectionChanges.end();)
+	{
+		if (itr->second <= MinChangeSeq)
+		{
+			m_SectionChanges.erase(itr++);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+
+	// The snapshots are only good for a single tick, the entities move:
+	for (cSnapshots::iterator itr = m_Snapshots.begin(), end = m_Snapshots.end(); itr != end; ++itr)
+	{
+		delete *itr;
+	}
+	m_Snapshots.clear();
+}
+
+
+
+
+
+void cLineOfSightCache::LogStats(cCommandOutputCallback & a_Output)
+{
+	cCSLock Lock(m_CS);
+	a_Output.Out("  Line of sight: %lld queries, %lld answered from the cache (%.1f %%), %lld results invalidated by block changes",
+		m_NumQueries, m_NumHits, (m_NumQueries > 0) ? (100.0 * m_NumHits / m_NumQueries) : 0.0, m_NumInvalidated
+	);
+	a_Output.Out("    %lld traces in %lld snapshots, %lld traces in the world; %u results cached",
+		m_NumSnapshotTraces, m_NumSnapshots, m_NumWorldTraces, (unsigned)m_Results.size()
+	);
+}
+
+
+
+
+
+bool cLineOfSightCache::IsResultValid(const sKey & a_Key, Int64 a_ChangeSeq) const
+{
+	if (m_SectionChanges.empty())
+	{
+		return true;
+	}
+	int MinX = LOS_SECTION(std::min(a_Key.m_From.x, a_Key.m_To.x));
+	int MaxX = LOS_SECTION(std::max(a_Key.m_From.x, a_Key.m_To.x));
+	int MinY = LOS_SECTION(std::min(a_Key.m_From.y, a_Key.m_To.y));
+	int MaxY = LOS_SECTION(std::max(a_Key.m_From.y, a_Key.m_To.y));
+	int MinZ = LOS_SECTION(std::min(a_Key.m_From.z, a_Key.m_To.z));
+	int MaxZ = LOS_SECTION(std::max(a_Key.m_From.z, a_Key.m_To.z));
+	for (int y = MinY; y <= MaxY; y++)
+	{
+		for (int z = MinZ; z <= MaxZ; z++)
+		{
+			for (int x = MinX; x <= MaxX; x++)
+			{
+				cSectionChanges::const_iterator itr = m_SectionChanges.find(Vector3i(x, y, z));
+				if ((itr != m_SectionChanges.end()) && (itr->second > a_ChangeSeq))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+
+
+
+
+cBlockArea * cLineOfSightCache::FindSnapshot(const Vector3i & a_From, const Vector3i & a_To) const
+{
+	for (cSnapshots::const_iterator itr = m_Snapshots.begin(), end = m_Snapshots.end(); itr != end; ++itr)
+	{
+		if (IsInSnapshot(**itr, a_From) && IsInSnapshot(**itr, a_To))
+		{
+			return *itr;
+		}
+	}
+	return NULL;
+}
+
+
+
+
+
+cBlockArea * cLineOfSightCache::ReadSnapshot(const Vector3i & a_Center)
+{
+	Int64 StartSeq;
+	{
+		cCSLock Lock(m_CS);
+		StartSeq = m_ChangeSeq;
+	}
+
+	int MinY = std::max(a_Center.y - LOS_SNAPSHOT_RADIUS_Y, 0);
+	int MaxY = std::min(a_Center.y + LOS_SNAPSHOT_RADIUS_Y, cChunkDef::Height - 1);
+	if (MinY > MaxY)
+	{
+		return NULL;
+	}
+	cBlockArea * Snapshot = new cBlockArea;
+	if (!Snapshot->Read(
+		&m_World,
+		a_Center.x - LOS_SNAPSHOT_RADIUS, a_Center.x + LOS_SNAPSHOT_RADIUS,
+		MinY, MaxY,
+		a_Center.z - LOS_SNAPSHOT_RADIUS, a_Center.z + LOS_SNAPSHOT_RADIUS,
+		cBlockArea::baTypes
+	))
+	{
+		// Some of the chunks are not loaded
+		delete Snapshot;
+		return NULL;
+	}
+
+	// If a block changed in the area while reading, the snapshot may be inconsistent:
+	cCSLock Lock(m_CS);
+	if (m_ChangeSeq != StartSeq)
+	{
+		for (int y = LOS_SECTION(MinY); y <= LOS_SECTION(MaxY); y++)
+		{
+			for (int z = LOS_SECTION(a_Center.z - LOS_SNAPSHOT_RADIUS); z <= LOS_SECTION(a_Center.z + LOS_SNAPSHOT_RADIUS); z++)
+			{
+				for (int x = LOS_SECTION(a_Center.x - LOS_SNAPSHOT_RADIUS); x <= LOS_SECTION(a_Center.x + LOS_SNAPSHOT_RADIUS); x++)
+				{
+					cSectionChanges::const_iterator itr = m_SectionChanges.find(Vector3i(x, y, z));
+					if ((itr != m_SectionChanges.end()) && (itr->second > StartSeq))
+					{
+						delete Snapshot;
+						return NULL;
+					}
+				}
+			}
+		}
+	}
+	return Snapshot;
+}
+
+
+
+
+
+void cLineOfSightCache::StoreResult(const sKey & a_Key, bool a_IsVisible, Int64 a_ChangeSeq)
+{
+	if (m_Results.size() >= LOS_MAX_RESULTS)
+	{
+		return;
+	}
+	sResult & Result = m_Results[a_Key];
+	Result.m_IsVisible = a_IsVisible;
+	Result.m_Tick = m_CurrentTick;
+	Result.m_ChangeSeq = a_ChangeSeq;
+}
+
+
+
+
+
+bool cLineOfSightCache::TraceInSnapshot(const cBlockArea & a_Snapshot, const cVector3iArray & a_Blocks)
+{
+	m_NumSnapshotTraces += 1;
+	for (cVector3iArray::const_iterator itr = a_Blocks.begin(), end = a_Blocks.end(); itr != end; ++itr)
+	{
+		if (g_BlockIsSolid[a_Snapshot.GetBlockType(itr->x, itr->y, itr->z)])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+
+
+bool cLineOfSightCache::IsInSnapshot(const cBlockArea & a_Snapshot, const Vector3i & a_Block)
+{
+	return (
+		(a_Block.x >= a_Snapshot.GetOriginX()) && (a_Block.x < a_Snapshot.GetOriginX() + a_Snapshot.GetSizeX()) &&
+		(a_Block.y >= a_Snapshot.GetOriginY()) && (a_Block.y < a_Snapshot.GetOriginY() + a_Snapshot.GetSizeY()) &&
+		(a_Block.z >= a_Snapshot.GetOriginZ()) && (a_Block.z < a_Snapshot.GetOriginZ() + a_Snapshot.GetSizeZ())
+	);
+}
+
+
+
+
+
+bool cLineOfSightCache::DoesSnapshotIntersect(const cBlockArea & a_Snapshot, const Vector3i & a_Min, const Vector3i & a_Max)
+{
+	return (
+		(a_Max.x >= a_Snapshot.GetOriginX()) && (a_Min.x < a_Snapshot.GetOriginX() + a_Snapshot.GetSizeX()) &&
+		(a_Max.y >= a_Snapshot.GetOriginY()) && (a_Min.y < a_Snapshot.GetOriginY() + a_Snapshot.GetSizeY()) &&
+		(a_Max.z >= a_Snapshot.GetOriginZ()) && (a_Min.z < a_Snapshot.GetOriginZ() + a_Snapshot.GetSizeZ())
+	);
+}
+
+
+
+
+
+void cLineOfSightCache::GetLineBlocks(const Vector3d & a_From, const Vector3d & a_To, cVector3iArray & a_Blocks)
+{
+	// A voxel traversal (Amanatides & Woo) from the start block to the end block:
+	Vector3i Pos((int)floor(a_From.x), (int)floor(a_From.y), (int)floor(a_From.z));
+	Vector3i End((int)floor(a_To.x),   (int)floor(a_To.y),   (int)floor(a_To.z));
+	Vector3d Dir = a_To - a_From;
+	int StepX = (Dir.x > 0) ? 1 : -1;
+	int StepY = (Dir.y > 0) ? 1 : -1;
+	int StepZ = (Dir.z > 0) ? 1 : -1;
+
+	// The line parameter at which the next block boundary is crossed on each axis, and the parameter step per block:
+	static const double Never = 1e30;
+	double MaxX = Never, MaxY = Never, MaxZ = Never;
+	double DeltaX = Never, DeltaY = Never, DeltaZ = Never;
+	if (Dir.x != 0)
+	{
+		DeltaX = 1 / fabs(Dir.x);
+		MaxX = ((StepX > 0) ? (Pos.x + 1 - a_From.x) : (a_From.x - Pos.x)) * DeltaX;
+	}
+	if (Dir.y != 0)
+	{
+		DeltaY = 1 / fabs(Dir.y);
+		MaxY = ((StepY > 0) ? (Pos.y + 1 - a_From.y) : (a_From.y - Pos.y)) * DeltaY;
+	}
+	if (Dir.z != 0)
+	{
+		DeltaZ = 1 / fabs(Dir.z);
+		MaxZ = ((StepZ > 0) ? (Pos.z + 1 - a_From.z) : (a_From.z - Pos.z)) * DeltaZ;
+	}
+
+	a_Blocks.clear();
+	int NumSteps = abs(End.x - Pos.x) + abs(End.y - Pos.y) + abs(End.z - Pos.z);
+	for (int i = 1; i < NumSteps; i++)
+	{
+		if ((MaxX < MaxY) && (MaxX < MaxZ))
+		{
+			Pos.x += StepX;
+			MaxX += DeltaX;
+		}
+		else if (MaxY < MaxZ)
+		{
+			Pos.y += StepY;
+			MaxY += DeltaY;
+		}
+		else
+		{
+			Pos.z += StepZ;
+			MaxZ += DeltaZ;
+		}
+		a_Blocks.push_back(Pos);
+	}
+}
+
+
+
+
@@ -0,0 +1,136 @@
+
+// LineOfSightCache.h
+
+// Declares the cLineOfSightCache class that answers and caches the line-of-sight queries of a world
+
+/*
+The mobs look for the closest visible player each tick, which used to mean a ray trace per mob and player every
+tick. The results are now cached for a few ticks, keyed by the blocks of both ends of the sight line. A cached
+result is dropped as soon as a block changes in any 16^3 section that the sight line's bounding box touches, the
+chunks report each block change through OnBlockChanged(), and the bulk changes (loading a chunk, writing a
+cBlockArea) through OnAreaChanged().
+
+The traces that aren't cached are batched: the first one around a position in a tick reads a snapshot of the
+blocks around its target end, the following traces that fit into the snapshot use it instead of querying the
+world block-by-block. The snapshots are dropped each tick and when a block in them changes.
+*/
+
+
+
+
+
+#pragma once
+
+#include "BlockArea.h"
+#include "Vector3d.h"
+#include "Vector3i.h"
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+class cWorld;
+
+
+
+
+
+class cLineOfSightCache
+{
+public:
+	cLineOfSightCache(cWorld & a_World);
+	~cLineOfSightCache();
+
+	/** Returns true if no solid block is between the two points */
+	bool IsVisible(const Vector3d & a_From, const Vector3d & a_To);
+
+	/** Called by the chunks whenever a block changes, drops the results and snapshots that the change affects */
+	void OnBlockChanged(int a_BlockX, int a_BlockY, int a_BlockZ);
+
+	/** Called by the chunks when they replace many blocks at once (loading, writing a cBlockArea), drops the results
+	and snapshots touching the area. The bounds are inclusive. */
+	void OnAreaChanged(int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_MaxBlockX, int a_MaxBlockY, int a_MaxBlockZ);
+
+	/** Called by the world once per tick; drops the expired results and all the snapshots */
+	void Tick(Int64 a_WorldAge);
+
+	/** Outputs the statistics of the queries */
+	void LogStats(cCommandOutputCallback & a_Output);
+
+protected:
+	/** The key of a cached result, the blocks of both ends of the sight line */
+	struct sKey
+	{
+		Vector3i m_From;
+		Vector3i m_To;
+
+		bool operator < (const sKey & a_Other) const;
+	} ;
+
+	struct sResult
+	{
+		bool  m_IsVisible;
+		Int64 m_Tick;       ///< The tick when the result was traced, for expiring
+		Int64 m_ChangeSeq;  ///< m_ChangeSeq at the time of the trace; a section changed later makes the result invalid
+	} ;
+
+	typedef std::map<sKey, sResult> cResults;
+
+	/** Sequence numbers of the last block change in each 16^3 section, indexed by the section coords */
+	typedef std::map<Vector3i, Int64> cSectionChanges;
+
+	typedef std::vector<cBlockArea *> cSnapshots;
+
+	cWorld & m_World;
+
+	/** Protects everything below. Never held while reading from the world, the chunks call OnBlockChanged() with
+	the chunkmap locked. */
+	cCriticalSection m_CS;
+
+	cResults        m_Results;
+	cSectionChanges m_SectionChanges;
+	cSnapshots      m_Snapshots;
+	Int64           m_CurrentTick;
+
+	/** Incremented on each block change */
+	Int64 m_ChangeSeq;
+
+	// Statistics:
+	Int64 m_NumQueries;
+	Int64 m_NumHits;
+	Int64 m_NumInvalidated;
+	Int64 m_NumSnapshotTraces;
+	Int64 m_NumWorldTraces;
+	Int64 m_NumSnapshots;
+
+	/** Returns true if a result traced at a_ChangeSeq is still valid for the sight line. Expects m_CS to be locked. */
+	bool IsResultValid(const sKey & a_Key, Int64 a_ChangeSeq) const;
+
+	/** Returns the snapshot containing both blocks, or NULL if none. Expects m_CS to be locked. */
+	cBlockArea * FindSnapshot(const Vector3i & a_From, const Vector3i & a_To) const;
+
+	/** Reads a new snapshot around a_Center. Returns NULL if it cannot be read, or if the blocks changed while reading.
+	Expects m_CS NOT to be locked, the reading locks the chunkmap. */
+	cBlockArea * ReadSnapshot(const Vector3i & a_Center);
+
+	/** Stores the result of a trace started at a_ChangeSeq, unless the cache is full. Expects m_CS to be locked. */
+	void StoreResult(const sKey & a_Key, bool a_IsVisible, Int64 a_ChangeSeq);
+
+	/** Returns true if none of the blocks is solid in the snapshot. Expects m_CS to be locked. */
+	bool TraceInSnapshot(const cBlockArea & a_Snapshot, const cVector3iArray & a_Blocks);
+
+	/** Returns true if the block is inside the snapshot */
+	static bool IsInSnapshot(const cBlockArea & a_Snapshot, const Vector3i & a_Block);
+
+	/** Returns true if any block of the area (inclusive bounds) is inside the snapshot */
+	static bool DoesSnapshotIntersect(const cBlockArea & a_Snapshot, const Vector3i & a_Min, const Vector3i & a_Max);
+
+	/** Fills a_Blocks with the blocks that the sight line passes through, excluding the blocks of its ends */
+	static void GetLineBlocks(const Vector3d & a_From, const Vector3d & a_To, cVector3iArray & a_Blocks);
+} ;
+
+
+
+
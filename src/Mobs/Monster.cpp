@@ -18,6 +18,13 @@
 
 
 
+/** A new path is requested when the destination moves more than this many blocks from the target of the current path */
+#define MONSTER_PATH_RETARGET_DISTANCE 2
+
+
+
+
+
 /** Map for eType <-> string
 Needs to be alpha-sorted by the strings, because binary search is used in StringToMobType()
 The strings need to be lowercase (for more efficient comparisons in StringToMobType())
@@ -71,6 +78,8 @@ cMonster::cMonster(const AString & a_ConfigName, eType a_MobType, const AString
 	, m_EMPersonality(AGGRESSIVE)
 	, m_Target(NULL)
 	, m_bMovingToDestination(false)
+	, m_PathRequestID(0)
+	, m_NextPathPoint(0)
 	, m_LastGroundHeight(POSY_TOINT)
 	, m_IdleInterval(0)
 	, m_DestroyTimer(0)
@@ -105,74 +114,107 @@ void cMonster::SpawnOn(cClientHandle & a_Client)
 
 void cMonster::TickPathFinding()
 {
-	int PosX = (int)floor(GetPosX());
-	int PosY = (int)floor(GetPosY());
-	int PosZ = (int)floor(GetPosZ());
-
 	m_FinalDestination.y = (double)FindFirstNonAirBlockPosition(m_FinalDestination.x, m_FinalDestination.z);
 
-	std::vector<Vector3d> m_PotentialCoordinates;
-	m_TraversedCoordinates.push_back(Vector3i(PosX, PosY, PosZ));
-
-	static const struct // Define which directions to try to move to
-	{
-		int x, z;
-	} gCrossCoords[] =
+	if (m_NextPathPoint < m_Path.size())
 	{
-		{ 1, 0},
-		{-1, 0},
-		{ 0, 1},
-		{ 0,-1},
-	} ;
+		// Walk to the next point of the path:
+		const Vector3i & Point = m_Path[m_NextPathPoint];
+		m_NextPathPoint += 1;
+		m_Destination = Vector3d(Point.x + 0.5, Point.y, Point.z + 0.5);
+		return;
+	}
 
-	for (size_t i = 0; i < ARRAYCOUNT(gCrossCoords); i++)
+	// The path has been walked through (it may have been a partial one), or there's none yet; wait in place for a new one:
+	if (m_PathRequestID == 0)
 	{
-		if ((gCrossCoords[i].x + PosX == PosX) && (gCrossCoords[i].z + PosZ == PosZ))
-		{
-			continue;
-		}
+		RequestPath();
+	}
+	m_Destination = GetPosition();
+}
 
-		if (IsCoordinateInTraversedList(Vector3i(gCrossCoords[i].x + PosX, PosY, gCrossCoords[i].z + PosZ)))
-		{
-			continue;
-		}
 
-		BLOCKTYPE BlockAtY = m_World->GetBlock(gCrossCoords[i].x + PosX, PosY, gCrossCoords[i].z + PosZ);
-		BLOCKTYPE BlockAtYP = m_World->GetBlock(gCrossCoords[i].x + PosX, PosY + 1, gCrossCoords[i].z + PosZ);
-		BLOCKTYPE BlockAtYPP = m_World->GetBlock(gCrossCoords[i].x + PosX, PosY + 2, gCrossCoords[i].z + PosZ);
-		BLOCKTYPE BlockAtYM = m_World->GetBlock(gCrossCoords[i].x + PosX, PosY - 1, gCrossCoords[i].z + PosZ);
 
-		if (!g_BlockIsSolid[BlockAtY] && !g_BlockIsSolid[BlockAtYP] && !IsBlockLava(BlockAtYM))
-		{
-			m_PotentialCoordinates.push_back(Vector3d((gCrossCoords[i].x + PosX), PosY, gCrossCoords[i].z + PosZ));
-		}
-		else if (g_BlockIsSolid[BlockAtY] && !g_BlockIsSolid[BlockAtYP] && !g_BlockIsSolid[BlockAtYPP] && !IsBlockLava(BlockAtYM))
-		{
-			m_PotentialCoordinates.push_back(Vector3d((gCrossCoords[i].x + PosX), PosY + 1, gCrossCoords[i].z + PosZ));
-		}
+
+
+void cMonster::RequestPath(void)
+{
+	cPathService & PathService = m_World->GetPathService();
+	if (m_PathRequestID != 0)
+	{
+		PathService.CancelRequest(m_PathRequestID);
 	}
+	Vector3i Start((int)floor(GetPosX()), (int)floor(GetPosY()), (int)floor(GetPosZ()));
+	m_PathTarget.Set((int)floor(m_FinalDestination.x), (int)floor(m_FinalDestination.y), (int)floor(m_FinalDestination.z));
+	m_PathRequestID = PathService.RequestPath(Start, m_PathTarget);
+}
+
+
+
 
-	if (!m_PotentialCoordinates.empty())
+
+void cMonster::CheckPathResult(void)
+{
+	cVector3iArray Path;
+	switch (m_World->GetPathService().GetResult(m_PathRequestID, Path))
 	{
-		Vector3f ShortestCoords = m_PotentialCoordinates.front();
-		for (std::vector<Vector3d>::const_iterator itr = m_PotentialCoordinates.begin(); itr != m_PotentialCoordinates.end(); ++itr)
+		case cPathService::psPending:
+		{
+			return;
+		}
+		case cPathService::psFound:
+		case cPathService::psPartial:
 		{
-			Vector3f Distance = m_FinalDestination - ShortestCoords;
-			Vector3f Distance2 = m_FinalDestination - *itr;
-			if (Distance.SqrLength() > Distance2.SqrLength())
+			// The mob may have moved since the request, continue from the point nearest to it:
+			m_PathRequestID = 0;
+			std::swap(m_Path, Path);
+			if (m_Path.empty())
 			{
-				ShortestCoords = *itr;
+				m_NextPathPoint = 0;
+				m_Destination = m_FinalDestination;
+				return;
 			}
+			size_t Nearest = 0;
+			double NearestDist = 1e30;
+			for (size_t i = 0; i < m_Path.size(); i++)
+			{
+				double Dist = (Vector3d(m_Path[i].x + 0.5, m_Path[i].y, m_Path[i].z + 0.5) - GetPosition()).SqrLength();
+				if (Dist < NearestDist)
+				{
+					Nearest = i;
+					NearestDist = Dist;
+				}
+			}
+			m_NextPathPoint = std::min(Nearest + 1, m_Path.size() - 1);
+			TickPathFinding();
+			return;
+		}
+		case cPathService::psNoPath:
+		{
+			// There's no known way, head straight for the destination:
+			m_PathRequestID = 0;
+			m_Path.clear();
+			m_NextPathPoint = 0;
+			m_Destination = m_FinalDestination;
+			return;
 		}
-
-		m_Destination = ShortestCoords;
-		m_Destination.z += 0.5f;
-		m_Destination.x += 0.5f;
 	}
-	else
+}
+
+
+
+
+
+void cMonster::FinishPathFinding(void)
+{
+	if (m_PathRequestID != 0)
 	{
-		FinishPathFinding();
+		m_World->GetPathService().CancelRequest(m_PathRequestID);
+		m_PathRequestID = 0;
 	}
+	m_Path.clear();
+	m_NextPathPoint = 0;
+	m_bMovingToDestination = false;
 }
 
 
@@ -181,11 +223,7 @@ void cMonster::TickPathFinding()
 
 void cMonster::MoveToPosition(const Vector3f & a_Position)
 {
-	FinishPathFinding();
-
-	m_FinalDestination = a_Position;
-	m_bMovingToDestination = true;
-	TickPathFinding();
+	MoveToPosition(Vector3d(a_Position.x, a_Position.y, a_Position.z));
 }
 
 
@@ -194,26 +232,35 @@ void cMonster::MoveToPosition(const Vector3f & a_Position)
 
 void cMonster::MoveToPosition(const Vector3d & a_Position)
 {
-	FinishPathFinding();
-
+	bool WasMoving = m_bMovingToDestination;
 	m_FinalDestination = a_Position;
 	m_bMovingToDestination = true;
-	TickPathFinding();
-}
-
-
 
-bool cMonster::IsCoordinateInTraversedList(Vector3i a_Coords)
-{
-	for (std::vector<Vector3i>::const_iterator itr = m_TraversedCoordinates.begin(); itr != m_TraversedCoordinates.end(); ++itr)
+	// Keep following the current path, or waiting for the requested one, if it leads close enough to the new destination:
+	Vector3i Target((int)floor(a_Position.x), (int)floor(a_Position.y), (int)floor(a_Position.z));
+	bool HasPath = (m_PathRequestID != 0) || (m_NextPathPoint < m_Path.size());
+	if (
+		WasMoving && HasPath &&
+		(std::abs(Target.x - m_PathTarget.x) <= MONSTER_PATH_RETARGET_DISTANCE) &&
+		(std::abs(Target.z - m_PathTarget.z) <= MONSTER_PATH_RETARGET_DISTANCE) &&
+		(std::abs(Target.y - m_PathTarget.y) <= 1)
+	)
 	{
-		if (itr->Equals(a_Coords))
-		{
-			return true;
-		}
+		return;
 	}
 
-	return false;
+	if (!WasMoving)
+	{
+		// Any leftovers are from a different movement:
+		m_Path.clear();
+		m_NextPathPoint = 0;
+	}
+	RequestPath();
+	if (m_NextPathPoint >= m_Path.size())
+	{
+		// Nothing to follow until the path is found, wait in place:
+		m_Destination = GetPosition();
+	}
 }
 
 
@@ -272,6 +319,11 @@ void cMonster::Tick(float a_Dt, cChunk & a_Chunk)
 
 	if (m_bMovingToDestination)
 	{
+		if (m_PathRequestID != 0)
+		{
+			CheckPathResult();
+		}
+
 		if (m_bOnGround)
 		{
 			m_Destination.y = FindFirstNonAirBlockPosition(m_Destination.x, m_Destination.z);
@@ -181,20 +181,25 @@ protected:
 		return ((a_PosY > (int)floor(GetPosY())) && (a_PosY == (int)floor(GetPosY()) + 1));
 	}
 
-	/** A semi-temporary list to store the traversed coordinates during active pathfinding so we don't visit them again */
-	std::vector<Vector3i> m_TraversedCoordinates;
-	/** Returns if coordinate is in the traversed list */
-	bool IsCoordinateInTraversedList(Vector3i a_Coords);
+	/** The ID of the pending request in the world's cPathService, 0 if none */
+	int m_PathRequestID;
+	/** The target block for which the current path or the pending request was made */
+	Vector3i m_PathTarget;
+	/** The path being followed, as the blocks where the mob's feet go */
+	cVector3iArray m_Path;
+	/** Index into m_Path of the next point to walk to */
+	size_t m_NextPathPoint;
+
+	/** Requests a new path from the current position to m_FinalDestination, replacing any pending request */
+	void RequestPath(void);
+	/** Picks up the result of the pending path request, if it is ready */
+	void CheckPathResult(void);
 
 	/** Finds the next place to go
-		This is based on the ultimate, final destination and the current position, as well as the traversed coordinates, and any environmental hazards */
+		This is the next point of the path to the ultimate, final destination; requests a new path if there is none */
 	void TickPathFinding(void);
 	/** Finishes a pathfinding task, be it due to failure or something else */
-	inline void FinishPathFinding(void)
-	{
-		m_TraversedCoordinates.clear();
-		m_bMovingToDestination = false;
-	}
+	void FinishPathFinding(void);
 	/** Sets the body yaw and head yaw/pitch based on next/ultimate destinations */
 	void SetPitchAndYawFromDestination(void);
 
@@ -0,0 +1,320 @@
+
+// PathFinder.cpp
+
+// Implements the cPathFinder class representing a bounded A* search for a walking mob's path within a snapshot of blocks
+
+#include "Globals.h"
+#include "PathFinder.h"
+#include "../Defines.h"
+
+
+
+
+
+/** The highest drop that the mobs will take when walking down; higher drops would hurt them */
+#define PATHFINDER_MAX_DROP 3
+
+/** The cost of a horizontal step. Jumping up costs one more, dropping costs one more per block dropped. */
+#define PATHFINDER_STEP_COST 1
+
+
+
+
+
+cPathFinder::cPathFinder(void) :
+	m_BlockTypes(NULL),
+	m_MaxNodes(0),
+	m_SearchID(0),
+	m_NumExpanded(0),
+	m_StartIdx(-1),
+	m_EndIdx(-1),
+	m_EndDistance(0),
+	m_Status(fsNoPath)
+{
+}
+
+
+
+
+
+void cPathFinder::Start(
+	const BLOCKTYPE * a_BlockTypes, const Vector3i & a_Origin, const Vector3i & a_Size,
+	const Vector3i & a_Start, const Vector3i & a_Target, int a_MaxNodes
+)
+{
+	m_BlockTypes = a_BlockTypes;
+	m_Origin = a_Origin;
+	m_Size = a_Size;
+	m_Target = a_Target;
+	m_MaxNodes = a_MaxNodes;
+	m_NumExpanded = 0;
+	m_Open.clear();
+
+	// Grow the cell array if needed; a new ID makes all the cells unvisited without clearing them:
+	size_t NumCells = (size_t)(a_Size.x * a_Size.y * a_Size.z);
+	if (m_Cells.size() < NumCells)
+	{
+		sCell Unvisited;
+		Unvisited.m_SearchID = -1;
+		m_Cells.resize(NumCells, Unvisited);
+	}
+	m_SearchID += 1;
+	if (m_SearchID == 0x7fffffff)
+	{
+		// The IDs have wrapped around, mark all the cells as unvisited explicitly:
+		for (std::vector<sCell>::iterator itr = m_Cells.begin(), end = m_Cells.end(); itr != end; ++itr)
+		{
+			itr->m_SearchID = -1;
+		}
+		m_SearchID = 0;
+	}
+
+	m_StartIdx = MakeIndex(a_Start.x, a_Start.y, a_Start.z);
+	if (m_StartIdx < 0)
+	{
+		m_Status = fsNoPath;
+		return;
+	}
+	sCell & Start = GetCell(m_StartIdx);
+	Start.m_Cost = 0;
+	m_EndIdx = m_StartIdx;
+	m_EndDistance = GetHeuristic(a_Start);
+	m_Open.push_back(cOpenNode(m_EndDistance, m_StartIdx));
+	m_Status = fsSearching;
+}
+
+
+
+
+
+void cPathFinder::AddKnownPoint(const Vector3i & a_Point, int a_Index)
+{
+	int Idx = MakeIndex(a_Point.x, a_Point.y, a_Point.z);
+	if (Idx >= 0)
+	{
+		GetCell(Idx).m_KnownIndex = a_Index;
+	}
+}
+
+
+
+
+
+cPathFinder::eStatus cPathFinder::Step(int & a_NodeBudget)
+{
+	while ((m_Status == fsSearching) && (a_NodeBudget > 0))
+	{
+		if (m_Open.empty())
+		{
+			// Everything reachable has been searched, the target is not reachable
+			return Finish((m_EndIdx == m_StartIdx) ? fsNoPath : fsPartial, m_EndIdx);
+		}
+		if (m_NumExpanded >= m_MaxNodes)
+		{
+			return Finish((m_EndIdx == m_StartIdx) ? fsNoPath : fsPartial, m_EndIdx);
+		}
+
+		// Pop the node with the lowest estimated cost:
+		std::pop_heap(m_Open.begin(), m_Open.end(), std::greater<cOpenNode>());
+		int Idx = m_Open.back().second;
+		m_Open.pop_back();
+		sCell & Cell = GetCell(Idx);
+		if (Cell.m_IsClosed)
+		{
+			// An outdated entry, the node has been expanded through a cheaper path already
+			continue;
+		}
+		Cell.m_IsClosed = true;
+		m_NumExpanded += 1;
+		a_NodeBudget -= 1;
+
+		Vector3i Pos = IndexToCoords(Idx);
+		if (IsAtTarget(Pos) || ((Cell.m_KnownIndex >= 0) && (Idx != m_StartIdx)))
+		{
+			return Finish(fsFound, Idx);
+		}
+		int Distance = GetHeuristic(Pos);
+		if (Distance < m_EndDistance)
+		{
+			m_EndDistance = Distance;
+			m_EndIdx = Idx;
+		}
+
+		// Add the neighbors:
+		static const struct
+		{
+			int x, z;
+		} Dirs[] =
+		{
+			{ 1,  0},
+			{-1,  0},
+			{ 0,  1},
+			{ 0, -1},
+		} ;
+		int Cost = Cell.m_Cost;
+		for (size_t i = 0; i < ARRAYCOUNT(Dirs); i++)
+		{
+			int X = Pos.x + Dirs[i].x;
+			int Z = Pos.z + Dirs[i].z;
+			if (CanStand(X, Pos.y, Z))
+			{
+				// Walk
+				ProcessNeighbor(Idx, Cost, X, Pos.y, Z, PATHFINDER_STEP_COST);
+			}
+			else if (!IsPassable(X, Pos.y, Z))
+			{
+				// Jump up, if there's room above the mob's head for the jump:
+				if (CanStand(X, Pos.y + 1, Z) && IsPassable(Pos.x, Pos.y + 2, Pos.z))
+				{
+					ProcessNeighbor(Idx, Cost, X, Pos.y + 1, Z, PATHFINDER_STEP_COST + 1);
+				}
+			}
+			else if (IsPassable(X, Pos.y + 1, Z))
+			{
+				// Drop down:
+				for (int Drop = 1; Drop <= PATHFINDER_MAX_DROP; Drop++)
+				{
+					if (!IsPassable(X, Pos.y - Drop, Z))
+					{
+						break;
+					}
+					if (CanStand(X, Pos.y - Drop, Z))
+					{
+						ProcessNeighbor(Idx, Cost, X, Pos.y - Drop, Z, PATHFINDER_STEP_COST + Drop);
+						break;
+					}
+				}
+			}
+		}  // for i - Dirs[]
+	}
+	return m_Status;
+}
+
+
+
+
+
+void cPathFinder::GetPath(cVector3iArray & a_Path) const
+{
+	a_Path.clear();
+	if ((m_Status != fsFound) && (m_Status != fsPartial))
+	{
+		return;
+	}
+	for (int Idx = m_EndIdx; Idx >= 0; Idx = m_Cells[Idx].m_Parent)
+	{
+		a_Path.push_back(IndexToCoords(Idx));
+	}
+	std::reverse(a_Path.begin(), a_Path.end());
+}
+
+
+
+
+
+int cPathFinder::GetKnownPointIndex(void) const
+{
+	if ((m_Status != fsFound) || (m_EndIdx < 0))
+	{
+		return -1;
+	}
+	return m_Cells[m_EndIdx].m_KnownIndex;
+}
+
+
+
+
+
+int cPathFinder::MakeIndex(int a_X, int a_Y, int a_Z) const
+{
+	int RelX = a_X - m_Origin.x;
+	int RelY = a_Y - m_Origin.y;
+	int RelZ = a_Z - m_Origin.z;
+	if (
+		(RelX < 0) || (RelX >= m_Size.x) ||
+		(RelY < 0) || (RelY >= m_Size.y) ||
+		(RelZ < 0) || (RelZ >= m_Size.z)
+	)
+	{
+		return -1;
+	}
+	return RelX + RelZ * m_Size.x + RelY * m_Size.x * m_Size.z;
+}
+
+
+
+
+
+Vector3i cPathFinder::IndexToCoords(int a_Idx) const
+{
+	int LayerSize = m_Size.x * m_Size.z;
+	int RelY = a_Idx / LayerSize;
+	int RelZ = (a_Idx % LayerSize) / m_Size.x;
+	int RelX = a_Idx % m_Size.x;
+	return Vector3i(m_Origin.x + RelX, m_Origin.y + RelY, m_Origin.z + RelZ);
+}
+
+
+
+
+
+bool cPathFinder::IsPassable(int a_X, int a_Y, int a_Z) const
+{
+	int Block = GetBlock(a_X, a_Y, a_Z);
+	return (Block >= 0) && !g_BlockIsSolid[Block] && !IsBlockLava((BLOCKTYPE)Block);
+}
+
+
+
+
+
+bool cPathFinder::CanStand(int a_X, int a_Y, int a_Z) const
+{
+	if (!IsPassable(a_X, a_Y, a_Z) || !IsPassable(a_X, a_Y + 1, a_Z))
+	{
+		return false;
+	}
+	if (IsBlockWater((BLOCKTYPE)GetBlock(a_X, a_Y, a_Z)))
+	{
+		// Swimming
+		return true;
+	}
+	int Below = GetBlock(a_X, a_Y - 1, a_Z);
+	return (Below >= 0) && g_BlockIsSolid[Below];
+}
+
+
+
+
+
+void cPathFinder::ProcessNeighbor(int a_FromIdx, int a_FromCost, int a_X, int a_Y, int a_Z, int a_StepCost)
+{
+	int Idx = MakeIndex(a_X, a_Y, a_Z);
+	ASSERT(Idx >= 0);  // CanStand() has checked the coords
+	sCell & Cell = GetCell(Idx);
+	int Cost = a_FromCost + a_StepCost;
+	if (Cell.m_IsClosed || (Cell.m_Cost <= Cost))
+	{
+		return;
+	}
+	Cell.m_Cost = Cost;
+	Cell.m_Parent = a_FromIdx;
+	m_Open.push_back(cOpenNode(Cost + GetHeuristic(Vector3i(a_X, a_Y, a_Z)), Idx));
+	std::push_heap(m_Open.begin(), m_Open.end(), std::greater<cOpenNode>());
+}
+
+
+
+
+
+cPathFinder::eStatus cPathFinder::Finish(eStatus a_Status, int a_EndIdx)
+{
+	m_Status = a_Status;
+	m_EndIdx = a_EndIdx;
+	m_Open.clear();
+	return m_Status;
+}
+
+
+
+
@@ -0,0 +1,160 @@
+
+// PathFinder.h
+
+// Declares the cPathFinder class representing a bounded A* search for a walking mob's path within a snapshot of blocks
+
+/*
+The search works on a box of block types (XZY-ordered, same as cBlockArea), so it doesn't touch the world and can
+run in any thread. A node is a block where the mob's feet are. A mob can stand in a node if the node and the block
+above are passable and the block below is solid, or the node is in water. From each node the mob can walk to the
+4 horizontal neighbors at the same level, jump up one block, or drop down at most PATHFINDER_MAX_DROP blocks.
+
+The search is resumable: Step() expands at most the given number of nodes and can be called again later, so that the
+caller can spread a long search over several ticks. The total number of expanded nodes is limited; if the target
+is not reached within the limit, the path to the node closest to the target is returned instead.
+
+Known points can be added to the search; these are points from which the path to the target is already known
+(such as another mob's path to the same target). Reaching any of them finishes the search.
+
+The per-node data is kept in arrays the size of the snapshot, stamped with the search ID, so that a new search
+doesn't need to clear them and the arrays are reused by all the searches.
+*/
+
+
+
+
+
+#pragma once
+
+#include "../Vector3i.h"
+
+
+
+
+
+class cPathFinder
+{
+public:
+	enum eStatus
+	{
+		fsSearching,  ///< The search is not finished yet, call Step() again
+		fsFound,      ///< A path to the target, or to a known point, has been found
+		fsPartial,    ///< The target was not reached, the path leads to the closest reached node
+		fsNoPath,     ///< The mob cannot move anywhere from the start
+	} ;
+
+	cPathFinder(void);
+
+	/** Starts a new search. a_BlockTypes is the XZY-ordered box of block types of a_Size, at a_Origin in the world;
+	it must stay valid until the search finishes. All the coords are absolute world coords. */
+	void Start(
+		const BLOCKTYPE * a_BlockTypes, const Vector3i & a_Origin, const Vector3i & a_Size,
+		const Vector3i & a_Start, const Vector3i & a_Target, int a_MaxNodes
+	);
+
+	/** Marks a point from which the path to the target is known. a_Index is returned by GetKnownPointIndex()
+	if the search finishes by reaching this point. Must be called after Start(). */
+	void AddKnownPoint(const Vector3i & a_Point, int a_Index);
+
+	/** Expands at most a_NodeBudget nodes, decreases a_NodeBudget by the number of nodes expanded. Returns the search status. */
+	eStatus Step(int & a_NodeBudget);
+
+	/** Returns the path from the start to the final node, including both. Valid after the search finishes with fsFound or fsPartial. */
+	void GetPath(cVector3iArray & a_Path) const;
+
+	/** Returns the index of the known point where the path ended, or -1 if it didn't end in a known point */
+	int GetKnownPointIndex(void) const;
+
+	/** Returns the total number of nodes expanded by the current search */
+	int GetNumExpandedNodes(void) const { return m_NumExpanded; }
+
+protected:
+	/** The search data for a single block of the snapshot */
+	struct sCell
+	{
+		int  m_SearchID;    ///< The search in which the rest of the values were set; if different from m_SearchID, the cell is unvisited
+		int  m_Cost;        ///< The cost of the best path from the start found so far
+		int  m_Parent;      ///< Index of the previous cell on the best path, -1 for the start
+		int  m_KnownIndex;  ///< The known point index, or -1 if not a known point
+		bool m_IsClosed;    ///< True if the cell has been expanded
+	} ;
+
+	/** A node in the open set: the estimated total cost and the cell index */
+	typedef std::pair<int, int> cOpenNode;
+
+	const BLOCKTYPE * m_BlockTypes;
+	Vector3i m_Origin;
+	Vector3i m_Size;
+	Vector3i m_Target;
+	int      m_MaxNodes;
+
+	std::vector<sCell> m_Cells;
+
+	/** The open set, as a min-heap on the estimated total cost. Outdated entries are skipped when popped. */
+	std::vector<cOpenNode> m_Open;
+
+	int m_SearchID;
+	int m_NumExpanded;
+	int m_StartIdx;
+
+	/** The node where the search ended; the closest node to the target while searching */
+	int m_EndIdx;
+	int m_EndDistance;
+	eStatus m_Status;
+
+	/** Returns the cell for the index, resetting it if it hasn't been touched by the current search yet */
+	sCell & GetCell(int a_Idx)
+	{
+		sCell & Cell = m_Cells[a_Idx];
+		if (Cell.m_SearchID != m_SearchID)
+		{
+			Cell.m_SearchID = m_SearchID;
+			Cell.m_Cost = 0x7fffffff;  // Not reached yet
+			Cell.m_Parent = -1;
+			Cell.m_KnownIndex = -1;
+			Cell.m_IsClosed = false;
+		}
+		return Cell;
+	}
+
+	/** Returns the cell index for the absolute coords, or -1 if outside the snapshot */
+	int MakeIndex(int a_X, int a_Y, int a_Z) const;
+
+	/** Returns the absolute coords of the cell */
+	Vector3i IndexToCoords(int a_Idx) const;
+
+	/** Returns the block type at the absolute coords, or -1 if outside the snapshot */
+	int GetBlock(int a_X, int a_Y, int a_Z) const
+	{
+		int Idx = MakeIndex(a_X, a_Y, a_Z);
+		return (Idx < 0) ? -1 : m_BlockTypes[Idx];
+	}
+
+	/** Returns true if a mob can be in the block (not solid, not lava) */
+	bool IsPassable(int a_X, int a_Y, int a_Z) const;
+
+	/** Returns true if a mob can stand with its feet in the block */
+	bool CanStand(int a_X, int a_Y, int a_Z) const;
+
+	/** Returns the estimated cost from the node to the target; never more than the real cost */
+	int GetHeuristic(const Vector3i & a_Pos) const
+	{
+		return std::abs(a_Pos.x - m_Target.x) + std::max(std::abs(a_Pos.y - m_Target.y) - 1, 0) + std::abs(a_Pos.z - m_Target.z);
+	}
+
+	/** Returns true if the node is close enough to the target to end the search */
+	bool IsAtTarget(const Vector3i & a_Pos) const
+	{
+		return (a_Pos.x == m_Target.x) && (a_Pos.z == m_Target.z) && (std::abs(a_Pos.y - m_Target.y) <= 1);
+	}
+
+	/** Adds the neighbor to the open set if the path through a_FromIdx is better than the one known */
+	void ProcessNeighbor(int a_FromIdx, int a_FromCost, int a_X, int a_Y, int a_Z, int a_StepCost);
+
+	/** Finishes the search with the specified status, setting the end node */
+	eStatus Finish(eStatus a_Status, int a_EndIdx);
+} ;
+
+
+
+
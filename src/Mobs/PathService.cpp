@@ -0,0 +1,463 @@
+
+// PathService.cpp
+
+// Implements the cPathService class representing the per-world queue of mob path requests, processed with cPathFinder
+
+#include "Globals.h"
+#include "PathService.h"
+#include "../World.h"
+#include "../CommandOutput.h"
+
+
+
+
+
+/** The furthest the snapshot reaches from the start towards the target, horizontally. Further targets get a partial path. */
+#define PATHSERVICE_MAX_RANGE 24
+
+/** The furthest the snapshot reaches from the start towards the target, vertically */
+#define PATHSERVICE_MAX_RANGE_Y 16
+
+/** The extra blocks read around the start and target horizontally, so that the path can go around obstacles */
+#define PATHSERVICE_MARGIN 8
+
+/** The extra blocks read below and above the start and target, for the drops and jumps */
+#define PATHSERVICE_MARGIN_DOWN 5
+#define PATHSERVICE_MARGIN_UP   4
+
+/** The maximum number of nodes expanded for a single request */
+#define PATHSERVICE_MAX_NODES 3000
+
+/** Number of ticks for which a found path is used for the other requests to the same target */
+#define PATHSERVICE_CACHE_TICKS 40
+
+/** Number of ticks after which a result that has not been picked up is dropped */
+#define PATHSERVICE_RESULT_TICKS 200
+
+/** The maximum number of cached paths; one path per target is kept */
+#define PATHSERVICE_CACHE_SIZE 64
+
+
+
+
+
+cPathService::cPathService(void) :
+	super("cPathService"),
+	m_World(NULL),
+	m_UseThread(false),
+	m_NodesPerTick(0),
+	m_NextRequestID(1),
+	m_CurrentTick(0),
+	m_IsSearching(false),
+	m_SearchRequestID(0),
+	m_NumRequests(0),
+	m_NumCacheHits(0),
+	m_NumJoined(0),
+	m_NumFound(0),
+	m_NumPartial(0),
+	m_NumNoPath(0),
+	m_NumNodes(0)
+{
+}
+
+
+
+
+
+cPathService::~cPathService()
+{
+	Stop();
+}
+
+
+
+
+
+void cPathService::Start(cWorld * a_World, bool a_UseThread, int a_NodesPerTick)
+{
+	m_World = a_World;
+	m_UseThread = a_UseThread;
+	m_NodesPerTick = std::max(a_NodesPerTick, 1);
+	if (m_UseThread)
+	{
+		super::Start();
+	}
+}
+
+
+
+
+
+void cPathService::Stop(void)
+{
+	m_ShouldTerminate = true;
+	m_evtTick.Set();
+	Wait();
+
+	cCSLock Lock(m_CS);
+	m_Requests.clear();
+	m_Queue.clear();
+	m_Cache.clear();
+}
+
+
+
+
+
+void cPathService::Tick(void)
+{
+	{
+		cCSLock Lock(m_CS);
+		m_CurrentTick += 1;
+		ExpireOldEntries();
+	}
+	if (m_UseThread)
+	{
+		m_evtTick.Set();
+	}
+	else
+	{
+		ProcessRequests(m_NodesPerTick);
+	}
+}
+
+
+
+
+
+int cPathService::RequestPath(const Vector3i & a_Start, const Vector3i & a_Target)
+{
+	cCSLock Lock(m_CS);
+	int RequestID = m_NextRequestID;
+	m_NextRequestID = (m_NextRequestID == 0x7fffffff) ? 1 : m_NextRequestID + 1;
+	m_NumRequests += 1;
+
+	sRequest & Request = m_Requests[RequestID];
+	Request.m_Start = a_Start;
+	Request.m_Target = a_Target;
+	Request.m_Status = psPending;
+	Request.m_FinishedTick = 0;
+	if (!AnswerFromCache(Request))
+	{
+		m_Queue.push_back(RequestID);
+	}
+	return RequestID;
+}
+
+
+
+
+
+cPathService::eStatus cPathService::GetResult(int a_RequestID, cVector3iArray & a_Path)
+{
+	cCSLock Lock(m_CS);
+	cRequestMap::iterator itr = m_Requests.find(a_RequestID);
+	if (itr == m_Requests.end())
+	{
+		return psNoPath;
+	}
+	eStatus Status = itr->second.m_Status;
+	if (Status == psPending)
+	{
+		return psPending;
+	}
+	std::swap(a_Path, itr->second.m_Path);
+	m_Requests.erase(itr);
+	return Status;
+}
+
+
+
+
+
+void cPathService::CancelRequest(int a_RequestID)
+{
+	// The ID stays in m_Queue, StartNextSearch() skips it:
+	cCSLock Lock(m_CS);
+	m_Requests.erase(a_RequestID);
+}
+
+
+
+
+
+void cPathService::LogStats(cCommandOutputCallback & a_Output)
+{
+	cCSLock Lock(m_CS);
+	Int64 NumSearches = m_NumFound + m_NumPartial + m_NumNoPath;
+	a_Output.Out("  Pathfinding: %lld requests, %lld answered from the cache, %u queued",
+		m_NumRequests, m_NumCacheHits, (unsigned)m_Queue.size()
+	);
+	a_Output.Out("    %lld searches: %lld found (%lld joined a cached path), %lld partial, %lld no path; %.1f nodes per search",
+		NumSearches, m_NumFound, m_NumJoined, m_NumPartial, m_NumNoPath,
+		(NumSearches > 0) ? ((double)m_NumNodes / NumSearches) : 0.0
+	);
+}
+
+
+
+
+
+void cPathService::Execute(void)
+{
+	for (;;)
+	{
+		m_evtTick.Wait();
+		if (m_ShouldTerminate)
+		{
+			return;
+		}
+		ProcessRequests(m_NodesPerTick);
+	}
+}
+
+
+
+
+
+void cPathService::ProcessRequests(int a_NodeBudget)
+{
+	while (a_NodeBudget > 0)
+	{
+		if (!m_IsSearching && !StartNextSearch())
+		{
+			// Nothing more to do
+			return;
+		}
+		cPathFinder::eStatus Status = m_Finder.Step(a_NodeBudget);
+		if (Status == cPathFinder::fsSearching)
+		{
+			// Out of budget, continue next tick
+			return;
+		}
+		FinishSearch(Status);
+	}
+}
+
+
+
+
+
+bool cPathService::StartNextSearch(void)
+{
+	Vector3i Start, Target;
+	{
+		cCSLock Lock(m_CS);
+		for (;;)
+		{
+			if (m_Queue.empty())
+			{
+				return false;
+			}
+			m_SearchRequestID = m_Queue.front();
+			m_Queue.pop_front();
+			cRequestMap::iterator itr = m_Requests.find(m_SearchRequestID);
+			if (itr == m_Requests.end())
+			{
+				// Cancelled
+				continue;
+			}
+			if (AnswerFromCache(itr->second))
+			{
+				// Another search has found a path through this start since the request was queued
+				continue;
+			}
+			Start = itr->second.m_Start;
+			Target = itr->second.m_Target;
+			break;
+		}
+
+		int CacheIdx = FindCachedPath(Target);
+		if (CacheIdx >= 0)
+		{
+			m_SearchKnownPath = m_Cache[CacheIdx].m_Path;
+		}
+		else
+		{
+			m_SearchKnownPath.clear();
+		}
+	}
+	m_SearchTarget = Target;
+	m_IsSearching = true;
+
+	// Read the snapshot around the start and the target, limited to the max range from the start:
+	int TargetX = std::min(std::max(Target.x, Start.x - PATHSERVICE_MAX_RANGE),   Start.x + PATHSERVICE_MAX_RANGE);
+	int TargetY = std::min(std::max(Target.y, Start.y - PATHSERVICE_MAX_RANGE_Y), Start.y + PATHSERVICE_MAX_RANGE_Y);
+	int TargetZ = std::min(std::max(Target.z, Start.z - PATHSERVICE_MAX_RANGE),   Start.z + PATHSERVICE_MAX_RANGE);
+	int MinX = std::min(Start.x, TargetX) - PATHSERVICE_MARGIN;
+	int MaxX = std::max(Start.x, TargetX) + PATHSERVICE_MARGIN;
+	int MinY = std::max(std::min(Start.y, TargetY) - PATHSERVICE_MARGIN_DOWN, 0);
+	int MaxY = std::min(std::max(Start.y, TargetY) + PATHSERVICE_MARGIN_UP, cChunkDef::Height - 1);
+	int MinZ = std::min(Start.z, TargetZ) - PATHSERVICE_MARGIN;
+	int MaxZ = std::max(Start.z, TargetZ) + PATHSERVICE_MARGIN;
+	if (
+		(Start.y < 0) || (Start.y >= cChunkDef::Height) ||
+		!m_Snapshot.Read(m_World, MinX, MaxX, MinY, MaxY, MinZ, MaxZ, cBlockArea::baTypes)
+	)
+	{
+		// Out of the world, or some of the chunks are not loaded and their blocks are undefined; make the search fail right away:
+		m_Finder.Start(NULL, Vector3i(), Vector3i(), Start, Target, 0);
+		return true;
+	}
+
+	m_Finder.Start(
+		m_Snapshot.GetBlockTypes(),
+		Vector3i(m_Snapshot.GetOriginX(), m_Snapshot.GetOriginY(), m_Snapshot.GetOriginZ()),
+		Vector3i(m_Snapshot.GetSizeX(),   m_Snapshot.GetSizeY(),   m_Snapshot.GetSizeZ()),
+		Start, Target, PATHSERVICE_MAX_NODES
+	);
+	for (size_t i = 0; i < m_SearchKnownPath.size(); i++)
+	{
+		m_Finder.AddKnownPoint(m_SearchKnownPath[i], (int)i);
+	}
+	return true;
+}
+
+
+
+
+
+void cPathService::FinishSearch(cPathFinder::eStatus a_Status)
+{
+	m_IsSearching = false;
+
+	cVector3iArray Path;
+	m_Finder.GetPath(Path);
+	eStatus Status = psNoPath;
+	bool HasJoined = false;
+	switch (a_Status)
+	{
+		case cPathFinder::fsFound:
+		{
+			Status = psFound;
+			int KnownIdx = m_Finder.GetKnownPointIndex();
+			if (KnownIdx >= 0)
+			{
+				// The search has reached a cached path, continue along it:
+				Path.insert(Path.end(), m_SearchKnownPath.begin() + KnownIdx + 1, m_SearchKnownPath.end());
+				HasJoined = true;
+			}
+			break;
+		}
+		case cPathFinder::fsPartial:   Status = psPartial; break;
+		case cPathFinder::fsNoPath:    Status = psNoPath;  break;
+		case cPathFinder::fsSearching: ASSERT(!"Search not finished"); break;
+	}
+
+	cCSLock Lock(m_CS);
+	m_NumNodes += m_Finder.GetNumExpandedNodes();
+	switch (Status)
+	{
+		case psFound:   m_NumFound   += 1; break;
+		case psPartial: m_NumPartial += 1; break;
+		default:        m_NumNoPath  += 1; break;
+	}
+	m_NumJoined += HasJoined ? 1 : 0;
+
+	// Cache the path, replacing the older path to the same target, or the oldest path if full:
+	if (Status == psFound)
+	{
+		int CacheIdx = FindCachedPath(m_SearchTarget);
+		if ((CacheIdx < 0) && (m_Cache.size() >= PATHSERVICE_CACHE_SIZE))
+		{
+			CacheIdx = 0;
+			for (size_t i = 1; i < m_Cache.size(); i++)
+			{
+				if (m_Cache[i].m_Tick < m_Cache[CacheIdx].m_Tick)
+				{
+					CacheIdx = (int)i;
+				}
+			}
+		}
+		if (CacheIdx < 0)
+		{
+			CacheIdx = (int)m_Cache.size();
+			m_Cache.push_back(sCachedPath());
+		}
+		m_Cache[CacheIdx].m_Target = m_SearchTarget;
+		m_Cache[CacheIdx].m_Path = Path;
+		m_Cache[CacheIdx].m_Tick = m_CurrentTick;
+	}
+
+	cRequestMap::iterator itr = m_Requests.find(m_SearchRequestID);
+	if (itr == m_Requests.end())
+	{
+		// Cancelled while searching
+		return;
+	}
+	itr->second.m_Status = Status;
+	itr->second.m_FinishedTick = m_CurrentTick;
+	std::swap(itr->second.m_Path, Path);
+}
+
+
+
+
+
+bool cPathService::AnswerFromCache(sRequest & a_Request)
+{
+	int CacheIdx = FindCachedPath(a_Request.m_Target);
+	if (CacheIdx < 0)
+	{
+		return false;
+	}
+	const cVector3iArray & Path = m_Cache[CacheIdx].m_Path;
+	for (cVector3iArray::const_iterator itr = Path.begin(), end = Path.end(); itr != end; ++itr)
+	{
+		if (itr->Equals(a_Request.m_Start))
+		{
+			a_Request.m_Path.assign(itr, end);
+			a_Request.m_Status = psFound;
+			a_Request.m_FinishedTick = m_CurrentTick;
+			m_NumCacheHits += 1;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+
+int cPathService::FindCachedPath(const Vector3i & a_Target) const
+{
+	for (size_t i = 0; i < m_Cache.size(); i++)
+	{
+		if (m_Cache[i].m_Target.Equals(a_Target))
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+
+
+
+
+void cPathService::ExpireOldEntries(void)
+{
+	for (size_t i = m_Cache.size(); i > 0; i--)
+	{
+		if (m_Cache[i - 1].m_Tick + PATHSERVICE_CACHE_TICKS < m_CurrentTick)
+		{
+			m_Cache.erase(m_Cache.begin() + (i - 1));
+		}
+	}
+	for (cRequestMap::iterator itr = m_Requests.begin(); itr != m_Requests.end();)
+	{
+		if ((itr->second.m_Status != psPending) && (itr->second.m_FinishedTick + PATHSERVICE_RESULT_TICKS < m_CurrentTick))
+		{
+			cRequestMap::iterator itr2 = itr;
+			++itr;
+			m_Requests.erase(itr2);
+			continue;
+		}
+		++itr;
+	}
+}
+
+
+
+
@@ -0,0 +1,159 @@
+
+// PathService.h
+
+// Declares the cPathService class representing the per-world queue of mob path requests, processed with cPathFinder
+
+/*
+Mobs request a path using RequestPath(), which returns a request ID, and then poll GetResult() until the result is
+ready. The requests are processed in the order they were made, a snapshot of the blocks around each request is
+read from the world and the path is searched in it by cPathFinder. The number of nodes expanded per world tick is
+limited, a search that doesn't fit the budget continues in the next tick.
+
+The processing can run either in the tick thread, from within Tick(), or in the service's own thread, which Tick()
+wakes up once per tick. The searches don't lock anything but the chunkmap while reading the snapshot.
+
+Found paths are cached for a short while, keyed by the target block. A request for the same target whose start is
+on a cached path is answered right away with the rest of that path; other requests to the same target finish their
+search as soon as they reach the cached path and share its remainder.
+*/
+
+
+
+
+
+#pragma once
+
+#include "../OSSupport/IsThread.h"
+#include "../BlockArea.h"
+#include "PathFinder.h"
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+class cWorld;
+
+
+
+
+
+class cPathService :
+	public cIsThread
+{
+	typedef cIsThread super;
+
+public:
+	enum eStatus
+	{
+		psPending,  ///< The request is still waiting in the queue or being searched
+		psFound,    ///< A path to the target has been found
+		psPartial,  ///< The target is not reachable within the limits, the path leads closer to it
+		psNoPath,   ///< No path could be found, or the request is unknown
+	} ;
+
+	cPathService(void);
+	~cPathService();
+
+	/** Starts the service. If a_UseThread is true, the requests are processed in a separate thread, otherwise in Tick() */
+	void Start(cWorld * a_World, bool a_UseThread, int a_NodesPerTick);
+
+	/** Stops the service's thread, if running, and drops all the requests */
+	void Stop(void);
+
+	/** Called by the world once per tick; processes the requests within the node budget, or lets the thread do it */
+	void Tick(void);
+
+	/** Queues a request for a path from a_Start to a_Target (block coords of the feet). Returns the request ID, never 0. */
+	int RequestPath(const Vector3i & a_Start, const Vector3i & a_Target);
+
+	/** Returns the status of the request. If not pending, fills in the path and removes the request. */
+	eStatus GetResult(int a_RequestID, cVector3iArray & a_Path);
+
+	/** Removes the request, if it is still present */
+	void CancelRequest(int a_RequestID);
+
+	/** Outputs the statistics of the requests and searches */
+	void LogStats(cCommandOutputCallback & a_Output);
+
+protected:
+	struct sRequest
+	{
+		Vector3i       m_Start;
+		Vector3i       m_Target;
+		eStatus        m_Status;
+		cVector3iArray m_Path;
+		Int64          m_FinishedTick;  ///< The tick when the result was set, for expiring results that were never picked up
+	} ;
+
+	typedef std::map<int, sRequest> cRequestMap;
+
+	struct sCachedPath
+	{
+		Vector3i       m_Target;
+		cVector3iArray m_Path;
+		Int64          m_Tick;  ///< The tick when the path was found; older paths may be outdated by block changes
+	} ;
+
+	typedef std::vector<sCachedPath> cCachedPaths;
+
+	cWorld * m_World;
+	bool     m_UseThread;
+	int      m_NodesPerTick;
+
+	/** Protects the requests, the queue, the cache and the statistics */
+	cCriticalSection m_CS;
+
+	cRequestMap      m_Requests;
+	std::deque<int>  m_Queue;
+	cCachedPaths     m_Cache;
+	int              m_NextRequestID;
+	Int64            m_CurrentTick;
+
+	/** Set once per tick when running in the thread, or to stop the thread */
+	cEvent m_evtTick;
+
+	// The search in progress; only accessed by the processing (the thread, or Tick()):
+	cPathFinder    m_Finder;
+	cBlockArea     m_Snapshot;
+	bool           m_IsSearching;
+	int            m_SearchRequestID;
+	Vector3i       m_SearchTarget;
+	cVector3iArray m_SearchKnownPath;  ///< The cached path that the search may join, copied out of the cache
+
+	// Statistics:
+	Int64 m_NumRequests;
+	Int64 m_NumCacheHits;
+	Int64 m_NumJoined;
+	Int64 m_NumFound;
+	Int64 m_NumPartial;
+	Int64 m_NumNoPath;
+	Int64 m_NumNodes;
+
+	// cIsThread override:
+	virtual void Execute(void) override;
+
+	/** Processes the queued requests, expanding at most a_NodeBudget nodes */
+	void ProcessRequests(int a_NodeBudget);
+
+	/** Takes the next request from the queue and starts its search. Returns false if the queue is empty */
+	bool StartNextSearch(void);
+
+	/** Stores the result of the finished search into its request and the cache */
+	void FinishSearch(cPathFinder::eStatus a_Status);
+
+	/** If the request's start is on a cached path to its target, sets the rest of that path as the result and returns true.
+	Expects m_CS to be locked */
+	bool AnswerFromCache(sRequest & a_Request);
+
+	/** Returns the index into m_Cache of the path to the target, or -1 if none. Expects m_CS to be locked */
+	int FindCachedPath(const Vector3i & a_Target) const;
+
+	/** Removes the outdated cache entries and the results that were never picked up. Expects m_CS to be locked */
+	void ExpireOldEntries(void);
+} ;
+
+
+
+
@@ -9,7 +9,73 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // cCriticalSection:
 
-cCriticalSection::cCriticalSection()
+volatile bool cCriticalSection::s_IsProfilingEnabled = false;
+volatile int cCriticalSection::s_ProfilingEpoch = 0;
+
+/** The named CSs currently alive */
+static std::vector<cCriticalSection *> g_NamedCSs;
+
+/** The stats of the named CSs destroyed since the profiling was last enabled, by the name */
+static std::map<AString, cCriticalSection::sStats> g_DestroyedCSStats;
+
+/** Protects g_NamedCSs and g_DestroyedCSStats; being unnamed, it is never profiled itself */
+static cCriticalSection g_CSNamedCSs;
+
+
+
+
+
+/** Returns the current time in microseconds, for measuring the lock wait and hold times */
+static Int64 GetLockProfilerTime(void)
+{
+	#ifdef _WIN32
+		static LARGE_INTEGER Frequency = {0};
+		if (Frequency.QuadPart == 0)
+		{
+			QueryPerformanceFrequency(&Frequency);
+		}
+		LARGE_INTEGER Now;
+		QueryPerformanceCounter(&Now);
+		return (Int64)(Now.QuadPart * 1000000 / Frequency.QuadPart);
+	#else
+		struct timespec Now;
+		clock_gettime(CLOCK_MONOTONIC, &Now);
+		return (Int64)Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+	#endif
+}
+
+
+
+
+
+cCriticalSection::cCriticalSection() :
+	m_Profile(NULL)
+{
+	Init();
+}
+
+
+
+
+
+cCriticalSection::cCriticalSection(const char * a_Name) :
+	m_Profile(new sProfile)
+{
+	Init();
+	
+	memset(m_Profile, 0, sizeof(*m_Profile));
+	m_Profile->m_Name = a_Name;
+	m_Profile->m_Epoch = s_ProfilingEpoch;
+	
+	cCSLock Lock(g_CSNamedCSs);
+	g_NamedCSs.push_back(this);
+}
+
+
+
+
+
+void cCriticalSection::Init(void)
 {
 	#ifdef _WIN32
 		InitializeCriticalSection(&m_CriticalSection);
@@ -34,6 +100,21 @@ cCriticalSection::cCriticalSection()
 
 cCriticalSection::~cCriticalSection()
 {
+	if (m_Profile != NULL)
+	{
+		// Keep the stats for GetProfile():
+		cCSLock Lock(g_CSNamedCSs);
+		g_NamedCSs.erase(std::find(g_NamedCSs.begin(), g_NamedCSs.end(), this));
+		m_Profile->UpdateEpoch();
+		if (m_Profile->m_NumAcquisitions > 0)
+		{
+			sStats & Stats = g_DestroyedCSStats[m_Profile->m_Name];
+			Stats.m_Name = m_Profile->m_Name;
+			m_Profile->AddTo(Stats);
+		}
+		delete m_Profile;
+	}
+	
 	#ifdef _WIN32
 		DeleteCriticalSection(&m_CriticalSection);
 	#else
@@ -51,6 +132,12 @@ cCriticalSection::~cCriticalSection()
 
 void cCriticalSection::Lock()
 {
+	if ((m_Profile != NULL) && s_IsProfilingEnabled)
+	{
+		LockProfiled();
+		return;
+	}
+	
 	#ifdef _WIN32
 		EnterCriticalSection(&m_CriticalSection);
 	#else
@@ -69,6 +156,12 @@ void cCriticalSection::Lock()
 
 void cCriticalSection::Unlock()
 {
+	// Checked regardless of s_IsProfilingEnabled, so that the locks taken before the profiling was disabled are finished:
+	if ((m_Profile != NULL) && (m_Profile->m_Depth > 0))
+	{
+		UnlockProfiled();
+	}
+	
 	#ifdef _DEBUG
 		ASSERT(m_IsLocked > 0);
 		m_IsLocked -= 1;
@@ -85,6 +178,135 @@ void cCriticalSection::Unlock()
 
 
 
+void cCriticalSection::LockProfiled(void)
+{
+	// Only an acquisition that cannot take the CS right away waits for another thread:
+	#ifdef _WIN32
+		bool IsContended = (TryEnterCriticalSection(&m_CriticalSection) == 0);
+	#else
+		bool IsContended = (pthread_mutex_trylock(&m_CriticalSection) != 0);
+	#endif
+	Int64 WaitStart = 0;
+	if (IsContended)
+	{
+		WaitStart = GetLockProfilerTime();
+		#ifdef _WIN32
+			EnterCriticalSection(&m_CriticalSection);
+		#else
+			pthread_mutex_lock(&m_CriticalSection);
+		#endif
+	}
+	
+	#ifdef _DEBUG
+		m_IsLocked += 1;
+		m_OwningThreadID = cIsThread::GetCurrentID();
+	#endif  // _DEBUG
+	
+	// The CS is held now, the profile may be modified:
+	m_Profile->m_Depth += 1;
+	if (m_Profile->m_Depth > 1)
+	{
+		// A recursive lock, only the outermost one is counted
+		return;
+	}
+	m_Profile->UpdateEpoch();
+	Int64 Now = GetLockProfilerTime();
+	m_Profile->m_NumAcquisitions += 1;
+	if (IsContended)
+	{
+		m_Profile->m_NumContended += 1;
+		m_Profile->m_WaitTime += Now - WaitStart;
+	}
+	m_Profile->m_HoldStart = Now;
+}
+
+
+
+
+
+void cCriticalSection::UnlockProfiled(void)
+{
+	m_Profile->m_Depth -= 1;
+	if (m_Profile->m_Depth > 0)
+	{
+		return;
+	}
+	if (m_Profile->m_Epoch != s_ProfilingEpoch)
+	{
+		// The profiling has been re-enabled while held, the hold started before the reset
+		return;
+	}
+	Int64 HoldTime = GetLockProfilerTime() - m_Profile->m_HoldStart;
+	m_Profile->m_HoldTime += HoldTime;
+	if (HoldTime > m_Profile->m_LongestHold)
+	{
+		m_Profile->m_LongestHold = HoldTime;
+	}
+}
+
+
+
+
+
+void cCriticalSection::SetProfilingEnabled(bool a_IsEnabled)
+{
+	cCSLock Lock(g_CSNamedCSs);
+	if (a_IsEnabled && !s_IsProfilingEnabled)
+	{
+		// Reset the stats; each live CS zeroes its own stats on its next lock:
+		s_ProfilingEpoch += 1;
+		g_DestroyedCSStats.clear();
+	}
+	s_IsProfilingEnabled = a_IsEnabled;
+}
+
+
+
+
+
+/** Sorts the stats by their total wait time, longest first */
+static bool CompareWaitTime(const cCriticalSection::sStats & a_Stats1, const cCriticalSection::sStats & a_Stats2)
+{
+	return (a_Stats1.m_WaitTime > a_Stats2.m_WaitTime);
+}
+
+
+
+
+
+void cCriticalSection::GetProfile(cStatsList & a_Stats)
+{
+	std::map<AString, sStats> Stats;
+	{
+		cCSLock Lock(g_CSNamedCSs);
+		Stats = g_DestroyedCSStats;
+		for (std::vector<cCriticalSection *>::const_iterator itr = g_NamedCSs.begin(); itr != g_NamedCSs.end(); ++itr)
+		{
+			// The profile is read without holding the CS; the stats of a CS being held may be torn, but the CS is kept alive by g_CSNamedCSs:
+			const sProfile & Profile = *((*itr)->m_Profile);
+			sStats & NameStats = Stats[Profile.m_Name];
+			NameStats.m_Name = Profile.m_Name;
+			NameStats.m_NumInstances += 1;
+			if (Profile.m_Epoch == s_ProfilingEpoch)
+			{
+				Profile.AddTo(NameStats);
+			}
+		}
+	}
+	
+	a_Stats.clear();
+	a_Stats.reserve(Stats.size());
+	for (std::map<AString, sStats>::const_iterator itr = Stats.begin(); itr != Stats.end(); ++itr)
+	{
+		a_Stats.push_back(itr->second);
+	}
+	std::sort(a_Stats.begin(), a_Stats.end(), CompareWaitTime);
+}
+
+
+
+
+
 #ifdef _DEBUG
 bool cCriticalSection::IsLocked(void)
 {
@@ -105,6 +327,41 @@ bool cCriticalSection::IsLockedByCurrentThread(void)
 
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cCriticalSection::sProfile:
+
+void cCriticalSection::sProfile::UpdateEpoch(void)
+{
+	int Epoch = s_ProfilingEpoch;
+	if (m_Epoch == Epoch)
+	{
+		return;
+	}
+	m_Epoch = Epoch;
+	m_NumAcquisitions = 0;
+	m_NumContended = 0;
+	m_WaitTime = 0;
+	m_HoldTime = 0;
+	m_LongestHold = 0;
+}
+
+
+
+
+
+void cCriticalSection::sProfile::AddTo(sStats & a_Stats) const
+{
+	a_Stats.m_NumAcquisitions += m_NumAcquisitions;
+	a_Stats.m_NumContended += m_NumContended;
+	a_Stats.m_WaitTime += m_WaitTime;
+	a_Stats.m_HoldTime += m_HoldTime;
+	a_Stats.m_LongestHold = std::max(a_Stats.m_LongestHold, m_LongestHold);
+}
+
+
+
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // cCSLock
 
@@ -5,15 +5,62 @@
 
 
 
+/*
+A critical section may be given a name; while the lock profiling is enabled, each named CS records how many times it
+was acquired, how many of those had to wait for another thread, the total wait and hold times and the longest hold.
+The stats of all the CSs with the same name are summed up (for example, all the clients' m_CSOutgoingData), including
+the CSs that have been destroyed since the profiling was last enabled. The profiling can be switched at runtime; when
+it is off, Lock() and Unlock() only check a flag more than before. The counters are updated while holding the CS
+itself, so they need no additional synchronization.
+*/
+
 class cCriticalSection
 {
 public:
+	/** The lock contention of all the critical sections of the same name, as returned by GetProfile() */
+	struct sStats
+	{
+		AString m_Name;
+		int     m_NumInstances;       ///< Number of the CSs with this name currently alive
+		Int64   m_NumAcquisitions;
+		Int64   m_NumContended;       ///< Number of the acquisitions that had to wait for another thread
+		Int64   m_WaitTime;           ///< Total time spent waiting for the CSs, in microseconds
+		Int64   m_HoldTime;           ///< Total time the CSs were held, in microseconds
+		Int64   m_LongestHold;        ///< The longest single hold, in microseconds
+		
+		sStats(void) :
+			m_NumInstances(0),
+			m_NumAcquisitions(0),
+			m_NumContended(0),
+			m_WaitTime(0),
+			m_HoldTime(0),
+			m_LongestHold(0)
+		{
+		}
+	} ;
+	
+	typedef std::vector<sStats> cStatsList;
+	
 	cCriticalSection(void);
+	
+	/** Creates a named CS whose lock contention is recorded while the profiling is enabled.
+	a_Name must be a string constant, only the pointer is stored. */
+	cCriticalSection(const char * a_Name);
+	
 	~cCriticalSection();
 
 	void Lock(void);
 	void Unlock(void);
 	
+	/** Enables or disables the lock profiling. Enabling it resets all the stats. */
+	static void SetProfilingEnabled(bool a_IsEnabled);
+	
+	static bool IsProfilingEnabled(void) { return s_IsProfilingEnabled; }
+	
+	/** Fills a_Stats with the stats of all the named CSs since the profiling was last enabled,
+	sorted by the total wait time, longest first. The stats of the CSs currently held may be slightly outdated. */
+	static void GetProfile(cStatsList & a_Stats);
+	
 	// IsLocked/IsLockedByCurrentThread are only used in ASSERT statements, but because of the changes with ASSERT they must always be defined
 	// The fake versions (in Release) will not effect the program in any way
 	#ifdef _DEBUG
@@ -25,6 +72,35 @@ public:
 	#endif  // _DEBUG
 	
 private:
+	/** The lock contention of a single named CS. Modified only while holding the CS */
+	struct sProfile
+	{
+		const char * m_Name;
+		int   m_Epoch;             ///< The s_ProfilingEpoch when the stats were last reset
+		int   m_Depth;             ///< Number of the current thread's recursive locks that are being profiled
+		Int64 m_HoldStart;         ///< Time of the outermost profiled lock, in microseconds
+		Int64 m_NumAcquisitions;
+		Int64 m_NumContended;
+		Int64 m_WaitTime;
+		Int64 m_HoldTime;
+		Int64 m_LongestHold;
+		
+		/** Zeroes the stats if they are from before the profiling was last enabled */
+		void UpdateEpoch(void);
+		
+		/** Adds the stats to a_Stats */
+		void AddTo(sStats & a_Stats) const;
+	} ;
+	
+	/** Set while the named CSs are being profiled */
+	static volatile bool s_IsProfilingEnabled;
+	
+	/** Incremented each time the profiling is enabled; the stats with an older epoch are considered zero */
+	static volatile int s_ProfilingEpoch;
+	
+	/** The profile of a named CS, NULL for the unnamed CSs */
+	sProfile * m_Profile;
+	
 	#ifdef _DEBUG
 	int           m_IsLocked;  // Number of times this CS is locked
 	unsigned long m_OwningThreadID;
@@ -36,6 +112,15 @@ private:
 		pthread_mutex_t     m_CriticalSection;
 		pthread_mutexattr_t m_Attributes;
 	#endif  // else _WIN32
+	
+	/** Lock() with the contention and the hold time recorded into m_Profile */
+	void LockProfiled(void);
+	
+	/** Records the hold time into m_Profile when the outermost profiled lock is released. Expects the CS to be held */
+	void UnlockProfiled(void);
+	
+	/** Initializes the OS synchronization object */
+	void Init(void);
 } ALIGN_8;
 
 
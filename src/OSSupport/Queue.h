@@ -1,7 +1,7 @@
-
 // Queue.h
 
 // Implements the cQueue class representing a thread safe queue
+// Implements the cIndexedQueue class representing the queue's storage, usable on its own under an external lock
 
 #pragma once
 
@@ -9,27 +9,356 @@
 Items can be added multiple times to a queue, there are two functions for
 adding, EnqueueItem() and EnqueueItemIfNotPresent(). The first one always
 enqueues the specified item, the second one checks if the item is already
-present and only queues it if it isn't.
+present and only queues it if it isn't. An item can also be moved to the
+front of the queue, so that it is dequeued before all the others.
 
 Usage:
 To create a queue of type T, instantiate a cQueue<T> object. You can also
 modify the behavior of the queue when deleting items and when adding items
 that are already in the queue by providing a second parameter, a class that
-implements the functions Delete() and Combine(). An example is given in
-cQueueFuncs and is used as the default behavior.
+implements the functions Delete(), Combine() and Hash(). An example is given in
+cQueueFuncs and is used as the default behavior; its Hash() uses the item's
+GetHash() function.
+
+The items are kept in a ring of contiguous blocks (std::deque) in the queue
+order, and indexed by their hash in an open-addressing hash table, so that
+finding, combining and removing an item takes constant time regardless of the
+queue length. Removing an item from the middle only marks its slot as removed,
+the slots are reclaimed when they reach the front of the queue or when the
+removed slots outnumber the items.
 */
 
 /// This empty struct allows for the callback functions to be inlined
 template<class T>
-struct cQueueFuncs 
+struct cQueueFuncs
 {
 public:
 
 	/// Called when an Item is deleted from the queue without being returned
 	static void Delete(T) {};
-	
+
 	/// Called when an Item is inserted with EnqueueItemIfNotPresent and there is another equal value already inserted
 	static void Combine(T & a_existing, const T & a_new) {};
+
+	/// Returns the hash of the item; items that are equal (operator ==) must have the same hash
+	static size_t Hash(const T & a_Item) { return a_Item.GetHash(); }
+};
+
+
+
+
+
+/// The storage of cQueue: the items in the queue order, indexed by their hash. Not thread safe.
+template <class ItemType, class Funcs = cQueueFuncs<ItemType> >
+class cIndexedQueue
+{
+public:
+	cIndexedQueue(void) :
+		m_HeadSeq(0),
+		m_Size(0),
+		m_IndexUsed(0)
+	{
+	}
+
+
+	/// Adds the item to the back of the queue, even if an equal one is already present
+	void PushBack(const ItemType & a_Item)
+	{
+		size_t Hash = Funcs::Hash(a_Item);
+		m_Slots.push_back(sSlot(a_Item, Hash));
+		m_Size += 1;
+		IndexInsert(Hash, m_HeadSeq + (Int64)m_Slots.size() - 1);
+	}
+
+
+	/// Adds the item to the front of the queue, even if an equal one is already present
+	void PushFront(const ItemType & a_Item)
+	{
+		size_t Hash = Funcs::Hash(a_Item);
+		m_Slots.push_front(sSlot(a_Item, Hash));
+		m_HeadSeq -= 1;
+		m_Size += 1;
+		IndexInsert(Hash, m_HeadSeq);
+	}
+
+
+	/// Adds the item to the back of the queue, unless an equal one is present; then the new item is combined into it.
+	/// Returns true if the item was added
+	bool PushBackIfNotPresent(const ItemType & a_Item)
+	{
+		size_t Hash = Funcs::Hash(a_Item);
+		int Idx = IndexFind(a_Item, Hash);
+		if (Idx >= 0)
+		{
+			Funcs::Combine(SlotAt(m_Index[Idx].m_Seq).m_Item, a_Item);
+			return false;
+		}
+		m_Slots.push_back(sSlot(a_Item, Hash));
+		m_Size += 1;
+		IndexInsert(Hash, m_HeadSeq + (Int64)m_Slots.size() - 1);
+		return true;
+	}
+
+
+	/// Moves the item to the front of the queue, combined with the new one if an equal one is present, or adds it there.
+	/// Returns true if the item was added
+	bool MoveToFront(const ItemType & a_Item)
+	{
+		size_t Hash = Funcs::Hash(a_Item);
+		int Idx = IndexFind(a_Item, Hash);
+		if (Idx < 0)
+		{
+			PushFront(a_Item);
+			return true;
+		}
+		Int64 Seq = m_Index[Idx].m_Seq;
+		ItemType Item(SlotAt(Seq).m_Item);
+		Funcs::Combine(Item, a_Item);
+		IndexErase(Idx);
+		RemoveSlot(Seq);
+		PushFront(Item);
+		return false;
+	}
+
+
+	/// Returns the item at the front of the queue. The queue must not be empty
+	const ItemType & Front(void) const
+	{
+		ASSERT(m_Size > 0);
+		return m_Slots.front().m_Item;
+	}
+
+
+	/// Removes the item at the front of the queue into a_Item. Returns false if the queue is empty
+	bool PopFront(ItemType & a_Item)
+	{
+		if (m_Size == 0)
+		{
+			return false;
+		}
+		ASSERT(m_Slots.front().m_IsValid);  // Removed slots are never left at the front
+		a_Item = m_Slots.front().m_Item;
+		int Idx = IndexFindSeq(m_Slots.front().m_Hash, m_HeadSeq);
+		ASSERT(Idx >= 0);
+		IndexErase(Idx);
+		RemoveSlot(m_HeadSeq);
+		return true;
+	}
+
+
+	/// Removes the item from the queue. If there are multiple such items, only the first one is removed.
+	/// Returns true if the item has been removed, false if no such item found.
+	bool Remove(const ItemType & a_Item)
+	{
+		int Idx = IndexFind(a_Item, Funcs::Hash(a_Item));
+		if (Idx < 0)
+		{
+			return false;
+		}
+		Int64 Seq = m_Index[Idx].m_Seq;
+		IndexErase(Idx);
+		RemoveSlot(Seq);
+		return true;
+	}
+
+
+	/// Returns true if an item equal to a_Item is in the queue
+	bool Contains(const ItemType & a_Item) const
+	{
+		return (IndexFind(a_Item, Funcs::Hash(a_Item)) >= 0);
+	}
+
+
+	/// Removes all items, calling Funcs::Delete() on each of them
+	void Clear(void)
+	{
+		for (typename cSlots::iterator itr = m_Slots.begin(), end = m_Slots.end(); itr != end; ++itr)
+		{
+			if (itr->m_IsValid)
+			{
+				Funcs::Delete(itr->m_Item);
+			}
+		}
+		m_Slots.clear();
+		m_Index.clear();
+		m_IndexUsed = 0;
+		m_Size = 0;
+		m_HeadSeq = 0;
+	}
+
+
+	size_t size(void) const { return m_Size; }
+	bool empty(void) const { return (m_Size == 0); }
+
+protected:
+	struct sSlot
+	{
+		ItemType m_Item;
+		size_t   m_Hash;
+		bool     m_IsValid;  ///< False if the item has been removed from the middle of the queue
+
+		sSlot(const ItemType & a_Item, size_t a_Hash) : m_Item(a_Item), m_Hash(a_Hash), m_IsValid(true) {}
+	} ;
+
+	/// An entry of the hash index, referring to a slot by its sequence number
+	struct sIndexEntry
+	{
+		size_t m_Hash;
+		Int64  m_Seq;
+		bool   m_IsUsed;
+
+		sIndexEntry(void) : m_Hash(0), m_Seq(0), m_IsUsed(false) {}
+	} ;
+
+	typedef std::deque<sSlot> cSlots;
+	typedef std::vector<sIndexEntry> cIndex;
+
+	/// The slots in the queue order. The slot at index i has the sequence number m_HeadSeq + i
+	cSlots m_Slots;
+
+	/// The sequence number of the front slot
+	Int64 m_HeadSeq;
+
+	/// Number of the valid slots
+	size_t m_Size;
+
+	/// The hash index of the valid slots; linear probing, the size is a power of two
+	cIndex m_Index;
+
+	/// Number of the used entries in m_Index
+	size_t m_IndexUsed;
+
+
+	sSlot & SlotAt(Int64 a_Seq) { return m_Slots[(size_t)(a_Seq - m_HeadSeq)]; }
+	const sSlot & SlotAt(Int64 a_Seq) const { return m_Slots[(size_t)(a_Seq - m_HeadSeq)]; }
+
+
+	/// Marks the slot as removed and reclaims the removed slots at the front; compacts the queue if there are too many removed slots
+	void RemoveSlot(Int64 a_Seq)
+	{
+		SlotAt(a_Seq).m_IsValid = false;
+		m_Size -= 1;
+		while (!m_Slots.empty() && !m_Slots.front().m_IsValid)
+		{
+			m_Slots.pop_front();
+			m_HeadSeq += 1;
+		}
+		if (m_Slots.size() > 2 * m_Size + 16)
+		{
+			Compact();
+		}
+	}
+
+
+	/// Drops all the removed slots and rebuilds the index
+	void Compact(void)
+	{
+		cSlots Slots;
+		for (typename cSlots::const_iterator itr = m_Slots.begin(), end = m_Slots.end(); itr != end; ++itr)
+		{
+			if (itr->m_IsValid)
+			{
+				Slots.push_back(*itr);
+			}
+		}
+		std::swap(m_Slots, Slots);
+		m_HeadSeq = 0;
+		m_Index.assign(m_Index.size(), sIndexEntry());
+		m_IndexUsed = 0;
+		for (size_t i = 0; i < m_Slots.size(); i++)
+		{
+			IndexInsert(m_Slots[i].m_Hash, (Int64)i);
+		}
+	}
+
+
+	/// Returns the index entry of the first (lowest sequence) item equal to a_Item, or -1 if there's none
+	int IndexFind(const ItemType & a_Item, size_t a_Hash) const
+	{
+		if (m_Index.empty())
+		{
+			return -1;
+		}
+		size_t Mask = m_Index.size() - 1;
+		int Res = -1;
+		for (size_t i = a_Hash & Mask; m_Index[i].m_IsUsed; i = (i + 1) & Mask)
+		{
+			const sIndexEntry & Entry = m_Index[i];
+			if ((Entry.m_Hash == a_Hash) && (SlotAt(Entry.m_Seq).m_Item == a_Item))
+			{
+				if ((Res < 0) || (Entry.m_Seq < m_Index[Res].m_Seq))
+				{
+					Res = (int)i;
+				}
+			}
+		}
+		return Res;
+	}
+
+
+	/// Returns the index entry referring to the specified slot
+	int IndexFindSeq(size_t a_Hash, Int64 a_Seq) const
+	{
+		size_t Mask = m_Index.size() - 1;
+		for (size_t i = a_Hash & Mask; m_Index[i].m_IsUsed; i = (i + 1) & Mask)
+		{
+			if (m_Index[i].m_Seq == a_Seq)
+			{
+				return (int)i;
+			}
+		}
+		return -1;
+	}
+
+
+	void IndexInsert(size_t a_Hash, Int64 a_Seq)
+	{
+		// Keep the index at most half full:
+		if (2 * (m_IndexUsed + 1) > m_Index.size())
+		{
+			cIndex Old;
+			std::swap(Old, m_Index);
+			m_Index.resize(std::max(Old.size() * 2, (size_t)64));
+			m_IndexUsed = 0;
+			for (typename cIndex::const_iterator itr = Old.begin(), end = Old.end(); itr != end; ++itr)
+			{
+				if (itr->m_IsUsed)
+				{
+					IndexInsert(itr->m_Hash, itr->m_Seq);
+				}
+			}
+		}
+		size_t Mask = m_Index.size() - 1;
+		size_t i = a_Hash & Mask;
+		while (m_Index[i].m_IsUsed)
+		{
+			i = (i + 1) & Mask;
+		}
+		m_Index[i].m_Hash = a_Hash;
+		m_Index[i].m_Seq = a_Seq;
+		m_Index[i].m_IsUsed = true;
+		m_IndexUsed += 1;
+	}
+
+
+	/// Erases the index entry, shifting back the entries that follow it in its probe sequence
+	void IndexErase(int a_Idx)
+	{
+		size_t Mask = m_Index.size() - 1;
+		size_t Hole = (size_t)a_Idx;
+		for (size_t i = (Hole + 1) & Mask; m_Index[i].m_IsUsed; i = (i + 1) & Mask)
+		{
+			// The entry can fill the hole if its home position isn't cyclically within (Hole, i]:
+			size_t Home = m_Index[i].m_Hash & Mask;
+			if (((i - Home) & Mask) >= ((i - Hole) & Mask))
+			{
+				m_Index[Hole] = m_Index[i];
+				Hole = i;
+			}
+		}
+		m_Index[Hole] = sIndexEntry();
+		m_IndexUsed -= 1;
+	}
 };
 
 
@@ -39,12 +368,6 @@ public:
 template <class ItemType, class Funcs = cQueueFuncs<ItemType> >
 class cQueue
 {
-	// The actual storage type for the queue
-	typedef typename std::list<ItemType> QueueType;
-	
-	// Make iterator an alias for the QueueType's iterator
-	typedef typename QueueType::iterator iterator;
-	
 public:
 	cQueue() {}
 	~cQueue() {}
@@ -54,7 +377,7 @@ public:
 	void EnqueueItem(ItemType a_Item)
 	{
 		cCSLock Lock(m_CS);
-		m_Contents.push_back(a_Item);
+		m_Contents.PushBack(a_Item);
 		m_evtAdded.Set();
 	}
 
@@ -63,17 +386,21 @@ public:
 	void EnqueueItemIfNotPresent(ItemType a_Item)
 	{
 		cCSLock Lock(m_CS);
+		if (m_Contents.PushBackIfNotPresent(a_Item))
+		{
+			m_evtAdded.Set();
+		}
+	}
+
 
-		for (iterator itr = m_Contents.begin(); itr != m_Contents.end(); ++itr)
+	/// Moves the item to the front of the queue, combining it with the one already present, or enqueues it at the front.
+	void EnqueueItemAtFront(ItemType a_Item)
+	{
+		cCSLock Lock(m_CS);
+		if (m_Contents.MoveToFront(a_Item))
 		{
-			if ((*itr) == a_Item)
-			{
-				Funcs::Combine(*itr, a_Item);
-				return;
-			}
+			m_evtAdded.Set();
 		}
-		m_Contents.push_back(a_Item);
-		m_evtAdded.Set();
 	}
 
 
@@ -82,12 +409,10 @@ public:
 	bool TryDequeueItem(ItemType & item)
 	{
 		cCSLock Lock(m_CS);
-		if (m_Contents.size() == 0)
+		if (!m_Contents.PopFront(item))
 		{
-			return false; 
+			return false;
 		}
-		item = m_Contents.front();
-		m_Contents.pop_front();
 		m_evtRemoved.Set();
 		return true;
 	}
@@ -97,13 +422,13 @@ public:
 	ItemType DequeueItem(void)
 	{
 		cCSLock Lock(m_CS);
-		while (m_Contents.size() == 0)
+		while (m_Contents.empty())
 		{
 			cCSUnlock Unlock(Lock);
 			m_evtAdded.Wait();
 		}
-		ItemType item = m_Contents.front();
-		m_Contents.pop_front();
+		ItemType item = m_Contents.Front();
+		m_Contents.PopFront(item);
 		m_evtRemoved.Set();
 		return item;
 	}
@@ -125,11 +450,7 @@ public:
 	void Clear(void)
 	{
 		cCSLock Lock(m_CS);
-		while (!m_Contents.empty())
-		{
-			Funcs::Delete(m_Contents.front());
-			m_Contents.pop_front();
-		}
+		m_Contents.Clear();
 	}
 
 
@@ -147,28 +468,24 @@ public:
 	bool Remove(ItemType a_Item)
 	{
 		cCSLock Lock(m_CS);
-		for (iterator itr = m_Contents.begin(); itr != m_Contents.end(); ++itr)
+		if (!m_Contents.Remove(a_Item))
 		{
-			if ((*itr) == a_Item)
-			{
-				m_Contents.erase(itr);
-				m_evtRemoved.Set();
-				return true;
-			}
+			return false;
 		}
-		return false;
+		m_evtRemoved.Set();
+		return true;
 	}
 
 private:
 	/// The contents of the queue
-	QueueType m_Contents;
-	
+	cIndexedQueue<ItemType, Funcs> m_Contents;
+
 	/// Mutex that protects access to the queue contents
 	cCriticalSection m_CS;
-	
+
 	/// Event that is signalled when an item is added
 	cEvent m_evtAdded;
-	
+
 	/// Event that is signalled when an item is removed (both dequeued or erased)
 	cEvent m_evtRemoved;
 };
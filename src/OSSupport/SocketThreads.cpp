@@ -8,6 +8,7 @@
 #include "Globals.h"
 #include "SocketThreads.h"
 #include "Errors.h"
+#include "../CommandOutput.h"
 
 
 
@@ -16,7 +17,12 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // cSocketThreads:
 
-cSocketThreads::cSocketThreads(void)
+cSocketThreads::cSocketThreads(void) :
+	m_CS("cSocketThreads"),
+	m_NumBytesReceived(0),
+	m_NumBytesSent(0),
+	m_NumLoops(0),
+	m_NumSendBufferFull(0)
 {
 }
 
@@ -133,6 +139,29 @@ void cSocketThreads::Write(const cCallback * a_Client, const AString & a_Data)
 
 
 
+void cSocketThreads::LogStats(cCommandOutputCallback & a_Output)
+{
+	cCSLock Lock(m_CS);
+	int NumSlots = 0;
+	size_t NumBytesQueued = 0, MaxBytesQueued = 0;
+	for (cSocketThreadList::const_iterator itr = m_Threads.begin(); itr != m_Threads.end(); ++itr)
+	{
+		(*itr)->AddStats(NumSlots, NumBytesQueued, MaxBytesQueued);
+	}  // for itr - m_Threads[]
+	a_Output.Out("Socket threads: %d threads, %d sockets (at most %d per thread)", (int)m_Threads.size(), NumSlots, MAX_SLOTS);
+	a_Output.Out("  received %lld KiB, sent %lld KiB in %lld select() rounds",
+		m_NumBytesReceived / 1024, m_NumBytesSent / 1024, m_NumLoops
+	);
+	a_Output.Out("  outgoing data waiting for the sockets: %d KiB in total, %d KiB at most on a single socket",
+		(int)(NumBytesQueued / 1024), (int)(MaxBytesQueued / 1024)
+	);
+	a_Output.Out("  OS send buffer full: %lld times", m_NumSendBufferFull);
+}
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // cSocketThreads::cSocketThread:
 
@@ -324,6 +353,21 @@ bool cSocketThreads::cSocketThread::Write(const cCallback * a_Client, const AStr
 
 
 
+void cSocketThreads::cSocketThread::AddStats(int & a_NumSlots, size_t & a_NumBytesQueued, size_t & a_MaxBytesQueued) const
+{
+	ASSERT(m_Parent->m_CS.IsLockedByCurrentThread());
+	a_NumSlots += m_NumSlots;
+	for (int i = 0; i < m_NumSlots; i++)
+	{
+		a_NumBytesQueued += m_Slots[i].m_Outgoing.size();
+		a_MaxBytesQueued = std::max(a_MaxBytesQueued, m_Slots[i].m_Outgoing.size());
+	}  // for i - m_Slots[]
+}
+
+
+
+
+
 bool cSocketThreads::cSocketThread::Start(void)
 {
 	// Create the control socket listener
@@ -430,6 +474,7 @@ void cSocketThreads::cSocketThread::PrepareSets(fd_set * a_Read, fd_set * a_Writ
 	FD_SET(m_ControlSocket1.GetSocket(), a_Read);
 
 	cCSLock Lock(m_Parent->m_CS);
+	m_Parent->m_NumLoops += 1;
 	for (int i = m_NumSlots - 1; i >= 0; --i)
 	{
 		if (!m_Slots[i].m_Socket.IsValid())
@@ -518,6 +563,7 @@ void cSocketThreads::cSocketThread::ReadFromSockets(fd_set * a_Read)
 		}
 		else
 		{
+			m_Parent->m_NumBytesReceived += Received;
 			if (m_Slots[i].m_Client != NULL)
 			{
 				m_Slots[i].m_Client->DataReceived(Buffer, Received);
@@ -615,6 +661,7 @@ bool cSocketThreads::cSocketThread::SendDataThroughSocket(cSocket & a_Socket, AS
 			if (Err == cSocket::ErrWouldBlock)
 			{
 				// The OS send buffer is full, leave the outgoing data for the next time
+				m_Parent->m_NumSendBufferFull += 1;
 				return true;
 			}
 			// An error has occured
@@ -625,6 +672,7 @@ bool cSocketThreads::cSocketThread::SendDataThroughSocket(cSocket & a_Socket, AS
 			a_Socket.CloseSocket();
 			return true;
 		}
+		m_Parent->m_NumBytesSent += Sent;
 		a_Data.erase(0, Sent);
 	}
 	return true;
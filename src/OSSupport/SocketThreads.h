@@ -47,6 +47,7 @@ The graph in $/docs/SocketThreads States.gv shows the state-machine transitions
 // fwd:
 class cSocket;
 class cClientHandle;
+class cCommandOutputCallback;
 
 
 
@@ -93,6 +94,9 @@ public:
 	/** Puts a_Data into outgoing data queue for a_Client */
 	void Write(const cCallback * a_Client, const AString & a_Data);
 	
+	/** Outputs the number of threads and sockets, the traffic so far and the outgoing data waiting for the sockets */
+	void LogStats(cCommandOutputCallback & a_Output);
+	
 private:
 
 	class cSocketThread :
@@ -120,6 +124,9 @@ private:
 		
 		bool IsValid(void) const {return m_ControlSocket2.IsValid(); }  // If the Control socket dies, the thread is not valid anymore
 		
+		/** Adds the number of used slots and the outgoing data queued in them to the params; assumes parent's m_CS is locked */
+		void AddStats(int & a_NumSlots, size_t & a_NumBytesQueued, size_t & a_MaxBytesQueued) const;
+		
 	private:
 	
 		cSocketThreads * m_Parent;
@@ -185,6 +192,12 @@ private:
 	
 	cCriticalSection  m_CS;
 	cSocketThreadList m_Threads;
+	
+	// Statistics, protected by m_CS:
+	long long m_NumBytesReceived;
+	long long m_NumBytesSent;
+	long long m_NumLoops;           ///< Number of select() rounds of all the threads
+	long long m_NumSendBufferFull;  ///< Number of times a socket's OS send buffer was full and the data had to wait for the next round
 } ;
 
 
@@ -0,0 +1,153 @@
+
+// PermissionTrie.cpp
+
+// Implements the cPermissionTrie class representing a compiled set of granted permissions that can be checked without allocations
+
+#include "Globals.h"
+#include "PermissionTrie.h"
+
+
+
+
+
+cPermissionTrie::cPermissionTrie(void)
+{
+	Clear();
+}
+
+
+
+
+
+void cPermissionTrie::Clear(void)
+{
+	m_Nodes.clear();
+	m_Nodes.push_back(sNode());  // The root
+}
+
+
+
+
+
+void cPermissionTrie::Add(const AString & a_Permission)
+{
+	AStringVector Split = StringSplit(a_Permission, ".");
+	int NumParts = (int)Split.size();
+	int Node = 0;
+	for (AStringVector::const_iterator itr = Split.begin(), end = Split.end(); itr != end; ++itr)
+	{
+		int Child = FindChild(Node, itr->data(), itr->size());
+		if (Child < 0)
+		{
+			// Insert a new child, keep the children sorted:
+			Child = (int)m_Nodes.size();
+			m_Nodes.push_back(sNode());
+			sNode::cChildren & Children = m_Nodes[Node].m_Children;
+			sNode::cChildren::iterator InsertAt = Children.begin();
+			while ((InsertAt != Children.end()) && (InsertAt->first < *itr))
+			{
+				++InsertAt;
+			}
+			Children.insert(InsertAt, std::make_pair(*itr, Child));
+			if (*itr == "*")
+			{
+				m_Nodes[Node].m_WildcardChild = Child;
+			}
+		}
+		Node = Child;
+		m_Nodes[Node].m_MinNumParts = std::min(m_Nodes[Node].m_MinNumParts, NumParts);
+	}
+	m_Nodes[Node].m_IsTerminal = true;
+}
+
+
+
+
+
+bool cPermissionTrie::HasPermission(const AString & a_Permission) const
+{
+	if (a_Permission.empty())
+	{
+		// Empty permission request is always granted
+		return true;
+	}
+
+	// Count the parts, same as StringSplit() does (a trailing empty part is ignored):
+	int NumParts = 1;
+	for (AString::const_iterator itr = a_Permission.begin(), end = a_Permission.end(); itr != end; ++itr)
+	{
+		if (*itr == '.')
+		{
+			NumParts++;
+		}
+	}
+	if (a_Permission[a_Permission.size() - 1] == '.')
+	{
+		NumParts--;
+	}
+
+	int Node = 0;
+	size_t Start = 0;
+	for (int i = 0; i < NumParts; i++)
+	{
+		size_t End = a_Permission.find('.', Start);
+		if (End == AString::npos)
+		{
+			End = a_Permission.size();
+		}
+		const char * Part = a_Permission.data() + Start;
+		size_t PartLength = End - Start;
+
+		// A "*" at this position grants anything that isn't "*" itself, if the granted permission isn't longer than the requested one:
+		int Wildcard = m_Nodes[Node].m_WildcardChild;
+		if (
+			(Wildcard >= 0) &&
+			(m_Nodes[Wildcard].m_MinNumParts <= NumParts) &&
+			!((PartLength == 1) && (Part[0] == '*'))
+		)
+		{
+			return true;
+		}
+
+		Node = FindChild(Node, Part, PartLength);
+		if (Node < 0)
+		{
+			return false;
+		}
+		Start = End + 1;
+	}
+	return m_Nodes[Node].m_IsTerminal;
+}
+
+
+
+
+
+int cPermissionTrie::FindChild(int a_Node, const char * a_Name, size_t a_NameLength) const
+{
+	// Binary search in the sorted children:
+	const sNode::cChildren & Children = m_Nodes[a_Node].m_Children;
+	size_t Lo = 0, Hi = Children.size();
+	while (Lo < Hi)
+	{
+		size_t Mid = (Lo + Hi) / 2;
+		int Cmp = Children[Mid].first.compare(0, AString::npos, a_Name, a_NameLength);
+		if (Cmp == 0)
+		{
+			return Children[Mid].second;
+		}
+		if (Cmp < 0)
+		{
+			Lo = Mid + 1;
+		}
+		else
+		{
+			Hi = Mid;
+		}
+	}
+	return -1;
+}
+
+
+
+
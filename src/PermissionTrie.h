@@ -0,0 +1,74 @@
+
+// PermissionTrie.h
+
+// Declares the cPermissionTrie class representing a compiled set of granted permissions that can be checked without allocations
+
+/*
+The permissions are dot-separated names, such as "core.give". A granted permission matches the requested one if
+it has the same parts, or if its parts match up to a "*" part that is not a "*" in the request (and the granted
+permission is not longer than the requested one). So "core.*" grants "core.give", and "*" grants everything.
+
+The granted permissions are stored in a trie of their parts. Checking a permission walks the trie along the
+requested parts, comparing them in-place, and looks at the "*" child of each visited node.
+*/
+
+
+
+
+
+#pragma once
+
+
+
+
+
+class cPermissionTrie
+{
+public:
+	cPermissionTrie(void);
+
+	/** Removes all the granted permissions */
+	void Clear(void);
+
+	/** Adds a granted permission */
+	void Add(const AString & a_Permission);
+
+	/** Returns true if the permission is granted by any of the added permissions. Doesn't allocate any memory. */
+	bool HasPermission(const AString & a_Permission) const;
+
+protected:
+	/** A single part of a permission name */
+	struct sNode
+	{
+		typedef std::vector<std::pair<AString, int> > cChildren;
+
+		/** The child nodes (indices into m_Nodes) by their part name, sorted by the name */
+		cChildren m_Children;
+
+		/** Index of the "*" child node, or -1 if there's none */
+		int m_WildcardChild;
+
+		/** True if a granted permission ends in this node */
+		bool m_IsTerminal;
+
+		/** The least number of parts of the granted permissions that go through this node */
+		int m_MinNumParts;
+
+		sNode(void) :
+			m_WildcardChild(-1),
+			m_IsTerminal(false),
+			m_MinNumParts(0x7fffffff)  // No permission yet
+		{
+		}
+	} ;
+
+	/** All the nodes; the first one is the root */
+	std::vector<sNode> m_Nodes;
+
+	/** Returns the index of the child of a_Node with the specified name, or -1 if there's no such child */
+	int FindChild(int a_Node, const char * a_Name, size_t a_NameLength) const;
+} ;
+
+
+
+
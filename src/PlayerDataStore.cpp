@@ -0,0 +1,328 @@
+
+// PlayerDataStore.cpp
+
+// Implements the cPlayerDataStore class that reads and writes the players' data files in a background thread
+
+#include "Globals.h"
+#include "PlayerDataStore.h"
+
+
+
+
+
+/** Number of msec for which the prefetched data waits for Load(); the player may never log in, if the auth fails */
+#define PREFETCH_TIMEOUT 60000
+
+
+
+
+
+cPlayerDataStore::cPlayerDataStore(void) :
+	super("cPlayerDataStore"),
+	m_NumSavesQueued(0),
+	m_NumSavesCoalesced(0),
+	m_NumFilesWritten(0),
+	m_NumPrefetchHits(0)
+{
+}
+
+
+
+
+
+cPlayerDataStore::~cPlayerDataStore()
+{
+	Stop();
+}
+
+
+
+
+
+void cPlayerDataStore::Start(void)
+{
+	m_ShouldTerminate = false;
+	super::Start();
+}
+
+
+
+
+
+void cPlayerDataStore::Stop(void)
+{
+	if (m_Handle == NULL_HANDLE)
+	{
+		// Not running
+		return;
+	}
+	m_ShouldTerminate = true;
+	m_evQueued.Set();
+	Wait();
+
+	cCSLock Lock(m_CS);
+	if (m_NumSavesQueued > 0)
+	{
+		LOGD("Player data store: %d saves queued, %d coalesced, %d files written; %d loads prefetched",
+			m_NumSavesQueued, m_NumSavesCoalesced, m_NumFilesWritten, m_NumPrefetchHits
+		);
+	}
+}
+
+
+
+
+
+void cPlayerDataStore::QueueSave(const AString & a_PlayerName, const AString & a_Data)
+{
+	cCSLock Lock(m_CS);
+	std::pair<cSaves::iterator, bool> Res = m_Saves.insert(cSaves::value_type(a_PlayerName, a_Data));
+	if (!Res.second)
+	{
+		// The previous save hasn't been written yet, this one replaces it:
+		Res.first->second = a_Data;
+		m_NumSavesCoalesced++;
+	}
+	m_NumSavesQueued++;
+
+	// A prefetched file is older than this save:
+	m_Prefetched.erase(a_PlayerName);
+	m_evQueued.Set();
+}
+
+
+
+
+
+void cPlayerDataStore::Prefetch(const AString & a_PlayerName)
+{
+	cCSLock Lock(m_CS);
+	m_PrefetchQueue.push_back(a_PlayerName);
+	m_evQueued.Set();
+}
+
+
+
+
+
+bool cPlayerDataStore::Load(const AString & a_PlayerName, AString & a_Data)
+{
+	{
+		cCSLock Lock(m_CS);
+
+		// The saves that haven't been written yet are newer than the file:
+		cSaves::const_iterator itrSave = m_Saves.find(a_PlayerName);
+		if (itrSave != m_Saves.end())
+		{
+			a_Data = itrSave->second;
+			return true;
+		}
+		itrSave = m_Writing.find(a_PlayerName);
+		if (itrSave != m_Writing.end())
+		{
+			a_Data = itrSave->second;
+			return true;
+		}
+
+		cPrefetched::iterator itrPrefetched = m_Prefetched.find(a_PlayerName);
+		if (itrPrefetched != m_Prefetched.end())
+		{
+			bool Exists = itrPrefetched->second.m_Exists;
+			std::swap(a_Data, itrPrefetched->second.m_Data);
+			m_Prefetched.erase(itrPrefetched);
+			m_NumPrefetchHits++;
+			return Exists;
+		}
+
+		// Not prefetched yet, the prefetch would be wasted:
+		m_PrefetchQueue.remove(a_PlayerName);
+	}
+
+	return ReadFile(a_PlayerName, a_Data);
+}
+
+
+
+
+
+AString cPlayerDataStore::GetFileName(const AString & a_PlayerName)
+{
+	return Printf("players/%s.json", a_PlayerName.c_str());
+}
+
+
+
+
+
+void cPlayerDataStore::Execute(void)
+{
+	for (;;)
+	{
+		m_evQueued.Wait();
+
+		// Read the flag first, so that everything queued before the termination was signalled gets written below:
+		bool ShouldTerminate = m_ShouldTerminate;
+
+		// The prefetches go first, the players are waiting for them:
+		ProcessPrefetches();
+		WriteSaves();
+		if (ShouldTerminate)
+		{
+			return;
+		}
+	}
+}
+
+
+
+
+
+void cPlayerDataStore::ProcessPrefetches(void)
+{
+	for (;;)
+	{
+		AString PlayerName;
+		{
+			cCSLock Lock(m_CS);
+			if (m_PrefetchQueue.empty())
+			{
+				return;
+			}
+			PlayerName = m_PrefetchQueue.front();
+			m_PrefetchQueue.pop_front();
+			if ((m_Saves.find(PlayerName) != m_Saves.end()) || (m_Prefetched.find(PlayerName) != m_Prefetched.end()))
+			{
+				// Load() has the data without the file
+				continue;
+			}
+		}
+
+		sPrefetched Prefetched;
+		Prefetched.m_Exists = ReadFile(PlayerName, Prefetched.m_Data);
+
+		cCSLock Lock(m_CS);
+		if (m_Saves.find(PlayerName) != m_Saves.end())
+		{
+			// The player was saved while reading, the file is outdated:
+			continue;
+		}
+		PurgeExpiredPrefetches();
+		Prefetched.m_ExpireTime = m_Timer.GetNowTime() + PREFETCH_TIMEOUT;
+		std::swap(m_Prefetched[PlayerName], Prefetched);
+	}
+}
+
+
+
+
+
+void cPlayerDataStore::WriteSaves(void)
+{
+	{
+		cCSLock Lock(m_CS);
+		if (m_Saves.empty())
+		{
+			return;
+		}
+		std::swap(m_Writing, m_Saves);
+	}
+
+	// m_Writing is not modified until cleared below, so it is safe to read without the lock:
+	cFile::CreateFolder(FILE_IO_PREFIX + AString("players"));
+	int NumWritten = 0;
+	for (cSaves::const_iterator itr = m_Writing.begin(); itr != m_Writing.end(); ++itr)
+	{
+		if (WriteFile(itr->first, itr->second))
+		{
+			NumWritten++;
+		}
+	}
+
+	cCSLock Lock(m_CS);
+	m_Writing.clear();
+	m_NumFilesWritten += NumWritten;
+}
+
+
+
+
+
+void cPlayerDataStore::PurgeExpiredPrefetches(void)
+{
+	long long Now = m_Timer.GetNowTime();
+	for (cPrefetched::iterator itr = m_Prefetched.begin(); itr != m_Prefetched.end();)
+	{
+		if (itr->second.m_ExpireTime < Now)
+		{
+			m_Prefetched.erase(itr++);
+		}
+		else
+		{
+			++itr;
+		}
+	}  // for itr - m_Prefetched[]
+}
+
+
+
+
+
+bool cPlayerDataStore::ReadFile(const AString & a_PlayerName, AString & a_Data)
+{
+	AString FileName = GetFileName(a_PlayerName);
+	cFile f;
+	if (!f.Open(FileName, cFile::fmRead))
+	{
+		// This is a new player whom we haven't seen yet
+		return false;
+	}
+	if (f.ReadRestOfFile(a_Data) != f.GetSize())
+	{
+		LOGWARNING("Cannot read player data from file \"%s\"", FileName.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+
+
+
+bool cPlayerDataStore::WriteFile(const AString & a_PlayerName, const AString & a_Data)
+{
+	AString FileName = GetFileName(a_PlayerName);
+	AString TempFileName = FileName + ".tmp";
+	{
+		cFile f;
+		if (!f.Open(TempFileName, cFile::fmWrite))
+		{
+			LOGERROR("ERROR WRITING PLAYER \"%s\" TO FILE \"%s\" - cannot open file", a_PlayerName.c_str(), TempFileName.c_str());
+			return false;
+		}
+		if (f.Write(a_Data.data(), a_Data.size()) != (int)a_Data.size())
+		{
+			LOGERROR("ERROR WRITING PLAYER JSON TO FILE \"%s\"", TempFileName.c_str());
+			f.Close();
+			cFile::Delete(FILE_IO_PREFIX + TempFileName);
+			return false;
+		}
+	}
+
+	// Replace the old file; unlike cFile::Rename() on Windows, both of these replace the file atomically:
+	#ifdef _WIN32
+		bool IsReplaced = (MoveFileExA((FILE_IO_PREFIX + TempFileName).c_str(), (FILE_IO_PREFIX + FileName).c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+	#else
+		bool IsReplaced = (rename((FILE_IO_PREFIX + TempFileName).c_str(), (FILE_IO_PREFIX + FileName).c_str()) == 0);
+	#endif
+	if (!IsReplaced)
+	{
+		LOGERROR("ERROR WRITING PLAYER \"%s\" TO FILE \"%s\" - cannot replace the file", a_PlayerName.c_str(), FileName.c_str());
+		cFile::Delete(FILE_IO_PREFIX + TempFileName);
+		return false;
+	}
+	return true;
+}
+
+
+
+
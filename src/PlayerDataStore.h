@@ -0,0 +1,116 @@
+
+// PlayerDataStore.h
+
+// Declares the cPlayerDataStore class that reads and writes the players' data files in a background thread
+
+/*
+The players are saved on the tick thread when they leave the server and when they die; a mass disconnect used to
+write all their files at once, stalling the world. The saves are now only queued there and a background thread
+writes them; a save that replaces a still-queued save of the same player takes its place in the queue. Each file is
+written under a temporary name and then renamed over the old one, so that a crash never leaves a half-written file.
+Loading a player returns their newest data: a save that hasn't been written yet, or the file. The login calls
+Prefetch() as soon as it knows the player's name, so that the file is already in memory once the player object gets
+created after the authentication.
+On shutdown, Stop() writes all the saves queued so far in a single batch.
+*/
+
+
+
+
+
+#pragma once
+
+#include "OSSupport/IsThread.h"
+#include "OSSupport/Timer.h"
+
+
+
+
+
+class cPlayerDataStore :
+	public cIsThread
+{
+	typedef cIsThread super;
+
+public:
+	cPlayerDataStore(void);
+	~cPlayerDataStore();
+
+	/** Starts the background thread */
+	void Start(void);
+
+	/** Writes all the queued saves and stops the background thread */
+	void Stop(void);
+
+	/** Queues the player's data to be written into their file, replacing the player's save that hasn't been written yet */
+	void QueueSave(const AString & a_PlayerName, const AString & a_Data);
+
+	/** Queues reading the player's file, so that a following Load() doesn't need to wait for the disk */
+	void Prefetch(const AString & a_PlayerName);
+
+	/** Returns the player's newest data in a_Data; reads the file right away unless it has been prefetched.
+	Returns false if there's no data for the player */
+	bool Load(const AString & a_PlayerName, AString & a_Data);
+
+	/** Returns the name of the file containing the player's data */
+	static AString GetFileName(const AString & a_PlayerName);
+
+protected:
+	/** A prefetched file */
+	struct sPrefetched
+	{
+		bool      m_Exists;      ///< False if the player has no file
+		AString   m_Data;
+		long long m_ExpireTime;  ///< The cTimer time when the prefetched data is dropped, if not loaded until then
+	} ;
+
+	typedef std::map<AString, AString> cSaves;
+	typedef std::map<AString, sPrefetched> cPrefetched;
+
+	cCriticalSection m_CS;
+
+	/** Set whenever a save or a prefetch is queued */
+	cEvent m_evQueued;
+
+	/** The saves waiting to be written, by the player name */
+	cSaves m_Saves;
+
+	/** The saves being written by the thread. Modified only by the thread while holding m_CS, so that Load() may read them */
+	cSaves m_Writing;
+
+	/** The names of the players whose files are to be prefetched */
+	AStringList m_PrefetchQueue;
+
+	/** The prefetched files waiting for Load(), by the player name */
+	cPrefetched m_Prefetched;
+
+	cTimer m_Timer;
+
+	// Statistics, modified while holding m_CS:
+	int m_NumSavesQueued;
+	int m_NumSavesCoalesced;
+	int m_NumFilesWritten;
+	int m_NumPrefetchHits;
+
+	// cIsThread override:
+	virtual void Execute(void) override;
+
+	/** Reads the files of all the players in m_PrefetchQueue */
+	void ProcessPrefetches(void);
+
+	/** Writes all the saves queued in m_Saves */
+	void WriteSaves(void);
+
+	/** Drops the prefetched data that hasn't been loaded in time. Expects m_CS to be held */
+	void PurgeExpiredPrefetches(void);
+
+	/** Reads the player's file into a_Data. Returns false if the player has no file or it cannot be read */
+	static bool ReadFile(const AString & a_PlayerName, AString & a_Data);
+
+	/** Writes a_Data into the player's file through a temporary file. Returns true if successful */
+	static bool WriteFile(const AString & a_PlayerName, const AString & a_Data);
+} ;
+
+
+
+
@@ -7,7 +7,7 @@
 
 #include "Globals.h"
 #include "ChunkDataSerializer.h"
-#include "zlib/zlib.h"
+#include "../Compressor.h"
 
 
 
@@ -17,13 +17,15 @@ cChunkDataSerializer::cChunkDataSerializer(
 	const cChunkDef::BlockNibbles & a_BlockMetas,
 	const cChunkDef::BlockNibbles & a_BlockLight,
 	const cChunkDef::BlockNibbles & a_BlockSkyLight,
-	const unsigned char *           a_BiomeData
+	const unsigned char *           a_BiomeData,
+	cCompressor &                   a_Compressor
 ) :
 	m_BlockTypes(a_BlockTypes),
 	m_BlockMetas(a_BlockMetas),
 	m_BlockLight(a_BlockLight),
 	m_BlockSkyLight(a_BlockSkyLight),
-	m_BiomeData(a_BiomeData)
+	m_BiomeData(a_BiomeData),
+	m_Compressor(a_Compressor)
 {
 }
 
@@ -80,18 +82,11 @@ void cChunkDataSerializer::Serialize29(AString & a_Data)
 	memcpy(AllData + SkyLightOffset,   m_BlockSkyLight, sizeof(m_BlockSkyLight));
 	memcpy(AllData + BiomeOffset,      m_BiomeData,     BiomeDataSize);
 
-	// Compress the data:
-	// In order not to use allocation, use a fixed-size buffer, with the size
-	// that uses the same calculation as compressBound():
-	const uLongf CompressedMaxSize = DataSize + (DataSize >> 12) + (DataSize >> 14) + (DataSize >> 25) + 16;
-	char CompressedBlockData[CompressedMaxSize];
-
-	uLongf CompressedSize = compressBound(DataSize);
-	
-	// Run-time check that our compile-time guess about CompressedMaxSize was enough:
-	ASSERT(CompressedSize <= CompressedMaxSize);
-	
-	compress2((Bytef*)CompressedBlockData, &CompressedSize, (const Bytef*)AllData, sizeof(AllData), Z_DEFAULT_COMPRESSION);
+	// Compress the data; the clients only understand zlib, the level is configurable:
+	ASSERT(m_Compressor.GetCodec() == cCompressor::codecZlib);
+	AString CompressedBlockData;
+	m_Compressor.Compress(AllData, sizeof(AllData), CompressedBlockData);
+	int CompressedSize = (int)CompressedBlockData.size();
 
 	// Now put all those data into a_Data:
 	
@@ -111,7 +106,7 @@ void cChunkDataSerializer::Serialize29(AString & a_Data)
 	Int32 UnusedInt32 = 0;
 	a_Data.append((const char *)&UnusedInt32,      sizeof(UnusedInt32));
 	
-	a_Data.append(CompressedBlockData, CompressedSize);
+	a_Data.append(CompressedBlockData);
 }
 
 
@@ -138,18 +133,11 @@ void cChunkDataSerializer::Serialize39(AString & a_Data)
 	memcpy(AllData + SkyLightOffset,   m_BlockSkyLight, sizeof(m_BlockSkyLight));
 	memcpy(AllData + BiomeOffset,      m_BiomeData,     BiomeDataSize);
 
-	// Compress the data:
-	// In order not to use allocation, use a fixed-size buffer, with the size
-	// that uses the same calculation as compressBound():
-	const uLongf CompressedMaxSize = DataSize + (DataSize >> 12) + (DataSize >> 14) + (DataSize >> 25) + 16;
-	char CompressedBlockData[CompressedMaxSize];
-
-	uLongf CompressedSize = compressBound(DataSize);
-	
-	// Run-time check that our compile-time guess about CompressedMaxSize was enough:
-	ASSERT(CompressedSize <= CompressedMaxSize);
-	
-	compress2((Bytef*)CompressedBlockData, &CompressedSize, (const Bytef*)AllData, sizeof(AllData), Z_DEFAULT_COMPRESSION);
+	// Compress the data; the clients only understand zlib, the level is configurable:
+	ASSERT(m_Compressor.GetCodec() == cCompressor::codecZlib);
+	AString CompressedBlockData;
+	m_Compressor.Compress(AllData, sizeof(AllData), CompressedBlockData);
+	int CompressedSize = (int)CompressedBlockData.size();
 
 	// Now put all those data into a_Data:
 	
@@ -168,7 +156,7 @@ void cChunkDataSerializer::Serialize39(AString & a_Data)
 	
 	// Unlike 29, 39 doesn't have the "unused" int
 	
-	a_Data.append(CompressedBlockData, CompressedSize);
+	a_Data.append(CompressedBlockData);
 }
 
 
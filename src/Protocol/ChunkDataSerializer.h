@@ -9,6 +9,13 @@
 
 
 
+// fwd:
+class cCompressor;
+
+
+
+
+
 class cChunkDataSerializer
 {
 protected:
@@ -17,6 +24,7 @@ protected:
 	const cChunkDef::BlockNibbles & m_BlockLight;
 	const cChunkDef::BlockNibbles & m_BlockSkyLight;
 	const unsigned char * m_BiomeData;
+	cCompressor & m_Compressor;  // Used for compressing the data, keeps the network compression stats
 	
 	typedef std::map<int, AString> Serializations;
 	
@@ -37,7 +45,8 @@ public:
 		const cChunkDef::BlockNibbles & a_BlockMetas,
 		const cChunkDef::BlockNibbles & a_BlockLight,
 		const cChunkDef::BlockNibbles & a_BlockSkyLight,
-		const unsigned char *           a_BiomeData
+		const unsigned char *           a_BiomeData,
+		cCompressor &                   a_Compressor
 	);
 
 	const AString & Serialize(int a_Version);  // Returns one of the internal m_Serializations[]
@@ -14,6 +14,7 @@
 #include "Blocks/BlockHandler.h"
 #include "Items/ItemHandler.h"
 #include "Chunk.h"
+#include "Simulator/FluidSimulator.h"
 #include "Protocol/ProtocolRecognizer.h"  // for protocol version constants
 #include "CommandOutput.h"
 #include "DeadlockDetect.h"
@@ -53,6 +54,7 @@ cRoot::cRoot(void) :
 	m_FurnaceRecipe(NULL),
 	m_WebAdmin(NULL),
 	m_PluginManager(NULL),
+	m_Authenticator(m_AuthCallbacks),
 	m_Log(NULL),
 	m_bStop(false),
 	m_bRestart(false)
@@ -175,6 +177,9 @@ void cRoot::Start(void)
 		LOGD("Starting Authenticator...");
 		m_Authenticator.Start(IniFile);
 		
+		LOGD("Starting player data store...");
+		m_PlayerDataStore.Start();
+		
 		LOGD("Starting worlds...");
 		StartWorlds();
 		
@@ -249,6 +254,8 @@ void cRoot::Start(void)
 
 		LOG("Cleaning up...");
 		delete m_Server; m_Server = NULL;
+		LOGD("Writing the player data...");
+		m_PlayerDataStore.Stop();
 		LOG("Shutdown successful!");
 	}
 
@@ -508,6 +515,24 @@ void cRoot::AuthenticateUser(int a_ClientID)
 
 
 
+void cRoot::cAuthCallbacks::OnAuthenticated(int a_ClientID)
+{
+	cRoot::Get()->AuthenticateUser(a_ClientID);
+}
+
+
+
+
+
+void cRoot::cAuthCallbacks::OnAuthFailed(int a_ClientID, const AString & a_Reason)
+{
+	cRoot::Get()->KickUser(a_ClientID, a_Reason);
+}
+
+
+
+
+
 int cRoot::GetTotalChunkCount(void)
 {
 	int res = 0;
@@ -804,6 +829,106 @@ void cRoot::LogChunkStats(cCommandOutputCallback & a_Output)
 
 
 
+void cRoot::LogTickStats(cCommandOutputCallback & a_Output)
+{
+	for (WorldMap::iterator itr = m_WorldsByName.begin(), end = m_WorldsByName.end(); itr != end; ++itr)
+	{
+		cWorld * World = itr->second;
+		a_Output.Out("World %s:", World->GetName().c_str());
+		a_Output.Out("  TPS: %.2f", World->GetCurrentTPS());
+		a_Output.Out("  Average tick duration: %.1f msec", World->GetAvgTickDuration());
+		a_Output.Out("  Overload level: %d", World->GetOverloadLevel());
+		a_Output.Out("  Deferred work since start:");
+		a_Output.Out("    mob spawning rounds: %lld", World->GetNumDeferredWork(cWorld::dwMobSpawning));
+		a_Output.Out("    weather on top:      %lld", World->GetNumDeferredWork(cWorld::dwWeatherOnTop));
+		a_Output.Out("    random block ticks:  %lld", World->GetNumDeferredWork(cWorld::dwRandomBlockTicks));
+		a_Output.Out("    far mob ticks:       %lld", World->GetNumDeferredWork(cWorld::dwFarMobTicks));
+		a_Output.Out("  Fluid blocks in the last tick:");
+		a_Output.Out("    water: %d simulated, %d settled and skipped", World->GetWaterSimulator()->GetNumSimulatedLastTick(), World->GetWaterSimulator()->GetNumSkippedLastTick());
+		a_Output.Out("    lava:  %d simulated, %d settled and skipped", World->GetLavaSimulator()->GetNumSimulatedLastTick(), World->GetLavaSimulator()->GetNumSkippedLastTick());
+		World->GetPathService().LogStats(a_Output);
+		World->GetLineOfSight().LogStats(a_Output);
+		World->GetBlockChangeStats().LogStats(a_Output);
+		World->GetChunkMap()->LogBlockEntityStats(a_Output);
+	}
+}
+
+
+
+
+
+void cRoot::LogStorageStats(cCommandOutputCallback & a_Output)
+{
+	for (WorldMap::iterator itr = m_WorldsByName.begin(), end = m_WorldsByName.end(); itr != end; ++itr)
+	{
+		a_Output.Out("World %s:", itr->second->GetName().c_str());
+		itr->second->GetStorage().LogStats(a_Output);
+	}
+}
+
+
+
+
+
+void cRoot::LogCompressionStats(cCommandOutputCallback & a_Output)
+{
+	for (WorldMap::iterator itr = m_WorldsByName.begin(), end = m_WorldsByName.end(); itr != end; ++itr)
+	{
+		cWorld * World = itr->second;
+		a_Output.Out("World %s:", World->GetName().c_str());
+		World->GetStorageCompressor().LogStats(a_Output);
+		World->GetNetworkCompressor().LogStats(a_Output);
+	}
+}
+
+
+
+
+
+void cRoot::LogLockStats(cCommandOutputCallback & a_Output)
+{
+	if (!cCriticalSection::IsProfilingEnabled())
+	{
+		a_Output.Out("Lock profiling is disabled, use \"lockstats on\" to enable it.");
+	}
+	cCriticalSection::cStatsList Stats;
+	cCriticalSection::GetProfile(Stats);
+	for (cCriticalSection::cStatsList::const_iterator itr = Stats.begin(), end = Stats.end(); itr != end; ++itr)
+	{
+		a_Output.Out("%s (%d instances):", itr->m_Name.c_str(), itr->m_NumInstances);
+		a_Output.Out("  acquisitions: %lld, contended: %lld (%.1f %%)",
+			itr->m_NumAcquisitions, itr->m_NumContended,
+			(itr->m_NumAcquisitions > 0) ? 100.0 * itr->m_NumContended / itr->m_NumAcquisitions : 0.0
+		);
+		a_Output.Out("  total wait: %.1f msec, total hold: %.1f msec, longest hold: %.1f msec",
+			itr->m_WaitTime / 1000.0, itr->m_HoldTime / 1000.0, itr->m_LongestHold / 1000.0
+		);
+	}  // for itr - Stats[]
+}
+
+
+
+
+
+void cRoot::LogNetworkStats(cCommandOutputCallback & a_Output)
+{
+	for (WorldMap::iterator itr = m_WorldsByName.begin(), end = m_WorldsByName.end(); itr != end; ++itr)
+	{
+		cWorld * World = itr->second;
+		int NumClients, NumChunksToSend, MaxChunksToSend;
+		World->GetClientChunkStats(NumClients, NumChunksToSend, MaxChunksToSend);
+		a_Output.Out("World %s:", World->GetName().c_str());
+		a_Output.Out("  Clients: %d, chunks waiting to be sent: %d in total, %d at most for a single client",
+			NumClients, NumChunksToSend, MaxChunksToSend
+		);
+		World->GetChunkSender().LogStats(a_Output);
+	}
+}
+
+
+
+
+
 int cRoot::GetFurnaceFuelBurnTime(const cItem & a_Fuel)
 {
 	cFurnaceRecipe * FR = Get()->GetFurnaceRecipe();
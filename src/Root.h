@@ -3,6 +3,8 @@
 
 #include "Authenticator.h"
 #include "HTTPServer/HTTPServer.h"
+#include "PlayerDataStore.h"
+#include "UI/WindowSyncStats.h"
 #include "Defines.h"
 
 
@@ -52,6 +54,24 @@ public:
 	/// Writes chunkstats, for each world and totals, to the output callback
 	void LogChunkStats(cCommandOutputCallback & a_Output);
 	
+	/// Writes the tick scheduler stats (TPS, tick duration, deferred work) for each world to the output callback
+	void LogTickStats(cCommandOutputCallback & a_Output);
+	
+	/// Writes the storage stats (such as the region file fragmentation) for each world to the output callback
+	void LogStorageStats(cCommandOutputCallback & a_Output);
+	
+	/// Writes the compression stats (ratio, CPU time) of each compression path of each world to the output callback
+	void LogCompressionStats(cCommandOutputCallback & a_Output);
+	
+	/// Writes the lock contention of the named critical sections to the output callback
+	void LogLockStats(cCommandOutputCallback & a_Output);
+	
+	/** Output the per-world chunk streaming stats: the chunks waiting for the clients and the chunk senders' queues */
+	void LogNetworkStats(cCommandOutputCallback & a_Output);
+	
+	/// Returns the counters of the window slots sent to the clients, shared by all the windows
+	cWindowSyncStats & GetWindowSyncStats(void) { return m_WindowSyncStats; }
+	
 	int GetPrimaryServerVersion(void) const { return m_PrimaryServerVersion; }  // tolua_export
 	void SetPrimaryServerVersion(int a_Version) { m_PrimaryServerVersion = a_Version; }  // tolua_export
 	
@@ -67,6 +87,7 @@ public:
 	cWebAdmin *        GetWebAdmin       (void) { return m_WebAdmin; }         // tolua_export
 	cPluginManager *   GetPluginManager  (void) { return m_PluginManager; }    // tolua_export
 	cAuthenticator &   GetAuthenticator  (void) { return m_Authenticator; }
+	cPlayerDataStore & GetPlayerDataStore(void) { return m_PlayerDataStore; }
 
 	/** Queues a console command for execution through the cServer class.
 	The command will be executed in the tick thread
@@ -148,6 +169,15 @@ private:
 		cCommandOutputCallback * m_Output;
 	} ;
 	
+	/// Forwards the authentication results to the server
+	class cAuthCallbacks :
+		public cAuthenticator::cCallbacks
+	{
+		// cAuthenticator::cCallbacks overrides:
+		virtual void OnAuthenticated(int a_ClientID) override;
+		virtual void OnAuthFailed(int a_ClientID, const AString & a_Reason) override;
+	} ;
+	
 	typedef std::map<AString, cWorld *> WorldMap;
 	typedef std::vector<cCommand> cCommandQueue;
 	
@@ -170,8 +200,11 @@ private:
 	cFurnaceRecipe *   m_FurnaceRecipe;
 	cWebAdmin *        m_WebAdmin;
 	cPluginManager *   m_PluginManager;
+	cAuthCallbacks     m_AuthCallbacks;
 	cAuthenticator     m_Authenticator;
+	cPlayerDataStore   m_PlayerDataStore;
 	cHTTPServer        m_HTTPServer;
+	cWindowSyncStats   m_WindowSyncStats;
 
 	cMCLogger *      m_Log;
 
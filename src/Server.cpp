@@ -480,6 +480,51 @@ void cServer::ExecuteConsoleCommand(const AString & a_Cmd, cCommandOutputCallbac
 		a_Output.Finished();
 		return;
 	}
+	if (split[0].compare("tickstats") == 0)
+	{
+		cRoot::Get()->LogTickStats(a_Output);
+		a_Output.Finished();
+		return;
+	}
+	if (split[0].compare("storagestats") == 0)
+	{
+		cRoot::Get()->LogStorageStats(a_Output);
+		a_Output.Finished();
+		return;
+	}
+	if (split[0].compare("compressionstats") == 0)
+	{
+		cRoot::Get()->LogCompressionStats(a_Output);
+		a_Output.Finished();
+		return;
+	}
+	if (split[0].compare("lockstats") == 0)
+	{
+		if ((split.size() > 1) && ((split[1] == "on") || (split[1] == "off")))
+		{
+			cCriticalSection::SetProfilingEnabled(split[1] == "on");
+			a_Output.Out("Lock profiling is %s.", (split[1] == "on") ? "enabled, the stats have been reset" : "disabled");
+		}
+		else
+		{
+			cRoot::Get()->LogLockStats(a_Output);
+		}
+		a_Output.Finished();
+		return;
+	}
+	if (split[0].compare("netstats") == 0)
+	{
+		m_SocketThreads.LogStats(a_Output);
+		cRoot::Get()->LogNetworkStats(a_Output);
+		a_Output.Finished();
+		return;
+	}
+	if (split[0].compare("windowstats") == 0)
+	{
+		cRoot::Get()->GetWindowSyncStats().LogStats(a_Output);
+		a_Output.Finished();
+		return;
+	}
 	#if defined(_MSC_VER) && defined(_DEBUG) && defined(ENABLE_LEAK_FINDER)
 	if (split[0].compare("dumpmem") == 0)
 	{
@@ -563,6 +608,12 @@ void cServer::BindBuiltInConsoleCommands(void)
 	PlgMgr->BindConsoleCommand("restart", NULL, " - Restarts the server cleanly");
 	PlgMgr->BindConsoleCommand("stop", NULL, " - Stops the server cleanly");
 	PlgMgr->BindConsoleCommand("chunkstats", NULL, " - Displays detailed chunk memory statistics");
+	PlgMgr->BindConsoleCommand("tickstats",  NULL, " - Displays the world tick rate, the work deferred due to overload and the block entities being ticked");
+	PlgMgr->BindConsoleCommand("storagestats", NULL, " - Displays the region file fragmentation and compaction statistics");
+	PlgMgr->BindConsoleCommand("compressionstats", NULL, " - Displays the compression ratio and CPU time of the chunk storage and network");
+	PlgMgr->BindConsoleCommand("lockstats", NULL, " [on|off] - Displays the contention of the named locks; \"on\" starts the profiling anew");
+	PlgMgr->BindConsoleCommand("netstats", NULL, " - Displays the network traffic and the chunks waiting to be sent to the clients");
+	PlgMgr->BindConsoleCommand("windowstats", NULL, " - Displays the number of window slots sent to the clients and the bandwidth saved");
 	#if defined(_MSC_VER) && defined(_DEBUG) && defined(ENABLE_LEAK_FINDER)
 	PlgMgr->BindConsoleCommand("dumpmem", NULL, " - Dumps all used memory blocks together with their callstacks into memdump.xml");
 	#endif
@@ -0,0 +1,89 @@
+
+// ChunkBlockBitmap.cpp
+
+// Implements the cChunkBlockBitmap class representing a set of blocks in a chunk as one bit per block index, used by the simulators' queues
+
+#include "Globals.h"
+#include "ChunkBlockBitmap.h"
+
+
+
+
+
+/** Number of the UInt32 words needed for all the blocks in a chunk */
+#define BITMAP_NUM_WORDS (cChunkDef::NumBlocks / 32)
+
+
+
+
+
+cChunkBlockBitmap::cChunkBlockBitmap(void) :
+	m_Bits(NULL),
+	m_Count(0)
+{
+}
+
+
+
+
+
+cChunkBlockBitmap::~cChunkBlockBitmap()
+{
+	delete[] m_Bits;
+}
+
+
+
+
+
+bool cChunkBlockBitmap::Set(int a_BlockIdx)
+{
+	ASSERT((a_BlockIdx >= 0) && (a_BlockIdx < cChunkDef::NumBlocks));
+	if (m_Bits == NULL)
+	{
+		m_Bits = new UInt32[BITMAP_NUM_WORDS];
+		memset(m_Bits, 0, BITMAP_NUM_WORDS * sizeof(UInt32));
+	}
+	UInt32 & Word = m_Bits[a_BlockIdx / 32];
+	UInt32 Mask = 1u << (a_BlockIdx % 32);
+	if ((Word & Mask) != 0)
+	{
+		return false;
+	}
+	Word |= Mask;
+	m_Count += 1;
+	return true;
+}
+
+
+
+
+
+void cChunkBlockBitmap::Clear(int a_BlockIdx)
+{
+	if (!IsSet(a_BlockIdx))
+	{
+		return;
+	}
+	m_Bits[a_BlockIdx / 32] &= ~(1u << (a_BlockIdx % 32));
+	m_Count -= 1;
+	if (m_Count == 0)
+	{
+		ClearAll();
+	}
+}
+
+
+
+
+
+void cChunkBlockBitmap::ClearAll(void)
+{
+	delete[] m_Bits;
+	m_Bits = NULL;
+	m_Count = 0;
+}
+
+
+
+
@@ -0,0 +1,61 @@
+
+// ChunkBlockBitmap.h
+
+// Declares the cChunkBlockBitmap class representing a set of blocks in a chunk as one bit per block index, used by the simulators' queues
+
+
+
+
+
+#pragma once
+
+#include "../ChunkDef.h"
+
+
+
+
+
+/** Tells which blocks of a chunk are queued in a simulator, so that adding a block can check for duplicates in constant time.
+The bits are indexed by cChunkDef::MakeIndex(). The memory (8 KiB) is allocated only while at least one bit is set,
+the chunks without any simulation going on take no memory. */
+class cChunkBlockBitmap
+{
+public:
+	cChunkBlockBitmap(void);
+	~cChunkBlockBitmap();
+	
+	/** Returns true if the bit for the block is set */
+	bool IsSet(int a_BlockIdx) const
+	{
+		ASSERT((a_BlockIdx >= 0) && (a_BlockIdx < cChunkDef::NumBlocks));
+		return (m_Bits != NULL) && ((m_Bits[a_BlockIdx / 32] & (1u << (a_BlockIdx % 32))) != 0);
+	}
+	
+	/** Sets the bit for the block. Returns true if it was set now, false if it had been set already */
+	bool Set(int a_BlockIdx);
+	
+	/** Clears the bit for the block; frees the memory once no bit is set */
+	void Clear(int a_BlockIdx);
+	
+	/** Clears all the bits and frees the memory */
+	void ClearAll(void);
+	
+	/** Returns the number of the bits set */
+	int GetCount(void) const { return m_Count; }
+	
+protected:
+	/** The bits, NULL if none is set */
+	UInt32 * m_Bits;
+	
+	/** Number of the bits set */
+	int m_Count;
+	
+private:
+	// Not copyable, the bitmaps are owned by the chunks:
+	cChunkBlockBitmap(const cChunkBlockBitmap &);
+	cChunkBlockBitmap & operator = (const cChunkBlockBitmap &);
+} ;
+
+
+
+
@@ -15,47 +15,37 @@
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// cDelayedFluidSimulatorChunkData::cSlot
+// cDelayedFluidSimulatorChunkData:
 
-bool cDelayedFluidSimulatorChunkData::cSlot::Add(int a_RelX, int a_RelY, int a_RelZ)
+cDelayedFluidSimulatorChunkData::cDelayedFluidSimulatorChunkData(int a_TickDelay) :
+	m_Slots(new cSlot[a_TickDelay])
 {
-	ASSERT(a_RelZ >= 0);
-	ASSERT(a_RelZ < ARRAYCOUNT(m_Blocks));
-	
-	cCoordWithIntVector & Blocks = m_Blocks[a_RelZ];
-	int Index = cChunkDef::MakeIndexNoCheck(a_RelX, a_RelY, a_RelZ);
-	for (cCoordWithIntVector::const_iterator itr = Blocks.begin(), end = Blocks.end(); itr != end; ++itr)
-	{
-		if (itr->Data == Index)
-		{
-			// Already present
-			return false;
-		}
-	}  // for itr - Blocks[]
-	Blocks.push_back(cCoordWithInt(a_RelX, a_RelY, a_RelZ, Index));
-	return true;
 }
 
 
 
 
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// cDelayedFluidSimulatorChunkData:
-
-cDelayedFluidSimulatorChunkData::cDelayedFluidSimulatorChunkData(int a_TickDelay) :
-	m_Slots(new cSlot[a_TickDelay])
+cDelayedFluidSimulatorChunkData::~cDelayedFluidSimulatorChunkData()
 {
+	delete[] m_Slots;
+	m_Slots = NULL;
 }
 
 
 
 
 
-cDelayedFluidSimulatorChunkData::~cDelayedFluidSimulatorChunkData()
+bool cDelayedFluidSimulatorChunkData::Add(int a_SlotNum, int a_RelX, int a_RelY, int a_RelZ)
 {
-	delete[] m_Slots;
-	m_Slots = NULL;
+	int Index = cChunkDef::MakeIndexNoCheck(a_RelX, a_RelY, a_RelZ);
+	if (!m_IsQueued.Set(Index))
+	{
+		// Already present
+		return false;
+	}
+	m_Slots[a_SlotNum].push_back(Index);
+	return true;
 }
 
 
@@ -101,14 +91,14 @@ void cDelayedFluidSimulator::AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ,
 
 	void * ChunkDataRaw = (m_FluidBlock == E_BLOCK_WATER) ? a_Chunk->GetWaterSimulatorData() : a_Chunk->GetLavaSimulatorData();
 	cDelayedFluidSimulatorChunkData * ChunkData = (cDelayedFluidSimulatorChunkData *)ChunkDataRaw;
-	cDelayedFluidSimulatorChunkData::cSlot & Slot = ChunkData->m_Slots[m_AddSlotNum];
 	
 	// Add, if not already present:
-	if (!Slot.Add(RelX, a_BlockY, RelZ))
+	if (!ChunkData->Add(m_AddSlotNum, RelX, a_BlockY, RelZ))
 	{
 		return;
 	}
 
+	cCSLock Lock(m_CSStatistics);
 	++m_TotalBlocks;
 }
 
@@ -118,6 +108,8 @@ void cDelayedFluidSimulator::AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ,
 
 void cDelayedFluidSimulator::Simulate(float a_Dt)
 {
+	StartTickStatistics();
+	
 	m_AddSlotNum = m_SimSlotNum;
 	m_SimSlotNum += 1;
 	if (m_SimSlotNum >= m_TickDelay)
@@ -134,23 +126,32 @@ void cDelayedFluidSimulator::SimulateChunk(float a_Dt, int a_ChunkX, int a_Chunk
 {	
 	void * ChunkDataRaw = (m_FluidBlock == E_BLOCK_WATER) ? a_Chunk->GetWaterSimulatorData() : a_Chunk->GetLavaSimulatorData();
 	cDelayedFluidSimulatorChunkData * ChunkData = (cDelayedFluidSimulatorChunkData *)ChunkDataRaw;
-	cDelayedFluidSimulatorChunkData::cSlot & Slot = ChunkData->m_Slots[m_SimSlotNum];
+	
+	// Take the scheduled slot out, so that the blocks added while simulating don't get into it:
+	cDelayedFluidSimulatorChunkData::cSlot Blocks;
+	std::swap(Blocks, ChunkData->m_Slots[m_SimSlotNum]);
 	
 	// Simulate all the blocks in the scheduled slot:
-	for (size_t i = 0; i < ARRAYCOUNT(Slot.m_Blocks); i++)
+	int NumSimulated = 0;
+	int NumSettled = 0;
+	for (cDelayedFluidSimulatorChunkData::cSlot::const_iterator itr = Blocks.begin(), end = Blocks.end(); itr != end; ++itr)
 	{
-		cCoordWithIntVector & Blocks = Slot.m_Blocks[i];
-		if (Blocks.empty())
+		// Unmark the block first, the simulation may queue it again:
+		ChunkData->m_IsQueued.Clear(*itr);
+		Vector3i Pos = cChunkDef::IndexToCoordinate(*itr);
+		switch (SimulateBlock(a_Chunk, Pos.x, Pos.y, Pos.z))
 		{
-			continue;
+			case srSimulated: NumSimulated += 1; break;
+			case srSettled:   NumSettled += 1;   break;
+			case srNotFluid:                     break;
 		}
-		for (cCoordWithIntVector::iterator itr = Blocks.begin(), end = Blocks.end(); itr != end; ++itr)
-		{
-			SimulateBlock(a_Chunk, itr->x, itr->y, itr->z);
-		}
-		m_TotalBlocks -= Blocks.size();
-		Blocks.clear();
 	}
+	
+	// The tick regions may be simulating other chunks in other threads, update the shared statistics at once:
+	cCSLock Lock(m_CSStatistics);
+	m_NumSimulated += NumSimulated;
+	m_NumSkipped += NumSettled;
+	m_TotalBlocks -= (int)Blocks.size();
 }
 
 
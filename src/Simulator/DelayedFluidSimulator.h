@@ -10,6 +10,7 @@
 #pragma once
 
 #include "FluidSimulator.h"
+#include "ChunkBlockBitmap.h"
 
 
 
@@ -19,26 +20,20 @@ class cDelayedFluidSimulatorChunkData :
 	public cFluidSimulatorData
 {
 public:
-	class cSlot
-	{
-	public:
-		/// Returns true if the specified block is stored
-		bool HasBlock(int a_RelX, int a_RelY, int a_RelZ);
-		
-		/// Adds the specified block unless already present; returns true if added, false if the block was already present
-		bool Add(int a_RelX, int a_RelY, int a_RelZ);
-		
-		/** Array of block containers, each item stores blocks for one Z coord
-		Int param is the block index (for faster duplicate comparison in Add())
-		*/
-		cCoordWithIntVector m_Blocks[16];
-	} ;
+	/// The blocks to simulate in one delay tick, as block indices (cChunkDef::MakeIndex())
+	typedef std::vector<int> cSlot;
 	
 	cDelayedFluidSimulatorChunkData(int a_TickDelay);
 	virtual ~cDelayedFluidSimulatorChunkData();
 	
+	/// Adds the specified block to the slot unless already queued in any slot; returns true if added, false if the block was already queued
+	bool Add(int a_SlotNum, int a_RelX, int a_RelY, int a_RelZ);
+	
 	/// Slots, one for each delay tick, each containing the blocks to simulate
 	cSlot * m_Slots;
+	
+	/// The blocks queued in any of the slots; a block is taken out right before it is simulated
+	cChunkBlockBitmap m_IsQueued;
 } ;
 
 
@@ -65,7 +60,7 @@ protected:
 	int m_AddSlotNum;  // Index into m_Slots[] where to add new blocks in each ChunkData
 	int m_SimSlotNum;  // Index into m_Slots[] where to simulate blocks in each ChunkData
 	
-	int m_TotalBlocks;  // Statistics only: the total number of blocks currently queued
+	int m_TotalBlocks;  // Statistics only: the total number of blocks currently queued; updated under m_CSStatistics
 
 	/*
 	Slots:
@@ -73,8 +68,16 @@ protected:
 	        adding blocks here ^ | ^ simulating here
 	*/
 	
+	/// The outcome of SimulateBlock(), for the statistics
+	enum eSimulateResult
+	{
+		srSimulated,  ///< The block has been simulated
+		srSettled,    ///< The block was settled and has been left alone
+		srNotFluid,   ///< The block is no longer a fluid block
+	} ;
+	
 	/// Called from SimulateChunk() to simulate each block in one slot of blocks. Descendants override this method to provide custom simulation.
-	virtual void SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ) = 0;
+	virtual eSimulateResult SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ) = 0;
 } ;
 
 
@@ -88,39 +88,45 @@ cFireSimulator::~cFireSimulator()
 
 void cFireSimulator::SimulateChunk(float a_Dt, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk)
 {
-	cCoordWithIntList & Data = a_Chunk->GetFireSimulatorData();
+	cFireSimulatorChunkData & ChunkData = a_Chunk->GetFireSimulatorData();
+	cCoordWithIntVector & Data = ChunkData.m_Blocks;
 
+	// Note that the fires started while simulating get appended to Data and thus simulated in the same pass.
+	// The vector may reallocate in the process, so the block's coords are copied instead of being referenced.
 	int NumMSecs = (int)a_Dt;
-	for (cCoordWithIntList::iterator itr = Data.begin(); itr != Data.end();)
+	for (size_t i = 0; i < Data.size();)
 	{
-		int idx = cChunkDef::MakeIndexNoCheck(itr->x, itr->y, itr->z);
+		int x = Data[i].x;
+		int y = Data[i].y;
+		int z = Data[i].z;
+		int idx = cChunkDef::MakeIndexNoCheck(x, y, z);
 		BLOCKTYPE BlockType = a_Chunk->GetBlock(idx);
 
 		if (!IsAllowedBlock(BlockType))
 		{
 			// The block is no longer eligible (not a fire block anymore; a player probably placed a block over the fire)
 			FLOG("FS: Removing block {%d, %d, %d}",
-				itr->x + a_ChunkX * cChunkDef::Width, itr->y, itr->z + a_ChunkZ * cChunkDef::Width
+				x + a_ChunkX * cChunkDef::Width, y, z + a_ChunkZ * cChunkDef::Width
 			);
-			itr = Data.erase(itr);
+			RemoveBlock(ChunkData, i);
 			continue;
 		}
 
 		// Try to spread the fire:
-		TrySpreadFire(a_Chunk, itr->x, itr->y, itr->z);
+		TrySpreadFire(a_Chunk, x, y, z);
 
-		itr->Data -= NumMSecs;
-		if (itr->Data >= 0)
+		Data[i].Data -= NumMSecs;
+		if (Data[i].Data >= 0)
 		{
 			// Not yet, wait for it longer
-			++itr;
+			++i;
 			continue;
 		}
 		
 		// Burn out the fire one step by increasing the meta:
 		/*
 		FLOG("FS: Fire at {%d, %d, %d} is stepping",
-			itr->x + a_ChunkX * cChunkDef::Width, itr->y, itr->z + a_ChunkZ * cChunkDef::Width
+			x + a_ChunkX * cChunkDef::Width, y, z + a_ChunkZ * cChunkDef::Width
 		);
 		*/
 		NIBBLETYPE BlockMeta = a_Chunk->GetMeta(idx);
@@ -128,20 +134,22 @@ void cFireSimulator::SimulateChunk(float a_Dt, int a_ChunkX, int a_ChunkZ, cChun
 		{
 			// The fire burnt out completely
 			FLOG("FS: Fire at {%d, %d, %d} burnt out, removing the fire block",
-				itr->x + a_ChunkX * cChunkDef::Width, itr->y, itr->z + a_ChunkZ * cChunkDef::Width
+				x + a_ChunkX * cChunkDef::Width, y, z + a_ChunkZ * cChunkDef::Width
 			);
-			a_Chunk->SetBlock(itr->x, itr->y, itr->z, E_BLOCK_AIR, 0);
-			RemoveFuelNeighbors(a_Chunk, itr->x, itr->y, itr->z);
-			itr = Data.erase(itr);
+			a_Chunk->SetBlock(x, y, z, E_BLOCK_AIR, 0);
+			RemoveFuelNeighbors(a_Chunk, x, y, z);
+			RemoveBlock(ChunkData, i);
 			continue;
 		}
 
-		if((itr->y > 0) && (!DoesBurnForever(a_Chunk->GetBlock(itr->x, itr->y - 1, itr->z))))
+		if((y > 0) && (!DoesBurnForever(a_Chunk->GetBlock(x, y - 1, z))))
 		{
 			a_Chunk->SetMeta(idx, BlockMeta + 1);
 		}
-		itr->Data = GetBurnStepTime(a_Chunk, itr->x, itr->y, itr->z);  // TODO: Add some randomness into this
-	}  // for itr - Data[]
+		int BurnStepTime = GetBurnStepTime(a_Chunk, x, y, z);  // TODO: Add some randomness into this
+		Data[i].Data = BurnStepTime;
+		++i;
+	}  // for i - Data[]
 }
 
 
@@ -206,17 +214,28 @@ void cFireSimulator::AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk *
 	
 	// Check for duplicates:
 	cFireSimulatorChunkData & ChunkData = a_Chunk->GetFireSimulatorData();
-	for (cCoordWithIntList::iterator itr = ChunkData.begin(), end = ChunkData.end(); itr != end; ++itr)
+	if (!ChunkData.m_IsQueued.Set(cChunkDef::MakeIndexNoCheck(RelX, a_BlockY, RelZ)))
 	{
-		if ((itr->x == RelX) && (itr->y == a_BlockY) && (itr->z == RelZ))
-		{
-			// Already present, skip adding
-			return;
-		}
-	}  // for itr - ChunkData[]
+		// Already present, skip adding
+		return;
+	}
 
 	FLOG("FS: Adding block {%d, %d, %d}", a_BlockX, a_BlockY, a_BlockZ);
-	ChunkData.push_back(cCoordWithInt(RelX, a_BlockY, RelZ, 100));
+	ChunkData.m_Blocks.push_back(cCoordWithInt(RelX, a_BlockY, RelZ, 100));
+}
+
+
+
+
+
+void cFireSimulator::RemoveBlock(cFireSimulatorChunkData & a_ChunkData, size_t a_Index)
+{
+	cCoordWithIntVector & Blocks = a_ChunkData.m_Blocks;
+	a_ChunkData.m_IsQueued.Clear(cChunkDef::MakeIndexNoCheck(Blocks[a_Index].x, Blocks[a_Index].y, Blocks[a_Index].z));
+	
+	// The order of the blocks doesn't matter, move the last one into the hole:
+	Blocks[a_Index] = Blocks.back();
+	Blocks.pop_back();
 }
 
 
@@ -272,7 +291,7 @@ int cFireSimulator::GetBurnStepTime(cChunk * a_Chunk, int a_RelX, int a_RelY, in
 void cFireSimulator::TrySpreadFire(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
 {
 	/*
-	if (m_World.GetTickRandomNumber(10000) > 100)
+	if (a_Chunk->GetTickRandomNumber(10000) > 100)
 	{
 		// Make the chance to spread 100x smaller
 		return;
@@ -288,7 +307,7 @@ void cFireSimulator::TrySpreadFire(cChunk * a_Chunk, int a_RelX, int a_RelY, int
 				// No need to check the coords for equality with the parent block,
 				// it cannot catch fire anyway (because it's not an air block)
 				
-				if (m_World.GetTickRandomNumber(MAX_CHANCE_FLAMMABILITY) > m_Flammability) 
+				if (a_Chunk->GetTickRandomNumber(MAX_CHANCE_FLAMMABILITY) > m_Flammability) 
 				{
 					continue;
 				}
@@ -330,7 +349,7 @@ void cFireSimulator::RemoveFuelNeighbors(cChunk * a_Chunk, int a_RelX, int a_Rel
 		{
 			continue;
 		}
-		bool ShouldReplaceFuel = (m_World.GetTickRandomNumber(MAX_CHANCE_REPLACE_FUEL) < m_ReplaceFuelChance);
+		bool ShouldReplaceFuel = (a_Chunk->GetTickRandomNumber(MAX_CHANCE_REPLACE_FUEL) < m_ReplaceFuelChance);
 		a_Chunk->UnboundedRelSetBlock(
 			a_RelX + gNeighborCoords[i].x, a_RelY + gNeighborCoords[i].y, a_RelZ + gNeighborCoords[i].z,
 			ShouldReplaceFuel ? E_BLOCK_FIRE : E_BLOCK_AIR, 0
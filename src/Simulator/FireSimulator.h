@@ -2,12 +2,19 @@
 #pragma once
 
 #include "Simulator.h"
+#include "ChunkBlockBitmap.h"
 #include "../BlockEntities/BlockEntity.h"
 
 
 
 
 
+class cFireSimulatorChunkData;
+
+
+
+
+
 /** The fire simulator takes care of the fire blocks.
 It periodically increases their meta ("steps") until they "burn out"; it also supports the forever burning netherrack.
 Each individual fire block gets stored in per-chunk data; that list is then used for fast retrieval.
@@ -26,6 +33,7 @@ public:
 	virtual void SimulateChunk(float a_Dt, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk) override;
 
 	virtual bool IsAllowedBlock(BLOCKTYPE a_BlockType) override;
+	virtual bool IsRegionLocal(void) const override { return true; }
 
 	static bool IsFuel   (BLOCKTYPE a_BlockType);
 	static bool DoesBurnForever(BLOCKTYPE a_BlockType);
@@ -46,6 +54,9 @@ protected:
 	
 	virtual void AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk) override;
 	
+	/// Removes the block at the specified index in the chunk's data; the last block is moved into its place
+	void RemoveBlock(cFireSimulatorChunkData & a_ChunkData, size_t a_Index);
+	
 	/// Returns the time [msec] after which the specified fire block is stepped again; based on surrounding fuels
 	int GetBurnStepTime(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ);
 	
@@ -67,8 +78,16 @@ protected:
 
 
 
-/// Stores individual fire blocks in the chunk; the int data is used as the time [msec] the fire takes to step to another stage (blockmeta++)
-typedef cCoordWithIntList cFireSimulatorChunkData;
+/// Stores individual fire blocks in the chunk
+class cFireSimulatorChunkData
+{
+public:
+	/// The fire blocks; the int data is used as the time [msec] the fire takes to step to another stage (blockmeta++)
+	cCoordWithIntVector m_Blocks;
+	
+	/// The blocks in m_Blocks, for checking duplicates
+	cChunkBlockBitmap m_IsQueued;
+} ;
 
 
 
@@ -12,6 +12,7 @@
 #include "../BlockArea.h"
 #include "../Blocks/BlockHandler.h"
 #include "../BlockInServerPluginInterface.h"
+#include "../ChunkTickRegion.h"
 
 
 
@@ -28,6 +29,40 @@
 
 
 
+/** Spreads into a block that gets washed away; dropping the block calls the block handler and plugin hooks, which need
+the tick thread, so the whole spread is deferred from the tick region */
+class cFloodyFluidSimulator::cDeferredSpread :
+	public cChunkTickRegion::cDeferredAction
+{
+public:
+	cDeferredSpread(cFloodyFluidSimulator & a_Simulator, cChunk & a_NearChunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_NewMeta) :
+		m_Simulator(a_Simulator),
+		m_NearChunk(a_NearChunk),
+		m_RelX(a_RelX),
+		m_RelY(a_RelY),
+		m_RelZ(a_RelZ),
+		m_NewMeta(a_NewMeta)
+	{
+	}
+	
+protected:
+	cFloodyFluidSimulator & m_Simulator;
+	cChunk & m_NearChunk;
+	int m_RelX, m_RelY, m_RelZ;
+	NIBBLETYPE m_NewMeta;
+	
+	// cChunkTickRegion::cDeferredAction override:
+	virtual void Run(void) override
+	{
+		// The block is checked anew, it may have changed since:
+		m_Simulator.SpreadToNeighbor(&m_NearChunk, m_RelX, m_RelY, m_RelZ, m_NewMeta);
+	}
+} ;
+
+
+
+
+
 cFloodyFluidSimulator::cFloodyFluidSimulator(
 	cWorld & a_World,
 	BLOCKTYPE a_Fluid,
@@ -46,7 +81,7 @@ cFloodyFluidSimulator::cFloodyFluidSimulator(
 
 
 
-void cFloodyFluidSimulator::SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
+cDelayedFluidSimulator::eSimulateResult cFloodyFluidSimulator::SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
 {
 	FLOG("Simulating block {%d, %d, %d}: block %d, meta %d", 
 		a_Chunk->GetPosX() * cChunkDef::Width + a_RelX, a_RelY, a_Chunk->GetPosZ() * cChunkDef::Width + a_RelZ,
@@ -59,7 +94,15 @@ void cFloodyFluidSimulator::SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_Re
 	{
 		// Can happen - if a block is scheduled for simulating and gets replaced in the meantime.
 		FLOG("  BadBlockType exit");
-		return;
+		return srNotFluid;
+	}
+
+	if (IsSettled(a_Chunk, a_RelX, a_RelY, a_RelZ, MyMeta))
+	{
+		// Nothing would change, put the block back to sleep:
+		FLOG("  Settled exit");
+		a_Chunk->FastSetBlock(a_RelX, a_RelY, a_RelZ, m_StationaryFluidBlock, MyMeta);
+		return srSettled;
 	}
 
 	if (MyMeta != 0)
@@ -70,7 +113,7 @@ void cFloodyFluidSimulator::SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_Re
 			// Has no tributary, has been decreased (in CheckTributaries()),
 			// no more processing needed (neighbors have been scheduled by the decrease)
 			FLOG("  CheckTributaries exit");
-			return;
+			return srSimulated;
 		}
 	}
 	
@@ -98,7 +141,7 @@ void cFloodyFluidSimulator::SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_Re
 		{
 			// We created a source, no more spreading is to be done now
 			// Also has been re-scheduled for ticking in the next wave, so no marking is needed
-			return;
+			return srSimulated;
 		}
 	}
 	
@@ -113,22 +156,79 @@ void cFloodyFluidSimulator::SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_Re
 	
 	// Mark as processed:
 	a_Chunk->FastSetBlock(a_RelX, a_RelY, a_RelZ, m_StationaryFluidBlock, MyMeta);
+	return srSimulated;
 }
 
 
 
 
 
-bool cFloodyFluidSimulator::CheckTributaries(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_MyMeta)
+bool cFloodyFluidSimulator::ShouldWakeUpStationary(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
+{
+	if (!IsSettled(a_Chunk, a_RelX, a_RelY, a_RelZ, a_Chunk->GetMeta(a_RelX, a_RelY, a_RelZ)))
+	{
+		return true;
+	}
+	cCSLock Lock(m_CSStatistics);
+	m_NumSkipped += 1;
+	return false;
+}
+
+
+
+
+
+bool cFloodyFluidSimulator::IsSettled(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_MyMeta)
+{
+	// The checks mirror SimulateBlock(), without any of its side effects:
+	if ((a_MyMeta != 0) && !IsFed(a_Chunk, a_RelX, a_RelY, a_RelZ, a_MyMeta))
+	{
+		// Would decrease
+		return false;
+	}
+	
+	if (a_RelY > 0)
+	{
+		BLOCKTYPE Below = a_Chunk->GetBlock(a_RelX, a_RelY - 1, a_RelZ);
+		if (IsPassableForFluid(Below) || IsBlockLava(Below) || IsBlockWater(Below))
+		{
+			// Spreads only down:
+			return !CanSpreadTo(a_Chunk, a_RelX, a_RelY - 1, a_RelZ, 8);
+		}
+		if ((m_NumNeighborsForSource > 0) && (a_MyMeta == m_Falloff))
+		{
+			// Might turn into a source, let the simulation decide
+			return false;
+		}
+	}
+	
+	NIBBLETYPE NewMeta = ((a_MyMeta == 0) || ((a_MyMeta & 0x08) != 0)) ? m_Falloff : (a_MyMeta + m_Falloff);
+	if (NewMeta >= 8)
+	{
+		// Doesn't spread any further
+		return true;
+	}
+	return (
+		!CanSpreadTo(a_Chunk, a_RelX - 1, a_RelY, a_RelZ,     NewMeta) &&
+		!CanSpreadTo(a_Chunk, a_RelX + 1, a_RelY, a_RelZ,     NewMeta) &&
+		!CanSpreadTo(a_Chunk, a_RelX,     a_RelY, a_RelZ - 1, NewMeta) &&
+		!CanSpreadTo(a_Chunk, a_RelX,     a_RelY, a_RelZ + 1, NewMeta)
+	);
+}
+
+
+
+
+
+bool cFloodyFluidSimulator::IsFed(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_MyMeta)
 {
 	// If we have a section above, check if there's fluid above this block that would feed it:
 	if (a_RelY < cChunkDef::Height - 1)
 	{
 		if (IsAnyFluidBlock(a_Chunk->GetBlock(a_RelX, a_RelY + 1, a_RelZ)))
 		{
-			// This block is fed from above, no more processing needed
 			FLOG("  Fed from above");
-			return false;
+			return true;
 		}
 	}
 
@@ -152,17 +252,30 @@ bool cFloodyFluidSimulator::CheckTributaries(cChunk * a_Chunk, int a_RelX, int a
 			}
 			if (IsAllowedBlock(BlockType) && IsHigherMeta(BlockMeta, a_MyMeta))
 			{
-				// This block is fed, no more processing needed
 				FLOG("  Fed from {%d, %d, %d}, type %d, meta %d",
 					a_Chunk->GetPosX() * cChunkDef::Width + a_RelX + Coords[i].x,
 					a_RelY,
 					a_Chunk->GetPosZ() * cChunkDef::Width + a_RelZ + Coords[i].z,
 					BlockType, BlockMeta
 				);
-				return false;
+				return true;
 			}
 		}  // for i - Coords[]
 	}  // if not fed from above
+	return false;
+}
+
+
+
+
+
+bool cFloodyFluidSimulator::CheckTributaries(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_MyMeta)
+{
+	if (IsFed(a_Chunk, a_RelX, a_RelY, a_RelZ, a_MyMeta))
+	{
+		// This block is fed, no more processing needed
+		return false;
+	}
 	
 	// Block is not fed, decrease by m_Falloff levels:
 	if (a_MyMeta >= 8)
@@ -274,6 +387,11 @@ void cFloodyFluidSimulator::SpreadToNeighbor(cChunk * a_NearChunk, int a_RelX, i
 		cBlockHandler * Handler = BlockHandler(BlockType);
 		if (Handler->DoesDropOnUnsuitable())
 		{
+			if (a_NearChunk->GetTickRegion() != NULL)
+			{
+				a_NearChunk->GetTickRegion()->Defer(new cDeferredSpread(*this, *a_NearChunk, a_RelX, a_RelY, a_RelZ, a_NewMeta));
+				return;
+			}
 			cChunkInterface ChunkInterface(m_World.GetChunkMap());
 			cBlockInServerPluginInterface PluginInterface(m_World);
 			Handler->DropBlock(
@@ -302,6 +420,35 @@ void cFloodyFluidSimulator::SpreadToNeighbor(cChunk * a_NearChunk, int a_RelX, i
 
 
 
+bool cFloodyFluidSimulator::CanSpreadTo(cChunk * a_NearChunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_NewMeta)
+{
+	BLOCKTYPE BlockType;
+	NIBBLETYPE BlockMeta;
+	if (!a_NearChunk->UnboundedRelGetBlock(a_RelX, a_RelY, a_RelZ, BlockType, BlockMeta))
+	{
+		// Chunk not available
+		return false;
+	}
+	
+	if (IsAllowedBlock(BlockType))
+	{
+		// Only if the level there is lower:
+		return !((BlockMeta == a_NewMeta) || IsHigherMeta(BlockMeta, a_NewMeta));
+	}
+	
+	if (IsBlockWater(BlockType) || IsBlockLava(BlockType))
+	{
+		// The other fluid, they interact
+		return true;
+	}
+	
+	return IsPassableForFluid(BlockType);
+}
+
+
+
+
+
 bool cFloodyFluidSimulator::CheckNeighborsForSource(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
 {
 	FLOG("  Checking neighbors for source creation");
@@ -31,17 +31,36 @@ class cFloodyFluidSimulator :
 public:
 	cFloodyFluidSimulator(cWorld & a_World, BLOCKTYPE a_Fluid, BLOCKTYPE a_StationaryFluid, NIBBLETYPE a_Falloff, int a_TickDelay, int a_NumNeighborsForSource);
 	
+	// cSimulator overrides:
+	virtual bool IsRegionLocal(void) const override { return true; }
+	
+	// cFluidSimulator overrides:
+	virtual bool ShouldWakeUpStationary(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ) override;
+	
 protected:
+	class cDeferredSpread;
+	
 	NIBBLETYPE m_Falloff;
 	int        m_NumNeighborsForSource;
 	
 	// cDelayedFluidSimulator overrides:
-	virtual void SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ) override;
+	virtual eSimulateResult SimulateBlock(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ) override;
+	
+	/** Returns true if simulating the fluid block wouldn't change anything - it is fed, cannot fall
+	and all its neighbors already have the level it would spread to them (or cannot be flooded).
+	Lakes and oceans consist of such blocks, they need no simulating unless a neighbor changes. */
+	bool IsSettled(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_MyMeta);
+	
+	/// Returns true if the block is fed from above or from a higher neighbor
+	bool IsFed(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_MyMeta);
 	
 	/// Checks tributaries, if not fed, decreases the block's level and returns true
 	bool CheckTributaries(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_MyMeta);
+	
+	/// Returns true if SpreadToNeighbor() with the same params would change the block there
+	bool CanSpreadTo(cChunk * a_NearChunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_NewMeta);
 
-	/// Spreads into the specified block, if the blocktype there allows. a_Area is for checking.
+	/// Spreads into the specified block, if the blocktype there allows. Washing a block away is deferred to the tick thread when ticked in a tick region.
 	void SpreadToNeighbor(cChunk * a_NearChunk, int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_NewMeta);
 	
 	/// Checks if there are enough neighbors to create a source at the coords specified; turns into source and returns true if so
@@ -10,7 +10,11 @@
 cFluidSimulator::cFluidSimulator(cWorld & a_World, BLOCKTYPE a_Fluid, BLOCKTYPE a_StationaryFluid) :
 	super(a_World),
 	m_FluidBlock(a_Fluid),
-	m_StationaryFluidBlock(a_StationaryFluid)
+	m_StationaryFluidBlock(a_StationaryFluid),
+	m_NumSimulated(0),
+	m_NumSkipped(0),
+	m_LastNumSimulated(0),
+	m_LastNumSkipped(0)
 {
 }
 
@@ -18,6 +22,18 @@ cFluidSimulator::cFluidSimulator(cWorld & a_World, BLOCKTYPE a_Fluid, BLOCKTYPE
 
 
 
+void cFluidSimulator::StartTickStatistics(void)
+{
+	m_LastNumSimulated = m_NumSimulated;
+	m_LastNumSkipped = m_NumSkipped;
+	m_NumSimulated = 0;
+	m_NumSkipped = 0;
+}
+
+
+
+
+
 bool cFluidSimulator::IsAllowedBlock(BLOCKTYPE a_BlockType)
 {
 	return ((a_BlockType == m_FluidBlock) || (a_BlockType == m_StationaryFluidBlock));
@@ -64,9 +64,35 @@ public:
 	/// Returns true if a_Meta1 is a higher fluid than a_Meta2. Takes source blocks into account.
 	bool IsHigherMeta(NIBBLETYPE a_Meta1, NIBBLETYPE a_Meta2);
 	
+	/** Called when a neighbor of a stationary fluid block changes. Returns true if the block should be turned
+	into the flowing one and simulated, false if it cannot change and may stay asleep. The default wakes it up always. */
+	virtual bool ShouldWakeUpStationary(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
+	{
+		UNUSED(a_Chunk);
+		UNUSED(a_RelX);
+		UNUSED(a_RelY);
+		UNUSED(a_RelZ);
+		return true;
+	}
+	
+	/// Returns the number of blocks simulated in the last tick (statistics only)
+	int GetNumSimulatedLastTick(void) const { return m_LastNumSimulated; }
+	
+	/// Returns the number of blocks that were left alone in the last tick because they were settled (statistics only)
+	int GetNumSkippedLastTick(void) const { return m_LastNumSkipped; }
+	
 protected:
 	BLOCKTYPE m_FluidBlock;            // The fluid block type that needs simulating
 	BLOCKTYPE m_StationaryFluidBlock;  // The fluid block type that indicates no simulation is needed
+	
+	// The descendants update these under m_CSStatistics, the tick regions may be simulating in several threads:
+	int m_NumSimulated;      // Statistics only: the number of blocks simulated in the current tick
+	int m_NumSkipped;        // Statistics only: the number of settled blocks left alone in the current tick
+	int m_LastNumSimulated;  // Statistics only: m_NumSimulated of the last tick
+	int m_LastNumSkipped;    // Statistics only: m_NumSkipped of the last tick
+	
+	/// Moves the current tick's statistics into the last tick's ones; called by the descendants at the start of each tick
+	void StartTickStatistics(void);
 } ;
 
 
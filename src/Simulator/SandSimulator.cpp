@@ -7,6 +7,7 @@
 #include "../Defines.h"
 #include "../Entities/FallingBlock.h"
 #include "../Chunk.h"
+#include "../ChunkTickRegion.h"
 
 
 
@@ -23,49 +24,80 @@ cSandSimulator::cSandSimulator(cWorld & a_World, cIniFile & a_IniFile) :
 
 
 
+/** Starts the fall of a block in the tick thread; deferred from the tick region, because the fall spawns an entity
+(calling plugin hooks) or finishes the fall through the world */
+class cSandSimulator::cDeferredFall :
+	public cChunkTickRegion::cDeferredAction
+{
+public:
+	cDeferredFall(cSandSimulator & a_Simulator, cChunk & a_Chunk, int a_RelX, int a_RelY, int a_RelZ) :
+		m_Simulator(a_Simulator),
+		m_Chunk(a_Chunk),
+		m_RelX(a_RelX),
+		m_RelY(a_RelY),
+		m_RelZ(a_RelZ)
+	{
+	}
+	
+protected:
+	cSandSimulator & m_Simulator;
+	cChunk & m_Chunk;
+	int m_RelX, m_RelY, m_RelZ;
+	
+	// cChunkTickRegion::cDeferredAction override:
+	virtual void Run(void) override
+	{
+		// Other deferred actions may have changed the blocks since, check again:
+		if (
+			m_Simulator.IsAllowedBlock(m_Chunk.GetBlock(m_RelX, m_RelY, m_RelZ)) &&
+			CanStartFallingThrough(m_Chunk.GetBlock(m_RelX, m_RelY - 1, m_RelZ))
+		)
+		{
+			m_Simulator.StartFalling(&m_Chunk, m_RelX, m_RelY, m_RelZ);
+		}
+	}
+} ;
+
+
+
+
+
 void cSandSimulator::SimulateChunk(float a_Dt, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk)
 {
 	cSandSimulatorChunkData & ChunkData = a_Chunk->GetSandSimulatorData();
-	if (ChunkData.empty())
+	if (ChunkData.m_Blocks.empty())
 	{
 		return;
 	}
 
-	int BaseX = a_Chunk->GetPosX() * cChunkDef::Width;
-	int BaseZ = a_Chunk->GetPosZ() * cChunkDef::Width;
-	for (cSandSimulatorChunkData::const_iterator itr = ChunkData.begin(), end = ChunkData.end(); itr != end; ++itr)
+	// The blocks queued while simulating are simulated in this same pass, so no iterators or references are kept:
+	for (size_t i = 0; i < ChunkData.m_Blocks.size(); i++)
 	{
-		BLOCKTYPE BlockType = a_Chunk->GetBlock(itr->x, itr->y, itr->z);
-		if (!IsAllowedBlock(BlockType) || (itr->y <= 0))
+		Vector3i Rel = cChunkDef::IndexToCoordinate(ChunkData.m_Blocks[i]);
+		BLOCKTYPE BlockType = a_Chunk->GetBlock(Rel.x, Rel.y, Rel.z);
+		if (!IsAllowedBlock(BlockType) || (Rel.y <= 0))
 		{
 			continue;
 		}
 
-		BLOCKTYPE BlockBelow = (itr->y > 0) ? a_Chunk->GetBlock(itr->x, itr->y - 1, itr->z) : E_BLOCK_AIR;
+		BLOCKTYPE BlockBelow = (Rel.y > 0) ? a_Chunk->GetBlock(Rel.x, Rel.y - 1, Rel.z) : E_BLOCK_AIR;
 		if (CanStartFallingThrough(BlockBelow))
 		{
-			if (m_IsInstantFall)
+			if (a_Chunk->GetTickRegion() != NULL)
 			{
-				DoInstantFall(a_Chunk, itr->x, itr->y, itr->z);
+				a_Chunk->GetTickRegion()->Defer(new cDeferredFall(*this, *a_Chunk, Rel.x, Rel.y, Rel.z));
 				continue;
 			}
-			Vector3i Pos;
-			Pos.x = itr->x + BaseX;
-			Pos.y = itr->y;
-			Pos.z = itr->z + BaseZ;
-			/*
-			LOGD(
-				"Creating a falling block at {%d, %d, %d} of type %s, block below: %s",
-				Pos.x, Pos.y, Pos.z, ItemTypeToString(BlockType).c_str(), ItemTypeToString(BlockBelow).c_str()
-			);
-			*/
-			cFallingBlock * FallingBlock = new cFallingBlock(Pos, BlockType, a_Chunk->GetMeta(itr->x, itr->y, itr->z));
-			FallingBlock->Initialize(&m_World);
-			a_Chunk->SetBlock(itr->x, itr->y, itr->z, E_BLOCK_AIR, 0);
+			StartFalling(a_Chunk, Rel.x, Rel.y, Rel.z);
 		}
 	}
-	m_TotalBlocks -= ChunkData.size();
-	ChunkData.clear();
+	{
+		// The tick regions may be simulating other chunks in other threads:
+		cCSLock Lock(m_CSStatistics);
+		m_TotalBlocks -= (int)ChunkData.m_Blocks.size();
+	}
+	ChunkData.m_Blocks.clear();
+	ChunkData.m_IsQueued.ClearAll();
 }
 
 
@@ -106,16 +138,15 @@ void cSandSimulator::AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk *
 
 	// Check for duplicates:
 	cSandSimulatorChunkData & ChunkData = a_Chunk->GetSandSimulatorData();
-	for (cSandSimulatorChunkData::iterator itr = ChunkData.begin(); itr != ChunkData.end(); ++itr)
+	int Index = cChunkDef::MakeIndexNoCheck(RelX, a_BlockY, RelZ);
+	if (!ChunkData.m_IsQueued.Set(Index))
 	{
-		if ((itr->x == RelX) && (itr->y == a_BlockY) && (itr->z == RelZ))
-		{
-			return;
-		}
+		return;
 	}
 
+	ChunkData.m_Blocks.push_back(Index);
+	cCSLock Lock(m_CSStatistics);
 	m_TotalBlocks += 1;
-	ChunkData.push_back(cCoordWithInt(RelX, a_BlockY, RelZ));
 }
 
 
@@ -265,6 +296,36 @@ void cSandSimulator::FinishFalling(
 
 
 
+void cSandSimulator::StartFalling(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
+{
+	if (m_IsInstantFall)
+	{
+		DoInstantFall(a_Chunk, a_RelX, a_RelY, a_RelZ);
+		return;
+	}
+	
+	BLOCKTYPE  BlockType;
+	NIBBLETYPE BlockMeta;
+	a_Chunk->GetBlockTypeMeta(a_RelX, a_RelY, a_RelZ, BlockType, BlockMeta);
+	Vector3i Pos;
+	Pos.x = a_RelX + a_Chunk->GetPosX() * cChunkDef::Width;
+	Pos.y = a_RelY;
+	Pos.z = a_RelZ + a_Chunk->GetPosZ() * cChunkDef::Width;
+	/*
+	LOGD(
+		"Creating a falling block at {%d, %d, %d} of type %s",
+		Pos.x, Pos.y, Pos.z, ItemTypeToString(BlockType).c_str()
+	);
+	*/
+	cFallingBlock * FallingBlock = new cFallingBlock(Pos, BlockType, BlockMeta);
+	FallingBlock->Initialize(&m_World);
+	a_Chunk->SetBlock(a_RelX, a_RelY, a_RelZ, E_BLOCK_AIR, 0);
+}
+
+
+
+
+
 void cSandSimulator::DoInstantFall(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ)
 {
 	// Remove the original block:
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Simulator.h"
+#include "ChunkBlockBitmap.h"
 
 
 
@@ -18,6 +19,7 @@ public:
 	virtual void Simulate(float a_Dt) override { UNUSED(a_Dt);}  // not used
 	virtual void SimulateChunk(float a_Dt, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk) override;
 	virtual bool IsAllowedBlock(BLOCKTYPE a_BlockType) override;
+	virtual bool IsRegionLocal(void) const override { return true; }
 	
 	/// Returns true if a falling-able block can start falling through the specified block type
 	static bool CanStartFallingThrough(BLOCKTYPE a_BlockType);
@@ -42,12 +44,18 @@ public:
 	);
 
 protected:
+	class cDeferredFall;
+	
 	bool m_IsInstantFall;  // If set to true, blocks don't fall using cFallingBlock entity, but instantly instead
 	
-	int  m_TotalBlocks;    // Total number of blocks currently in the queue for simulating
+	int  m_TotalBlocks;    // Total number of blocks currently in the queue for simulating; updated under m_CSStatistics
 	
 	virtual void AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk) override;
 	
+	/** Makes the block start falling, either instantly or as a cFallingBlock entity. Both go through the world,
+	so when ticked in a tick region, the fall is deferred to the tick thread. */
+	void StartFalling(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ);
+	
 	/// Performs the instant fall of the block - removes it from top, Finishes it at the bottom
 	void DoInstantFall(cChunk * a_Chunk, int a_RelX, int a_RelY, int a_RelZ);
 };
@@ -55,8 +63,16 @@ protected:
 
 
 
-/// Per-chunk data for the simulator, specified individual chunks to simulate; Data is not used
-typedef cCoordWithIntList cSandSimulatorChunkData;
+/// Per-chunk data for the simulator, the individual blocks to simulate
+class cSandSimulatorChunkData
+{
+public:
+	/// The blocks as block indices (cChunkDef::MakeIndex()), in the order they were queued
+	std::vector<int> m_Blocks;
+	
+	/// The blocks in m_Blocks, for checking duplicates
+	cChunkBlockBitmap m_IsQueued;
+} ;
 
 
 
@@ -38,6 +38,11 @@ public:
 	virtual void WakeUp(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk);
 
 	virtual bool IsAllowedBlock(BLOCKTYPE a_BlockType) = 0;
+	
+	/** Returns true if SimulateChunk() may run in a tick region's worker thread in the parallel tick mode: it touches only
+	the chunk and its direct neighbors, takes its random numbers from cChunk::GetTickRandomNumber() and defers anything else
+	to cChunk::GetTickRegion(). The other simulators' SimulateChunk() runs in the tick thread. */
+	virtual bool IsRegionLocal(void) const { return false; }
 
 protected:
 	friend class cChunk;  // Calls AddBlock() in its WakeUpSimulators() function, to speed things up
@@ -46,6 +51,9 @@ protected:
 	virtual void AddBlock(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk) = 0;
 
 	cWorld & m_World;
+	
+	/** Protects the descendants' statistics counters; in the parallel tick mode the region-local simulators update them from several threads */
+	cCriticalSection m_CSStatistics;
 } ;
 
 
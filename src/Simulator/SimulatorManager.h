@@ -35,6 +35,10 @@ public:
 	
 	void SimulateChunk(float a_DT, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk);
 	
+	/** Simulates the chunk only with the simulators whose IsRegionLocal() equals a_IsRegionLocal.
+	Used by the parallel tick mode, which runs the region-local simulators in the tick regions and the rest in the tick thread. */
+	void SimulateChunk(float a_DT, int a_ChunkX, int a_ChunkZ, cChunk * a_Chunk, bool a_IsRegionLocal);
+	
 	void WakeUp(int a_BlockX, int a_BlockY, int a_BlockZ, cChunk * a_Chunk);
 
 	void RegisterSimulator(cSimulator * a_Simulator, int a_Rate);  // Takes ownership of the simulator object!
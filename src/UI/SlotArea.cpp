@@ -157,7 +157,7 @@ void cSlotArea::Clicked(cPlayer & a_Player, int a_SlotNum, eClickAction a_ClickA
 		default:
 		{
 			LOGWARNING("SlotArea: Unhandled click action: %d (%s)", a_ClickAction, ClickActionToString(a_ClickAction));
-			m_ParentWindow.BroadcastWholeWindow();
+			m_ParentWindow.BroadcastChangedSlots();
 			return;
 		}
 	}  // switch (a_ClickAction
@@ -187,7 +187,7 @@ void cSlotArea::ShiftClicked(cPlayer & a_Player, int a_SlotNum, const cItem & a_
 	SetSlot(a_SlotNum, a_Player, Slot);
 	
 	// Some clients try to guess our actions and not always right (armor slots in 1.2.5), so we fix them:
-	m_ParentWindow.BroadcastWholeWindow();
+	m_ParentWindow.BroadcastChangedSlots();
 }
 
 
@@ -217,7 +217,7 @@ void cSlotArea::DblClicked(cPlayer & a_Player, int a_SlotNum)
 		m_ParentWindow.CollectItemsToHand(Dragging, *this, a_Player, true);
 	}
 	
-	m_ParentWindow.BroadcastWholeWindow();  // We need to broadcast, in case the window was a chest opened by multiple players
+	m_ParentWindow.BroadcastChangedSlots();  // We need to broadcast, in case the window was a chest opened by multiple players
 }
 
 
@@ -479,7 +479,7 @@ void cSlotAreaCrafting::ClickedResult(cPlayer & a_Player)
 	UpdateRecipe(a_Player);
 	
 	// We're done. Send all changes to the client and bail out:
-	m_ParentWindow.BroadcastWholeWindow();
+	m_ParentWindow.BroadcastChangedSlots();
 }
 
 
@@ -654,10 +654,10 @@ void cSlotAreaFurnace::SetSlot(int a_SlotNum, cPlayer & a_Player, const cItem &
 
 void cSlotAreaFurnace::OnSlotChanged(cItemGrid * a_ItemGrid, int a_SlotNum)
 {
-	// Something has changed in the window, broadcast the entire window to all clients
+	// Something has changed in the window, broadcast the changes to all clients
 	ASSERT(a_ItemGrid == &(m_Furnace->GetContents()));
 	
-	m_ParentWindow.BroadcastWholeWindow();
+	m_ParentWindow.BroadcastChangedSlots();
 }
 
 
@@ -176,6 +176,8 @@ void cWindow::Clicked(
 		LOGWARNING("%s: Wrong window ID (exp %d, got %d) received from \"%s\"; ignoring click.", __FUNCTION__, m_WindowID, a_WindowID, a_Player.GetName().c_str());
 		return;
 	}
+	
+	InvalidateClickedSlots(a_Player, a_SlotNum, a_ClickAction);
 
 	switch (a_ClickAction)
 	{
@@ -267,6 +269,9 @@ void cWindow::OpenedByPlayer(cPlayer & a_Player)
 		// Then add player
 		m_OpenedBy.push_back(&a_Player);
 		
+		// The client will be sent the whole window first:
+		m_SentSlots.erase(&a_Player);
+		
 		for (cSlotAreas::iterator itr = m_SlotAreas.begin(), end = m_SlotAreas.end(); itr != end; ++itr)
 		{
 			(*itr)->OnPlayerAdded(a_Player);
@@ -304,6 +309,7 @@ bool cWindow::ClosedByPlayer(cPlayer & a_Player, bool a_CanRefuse)
 		}  // for itr - m_SlotAreas[]
 
 		m_OpenedBy.remove(&a_Player);
+		m_SentSlots.erase(&a_Player);
 		
 		if ((m_WindowType != wtInventory) && m_OpenedBy.empty())
 		{
@@ -479,9 +485,12 @@ void cWindow::SendSlot(cPlayer & a_Player, cSlotArea * a_SlotArea, int a_Relativ
 		return;
 	}
 	
-	a_Player.GetClientHandle()->SendInventorySlot(
-		m_WindowID, a_RelativeSlotNum + SlotBase, *(a_SlotArea->GetSlot(a_RelativeSlotNum, a_Player))
-	);
+	const cItem & Item = *(a_SlotArea->GetSlot(a_RelativeSlotNum, a_Player));
+	{
+		cCSLock Lock(m_CS);
+		UpdateSentSlot(a_Player, a_RelativeSlotNum + SlotBase, Item);
+	}
+	a_Player.GetClientHandle()->SendInventorySlot(m_WindowID, a_RelativeSlotNum + SlotBase, Item);
 }
 
 
@@ -707,7 +716,9 @@ void cWindow::BroadcastSlot(cSlotArea * a_Area, int a_LocalSlotNum)
 	cCSLock Lock(m_CS);
 	for (cPlayerList::iterator itr = m_OpenedBy.begin(); itr != m_OpenedBy.end(); ++itr)
 	{
-		(*itr)->GetClientHandle()->SendInventorySlot(m_WindowID, SlotNum, *a_Area->GetSlot(a_LocalSlotNum, **itr));
+		const cItem & Item = *a_Area->GetSlot(a_LocalSlotNum, **itr);
+		UpdateSentSlot(**itr, SlotNum, Item);
+		(*itr)->GetClientHandle()->SendInventorySlot(m_WindowID, SlotNum, Item);
 	}  // for itr - m_OpenedBy[]
 }
 
@@ -717,6 +728,16 @@ void cWindow::BroadcastSlot(cSlotArea * a_Area, int a_LocalSlotNum)
 
 void cWindow::SendWholeWindow(cClientHandle & a_Client)
 {
+	cPlayer * Player = a_Client.GetPlayer();
+	if (Player != NULL)
+	{
+		// Remember what the client has been sent:
+		cCSLock Lock(m_CS);
+		sSentSlots & Sent = m_SentSlots[Player];
+		GetSlots(*Player, Sent.m_Slots);
+		Sent.m_StaleSlots.clear();
+		cRoot::Get()->GetWindowSyncStats().AddWholeWindow(Sent.m_Slots);
+	}
 	a_Client.SendWholeInventory(*this);
 }
 
@@ -737,6 +758,142 @@ void cWindow::BroadcastWholeWindow(void)
 
 
 
+void cWindow::SendChangedSlots(cPlayer & a_Player)
+{
+	cCSLock Lock(m_CS);
+	cSentSlotsMap::iterator itr = m_SentSlots.find(&a_Player);
+	if (itr == m_SentSlots.end())
+	{
+		// The client hasn't been sent the window yet, or it may have changed any slot on its own:
+		SendWholeWindow(*a_Player.GetClientHandle());
+		return;
+	}
+	
+	cItems Slots;
+	GetSlots(a_Player, Slots);
+	cItems & Sent = itr->second.m_Slots;
+	if (Sent.size() != Slots.size())
+	{
+		SendWholeWindow(*a_Player.GetClientHandle());
+		return;
+	}
+	
+	// Find the changed slots:
+	cSlotNums Changed;
+	cSlotNums & Stale = itr->second.m_StaleSlots;
+	for (size_t i = 0; i < Slots.size(); i++)
+	{
+		if (!AreSlotsSame(Slots[i], Sent[i]) || (std::find(Stale.begin(), Stale.end(), (int)i) != Stale.end()))
+		{
+			Changed.push_back((int)i);
+		}
+	}
+	if (Changed.size() * 2 > Slots.size())
+	{
+		// Most of the slots changed, the whole window is cheaper:
+		SendWholeWindow(*a_Player.GetClientHandle());
+		return;
+	}
+	
+	// Send the changed slots only:
+	int NumBytes = 0;
+	cClientHandle * Client = a_Player.GetClientHandle();
+	for (cSlotNums::const_iterator itrS = Changed.begin(), end = Changed.end(); itrS != end; ++itrS)
+	{
+		Client->SendInventorySlot(m_WindowID, (short)*itrS, Slots[*itrS]);
+		Sent[*itrS] = Slots[*itrS];
+		NumBytes += cWindowSyncStats::GetSlotPacketSize(Slots[*itrS]);
+	}
+	Stale.clear();
+	cRoot::Get()->GetWindowSyncStats().AddChangedSlots(Slots, (int)Changed.size(), NumBytes);
+}
+
+
+
+
+
+void cWindow::BroadcastChangedSlots(void)
+{
+	cCSLock Lock(m_CS);
+	for (cPlayerList::iterator itr = m_OpenedBy.begin(); itr != m_OpenedBy.end(); ++itr)
+	{
+		SendChangedSlots(**itr);
+	}  // for itr - m_OpenedBy[]
+}
+
+
+
+
+
+void cWindow::InvalidateClickedSlots(cPlayer & a_Player, int a_SlotNum, eClickAction a_ClickAction)
+{
+	cCSLock Lock(m_CS);
+	switch (a_ClickAction)
+	{
+		case caLeftClickOutside:
+		case caRightClickOutside:
+		case caLeftClickOutsideHoldNothing:
+		case caRightClickOutsideHoldNothing:
+		case caLeftPaintBegin:
+		case caRightPaintBegin:
+		case caLeftPaintProgress:
+		case caRightPaintProgress:
+		{
+			// The client doesn't change any slot on its own
+			return;
+		}
+		case caLeftClick:
+		case caRightClick:
+		{
+			cSentSlotsMap::iterator itr = m_SentSlots.find(&a_Player);
+			if ((itr != m_SentSlots.end()) && (a_SlotNum >= 0) && (a_SlotNum < (int)itr->second.m_Slots.size()))
+			{
+				itr->second.m_StaleSlots.push_back(a_SlotNum);
+				return;
+			}
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+	m_SentSlots.erase(&a_Player);
+}
+
+
+
+
+
+void cWindow::UpdateSentSlot(cPlayer & a_Player, int a_SlotNum, const cItem & a_Item)
+{
+	cSentSlotsMap::iterator itr = m_SentSlots.find(&a_Player);
+	if ((itr == m_SentSlots.end()) || (a_SlotNum < 0) || (a_SlotNum >= (int)itr->second.m_Slots.size()))
+	{
+		return;
+	}
+	itr->second.m_Slots[a_SlotNum] = a_Item;
+	cSlotNums & Stale = itr->second.m_StaleSlots;
+	Stale.erase(std::remove(Stale.begin(), Stale.end(), a_SlotNum), Stale.end());
+}
+
+
+
+
+
+bool cWindow::AreSlotsSame(const cItem & a_Slot1, const cItem & a_Slot2)
+{
+	if (a_Slot1.IsEmpty() || a_Slot2.IsEmpty())
+	{
+		return (a_Slot1.IsEmpty() && a_Slot2.IsEmpty());
+	}
+	return (a_Slot1.IsEqual(a_Slot2) && (a_Slot1.m_ItemCount == a_Slot2.m_ItemCount));
+}
+
+
+
+
+
 void cWindow::BroadcastProgress(int a_Progressbar, int a_Value)
 {
 	cCSLock Lock(m_CS);
@@ -127,6 +127,13 @@ public:
 	/// Sends the contents of the whole window to all clients of this window.
 	void BroadcastWholeWindow(void);
 	
+	/** Sends the slots that changed since they were last sent to the player's client, as individual slots.
+	If most of the slots changed, or the client hasn't been sent the window yet, sends the whole window instead. */
+	void SendChangedSlots(cPlayer & a_Player);
+	
+	/// Sends the changed slots to all clients of this window (see SendChangedSlots())
+	void BroadcastChangedSlots(void);
+	
 	/// Sends the progressbar to all clients of this window (same as SetProperty)
 	void BroadcastProgress(int a_Progressbar, int a_Value);
 
@@ -173,8 +180,17 @@ protected:
 	int     m_WindowType;
 	AString m_WindowTitle;
 
+	/** The slots as they were last sent to a client, for sending only the changed ones */
+	struct sSentSlots
+	{
+		cItems    m_Slots;
+		cSlotNums m_StaleSlots;  ///< Slots that the client may show differently (it guessed the outcome of a click), always sent
+	} ;
+	typedef std::map<const cPlayer *, sSentSlots> cSentSlotsMap;
+	
 	cCriticalSection m_CS;
 	cPlayerList      m_OpenedBy;
+	cSentSlotsMap    m_SentSlots;  ///< The slots last sent to each player's client; protected by m_CS
 	
 	bool m_IsDestroyed;
 	bool m_ShouldDistributeToHotbarFirst;  ///< If set (default), shift+click tries to distribute to hotbar first, then other areas. False for doublechests
@@ -199,6 +215,16 @@ protected:
 	*/
 	const cSlotArea * GetSlotArea(int a_GlobalSlotNum, int & a_LocalSlotNum) const;
 	
+	/** Marks the slots that the player's client may have changed on its own, guessing the outcome of the click.
+	A plain click changes only the clicked slot, the other clicks can change any slot, so the whole window is sent next time. */
+	void InvalidateClickedSlots(cPlayer & a_Player, int a_SlotNum, eClickAction a_ClickAction);
+	
+	/// Stores the slot as sent to the player's client, if the client has been sent the window. Expects m_CS to be locked.
+	void UpdateSentSlot(cPlayer & a_Player, int a_SlotNum, const cItem & a_Item);
+	
+	/// Returns true if the two slots look the same to the client
+	static bool AreSlotsSame(const cItem & a_Slot1, const cItem & a_Slot2);
+	
 	/// Prepares the internal structures for inventory painting from the specified player
 	void OnPaintBegin(cPlayer & a_Player);
 	
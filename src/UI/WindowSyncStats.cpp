@@ -0,0 +1,120 @@
+
+// WindowSyncStats.cpp
+
+// Implements the cWindowSyncStats class that counts the window slots sent to the clients
+
+#include "Globals.h"
+#include "WindowSyncStats.h"
+#include "../CommandOutput.h"
+
+
+
+
+
+/** The approximate sizes of the packets and items, in bytes, for estimating the savings */
+#define SLOT_PACKET_SIZE    5
+#define WINDOW_PACKET_SIZE  5
+#define EMPTY_ITEM_SIZE     2
+#define ITEM_SIZE           7
+#define ENCHANTED_ITEM_SIZE 40
+
+
+
+
+
+cWindowSyncStats::cWindowSyncStats(void) :
+	m_NumWholeWindows(0),
+	m_NumWholeWindowSlots(0),
+	m_NumSlotPackets(0),
+	m_NumSlotsSkipped(0),
+	m_NumBytesSent(0),
+	m_NumBytesSaved(0)
+{
+}
+
+
+
+
+
+void cWindowSyncStats::AddWholeWindow(const cItems & a_Slots)
+{
+	int NumBytes = GetWindowPacketSize(a_Slots);
+	cCSLock Lock(m_CS);
+	m_NumWholeWindows += 1;
+	m_NumWholeWindowSlots += a_Slots.size();
+	m_NumBytesSent += NumBytes;
+}
+
+
+
+
+
+void cWindowSyncStats::AddChangedSlots(const cItems & a_Slots, int a_NumSent, int a_NumBytesSent)
+{
+	int NumBytesWhole = GetWindowPacketSize(a_Slots);
+	cCSLock Lock(m_CS);
+	m_NumSlotPackets += a_NumSent;
+	m_NumSlotsSkipped += (Int64)a_Slots.size() - a_NumSent;
+	m_NumBytesSent += a_NumBytesSent;
+	m_NumBytesSaved += NumBytesWhole - a_NumBytesSent;
+}
+
+
+
+
+
+void cWindowSyncStats::LogStats(cCommandOutputCallback & a_Output)
+{
+	cCSLock Lock(m_CS);
+	a_Output.Out("Window slots: %lld whole windows sent (%lld slots), %lld set-slot packets sent",
+		m_NumWholeWindows, m_NumWholeWindowSlots, m_NumSlotPackets
+	);
+	a_Output.Out("  %lld unchanged slots not sent, about %lld KiB sent, %lld KiB saved compared to sending the whole windows",
+		m_NumSlotsSkipped, m_NumBytesSent / 1024, m_NumBytesSaved / 1024
+	);
+}
+
+
+
+
+
+int cWindowSyncStats::GetSlotPacketSize(const cItem & a_Item)
+{
+	return SLOT_PACKET_SIZE + GetItemSize(a_Item);
+}
+
+
+
+
+
+int cWindowSyncStats::GetWindowPacketSize(const cItems & a_Slots)
+{
+	int Size = WINDOW_PACKET_SIZE;
+	for (cItems::const_iterator itr = a_Slots.begin(), end = a_Slots.end(); itr != end; ++itr)
+	{
+		Size += GetItemSize(*itr);
+	}
+	return Size;
+}
+
+
+
+
+
+int cWindowSyncStats::GetItemSize(const cItem & a_Item)
+{
+	if (a_Item.IsEmpty())
+	{
+		return EMPTY_ITEM_SIZE;
+	}
+	if (!a_Item.m_Enchantments.IsEmpty() || !a_Item.m_CustomName.empty() || !a_Item.m_Lore.empty())
+	{
+		// The NBT part, only roughly:
+		return ENCHANTED_ITEM_SIZE + (int)(a_Item.m_CustomName.size() + a_Item.m_Lore.size());
+	}
+	return ITEM_SIZE;
+}
+
+
+
+
@@ -0,0 +1,68 @@
+
+// WindowSyncStats.h
+
+// Declares the cWindowSyncStats class that counts the window slots sent to the clients
+
+/*
+When a window's contents change, each client viewing it gets only the slots that changed since it was last sent
+the window, as set-slot packets; only if most of the slots changed, the whole window is sent again instead.
+This class counts what has been sent and estimates the bytes it saved, compared to sending the whole window.
+*/
+
+
+
+
+
+#pragma once
+
+#include "../Item.h"
+
+
+
+
+
+// fwd:
+class cCommandOutputCallback;
+
+
+
+
+
+class cWindowSyncStats
+{
+public:
+	cWindowSyncStats(void);
+
+	/** Called when the whole window, a_Slots, has been sent to a client */
+	void AddWholeWindow(const cItems & a_Slots);
+
+	/** Called when a_NumSent changed slots, out of a_Slots, have been sent to a client as set-slot packets;
+	a_NumBytesSent is the estimated size of those packets */
+	void AddChangedSlots(const cItems & a_Slots, int a_NumSent, int a_NumBytesSent);
+
+	/** Outputs the statistics */
+	void LogStats(cCommandOutputCallback & a_Output);
+
+	/** Returns the estimated size of the set-slot packet carrying the item, in bytes */
+	static int GetSlotPacketSize(const cItem & a_Item);
+
+protected:
+	cCriticalSection m_CS;  ///< The windows are updated from multiple threads
+
+	Int64 m_NumWholeWindows;      ///< Whole windows sent, counted per client
+	Int64 m_NumWholeWindowSlots;  ///< Slots sent in the whole windows
+	Int64 m_NumSlotPackets;       ///< Set-slot packets sent for the changed slots
+	Int64 m_NumSlotsSkipped;      ///< Unchanged slots not sent, compared to sending the whole window
+	Int64 m_NumBytesSent;         ///< Estimated bytes sent, both the whole windows and the set-slot packets
+	Int64 m_NumBytesSaved;        ///< Estimated bytes not sent, compared to sending the whole window each time
+
+	/** Returns the estimated size of the whole window packet carrying the slots, in bytes */
+	static int GetWindowPacketSize(const cItems & a_Slots);
+
+	/** Returns the estimated size of the item as written in the packets, in bytes */
+	static int GetItemSize(const cItem & a_Item);
+} ;
+
+
+
+
@@ -401,6 +401,39 @@ AString cWebAdmin::GetDefaultPage(void)
 		Content.append(PlayerAccum.m_Contents);
 	}
 	Content += "</ul><br>";
+	Content += GetLockStatsTable();
+	return Content;
+}
+
+
+
+
+
+AString cWebAdmin::GetLockStatsTable(void)
+{
+	cCriticalSection::cStatsList Stats;
+	cCriticalSection::GetProfile(Stats);
+	if (!cCriticalSection::IsProfilingEnabled() && (Stats.empty() || (Stats.front().m_NumAcquisitions == 0)))
+	{
+		return "";
+	}
+	
+	AString Content;
+	Content += "<h4>Lock contention:</h4>";
+	if (!cCriticalSection::IsProfilingEnabled())
+	{
+		Content += "<p>The profiling is disabled, these are the stats from when it was last enabled.</p>";
+	}
+	Content += "<table><tr><th>Lock</th><th>Instances</th><th>Acquisitions</th><th>Contended</th>";
+	Content += "<th>Total wait [msec]</th><th>Total hold [msec]</th><th>Longest hold [msec]</th></tr>";
+	for (cCriticalSection::cStatsList::const_iterator itr = Stats.begin(), end = Stats.end(); itr != end; ++itr)
+	{
+		AppendPrintf(Content, "<tr><td>%s</td><td>%d</td><td>%lld</td><td>%lld</td><td>%.1f</td><td>%.1f</td><td>%.1f</td></tr>",
+			GetHTMLEscapedString(itr->m_Name).c_str(), itr->m_NumInstances, itr->m_NumAcquisitions, itr->m_NumContended,
+			itr->m_WaitTime / 1000.0, itr->m_HoldTime / 1000.0, itr->m_LongestHold / 1000.0
+		);
+	}  // for itr - Stats[]
+	Content += "</table><br>";
 	return Content;
 }
 
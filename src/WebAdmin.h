@@ -128,6 +128,9 @@ public:
 
 	/** Returns the contents of the default page - the list of plugins and players */
 	AString GetDefaultPage(void);
+	
+	/** Returns the table of the lock contention of the named critical sections; empty if nothing has been profiled */
+	AString GetLockStatsTable(void);
 
 	/** Returns the prefix needed for making a link point to the webadmin root from the given URL ("../../../webadmin"-style) */
 	AString GetBaseURL(const AString & a_URL);
@@ -45,7 +45,6 @@
 #include "Blocks/BlockHandler.h"
 #include "Vector3d.h"
 
-#include "Tracer.h"
 
 // DEBUG: Test out the cLineBlockTracer class by tracing a few lines:
 #include "LineBlockTracer.h"
@@ -203,7 +202,12 @@ void cWorld::cTickThread::Execute(void)
 	cTimer Timer;
 
 	const Int64 msPerTick = 50;
+	
+	// The maximum time the ticks may lag behind; if lagging more, the missed ticks are dropped instead of caught up on
+	const Int64 msMaxLag = 20 * msPerTick;
+	
 	Int64 LastTime = Timer.GetNowTime();
+	Int64 NextTickTime = LastTime;
 
 	Int64 TickDuration = 50;
 	while (!m_ShouldTerminate)
@@ -211,12 +215,19 @@ void cWorld::cTickThread::Execute(void)
 		Int64 NowTime = Timer.GetNowTime();
 		float DeltaTime = (float)(NowTime - LastTime);
 		m_World.Tick(DeltaTime, (int)TickDuration);
-		TickDuration = Timer.GetNowTime() - NowTime;
+		Int64 TickEndTime = Timer.GetNowTime();
+		TickDuration = TickEndTime - NowTime;
 		
-		if (TickDuration < msPerTick)
+		// Schedule the next tick relative to when this one was due, so that an overlong tick is caught up on by the following ones:
+		NextTickTime += msPerTick;
+		if (NextTickTime < TickEndTime - msMaxLag)
+		{
+			// Too far behind, drop the missed ticks
+			NextTickTime = TickEndTime;
+		}
+		if (NextTickTime > TickEndTime)
 		{
-			// Stretch tick time until it's at least msPerTick
-			cSleep::MilliSleep((unsigned int)(msPerTick - TickDuration));
+			cSleep::MilliSleep((unsigned int)(NextTickTime - TickEndTime));
 		}
 
 		LastTime = NowTime;
@@ -235,10 +246,17 @@ cWorld::cWorld(const AString & a_WorldName) :
 	m_IniFileName(m_WorldName + "/world.ini"),
 	m_StorageSchema("Default"),
 #ifdef __arm__
-	m_StorageCompressionFactor(0),
+	m_StorageCompressor("storage", cCompressor::codecZlib, 0),
 #else
-	m_StorageCompressionFactor(6),
+	m_StorageCompressor("storage", cCompressor::codecZlib, 6),
 #endif
+	m_NetworkCompressor("network chunks", cCompressor::codecZlib, 6),
+	m_TickBudgetMSec(45),
+	m_OverloadLevel(0),
+	m_AvgTickDuration(0),
+	m_CurrentTPS(20),
+	m_TPSNumTicks(0),
+	m_TPSTime(0),
 	m_IsSpawnExplicitlySet(false),
 	m_WorldAgeSecs(0),
 	m_TimeOfDaySecs(0),
@@ -252,9 +270,12 @@ cWorld::cWorld(const AString & a_WorldName) :
 	m_bUseChatPrefixes(true),
 	m_Scoreboard(this),
 	m_GeneratorCallbacks(*this),
+	m_LineOfSight(*this),
 	m_TickThread(*this)
 {
 	LOGD("cWorld::cWorld(\"%s\")", a_WorldName.c_str());
+	
+	memset(m_NumDeferredWork, 0, sizeof(m_NumDeferredWork));
 
 	cFile::CreateFolder(FILE_IO_PREFIX + m_WorldName);
 
@@ -531,7 +552,13 @@ void cWorld::Start(void)
 	}
 
 	m_StorageSchema             = IniFile.GetValueSet ("Storage",       "Schema",                    m_StorageSchema);
-	m_StorageCompressionFactor  = IniFile.GetValueSetI("Storage",       "CompressionFactor",         m_StorageCompressionFactor);
+	int StorageCompressionLevel = IniFile.GetValueSetI("Storage",       "CompressionFactor",         m_StorageCompressor.GetLevel());
+	AString StorageCodec        = IniFile.GetValueSet ("Storage",       "CompressionCodec",          cCompressor::CodecToString(m_StorageCompressor.GetCodec()));
+	int ChunkCompressionLevel   = IniFile.GetValueSetI("Network",       "ChunkCompressionLevel",     m_NetworkCompressor.GetLevel());
+	m_TickBudgetMSec            = IniFile.GetValueSetI("General",       "TickBudgetMSec",            m_TickBudgetMSec);
+	int NumTickThreads          = IniFile.GetValueSetI("General",       "ParallelTickThreads",       0);
+	int PathNodesPerTick        = IniFile.GetValueSetI("Pathfinding",   "NodesPerTick",              2000);
+	bool ShouldPathInThread     = IniFile.GetValueSetB("Pathfinding",   "UseThread",                 true);
 	m_MaxCactusHeight           = IniFile.GetValueSetI("Plants",        "MaxCactusHeight",           3);
 	m_MaxSugarcaneHeight        = IniFile.GetValueSetI("Plants",        "MaxSugarcaneHeight",        3);
 	m_IsCactusBonemealable      = IniFile.GetValueSetB("Plants",        "IsCactusBonemealable",      false);
@@ -586,9 +613,16 @@ void cWorld::Start(void)
 	}
 
 	m_ChunkMap = new cChunkMap(this);
+	if (NumTickThreads > 0)
+	{
+		// Opt-in: the parallel tick mode ticks only the region-local simulators in parallel, see cChunkTickRegion
+		LOG("World \"%s\": Ticking the chunks in %d parallel threads", m_WorldName.c_str(), NumTickThreads + 1);
+		m_ChunkMap->StartTickThreads(NumTickThreads);
+	}
 	
 	m_LastSave = 0;
 	m_LastUnload = 0;
+	m_LastStorageWork = 0;
 
 	// preallocate some memory for ticking blocks so we don't need to allocate that often
 	m_BlockTickQueue.reserve(1000);
@@ -601,13 +635,27 @@ void cWorld::Start(void)
 	m_SandSimulator     = new cSandSimulator(*this, IniFile);
 	m_FireSimulator     = new cFireSimulator(*this, IniFile);
 	m_RedstoneSimulator = InitializeRedstoneSimulator(IniFile);
+	
+	// Set up the compression; the codecs other than zlib can only be used by the MCServer-specific storage schema:
+	m_StorageCompressor.SetLevel(StorageCompressionLevel);
+	m_StorageCompressor.SetCodec(cCompressor::StringToCodec(StorageCodec, cCompressor::codecZlib));
+	if ((m_StorageCompressor.GetCodec() != cCompressor::codecZlib) && (NoCaseCompare(m_StorageSchema, "compact") != 0))
+	{
+		LOGWARNING("World \"%s\": The \"%s\" storage codec can only be used with the \"compact\" storage schema, using zlib instead.",
+			m_WorldName.c_str(), StorageCodec.c_str()
+		);
+		m_StorageCompressor.SetCodec(cCompressor::codecZlib);
+	}
+	m_NetworkCompressor.SetLevel(ChunkCompressionLevel);
 
 	// Water, Lava and Redstone simulators get registered in their initialize function.
 	m_SimulatorManager->RegisterSimulator(m_SandSimulator, 1);
 	m_SimulatorManager->RegisterSimulator(m_FireSimulator, 1);
 
 	m_Lighting.Start(this);
-	m_Storage.Start(this, m_StorageSchema, m_StorageCompressionFactor );
+	m_PathService.Start(this, ShouldPathInThread, PathNodesPerTick);
+	m_BlockAreaIO.Start(this);
+	m_Storage.Start(this, m_StorageSchema, m_StorageCompressor);
 	m_Generator.Start(m_GeneratorCallbacks, m_GeneratorCallbacks, IniFile);
 	m_ChunkSender.Start(this);
 	m_TickThread.Start();
@@ -671,6 +719,8 @@ void cWorld::Stop(void)
 	
 	m_TickThread.Stop();
 	m_Lighting.Stop();
+	m_PathService.Stop();
+	m_BlockAreaIO.Stop();
 	m_Generator.Stop();
 	m_ChunkSender.Stop();
 	m_Storage.Stop();
@@ -682,6 +732,8 @@ void cWorld::Stop(void)
 
 void cWorld::Tick(float a_Dt, int a_LastTickDurationMSec)
 {
+	UpdateTickLoad(a_Dt, a_LastTickDurationMSec);
+	
 	// Call the plugins
 	cPluginManager::Get()->CallHookWorldTick(*this, a_Dt, a_LastTickDurationMSec);
 	
@@ -730,8 +782,55 @@ void cWorld::Tick(float a_Dt, int a_LastTickDurationMSec)
 	{
 		UnloadUnusedChunks();
 	}
+	
+	if (m_WorldAge - m_LastStorageWork >= 20)  // Let the storage do its background work each second
+	{
+		m_Storage.QueueBackgroundWork();
+		m_LastStorageWork = m_WorldAge;
+	}
 
+	m_LineOfSight.Tick(m_WorldAge);
 	TickMobs(a_Dt);
+
+	m_PathService.Tick();
+}
+
+
+
+
+
+void cWorld::UpdateTickLoad(float a_Dt, int a_LastTickDurationMSec)
+{
+	// Smooth the tick duration, so that a single slow tick doesn't trigger the deferring:
+	m_AvgTickDuration = 0.9 * m_AvgTickDuration + 0.1 * a_LastTickDurationMSec;
+	
+	// Measure the TPS and adjust the overload level once per second:
+	m_TPSNumTicks += 1;
+	m_TPSTime += a_Dt;
+	if (m_TPSTime < 1000)
+	{
+		return;
+	}
+	m_CurrentTPS = m_TPSNumTicks * 1000.0 / m_TPSTime;
+	m_TPSNumTicks = 0;
+	m_TPSTime = 0;
+	
+	if (m_TickBudgetMSec <= 0)
+	{
+		m_OverloadLevel = 0;
+		return;
+	}
+	if ((m_AvgTickDuration > m_TickBudgetMSec) && (m_OverloadLevel < dwCount))
+	{
+		m_OverloadLevel += 1;
+		LOGD("World \"%s\": ticks take %.1f msec on average, raising overload level to %d", m_WorldName.c_str(), m_AvgTickDuration, m_OverloadLevel);
+	}
+	else if ((m_AvgTickDuration < m_TickBudgetMSec * 0.6) && (m_OverloadLevel > 0))
+	{
+		// Use hysteresis, so that the level doesn't oscillate around the budget
+		m_OverloadLevel -= 1;
+		LOGD("World \"%s\": ticks take %.1f msec on average, lowering overload level to %d", m_WorldName.c_str(), m_AvgTickDuration, m_OverloadLevel);
+	}
 }
 
 
@@ -802,7 +901,11 @@ void cWorld::TickMobs(float a_Dt)
 	// before every Mob action, we have to count them depending on the distance to players, on their family ...
 	cMobCensus MobCensus;
 	m_ChunkMap->CollectMobCensus(MobCensus);
-	if (m_bAnimals)
+	if (m_bAnimals && ShouldDeferWork(dwMobSpawning))
+	{
+		AddDeferredWork(dwMobSpawning, 1);
+	}
+	else if (m_bAnimals)
 	{
 		// Spawning is enabled, spawn now:
 		static const cMonster::eFamily AllFamilies[] =
@@ -839,6 +942,13 @@ void cWorld::TickMobs(float a_Dt)
 
 	// move close mobs
 	cMobProximityCounter::sIterablePair allCloseEnoughToMoveMobs = MobCensus.GetProximityCounter().getMobWithinThosesDistances(-1, 64 * 16);// MG TODO : deal with this magic number (the 16 is the size of a block)
+	if (ShouldDeferWork(dwFarMobTicks))
+	{
+		// Overloaded, move only the mobs nearest to the players:
+		int NumCloseMobs = allCloseEnoughToMoveMobs.m_Count;
+		allCloseEnoughToMoveMobs = MobCensus.GetProximityCounter().getMobWithinThosesDistances(-1, 32 * 16);
+		AddDeferredWork(dwFarMobTicks, NumCloseMobs - allCloseEnoughToMoveMobs.m_Count);
+	}
 	for(cMobProximityCounter::tDistanceToMonster::const_iterator itr = allCloseEnoughToMoveMobs.m_Begin; itr != allCloseEnoughToMoveMobs.m_End; itr++)
 	{
 		itr->second.m_Monster.Tick(a_Dt, itr->second.m_Chunk);
@@ -1102,6 +1212,24 @@ bool cWorld::DoWithBlockEntityAt(int a_BlockX, int a_BlockY, int a_BlockZ, cBloc
 
 
 
+void cWorld::WakeUpBlockEntity(cBlockEntity & a_BlockEntity)
+{
+	m_ChunkMap->WakeUpBlockEntity(a_BlockEntity);
+}
+
+
+
+
+
+void cWorld::WakeUpBlockEntityNeighbors(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	m_ChunkMap->WakeUpBlockEntityNeighbors(a_BlockX, a_BlockY, a_BlockZ);
+}
+
+
+
+
+
 bool cWorld::DoWithChestAt(int a_BlockX, int a_BlockY, int a_BlockZ, cChestCallback & a_Callback)
 {
 	return m_ChunkMap->DoWithChestAt(a_BlockX, a_BlockY, a_BlockZ, a_Callback);
@@ -1548,6 +1676,24 @@ bool cWorld::WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlock
 
 
 
+void cWorld::ReadBlockAreaAsync(cBlockArea & a_Area, int a_MinBlockX, int a_MaxBlockX, int a_MinBlockY, int a_MaxBlockY, int a_MinBlockZ, int a_MaxBlockZ, int a_DataTypes, cBlockAreaCallback * a_Callback)
+{
+	m_BlockAreaIO.QueueRead(a_Area, a_MinBlockX, a_MaxBlockX, a_MinBlockY, a_MaxBlockY, a_MinBlockZ, a_MaxBlockZ, a_DataTypes, a_Callback);
+}
+
+
+
+
+
+void cWorld::WriteBlockAreaAsync(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes, cBlockAreaCallback * a_Callback)
+{
+	m_BlockAreaIO.QueueWrite(a_Area, a_MinBlockX, a_MinBlockY, a_MinBlockZ, a_DataTypes, a_Callback);
+}
+
+
+
+
+
 void cWorld::SpawnItemPickups(const cItems & a_Pickups, double a_BlockX, double a_BlockY, double a_BlockZ, double a_FlyAwaySpeed, bool IsPlayerCreated)
 {
 	MTRand r1;
@@ -2368,8 +2514,6 @@ bool cWorld::FindAndDoWithPlayer(const AString & a_PlayerNameHint, cPlayerListCa
 // TODO: This interface is dangerous!
 cPlayer * cWorld::FindClosestPlayer(const Vector3d & a_Pos, float a_SightLimit, bool a_CheckLineOfSight)
 {
-	cTracer LineOfSight(this);
-
 	float ClosestDistance = a_SightLimit;
 	cPlayer* ClosestPlayer = NULL;
 
@@ -2381,16 +2525,12 @@ cPlayer * cWorld::FindClosestPlayer(const Vector3d & a_Pos, float a_SightLimit,
 
 		if (Distance < ClosestDistance)
 		{
-			if (a_CheckLineOfSight && !LineOfSight.Trace(a_Pos,(Pos - a_Pos),(int)(Pos - a_Pos).Length()))
-			{
-				ClosestDistance = Distance;
-				ClosestPlayer = *itr;
-			}
-			else
+			if (a_CheckLineOfSight && !m_LineOfSight.IsVisible(a_Pos, (*itr)->GetEyePosition()))
 			{
-				ClosestDistance = Distance;
-				ClosestPlayer = *itr;
+				continue;
 			}
+			ClosestDistance = Distance;
+			ClosestPlayer = *itr;
 		}
 	}
 	return ClosestPlayer;
@@ -2593,7 +2733,8 @@ void cWorld::RegenerateChunk(int a_ChunkX, int a_ChunkZ)
 	m_ChunkMap->MarkChunkRegenerating(a_ChunkX, a_ChunkZ);
 	
 	// Trick: use Y=1 to force the chunk generation even though the chunk data is already present
-	m_Generator.QueueGenerateChunk(a_ChunkX, 1, a_ChunkZ);
+	// The regeneration is requested explicitly, so it goes before the chunks queued by the players moving around
+	m_Generator.QueueGenerateChunk(a_ChunkX, 1, a_ChunkZ, true);
 }
 
 
@@ -2745,6 +2886,33 @@ void cWorld::GetChunkStats(int & a_NumValid, int & a_NumDirty, int & a_NumInLigh
 
 
 
+void cWorld::GetClientChunkStats(int & a_NumClients, int & a_NumChunksToSend, int & a_MaxChunksToSend)
+{
+	a_NumChunksToSend = 0;
+	a_MaxChunksToSend = 0;
+	cCSLock Lock(m_CSClients);
+	a_NumClients = (int)m_Clients.size();
+	for (cClientHandleList::iterator itr = m_Clients.begin(), end = m_Clients.end(); itr != end; ++itr)
+	{
+		int NumChunksToSend = (*itr)->GetNumChunksToSend();
+		a_NumChunksToSend += NumChunksToSend;
+		a_MaxChunksToSend = std::max(a_MaxChunksToSend, NumChunksToSend);
+	}  // for itr - m_Clients[]
+}
+
+
+
+
+
+int cWorld::GetNumChunksInRegion(int a_RegionX, int a_RegionZ)
+{
+	return m_ChunkMap->GetNumChunksInLayer(a_RegionX, a_RegionZ);
+}
+
+
+
+
+
 void cWorld::TickQueuedBlocks(void)
 {
 	if (m_BlockTickQueue.empty())
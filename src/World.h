@@ -17,8 +17,13 @@
 #include "Vector3i.h"
 #include "Vector3f.h"
 #include "ChunkSender.h"
+#include "Compressor.h"
 #include "Defines.h"
 #include "LightingThread.h"
+#include "Mobs/PathService.h"
+#include "BlockAreaIOThread.h"
+#include "LineOfSightCache.h"
+#include "BlockChangeStats.h"
 #include "Item.h"
 #include "Mobs/Monster.h"
 #include "Entities/ProjectileEntity.h"
@@ -403,6 +408,14 @@ public:
 	*/
 	virtual bool WriteBlockArea(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes);
 	
+	/** Reads the area (all coords inclusive) in a separate thread, then calls the callback in the tick thread.
+	The area must not be accessed until then. Takes ownership of a_Callback, which may be NULL. */
+	void ReadBlockAreaAsync(cBlockArea & a_Area, int a_MinBlockX, int a_MaxBlockX, int a_MinBlockY, int a_MaxBlockY, int a_MinBlockZ, int a_MaxBlockZ, int a_DataTypes, cBlockAreaCallback * a_Callback);  // Exported in ManualBindings.cpp as cBlockArea:ReadAsync()
+	
+	/** Writes the area in a separate thread, then calls the callback in the tick thread.
+	The area must not be accessed until then. Takes ownership of a_Callback, which may be NULL. */
+	void WriteBlockAreaAsync(cBlockArea & a_Area, int a_MinBlockX, int a_MinBlockY, int a_MinBlockZ, int a_DataTypes, cBlockAreaCallback * a_Callback);  // Exported in ManualBindings.cpp as cBlockArea:WriteAsync()
+	
 	// tolua_begin
 
 	/** Spawns item pickups for each item in the list. May compress pickups if too many entities: */
@@ -488,6 +501,12 @@ public:
 
 	/** Calls the callback for the block entity at the specified coords; returns false if there's no block entity at those coords, true if found */
 	bool DoWithBlockEntityAt(int a_BlockX, int a_BlockY, int a_BlockZ, cBlockEntityCallback & a_Callback);  // Exported in ManualBindings.cpp
+	
+	/** Wakes up the block entity, so that it is ticked again. Used by cBlockEntity::WakeUp() */
+	void WakeUpBlockEntity(cBlockEntity & a_BlockEntity);
+	
+	/** Wakes up the block entities of all 6 neighbors of the specified block, for example when its contents change */
+	void WakeUpBlockEntityNeighbors(int a_BlockX, int a_BlockY, int a_BlockZ);
 
 	/** Calls the callback for the chest at the specified coords; returns false if there's no chest at those coords, true if found */
 	bool DoWithChestAt(int a_BlockX, int a_BlockY, int a_BlockZ, cChestCallback & a_Callback);  // Exported in ManualBindings.cpp
@@ -594,6 +613,12 @@ public:
 
 	/** Returns the number of chunks loaded and dirty, and in the lighting queue */
 	void GetChunkStats(int & a_NumValid, int & a_NumDirty, int & a_NumInLightingQueue);
+	
+	/** Returns the number of clients in the world and the total and the largest number of chunks waiting to be sent to a client */
+	void GetClientChunkStats(int & a_NumClients, int & a_NumChunksToSend, int & a_MaxChunksToSend);
+	
+	/** Returns the number of chunks loaded in the specified 32 x 32 chunk region */
+	int GetNumChunksInRegion(int a_RegionX, int a_RegionZ);
 
 	// Various queues length queries (cannot be const, they lock their CS):
 	inline int GetGeneratorQueueLength  (void) { return m_Generator.GetQueueLength();   }    // tolua_export
@@ -648,6 +673,23 @@ public:
 	cChunkGenerator & GetGenerator(void) { return m_Generator; }
 	cWorldStorage &   GetStorage  (void) { return m_Storage; }
 	cChunkMap *       GetChunkMap (void) { return m_ChunkMap; }
+	
+	cCompressor & GetStorageCompressor(void) { return m_StorageCompressor; }
+	cCompressor & GetNetworkCompressor(void) { return m_NetworkCompressor; }
+	
+	cChunkSender & GetChunkSender(void) { return m_ChunkSender; }
+	
+	/** Returns the service that finds the paths for the mobs in this world */
+	cPathService & GetPathService(void) { return m_PathService; }
+	
+	/** Returns the thread that processes the asynchronous cBlockArea reads and writes in this world */
+	cBlockAreaIOThread & GetBlockAreaIO(void) { return m_BlockAreaIO; }
+	
+	/** Returns the cache of the line-of-sight queries in this world */
+	cLineOfSightCache & GetLineOfSight(void) { return m_LineOfSight; }
+	
+	/** Returns the statistics of the block changes sent to the clients in this world */
+	cBlockChangeStats & GetBlockChangeStats(void) { return m_BlockChangeStats; }
 		
 	/** Sets the blockticking to start at the specified block. Only one blocktick per chunk may be set, second call overwrites the first call */
 	void SetNextBlockTick(int a_BlockX, int a_BlockY, int a_BlockZ);  // tolua_export
@@ -672,6 +714,35 @@ public:
 
 	/** Get the current darkness level based on the time */
 	NIBBLETYPE GetSkyDarkness() { return m_SkyDarkness; }
+	
+	/** Kinds of non-critical work that get deferred when the world ticks take longer than the tick budget.
+	Listed in the order in which they get deferred as the overload level rises. */
+	enum eDeferrableWork
+	{
+		dwMobSpawning = 0,   ///< Spawning new mobs in TickMobs()
+		dwWeatherOnTop,      ///< Snow and ice placed by the weather in cChunk::ApplyWeatherToTop()
+		dwRandomBlockTicks,  ///< Most of the random block ticks in cChunk::TickBlocks()
+		dwFarMobTicks,       ///< Ticking the mobs that are further away from the players
+		dwCount,             ///< Number of the deferrable work kinds, also the maximum overload level
+	} ;
+	
+	/** Returns true if the specified kind of work is to be deferred in this tick due to overload. */
+	bool ShouldDeferWork(eDeferrableWork a_Work) const { return ((int)a_Work < m_OverloadLevel); }
+	
+	/** Adds the amount of work that has been deferred to the stats. To be used only in the tick thread! */
+	void AddDeferredWork(eDeferrableWork a_Work, int a_Amount) { m_NumDeferredWork[a_Work] += a_Amount; }
+	
+	/** Returns the total amount of the specified kind of work deferred since the world was started */
+	Int64 GetNumDeferredWork(eDeferrableWork a_Work) const { return m_NumDeferredWork[a_Work]; }
+	
+	/** Returns the current overload level: 0 is normal, N means the first N kinds of eDeferrableWork are being deferred */
+	int GetOverloadLevel(void) const { return m_OverloadLevel; }
+	
+	/** Returns the number of ticks per second, measured over the last second */
+	double GetCurrentTPS(void) const { return m_CurrentTPS; }
+	
+	/** Returns the average (smoothed) tick duration, in msec */
+	double GetAvgTickDuration(void) const { return m_AvgTickDuration; }
 
 private:
 
@@ -742,13 +813,36 @@ private:
 	/** Name of the storage schema used to load and save chunks */
 	AString m_StorageSchema;
 	
-	int m_StorageCompressionFactor;
+	/** The compression used for saving the chunks; the codec and level are set in world.ini */
+	cCompressor m_StorageCompressor;
+	
+	/** The compression used for the chunk data sent to the clients; always zlib, the level is set in world.ini */
+	cCompressor m_NetworkCompressor;
 	
 	/** The dimension of the world, used by the client to provide correct lighting scheme */
 	eDimension m_Dimension;
 	
 	/** This random generator is to be used only in the Tick() method, and thus only in the World-Tick-thread (MTRand is not exactly thread-safe) */
 	MTRand m_TickRand;
+	
+	/** The maximum average tick duration, in msec, before the non-critical work starts being deferred. 0 disables the deferring. */
+	int m_TickBudgetMSec;
+	
+	/** The current overload level; the first m_OverloadLevel kinds of eDeferrableWork are being deferred */
+	int m_OverloadLevel;
+	
+	/** The tick duration, smoothed over the last few ticks, in msec */
+	double m_AvgTickDuration;
+	
+	/** The ticks per second, measured over the last second */
+	double m_CurrentTPS;
+	
+	/** Number of ticks and their total time (in msec) since the last TPS measurement */
+	int   m_TPSNumTicks;
+	float m_TPSTime;
+	
+	/** The total amount of each kind of work deferred since the world was started */
+	Int64 m_NumDeferredWork[dwCount];
 
 	bool m_IsSpawnExplicitlySet;
 	double m_SpawnX;
@@ -762,6 +856,7 @@ private:
 	Int64  m_LastTimeUpdate;    // The tick in which the last time update has been sent.
 	Int64  m_LastUnload;        // The last WorldAge (in ticks) in which unloading was triggerred
 	Int64  m_LastSave;          // The last WorldAge (in ticks) in which save-all was triggerred
+	Int64  m_LastStorageWork;   // The last WorldAge (in ticks) in which the storage was woken up for its background work
 	std::map<cMonster::eFamily,Int64> m_LastSpawnMonster; // The last WorldAge (in ticks) in which a monster was spawned (for each megatype of monster) // MG TODO : find a way to optimize without creating unmaintenability (if mob IDs are becoming unrowed)
 
 	NIBBLETYPE m_SkyDarkness;
@@ -827,6 +922,10 @@ private:
 	
 	cChunkSender     m_ChunkSender;
 	cLightingThread  m_Lighting;
+	cPathService     m_PathService;
+	cBlockAreaIOThread m_BlockAreaIO;
+	cLineOfSightCache m_LineOfSight;
+	cBlockChangeStats m_BlockChangeStats;
 	cTickThread      m_TickThread;
 	
 	/** Guards the m_Tasks */
@@ -860,6 +959,9 @@ private:
 	virtual ~cWorld();
 
 	void Tick(float a_Dt, int a_LastTickDurationMSec);
+	
+	/** Updates the TPS and tick duration stats and adjusts the overload level based on the tick durations */
+	void UpdateTickLoad(float a_Dt, int a_LastTickDurationMSec);
 
 	/** Handles the weather in each tick */
 	void TickWeather(float a_Dt);
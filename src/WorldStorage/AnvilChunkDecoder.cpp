@@ -0,0 +1,201 @@
+
+// AnvilChunkDecoder.cpp
+
+// Implements the cAnvilChunkDecoder class that decodes the raw Anvil chunk data into the block arrays used by cChunk
+
+#include "Globals.h"
+#include "AnvilChunkDecoder.h"
+#include "zlib/zlib.h"
+
+
+
+
+
+/// The initial size of the inflate buffer; raw chunk data is 192 KiB, allow 64 KiB more of entities
+#define CHUNK_INFLATE_INITIAL 256 KiB
+
+/// The maximum size of an inflated chunk; anything larger is considered corrupt
+#define CHUNK_INFLATE_MAX 16 MiB
+
+/// Number of vertical sections in a chunk
+#define NUM_SECTIONS (cChunkDef::Height / 16)
+
+/// Number of blocks in a single section
+#define SECTION_BLOCKS (cChunkDef::Width * cChunkDef::Width * 16)
+
+
+
+
+
+cAnvilChunkDecoder::cAnvilChunkDecoder(void) :
+	m_DataSize(0),
+	m_LastBytesCopied(0)
+{
+	m_Buffer.resize(CHUNK_INFLATE_INITIAL);
+}
+
+
+
+
+
+bool cAnvilChunkDecoder::Inflate(const char * a_Data, size_t a_Length)
+{
+	m_DataSize = 0;
+
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	if (inflateInit(&strm) != Z_OK)
+	{
+		return false;
+	}
+	strm.next_in  = (Bytef *)a_Data;
+	strm.avail_in = (uInt)a_Length;
+
+	for (;;)
+	{
+		// Grow the buffer if it is full:
+		if (m_DataSize == m_Buffer.size())
+		{
+			if (m_Buffer.size() >= CHUNK_INFLATE_MAX)
+			{
+				LOGWARNING("%s: Inflated chunk data is larger than %d bytes, refusing to load.", __FUNCTION__, CHUNK_INFLATE_MAX);
+				inflateEnd(&strm);
+				return false;
+			}
+			m_Buffer.resize(m_Buffer.size() * 2);
+		}
+
+		strm.next_out  = (Bytef *)&(m_Buffer[m_DataSize]);
+		strm.avail_out = (uInt)(m_Buffer.size() - m_DataSize);
+		int res = inflate(&strm, Z_NO_FLUSH);
+		m_DataSize = m_Buffer.size() - strm.avail_out;
+		switch (res)
+		{
+			case Z_STREAM_END:
+			{
+				inflateEnd(&strm);
+				return true;
+			}
+			case Z_OK:
+			{
+				// Some data has been inflated, continue
+				break;
+			}
+			case Z_BUF_ERROR:
+			{
+				if (strm.avail_out == 0)
+				{
+					// Output buffer full, it will be grown in the next iteration
+					break;
+				}
+				// Input data is truncated
+				inflateEnd(&strm);
+				return false;
+			}
+			default:
+			{
+				inflateEnd(&strm);
+				return false;
+			}
+		}  // switch (res)
+	}  // for (;;)
+}
+
+
+
+
+
+bool cAnvilChunkDecoder::DecodeSections(
+	const cParsedNBT & a_NBT, int a_LevelTag,
+	BLOCKTYPE * a_BlockTypes, NIBBLETYPE * a_BlockMetas, NIBBLETYPE * a_BlockLight, NIBBLETYPE * a_SkyLight
+)
+{
+	m_LastBytesCopied = 0;
+	int Sections = a_NBT.FindChildByName(a_LevelTag, "Sections");
+	if ((Sections < 0) || (a_NBT.GetType(Sections) != TAG_List) || (a_NBT.GetChildrenType(Sections) != TAG_Compound))
+	{
+		return false;
+	}
+
+	bool IsPresent[NUM_SECTIONS];
+	memset(IsPresent, 0, sizeof(IsPresent));
+	for (int Child = a_NBT.GetFirstChild(Sections); Child >= 0; Child = a_NBT.GetNextSibling(Child))
+	{
+		int SectionY = a_NBT.FindChildByName(Child, "Y");
+		if ((SectionY < 0) || (a_NBT.GetType(SectionY) != TAG_Byte))
+		{
+			continue;
+		}
+		int y = a_NBT.GetByte(SectionY);
+		if ((y < 0) || (y >= NUM_SECTIONS))
+		{
+			continue;
+		}
+		IsPresent[y] = true;
+
+		// Copy each kind of data, use the defaults for data missing in the section:
+		if ((a_BlockTypes != NULL) && !CopySectionData(a_NBT, Child, "Blocks", a_BlockTypes + y * SECTION_BLOCKS, SECTION_BLOCKS))
+		{
+			memset(a_BlockTypes + y * SECTION_BLOCKS, E_BLOCK_AIR, SECTION_BLOCKS);
+		}
+		if ((a_BlockMetas != NULL) && !CopySectionData(a_NBT, Child, "Data", a_BlockMetas + y * SECTION_BLOCKS / 2, SECTION_BLOCKS / 2))
+		{
+			memset(a_BlockMetas + y * SECTION_BLOCKS / 2, 0, SECTION_BLOCKS / 2);
+		}
+		if ((a_SkyLight != NULL) && !CopySectionData(a_NBT, Child, "SkyLight", a_SkyLight + y * SECTION_BLOCKS / 2, SECTION_BLOCKS / 2))
+		{
+			memset(a_SkyLight + y * SECTION_BLOCKS / 2, 0xff, SECTION_BLOCKS / 2);
+		}
+		if ((a_BlockLight != NULL) && !CopySectionData(a_NBT, Child, "BlockLight", a_BlockLight + y * SECTION_BLOCKS / 2, SECTION_BLOCKS / 2))
+		{
+			memset(a_BlockLight + y * SECTION_BLOCKS / 2, 0, SECTION_BLOCKS / 2);
+		}
+	}  // for Child - Sections[]
+
+	// Fill the sections not present in the data; by default, data not present in the NBT means air, which means full skylight:
+	for (int y = 0; y < NUM_SECTIONS; y++)
+	{
+		if (IsPresent[y])
+		{
+			continue;
+		}
+		if (a_BlockTypes != NULL)
+		{
+			memset(a_BlockTypes + y * SECTION_BLOCKS, E_BLOCK_AIR, SECTION_BLOCKS);
+		}
+		if (a_BlockMetas != NULL)
+		{
+			memset(a_BlockMetas + y * SECTION_BLOCKS / 2, 0, SECTION_BLOCKS / 2);
+		}
+		if (a_SkyLight != NULL)
+		{
+			memset(a_SkyLight + y * SECTION_BLOCKS / 2, 0xff, SECTION_BLOCKS / 2);
+		}
+		if (a_BlockLight != NULL)
+		{
+			memset(a_BlockLight + y * SECTION_BLOCKS / 2, 0, SECTION_BLOCKS / 2);
+		}
+	}  // for y
+
+	return true;
+}
+
+
+
+
+
+bool cAnvilChunkDecoder::CopySectionData(const cParsedNBT & a_NBT, int a_SectionTag, const char * a_ChildName, void * a_Destination, int a_Length)
+{
+	int Child = a_NBT.FindChildByName(a_SectionTag, a_ChildName);
+	if ((Child < 0) || (a_NBT.GetType(Child) != TAG_ByteArray) || (a_NBT.GetDataLength(Child) != a_Length))
+	{
+		return false;
+	}
+	memcpy(a_Destination, a_NBT.GetData(Child), a_Length);
+	m_LastBytesCopied += a_Length;
+	return true;
+}
+
+
+
+
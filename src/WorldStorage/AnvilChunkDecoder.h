@@ -0,0 +1,71 @@
+
+// AnvilChunkDecoder.h
+
+// Declares the cAnvilChunkDecoder class that decodes the raw Anvil chunk data into the block arrays used by cChunk
+
+/*
+The decoder inflates the compressed chunk into a buffer that is kept between chunks, so that no huge stack buffer
+is needed and chunks larger than the initial buffer (lots of entities) still load. The block data from each section
+is then copied straight into the destination arrays; only the sections not present in the file are cleared.
+
+Both the MCA sections and cChunk store the blocks in the XZY order (index = x + 16 * z + 256 * y), so each section
+is a single contiguous run in the destination arrays and no per-block reordering is needed.
+*/
+
+
+
+
+
+#pragma once
+
+#include "FastNBT.h"
+
+
+
+
+
+class cAnvilChunkDecoder
+{
+public:
+	cAnvilChunkDecoder(void);
+
+	/** Inflates the zlib-compressed chunk data into the internal buffer.
+	Returns true on success; the data is then available via GetData() / GetDataSize() until the next call. */
+	bool Inflate(const char * a_Data, size_t a_Length);
+
+	/** Returns the inflated data, valid after a successful Inflate() */
+	const char * GetData(void) const { return m_Buffer.data(); }
+
+	/** Returns the number of valid bytes in GetData() */
+	int GetDataSize(void) const { return (int)m_DataSize; }
+
+	/** Decodes the blocktypes, metas, blocklight and skylight from the Level\\Sections tag of the parsed chunk.
+	Any of the destination arrays may be NULL, then that kind of data is skipped.
+	Sections that are not present in the NBT are filled with air and full skylight.
+	Returns false if the Sections tag is missing or invalid. */
+	bool DecodeSections(
+		const cParsedNBT & a_NBT, int a_LevelTag,
+		BLOCKTYPE * a_BlockTypes, NIBBLETYPE * a_BlockMetas, NIBBLETYPE * a_BlockLight, NIBBLETYPE * a_SkyLight
+	);
+
+	/** Returns the number of bytes copied from the NBT data into the destination arrays by the last DecodeSections() call */
+	size_t GetLastBytesCopied(void) const { return m_LastBytesCopied; }
+
+protected:
+	/** The buffer into which the chunk data is inflated. Grows as needed, never shrinks. */
+	AString m_Buffer;
+
+	/** Number of valid bytes in m_Buffer */
+	size_t m_DataSize;
+
+	/** Number of bytes copied from the NBT data into the destination arrays by the last DecodeSections() call */
+	size_t m_LastBytesCopied;
+
+	/** Copies a_Length bytes of the specified child's data into a_Destination, if the child is a bytearray of exactly that length.
+	Returns true if copied, false if the child is not present or invalid. */
+	bool CopySectionData(const cParsedNBT & a_NBT, int a_SectionTag, const char * a_ChildName, void * a_Destination, int a_Length);
+} ;
+
+
+
+
@@ -14,6 +14,7 @@
 #include "../Item.h"
 #include "../ItemGrid.h"
 #include "../StringCompression.h"
+#include "../CommandOutput.h"
 
 #include "../BlockEntities/ChestEntity.h"
 #include "../BlockEntities/CommandBlockEntity.h"
@@ -49,8 +50,17 @@ Since only the header is actually in the memory, this number can be high, but st
 */
 #define MAX_MCA_FILES 32
 
-/// The maximum size of an inflated chunk; raw chunk data is 192 KiB, allow 64 KiB more of entities
-#define CHUNK_INFLATE_MAX 256 KiB
+/** Interval between the scans of the region folder for files to compact, in msec */
+#define COMPACTION_SCAN_INTERVAL (5 * 60 * 1000)
+
+/** Maximum number of bytes per second that the background compaction copies, so that it doesn't starve the chunk I/O */
+#define COMPACTION_BYTES_PER_SEC (1 MiB)
+
+/** Maximum number of chunks copied by a single compaction step; the step holds the file lock */
+#define COMPACTION_MAX_CHUNKS_PER_STEP 32
+
+/** A region file is compacted only if it wastes at least this many sectors, and at least a quarter of its size */
+#define COMPACTION_MIN_WASTED_SECTORS 16
 
 
 
@@ -60,10 +70,21 @@ Since only the header is actually in the memory, this number can be high, but st
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // cWSSAnvil:
 
-cWSSAnvil::cWSSAnvil(cWorld * a_World, int a_CompressionFactor) :
+cWSSAnvil::cWSSAnvil(cWorld * a_World, cCompressor & a_Compressor) :
 	super(a_World),
-	m_CompressionFactor(a_CompressionFactor)
-{
+	m_CS("cWSSAnvil::m_CS"),
+	m_Compressor(a_Compressor),
+	m_LastRegionScan(0),
+	m_CompactionBudget(0),
+	m_LastBudgetRefill(0),
+	m_NumFilesCompacted(0),
+	m_NumCompactionsAborted(0),
+	m_NumBytesReclaimed(0)
+{
+	m_Compaction.m_IsActive = false;
+	m_Compaction.m_IsAborted = false;
+	
+
 	// Create a level.dat file for mapping tools, if it doesn't already exist:
 	AString fnam;
 	Printf(fnam, "%s/level.dat", a_World->GetName().c_str());
@@ -98,10 +119,20 @@ cWSSAnvil::cWSSAnvil(cWorld * a_World, int a_CompressionFactor) :
 cWSSAnvil::~cWSSAnvil()
 {
 	cCSLock Lock(m_CS);
+	if (m_Compaction.m_IsActive)
+	{
+		AbortCompaction();
+	}
 	for (cMCAFiles::iterator itr = m_Files.begin(); itr != m_Files.end(); ++itr)
 	{
 		delete *itr;
 	}  // for itr - m_Files[]
+	
+	cCSLock DecodersLock(m_CSDecoders);
+	for (cAnvilChunkDecoders::iterator itr = m_Decoders.begin(); itr != m_Decoders.end(); ++itr)
+	{
+		delete *itr;
+	}  // for itr - m_Decoders[]
 }
 
 
@@ -146,6 +177,63 @@ bool cWSSAnvil::SaveChunk(const cChunkCoords & a_Chunk)
 
 
 
+bool cWSSAnvil::DoBackgroundWork(void)
+{
+	if (!m_Compaction.m_IsActive)
+	{
+		// Look for a file to compact, but don't rescan the folder too often:
+		long long Now = m_Timer.GetNowTime();
+		if ((m_LastRegionScan != 0) && (Now - m_LastRegionScan < COMPACTION_SCAN_INTERVAL))
+		{
+			return false;
+		}
+		m_LastRegionScan = Now;
+		int RegionX, RegionZ;
+		if (!ScanRegionFiles(RegionX, RegionZ) || !StartCompaction(RegionX, RegionZ))
+		{
+			return false;
+		}
+	}
+	return CompactionStep();
+}
+
+
+
+
+
+void cWSSAnvil::LogStats(cCommandOutputCallback & a_Output)
+{
+	cCSLock Lock(m_CS);
+	if (m_RegionStats.empty())
+	{
+		a_Output.Out("  No region files scanned yet");
+	}
+	int TotalFileSectors = 0;
+	int TotalWastedSectors = 0;
+	for (cRegionStatsMap::const_iterator itr = m_RegionStats.begin(), end = m_RegionStats.end(); itr != end; ++itr)
+	{
+		const sRegionStats & Stats = itr->second;
+		int Wasted = Stats.GetWastedSectors();
+		a_Output.Out("  %s: %d chunks, %d KiB, %d KiB wasted (%d %%)",
+			itr->first.c_str(), Stats.m_NumChunks, Stats.m_FileSectors * 4, Wasted * 4,
+			(Stats.m_FileSectors > 0) ? (100 * Wasted / Stats.m_FileSectors) : 0
+		);
+		TotalFileSectors += Stats.m_FileSectors;
+		TotalWastedSectors += Wasted;
+	}  // for itr - m_RegionStats[]
+	a_Output.Out("  Total: %d region files, %d KiB, %d KiB wasted",
+		(int)m_RegionStats.size(), TotalFileSectors * 4, TotalWastedSectors * 4
+	);
+	a_Output.Out("  Compaction: %d files compacted, %d aborted, %lld KiB reclaimed%s",
+		m_NumFilesCompacted, m_NumCompactionsAborted, m_NumBytesReclaimed / 1024,
+		m_Compaction.m_IsActive ? "; compacting a file now" : ""
+	);
+}
+
+
+
+
+
 bool cWSSAnvil::GetChunkData(const cChunkCoords & a_Chunk, AString & a_Data)
 {
 	cCSLock Lock(m_CS);
@@ -169,6 +257,15 @@ bool cWSSAnvil::SetChunkData(const cChunkCoords & a_Chunk, const AString & a_Dat
 	{
 		return false;
 	}
+	if (
+		m_Compaction.m_IsActive &&
+		(File->GetRegionX() == m_Compaction.m_RegionX) &&
+		(File->GetRegionZ() == m_Compaction.m_RegionZ)
+	)
+	{
+		// The chunks already copied into the compacted file may be outdated now
+		m_Compaction.m_IsAborted = true;
+	}
 	return File->SetChunkData(a_Chunk, a_Data);
 }
 
@@ -231,34 +328,37 @@ cWSSAnvil::cMCAFile * cWSSAnvil::LoadMCAFile(const cChunkCoords & a_Chunk)
 
 bool cWSSAnvil::LoadChunkFromData(const cChunkCoords & a_Chunk, const AString & a_Data)
 {
-	// Decompress the data:
-	char Uncompressed[CHUNK_INFLATE_MAX];
-	z_stream strm;
-	strm.zalloc = (alloc_func)NULL;
-	strm.zfree = (free_func)NULL;
-	strm.opaque = NULL;
-	inflateInit(&strm);
-	strm.next_out  = (Bytef *)Uncompressed;
-	strm.avail_out = sizeof(Uncompressed);
-	strm.next_in   = (Bytef *)a_Data.data();
-	strm.avail_in  = a_Data.size();
-	int res = inflate(&strm, Z_FINISH);
-	inflateEnd(&strm);
-	if (res != Z_STREAM_END)
+	// Get a decoder to use; reuse one if available:
+	cAnvilChunkDecoder * Decoder = NULL;
 	{
-		return false;
+		cCSLock Lock(m_CSDecoders);
+		if (!m_Decoders.empty())
+		{
+			Decoder = m_Decoders.back();
+			m_Decoders.pop_back();
+		}
+	}
+	if (Decoder == NULL)
+	{
+		Decoder = new cAnvilChunkDecoder;
 	}
 	
-	// Parse the NBT data:
-	cParsedNBT NBT(Uncompressed, strm.total_out);
-	if (!NBT.IsValid())
+	bool res = false;
+	
+	// Decompress the data into the decoder's buffer:
+	if (Decoder->Inflate(a_Data.data(), a_Data.size()))
 	{
-		// NBT Parsing failed
-		return false;
+		// Parse the NBT data and load the chunk from it:
+		cParsedNBT NBT(Decoder->GetData(), Decoder->GetDataSize());
+		res = NBT.IsValid() && LoadChunkFromNBT(a_Chunk, NBT, *Decoder);
 	}
-
-	// Load the data from NBT:
-	return LoadChunkFromNBT(a_Chunk, NBT);
+	
+	// Return the decoder for reuse:
+	{
+		cCSLock Lock(m_CSDecoders);
+		m_Decoders.push_back(Decoder);
+	}
+	return res;
 }
 
 
@@ -275,56 +375,32 @@ bool cWSSAnvil::SaveChunkToData(const cChunkCoords & a_Chunk, AString & a_Data)
 	}
 	Writer.Finish();
 	
-	CompressString(Writer.GetResult().data(), Writer.GetResult().size(), a_Data, m_CompressionFactor);
-	return true;
+	ASSERT(m_Compressor.GetCodec() == cCompressor::codecZlib);  // cWorld makes sure of this
+	return (m_Compressor.Compress(Writer.GetResult().data(), Writer.GetResult().size(), a_Data) == Z_OK);
 }
 
 
 
 
 
-bool cWSSAnvil::LoadChunkFromNBT(const cChunkCoords & a_Chunk, const cParsedNBT & a_NBT)
+bool cWSSAnvil::LoadChunkFromNBT(const cChunkCoords & a_Chunk, const cParsedNBT & a_NBT, cAnvilChunkDecoder & a_Decoder)
 {
-	// The data arrays, in MCA-native y/z/x ordering (will be reordered for the final chunk data)
+	// The data arrays; the MCA-native y/z/x ordering is the same as cChunk's, so they are decoded directly in the final layout
 	cChunkDef::BlockTypes   BlockTypes;
 	cChunkDef::BlockNibbles MetaData;
 	cChunkDef::BlockNibbles BlockLight;
 	cChunkDef::BlockNibbles SkyLight;
 	
-	memset(BlockTypes, E_BLOCK_AIR, sizeof(BlockTypes));
-	memset(MetaData,   0,           sizeof(MetaData));
-	memset(SkyLight,   0xff,        sizeof(SkyLight));  // By default, data not present in the NBT means air, which means full skylight
-	memset(BlockLight, 0x00,        sizeof(BlockLight));
-	
 	// Load the blockdata, blocklight and skylight:
 	int Level = a_NBT.FindChildByName(0, "Level");
 	if (Level < 0)
 	{
 		return false;
 	}
-	int Sections = a_NBT.FindChildByName(Level, "Sections");
-	if ((Sections < 0) || (a_NBT.GetType(Sections) != TAG_List) || (a_NBT.GetChildrenType(Sections) != TAG_Compound))
+	if (!a_Decoder.DecodeSections(a_NBT, Level, BlockTypes, MetaData, BlockLight, SkyLight))
 	{
 		return false;
 	}
-	for (int Child = a_NBT.GetFirstChild(Sections); Child >= 0; Child = a_NBT.GetNextSibling(Child))
-	{
-		int y = 0;
-		int SectionY = a_NBT.FindChildByName(Child, "Y");
-		if ((SectionY < 0) || (a_NBT.GetType(SectionY) != TAG_Byte))
-		{
-			continue;
-		}
-		y = a_NBT.GetByte(SectionY);
-		if ((y < 0) || (y > 15))
-		{
-			continue;
-		}
-		CopyNBTData(a_NBT, Child, "Blocks",     (char *)&(BlockTypes[y * 4096]), 4096);
-		CopyNBTData(a_NBT, Child, "Data",       (char *)&(MetaData[y   * 2048]), 2048);
-		CopyNBTData(a_NBT, Child, "SkyLight",   (char *)&(SkyLight[y   * 2048]), 2048);
-		CopyNBTData(a_NBT, Child, "BlockLight", (char *)&(BlockLight[y * 2048]), 2048);
-	}  // for itr - LevelSections[]
 	
 	// Load the biomes from NBT, if present and valid. First try MCS-style, then Vanilla-style:
 	cChunkDef::BiomeMap BiomeMap;
@@ -393,19 +469,6 @@ bool cWSSAnvil::LoadChunkFromNBT(const cChunkCoords & a_Chunk, const cParsedNBT
 
 
 
-void cWSSAnvil::CopyNBTData(const cParsedNBT & a_NBT, int a_Tag, const AString & a_ChildName, char * a_Destination, int a_Length)
-{
-	int Child = a_NBT.FindChildByName(a_Tag, a_ChildName);
-	if ((Child >= 0) && (a_NBT.GetType(Child) == TAG_ByteArray) && (a_NBT.GetDataLength(Child) == a_Length))
-	{
-		memcpy(a_Destination, a_NBT.GetData(Child), a_Length);
-	}
-}
-
-
-
-
-
 bool cWSSAnvil::SaveChunkToNBT(const cChunkCoords & a_Chunk, cFastNBTWriter & a_Writer)
 {
 	a_Writer.BeginCompound("Level");
@@ -2052,6 +2115,281 @@ bool cWSSAnvil::GetBlockEntityNBTPos(const cParsedNBT & a_NBT, int a_TagIdx, int
 
 
 
+bool cWSSAnvil::ScanRegionFiles(int & a_RegionX, int & a_RegionZ)
+{
+	AString Folder;
+	Printf(Folder, "%s/region", m_World->GetName().c_str());
+	AStringVector Files = cFile::GetFolderContents(Folder);
+	
+	cRegionStatsMap Stats;
+	unsigned Header[MCA_MAX_CHUNKS];
+	int MaxWasted = 0;
+	for (AStringVector::const_iterator itr = Files.begin(), end = Files.end(); itr != end; ++itr)
+	{
+		int RegionX, RegionZ;
+		if (
+			(itr->size() < 4) ||
+			(itr->compare(itr->size() - 4, 4, ".mca") != 0) ||
+			(sscanf(itr->c_str(), "r.%d.%d.mca", &RegionX, &RegionZ) != 2)
+		)
+		{
+			// Not a region file
+			continue;
+		}
+		cFile f;
+		if (!f.Open(Folder + "/" + *itr, cFile::fmRead) || (f.Read(Header, sizeof(Header)) != sizeof(Header)))
+		{
+			continue;
+		}
+		sRegionStats & FileStats = Stats[*itr];
+		FileStats.Calculate(RegionX, RegionZ, Header, f.GetSize());
+		
+		// Pick the most fragmented file, if it is cold enough:
+		int Wasted = FileStats.GetWastedSectors();
+		if (
+			(Wasted > MaxWasted) &&
+			(Wasted >= COMPACTION_MIN_WASTED_SECTORS) &&
+			(Wasted * 4 >= FileStats.m_FileSectors) &&
+			(m_World->GetNumChunksInRegion(RegionX, RegionZ) == 0)
+		)
+		{
+			MaxWasted = Wasted;
+			a_RegionX = RegionX;
+			a_RegionZ = RegionZ;
+		}
+	}  // for itr - Files[]
+	
+	cCSLock Lock(m_CS);
+	std::swap(m_RegionStats, Stats);
+	return (MaxWasted > 0);
+}
+
+
+
+
+
+bool cWSSAnvil::StartCompaction(int a_RegionX, int a_RegionZ)
+{
+	cCSLock Lock(m_CS);
+	cMCAFile * File = LoadMCAFile(cChunkCoords(a_RegionX * 32, 0, a_RegionZ * 32));
+	if ((File == NULL) || !File->GetHeader(m_Compaction.m_OldHeader))
+	{
+		return false;
+	}
+	
+	AString TempFileName = File->GetFileName() + ".compact";
+	if (!m_Compaction.m_TempFile.Open(TempFileName, cFile::fmWrite))
+	{
+		LOGWARNING("Cannot compact region file \"%s\", failed to create the temporary file", File->GetFileName().c_str());
+		return false;
+	}
+	
+	// The chunks keep their indices, so their timestamps are copied as they are:
+	unsigned Timestamps[MCA_MAX_CHUNKS];
+	if (!File->GetTimestamps(Timestamps))
+	{
+		LOGWARNING("Cannot compact region file \"%s\", failed to read the chunk timestamps", File->GetFileName().c_str());
+		m_Compaction.m_TempFile.Close();
+		cFile::Delete(FILE_IO_PREFIX + TempFileName);
+		return false;
+	}
+	
+	// Reserve the space for the header, it is written once all the chunks are copied; write the timestamps:
+	memset(m_Compaction.m_NewHeader, 0, sizeof(m_Compaction.m_NewHeader));
+	if (
+		(m_Compaction.m_TempFile.Write(m_Compaction.m_NewHeader, sizeof(m_Compaction.m_NewHeader)) != sizeof(m_Compaction.m_NewHeader)) ||
+		(m_Compaction.m_TempFile.Write(Timestamps, sizeof(Timestamps)) != sizeof(Timestamps))
+	)
+	{
+		LOGWARNING("Cannot compact region file \"%s\", failed to write the temporary file", File->GetFileName().c_str());
+		m_Compaction.m_TempFile.Close();
+		cFile::Delete(FILE_IO_PREFIX + TempFileName);
+		return false;
+	}
+	
+	m_Compaction.m_IsActive   = true;
+	m_Compaction.m_IsAborted  = false;
+	m_Compaction.m_RegionX    = a_RegionX;
+	m_Compaction.m_RegionZ    = a_RegionZ;
+	m_Compaction.m_FileName   = File->GetFileName();
+	m_Compaction.m_NextChunk  = 0;
+	m_Compaction.m_NextSector = 2;  // Right after the header and the timestamps
+	LOGD("Compacting region file \"%s\"", m_Compaction.m_FileName.c_str());
+	return true;
+}
+
+
+
+
+
+bool cWSSAnvil::CompactionStep(void)
+{
+	// Replenish the I/O budget:
+	long long Now = m_Timer.GetNowTime();
+	long long Budget = m_CompactionBudget + (Now - m_LastBudgetRefill) * COMPACTION_BYTES_PER_SEC / 1000;
+	m_CompactionBudget = (int)std::min<long long>(Budget, COMPACTION_BYTES_PER_SEC);
+	m_LastBudgetRefill = Now;
+	if (m_CompactionBudget <= 0)
+	{
+		// Wait for the next wakeup
+		return false;
+	}
+	
+	cCSLock Lock(m_CS);
+	if (m_Compaction.m_IsAborted)
+	{
+		// A chunk has been saved into the file meanwhile, the file will be picked again by a later scan
+		LOGD("Region file \"%s\" has been written to while compacting, compaction aborted", m_Compaction.m_FileName.c_str());
+		AbortCompaction();
+		return false;
+	}
+	cMCAFile * File = LoadMCAFile(cChunkCoords(m_Compaction.m_RegionX * 32, 0, m_Compaction.m_RegionZ * 32));
+	if (File == NULL)
+	{
+		AbortCompaction();
+		return false;
+	}
+	
+	// Copy the chunks in their header order, so that they are sequential in the new file:
+	AString Data;
+	int NumCopied = 0;
+	for (; m_Compaction.m_NextChunk < MCA_MAX_CHUNKS; m_Compaction.m_NextChunk++)
+	{
+		if ((NumCopied >= COMPACTION_MAX_CHUNKS_PER_STEP) || (m_CompactionBudget <= 0))
+		{
+			// Continue in the next step
+			return (m_CompactionBudget > 0);
+		}
+		int Idx = m_Compaction.m_NextChunk;
+		if (m_Compaction.m_OldHeader[Idx] == 0)
+		{
+			// Chunk not present
+			continue;
+		}
+		if (!File->GetRawChunkData(Idx, Data))
+		{
+			LOGWARNING("Cannot compact region file \"%s\", chunk #%d cannot be read", m_Compaction.m_FileName.c_str(), Idx);
+			AbortCompaction();
+			return false;
+		}
+		
+		// Pad the data to whole sectors:
+		unsigned NumSectors = (unsigned)(Data.size() + 4095) / 4096;
+		Data.resize(NumSectors * 4096);
+		if (m_Compaction.m_TempFile.Write(Data.data(), (int)Data.size()) != (int)Data.size())
+		{
+			LOGWARNING("Cannot compact region file \"%s\", writing the temporary file failed", m_Compaction.m_FileName.c_str());
+			AbortCompaction();
+			return false;
+		}
+		m_Compaction.m_NewHeader[Idx] = htonl((m_Compaction.m_NextSector << 8) | NumSectors);
+		m_Compaction.m_NextSector += NumSectors;
+		m_CompactionBudget -= (int)Data.size();
+		NumCopied++;
+	}  // for m_NextChunk
+	
+	FinishCompaction();
+	return false;
+}
+
+
+
+
+
+void cWSSAnvil::FinishCompaction(void)
+{
+	ASSERT(m_CS.IsLocked());
+	
+	AString TempFileName = m_Compaction.m_FileName + ".compact";
+	if (
+		(m_Compaction.m_TempFile.Seek(0) < 0) ||
+		(m_Compaction.m_TempFile.Write(m_Compaction.m_NewHeader, sizeof(m_Compaction.m_NewHeader)) != sizeof(m_Compaction.m_NewHeader))
+	)
+	{
+		LOGWARNING("Cannot compact region file \"%s\", writing the header failed", m_Compaction.m_FileName.c_str());
+		AbortCompaction();
+		return;
+	}
+	m_Compaction.m_TempFile.Close();
+	
+	// Close the original file; the cached cMCAFile re-opens it, with the new header, on the next access:
+	cMCAFile * File = LoadMCAFile(cChunkCoords(m_Compaction.m_RegionX * 32, 0, m_Compaction.m_RegionZ * 32));
+	if (File != NULL)
+	{
+		File->Close();
+	}
+	int OldSize = cFile::GetSize(FILE_IO_PREFIX + m_Compaction.m_FileName);
+	
+	// Replace the original file. On POSIX, rename() replaces the file atomically; Windows can't rename over an existing file
+	#ifdef _WIN32
+		cFile::Delete(FILE_IO_PREFIX + m_Compaction.m_FileName);
+	#endif
+	if (!cFile::Rename(FILE_IO_PREFIX + TempFileName, FILE_IO_PREFIX + m_Compaction.m_FileName))
+	{
+		LOGWARNING("Cannot compact region file \"%s\", renaming the compacted file failed", m_Compaction.m_FileName.c_str());
+		AbortCompaction();
+		return;
+	}
+	
+	int NewSize = (int)m_Compaction.m_NextSector * 4096;
+	m_NumFilesCompacted += 1;
+	m_NumBytesReclaimed += std::max(OldSize - NewSize, 0);
+	AString StatsName;
+	Printf(StatsName, "r.%d.%d.mca", m_Compaction.m_RegionX, m_Compaction.m_RegionZ);
+	m_RegionStats[StatsName].Calculate(m_Compaction.m_RegionX, m_Compaction.m_RegionZ, m_Compaction.m_NewHeader, NewSize);
+	LOG("Compacted region file \"%s\" from %d KiB to %d KiB", m_Compaction.m_FileName.c_str(), OldSize / 1024, NewSize / 1024);
+	m_Compaction.m_IsActive = false;
+}
+
+
+
+
+
+void cWSSAnvil::AbortCompaction(void)
+{
+	if (m_Compaction.m_TempFile.IsOpen())
+	{
+		m_Compaction.m_TempFile.Close();
+	}
+	cFile::Delete(FILE_IO_PREFIX + m_Compaction.m_FileName + ".compact");
+	m_Compaction.m_IsActive = false;
+	m_NumCompactionsAborted += 1;
+}
+
+
+
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// cWSSAnvil::sRegionStats:
+
+void cWSSAnvil::sRegionStats::Calculate(int a_RegionX, int a_RegionZ, const unsigned * a_Header, int a_FileSize)
+{
+	m_RegionX = a_RegionX;
+	m_RegionZ = a_RegionZ;
+	m_NumChunks = 0;
+	m_UsedSectors = 2;  // The header and the timestamps
+	for (int i = 0; i < MCA_MAX_CHUNKS; i++)
+	{
+		unsigned ChunkLocation = ntohl(a_Header[i]);
+		if (ChunkLocation == 0)
+		{
+			continue;
+		}
+		m_NumChunks += 1;
+		m_UsedSectors += ChunkLocation & 0xff;
+	}  // for i - a_Header[]
+	m_FileSectors = std::max((a_FileSize + 4095) / 4096, m_UsedSectors);
+}
+
+
+
+
+
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // cWSSAnvil::cMCAFile:
 
@@ -2112,6 +2450,79 @@ bool cWSSAnvil::cMCAFile::OpenFile(bool a_IsForReading)
 
 
 
+bool cWSSAnvil::cMCAFile::GetHeader(unsigned * a_Header)
+{
+	if (!OpenFile(true))
+	{
+		return false;
+	}
+	memcpy(a_Header, m_Header, sizeof(m_Header));
+	return true;
+}
+
+
+
+
+
+bool cWSSAnvil::cMCAFile::GetTimestamps(unsigned * a_Timestamps)
+{
+	if (!OpenFile(true))
+	{
+		return false;
+	}
+	int Size = MCA_MAX_CHUNKS * (int)sizeof(unsigned);
+	return (
+		(m_File.Seek(sizeof(m_Header)) >= 0) &&
+		(m_File.Read(a_Timestamps, Size) == Size)
+	);
+}
+
+
+
+
+
+bool cWSSAnvil::cMCAFile::GetRawChunkData(int a_Index, AString & a_Data)
+{
+	if (!OpenFile(true))
+	{
+		return false;
+	}
+	unsigned ChunkLocation = ntohl(m_Header[a_Index]);
+	unsigned ChunkOffset = ChunkLocation >> 8;
+	unsigned ChunkSectors = ChunkLocation & 0xff;
+	if ((ChunkOffset < 2) || (ChunkSectors == 0))
+	{
+		// Chunk not present
+		return false;
+	}
+	if (m_File.Seek(ChunkOffset * 4096) < 0)
+	{
+		return false;
+	}
+	
+	unsigned ChunkSize = 0;
+	if (m_File.Read(&ChunkSize, 4) != 4)
+	{
+		return false;
+	}
+	ChunkSize = ntohl(ChunkSize);
+	if ((ChunkSize < 1) || (ChunkSize + 4 > ChunkSectors * 4096))
+	{
+		// Invalid length
+		return false;
+	}
+	
+	// HACK: This depends on the internal knowledge that AString's data() function returns the internal buffer directly
+	a_Data.assign(ChunkSize + 4, '\0');
+	unsigned NetChunkSize = htonl(ChunkSize);
+	memcpy((void *)a_Data.data(), &NetChunkSize, 4);
+	return (m_File.Read((void *)(a_Data.data() + 4), (int)ChunkSize) == (int)ChunkSize);
+}
+
+
+
+
+
 bool cWSSAnvil::cMCAFile::GetChunkData(const cChunkCoords & a_Chunk, AString & a_Data)
 {
 	if (!OpenFile(true))
@@ -10,6 +10,9 @@
 
 #include "WorldStorage.h"
 #include "FastNBT.h"
+#include "AnvilChunkDecoder.h"
+#include "../Compressor.h"
+#include "../OSSupport/Timer.h"
 
 
 
@@ -47,7 +50,7 @@ class cWSSAnvil :
 	
 public:
 
-	cWSSAnvil(cWorld * a_World, int a_CompressionFactor);
+	cWSSAnvil(cWorld * a_World, cCompressor & a_Compressor);
 	virtual ~cWSSAnvil();
 	
 protected:
@@ -66,6 +69,19 @@ protected:
 		int             GetRegionZ (void) const {return m_RegionZ; }
 		const AString & GetFileName(void) const {return m_FileName; }
 		
+		/** Copies the header (chunk locations) into a_Header; returns false if the file cannot be opened */
+		bool GetHeader(unsigned * a_Header);
+		
+		/** Reads the chunk timestamps, the header's second sector, into a_Timestamps (MCA_MAX_CHUNKS entries); returns false on error */
+		bool GetTimestamps(unsigned * a_Timestamps);
+		
+		/** Reads the chunk data at the specified header index as stored in the file, including the length and compression type, but without the sector padding.
+		Returns false if the chunk is not present or the data is invalid. */
+		bool GetRawChunkData(int a_Index, AString & a_Data);
+		
+		/** Closes the file so that it can be replaced on the disk. It is re-opened (and the header re-read) on the next access. */
+		void Close(void) { m_File.Close(); }
+		
 	protected:
 	
 		int     m_RegionX;
@@ -87,10 +103,71 @@ protected:
 	} ;
 	typedef std::list<cMCAFile *> cMCAFiles;
 	
+	/** Fragmentation statistics of a single region file */
+	struct sRegionStats
+	{
+		int m_RegionX;
+		int m_RegionZ;
+		int m_NumChunks;
+		int m_UsedSectors;  ///< Number of 4 KiB sectors used by the header and the chunks
+		int m_FileSectors;  ///< Number of 4 KiB sectors in the file
+		
+		/** Returns the number of sectors that are not used by anything and would be reclaimed by compacting the file */
+		int GetWastedSectors(void) const { return m_FileSectors - m_UsedSectors; }
+		
+		/** Fills in the stats from the file's header (chunk locations) and size */
+		void Calculate(int a_RegionX, int a_RegionZ, const unsigned * a_Header, int a_FileSize);
+	} ;
+	typedef std::map<AString, sRegionStats> cRegionStatsMap;
+	
 	cCriticalSection m_CS;
 	cMCAFiles        m_Files;  // a MRU cache of MCA files
 	
-	int m_CompressionFactor;
+	/** The compression path used for saving the chunks; always zlib, the format doesn't allow anything else */
+	cCompressor & m_Compressor;
+	
+	typedef std::vector<cAnvilChunkDecoder *> cAnvilChunkDecoders;
+	
+	/** Guards m_Decoders; LoadChunk() may be called from threads other than the storage thread */
+	cCriticalSection m_CSDecoders;
+	
+	/** Decoders not currently in use, kept so that their inflate buffers are reused between chunks */
+	cAnvilChunkDecoders m_Decoders;
+	
+	/** Fragmentation statistics of the region files, by file name; updated by the periodic scan and by compaction. Protected by m_CS. */
+	cRegionStatsMap m_RegionStats;
+	
+	/** The time (cTimer msec) of the last region folder scan; 0 if not scanned yet */
+	long long m_LastRegionScan;
+	
+	/** Timer used for the background work scheduling */
+	cTimer m_Timer;
+	
+	/** State of the region file compaction that is in progress. Only used by the storage thread, except for m_IsAborted. */
+	struct sCompaction
+	{
+		bool     m_IsActive;
+		bool     m_IsAborted;   ///< Set (under m_CS) when the file is written to while being compacted
+		int      m_RegionX;
+		int      m_RegionZ;
+		AString  m_FileName;    ///< Name of the region file being compacted
+		cFile    m_TempFile;    ///< The compacted file being written
+		int      m_NextChunk;   ///< Header index of the next chunk to copy
+		unsigned m_NextSector;  ///< Sector in m_TempFile where the next chunk will be written
+		unsigned m_OldHeader[MCA_MAX_CHUNKS];  ///< Chunk locations in the original file
+		unsigned m_NewHeader[MCA_MAX_CHUNKS];  ///< Chunk locations in the compacted file
+	} m_Compaction;
+	
+	/** Number of bytes the compaction may still copy before it has to wait for more; replenished over time to limit the I/O bandwidth */
+	int m_CompactionBudget;
+	
+	/** The time (cTimer msec) when m_CompactionBudget was last replenished */
+	long long m_LastBudgetRefill;
+	
+	/** Overall compaction statistics since the server start */
+	int       m_NumFilesCompacted;
+	int       m_NumCompactionsAborted;
+	long long m_NumBytesReclaimed;
 
 	/// Gets chunk data from the correct file; locks file CS as needed
 	bool GetChunkData(const cChunkCoords & a_Chunk, AString & a_Data);
@@ -104,8 +181,8 @@ protected:
 	/// Saves the chunk into datastream (no locking needed)
 	bool SaveChunkToData(const cChunkCoords & a_Chunk, AString & a_Data);
 	
-	/// Loads the chunk from NBT data (no locking needed)
-	bool LoadChunkFromNBT(const cChunkCoords & a_Chunk, const cParsedNBT & a_NBT);
+	/// Loads the chunk from NBT data, using a_Decoder for the block data (no locking needed)
+	bool LoadChunkFromNBT(const cChunkCoords & a_Chunk, const cParsedNBT & a_NBT, cAnvilChunkDecoder & a_Decoder);
 	
 	/// Saves the chunk into NBT data using a_Writer; returns true on success
 	bool SaveChunkToNBT(const cChunkCoords & a_Chunk, cFastNBTWriter & a_Writer);
@@ -205,13 +282,29 @@ protected:
 	/// Gets the correct MCA file either from cache or from disk, manages the m_MCAFiles cache; assumes m_CS is locked
 	cMCAFile * LoadMCAFile(const cChunkCoords & a_Chunk);
 	
-	/// Copies a_Length bytes of data from the specified NBT Tag's Child into the a_Destination buffer
-	void CopyNBTData(const cParsedNBT & a_NBT, int a_Tag, const AString & a_ChildName, char * a_Destination, int a_Length);
-		
+	/** Reads the headers of all the region files and updates m_RegionStats.
+	Returns true and the coords of the most fragmented region that is worth compacting and has no chunks loaded, false if there's none. */
+	bool ScanRegionFiles(int & a_RegionX, int & a_RegionZ);
+	
+	/** Starts compacting the specified region file; returns true if started */
+	bool StartCompaction(int a_RegionX, int a_RegionZ);
+	
+	/** Copies the next few chunks into the compacted file, within the I/O budget; replaces the original file when all chunks are copied.
+	Returns true if there is more work that can be done right away. */
+	bool CompactionStep(void);
+	
+	/** Writes the new header and replaces the original region file with the compacted one; assumes m_CS is locked */
+	void FinishCompaction(void);
+	
+	/** Stops the compaction in progress and removes the temporary file */
+	void AbortCompaction(void);
+	
 	// cWSSchema overrides:
 	virtual bool LoadChunk(const cChunkCoords & a_Chunk) override;
 	virtual bool SaveChunk(const cChunkCoords & a_Chunk) override;
 	virtual const AString GetName(void) const override {return "anvil"; }
+	virtual bool DoBackgroundWork(void) override;
+	virtual void LogStats(cCommandOutputCallback & a_Output) override;
 } ;
 
 
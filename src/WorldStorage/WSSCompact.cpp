@@ -8,7 +8,6 @@
 #include "../World.h"
 #include "zlib/zlib.h"
 #include "json/json.h"
-#include "../StringCompression.h"
 #include "../BlockEntities/ChestEntity.h"
 #include "../BlockEntities/CommandBlockEntity.h"
 #include "../BlockEntities/DispenserEntity.h"
@@ -195,7 +194,7 @@ cWSSCompact::cPAKFile * cWSSCompact::LoadPAKFile(const cChunkCoords & a_Chunk)
 	// Load it anew:
 	AString FileName;
 	Printf(FileName, "%s/X%i_Z%i.pak", m_World->GetName().c_str(), LayerX, LayerZ );
-	cPAKFile * f = new cPAKFile(FileName, LayerX, LayerZ, m_CompressionFactor);
+	cPAKFile * f = new cPAKFile(FileName, LayerX, LayerZ, m_Compressor);
 	if (f == NULL)
 	{
 		return NULL;
@@ -389,9 +388,9 @@ void cWSSCompact::LoadEntitiesFromJson(Json::Value & a_Value, cEntityList & a_En
 		return; \
 	}
 
-cWSSCompact::cPAKFile::cPAKFile(const AString & a_FileName, int a_LayerX, int a_LayerZ, int a_CompressionFactor) :
+cWSSCompact::cPAKFile::cPAKFile(const AString & a_FileName, int a_LayerX, int a_LayerZ, cCompressor & a_Compressor) :
 	m_FileName(a_FileName),
-	m_CompressionFactor(a_CompressionFactor),
+	m_Compressor(a_Compressor),
 	m_LayerX(a_LayerX),
 	m_LayerZ(a_LayerZ),
 	m_NumDirty(0),
@@ -559,7 +558,7 @@ void cWSSCompact::cPAKFile::UpdateChunk1To2()
 		// Decompress the data:
 		AString UncompressedData;
 		{
-			int errorcode = UncompressString(Data.data(), Data.size(), UncompressedData, UncompressedSize);
+			int errorcode = cCompressor::Uncompress(Data.data(), Data.size(), UncompressedData, UncompressedSize);
 			if (errorcode != Z_OK)
 			{
 				LOGERROR("Error %d decompressing data for chunk [%d, %d]", 
@@ -639,7 +638,7 @@ void cWSSCompact::cPAKFile::UpdateChunk1To2()
 		// Re-compress data
 		AString CompressedData;
 		{
-			int errorcode = CompressString(Converted.data(), Converted.size(), CompressedData,m_CompressionFactor);
+			int errorcode = m_Compressor.Compress(Converted.data(), Converted.size(), CompressedData);
 			if (errorcode != Z_OK)
 			{
 				LOGERROR("Error %d compressing data for chunk [%d, %d]", 
@@ -703,7 +702,7 @@ void cWSSCompact::cPAKFile::UpdateChunk2To3()
 		// Decompress the data:
 		AString UncompressedData;
 		{
-			int errorcode = UncompressString(Data.data(), Data.size(), UncompressedData, UncompressedSize);
+			int errorcode = cCompressor::Uncompress(Data.data(), Data.size(), UncompressedData, UncompressedSize);
 			if (errorcode != Z_OK)
 			{
 				LOGERROR("Error %d decompressing data for chunk [%d, %d]", 
@@ -777,7 +776,7 @@ void cWSSCompact::cPAKFile::UpdateChunk2To3()
 		// Re-compress data
 		AString CompressedData;
 		{
-			int errorcode = CompressString(Converted.data(), Converted.size(), CompressedData, m_CompressionFactor);
+			int errorcode = m_Compressor.Compress(Converted.data(), Converted.size(), CompressedData);
 			if (errorcode != Z_OK)
 			{
 				LOGERROR("Error %d compressing data for chunk [%d, %d]", 
@@ -821,7 +820,7 @@ bool cWSSCompact::LoadChunkFromData(const cChunkCoords & a_Chunk, int & a_Uncomp
 	
 	// Decompress the data:
 	AString UncompressedData;
-	int errorcode = UncompressString(a_Data.data(), a_Data.size(), UncompressedData, a_UncompressedSize);
+	int errorcode = cCompressor::Uncompress(a_Data.data(), a_Data.size(), UncompressedData, a_UncompressedSize);
 	if (errorcode != Z_OK)
 	{
 		LOGERROR("Error %d decompressing data for chunk [%d, %d]", 
@@ -930,7 +929,7 @@ bool cWSSCompact::cPAKFile::SaveChunkToData(const cChunkCoords & a_Chunk, cWorld
 	
 	// Compress the data:
 	AString CompressedData;
-	int errorcode = CompressString(Data.data(), Data.size(), CompressedData, m_CompressionFactor);
+	int errorcode = m_Compressor.Compress(Data.data(), Data.size(), CompressedData);
 	if ( errorcode != Z_OK )
 	{
 		LOGERROR("Error %i compressing data for chunk [%d, %d, %d]", errorcode, a_Chunk.m_ChunkX, a_Chunk.m_ChunkY, a_Chunk.m_ChunkZ);
@@ -14,6 +14,7 @@
 #include "WorldStorage.h"
 #include "../Vector3i.h"
 #include "json/json.h"
+#include "../Compressor.h"
 
 
 
@@ -53,7 +54,7 @@ class cWSSCompact :
 	public cWSSchema
 {
 public:
-	cWSSCompact(cWorld * a_World, int a_CompressionFactor) : cWSSchema(a_World), m_CompressionFactor(a_CompressionFactor) {}
+	cWSSCompact(cWorld * a_World, cCompressor & a_Compressor) : cWSSchema(a_World), m_Compressor(a_Compressor) {}
 	virtual ~cWSSCompact();
 	
 protected:
@@ -74,7 +75,7 @@ protected:
 	{
 	public:
 	
-		cPAKFile(const AString & a_FileName, int a_LayerX, int a_LayerZ, int a_CompressionFactor);
+		cPAKFile(const AString & a_FileName, int a_LayerX, int a_LayerZ, cCompressor & a_Compressor);
 		~cPAKFile();
 
 		bool GetChunkData(const cChunkCoords & a_Chunk, int & a_UncompressedSize, AString & a_Data);
@@ -95,7 +96,7 @@ protected:
 	protected:
 	
 		AString m_FileName;
-		int m_CompressionFactor;
+		cCompressor & m_Compressor;
 		int     m_LayerX;
 		int     m_LayerZ;
 		
@@ -120,7 +121,8 @@ protected:
 	cCriticalSection m_CS;
 	cPAKFiles m_PAKFiles;  // A MRU cache of PAK files
 	
-	int m_CompressionFactor;
+	/** The compression path used for saving the chunks; may use any codec, the data is loaded regardless of the codec */
+	cCompressor & m_Compressor;
 	
 	/// Loads the correct PAK file either from cache or from disk, manages the m_PAKFiles cache
 	cPAKFile * LoadPAKFile(const cChunkCoords & a_Chunk);
@@ -68,11 +68,11 @@ cWorldStorage::~cWorldStorage()
 
 
 
-bool cWorldStorage::Start(cWorld * a_World, const AString & a_StorageSchemaName, int a_StorageCompressionFactor )
+bool cWorldStorage::Start(cWorld * a_World, const AString & a_StorageSchemaName, cCompressor & a_Compressor)
 {
 	m_World = a_World;
 	m_StorageSchemaName = a_StorageSchemaName;
-	InitSchemas(a_StorageCompressionFactor);
+	InitSchemas(a_Compressor);
 	
 	return super::Start();
 }
@@ -179,6 +179,27 @@ void cWorldStorage::QueueSavedMessage(void)
 
 
 
+void cWorldStorage::QueueBackgroundWork(void)
+{
+	m_Event.Set();
+}
+
+
+
+
+
+void cWorldStorage::LogStats(cCommandOutputCallback & a_Output)
+{
+	if (m_SaveSchema != NULL)
+	{
+		m_SaveSchema->LogStats(a_Output);
+	}
+}
+
+
+
+
+
 void cWorldStorage::UnqueueLoad(int a_ChunkX, int a_ChunkY, int a_ChunkZ)
 {
 	m_LoadQueue.Remove(sChunkLoad(a_ChunkX, a_ChunkY, a_ChunkZ,true));
@@ -197,11 +218,11 @@ void cWorldStorage::UnqueueSave(const cChunkCoords & a_Chunk)
 
 
 
-void cWorldStorage::InitSchemas(int a_StorageCompressionFactor)
+void cWorldStorage::InitSchemas(cCompressor & a_Compressor)
 {
 	// The first schema added is considered the default
-	m_Schemas.push_back(new cWSSAnvil    (m_World,a_StorageCompressionFactor));
-	m_Schemas.push_back(new cWSSCompact  (m_World,a_StorageCompressionFactor));
+	m_Schemas.push_back(new cWSSAnvil    (m_World, a_Compressor));
+	m_Schemas.push_back(new cWSSCompact  (m_World, a_Compressor));
 	m_Schemas.push_back(new cWSSForgetful(m_World));
 	// Add new schemas here
 	
@@ -251,6 +272,12 @@ void cWorldStorage::Execute(void)
 			
 			Success = LoadOneChunk();
 			Success |= SaveOneChunk();
+			
+			// Only do the background work when there are no chunks waiting:
+			if (!Success)
+			{
+				Success = m_SaveSchema->DoBackgroundWork();
+			}
 		} while (Success);
 	}
 }
@@ -24,6 +24,8 @@
 
 // fwd:
 class cWorld;
+class cCommandOutputCallback;
+class cCompressor;
 
 typedef cQueue<cChunkCoords> cChunkCoordsQueue;
 
@@ -42,6 +44,14 @@ public:
 	virtual bool SaveChunk(const cChunkCoords & a_Chunk) = 0;
 	virtual const AString GetName(void) const = 0;
 	
+	/** Called by the storage thread when there are no chunks to load or save.
+	Performs a bounded piece of maintenance work (such as compacting the files) and returns true if there is more work to do right away.
+	The default implementation has nothing to do. */
+	virtual bool DoBackgroundWork(void) { return false; }
+	
+	/** Outputs the schema-specific storage statistics. The default implementation has none. */
+	virtual void LogStats(cCommandOutputCallback & a_Output) { UNUSED(a_Output); }
+	
 protected:
 
 	cWorld * m_World;
@@ -70,13 +80,20 @@ public:
 	/// Signals that a message should be output to the console when all the chunks have been saved
 	void QueueSavedMessage(void);
 	
+	/** Wakes the storage thread up so that the save schema can do its background work, if the queues are empty.
+	Called periodically by the world. */
+	void QueueBackgroundWork(void);
+	
+	/** Outputs the statistics of the save schema */
+	void LogStats(cCommandOutputCallback & a_Output);
+	
 	/// Loads the chunk specified; returns true on success, false on failure
 	bool LoadChunk(int a_ChunkX, int a_ChunkY, int a_ChunkZ);
 
 	void UnqueueLoad(int a_ChunkX, int a_ChunkY, int a_ChunkZ);
 	void UnqueueSave(const cChunkCoords & a_Chunk);
 	
-	bool Start(cWorld * a_World, const AString & a_StorageSchemaName, int a_StorageCompressionFactor);  // Hide the cIsThread's Start() method, we need to provide args
+	bool Start(cWorld * a_World, const AString & a_StorageSchemaName, cCompressor & a_Compressor);  // Hide the cIsThread's Start() method, we need to provide args
 	void Stop(void);  // Hide the cIsThread's Stop() method, we need to signal the event
 	void WaitForFinish(void);
 	void WaitForLoadQueueEmpty(void);
@@ -110,6 +127,10 @@ protected:
 		{
 			a_orig.m_Generate |= a_new.m_Generate;
 		};
+		static size_t Hash(const sChunkLoad & a_Item)
+		{
+			return cChunkCoords(a_Item.m_ChunkX, a_Item.m_ChunkY, a_Item.m_ChunkZ).GetHash();
+		}
 	};
 
 	typedef cQueue<sChunkLoad,FuncTable> sChunkLoadQueue;
@@ -126,7 +147,7 @@ protected:
 	/// The one storage schema used for saving
 	cWSSchema *   m_SaveSchema;
 	
-	void InitSchemas(int a_StorageCompressionFactor);
+	void InitSchemas(cCompressor & a_Compressor);
 	
 	virtual void Execute(void) override;
 	